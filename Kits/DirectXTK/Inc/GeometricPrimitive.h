@@ -36,6 +36,7 @@ namespace DirectX
         using VertexType = VertexPositionNormalTexture;
         using VertexCollection = std::vector<VertexType>;
         using IndexCollection = std::vector<uint16_t>;
+        using IndexCollection32 = std::vector<uint32_t>;
 
         virtual ~GeometricPrimitive();
 
@@ -67,6 +68,14 @@ namespace DirectX
         static void __cdecl CreateIcosahedron(VertexCollection& vertices, IndexCollection& indices, float size = 1, bool rhcoords = true);
         static void __cdecl CreateTeapot(VertexCollection& vertices, IndexCollection& indices, float size = 1, size_t tessellation = 8, bool rhcoords = true);
 
+        // 32-bit index variants for tessellations too fine for 16-bit indices.
+        static void __cdecl CreateSphere(VertexCollection& vertices, IndexCollection32& indices, float diameter = 1, size_t tessellation = 16, bool rhcoords = true, bool invertn = false);
+        static void __cdecl CreateGeoSphere(VertexCollection& vertices, IndexCollection32& indices, float diameter = 1, size_t tessellation = 3, bool rhcoords = true);
+        static void __cdecl CreateCylinder(VertexCollection& vertices, IndexCollection32& indices, float height = 1, float diameter = 1, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateCone(VertexCollection& vertices, IndexCollection32& indices, float diameter = 1, float height = 1, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateTorus(VertexCollection& vertices, IndexCollection32& indices, float diameter = 1, float thickness = 0.333f, size_t tessellation = 32, bool rhcoords = true);
+        static void __cdecl CreateTeapot(VertexCollection& vertices, IndexCollection32& indices, float size = 1, size_t tessellation = 8, bool rhcoords = true);
+
         // Draw the primitive.
         void XM_CALLCONV Draw(FXMMATRIX world, CXMMATRIX view, CXMMATRIX projection,
             FXMVECTOR color = Colors::White,
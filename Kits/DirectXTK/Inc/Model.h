@@ -39,6 +39,7 @@ namespace DirectX
     class IEffectFactory;
     class CommonStates;
     class ModelMesh;
+    struct VertexPositionNormalTangentColorTextureSkinning;
 
     //----------------------------------------------------------------------------------
     // Model loading options
@@ -92,6 +93,31 @@ namespace DirectX
     };
 
 
+    //----------------------------------------------------------------------------------
+    // CPU skinning matching SkinnedEffect, for when the skinned vertices are needed on the CPU
+    struct SkinningJob
+    {
+        const VertexPositionNormalTangentColorTextureSkinning*  vertices;
+        size_t                                                  vertexCount;
+        const XMMATRIX*                                         boneTransforms;     // Bone palette indexed by the vertices
+        size_t                                                  boneCount;
+        XMFLOAT3*                                               positions;
+        XMFLOAT3*                                               normals;            // Optional
+    };
+
+    void __cdecl SkinVertices(
+        size_t nverts, _In_reads_(nverts) const VertexPositionNormalTangentColorTextureSkinning* vertices,
+        size_t nbones, _In_reads_(nbones) const XMMATRIX* boneTransforms,
+        _Out_writes_(nverts) XMFLOAT3* positions,
+        _Out_writes_opt_(nverts) XMFLOAT3* normals = nullptr);
+
+    void __cdecl SkinVertices(
+        size_t njobs, _In_reads_(njobs) const SkinningJob* jobs,
+        unsigned int threadCount = 0);
+        // Splits the vertices of all the jobs across threadCount threads (0 for one per hardware thread),
+        // which are created for the call and joined before it returns
+
+
     //----------------------------------------------------------------------------------
     // Each mesh part is a submesh with a single effect
     class ModelMeshPart
@@ -269,6 +295,17 @@ namespace DirectX
             _In_reads_(nbones) const XMMATRIX* inBoneTransforms,
             _Out_writes_(nbones) XMMATRIX* outBoneTransforms) const;
 
+        // Compute bone positions for many instances of the model, each using nbones consecutive transforms
+        void __cdecl CopyAbsoluteBoneTransformsBatch(
+            size_t ninstances, size_t nbones,
+            _In_reads_(ninstances * nbones) const XMMATRIX* inBoneTransforms,
+            _Out_writes_(ninstances * nbones) XMMATRIX* outBoneTransforms) const;
+
+        // Flattens the bone hierarchy into a parent-before-child order used to compute absolute transforms.
+        // The loaders call this; call it again after changing the hierarchy, or the slower recursive walk is used.
+        // Hierarchies which reach a bone more than once (shared bones or cycles) always use the recursive walk.
+        void __cdecl UpdateBoneEvaluationOrder();
+
         // Set bone matrices to a set of relative tansforms
         void __cdecl CopyBoneTransformsFrom(
             size_t nbones,
@@ -324,13 +361,30 @@ namespace DirectX
             ModelLoaderFlags flags = ModelLoader_Clockwise);
 
     private:
-        std::set<IEffect*>  mEffectCache;
+        struct BoneEvaluation
+        {
+            uint32_t    index;
+            uint32_t    parent;         // Bone this transform is relative to, or c_Invalid for the roots
+            uint32_t    childIndex;     // Links of the bone when the order was built
+            uint32_t    siblingIndex;
+        };
+
+        std::set<IEffect*>              mEffectCache;
+        std::vector<BoneEvaluation>     mBoneOrder;
+        size_t                          mBoneOrderCount = 0;
 
         void __cdecl ComputeAbsolute(uint32_t index,
             CXMMATRIX local, size_t nbones,
             _In_reads_(nbones) const XMMATRIX* inBoneTransforms,
             _Inout_updates_(nbones) XMMATRIX* outBoneTransforms,
             size_t& visited) const;
+
+        bool __cdecl IsBoneEvaluationOrderCurrent() const noexcept;
+
+        void __cdecl ComputeAbsoluteTransforms(
+            bool useOrder, size_t nbones,
+            _In_reads_(nbones) const XMMATRIX* inBoneTransforms,
+            _Out_writes_(nbones) XMMATRIX* outBoneTransforms) const;
     };
 
 #ifdef __clang__
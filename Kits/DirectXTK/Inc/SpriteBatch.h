@@ -58,7 +58,8 @@ namespace DirectX
 
         virtual ~SpriteBatch();
 
-        // Begin/End a batch of sprite drawing operations.
+        // Begin/End a batch of sprite drawing operations. Unless the sort mode is SpriteSortMode_Immediate, Draw may
+        // also be called from other threads in between, as long as those calls have returned before End.
         void XM_CALLCONV Begin(SpriteSortMode sortMode = SpriteSortMode_Deferred,
             _In_opt_ ID3D11BlendState* blendState = nullptr,
             _In_opt_ ID3D11SamplerState* samplerState = nullptr,
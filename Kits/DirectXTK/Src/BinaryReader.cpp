@@ -14,15 +14,47 @@
 
 using namespace DirectX;
 
+namespace
+{
+    // Opens a file for reading and returns its size.
+    HRESULT OpenFileForRead(
+        _In_z_ wchar_t const* fileName,
+        ScopedHandle& hFile,
+        _Out_ FILE_STANDARD_INFO* fileInfo) noexcept
+    {
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+        hFile.reset(safe_handle(CreateFile2(
+            fileName,
+            GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
+            nullptr)));
+#else
+        hFile.reset(safe_handle(CreateFileW(
+            fileName,
+            GENERIC_READ, FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+            nullptr)));
+#endif
+
+        if (!hFile)
+            return HRESULT_FROM_WIN32(GetLastError());
+
+        if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, fileInfo, sizeof(FILE_STANDARD_INFO)))
+        {
+            return HRESULT_FROM_WIN32(GetLastError());
+        }
+
+        return S_OK;
+    }
+}
+
 
 // Constructor reads from the filesystem.
 BinaryReader::BinaryReader(_In_z_ wchar_t const* fileName) noexcept(false) :
     mPos(nullptr),
     mEnd(nullptr)
 {
-    size_t dataSize;
-
-    HRESULT hr = ReadEntireFile(fileName, mOwnedData, &dataSize);
+    HRESULT hr = mFile.Open(fileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: BinaryReader failed (%08X) to load '%ls'\n",
@@ -30,8 +62,8 @@ BinaryReader::BinaryReader(_In_z_ wchar_t const* fileName) noexcept(false) :
         throw std::runtime_error("BinaryReader");
     }
 
-    mPos = mOwnedData.get();
-    mEnd = mOwnedData.get() + dataSize;
+    mPos = mFile.data();
+    mEnd = mFile.data() + mFile.size();
 }
 
 
@@ -54,30 +86,12 @@ HRESULT BinaryReader::ReadEntireFile(
 
     *dataSize = 0;
 
-    // Open the file.
-#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
-    ScopedHandle hFile(safe_handle(CreateFile2(
-        fileName,
-        GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING,
-        nullptr)));
-#else
-    ScopedHandle hFile(safe_handle(CreateFileW(
-        fileName,
-        GENERIC_READ, FILE_SHARE_READ,
-        nullptr,
-        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
-        nullptr)));
-#endif
-
-    if (!hFile)
-        return HRESULT_FROM_WIN32(GetLastError());
-
-    // Get the file size.
+    // Open the file and get its size.
+    ScopedHandle hFile;
     FILE_STANDARD_INFO fileInfo;
-    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
-    {
-        return HRESULT_FROM_WIN32(GetLastError());
-    }
+    HRESULT hr = OpenFileForRead(fileName, hFile, &fileInfo);
+    if (FAILED(hr))
+        return hr;
 
     // File is too big for 32-bit allocation, so reject read.
     if (fileInfo.EndOfFile.HighPart > 0)
@@ -104,3 +118,67 @@ HRESULT BinaryReader::ReadEntireFile(
 
     return S_OK;
 }
+
+
+// Maps the file read-only, falling back to reading it into memory.
+HRESULT MappedFile::Open(_In_z_ wchar_t const* fileName)
+{
+    mView.reset();
+    mOwnedData.reset();
+    mData = nullptr;
+    mSize = 0;
+
+    if (!fileName)
+        return E_INVALIDARG;
+
+#if (defined(_XBOX_ONE) && defined(_TITLE)) || !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP) || (_WIN32_WINNT >= _WIN32_WINNT_WIN10)
+    {
+        ScopedHandle hFile;
+        FILE_STANDARD_INFO fileInfo;
+        HRESULT hr = OpenFileForRead(fileName, hFile, &fileInfo);
+        if (FAILED(hr))
+            return hr;
+
+        // Same 32-bit limit as ReadEntireFile.
+        if (fileInfo.EndOfFile.HighPart > 0)
+            return E_FAIL;
+
+        // Empty files can't be mapped, so those go through the fallback.
+        if (fileInfo.EndOfFile.LowPart > 0)
+        {
+#if (defined(_XBOX_ONE) && defined(_TITLE)) || !defined(WINAPI_FAMILY) || (WINAPI_FAMILY == WINAPI_FAMILY_DESKTOP_APP)
+            ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+            if (hMapping)
+            {
+                mView.reset(MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0));
+            }
+#else
+            ScopedHandle hMapping(CreateFileMappingFromApp(hFile.get(), nullptr, PAGE_READONLY, 0, nullptr));
+            if (hMapping)
+            {
+                mView.reset(MapViewOfFileFromApp(hMapping.get(), FILE_MAP_READ, 0, 0));
+            }
+#endif
+
+            // The view keeps the file contents alive after both handles are closed.
+            if (mView)
+            {
+                mData = static_cast<uint8_t const*>(mView.get());
+                mSize = fileInfo.EndOfFile.LowPart;
+                return S_OK;
+            }
+        }
+    }
+#endif
+
+    // Some file systems refuse mapping, so read the data in instead.
+    size_t dataSize = 0;
+    HRESULT hr = BinaryReader::ReadEntireFile(fileName, mOwnedData, &dataSize);
+    if (FAILED(hr))
+        return hr;
+
+    mData = mOwnedData.get();
+    mSize = dataSize;
+
+    return S_OK;
+}
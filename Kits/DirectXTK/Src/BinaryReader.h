@@ -20,6 +20,31 @@
 
 namespace DirectX
 {
+    // Read-only view of an entire file, memory-mapped where the platform allows it and read into memory otherwise.
+    class MappedFile
+    {
+    public:
+        MappedFile() noexcept : mData(nullptr), mSize(0) {}
+
+        MappedFile(MappedFile const&) = delete;
+        MappedFile& operator= (MappedFile const&) = delete;
+
+        HRESULT Open(_In_z_ wchar_t const* fileName);
+
+        uint8_t const* data() const noexcept { return mData; }
+        size_t size() const noexcept { return mSize; }
+
+    private:
+        struct view_unmapper { void operator()(void const* p) noexcept { if (p) UnmapViewOfFile(p); } };
+
+        uint8_t const* mData;
+        size_t mSize;
+
+        std::unique_ptr<void const, view_unmapper> mView;
+        std::unique_ptr<uint8_t[]> mOwnedData;
+    };
+
+
     // Helper for reading binary data, either from the filesystem a memory buffer.
     class BinaryReader
     {
@@ -67,6 +92,6 @@ namespace DirectX
         uint8_t const* mPos;
         uint8_t const* mEnd;
 
-        std::unique_ptr<uint8_t[]> mOwnedData;
+        MappedFile mFile;
     };
 }
@@ -502,6 +502,18 @@ void GeometricPrimitive::CreateSphere(
     ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateSphere(
+    VertexCollection& vertices,
+    IndexCollection32& indices,
+    float diameter,
+    size_t tessellation,
+    bool rhcoords,
+    bool invertn)
+{
+    ComputeSphere(vertices, indices, diameter, tessellation, rhcoords, invertn);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Geodesic sphere
@@ -535,6 +547,16 @@ void GeometricPrimitive::CreateGeoSphere(
     ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateGeoSphere(
+    VertexCollection& vertices,
+    IndexCollection32& indices,
+    float diameter,
+    size_t tessellation, bool rhcoords)
+{
+    ComputeGeoSphere(vertices, indices, diameter, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Cylinder / Cone
@@ -572,6 +594,18 @@ void GeometricPrimitive::CreateCylinder(
     ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCylinder(
+    VertexCollection& vertices,
+    IndexCollection32& indices,
+    float height,
+    float diameter,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeCylinder(vertices, indices, height, diameter, tessellation, rhcoords);
+}
+
 
 // Creates a cone primitive.
 _Use_decl_annotations_
@@ -605,6 +639,18 @@ void GeometricPrimitive::CreateCone(
     ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateCone(
+    VertexCollection& vertices,
+    IndexCollection32& indices,
+    float diameter,
+    float height,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeCone(vertices, indices, diameter, height, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Torus
@@ -641,6 +687,18 @@ void GeometricPrimitive::CreateTorus(
     ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTorus(
+    VertexCollection& vertices,
+    IndexCollection32& indices,
+    float diameter,
+    float thickness,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeTorus(vertices, indices, diameter, thickness, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Tetrahedron
@@ -803,6 +861,17 @@ void GeometricPrimitive::CreateTeapot(
     ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
 }
 
+_Use_decl_annotations_
+void GeometricPrimitive::CreateTeapot(
+    VertexCollection& vertices,
+    IndexCollection32& indices,
+    float size,
+    size_t tessellation,
+    bool rhcoords)
+{
+    ComputeTeapot(vertices, indices, size, tessellation, rhcoords);
+}
+
 
 //--------------------------------------------------------------------------------------
 // Custom
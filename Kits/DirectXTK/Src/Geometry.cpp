@@ -12,6 +12,9 @@
 #include "Geometry.h"
 #include "Bezier.h"
 
+#include <limits>
+#include <thread>
+
 using namespace DirectX;
 
 namespace
@@ -20,24 +23,28 @@ namespace
     constexpr float SQRT3 = 1.73205080756887729352f;
     constexpr float SQRT6 = 2.44948974278317809820f;
 
-    inline void CheckIndexOverflow(size_t value)
+    template<typename index_t>
+    inline void CheckIndexOverflow(uint64_t value)
     {
-        // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values.
-        if (value >= USHRT_MAX)
+        // Use >=, not > comparison, because some D3D level 9_x hardware does not support 0xFFFF index values,
+        // and 0xFFFFFFFF is the strip-cut value for 32-bit indices.
+        if (value >= (std::numeric_limits<index_t>::max)())
             throw std::out_of_range("Index value out of range: cannot tesselate primitive so finely");
     }
 
 
     // Collection types used when generating the geometry.
-    inline void index_push_back(IndexCollection& indices, size_t value)
+    template<typename index_t>
+    inline void index_push_back(std::vector<index_t>& indices, size_t value)
     {
-        CheckIndexOverflow(value);
-        indices.push_back(static_cast<uint16_t>(value));
+        CheckIndexOverflow<index_t>(value);
+        indices.push_back(static_cast<index_t>(value));
     }
 
 
     // Helper for flipping winding of geometric primitives for LH vs. RH coords
-    inline void ReverseWinding(IndexCollection& indices, VertexCollection& vertices)
+    template<typename index_t>
+    inline void ReverseWinding(std::vector<index_t>& indices, VertexCollection& vertices)
     {
         assert((indices.size() % 3) == 0);
         for (auto it = indices.begin(); it != indices.end(); it += 3)
@@ -144,312 +151,466 @@ void DirectX::ComputeBox(VertexCollection& vertices, IndexCollection& indices, c
 //--------------------------------------------------------------------------------------
 // Sphere
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
+namespace
 {
-    vertices.clear();
-    indices.clear();
+    template<typename index_t>
+    void ComputeSphereImpl(VertexCollection& vertices, std::vector<index_t>& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
+    {
+        vertices.clear();
+        indices.clear();
 
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
+        if (tessellation < 3)
+            throw std::invalid_argument("tesselation parameter must be at least 3");
 
-    const size_t verticalSegments = tessellation;
-    const size_t horizontalSegments = tessellation * 2;
+        const size_t verticalSegments = tessellation;
+        const size_t horizontalSegments = tessellation * 2;
 
-    const float radius = diameter / 2;
+        const float radius = diameter / 2;
 
-    // Create rings of vertices at progressively higher latitudes.
-    for (size_t i = 0; i <= verticalSegments; i++)
-    {
-        const float v = 1 - float(i) / float(verticalSegments);
+        vertices.reserve((verticalSegments + 1) * (horizontalSegments + 1));
+        indices.reserve(verticalSegments * (horizontalSegments + 1) * 6);
+
+        // Create rings of vertices at progressively higher latitudes.
+        for (size_t i = 0; i <= verticalSegments; i++)
+        {
+            const float v = 1 - float(i) / float(verticalSegments);
 
-        const float latitude = (float(i) * XM_PI / float(verticalSegments)) - XM_PIDIV2;
-        float dy, dxz;
+            const float latitude = (float(i) * XM_PI / float(verticalSegments)) - XM_PIDIV2;
+            float dy, dxz;
 
-        XMScalarSinCos(&dy, &dxz, latitude);
+            XMScalarSinCos(&dy, &dxz, latitude);
 
-        // Create a single ring of vertices at this latitude.
-        for (size_t j = 0; j <= horizontalSegments; j++)
-        {
-            const float u = float(j) / float(horizontalSegments);
+            // Create a single ring of vertices at this latitude.
+            for (size_t j = 0; j <= horizontalSegments; j++)
+            {
+                const float u = float(j) / float(horizontalSegments);
 
-            const float longitude = float(j) * XM_2PI / float(horizontalSegments);
-            float dx, dz;
+                const float longitude = float(j) * XM_2PI / float(horizontalSegments);
+                float dx, dz;
 
-            XMScalarSinCos(&dx, &dz, longitude);
+                XMScalarSinCos(&dx, &dz, longitude);
 
-            dx *= dxz;
-            dz *= dxz;
+                dx *= dxz;
+                dz *= dxz;
 
-            const XMVECTOR normal = XMVectorSet(dx, dy, dz, 0);
-            const XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+                const XMVECTOR normal = XMVectorSet(dx, dy, dz, 0);
+                const XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
 
-            vertices.push_back(VertexPositionNormalTexture(XMVectorScale(normal, radius), normal, textureCoordinate));
+                vertices.push_back(VertexPositionNormalTexture(XMVectorScale(normal, radius), normal, textureCoordinate));
+            }
         }
-    }
 
-    // Fill the index buffer with triangles joining each pair of latitude rings.
-    const size_t stride = horizontalSegments + 1;
+        // Fill the index buffer with triangles joining each pair of latitude rings.
+        const size_t stride = horizontalSegments + 1;
 
-    for (size_t i = 0; i < verticalSegments; i++)
-    {
-        for (size_t j = 0; j <= horizontalSegments; j++)
+        for (size_t i = 0; i < verticalSegments; i++)
         {
-            const size_t nextI = i + 1;
-            const size_t nextJ = (j + 1) % stride;
+            for (size_t j = 0; j <= horizontalSegments; j++)
+            {
+                const size_t nextI = i + 1;
+                const size_t nextJ = (j + 1) % stride;
 
-            index_push_back(indices, i * stride + j);
-            index_push_back(indices, nextI * stride + j);
-            index_push_back(indices, i * stride + nextJ);
+                index_push_back(indices, i * stride + j);
+                index_push_back(indices, nextI * stride + j);
+                index_push_back(indices, i * stride + nextJ);
 
-            index_push_back(indices, i * stride + nextJ);
-            index_push_back(indices, nextI * stride + j);
-            index_push_back(indices, nextI * stride + nextJ);
+                index_push_back(indices, i * stride + nextJ);
+                index_push_back(indices, nextI * stride + j);
+                index_push_back(indices, nextI * stride + nextJ);
+            }
         }
+
+        // Build RH above
+        if (!rhcoords)
+            ReverseWinding(indices, vertices);
+
+        if (invertn)
+            InvertNormals(vertices);
     }
+}
 
-    // Build RH above
-    if (!rhcoords)
-        ReverseWinding(indices, vertices);
+void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
+{
+    ComputeSphereImpl(vertices, indices, diameter, tessellation, rhcoords, invertn);
+}
 
-    if (invertn)
-        InvertNormals(vertices);
+void DirectX::ComputeSphere(VertexCollection& vertices, IndexCollection32& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn)
+{
+    ComputeSphereImpl(vertices, indices, diameter, tessellation, rhcoords, invertn);
 }
 
 
 //--------------------------------------------------------------------------------------
 // Geodesic sphere
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords)
+namespace
 {
-    vertices.clear();
-    indices.clear();
+    constexpr uint64_t c_EmptyEdge = UINT64_MAX;
 
-    // An undirected edge between two vertices, represented by a pair of indexes into a vertex array.
-    // Becuse this edge is undirected, (a,b) is the same as (b,a).
-    using UndirectedEdge = std::pair<uint16_t, uint16_t>;
-
-    // Makes an undirected edge. Rather than overloading comparison operators to give us the (a,b)==(b,a) property,
-    // we'll just ensure that the larger of the two goes first. This'll simplify things greatly.
-    auto makeUndirectedEdge = [](uint16_t a, uint16_t b) noexcept
+    // Open-addressed table from an undirected edge to the index of the vertex which lies midway between the two
+    // vertices of that edge. This is used to avoid duplicating vertices when subdividing triangles along edges.
+    class EdgeSubdivisionTable
     {
-        return std::make_pair(std::max(a, b), std::min(a, b));
-    };
+    public:
+        EdgeSubdivisionTable() noexcept : mShift(64) {}
 
-    // Key: an edge
-    // Value: the index of the vertex which lies midway between the two vertices pointed to by the key value
-    // This map is used to avoid duplicating vertices when subdividing triangles along edges.
-    using EdgeSubdivisionMap = std::map<UndirectedEdge, uint16_t>;
+        // Empties the table, sizing it for the given number of edges.
+        void Reset(size_t edgeCount)
+        {
+            size_t capacity = 16;
+            mShift = 60;
+            while (capacity < edgeCount * 2)
+            {
+                capacity <<= 1;
+                --mShift;
+            }
 
+            const Entry empty = { c_EmptyEdge, 0 };
+            mEntries.assign(capacity, empty);
+        }
 
-    static const XMFLOAT3 OctahedronVertices[] =
-    {
-        // when looking down the negative z-axis (into the screen)
-        XMFLOAT3(0,  1,  0), // 0 top
-        XMFLOAT3(0,  0, -1), // 1 front
-        XMFLOAT3(1,  0,  0), // 2 right
-        XMFLOAT3(0,  0,  1), // 3 back
-        XMFLOAT3(-1,  0,  0), // 4 left
-        XMFLOAT3(0, -1,  0), // 5 bottom
-    };
-    static const uint16_t OctahedronIndices[] =
-    {
-        0, 1, 2, // top front-right face
-        0, 2, 3, // top back-right face
-        0, 3, 4, // top back-left face
-        0, 4, 1, // top front-left face
-        5, 1, 4, // bottom front-left face
-        5, 4, 3, // bottom back-left face
-        5, 3, 2, // bottom back-right face
-        5, 2, 1, // bottom front-right face
+        // Returns the midpoint index stored for the edge (a,b). Because this edge is undirected, (a,b) is the same as
+        // (b,a). If the edge isn't in the table yet, it is added and 'found' is set to false so the caller can fill in
+        // the index.
+        uint32_t& Find(uint32_t a, uint32_t b, bool& found) noexcept
+        {
+            const uint64_t key = (uint64_t(std::max(a, b)) << 32) | std::min(a, b);
+            const size_t mask = mEntries.size() - 1;
+
+            // Fibonacci hashing spreads the consecutive indices of neighboring edges across the table.
+            auto slot = static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> mShift);
+            for (;;)
+            {
+                Entry& entry = mEntries[slot];
+                if (entry.key == key)
+                {
+                    found = true;
+                    return entry.index;
+                }
+
+                if (entry.key == c_EmptyEdge)
+                {
+                    entry.key = key;
+                    found = false;
+                    return entry.index;
+                }
+
+                slot = (slot + 1) & mask;
+            }
+        }
+
+    private:
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t index;
+        };
+
+        std::vector<Entry> mEntries;
+        unsigned int mShift;
     };
 
-    const float radius = diameter / 2.0f;
 
-    // Start with an octahedron; copy the data into the vertex/index collection.
+    // Levels with fewer triangles than this are subdivided on the calling thread alone
+    constexpr size_t c_ParallelSubdivisionThreshold = 16384;
+
+    // Calls func(begin, end) for slices of [0, count), one per hardware thread. The calling thread takes the first
+    // slice, and any slices whose threads couldn't be started. func must not throw.
+    template<typename Func>
+    void ParallelSlices(size_t count, const Func& func)
+    {
+        const size_t threadCount = std::max<size_t>(1u, std::thread::hardware_concurrency());
+        if (threadCount == 1)
+        {
+            func(size_t(0), count);
+            return;
+        }
+
+        std::vector<std::thread> threads;
+        size_t started = 1;
+        try
+        {
+            threads.reserve(threadCount - 1);
+            for (; started < threadCount; ++started)
+            {
+                threads.emplace_back(func, count * started / threadCount, count * (started + 1) / threadCount);
+            }
+        }
+        catch (const std::exception&)
+        {
+        }
 
-    std::vector<XMFLOAT3> vertexPositions(std::begin(OctahedronVertices), std::end(OctahedronVertices));
+        func(size_t(0), count / threadCount);
+        if (started < threadCount)
+        {
+            func(count * started / threadCount, count);
+        }
 
-    indices.insert(indices.begin(), std::begin(OctahedronIndices), std::end(OctahedronIndices));
+        for (auto& it : threads)
+        {
+            it.join();
+        }
+    }
 
-    // We know these values by looking at the above index list for the octahedron. Despite the subdivisions that are
-    // about to go on, these values aren't ever going to change because the vertices don't move around in the array.
-    // We'll need these values later on to fix the singularities that show up at the poles.
-    constexpr uint16_t northPoleIndex = 0;
-    constexpr uint16_t southPoleIndex = 5;
 
-    for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
+    template<typename index_t>
+    void ComputeGeoSphereImpl(VertexCollection& vertices, std::vector<index_t>& indices, float diameter, size_t tessellation, bool rhcoords)
     {
-        assert(indices.size() % 3 == 0); // sanity
+        vertices.clear();
+        indices.clear();
 
-        // We use this to keep track of which edges have already been subdivided.
-        EdgeSubdivisionMap subdividedEdges;
+        static const XMFLOAT3 OctahedronVertices[] =
+        {
+            // when looking down the negative z-axis (into the screen)
+            XMFLOAT3(0,  1,  0), // 0 top
+            XMFLOAT3(0,  0, -1), // 1 front
+            XMFLOAT3(1,  0,  0), // 2 right
+            XMFLOAT3(0,  0,  1), // 3 back
+            XMFLOAT3(-1,  0,  0), // 4 left
+            XMFLOAT3(0, -1,  0), // 5 bottom
+        };
+        static const uint16_t OctahedronIndices[] =
+        {
+            0, 1, 2, // top front-right face
+            0, 2, 3, // top back-right face
+            0, 3, 4, // top back-left face
+            0, 4, 1, // top front-left face
+            5, 1, 4, // bottom front-left face
+            5, 4, 3, // bottom back-left face
+            5, 3, 2, // bottom back-right face
+            5, 2, 1, // bottom front-right face
+        };
+
+        const float radius = diameter / 2.0f;
+
+        // Each subdivision turns every triangle into four, and a closed mesh of T triangles has T/2 + 2 vertices. This
+        // rejects a tessellation which would overflow the index type before doing any work, and sizes the storage.
+        uint64_t finalTriangleCount = std::size(OctahedronIndices) / 3;
+        for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
+        {
+            finalTriangleCount *= 4;
+            CheckIndexOverflow<index_t>(finalTriangleCount / 2 + 2);
+        }
+
+        // Start with an octahedron; copy the data into the vertex/index collection.
+
+        std::vector<XMFLOAT3> vertexPositions;
+        vertexPositions.reserve(static_cast<size_t>(finalTriangleCount / 2 + 2));
+        vertexPositions.assign(std::begin(OctahedronVertices), std::end(OctahedronVertices));
+
+        indices.reserve(static_cast<size_t>(finalTriangleCount * 3));
+        indices.assign(std::begin(OctahedronIndices), std::end(OctahedronIndices));
+
+        // We know these values by looking at the above index list for the octahedron. Despite the subdivisions that are
+        // about to go on, these values aren't ever going to change because the vertices don't move around in the array.
+        // We'll need these values later on to fix the singularities that show up at the poles.
+        constexpr index_t northPoleIndex = 0;
+        constexpr index_t southPoleIndex = 5;
 
-        // The new index collection after subdivision.
-        IndexCollection newIndices;
+        // We use this to keep track of which edges have already been subdivided.
+        EdgeSubdivisionTable subdividedEdges;
+
+        // The new index collection after subdivision, the midpoint indices of each triangle's edges, and the end
+        // points of each edge which gets a new midpoint vertex.
+        std::vector<index_t> newIndices;
+        std::vector<index_t> triangleMidpoints;
+        std::vector<index_t> newEdges;
+        if (tessellation > 0)
+        {
+            newIndices.reserve(indices.capacity());
+            triangleMidpoints.reserve(indices.capacity() / 4);
+            newEdges.reserve(vertexPositions.capacity() * 2);
+        }
 
-        const size_t triangleCount = indices.size() / 3;
-        for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle)
+        for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
         {
-            // For each edge on this triangle, create a new vertex in the middle of that edge.
-            // The winding order of the triangles we output are the same as the winding order of the inputs.
-
-            // Indices of the vertices making up this triangle
-            const uint16_t iv0 = indices[iTriangle * 3 + 0];
-            const uint16_t iv1 = indices[iTriangle * 3 + 1];
-            const uint16_t iv2 = indices[iTriangle * 3 + 2];
-
-            // Get the new vertices
-            XMFLOAT3 v01; // vertex on the midpoint of v0 and v1
-            XMFLOAT3 v12; // ditto v1 and v2
-            XMFLOAT3 v20; // ditto v2 and v0
-            uint16_t iv01; // index of v01
-            uint16_t iv12; // index of v12
-            uint16_t iv20; // index of v20
-
-            // Function that, when given the index of two vertices, creates a new vertex at the midpoint of those vertices.
-            auto const divideEdge = [&](uint16_t i0, uint16_t i1, XMFLOAT3& outVertex, uint16_t& outIndex)
-            {
-                const UndirectedEdge edge = makeUndirectedEdge(i0, i1);
+            assert(indices.size() % 3 == 0); // sanity
 
-                // Check to see if we've already generated this vertex
-                auto it = subdividedEdges.find(edge);
-                if (it != subdividedEdges.end())
+            const size_t triangleCount = indices.size() / 3;
+
+            // Every edge of the closed mesh is shared by two triangles.
+            subdividedEdges.Reset(triangleCount * 3 / 2);
+
+            // Walk the triangles in order to number the midpoint vertices, creating each one the first time its edge
+            // is seen. This is the only part of a level which depends on the triangles before it, so it runs serially
+            // and keeps the vertex order the same regardless of how the rest is split up.
+            const size_t firstNewVertex = vertexPositions.size();
+            triangleMidpoints.resize(indices.size());
+            newEdges.clear();
+
+            for (size_t j = 0; j < indices.size(); ++j)
+            {
+                // The edges of each triangle are v0-v1, v1-v2 and v0-v2, in that order.
+                const size_t first = j - (j % 3);
+                const index_t i0 = (j % 3 == 2) ? indices[first] : indices[j];
+                const index_t i1 = (j % 3 == 2) ? indices[j] : indices[j + 1];
+
+                bool found;
+                uint32_t& midpoint = subdividedEdges.Find(i0, i1, found);
+                if (!found)
                 {
-                    // We've already generated this vertex before
-                    outIndex = it->second; // the index of this vertex
-                    outVertex = vertexPositions[outIndex]; // and the vertex itself
+                    midpoint = static_cast<uint32_t>(firstNewVertex + newEdges.size() / 2);
+                    newEdges.push_back(i0);
+                    newEdges.push_back(i1);
                 }
-                else
-                {
-                    // Haven't generated this vertex before: so add it now
 
+                triangleMidpoints[j] = static_cast<index_t>(midpoint);
+            }
+
+            const size_t newVertexCount = newEdges.size() / 2;
+            CheckIndexOverflow<index_t>(firstNewVertex + newVertexCount - 1);
+            vertexPositions.resize(firstNewVertex + newVertexCount);
+            newIndices.resize(triangleCount * 12);
+
+            // Each new vertex and each group of four new triangles only depends on the numbering above, so these can
+            // be filled in any order.
+            auto const fillVertices = [&](size_t begin, size_t end) noexcept
+            {
+                for (size_t j = begin; j < end; ++j)
+                {
                     // outVertex = (vertices[i0] + vertices[i1]) / 2
                     XMStoreFloat3(
-                        &outVertex,
+                        &vertexPositions[firstNewVertex + j],
                         XMVectorScale(
-                        XMVectorAdd(XMLoadFloat3(&vertexPositions[i0]), XMLoadFloat3(&vertexPositions[i1])),
+                        XMVectorAdd(XMLoadFloat3(&vertexPositions[newEdges[j * 2]]), XMLoadFloat3(&vertexPositions[newEdges[j * 2 + 1]])),
                         0.5f
                     )
                     );
-
-                    outIndex = static_cast<uint16_t>(vertexPositions.size());
-                    CheckIndexOverflow(outIndex);
-                    vertexPositions.push_back(outVertex);
-
-                    // Now add it to the map.
-                    auto entry = std::make_pair(edge, outIndex);
-                    subdividedEdges.insert(entry);
                 }
             };
 
-            // Add/get new vertices and their indices
-            divideEdge(iv0, iv1, v01, iv01);
-            divideEdge(iv1, iv2, v12, iv12);
-            divideEdge(iv0, iv2, v20, iv20);
-
-            // Add the new indices. We have four new triangles from our original one:
-            //        v0
-            //        o
-            //       /a\
-            //  v20 o---o v01
-            //     /b\c/d\
-            // v2 o---o---o v1
-            //       v12
-            const uint16_t indicesToAdd[] =
+            auto const fillTriangles = [&](size_t begin, size_t end) noexcept
             {
-                 iv0, iv01, iv20, // a
-                iv20, iv12,  iv2, // b
-                iv20, iv01, iv12, // c
-                iv01,  iv1, iv12, // d
+                for (size_t iTriangle = begin; iTriangle < end; ++iTriangle)
+                {
+                    // The winding order of the triangles we output are the same as the winding order of the inputs.
+
+                    // Indices of the vertices making up this triangle, and of the vertices in the middle of its edges
+                    const index_t iv0 = indices[iTriangle * 3 + 0];
+                    const index_t iv1 = indices[iTriangle * 3 + 1];
+                    const index_t iv2 = indices[iTriangle * 3 + 2];
+
+                    const index_t iv01 = triangleMidpoints[iTriangle * 3 + 0];
+                    const index_t iv12 = triangleMidpoints[iTriangle * 3 + 1];
+                    const index_t iv20 = triangleMidpoints[iTriangle * 3 + 2];
+
+                    // Add the new indices. We have four new triangles from our original one:
+                    //        v0
+                    //        o
+                    //       /a\
+                    //  v20 o---o v01
+                    //     /b\c/d\
+                    // v2 o---o---o v1
+                    //       v12
+                    const index_t indicesToAdd[] =
+                    {
+                         iv0, iv01, iv20, // a
+                        iv20, iv12,  iv2, // b
+                        iv20, iv01, iv12, // c
+                        iv01,  iv1, iv12, // d
+                    };
+                    std::copy(std::begin(indicesToAdd), std::end(indicesToAdd), newIndices.begin() + ptrdiff_t(iTriangle * 12));
+                }
             };
-            newIndices.insert(newIndices.end(), std::begin(indicesToAdd), std::end(indicesToAdd));
+
+            if (triangleCount < c_ParallelSubdivisionThreshold)
+            {
+                fillVertices(0, newVertexCount);
+                fillTriangles(0, triangleCount);
+            }
+            else
+            {
+                ParallelSlices(newVertexCount, fillVertices);
+                ParallelSlices(triangleCount, fillTriangles);
+            }
+
+            // Swap rather than move so both collections keep their storage for the next level.
+            std::swap(indices, newIndices);
         }
 
-        indices = std::move(newIndices);
-    }
+        // Now that we've completed subdivision, fill in the final vertex collection
+        vertices.reserve(vertexPositions.size());
+        for (const auto& it : vertexPositions)
+        {
+            auto const normal = XMVector3Normalize(XMLoadFloat3(&it));
+            auto const pos = XMVectorScale(normal, radius);
 
-    // Now that we've completed subdivision, fill in the final vertex collection
-    vertices.reserve(vertexPositions.size());
-    for (const auto& it : vertexPositions)
-    {
-        auto const normal = XMVector3Normalize(XMLoadFloat3(&it));
-        auto const pos = XMVectorScale(normal, radius);
+            XMFLOAT3 normalFloat3;
+            XMStoreFloat3(&normalFloat3, normal);
 
-        XMFLOAT3 normalFloat3;
-        XMStoreFloat3(&normalFloat3, normal);
+            // calculate texture coordinates for this vertex
+            const float longitude = atan2f(normalFloat3.x, -normalFloat3.z);
+            const float latitude = acosf(normalFloat3.y);
 
-        // calculate texture coordinates for this vertex
-        const float longitude = atan2f(normalFloat3.x, -normalFloat3.z);
-        const float latitude = acosf(normalFloat3.y);
+            const float u = longitude / XM_2PI + 0.5f;
+            const float v = latitude / XM_PI;
 
-        const float u = longitude / XM_2PI + 0.5f;
-        const float v = latitude / XM_PI;
+            auto const texcoord = XMVectorSet(1.0f - u, v, 0.0f, 0.0f);
+            vertices.push_back(VertexPositionNormalTexture(pos, normal, texcoord));
+        }
 
-        auto const texcoord = XMVectorSet(1.0f - u, v, 0.0f, 0.0f);
-        vertices.push_back(VertexPositionNormalTexture(pos, normal, texcoord));
-    }
+        // There are a couple of fixes to do. One is a texture coordinate wraparound fixup. At some point, there will be
+        // a set of triangles somewhere in the mesh with texture coordinates such that the wraparound across 0.0/1.0
+        // occurs across that triangle. Eg. when the left hand side of the triangle has a U coordinate of 0.98 and the
+        // right hand side has a U coordinate of 0.0. The intent is that such a triangle should render with a U of 0.98 to
+        // 1.0, not 0.98 to 0.0. If we don't do this fixup, there will be a visible seam across one side of the sphere.
+        //
+        // Luckily this is relatively easy to fix. There is a straight edge which runs down the prime meridian of the
+        // completed sphere. If you imagine the vertices along that edge, they circumscribe a semicircular arc starting at
+        // y=1 and ending at y=-1, and sweeping across the range of z=0 to z=1. x stays zero. It's along this edge that we
+        // need to duplicate our vertices - and provide the correct texture coordinates.
+        const size_t preFixupVertexCount = vertices.size();
+
+        // Index of the corrected copy of each vertex on the prime meridian, or zero for the other vertices.
+        std::vector<index_t> meridianCopies(preFixupVertexCount, 0);
+        for (size_t i = 0; i < preFixupVertexCount; ++i)
+        {
+            // This vertex is on the prime meridian if position.x and texcoord.u are both zero (allowing for small epsilon).
+            const bool isOnPrimeMeridian = XMVector2NearEqual(
+                XMVectorSet(vertices[i].position.x, vertices[i].textureCoordinate.x, 0.0f, 0.0f),
+                XMVectorZero(),
+                XMVectorSplatEpsilon());
 
-    // There are a couple of fixes to do. One is a texture coordinate wraparound fixup. At some point, there will be
-    // a set of triangles somewhere in the mesh with texture coordinates such that the wraparound across 0.0/1.0
-    // occurs across that triangle. Eg. when the left hand side of the triangle has a U coordinate of 0.98 and the
-    // right hand side has a U coordinate of 0.0. The intent is that such a triangle should render with a U of 0.98 to
-    // 1.0, not 0.98 to 0.0. If we don't do this fixup, there will be a visible seam across one side of the sphere.
-    //
-    // Luckily this is relatively easy to fix. There is a straight edge which runs down the prime meridian of the
-    // completed sphere. If you imagine the vertices along that edge, they circumscribe a semicircular arc starting at
-    // y=1 and ending at y=-1, and sweeping across the range of z=0 to z=1. x stays zero. It's along this edge that we
-    // need to duplicate our vertices - and provide the correct texture coordinates.
-    const size_t preFixupVertexCount = vertices.size();
-    for (size_t i = 0; i < preFixupVertexCount; ++i)
-    {
-        // This vertex is on the prime meridian if position.x and texcoord.u are both zero (allowing for small epsilon).
-        const bool isOnPrimeMeridian = XMVector2NearEqual(
-            XMVectorSet(vertices[i].position.x, vertices[i].textureCoordinate.x, 0.0f, 0.0f),
-            XMVectorZero(),
-            XMVectorSplatEpsilon());
+            if (isOnPrimeMeridian)
+            {
+                const size_t newIndex = vertices.size(); // the index of this vertex that we're about to add
+                CheckIndexOverflow<index_t>(newIndex);
+
+                // copy this vertex, correct the texture coordinate, and add the vertex
+                VertexPositionNormalTexture v = vertices[i];
+                v.textureCoordinate.x = 1.0f;
+                vertices.push_back(v);
+
+                meridianCopies[i] = static_cast<index_t>(newIndex);
+            }
+        }
 
-        if (isOnPrimeMeridian)
+        // Now update the triangles which use those vertices where necessary. The corners of a triangle that lie on the
+        // meridian are visited in vertex order, each seeing the corrections already made to the others, so the result
+        // is the same as searching the whole index list once per meridian vertex.
+        for (size_t j = 0; j < indices.size(); j += 3)
         {
-            size_t newIndex = vertices.size(); // the index of this vertex that we're about to add
-            CheckIndexOverflow(newIndex);
+            index_t* tri = &indices[j];
 
-            // copy this vertex, correct the texture coordinate, and add the vertex
-            VertexPositionNormalTexture v = vertices[i];
-            v.textureCoordinate.x = 1.0f;
-            vertices.push_back(v);
+            size_t corners[3] = { 0, 1, 2 };
+            std::sort(std::begin(corners), std::end(corners), [tri](size_t a, size_t b) noexcept { return tri[a] < tri[b]; });
 
-            // Now find all the triangles which contain this vertex and update them if necessary
-            for (size_t j = 0; j < indices.size(); j += 3)
+            for (const size_t corner : corners)
             {
-                uint16_t* triIndex0 = &indices[j + 0];
-                uint16_t* triIndex1 = &indices[j + 1];
-                uint16_t* triIndex2 = &indices[j + 2];
-
-                if (*triIndex0 == i)
-                {
-                    // nothing; just keep going
-                }
-                else if (*triIndex1 == i)
-                {
-                    std::swap(triIndex0, triIndex1); // swap the pointers (not the values)
-                }
-                else if (*triIndex2 == i)
-                {
-                    std::swap(triIndex0, triIndex2); // swap the pointers (not the values)
-                }
-                else
+                const size_t i = tri[corner];
+                if (!meridianCopies[i])
                 {
-                    // this triangle doesn't use the vertex we're interested in
+                    // this corner isn't on the meridian
                     continue;
                 }
 
-                // If we got to this point then triIndex0 is the pointer to the index to the vertex we're looking at
-                assert(*triIndex0 == i);
-                assert(*triIndex1 != i && *triIndex2 != i); // assume no degenerate triangles
+                const index_t other0 = tri[(corner + 1) % 3];
+                const index_t other1 = tri[(corner + 2) % 3];
+                assert(other0 != i && other1 != i); // assume no degenerate triangles
 
-                const VertexPositionNormalTexture& v0 = vertices[*triIndex0];
-                const VertexPositionNormalTexture& v1 = vertices[*triIndex1];
-                const VertexPositionNormalTexture& v2 = vertices[*triIndex2];
+                const VertexPositionNormalTexture& v0 = vertices[i];
+                const VertexPositionNormalTexture& v1 = vertices[other0];
+                const VertexPositionNormalTexture& v2 = vertices[other1];
 
                 // check the other two vertices to see if we might need to fix this triangle
 
@@ -457,82 +618,92 @@ void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indi
                     abs(v0.textureCoordinate.x - v2.textureCoordinate.x) > 0.5f)
                 {
                     // yep; replace the specified index to point to the new, corrected vertex
-                    *triIndex0 = static_cast<uint16_t>(newIndex);
+                    tri[corner] = meridianCopies[i];
                 }
             }
         }
-    }
-
-    // And one last fix we need to do: the poles. A common use-case of a sphere mesh is to map a rectangular texture onto
-    // it. If that happens, then the poles become singularities which map the entire top and bottom rows of the texture
-    // onto a single point. In general there's no real way to do that right. But to match the behavior of non-geodesic
-    // spheres, we need to duplicate the pole vertex for every triangle that uses it. This will introduce seams near the
-    // poles, but reduce stretching.
-    auto const fixPole = [&](size_t poleIndex)
-    {
-        const auto& poleVertex = vertices[poleIndex];
-        bool overwrittenPoleVertex = false; // overwriting the original pole vertex saves us one vertex
 
-        for (size_t i = 0; i < indices.size(); i += 3)
+        // And one last fix we need to do: the poles. A common use-case of a sphere mesh is to map a rectangular texture onto
+        // it. If that happens, then the poles become singularities which map the entire top and bottom rows of the texture
+        // onto a single point. In general there's no real way to do that right. But to match the behavior of non-geodesic
+        // spheres, we need to duplicate the pole vertex for every triangle that uses it. This will introduce seams near the
+        // poles, but reduce stretching.
+        auto const fixPole = [&](size_t poleIndex)
         {
-            // These pointers point to the three indices which make up this triangle. pPoleIndex is the pointer to the
-            // entry in the index array which represents the pole index, and the other two pointers point to the other
-            // two indices making up this triangle.
-            uint16_t* pPoleIndex;
-            uint16_t* pOtherIndex0;
-            uint16_t* pOtherIndex1;
-            if (indices[i + 0] == poleIndex)
-            {
-                pPoleIndex = &indices[i + 0];
-                pOtherIndex0 = &indices[i + 1];
-                pOtherIndex1 = &indices[i + 2];
-            }
-            else if (indices[i + 1] == poleIndex)
-            {
-                pPoleIndex = &indices[i + 1];
-                pOtherIndex0 = &indices[i + 2];
-                pOtherIndex1 = &indices[i + 0];
-            }
-            else if (indices[i + 2] == poleIndex)
-            {
-                pPoleIndex = &indices[i + 2];
-                pOtherIndex0 = &indices[i + 0];
-                pOtherIndex1 = &indices[i + 1];
-            }
-            else
+            const auto& poleVertex = vertices[poleIndex];
+            bool overwrittenPoleVertex = false; // overwriting the original pole vertex saves us one vertex
+
+            for (size_t i = 0; i < indices.size(); i += 3)
             {
-                continue;
-            }
+                // These pointers point to the three indices which make up this triangle. pPoleIndex is the pointer to the
+                // entry in the index array which represents the pole index, and the other two pointers point to the other
+                // two indices making up this triangle.
+                index_t* pPoleIndex;
+                index_t* pOtherIndex0;
+                index_t* pOtherIndex1;
+                if (indices[i + 0] == poleIndex)
+                {
+                    pPoleIndex = &indices[i + 0];
+                    pOtherIndex0 = &indices[i + 1];
+                    pOtherIndex1 = &indices[i + 2];
+                }
+                else if (indices[i + 1] == poleIndex)
+                {
+                    pPoleIndex = &indices[i + 1];
+                    pOtherIndex0 = &indices[i + 2];
+                    pOtherIndex1 = &indices[i + 0];
+                }
+                else if (indices[i + 2] == poleIndex)
+                {
+                    pPoleIndex = &indices[i + 2];
+                    pOtherIndex0 = &indices[i + 0];
+                    pOtherIndex1 = &indices[i + 1];
+                }
+                else
+                {
+                    continue;
+                }
 
-            const auto& otherVertex0 = vertices[*pOtherIndex0];
-            const auto& otherVertex1 = vertices[*pOtherIndex1];
+                const auto& otherVertex0 = vertices[*pOtherIndex0];
+                const auto& otherVertex1 = vertices[*pOtherIndex1];
 
-            // Calculate the texcoords for the new pole vertex, add it to the vertices and update the index
-            VertexPositionNormalTexture newPoleVertex = poleVertex;
-            newPoleVertex.textureCoordinate.x = (otherVertex0.textureCoordinate.x + otherVertex1.textureCoordinate.x) / 2;
-            newPoleVertex.textureCoordinate.y = poleVertex.textureCoordinate.y;
+                // Calculate the texcoords for the new pole vertex, add it to the vertices and update the index
+                VertexPositionNormalTexture newPoleVertex = poleVertex;
+                newPoleVertex.textureCoordinate.x = (otherVertex0.textureCoordinate.x + otherVertex1.textureCoordinate.x) / 2;
+                newPoleVertex.textureCoordinate.y = poleVertex.textureCoordinate.y;
 
-            if (!overwrittenPoleVertex)
-            {
-                vertices[poleIndex] = newPoleVertex;
-                overwrittenPoleVertex = true;
-            }
-            else
-            {
-                CheckIndexOverflow(vertices.size());
+                if (!overwrittenPoleVertex)
+                {
+                    vertices[poleIndex] = newPoleVertex;
+                    overwrittenPoleVertex = true;
+                }
+                else
+                {
+                    CheckIndexOverflow<index_t>(vertices.size());
 
-                *pPoleIndex = static_cast<uint16_t>(vertices.size());
-                vertices.push_back(newPoleVertex);
+                    *pPoleIndex = static_cast<index_t>(vertices.size());
+                    vertices.push_back(newPoleVertex);
+                }
             }
-        }
-    };
+        };
 
-    fixPole(northPoleIndex);
-    fixPole(southPoleIndex);
+        fixPole(northPoleIndex);
+        fixPole(southPoleIndex);
 
-    // Build RH above
-    if (!rhcoords)
-        ReverseWinding(indices, vertices);
+        // Build RH above
+        if (!rhcoords)
+            ReverseWinding(indices, vertices);
+    }
+}
+
+void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords)
+{
+    ComputeGeoSphereImpl(vertices, indices, diameter, tessellation, rhcoords);
+}
+
+void DirectX::ComputeGeoSphere(VertexCollection& vertices, IndexCollection32& indices, float diameter, size_t tessellation, bool rhcoords)
+{
+    ComputeGeoSphereImpl(vertices, indices, diameter, tessellation, rhcoords);
 }
 
 
@@ -566,7 +737,8 @@ namespace
 
 
     // Helper creates a triangle fan to close the end of a cylinder / cone
-    void CreateCylinderCap(VertexCollection& vertices, IndexCollection& indices, size_t tessellation, float height, float radius, bool isTop)
+    template<typename index_t>
+    void CreateCylinderCap(VertexCollection& vertices, std::vector<index_t>& indices, size_t tessellation, float height, float radius, bool isTop)
     {
         // Create cap indices.
         for (size_t i = 0; i < tessellation - 2; i++)
@@ -607,169 +779,220 @@ namespace
             vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
         }
     }
-}
 
-void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords)
-{
-    vertices.clear();
-    indices.clear();
 
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
+    template<typename index_t>
+    void ComputeCylinderImpl(VertexCollection& vertices, std::vector<index_t>& indices, float height, float diameter, size_t tessellation, bool rhcoords)
+    {
+        vertices.clear();
+        indices.clear();
+
+        if (tessellation < 3)
+            throw std::invalid_argument("tesselation parameter must be at least 3");
 
-    height /= 2;
+        height /= 2;
 
-    const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
+        const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
 
-    const float radius = diameter / 2;
-    const size_t stride = tessellation + 1;
+        const float radius = diameter / 2;
+        const size_t stride = tessellation + 1;
 
-    // Create a ring of triangles around the outside of the cylinder.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        const XMVECTOR normal = GetCircleVector(i, tessellation);
+        // The sides plus the two caps.
+        vertices.reserve(stride * 2 + tessellation * 2);
+        indices.reserve(stride * 6 + (tessellation - 2) * 6);
+
+        // Create a ring of triangles around the outside of the cylinder.
+        for (size_t i = 0; i <= tessellation; i++)
+        {
+            const XMVECTOR normal = GetCircleVector(i, tessellation);
 
-        const XMVECTOR sideOffset = XMVectorScale(normal, radius);
+            const XMVECTOR sideOffset = XMVectorScale(normal, radius);
 
-        const float u = float(i) / float(tessellation);
+            const float u = float(i) / float(tessellation);
 
-        const XMVECTOR textureCoordinate = XMLoadFloat(&u);
+            const XMVECTOR textureCoordinate = XMLoadFloat(&u);
 
-        vertices.push_back(VertexPositionNormalTexture(XMVectorAdd(sideOffset, topOffset), normal, textureCoordinate));
-        vertices.push_back(VertexPositionNormalTexture(XMVectorSubtract(sideOffset, topOffset), normal, XMVectorAdd(textureCoordinate, g_XMIdentityR1)));
+            vertices.push_back(VertexPositionNormalTexture(XMVectorAdd(sideOffset, topOffset), normal, textureCoordinate));
+            vertices.push_back(VertexPositionNormalTexture(XMVectorSubtract(sideOffset, topOffset), normal, XMVectorAdd(textureCoordinate, g_XMIdentityR1)));
 
-        index_push_back(indices, i * 2);
-        index_push_back(indices, (i * 2 + 2) % (stride * 2));
-        index_push_back(indices, i * 2 + 1);
+            index_push_back(indices, i * 2);
+            index_push_back(indices, (i * 2 + 2) % (stride * 2));
+            index_push_back(indices, i * 2 + 1);
 
-        index_push_back(indices, i * 2 + 1);
-        index_push_back(indices, (i * 2 + 2) % (stride * 2));
-        index_push_back(indices, (i * 2 + 3) % (stride * 2));
+            index_push_back(indices, i * 2 + 1);
+            index_push_back(indices, (i * 2 + 2) % (stride * 2));
+            index_push_back(indices, (i * 2 + 3) % (stride * 2));
+        }
+
+        // Create flat triangle fan caps to seal the top and bottom.
+        CreateCylinderCap(vertices, indices, tessellation, height, radius, true);
+        CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+
+        // Build RH above
+        if (!rhcoords)
+            ReverseWinding(indices, vertices);
     }
+}
 
-    // Create flat triangle fan caps to seal the top and bottom.
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, true);
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection& indices, float height, float diameter, size_t tessellation, bool rhcoords)
+{
+    ComputeCylinderImpl(vertices, indices, height, diameter, tessellation, rhcoords);
+}
 
-    // Build RH above
-    if (!rhcoords)
-        ReverseWinding(indices, vertices);
+void DirectX::ComputeCylinder(VertexCollection& vertices, IndexCollection32& indices, float height, float diameter, size_t tessellation, bool rhcoords)
+{
+    ComputeCylinderImpl(vertices, indices, height, diameter, tessellation, rhcoords);
 }
 
 
-// Creates a cone primitive.
-void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords)
+namespace
 {
-    vertices.clear();
-    indices.clear();
+    // Creates a cone primitive.
+    template<typename index_t>
+    void ComputeConeImpl(VertexCollection& vertices, std::vector<index_t>& indices, float diameter, float height, size_t tessellation, bool rhcoords)
+    {
+        vertices.clear();
+        indices.clear();
 
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
+        if (tessellation < 3)
+            throw std::invalid_argument("tesselation parameter must be at least 3");
 
-    height /= 2;
+        height /= 2;
 
-    const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
+        const XMVECTOR topOffset = XMVectorScale(g_XMIdentityR1, height);
 
-    const float radius = diameter / 2;
-    const size_t stride = tessellation + 1;
+        const float radius = diameter / 2;
+        const size_t stride = tessellation + 1;
 
-    // Create a ring of triangles around the outside of the cone.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        const XMVECTOR circlevec = GetCircleVector(i, tessellation);
+        // The sides plus the bottom cap.
+        vertices.reserve(stride * 2 + tessellation);
+        indices.reserve(stride * 3 + (tessellation - 2) * 3);
 
-        const XMVECTOR sideOffset = XMVectorScale(circlevec, radius);
+        // Create a ring of triangles around the outside of the cone.
+        for (size_t i = 0; i <= tessellation; i++)
+        {
+            const XMVECTOR circlevec = GetCircleVector(i, tessellation);
 
-        const float u = float(i) / float(tessellation);
+            const XMVECTOR sideOffset = XMVectorScale(circlevec, radius);
 
-        const XMVECTOR textureCoordinate = XMLoadFloat(&u);
+            const float u = float(i) / float(tessellation);
 
-        const XMVECTOR pt = XMVectorSubtract(sideOffset, topOffset);
+            const XMVECTOR textureCoordinate = XMLoadFloat(&u);
 
-        XMVECTOR normal = XMVector3Cross(
-            GetCircleTangent(i, tessellation),
-            XMVectorSubtract(topOffset, pt));
-        normal = XMVector3Normalize(normal);
+            const XMVECTOR pt = XMVectorSubtract(sideOffset, topOffset);
 
-        // Duplicate the top vertex for distinct normals
-        vertices.push_back(VertexPositionNormalTexture(topOffset, normal, g_XMZero));
-        vertices.push_back(VertexPositionNormalTexture(pt, normal, XMVectorAdd(textureCoordinate, g_XMIdentityR1)));
+            XMVECTOR normal = XMVector3Cross(
+                GetCircleTangent(i, tessellation),
+                XMVectorSubtract(topOffset, pt));
+            normal = XMVector3Normalize(normal);
 
-        index_push_back(indices, i * 2);
-        index_push_back(indices, (i * 2 + 3) % (stride * 2));
-        index_push_back(indices, (i * 2 + 1) % (stride * 2));
+            // Duplicate the top vertex for distinct normals
+            vertices.push_back(VertexPositionNormalTexture(topOffset, normal, g_XMZero));
+            vertices.push_back(VertexPositionNormalTexture(pt, normal, XMVectorAdd(textureCoordinate, g_XMIdentityR1)));
+
+            index_push_back(indices, i * 2);
+            index_push_back(indices, (i * 2 + 3) % (stride * 2));
+            index_push_back(indices, (i * 2 + 1) % (stride * 2));
+        }
+
+        // Create flat triangle fan caps to seal the bottom.
+        CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+
+        // Build RH above
+        if (!rhcoords)
+            ReverseWinding(indices, vertices);
     }
+}
 
-    // Create flat triangle fan caps to seal the bottom.
-    CreateCylinderCap(vertices, indices, tessellation, height, radius, false);
+void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection& indices, float diameter, float height, size_t tessellation, bool rhcoords)
+{
+    ComputeConeImpl(vertices, indices, diameter, height, tessellation, rhcoords);
+}
 
-    // Build RH above
-    if (!rhcoords)
-        ReverseWinding(indices, vertices);
+void DirectX::ComputeCone(VertexCollection& vertices, IndexCollection32& indices, float diameter, float height, size_t tessellation, bool rhcoords)
+{
+    ComputeConeImpl(vertices, indices, diameter, height, tessellation, rhcoords);
 }
 
 
 //--------------------------------------------------------------------------------------
 // Torus
 //--------------------------------------------------------------------------------------
-void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
+namespace
 {
-    vertices.clear();
-    indices.clear();
+    template<typename index_t>
+    void ComputeTorusImpl(VertexCollection& vertices, std::vector<index_t>& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
+    {
+        vertices.clear();
+        indices.clear();
 
-    if (tessellation < 3)
-        throw std::invalid_argument("tesselation parameter must be at least 3");
+        if (tessellation < 3)
+            throw std::invalid_argument("tesselation parameter must be at least 3");
 
-    const size_t stride = tessellation + 1;
+        const size_t stride = tessellation + 1;
 
-    // First we loop around the main ring of the torus.
-    for (size_t i = 0; i <= tessellation; i++)
-    {
-        const float u = float(i) / float(tessellation);
+        vertices.reserve(stride * stride);
+        indices.reserve(stride * stride * 6);
 
-        const float outerAngle = float(i) * XM_2PI / float(tessellation) - XM_PIDIV2;
+        // First we loop around the main ring of the torus.
+        for (size_t i = 0; i <= tessellation; i++)
+        {
+            const float u = float(i) / float(tessellation);
 
-        // Create a transform matrix that will align geometry to
-        // slice perpendicularly though the current ring position.
-        const XMMATRIX transform = XMMatrixTranslation(diameter / 2, 0, 0) * XMMatrixRotationY(outerAngle);
+            const float outerAngle = float(i) * XM_2PI / float(tessellation) - XM_PIDIV2;
 
-        // Now we loop along the other axis, around the side of the tube.
-        for (size_t j = 0; j <= tessellation; j++)
-        {
-            const float v = 1 - float(j) / float(tessellation);
+            // Create a transform matrix that will align geometry to
+            // slice perpendicularly though the current ring position.
+            const XMMATRIX transform = XMMatrixTranslation(diameter / 2, 0, 0) * XMMatrixRotationY(outerAngle);
 
-            const float innerAngle = float(j) * XM_2PI / float(tessellation) + XM_PI;
-            float dx, dy;
+            // Now we loop along the other axis, around the side of the tube.
+            for (size_t j = 0; j <= tessellation; j++)
+            {
+                const float v = 1 - float(j) / float(tessellation);
 
-            XMScalarSinCos(&dy, &dx, innerAngle);
+                const float innerAngle = float(j) * XM_2PI / float(tessellation) + XM_PI;
+                float dx, dy;
 
-            // Create a vertex.
-            XMVECTOR normal = XMVectorSet(dx, dy, 0, 0);
-            XMVECTOR position = XMVectorScale(normal, thickness / 2);
-            const XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
+                XMScalarSinCos(&dy, &dx, innerAngle);
 
-            position = XMVector3Transform(position, transform);
-            normal = XMVector3TransformNormal(normal, transform);
+                // Create a vertex.
+                XMVECTOR normal = XMVectorSet(dx, dy, 0, 0);
+                XMVECTOR position = XMVectorScale(normal, thickness / 2);
+                const XMVECTOR textureCoordinate = XMVectorSet(u, v, 0, 0);
 
-            vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
+                position = XMVector3Transform(position, transform);
+                normal = XMVector3TransformNormal(normal, transform);
 
-            // And create indices for two triangles.
-            const size_t nextI = (i + 1) % stride;
-            const size_t nextJ = (j + 1) % stride;
+                vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
 
-            index_push_back(indices, i * stride + j);
-            index_push_back(indices, i * stride + nextJ);
-            index_push_back(indices, nextI * stride + j);
+                // And create indices for two triangles.
+                const size_t nextI = (i + 1) % stride;
+                const size_t nextJ = (j + 1) % stride;
 
-            index_push_back(indices, i * stride + nextJ);
-            index_push_back(indices, nextI * stride + nextJ);
-            index_push_back(indices, nextI * stride + j);
+                index_push_back(indices, i * stride + j);
+                index_push_back(indices, i * stride + nextJ);
+                index_push_back(indices, nextI * stride + j);
+
+                index_push_back(indices, i * stride + nextJ);
+                index_push_back(indices, nextI * stride + nextJ);
+                index_push_back(indices, nextI * stride + j);
+            }
         }
+
+        // Build RH above
+        if (!rhcoords)
+            ReverseWinding(indices, vertices);
     }
+}
 
-    // Build RH above
-    if (!rhcoords)
-        ReverseWinding(indices, vertices);
+void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
+{
+    ComputeTorusImpl(vertices, indices, diameter, thickness, tessellation, rhcoords);
+}
+
+void DirectX::ComputeTorus(VertexCollection& vertices, IndexCollection32& indices, float diameter, float thickness, size_t tessellation, bool rhcoords)
+{
+    ComputeTorusImpl(vertices, indices, diameter, thickness, tessellation, rhcoords);
 }
 
 
@@ -1127,7 +1350,8 @@ namespace
 #include "TeapotData.inc"
 
     // Tessellates the specified bezier patch.
-    void XM_CALLCONV TessellatePatch(VertexCollection& vertices, IndexCollection& indices, TeapotPatch const& patch, size_t tessellation, FXMVECTOR scale, bool isMirrored)
+    template<typename index_t>
+    void XM_CALLCONV TessellatePatch(VertexCollection& vertices, std::vector<index_t>& indices, TeapotPatch const& patch, size_t tessellation, FXMVECTOR scale, bool isMirrored)
     {
         // Look up the 16 control points for this patch.
         XMVECTOR controlPoints[16] = {};
@@ -1150,44 +1374,65 @@ namespace
                                         vertices.push_back(VertexPositionNormalTexture(position, normal, textureCoordinate));
                                     });
     }
-}
 
 
-// Creates a teapot primitive.
-void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation, bool rhcoords)
-{
-    vertices.clear();
-    indices.clear();
+    // Creates a teapot primitive.
+    template<typename index_t>
+    void ComputeTeapotImpl(VertexCollection& vertices, std::vector<index_t>& indices, float size, size_t tessellation, bool rhcoords)
+    {
+        vertices.clear();
+        indices.clear();
 
-    if (tessellation < 1)
-        throw std::invalid_argument("tesselation parameter must be non-zero");
+        if (tessellation < 1)
+            throw std::invalid_argument("tesselation parameter must be non-zero");
 
-    const XMVECTOR scaleVector = XMVectorReplicate(size);
+        const XMVECTOR scaleVector = XMVectorReplicate(size);
 
-    const XMVECTOR scaleNegateX = XMVectorMultiply(scaleVector, g_XMNegateX);
-    const XMVECTOR scaleNegateZ = XMVectorMultiply(scaleVector, g_XMNegateZ);
-    const XMVECTOR scaleNegateXZ = XMVectorMultiply(scaleVector, XMVectorMultiply(g_XMNegateX, g_XMNegateZ));
+        const XMVECTOR scaleNegateX = XMVectorMultiply(scaleVector, g_XMNegateX);
+        const XMVECTOR scaleNegateZ = XMVectorMultiply(scaleVector, g_XMNegateZ);
+        const XMVECTOR scaleNegateXZ = XMVectorMultiply(scaleVector, XMVectorMultiply(g_XMNegateX, g_XMNegateZ));
 
-    for (size_t i = 0; i < std::size(TeapotPatches); i++)
-    {
-        TeapotPatch const& patch = TeapotPatches[i];
+        // Every patch is tessellated twice, or four times when also mirrored in Z.
+        size_t patchCount = 0;
+        for (size_t i = 0; i < std::size(TeapotPatches); i++)
+        {
+            patchCount += (TeapotPatches[i].mirrorZ) ? 4 : 2;
+        }
 
-        // Because the teapot is symmetrical from left to right, we only store
-        // data for one side, then tessellate each patch twice, mirroring in X.
-        TessellatePatch(vertices, indices, patch, tessellation, scaleVector, false);
-        TessellatePatch(vertices, indices, patch, tessellation, scaleNegateX, true);
+        vertices.reserve(patchCount * (tessellation + 1) * (tessellation + 1));
+        indices.reserve(patchCount * tessellation * tessellation * 6);
 
-        if (patch.mirrorZ)
+        for (size_t i = 0; i < std::size(TeapotPatches); i++)
         {
-            // Some parts of the teapot (the body, lid, and rim, but not the
-            // handle or spout) are also symmetrical from front to back, so
-            // we tessellate them four times, mirroring in Z as well as X.
-            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateZ, true);
-            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateXZ, false);
+            TeapotPatch const& patch = TeapotPatches[i];
+
+            // Because the teapot is symmetrical from left to right, we only store
+            // data for one side, then tessellate each patch twice, mirroring in X.
+            TessellatePatch(vertices, indices, patch, tessellation, scaleVector, false);
+            TessellatePatch(vertices, indices, patch, tessellation, scaleNegateX, true);
+
+            if (patch.mirrorZ)
+            {
+                // Some parts of the teapot (the body, lid, and rim, but not the
+                // handle or spout) are also symmetrical from front to back, so
+                // we tessellate them four times, mirroring in Z as well as X.
+                TessellatePatch(vertices, indices, patch, tessellation, scaleNegateZ, true);
+                TessellatePatch(vertices, indices, patch, tessellation, scaleNegateXZ, false);
+            }
         }
+
+        // Built RH above
+        if (!rhcoords)
+            ReverseWinding(indices, vertices);
     }
+}
 
-    // Built RH above
-    if (!rhcoords)
-        ReverseWinding(indices, vertices);
+void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation, bool rhcoords)
+{
+    ComputeTeapotImpl(vertices, indices, size, tessellation, rhcoords);
+}
+
+void DirectX::ComputeTeapot(VertexCollection& vertices, IndexCollection32& indices, float size, size_t tessellation, bool rhcoords)
+{
+    ComputeTeapotImpl(vertices, indices, size, tessellation, rhcoords);
 }
@@ -14,6 +14,7 @@ namespace DirectX
 {
     using VertexCollection = std::vector<DirectX::VertexPositionNormalTexture>;
     using IndexCollection = std::vector<uint16_t>;
+    using IndexCollection32 = std::vector<uint32_t>;
 
     void ComputeBox(VertexCollection& vertices, IndexCollection& indices, const XMFLOAT3& size, bool rhcoords, bool invertn);
     void ComputeSphere(VertexCollection& vertices, IndexCollection& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn);
@@ -26,4 +27,12 @@ namespace DirectX
     void ComputeDodecahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords);
     void ComputeIcosahedron(VertexCollection& vertices, IndexCollection& indices, float size, bool rhcoords);
     void ComputeTeapot(VertexCollection& vertices, IndexCollection& indices, float size, size_t tessellation, bool rhcoords);
+
+    // 32-bit index variants for tessellations too fine for 16-bit indices.
+    void ComputeSphere(VertexCollection& vertices, IndexCollection32& indices, float diameter, size_t tessellation, bool rhcoords, bool invertn);
+    void ComputeGeoSphere(VertexCollection& vertices, IndexCollection32& indices, float diameter, size_t tessellation, bool rhcoords);
+    void ComputeCylinder(VertexCollection& vertices, IndexCollection32& indices, float height, float diameter, size_t tessellation, bool rhcoords);
+    void ComputeCone(VertexCollection& vertices, IndexCollection32& indices, float diameter, float height, size_t tessellation, bool rhcoords);
+    void ComputeTorus(VertexCollection& vertices, IndexCollection32& indices, float diameter, float thickness, size_t tessellation, bool rhcoords);
+    void ComputeTeapot(VertexCollection& vertices, IndexCollection32& indices, float size, size_t tessellation, bool rhcoords);
 }
@@ -416,7 +416,9 @@ Model::Model(Model const& other) :
     meshes(other.meshes),
     bones(other.bones),
     name(other.name),
-    mEffectCache(other.mEffectCache)
+    mEffectCache(other.mEffectCache),
+    mBoneOrder(other.mBoneOrder),
+    mBoneOrderCount(other.mBoneOrderCount)
 {
     const size_t nbones = other.bones.size();
     if (nbones > 0)
@@ -445,6 +447,8 @@ Model& Model::operator= (Model const& rhs)
         std::swap(invBindPoseMatrices, tmp.invBindPoseMatrices);
         std::swap(name, tmp.name);
         std::swap(mEffectCache, tmp.mEffectCache);
+        std::swap(mBoneOrder, tmp.mBoneOrder);
+        std::swap(mBoneOrderCount, tmp.mBoneOrderCount);
     }
     return *this;
 }
@@ -586,11 +590,7 @@ void Model::CopyAbsoluteBoneTransformsTo(
         throw std::runtime_error("Model is missing bones");
     }
 
-    memset(boneTransforms, 0, sizeof(XMMATRIX) * nbones);
-
-    const XMMATRIX id = XMMatrixIdentity();
-    size_t visited = 0;
-    ComputeAbsolute(0, id, bones.size(), boneMatrices.get(), boneTransforms, visited);
+    ComputeAbsoluteTransforms(IsBoneEvaluationOrderCurrent(), nbones, boneMatrices.get(), boneTransforms);
 }
 
 
@@ -616,11 +616,152 @@ void Model::CopyAbsoluteBoneTransforms(
         throw std::runtime_error("Model is missing bones");
     }
 
-    memset(outBoneTransforms, 0, sizeof(XMMATRIX) * nbones);
+    ComputeAbsoluteTransforms(IsBoneEvaluationOrderCurrent(), nbones, inBoneTransforms, outBoneTransforms);
+}
+
+
+// Compute using bone hierarchy for a batch of instances, each with its own run of nbones transforms.
+_Use_decl_annotations_
+void Model::CopyAbsoluteBoneTransformsBatch(
+    size_t ninstances,
+    size_t nbones,
+    const XMMATRIX* inBoneTransforms,
+    XMMATRIX* outBoneTransforms) const
+{
+    if (!ninstances || !nbones || !inBoneTransforms || !outBoneTransforms)
+    {
+        throw std::invalid_argument("Bone transforms arrays required");
+    }
+
+    if (nbones < bones.size())
+    {
+        throw std::invalid_argument("Bone transforms arrays are too small");
+    }
+
+    if (bones.empty())
+    {
+        throw std::runtime_error("Model is missing bones");
+    }
+
+    // The hierarchy is validated once for the whole batch, and the order is small enough to stay in cache
+    // while each instance's transforms are walked in turn.
+    const bool useOrder = IsBoneEvaluationOrderCurrent();
+
+    for (size_t j = 0; j < ninstances; ++j)
+    {
+        ComputeAbsoluteTransforms(useOrder, nbones,
+            inBoneTransforms + j * nbones, outBoneTransforms + j * nbones);
+    }
+}
+
+
+// Flatten the bone hierarchy so absolute transforms can be computed without recursion.
+void Model::UpdateBoneEvaluationOrder()
+{
+    mBoneOrder.clear();
+    mBoneOrderCount = 0;
+
+    const size_t nbones = bones.size();
+    if (!nbones)
+        return;
+
+    std::vector<BoneEvaluation> order;
+    order.reserve(nbones);
+
+    std::vector<bool> visited(nbones, false);
+
+    // Visits the bones in the same order as ComputeAbsolute: siblings share the parent's transform, and are
+    // finished before the children which are relative to this bone.
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    stack.emplace_back(0u, static_cast<uint32_t>(ModelBone::c_Invalid));
+    while (!stack.empty())
+    {
+        const uint32_t index = stack.back().first;
+        const uint32_t parent = stack.back().second;
+        stack.pop_back();
+
+        if (index == ModelBone::c_Invalid || index >= nbones)
+            continue;
+
+        if (visited[index])
+        {
+            // The flat order must hold each bone at most once. Leave it empty so ComputeAbsolute handles bones shared
+            // by several parents as before, and reports cycles as an invalid graph.
+            DebugTrace("WARNING: Model::UpdateBoneEvaluationOrder reached bone %u more than once!\n", index);
+            return;
+        }
+        visited[index] = true;
+
+        const ModelBone& bone = bones[index];
+        order.push_back({ index, parent, bone.childIndex, bone.siblingIndex });
+
+        stack.emplace_back(bone.childIndex, index);
+        stack.emplace_back(bone.siblingIndex, parent);
+    }
+
+    mBoneOrder = std::move(order);
+    mBoneOrderCount = nbones;
+}
+
 
-    const XMMATRIX id = XMMatrixIdentity();
-    size_t visited = 0;
-    ComputeAbsolute(0, id, bones.size(), inBoneTransforms, outBoneTransforms, visited);
+// Private helper to check the flattened order still matches the bone hierarchy.
+bool Model::IsBoneEvaluationOrderCurrent() const noexcept
+{
+    if (mBoneOrder.empty() || mBoneOrderCount != bones.size())
+        return false;
+
+    // Only the links of reachable bones affect the traversal
+    for (const auto& it : mBoneOrder)
+    {
+        const ModelBone& bone = bones[it.index];
+        if (bone.childIndex != it.childIndex || bone.siblingIndex != it.siblingIndex)
+            return false;
+    }
+
+    return true;
+}
+
+
+// Private helper for computing hierarchical transforms, using the flattened order if possible.
+_Use_decl_annotations_
+void Model::ComputeAbsoluteTransforms(
+    bool useOrder,
+    size_t nbones,
+    const XMMATRIX* inBoneTransforms,
+    XMMATRIX* outBoneTransforms) const
+{
+    assert(inBoneTransforms != nullptr && outBoneTransforms != nullptr);
+    assert(nbones >= bones.size());
+
+    if (!useOrder)
+    {
+        memset(outBoneTransforms, 0, sizeof(XMMATRIX) * nbones);
+
+        const XMMATRIX id = XMMatrixIdentity();
+        size_t visited = 0;
+        ComputeAbsolute(0, id, bones.size(), inBoneTransforms, outBoneTransforms, visited);
+        return;
+    }
+
+    // The order holds each bone at most once, so it only covers every bone if it is as long as the hierarchy. Bones
+    // which aren't reachable from the root are left zeroed, as with the recursive walk.
+    assert(mBoneOrder.size() <= bones.size());
+    if (mBoneOrder.size() < bones.size())
+    {
+        memset(outBoneTransforms, 0, sizeof(XMMATRIX) * nbones);
+    }
+    else if (nbones > bones.size())
+    {
+        memset(outBoneTransforms + bones.size(), 0, sizeof(XMMATRIX) * (nbones - bones.size()));
+    }
+
+    for (const auto& it : mBoneOrder)
+    {
+        const XMMATRIX local = inBoneTransforms[it.index];
+        outBoneTransforms[it.index] = (it.parent != ModelBone::c_Invalid)
+            ? XMMatrixMultiply(local, outBoneTransforms[it.parent])
+            : local;
+    }
 }
 
 
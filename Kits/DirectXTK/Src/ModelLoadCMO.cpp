@@ -14,146 +14,16 @@
 #include "VertexTypes.h"
 #include "BinaryReader.h"
 #include "PlatformHelpers.h"
+#include "ModelMeshData.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
 
-//--------------------------------------------------------------------------------------
-// .CMO files are built by Visual Studio's MeshContentTask and an example renderer was
-// provided in the VS Direct3D Starter Kit
-// https://devblogs.microsoft.com/cppblog/developing-an-app-with-the-visual-studio-3d-starter-kit-part-1-of-3/
-// https://devblogs.microsoft.com/cppblog/developing-an-app-with-the-visual-studio-3d-starter-kit-part-2-of-3/
-// https://devblogs.microsoft.com/cppblog/developing-an-app-with-the-visual-studio-3d-starter-kit-part-3-of-3/
-//--------------------------------------------------------------------------------------
-
 namespace VSD3DStarter
 {
-    // .CMO files
-
-    // UINT - Mesh count
-    // { [Mesh count]
-    //      UINT - Length of name
-    //      wchar_t[] - Name of mesh (if length > 0)
-    //      UINT - Material count
-    //      { [Material count]
-    //          UINT - Length of material name
-    //          wchar_t[] - Name of material (if length > 0)
-    //          Material structure
-    //          UINT - Length of pixel shader name
-    //          wchar_t[] - Name of pixel shader (if length > 0)
-    //          { [8]
-    //              UINT - Length of texture name
-    //              wchar_t[] - Name of texture (if length > 0)
-    //          }
-    //      }
-    //      BYTE - 1 if there is skeletal animation data present
-    //      UINT - SubMesh count
-    //      { [SubMesh count]
-    //          SubMesh structure
-    //      }
-    //      UINT - IB Count
-    //      { [IB Count]
-    //          UINT - Number of USHORTs in IB
-    //          USHORT[] - Array of indices
-    //      }
-    //      UINT - VB Count
-    //      { [VB Count]
-    //          UINT - Number of verts in VB
-    //          Vertex[] - Array of vertices
-    //      }
-    //      UINT - Skinning VB Count
-    //      { [Skinning VB Count]
-    //          UINT - Number of verts in Skinning VB
-    //          SkinningVertex[] - Array of skinning verts
-    //      }
-    //      MeshExtents structure
-    //      [If skeleton animation data is not present, file ends here]
-    //      UINT - Bone count
-    //      { [Bone count]
-    //          UINT - Length of bone name
-    //          wchar_t[] - Bone name (if length > 0)
-    //          Bone structure
-    //      }
-    //      UINT - Animation clip count
-    //      { [Animation clip count]
-    //          UINT - Length of clip name
-    //          wchar_t[] - Clip name (if length > 0)
-    //          float - Start time
-    //          float - End time
-    //          UINT - Keyframe count
-    //          { [Keyframe count]
-    //              Keyframe structure
-    //          }
-    //      }
-    // }
-
-#pragma pack(push,1)
-
-    struct Material
-    {
-        DirectX::XMFLOAT4   Ambient;
-        DirectX::XMFLOAT4   Diffuse;
-        DirectX::XMFLOAT4   Specular;
-        float               SpecularPower;
-        DirectX::XMFLOAT4   Emissive;
-        DirectX::XMFLOAT4X4 UVTransform;
-    };
-
-    constexpr uint32_t MAX_TEXTURE = 8;
-
-    struct SubMesh
-    {
-        uint32_t MaterialIndex;
-        uint32_t IndexBufferIndex;
-        uint32_t VertexBufferIndex;
-        uint32_t StartIndex;
-        uint32_t PrimCount;
-    };
-
-    constexpr uint32_t NUM_BONE_INFLUENCES = 4;
-
     static_assert(sizeof(VertexPositionNormalTangentColorTexture) == 52, "mismatch with CMO vertex type");
 
-    struct SkinningVertex
-    {
-        uint32_t boneIndex[NUM_BONE_INFLUENCES];
-        float boneWeight[NUM_BONE_INFLUENCES];
-    };
-
-    struct MeshExtents
-    {
-        float CenterX, CenterY, CenterZ;
-        float Radius;
-
-        float MinX, MinY, MinZ;
-        float MaxX, MaxY, MaxZ;
-    };
-
-    struct Bone
-    {
-        int32_t ParentIndex;
-        DirectX::XMFLOAT4X4 InvBindPos;
-        DirectX::XMFLOAT4X4 BindPos;
-        DirectX::XMFLOAT4X4 LocalTransform;
-    };
-
-    struct Clip
-    {
-        float StartTime;
-        float EndTime;
-        uint32_t keys;
-    };
-
-    struct Keyframe
-    {
-        uint32_t BoneIndex;
-        float Time;
-        DirectX::XMFLOAT4X4 Transform;
-    };
-
-#pragma pack(pop)
-
     const Material s_defMaterial =
     {
         { 0.2f, 0.2f, 0.2f, 1.f },
@@ -168,14 +38,6 @@ namespace VSD3DStarter
     };
 } // namespace
 
-static_assert(sizeof(VSD3DStarter::Material) == 132, "CMO Mesh structure size incorrect");
-static_assert(sizeof(VSD3DStarter::SubMesh) == 20, "CMO Mesh structure size incorrect");
-static_assert(sizeof(VSD3DStarter::SkinningVertex) == 32, "CMO Mesh structure size incorrect");
-static_assert(sizeof(VSD3DStarter::MeshExtents) == 40, "CMO Mesh structure size incorrect");
-static_assert(sizeof(VSD3DStarter::Bone) == 196, "CMO Mesh structure size incorrect");
-static_assert(sizeof(VSD3DStarter::Clip) == 12, "CMO Mesh structure size incorrect");
-static_assert(sizeof(VSD3DStarter::Keyframe) == 72, "CMO Mesh structure size incorrect");
-
 namespace
 {
     //----------------------------------------------------------------------------------
@@ -260,186 +122,86 @@ namespace
 //======================================================================================
 
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
-    ID3D11Device* device,
+CMOMeshData DirectX::ParseCMOMeshData(
     const uint8_t* meshData, size_t dataSize,
-    IEffectFactory& fxFactory,
     ModelLoaderFlags flags,
-    size_t* animsOffset)
+    bool findAnimations)
 {
-    if (animsOffset)
-    {
-        *animsOffset = 0;
-    }
+    if (!meshData)
+        throw std::invalid_argument("meshData cannot be null");
 
-    if (!InitOnceExecuteOnce(&g_InitOnce, InitializeDecl, nullptr, nullptr))
-        throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "InitOnceExecuteOnce");
-
-    if (!device || !meshData)
-        throw std::invalid_argument("Device and meshData cannot be null");
+    BinaryReader reader(meshData, dataSize);
 
-    auto fxFactoryDGSL = dynamic_cast<DGSLEffectFactory*>(&fxFactory);
+    auto readString = [&]() -> MeshDataSpan<wchar_t>
+    {
+        auto const nName = reader.Read<uint32_t>();
+        return MeshDataSpan<wchar_t>(reader.ReadArray<wchar_t>(nName), nName);
+    };
 
     // Meshes
-    auto nMesh = reinterpret_cast<const uint32_t*>(meshData);
-    size_t usedSize = sizeof(uint32_t);
-    if (dataSize < usedSize)
-        throw std::runtime_error("End of file");
-
-    if (!*nMesh)
+    auto const nMesh = reader.Read<uint32_t>();
+    if (!nMesh)
         throw std::runtime_error("No meshes found");
 
-    auto model = std::make_unique<Model>();
-
-    for (size_t meshIndex = 0; meshIndex < *nMesh; ++meshIndex)
+    // Counts read from the file only size the containers as their records are read, so a
+    // corrupt count runs into the end of the file rather than a huge allocation
+    CMOMeshData result;
+    for (size_t meshIndex = 0; meshIndex < nMesh; ++meshIndex)
     {
-        // Mesh name
-        auto nName = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-        usedSize += sizeof(uint32_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
-
-        auto meshName = reinterpret_cast<const wchar_t*>(meshData + usedSize);
-
-        usedSize += sizeof(wchar_t)*(*nName);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
-
-        auto mesh = std::make_shared<ModelMesh>();
-        mesh->name.assign(meshName, *nName);
-        mesh->ccw = (flags & ModelLoader_CounterClockwise) != 0;
-        mesh->pmalpha = (flags & ModelLoader_PremultipledAlpha) != 0;
+        CMOMeshData::Mesh mesh = {};
+        mesh.name = readString();
 
         // Materials
-        auto nMats = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-        usedSize += sizeof(uint32_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
+        auto const nMats = reader.Read<uint32_t>();
 
-        std::vector<MaterialRecordCMO> materials;
-        materials.reserve(*nMats);
-        for (size_t j = 0; j < *nMats; ++j)
+        for (size_t j = 0; j < nMats; ++j)
         {
-            MaterialRecordCMO m;
-
-            // Material name
-            nName = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-            usedSize += sizeof(uint32_t);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            auto matName = reinterpret_cast<const wchar_t*>(meshData + usedSize);
-
-            usedSize += sizeof(wchar_t)*(*nName);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            m.name.assign(matName, *nName);
-
-            // Material settings
-            auto matSetting = reinterpret_cast<const VSD3DStarter::Material*>(meshData + usedSize);
-            usedSize += sizeof(VSD3DStarter::Material);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            m.pMaterial = matSetting;
-
-            // Pixel shader name
-            nName = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-            usedSize += sizeof(uint32_t);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            auto psName = reinterpret_cast<const wchar_t*>(meshData + usedSize);
-
-            usedSize += sizeof(wchar_t)*(*nName);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            m.pixelShader.assign(psName, *nName);
+            CMOMeshData::Material m = {};
+            m.name = readString();
+            m.material = &reader.Read<VSD3DStarter::Material>();
+            m.pixelShader = readString();
 
             for (size_t t = 0; t < VSD3DStarter::MAX_TEXTURE; ++t)
             {
-                nName = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-                usedSize += sizeof(uint32_t);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
-
-                auto txtName = reinterpret_cast<const wchar_t*>(meshData + usedSize);
-
-                usedSize += sizeof(wchar_t)*(*nName);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
-
-                m.texture[t].assign(txtName, *nName);
+                m.texture[t] = readString();
             }
 
-            materials.emplace_back(m);
+            mesh.materials.emplace_back(m);
         }
 
-        assert(materials.size() == *nMats);
-
-        if (materials.empty())
+        if (mesh.materials.empty())
         {
             // Add default material if none defined
-            MaterialRecordCMO m;
-            m.pMaterial = &VSD3DStarter::s_defMaterial;
-            m.name = L"Default";
-            materials.emplace_back(m);
+            static const wchar_t s_defName[] = L"Default";
+
+            CMOMeshData::Material m = {};
+            m.name = MeshDataSpan<wchar_t>(s_defName, wcslen(s_defName));
+            m.material = &VSD3DStarter::s_defMaterial;
+            mesh.materials.emplace_back(m);
         }
 
         // Skeletal data?
-        const uint8_t* bSkeleton = meshData + usedSize;
-        usedSize += sizeof(uint8_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
+        mesh.skeleton = reader.Read<uint8_t>() != 0;
 
         // Submeshes
-        auto nSubmesh = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-        usedSize += sizeof(uint32_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
-
-        if (!*nSubmesh)
+        auto const nSubmesh = reader.Read<uint32_t>();
+        if (!nSubmesh)
             throw std::runtime_error("No submeshes found\n");
 
-        auto subMesh = reinterpret_cast<const VSD3DStarter::SubMesh*>(meshData + usedSize);
-        usedSize += sizeof(VSD3DStarter::SubMesh) * (*nSubmesh);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
+        mesh.submeshes = MeshDataSpan<VSD3DStarter::SubMesh>(reader.ReadArray<VSD3DStarter::SubMesh>(nSubmesh), nSubmesh);
 
         // Index buffers
-        auto nIBs = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-        usedSize += sizeof(uint32_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
-
-        if (!*nIBs)
+        auto const nIBs = reader.Read<uint32_t>();
+        if (!nIBs)
             throw std::runtime_error("No index buffers found\n");
 
-        struct IBData
-        {
-            size_t          nIndices;
-            const uint16_t* ptr;
-        };
-
-        std::vector<IBData> ibData;
-        ibData.reserve(*nIBs);
-
-        std::vector<ComPtr<ID3D11Buffer>> ibs;
-        ibs.resize(*nIBs);
-
-        for (size_t j = 0; j < *nIBs; ++j)
+        for (size_t j = 0; j < nIBs; ++j)
         {
-            auto nIndexes = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-            usedSize += sizeof(uint32_t);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            if (!*nIndexes)
+            auto const nIndexes = reader.Read<uint32_t>();
+            if (!nIndexes)
                 throw std::runtime_error("Empty index buffer found\n");
 
-            const uint64_t sizeInBytes = uint64_t(*(nIndexes)) * sizeof(uint16_t);
+            const uint64_t sizeInBytes = uint64_t(nIndexes) * sizeof(uint16_t);
 
             if (sizeInBytes > UINT32_MAX)
                 throw std::runtime_error("IB too large");
@@ -450,167 +212,216 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                     throw std::runtime_error("IB too large for DirectX 11");
             }
 
-            auto const ibBytes = static_cast<size_t>(sizeInBytes);
+            mesh.indexBuffers.emplace_back(reader.ReadArray<uint16_t>(nIndexes), nIndexes);
+        }
 
-            auto indexes = reinterpret_cast<const uint16_t*>(meshData + usedSize);
-            usedSize += ibBytes;
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
+        // Vertex buffers
+        auto const nVBs = reader.Read<uint32_t>();
+        if (!nVBs)
+            throw std::runtime_error("No vertex buffers found\n");
 
-            IBData ib;
-            ib.nIndices = *nIndexes;
-            ib.ptr = indexes;
-            ibData.emplace_back(ib);
+        for (size_t j = 0; j < nVBs; ++j)
+        {
+            auto const nVerts = reader.Read<uint32_t>();
+            if (!nVerts)
+                throw std::runtime_error("Empty vertex buffer found\n");
 
-            D3D11_BUFFER_DESC desc = {};
-            desc.Usage = D3D11_USAGE_DEFAULT;
-            desc.ByteWidth = static_cast<UINT>(ibBytes);
-            desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+            mesh.vertexBuffers.emplace_back(reader.ReadArray<VertexPositionNormalTangentColorTexture>(nVerts), nVerts);
+        }
 
-            D3D11_SUBRESOURCE_DATA initData = { indexes, 0, 0 };
+        // Skinning vertex buffers
+        auto const nSkinVBs = reader.Read<uint32_t>();
+        if (nSkinVBs)
+        {
+            if (nSkinVBs != nVBs)
+                throw std::runtime_error("Number of VBs not equal to number of skin VBs");
 
-            ThrowIfFailed(
-                device->CreateBuffer(&desc, &initData, &ibs[j])
-            );
+            for (size_t j = 0; j < nSkinVBs; ++j)
+            {
+                auto const nVerts = reader.Read<uint32_t>();
+                if (!nVerts)
+                    throw std::runtime_error("Empty skinning vertex buffer found\n");
 
-            SetDebugObjectName(ibs[j].Get(), "ModelCMO");
+                if (mesh.vertexBuffers[j].size() != nVerts)
+                    throw std::runtime_error("Mismatched number of verts for skin VBs");
+
+                mesh.skinningVertexBuffers.emplace_back(reader.ReadArray<VSD3DStarter::SkinningVertex>(nVerts), nVerts);
+            }
         }
 
-        assert(ibData.size() == *nIBs);
-        assert(ibs.size() == *nIBs);
+        // The vertex buffers are expanded to the skinned vertex type when skinning is used
+        const bool enableSkinning = nSkinVBs != 0 && !(flags & ModelLoader_DisableSkinning);
+        const size_t stride = enableSkinning ? sizeof(VertexPositionNormalTangentColorTextureSkinning)
+            : sizeof(VertexPositionNormalTangentColorTexture);
 
-        // Vertex buffers
-        auto nVBs = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-        usedSize += sizeof(uint32_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
+        for (auto& vb : mesh.vertexBuffers)
+        {
+            const uint64_t sizeInBytes = uint64_t(stride) * uint64_t(vb.size());
 
-        if (!*nVBs)
-            throw std::runtime_error("No vertex buffers found\n");
+            if (sizeInBytes > UINT32_MAX)
+                throw std::runtime_error("VB too large");
 
-        struct VBData
+            if (!(flags & ModelLoader_AllowLargeModels))
+            {
+                if (sizeInBytes > uint64_t(D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
+                    throw std::runtime_error("VB too large for DirectX 11");
+            }
+        }
+
+        for (auto& sm : mesh.submeshes)
         {
-            size_t                                          nVerts;
-            const VertexPositionNormalTangentColorTexture*  ptr;
-            const VSD3DStarter::SkinningVertex*             skinPtr;
-        };
-
-        std::vector<VBData> vbData;
-        vbData.reserve(*nVBs);
-        for (size_t j = 0; j < *nVBs; ++j)
+            if ((sm.IndexBufferIndex >= nIBs)
+                || (sm.VertexBufferIndex >= nVBs)
+                || (sm.MaterialIndex >= mesh.materials.size()))
+                throw std::out_of_range("Invalid submesh found\n");
+        }
+
+        // Extents
+        mesh.extents = &reader.Read<VSD3DStarter::MeshExtents>();
+
+        // Bones (if present and requested)
+        if (mesh.skeleton && (flags & ModelLoader_IncludeBones))
         {
-            auto nVerts = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-            usedSize += sizeof(uint32_t);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
+            auto const nBones = reader.Read<uint32_t>();
+            if (!nBones)
+                throw std::runtime_error("Animation bone data is missing\n");
 
-            if (!*nVerts)
-                throw std::runtime_error("Empty vertex buffer found\n");
+            for (size_t j = 0; j < nBones; ++j)
+            {
+                CMOMeshData::Bone bone = {};
+                bone.name = readString();
+                bone.bone = &reader.Read<VSD3DStarter::Bone>();
 
-            const size_t vbBytes = sizeof(VertexPositionNormalTangentColorTexture) * (*(nVerts));
+                if (bone.bone->ParentIndex >= 0)
+                {
+                    if (static_cast<uint32_t>(bone.bone->ParentIndex) >= nBones)
+                        throw std::runtime_error("Skeleton bones corrupt");
+
+                    if (!j)
+                        throw std::runtime_error("First bone must be root!");
+                }
 
-            auto verts = reinterpret_cast<const VertexPositionNormalTangentColorTexture*>(meshData + usedSize);
-            usedSize += vbBytes;
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
+                mesh.bones.emplace_back(bone);
+            }
 
-            VBData vb;
-            vb.nVerts = *nVerts;
-            vb.ptr = verts;
-            vb.skinPtr = nullptr;
-            vbData.emplace_back(vb);
+            // Animation clips
+            if (findAnimations)
+            {
+                auto const& nClips = reader.Read<uint32_t>();
+                if (nClips > 0)
+                {
+                    mesh.animsOffset = static_cast<size_t>(reinterpret_cast<const uint8_t*>(&nClips) - meshData);
+                }
+            }
         }
 
-        assert(vbData.size() == *nVBs);
+        result.meshes.emplace_back(std::move(mesh));
+    }
+
+    return result;
+}
 
-        // Skinning vertex buffers
-        auto nSkinVBs = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-        usedSize += sizeof(uint32_t);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
 
-        if (*nSkinVBs)
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
+    ID3D11Device* device,
+    const uint8_t* meshData, size_t dataSize,
+    IEffectFactory& fxFactory,
+    ModelLoaderFlags flags,
+    size_t* animsOffset)
+{
+    if (animsOffset)
+    {
+        *animsOffset = 0;
+    }
+
+    if (!InitOnceExecuteOnce(&g_InitOnce, InitializeDecl, nullptr, nullptr))
+        throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "InitOnceExecuteOnce");
+
+    if (!device || !meshData)
+        throw std::invalid_argument("Device and meshData cannot be null");
+
+    const CMOMeshData data = ParseCMOMeshData(meshData, dataSize, flags, animsOffset != nullptr);
+
+    auto fxFactoryDGSL = dynamic_cast<DGSLEffectFactory*>(&fxFactory);
+
+    auto model = std::make_unique<Model>();
+    model->meshes.reserve(data.meshes.size());
+
+    for (auto& md : data.meshes)
+    {
+        auto mesh = std::make_shared<ModelMesh>();
+        mesh->name.assign(md.name.data(), md.name.size());
+        mesh->ccw = (flags & ModelLoader_CounterClockwise) != 0;
+        mesh->pmalpha = (flags & ModelLoader_PremultipledAlpha) != 0;
+
+        // Materials
+        std::vector<MaterialRecordCMO> materials;
+        materials.resize(md.materials.size());
+        for (size_t j = 0; j < md.materials.size(); ++j)
         {
-            if (*nSkinVBs != *nVBs)
-                throw std::runtime_error("Number of VBs not equal to number of skin VBs");
+            auto& mdm = md.materials[j];
+            auto& m = materials[j];
+
+            m.pMaterial = mdm.material;
+            m.name.assign(mdm.name.data(), mdm.name.size());
+            m.pixelShader.assign(mdm.pixelShader.data(), mdm.pixelShader.size());
 
-            for (size_t j = 0; j < *nSkinVBs; ++j)
+            for (size_t t = 0; t < VSD3DStarter::MAX_TEXTURE; ++t)
             {
-                auto nVerts = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-                usedSize += sizeof(uint32_t);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
+                m.texture[t].assign(mdm.texture[t].data(), mdm.texture[t].size());
+            }
+        }
 
-                if (!*nVerts)
-                    throw std::runtime_error("Empty skinning vertex buffer found\n");
+        // Index buffers
+        const size_t nIBs = md.indexBuffers.size();
 
-                if (vbData[j].nVerts != *nVerts)
-                    throw std::runtime_error("Mismatched number of verts for skin VBs");
+        std::vector<ComPtr<ID3D11Buffer>> ibs;
+        ibs.resize(nIBs);
+
+        for (size_t j = 0; j < nIBs; ++j)
+        {
+            D3D11_BUFFER_DESC desc = {};
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.ByteWidth = static_cast<UINT>(md.indexBuffers[j].size_bytes());
+            desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
-                const size_t vbBytes = sizeof(VSD3DStarter::SkinningVertex) * (*(nVerts));
+            D3D11_SUBRESOURCE_DATA initData = { md.indexBuffers[j].data(), 0, 0 };
 
-                auto verts = reinterpret_cast<const VSD3DStarter::SkinningVertex*>(meshData + usedSize);
-                usedSize += vbBytes;
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
+            ThrowIfFailed(
+                device->CreateBuffer(&desc, &initData, &ibs[j])
+            );
 
-                vbData[j].skinPtr = verts;
-            }
+            SetDebugObjectName(ibs[j].Get(), "ModelCMO");
         }
 
         // Extents
-        auto extents = reinterpret_cast<const VSD3DStarter::MeshExtents*>(meshData + usedSize);
-        usedSize += sizeof(VSD3DStarter::MeshExtents);
-        if (dataSize < usedSize)
-            throw std::runtime_error("End of file");
-
-        mesh->boundingSphere.Center.x = extents->CenterX;
-        mesh->boundingSphere.Center.y = extents->CenterY;
-        mesh->boundingSphere.Center.z = extents->CenterZ;
-        mesh->boundingSphere.Radius = extents->Radius;
-
-        const XMVECTOR min = XMVectorSet(extents->MinX, extents->MinY, extents->MinZ, 0.f);
-        const XMVECTOR max = XMVectorSet(extents->MaxX, extents->MaxY, extents->MaxZ, 0.f);
+        mesh->boundingSphere.Center.x = md.extents->CenterX;
+        mesh->boundingSphere.Center.y = md.extents->CenterY;
+        mesh->boundingSphere.Center.z = md.extents->CenterZ;
+        mesh->boundingSphere.Radius = md.extents->Radius;
+
+        const XMVECTOR min = XMVectorSet(md.extents->MinX, md.extents->MinY, md.extents->MinZ, 0.f);
+        const XMVECTOR max = XMVectorSet(md.extents->MaxX, md.extents->MaxY, md.extents->MaxZ, 0.f);
         BoundingBox::CreateFromPoints(mesh->boundingBox, min, max);
 
         // Load model bones (if present and requested)
-        if (*bSkeleton && (flags & ModelLoader_IncludeBones))
+        if (!md.bones.empty())
         {
-            // Bones
-            auto nBones = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-            usedSize += sizeof(uint32_t);
-            if (dataSize < usedSize)
-                throw std::runtime_error("End of file");
-
-            if (!*nBones)
-                throw std::runtime_error("Animation bone data is missing\n");
+            const auto nBones = static_cast<uint32_t>(md.bones.size());
 
             ModelBone::Collection bones;
-            bones.resize(*nBones);
-            auto transforms = ModelBone::MakeArray(*nBones);
-            auto invTransforms = ModelBone::MakeArray(*nBones);
+            bones.resize(nBones);
+            auto transforms = ModelBone::MakeArray(nBones);
+            auto invTransforms = ModelBone::MakeArray(nBones);
 
-            for (uint32_t j = 0; j < *nBones; ++j)
+            for (uint32_t j = 0; j < nBones; ++j)
             {
-                // Bone name
-                nName = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-                usedSize += sizeof(uint32_t);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
-
-                auto boneName = reinterpret_cast<const wchar_t*>(meshData + usedSize);
+                auto& boneName = md.bones[j].name;
+                bones[j].name.assign(boneName.data(), wcsnlen(boneName.data(), boneName.size()));
 
-                usedSize += sizeof(wchar_t) * (*nName);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
-
-                bones[j].name = boneName;
-
-                // Bone settings
-                auto cmobones = reinterpret_cast<const VSD3DStarter::Bone*>(meshData + usedSize);
-                usedSize += sizeof(VSD3DStarter::Bone);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
+                auto cmobones = md.bones[j].bone;
 
                 transforms[j] = XMLoadFloat4x4(&cmobones->LocalTransform);
                 invTransforms[j] = XMLoadFloat4x4(&cmobones->InvBindPos);
@@ -624,7 +435,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                     uint32_t index = 0;
                     for (size_t visited = 0;; ++visited)
                     {
-                        if (visited >= *nBones)
+                        if (visited >= nBones)
                             throw std::runtime_error("Skeleton bones form an invalid graph");
 
                         const uint32_t sibling = bones[index].siblingIndex;
@@ -634,21 +445,15 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                             break;
                         }
 
-                        if (sibling >= *nBones)
+                        if (sibling >= nBones)
                             throw std::runtime_error("Skeleton bones corrupt");
 
                         index = sibling;
                     }
                 }
-                else if (static_cast<uint32_t>(cmobones->ParentIndex) >= *nBones)
-                {
-                    throw std::runtime_error("Skeleton bones corrupt");
-                }
                 else
                 {
-                    if (!j)
-                        throw std::runtime_error("First bone must be root!");
-
+                    // The parse has checked the parent is in range and that this isn't the first bone
                     auto index = static_cast<uint32_t>(cmobones->ParentIndex);
 
                     bones[j].parentIndex = index;
@@ -664,7 +469,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                         index = bones[index].childIndex;
                         for (size_t visited = 0;; ++visited)
                         {
-                            if (visited >= *nBones)
+                            if (visited >= nBones)
                                 throw std::runtime_error("Skeleton bones form an invalid graph");
 
                             const uint32_t sibling = bones[index].siblingIndex;
@@ -674,7 +479,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                                 break;
                             }
 
-                            if (sibling >= *nBones)
+                            if (sibling >= nBones)
                                 throw std::runtime_error("Skeleton bones corrupt");
 
                             index = sibling;
@@ -687,50 +492,33 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
             std::swap(model->boneMatrices, transforms);
             std::swap(model->invBindPoseMatrices, invTransforms);
 
-            // Animation Clips
-            if (animsOffset)
-            {
-                // Optional return for offset to start of animation clips in the CMO.
-
-                size_t offset = usedSize;
-
-                auto nClips = reinterpret_cast<const uint32_t*>(meshData + usedSize);
-                usedSize += sizeof(uint32_t);
-                if (dataSize < usedSize)
-                    throw std::runtime_error("End of file");
+            model->UpdateBoneEvaluationOrder();
 
-                if (*nClips > 0)
-                {
-                    *animsOffset = offset;
-                }
+            // Optional return for offset to start of animation clips in the CMO
+            if (animsOffset && md.animsOffset)
+            {
+                *animsOffset = md.animsOffset;
             }
         }
 
-        const bool enableSkinning = (*nSkinVBs) != 0 && !(flags & ModelLoader_DisableSkinning);
+        const bool enableSkinning = !md.skinningVertexBuffers.empty() && !(flags & ModelLoader_DisableSkinning);
 
         // Build vertex buffers
+        const size_t nVBs = md.vertexBuffers.size();
+
         std::vector<ComPtr<ID3D11Buffer>> vbs;
-        vbs.resize(*nVBs);
+        vbs.resize(nVBs);
 
         const size_t stride = enableSkinning ? sizeof(VertexPositionNormalTangentColorTextureSkinning)
             : sizeof(VertexPositionNormalTangentColorTexture);
 
-        for (size_t j = 0; j < *nVBs; ++j)
+        for (size_t j = 0; j < nVBs; ++j)
         {
-            const size_t nVerts = vbData[j].nVerts;
+            auto& vb = md.vertexBuffers[j];
+            const size_t nVerts = vb.size();
 
-            const uint64_t sizeInBytes = uint64_t(stride) * uint64_t(nVerts);
-
-            if (sizeInBytes > UINT32_MAX)
-                throw std::runtime_error("VB too large");
-
-            if (!(flags & ModelLoader_AllowLargeModels))
-            {
-                if (sizeInBytes > uint64_t(D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
-                    throw std::runtime_error("VB too large for DirectX 11");
-            }
-
-            const size_t bytes = static_cast<size_t>(sizeInBytes);
+            // The parse has checked this fits in a buffer
+            const size_t bytes = stride * nVerts;
 
             D3D11_BUFFER_DESC desc = {};
             desc.Usage = D3D11_USAGE_DEFAULT;
@@ -740,7 +528,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
             if (fxFactoryDGSL && !enableSkinning)
             {
                 // Can use CMO vertex data directly
-                D3D11_SUBRESOURCE_DATA initData = { vbData[j].ptr, 0, 0 };
+                D3D11_SUBRESOURCE_DATA initData = { vb.data(), 0, 0 };
 
                 ThrowIfFailed(
                     device->CreateBuffer(&desc, &initData, &vbs[j])
@@ -753,17 +541,17 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                 auto visited = reinterpret_cast<uint32_t*>(temp.get() + bytes);
                 memset(visited, 0xff, sizeof(uint32_t) * nVerts);
 
-                assert(vbData[j].ptr != nullptr);
+                assert(vb.data() != nullptr);
 
                 if (enableSkinning)
                 {
                     // Combine CMO multi-stream data into a single stream
-                    auto skinptr = vbData[j].skinPtr;
+                    auto skinptr = md.skinningVertexBuffers[j].data();
                     assert(skinptr != nullptr);
 
                     uint8_t* ptr = temp.get();
 
-                    auto sptr = vbData[j].ptr;
+                    auto sptr = vb.data();
 
                     for (size_t v = 0; v < nVerts; ++v)
                     {
@@ -778,32 +566,24 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
                 }
                 else
                 {
-                    memcpy(temp.get(), vbData[j].ptr, bytes);
+                    memcpy(temp.get(), vb.data(), bytes);
                 }
 
                 if (!fxFactoryDGSL)
                 {
                     // Need to fix up VB tex coords for UV transform which is not supported by basic effects
-                    for (size_t k = 0; k < *nSubmesh; ++k)
+                    for (auto& sm : md.submeshes)
                     {
-                        auto& sm = subMesh[k];
-
                         if (sm.VertexBufferIndex != j)
                             continue;
 
-                        if ((sm.IndexBufferIndex >= *nIBs)
-                            || (sm.MaterialIndex >= materials.size()))
-                            throw std::out_of_range("Invalid submesh found\n");
-
                         const XMMATRIX uvTransform = XMLoadFloat4x4(&materials[sm.MaterialIndex].pMaterial->UVTransform);
 
-                        auto ib = ibData[sm.IndexBufferIndex].ptr;
-
-                        const size_t count = ibData[sm.IndexBufferIndex].nIndices;
+                        auto& ib = md.indexBuffers[sm.IndexBufferIndex];
 
-                        for (size_t q = 0; q < count; ++q)
+                        for (auto const index : ib)
                         {
-                            size_t v = ib[q];
+                            const size_t v = index;
 
                             if (v >= nVerts)
                                 throw std::out_of_range("Invalid index found\n");
@@ -850,7 +630,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
             SetDebugObjectName(vbs[j].Get(), "ModelCMO");
         }
 
-        assert(vbs.size() == *nVBs);
+        assert(vbs.size() == nVBs);
 
         // Create Effects
         const bool srgb = (flags & ModelLoader_MaterialColorsSRGB) != 0;
@@ -909,15 +689,9 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
         }
 
         // Build mesh parts
-        for (size_t j = 0; j < *nSubmesh; ++j)
+        mesh->meshParts.reserve(md.submeshes.size());
+        for (auto& sm : md.submeshes)
         {
-            auto& sm = subMesh[j];
-
-            if ((sm.IndexBufferIndex >= *nIBs)
-                || (sm.VertexBufferIndex >= *nVBs)
-                || (sm.MaterialIndex >= materials.size()))
-                throw std::out_of_range("Invalid submesh found\n");
-
             auto& mat = materials[sm.MaterialIndex];
 
             auto part = new ModelMeshPart();
@@ -958,9 +732,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
         *animsOffset = 0;
     }
 
-    size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile(szFileName, data, &dataSize);
+    MappedFile file;
+    HRESULT hr = file.Open(szFileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: CreateFromCMO failed (%08X) loading '%ls'\n",
@@ -968,7 +741,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromCMO(
         throw std::runtime_error("CreateFromCMO");
     }
 
-    auto model = CreateFromCMO(device, data.get(), dataSize, fxFactory, flags, animsOffset);
+    auto model = CreateFromCMO(device, file.data(), file.size(), fxFactory, flags, animsOffset);
 
     model->name = szFileName;
 
@@ -14,7 +14,7 @@
 #include "VertexTypes.h"
 #include "BinaryReader.h"
 #include "PlatformHelpers.h"
-#include "SDKMesh.h"
+#include "ModelMeshData.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -366,15 +366,13 @@ namespace
 //======================================================================================
 
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
-    ID3D11Device* d3dDevice,
+SDKMESHMeshData DirectX::ParseSDKMESHMeshData(
     const uint8_t* meshData,
     size_t idataSize,
-    IEffectFactory& fxFactory,
     ModelLoaderFlags flags)
 {
-    if (!d3dDevice || !meshData)
-        throw std::invalid_argument("Device and meshData cannot be null");
+    if (!meshData)
+        throw std::invalid_argument("meshData cannot be null");
 
     const uint64_t dataSize = idataSize;
 
@@ -434,7 +432,10 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         throw std::runtime_error("End of file");
     auto subsetArray = reinterpret_cast<const DXUT::SDKMESH_SUBSET*>(meshData + header->SubsetDataOffset);
 
-    const DXUT::SDKMESH_FRAME* frameArray = nullptr;
+    SDKMESHMeshData result;
+    result.header = header;
+    result.subsets = MeshDataSpan<DXUT::SDKMESH_SUBSET>(subsetArray, header->NumTotalSubsets);
+
     if (header->NumFrames > 0)
     {
         if (dataSize < header->FrameDataOffset
@@ -443,7 +444,9 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
 
         if (flags & ModelLoader_IncludeBones)
         {
-            frameArray = reinterpret_cast<const DXUT::SDKMESH_FRAME*>(meshData + header->FrameDataOffset);
+            result.frames = MeshDataSpan<DXUT::SDKMESH_FRAME>(
+                reinterpret_cast<const DXUT::SDKMESH_FRAME*>(meshData + header->FrameDataOffset),
+                header->NumFrames);
         }
     }
 
@@ -451,15 +454,17 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         || (dataSize < (header->MaterialDataOffset + uint64_t(header->NumMaterials) * sizeof(DXUT::SDKMESH_MATERIAL))))
         throw std::runtime_error("End of file");
 
-    const DXUT::SDKMESH_MATERIAL* materialArray = nullptr;
-    const DXUT::SDKMESH_MATERIAL_V2* materialArray_v2 = nullptr;
     if (header->Version == DXUT::SDKMESH_FILE_VERSION_V2)
     {
-        materialArray_v2 = reinterpret_cast<const DXUT::SDKMESH_MATERIAL_V2*>(meshData + header->MaterialDataOffset);
+        result.materialsV2 = MeshDataSpan<DXUT::SDKMESH_MATERIAL_V2>(
+            reinterpret_cast<const DXUT::SDKMESH_MATERIAL_V2*>(meshData + header->MaterialDataOffset),
+            header->NumMaterials);
     }
     else
     {
-        materialArray = reinterpret_cast<const DXUT::SDKMESH_MATERIAL*>(meshData + header->MaterialDataOffset);
+        result.materials = MeshDataSpan<DXUT::SDKMESH_MATERIAL>(
+            reinterpret_cast<const DXUT::SDKMESH_MATERIAL*>(meshData + header->MaterialDataOffset),
+            header->NumMaterials);
     }
 
     // Buffer data
@@ -469,17 +474,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         throw std::runtime_error("End of file");
     const uint8_t* bufferData = meshData + bufferDataOffset;
 
-    // Create vertex buffers
-    std::vector<ComPtr<ID3D11Buffer>> vbs;
-    vbs.resize(header->NumVertexBuffers);
-
-    std::vector<std::shared_ptr<ModelMeshPart::InputLayoutCollection>> vbDecls;
-    vbDecls.resize(header->NumVertexBuffers);
-
-    std::vector<unsigned int> materialFlags;
-    materialFlags.resize(header->NumVertexBuffers);
-
-    bool dec3nwarning = false;
+    // Vertex buffers
+    result.vertexBuffers.reserve(header->NumVertexBuffers);
     for (size_t j = 0; j < header->NumVertexBuffers; ++j)
     {
         auto& vh = vbArray[j];
@@ -497,8 +493,144 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
             || (dataSize < vh.DataOffset + vh.SizeBytes))
             throw std::runtime_error("End of file");
 
+        SDKMESHMeshData::VertexBuffer vb;
+        vb.header = &vh;
+        vb.data = MeshDataSpan<uint8_t>(bufferData + (vh.DataOffset - bufferDataOffset), static_cast<size_t>(vh.SizeBytes));
+        result.vertexBuffers.emplace_back(vb);
+    }
+
+    // Index buffers
+    result.indexBuffers.reserve(header->NumIndexBuffers);
+    for (size_t j = 0; j < header->NumIndexBuffers; ++j)
+    {
+        auto& ih = ibArray[j];
+
+        if (ih.SizeBytes > UINT32_MAX)
+            throw std::runtime_error("IB too large");
+
+        if (!(flags & ModelLoader_AllowLargeModels))
+        {
+            if (ih.SizeBytes > (D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
+                throw std::runtime_error("IB too large for DirectX 11");
+        }
+
+        if (dataSize < ih.DataOffset
+            || (dataSize < ih.DataOffset + ih.SizeBytes))
+            throw std::runtime_error("End of file");
+
+        if (ih.IndexType != DXUT::IT_16BIT && ih.IndexType != DXUT::IT_32BIT)
+            throw std::runtime_error("Invalid index buffer type found");
+
+        SDKMESHMeshData::IndexBuffer ib;
+        ib.header = &ih;
+        ib.data = MeshDataSpan<uint8_t>(bufferData + (ih.DataOffset - bufferDataOffset), static_cast<size_t>(ih.SizeBytes));
+        result.indexBuffers.emplace_back(ib);
+    }
+
+    // Meshes
+    result.meshes.reserve(header->NumMeshes);
+    for (size_t meshIndex = 0; meshIndex < header->NumMeshes; ++meshIndex)
+    {
+        auto& mh = meshArray[meshIndex];
+
+        if (!mh.NumSubsets
+            || !mh.NumVertexBuffers
+            || mh.IndexBuffer >= header->NumIndexBuffers
+            || mh.VertexBuffers[0] >= header->NumVertexBuffers)
+            throw std::out_of_range("Invalid mesh found");
+
+        // mh.NumVertexBuffers is sometimes not what you'd expect, so we skip validating it
+
+        if (dataSize < mh.SubsetOffset
+            || (dataSize < mh.SubsetOffset + uint64_t(mh.NumSubsets) * sizeof(uint32_t)))
+            throw std::runtime_error("End of file");
+
+        auto subsets = reinterpret_cast<const uint32_t*>(meshData + mh.SubsetOffset);
+
+        SDKMESHMeshData::Mesh mesh;
+        mesh.header = &mh;
+        mesh.subsets = MeshDataSpan<uint32_t>(subsets, mh.NumSubsets);
+
+        if (mh.NumFrameInfluences > 0)
+        {
+            if (dataSize < mh.FrameInfluenceOffset
+                || (dataSize < mh.FrameInfluenceOffset + uint64_t(mh.NumFrameInfluences) * sizeof(uint32_t)))
+                throw std::runtime_error("End of file");
+
+            if (flags & ModelLoader_IncludeBones)
+            {
+                mesh.influences = MeshDataSpan<uint32_t>(
+                    reinterpret_cast<const uint32_t*>(meshData + mh.FrameInfluenceOffset),
+                    mh.NumFrameInfluences);
+            }
+        }
+
+        for (size_t j = 0; j < mh.NumSubsets; ++j)
+        {
+            auto const sIndex = subsets[j];
+            if (sIndex >= header->NumTotalSubsets)
+                throw std::out_of_range("Invalid mesh found");
+
+            auto& subset = subsetArray[sIndex];
+
+            if (subset.PrimitiveType == DXUT::PT_QUAD_PATCH_LIST
+                || subset.PrimitiveType == DXUT::PT_TRIANGLE_PATCH_LIST)
+                throw std::runtime_error("Direct3D9 era tessellation not supported");
+
+            if (subset.PrimitiveType > DXUT::PT_LINE_STRIP_ADJ)
+                throw std::runtime_error("Unknown primitive type");
+
+            if (subset.MaterialID >= header->NumMaterials)
+                throw std::out_of_range("Invalid mesh found");
+        }
+
+        result.meshes.emplace_back(mesh);
+    }
+
+    // Frames
+    for (auto& frame : result.frames)
+    {
+        if (frame.Mesh != DXUT::INVALID_MESH && frame.Mesh >= header->NumMeshes)
+            throw std::out_of_range("Invalid mesh index found in frame data");
+    }
+
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
+    ID3D11Device* d3dDevice,
+    const uint8_t* meshData,
+    size_t idataSize,
+    IEffectFactory& fxFactory,
+    ModelLoaderFlags flags)
+{
+    if (!d3dDevice || !meshData)
+        throw std::invalid_argument("Device and meshData cannot be null");
+
+    const SDKMESHMeshData data = ParseSDKMESHMeshData(meshData, idataSize, flags);
+
+    // Create vertex buffers
+    const size_t nVBs = data.vertexBuffers.size();
+
+    std::vector<ComPtr<ID3D11Buffer>> vbs;
+    vbs.resize(nVBs);
+
+    std::vector<std::shared_ptr<ModelMeshPart::InputLayoutCollection>> vbDecls;
+    vbDecls.resize(nVBs);
+
+    std::vector<unsigned int> materialFlags;
+    materialFlags.resize(nVBs);
+
+    bool dec3nwarning = false;
+    for (size_t j = 0; j < nVBs; ++j)
+    {
+        auto& vb = data.vertexBuffers[j];
+
         vbDecls[j] = std::make_shared<ModelMeshPart::InputLayoutCollection>();
-        unsigned int ilflags = GetInputLayoutDesc(vh.Decl, *vbDecls[j].get());
+        unsigned int ilflags = GetInputLayoutDesc(vb.header->Decl, *vbDecls[j].get());
 
         if (flags & ModelLoader_DisableSkinning)
         {
@@ -516,14 +648,12 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
 
         materialFlags[j] = ilflags;
 
-        auto verts = bufferData + (vh.DataOffset - bufferDataOffset);
-
         D3D11_BUFFER_DESC desc = {};
         desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = static_cast<UINT>(vh.SizeBytes);
+        desc.ByteWidth = static_cast<UINT>(vb.data.size());
         desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 
-        D3D11_SUBRESOURCE_DATA initData = { verts, 0, 0 };
+        D3D11_SUBRESOURCE_DATA initData = { vb.data.data(), 0, 0 };
 
         ThrowIfFailed(
             d3dDevice->CreateBuffer(&desc, &initData, &vbs[j])
@@ -540,36 +670,18 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
 
     // Create index buffers
     std::vector<ComPtr<ID3D11Buffer>> ibs;
-    ibs.resize(header->NumIndexBuffers);
+    ibs.resize(data.indexBuffers.size());
 
-    for (size_t j = 0; j < header->NumIndexBuffers; ++j)
+    for (size_t j = 0; j < data.indexBuffers.size(); ++j)
     {
-        auto& ih = ibArray[j];
-
-        if (ih.SizeBytes > UINT32_MAX)
-            throw std::runtime_error("IB too large");
-
-        if (!(flags & ModelLoader_AllowLargeModels))
-        {
-            if (ih.SizeBytes > (D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * 1024u * 1024u))
-                throw std::runtime_error("IB too large for DirectX 11");
-        }
-
-        if (dataSize < ih.DataOffset
-            || (dataSize < ih.DataOffset + ih.SizeBytes))
-            throw std::runtime_error("End of file");
-
-        if (ih.IndexType != DXUT::IT_16BIT && ih.IndexType != DXUT::IT_32BIT)
-            throw std::runtime_error("Invalid index buffer type found");
-
-        auto indices = bufferData + (ih.DataOffset - bufferDataOffset);
+        auto& ib = data.indexBuffers[j];
 
         D3D11_BUFFER_DESC desc = {};
         desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = static_cast<UINT>(ih.SizeBytes);
+        desc.ByteWidth = static_cast<UINT>(ib.data.size());
         desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
-        D3D11_SUBRESOURCE_DATA initData = { indices, 0, 0 };
+        D3D11_SUBRESOURCE_DATA initData = { ib.data.data(), 0, 0 };
 
         ThrowIfFailed(
             d3dDevice->CreateBuffer(&desc, &initData, &ibs[j])
@@ -580,41 +692,14 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
 
     // Create meshes
     std::vector<MaterialRecordSDKMESH> materials;
-    materials.resize(header->NumMaterials);
+    materials.resize(data.header->NumMaterials);
 
     auto model = std::make_unique<Model>();
-    model->meshes.reserve(header->NumMeshes);
+    model->meshes.reserve(data.meshes.size());
 
-    for (size_t meshIndex = 0; meshIndex < header->NumMeshes; ++meshIndex)
+    for (auto& md : data.meshes)
     {
-        auto& mh = meshArray[meshIndex];
-
-        if (!mh.NumSubsets
-            || !mh.NumVertexBuffers
-            || mh.IndexBuffer >= header->NumIndexBuffers
-            || mh.VertexBuffers[0] >= header->NumVertexBuffers)
-            throw std::out_of_range("Invalid mesh found");
-
-        // mh.NumVertexBuffers is sometimes not what you'd expect, so we skip validating it
-
-        if (dataSize < mh.SubsetOffset
-            || (dataSize < mh.SubsetOffset + uint64_t(mh.NumSubsets) * sizeof(uint32_t)))
-            throw std::runtime_error("End of file");
-
-        auto subsets = reinterpret_cast<const uint32_t*>(meshData + mh.SubsetOffset);
-
-        const uint32_t* influences = nullptr;
-        if (mh.NumFrameInfluences > 0)
-        {
-            if (dataSize < mh.FrameInfluenceOffset
-                || (dataSize < mh.FrameInfluenceOffset + uint64_t(mh.NumFrameInfluences) * sizeof(uint32_t)))
-                throw std::runtime_error("End of file");
-
-            if (flags & ModelLoader_IncludeBones)
-            {
-                influences = reinterpret_cast<const uint32_t*>(meshData + mh.FrameInfluenceOffset);
-            }
-        }
+        auto& mh = *md.header;
 
         auto mesh = std::make_shared<ModelMesh>();
         wchar_t meshName[DXUT::MAX_MESH_NAME] = {};
@@ -628,21 +713,18 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         mesh->boundingBox.Extents = mh.BoundingBoxExtents;
         BoundingSphere::CreateFromBoundingBox(mesh->boundingSphere, mesh->boundingBox);
 
-        if (influences)
+        if (!md.influences.empty())
         {
-            mesh->boneInfluences.resize(mh.NumFrameInfluences);
-            memcpy(mesh->boneInfluences.data(), influences, sizeof(uint32_t) * mh.NumFrameInfluences);
+            mesh->boneInfluences.assign(md.influences.begin(), md.influences.end());
         }
 
         // Create subsets
-        mesh->meshParts.reserve(mh.NumSubsets);
-        for (size_t j = 0; j < mh.NumSubsets; ++j)
-        {
-            auto const sIndex = subsets[j];
-            if (sIndex >= header->NumTotalSubsets)
-                throw std::out_of_range("Invalid mesh found");
+        const size_t vi = mh.VertexBuffers[0];
 
-            auto& subset = subsetArray[sIndex];
+        mesh->meshParts.reserve(md.subsets.size());
+        for (auto const sIndex : md.subsets)
+        {
+            auto& subset = data.subsets[sIndex];
 
             D3D11_PRIMITIVE_TOPOLOGY primType;
             switch (subset.PrimitiveType)
@@ -657,27 +739,18 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
                 case DXUT::PT_LINE_LIST_ADJ:        primType = D3D11_PRIMITIVE_TOPOLOGY_LINELIST_ADJ;       break;
                 case DXUT::PT_LINE_STRIP_ADJ:       primType = D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP_ADJ;      break;
 
-                case DXUT::PT_QUAD_PATCH_LIST:
-                case DXUT::PT_TRIANGLE_PATCH_LIST:
-                    throw std::runtime_error("Direct3D9 era tessellation not supported");
-
                 default:
                     throw std::runtime_error("Unknown primitive type");
             }
 
-            if (subset.MaterialID >= header->NumMaterials)
-                throw std::out_of_range("Invalid mesh found");
-
             auto& mat = materials[subset.MaterialID];
 
             if (!mat.effect)
             {
-                const size_t vi = mh.VertexBuffers[0];
-
-                if (materialArray_v2)
+                if (!data.materialsV2.empty())
                 {
                     LoadMaterial(
-                        materialArray_v2[subset.MaterialID],
+                        data.materialsV2[subset.MaterialID],
                         materialFlags[vi],
                         fxFactory,
                         mat);
@@ -685,7 +758,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
                 else
                 {
                     LoadMaterial(
-                        materialArray[subset.MaterialID],
+                        data.materials[subset.MaterialID],
                         materialFlags[vi],
                         fxFactory,
                         mat,
@@ -696,7 +769,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
             ComPtr<ID3D11InputLayout> il;
             ThrowIfFailed(
                 CreateInputLayoutFromEffect(d3dDevice, mat.effect.get(),
-                    vbDecls[mh.VertexBuffers[0]]->data(), vbDecls[mh.VertexBuffers[0]]->size(), il.GetAddressOf())
+                    vbDecls[vi]->data(), vbDecls[vi]->size(), il.GetAddressOf())
             );
 
             SetDebugObjectName(il.Get(), "ModelSDKMESH");
@@ -707,14 +780,14 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
             part->indexCount = static_cast<uint32_t>(subset.IndexCount);
             part->startIndex = static_cast<uint32_t>(subset.IndexStart);
             part->vertexOffset = static_cast<int32_t>(subset.VertexStart);
-            part->vertexStride = static_cast<uint32_t>(vbArray[mh.VertexBuffers[0]].StrideBytes);
-            part->indexFormat = (ibArray[mh.IndexBuffer].IndexType == DXUT::IT_32BIT) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+            part->vertexStride = static_cast<uint32_t>(data.vertexBuffers[vi].header->StrideBytes);
+            part->indexFormat = (data.indexBuffers[mh.IndexBuffer].header->IndexType == DXUT::IT_32BIT) ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
             part->primitiveType = primType;
             part->inputLayout = il;
             part->indexBuffer = ibs[mh.IndexBuffer];
-            part->vertexBuffer = vbs[mh.VertexBuffers[0]];
+            part->vertexBuffer = vbs[vi];
             part->effect = mat.effect;
-            part->vbDecl = vbDecls[mh.VertexBuffers[0]];
+            part->vbDecl = vbDecls[vi];
 
             mesh->meshParts.emplace_back(part);
         }
@@ -723,36 +796,35 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
     }
 
     // Load model bones (if present and requested)
-    if (frameArray)
+    if (!data.frames.empty())
     {
         static_assert(DXUT::INVALID_FRAME == ModelBone::c_Invalid, "ModelBone invalid type mismatch");
 
+        const auto nFrames = static_cast<uint32_t>(data.frames.size());
+
         ModelBone::Collection bones;
-        bones.reserve(header->NumFrames);
-        auto transforms = ModelBone::MakeArray(header->NumFrames);
+        bones.reserve(nFrames);
+        auto transforms = ModelBone::MakeArray(nFrames);
 
-        for (uint32_t j = 0; j < header->NumFrames; ++j)
+        for (uint32_t j = 0; j < nFrames; ++j)
         {
+            auto& frame = data.frames[j];
+
             ModelBone bone(
-                frameArray[j].ParentFrame,
-                frameArray[j].ChildFrame,
-                frameArray[j].SiblingFrame);
+                frame.ParentFrame,
+                frame.ChildFrame,
+                frame.SiblingFrame);
 
             wchar_t boneName[DXUT::MAX_FRAME_NAME] = {};
-            ASCIIToWChar(boneName, frameArray[j].Name);
+            ASCIIToWChar(boneName, frame.Name);
             bone.name = boneName;
             bones.emplace_back(bone);
 
-            transforms[j] = XMLoadFloat4x4(&frameArray[j].Matrix);
+            transforms[j] = XMLoadFloat4x4(&frame.Matrix);
 
-            const uint32_t index = frameArray[j].Mesh;
+            const uint32_t index = frame.Mesh;
             if (index != DXUT::INVALID_MESH)
             {
-                if (index >= model->meshes.size())
-                {
-                    throw std::out_of_range("Invalid mesh index found in frame data");
-                }
-
                 if (model->meshes[index]->boneIndex == ModelBone::c_Invalid)
                 {
                     // Bind the first bone that links to a given mesh
@@ -762,13 +834,14 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         }
 
         std::swap(model->bones, bones);
+        model->UpdateBoneEvaluationOrder();
 
         // Compute inverse bind pose matrices for the model
-        auto bindPose = ModelBone::MakeArray(header->NumFrames);
-        model->CopyAbsoluteBoneTransforms(header->NumFrames, transforms.get(), bindPose.get());
+        auto bindPose = ModelBone::MakeArray(nFrames);
+        model->CopyAbsoluteBoneTransforms(nFrames, transforms.get(), bindPose.get());
 
-        auto invBoneTransforms = ModelBone::MakeArray(header->NumFrames);
-        for (size_t j = 0; j < header->NumFrames; ++j)
+        auto invBoneTransforms = ModelBone::MakeArray(nFrames);
+        for (size_t j = 0; j < nFrames; ++j)
         {
             invBoneTransforms[j] = XMMatrixInverse(nullptr, bindPose[j]);
         }
@@ -789,9 +862,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
     IEffectFactory& fxFactory,
     ModelLoaderFlags flags)
 {
-    size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile(szFileName, data, &dataSize);
+    MappedFile file;
+    HRESULT hr = file.Open(szFileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: CreateFromSDKMESH failed (%08X) loading '%ls'\n",
@@ -799,7 +871,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromSDKMESH(
         throw std::runtime_error("CreateFromSDKMESH");
     }
 
-    auto model = CreateFromSDKMESH(device, data.get(), dataSize, fxFactory, flags);
+    auto model = CreateFromSDKMESH(device, file.data(), file.size(), fxFactory, flags);
 
     model->name = szFileName;
 
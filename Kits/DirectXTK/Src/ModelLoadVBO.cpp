@@ -14,8 +14,7 @@
 #include "VertexTypes.h"
 #include "BinaryReader.h"
 #include "PlatformHelpers.h"
-
-#include "vbo.h"
+#include "ModelMeshData.h"
 
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
@@ -46,17 +45,12 @@ namespace
 
 //--------------------------------------------------------------------------------------
 _Use_decl_annotations_
-std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
-    ID3D11Device* device,
+VBOMeshData DirectX::ParseVBOMeshData(
     const uint8_t* meshData, size_t dataSize,
-    std::shared_ptr<IEffect> ieffect,
     ModelLoaderFlags flags)
 {
-    if (!InitOnceExecuteOnce(&g_InitOnce, InitializeDecl, nullptr, nullptr))
-        throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "InitOnceExecuteOnce");
-
-    if (!device || !meshData)
-        throw std::invalid_argument("Device and meshData cannot be null");
+    if (!meshData)
+        throw std::invalid_argument("meshData cannot be null");
 
     // File Header
     if (dataSize < sizeof(VBO::header_t))
@@ -100,15 +94,38 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
         throw std::runtime_error("End of file");
     auto indices = reinterpret_cast<const uint16_t*>(meshData + sizeof(VBO::header_t) + vertSize);
 
+    VBOMeshData result;
+    result.vertices = MeshDataSpan<VertexPositionNormalTexture>(verts, header->numVertices);
+    result.indices = MeshDataSpan<uint16_t>(indices, header->numIndices);
+    return result;
+}
+
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_
+std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
+    ID3D11Device* device,
+    const uint8_t* meshData, size_t dataSize,
+    std::shared_ptr<IEffect> ieffect,
+    ModelLoaderFlags flags)
+{
+    if (!InitOnceExecuteOnce(&g_InitOnce, InitializeDecl, nullptr, nullptr))
+        throw std::system_error(std::error_code(static_cast<int>(GetLastError()), std::system_category()), "InitOnceExecuteOnce");
+
+    if (!device || !meshData)
+        throw std::invalid_argument("Device and meshData cannot be null");
+
+    const VBOMeshData data = ParseVBOMeshData(meshData, dataSize, flags);
+
     // Create vertex buffer
     ComPtr<ID3D11Buffer> vb;
     {
         D3D11_BUFFER_DESC desc = {};
         desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = static_cast<UINT>(vertSize);
+        desc.ByteWidth = static_cast<UINT>(data.vertices.size_bytes());
         desc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 
-        D3D11_SUBRESOURCE_DATA initData = { verts, 0, 0 };
+        D3D11_SUBRESOURCE_DATA initData = { data.vertices.data(), 0, 0 };
 
         ThrowIfFailed(
             device->CreateBuffer(&desc, &initData, vb.GetAddressOf())
@@ -122,10 +139,10 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
     {
         D3D11_BUFFER_DESC desc = {};
         desc.Usage = D3D11_USAGE_DEFAULT;
-        desc.ByteWidth = static_cast<UINT>(indexSize);
+        desc.ByteWidth = static_cast<UINT>(data.indices.size_bytes());
         desc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
-        D3D11_SUBRESOURCE_DATA initData = { indices, 0, 0 };
+        D3D11_SUBRESOURCE_DATA initData = { data.indices.data(), 0, 0 };
 
         ThrowIfFailed(
             device->CreateBuffer(&desc, &initData, ib.GetAddressOf())
@@ -153,7 +170,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
     SetDebugObjectName(il.Get(), "ModelVBO");
 
     auto part = new ModelMeshPart();
-    part->indexCount = header->numIndices;
+    part->indexCount = static_cast<uint32_t>(data.indices.size());
     part->startIndex = 0;
     part->vertexStride = static_cast<UINT>(sizeof(VertexPositionNormalTexture));
     part->inputLayout = il;
@@ -165,8 +182,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
     auto mesh = std::make_shared<ModelMesh>();
     mesh->ccw = (flags & ModelLoader_CounterClockwise) != 0;
     mesh->pmalpha = (flags & ModelLoader_PremultipledAlpha) != 0;
-    BoundingSphere::CreateFromPoints(mesh->boundingSphere, header->numVertices, &verts->position, sizeof(VertexPositionNormalTexture));
-    BoundingBox::CreateFromPoints(mesh->boundingBox, header->numVertices, &verts->position, sizeof(VertexPositionNormalTexture));
+    BoundingSphere::CreateFromPoints(mesh->boundingSphere, data.vertices.size(), &data.vertices.data()->position, sizeof(VertexPositionNormalTexture));
+    BoundingBox::CreateFromPoints(mesh->boundingBox, data.vertices.size(), &data.vertices.data()->position, sizeof(VertexPositionNormalTexture));
     mesh->meshParts.emplace_back(part);
 
     auto model = std::make_unique<Model>();
@@ -184,9 +201,8 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
     std::shared_ptr<IEffect> ieffect,
     ModelLoaderFlags flags)
 {
-    size_t dataSize = 0;
-    std::unique_ptr<uint8_t[]> data;
-    HRESULT hr = BinaryReader::ReadEntireFile(szFileName, data, &dataSize);
+    MappedFile file;
+    HRESULT hr = file.Open(szFileName);
     if (FAILED(hr))
     {
         DebugTrace("ERROR: CreateFromVBO failed (%08X) loading '%ls'\n",
@@ -194,7 +210,7 @@ std::unique_ptr<Model> DirectX::Model::CreateFromVBO(
         throw std::runtime_error("CreateFromVBO");
     }
 
-    auto model = CreateFromVBO(device, data.get(), dataSize, ieffect, flags);
+    auto model = CreateFromVBO(device, file.data(), file.size(), ieffect, flags);
 
     model->name = szFileName;
 
@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------------------
+// File: ModelMeshData.h
+//
+// CPU-side descriptions of the model file formats. Parsing a file validates all of its
+// headers, counts and offsets up front, and describes the vertices, indices, subsets
+// and bones as views into the file data rather than copies, so the data (usually a
+// MappedFile) must outlive the description.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "Model.h"
+#include "VertexTypes.h"
+
+#include "CMO.h"
+#include "SDKMesh.h"
+#include "vbo.h"
+
+
+namespace DirectX
+{
+    // Read-only run of elements inside the file data.
+    template<typename T>
+    class MeshDataSpan
+    {
+    public:
+        MeshDataSpan() noexcept : mData(nullptr), mCount(0) {}
+        MeshDataSpan(_In_reads_opt_(count) T const* data, size_t count) noexcept : mData(data), mCount(count) {}
+
+        T const* data() const noexcept { return mData; }
+        size_t size() const noexcept { return mCount; }
+        size_t size_bytes() const noexcept { return mCount * sizeof(T); }
+        bool empty() const noexcept { return !mCount; }
+
+        T const* begin() const noexcept { return mData; }
+        T const* end() const noexcept { return mData + mCount; }
+
+        T const& operator[](size_t index) const noexcept
+        {
+            assert(index < mCount);
+            return mData[index];
+        }
+
+    private:
+        T const* mData;
+        size_t mCount;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // .VBO: one mesh with a single subset
+    struct VBOMeshData
+    {
+        MeshDataSpan<VertexPositionNormalTexture>   vertices;
+        MeshDataSpan<uint16_t>                      indices;
+    };
+
+    VBOMeshData __cdecl ParseVBOMeshData(
+        _In_reads_bytes_(dataSize) const uint8_t* meshData, size_t dataSize,
+        ModelLoaderFlags flags);
+
+
+    //----------------------------------------------------------------------------------
+    // .SDKMESH: every index that links the records together is range checked, so the
+    // consumer can follow them without further checks
+    struct SDKMESHMeshData
+    {
+        struct VertexBuffer
+        {
+            const DXUT::SDKMESH_VERTEX_BUFFER_HEADER*   header;
+            MeshDataSpan<uint8_t>                       data;
+        };
+
+        struct IndexBuffer
+        {
+            const DXUT::SDKMESH_INDEX_BUFFER_HEADER*    header;
+            MeshDataSpan<uint8_t>                       data;
+        };
+
+        struct Mesh
+        {
+            const DXUT::SDKMESH_MESH*   header;
+            MeshDataSpan<uint32_t>      subsets;        // Indices into SDKMESHMeshData::subsets
+            MeshDataSpan<uint32_t>      influences;     // Frame influences, only with ModelLoader_IncludeBones
+        };
+
+        const DXUT::SDKMESH_HEADER*                 header;
+        std::vector<VertexBuffer>                   vertexBuffers;
+        std::vector<IndexBuffer>                    indexBuffers;
+        std::vector<Mesh>                           meshes;
+        MeshDataSpan<DXUT::SDKMESH_SUBSET>          subsets;
+        MeshDataSpan<DXUT::SDKMESH_FRAME>           frames;         // Only with ModelLoader_IncludeBones
+        MeshDataSpan<DXUT::SDKMESH_MATERIAL>        materials;      // Version 1 files
+        MeshDataSpan<DXUT::SDKMESH_MATERIAL_V2>     materialsV2;    // Version 2 files
+    };
+
+    SDKMESHMeshData __cdecl ParseSDKMESHMeshData(
+        _In_reads_bytes_(dataSize) const uint8_t* meshData, size_t dataSize,
+        ModelLoaderFlags flags);
+
+
+    //----------------------------------------------------------------------------------
+    // .CMO: a sequence of self-contained meshes, each with its own materials and buffers
+    struct CMOMeshData
+    {
+        struct Material
+        {
+            MeshDataSpan<wchar_t>               name;
+            const VSD3DStarter::Material*       material;
+            MeshDataSpan<wchar_t>               pixelShader;
+            MeshDataSpan<wchar_t>               texture[VSD3DStarter::MAX_TEXTURE];
+        };
+
+        struct Bone
+        {
+            MeshDataSpan<wchar_t>               name;
+            const VSD3DStarter::Bone*           bone;
+        };
+
+        struct Mesh
+        {
+            MeshDataSpan<wchar_t>                                                   name;
+            std::vector<Material>                                                   materials;
+            bool                                                                    skeleton;
+            MeshDataSpan<VSD3DStarter::SubMesh>                                     submeshes;
+            std::vector<MeshDataSpan<uint16_t>>                                     indexBuffers;
+            std::vector<MeshDataSpan<VertexPositionNormalTangentColorTexture>>      vertexBuffers;
+            std::vector<MeshDataSpan<VSD3DStarter::SkinningVertex>>                 skinningVertexBuffers;  // Empty, or one per vertex buffer
+            const VSD3DStarter::MeshExtents*                                        extents;
+            std::vector<Bone>                                                       bones;                  // Only with ModelLoader_IncludeBones
+            size_t                                                                  animsOffset;            // Offset of the animation clips, if requested and present
+        };
+
+        std::vector<Mesh>   meshes;
+    };
+
+    CMOMeshData __cdecl ParseCMOMeshData(
+        _In_reads_bytes_(dataSize) const uint8_t* meshData, size_t dataSize,
+        ModelLoaderFlags flags,
+        bool findAnimations = false);
+}
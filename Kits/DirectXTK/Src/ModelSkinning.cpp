@@ -0,0 +1,469 @@
+//--------------------------------------------------------------------------------------
+// File: ModelSkinning.cpp
+//
+// CPU evaluation of the SkinnedEffect vertex skinning
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248929
+//--------------------------------------------------------------------------------------
+
+#include "pch.h"
+#include "Model.h"
+#include "VertexTypes.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+    // Vertices are handed out to worker threads in runs of this many
+    constexpr size_t c_SkinningChunkSize = 1024;
+
+    // Blends the bone palette exactly as Skinning.fxh does, with out of range bones contributing nothing.
+    inline XMMATRIX XM_CALLCONV BlendBones(
+        uint32_t indices,
+        uint32_t weights,
+        size_t nbones,
+        _In_reads_(nbones) const XMMATRIX* boneTransforms) noexcept
+    {
+        XMMATRIX skinning;
+        skinning.r[0] = skinning.r[1] = skinning.r[2] = skinning.r[3] = XMVectorZero();
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            size_t index = (indices >> (j * 8)) & 0xff;
+            float weight = static_cast<float>((weights >> (j * 8)) & 0xff) * (1.f / 255.f);
+            if (index >= nbones)
+            {
+                index = 0;
+                weight = 0.f;
+            }
+
+            const XMVECTOR w = XMVectorReplicate(weight);
+            const XMMATRIX& bone = boneTransforms[index];
+            skinning.r[0] = XMVectorMultiplyAdd(bone.r[0], w, skinning.r[0]);
+            skinning.r[1] = XMVectorMultiplyAdd(bone.r[1], w, skinning.r[1]);
+            skinning.r[2] = XMVectorMultiplyAdd(bone.r[2], w, skinning.r[2]);
+            skinning.r[3] = XMVectorMultiplyAdd(bone.r[3], w, skinning.r[3]);
+        }
+
+        return skinning;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Several vertices are skinned at once by transposing them so that each vector holds
+    // one component for every vertex. The palette is still blended per vertex, as gathering
+    // the bone rows for each lane costs more than it saves, but the blended matrices are
+    // transposed too so each transform runs across all the lanes. The operations are
+    // ordered as in XMVector3Transform and XMVector3Normalize, so results match the scalar
+    // path up to the dot product used by the normalize on SSE4.
+    //----------------------------------------------------------------------------------
+
+    // Transposes the xyz of four vectors into one vector per component.
+    inline void XM_CALLCONV Transpose3(
+        FXMVECTOR v0, FXMVECTOR v1, FXMVECTOR v2, GXMVECTOR v3,
+        _Out_ XMVECTOR* x, _Out_ XMVECTOR* y, _Out_ XMVECTOR* z) noexcept
+    {
+        const XMVECTOR t0 = XMVectorMergeXY(v0, v2);
+        const XMVECTOR t1 = XMVectorMergeXY(v1, v3);
+        const XMVECTOR t2 = XMVectorMergeZW(v0, v2);
+        const XMVECTOR t3 = XMVectorMergeZW(v1, v3);
+
+        *x = XMVectorMergeXY(t0, t1);
+        *y = XMVectorMergeZW(t0, t1);
+        *z = XMVectorMergeXY(t2, t3);
+    }
+
+    // Interleaves four vectors of x, y and z back into four consecutive XMFLOAT3.
+    inline void XM_CALLCONV StoreFloat3x4(_Out_writes_(4) XMFLOAT3* dest, FXMVECTOR x, FXMVECTOR y, FXMVECTOR z) noexcept
+    {
+        const XMVECTOR xy01 = XMVectorMergeXY(x, y);
+        const XMVECTOR xy23 = XMVectorMergeZW(x, y);
+
+        auto out = reinterpret_cast<XMFLOAT4*>(dest);
+        XMStoreFloat4(out, XMVectorPermute<0, 1, 4, 2>(xy01, z));
+        XMStoreFloat4(out + 1, XMVectorPermute<0, 1, 4, 5>(XMVectorPermute<3, 5, 3, 5>(xy01, z), xy23));
+        XMStoreFloat4(out + 2, XMVectorPermute<6, 2, 3, 7>(xy23, z));
+    }
+
+    // Skins four consecutive vertices.
+    void SkinGroup4(
+        const SkinningJob& job,
+        _In_reads_(4) const VertexPositionNormalTangentColorTextureSkinning* vertex,
+        _Out_writes_(4) XMFLOAT3* position,
+        _Out_writes_opt_(4) XMFLOAT3* normal) noexcept
+    {
+        XMMATRIX skinning[4];
+        for (size_t k = 0; k < 4; ++k)
+        {
+            skinning[k] = BlendBones(vertex[k].indices, vertex[k].weights, job.boneCount, job.boneTransforms);
+        }
+
+        XMVECTOR m[4][3];
+        for (size_t r = 0; r < 4; ++r)
+        {
+            Transpose3(skinning[0].r[r], skinning[1].r[r], skinning[2].r[r], skinning[3].r[r], &m[r][0], &m[r][1], &m[r][2]);
+        }
+
+        XMVECTOR x, y, z;
+        Transpose3(
+            XMLoadFloat3(&vertex[0].position), XMLoadFloat3(&vertex[1].position),
+            XMLoadFloat3(&vertex[2].position), XMLoadFloat3(&vertex[3].position),
+            &x, &y, &z);
+
+        XMVECTOR result[3];
+        for (size_t c = 0; c < 3; ++c)
+        {
+            result[c] = XMVectorMultiplyAdd(z, m[2][c], m[3][c]);
+            result[c] = XMVectorMultiplyAdd(y, m[1][c], result[c]);
+            result[c] = XMVectorMultiplyAdd(x, m[0][c], result[c]);
+        }
+
+        StoreFloat3x4(position, result[0], result[1], result[2]);
+
+        if (!normal)
+            return;
+
+        Transpose3(
+            XMLoadFloat3(&vertex[0].normal), XMLoadFloat3(&vertex[1].normal),
+            XMLoadFloat3(&vertex[2].normal), XMLoadFloat3(&vertex[3].normal),
+            &x, &y, &z);
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            result[c] = XMVectorMultiply(z, m[2][c]);
+            result[c] = XMVectorMultiplyAdd(y, m[1][c], result[c]);
+            result[c] = XMVectorMultiplyAdd(x, m[0][c], result[c]);
+        }
+
+        // Zero length normals come out as zero and infinite ones as QNaN, as from XMVector3Normalize
+        const XMVECTOR lengthSq = XMVectorAdd(
+            XMVectorAdd(XMVectorMultiply(result[0], result[0]), XMVectorMultiply(result[1], result[1])),
+            XMVectorMultiply(result[2], result[2]));
+        const XMVECTOR length = XMVectorSqrt(lengthSq);
+        const XMVECTOR nonZero = XMVectorNotEqual(length, XMVectorZero());
+        const XMVECTOR finite = XMVectorNotEqual(lengthSq, g_XMInfinity);
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            result[c] = XMVectorAndInt(XMVectorDivide(result[c], length), nonZero);
+            result[c] = XMVectorSelect(g_XMQNaN, result[c], finite);
+        }
+
+        StoreFloat3x4(normal, result[0], result[1], result[2]);
+    }
+
+#ifdef _XM_AVX_INTRINSICS_
+    inline __m256 MultiplyAdd8(__m256 a, __m256 b, __m256 c) noexcept
+    {
+    #ifdef _XM_FMA3_INTRINSICS_
+        return _mm256_fmadd_ps(a, b, c);
+    #else
+        return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+    #endif
+    }
+
+    // As BlendBones, but two matrix rows at a time.
+    inline XMMATRIX BlendBones8(
+        uint32_t indices,
+        uint32_t weights,
+        size_t nbones,
+        _In_reads_(nbones) const XMMATRIX* boneTransforms) noexcept
+    {
+        __m256 r01 = _mm256_setzero_ps();
+        __m256 r23 = _mm256_setzero_ps();
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            size_t index = (indices >> (j * 8)) & 0xff;
+            float weight = static_cast<float>((weights >> (j * 8)) & 0xff) * (1.f / 255.f);
+            if (index >= nbones)
+            {
+                index = 0;
+                weight = 0.f;
+            }
+
+            const __m256 w = _mm256_set1_ps(weight);
+            auto bone = reinterpret_cast<const float*>(&boneTransforms[index]);
+            r01 = MultiplyAdd8(_mm256_loadu_ps(bone), w, r01);
+            r23 = MultiplyAdd8(_mm256_loadu_ps(bone + 8), w, r23);
+        }
+
+        XMMATRIX skinning;
+        skinning.r[0] = _mm256_castps256_ps128(r01);
+        skinning.r[1] = _mm256_extractf128_ps(r01, 1);
+        skinning.r[2] = _mm256_castps256_ps128(r23);
+        skinning.r[3] = _mm256_extractf128_ps(r23, 1);
+        return skinning;
+    }
+
+    // Transposes the xyz of eight vectors, with lanes 0-3 in the low half and 4-7 in the high half.
+    inline void Transpose3x8(
+        _In_reads_(8) const XMVECTOR* v,
+        _Out_ __m256* x, _Out_ __m256* y, _Out_ __m256* z) noexcept
+    {
+        const __m256 a0 = _mm256_insertf128_ps(_mm256_castps128_ps256(v[0]), v[4], 1);
+        const __m256 a1 = _mm256_insertf128_ps(_mm256_castps128_ps256(v[1]), v[5], 1);
+        const __m256 a2 = _mm256_insertf128_ps(_mm256_castps128_ps256(v[2]), v[6], 1);
+        const __m256 a3 = _mm256_insertf128_ps(_mm256_castps128_ps256(v[3]), v[7], 1);
+
+        const __m256 t0 = _mm256_unpacklo_ps(a0, a2);
+        const __m256 t1 = _mm256_unpacklo_ps(a1, a3);
+        const __m256 t2 = _mm256_unpackhi_ps(a0, a2);
+        const __m256 t3 = _mm256_unpackhi_ps(a1, a3);
+
+        *x = _mm256_unpacklo_ps(t0, t1);
+        *y = _mm256_unpackhi_ps(t0, t1);
+        *z = _mm256_unpacklo_ps(t2, t3);
+    }
+
+    inline void StoreFloat3x8(_Out_writes_(8) XMFLOAT3* dest, __m256 x, __m256 y, __m256 z) noexcept
+    {
+        StoreFloat3x4(dest, _mm256_castps256_ps128(x), _mm256_castps256_ps128(y), _mm256_castps256_ps128(z));
+        StoreFloat3x4(dest + 4, _mm256_extractf128_ps(x, 1), _mm256_extractf128_ps(y, 1), _mm256_extractf128_ps(z, 1));
+    }
+
+    // Skins eight consecutive vertices.
+    void SkinGroup8(
+        const SkinningJob& job,
+        _In_reads_(8) const VertexPositionNormalTangentColorTextureSkinning* vertex,
+        _Out_writes_(8) XMFLOAT3* position,
+        _Out_writes_opt_(8) XMFLOAT3* normal) noexcept
+    {
+        XMMATRIX skinning[8];
+        for (size_t k = 0; k < 8; ++k)
+        {
+            skinning[k] = BlendBones8(vertex[k].indices, vertex[k].weights, job.boneCount, job.boneTransforms);
+        }
+
+        XMVECTOR v[8];
+        __m256 m[4][3];
+        for (size_t r = 0; r < 4; ++r)
+        {
+            for (size_t k = 0; k < 8; ++k)
+            {
+                v[k] = skinning[k].r[r];
+            }
+            Transpose3x8(v, &m[r][0], &m[r][1], &m[r][2]);
+        }
+
+        __m256 x, y, z;
+        for (size_t k = 0; k < 8; ++k)
+        {
+            v[k] = XMLoadFloat3(&vertex[k].position);
+        }
+        Transpose3x8(v, &x, &y, &z);
+
+        __m256 result[3];
+        for (size_t c = 0; c < 3; ++c)
+        {
+            result[c] = MultiplyAdd8(z, m[2][c], m[3][c]);
+            result[c] = MultiplyAdd8(y, m[1][c], result[c]);
+            result[c] = MultiplyAdd8(x, m[0][c], result[c]);
+        }
+
+        StoreFloat3x8(position, result[0], result[1], result[2]);
+
+        if (!normal)
+            return;
+
+        for (size_t k = 0; k < 8; ++k)
+        {
+            v[k] = XMLoadFloat3(&vertex[k].normal);
+        }
+        Transpose3x8(v, &x, &y, &z);
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            result[c] = _mm256_mul_ps(z, m[2][c]);
+            result[c] = MultiplyAdd8(y, m[1][c], result[c]);
+            result[c] = MultiplyAdd8(x, m[0][c], result[c]);
+        }
+
+        const __m256 lengthSq = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(result[0], result[0]), _mm256_mul_ps(result[1], result[1])),
+            _mm256_mul_ps(result[2], result[2]));
+        const __m256 length = _mm256_sqrt_ps(lengthSq);
+        const __m256 nonZero = _mm256_cmp_ps(length, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+        const __m256 finite = _mm256_cmp_ps(lengthSq, _mm256_castsi256_ps(_mm256_set1_epi32(0x7F800000)), _CMP_NEQ_UQ);
+        const __m256 qnan = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FC00000));
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            result[c] = _mm256_and_ps(_mm256_div_ps(result[c], length), nonZero);
+            result[c] = _mm256_blendv_ps(qnan, result[c], finite);
+        }
+
+        StoreFloat3x8(normal, result[0], result[1], result[2]);
+    }
+#endif // _XM_AVX_INTRINSICS_
+
+    void SkinRange(
+        const SkinningJob& job,
+        size_t first,
+        size_t count) noexcept
+    {
+        assert(first + count <= job.vertexCount);
+
+        const VertexPositionNormalTangentColorTextureSkinning* vertex = job.vertices + first;
+        XMFLOAT3* position = job.positions + first;
+        XMFLOAT3* normal = (job.normals) ? (job.normals + first) : nullptr;
+
+        size_t j = 0;
+
+    #ifdef _XM_AVX_INTRINSICS_
+        for (; j + 8 <= count; j += 8)
+        {
+            SkinGroup8(job, vertex + j, position + j, (normal) ? (normal + j) : nullptr);
+        }
+    #endif
+
+        for (; j + 4 <= count; j += 4)
+        {
+            SkinGroup4(job, vertex + j, position + j, (normal) ? (normal + j) : nullptr);
+        }
+
+        for (; j < count; ++j)
+        {
+            const XMMATRIX skinning = BlendBones(vertex[j].indices, vertex[j].weights, job.boneCount, job.boneTransforms);
+
+            XMStoreFloat3(&position[j], XMVector3Transform(XMLoadFloat3(&vertex[j].position), skinning));
+
+            if (normal)
+            {
+                const XMVECTOR n = XMVector3TransformNormal(XMLoadFloat3(&vertex[j].normal), skinning);
+                XMStoreFloat3(&normal[j], XMVector3Normalize(n));
+            }
+        }
+    }
+
+    void ValidateJob(const SkinningJob& job)
+    {
+        if (!job.vertexCount)
+            return;
+
+        if (!job.vertices || !job.positions)
+        {
+            throw std::invalid_argument("Skinning requires vertices and a position array");
+        }
+
+        if (!job.boneCount || !job.boneTransforms)
+        {
+            throw std::invalid_argument("Bone transforms array required");
+        }
+    }
+}
+
+
+// Skins a single vertex buffer on the calling thread.
+_Use_decl_annotations_
+void DirectX::SkinVertices(
+    size_t nverts,
+    const VertexPositionNormalTangentColorTextureSkinning* vertices,
+    size_t nbones,
+    const XMMATRIX* boneTransforms,
+    XMFLOAT3* positions,
+    XMFLOAT3* normals)
+{
+    SkinningJob job = {};
+    job.vertices = vertices;
+    job.vertexCount = nverts;
+    job.boneTransforms = boneTransforms;
+    job.boneCount = nbones;
+    job.positions = positions;
+    job.normals = normals;
+
+    ValidateJob(job);
+
+    SkinRange(job, 0, nverts);
+}
+
+
+// Skins a batch of vertex buffers, sharing runs of vertices from all of them across threads.
+_Use_decl_annotations_
+void DirectX::SkinVertices(
+    size_t njobs,
+    const SkinningJob* jobs,
+    unsigned int threadCount)
+{
+    if (!njobs)
+        return;
+
+    if (!jobs)
+    {
+        throw std::invalid_argument("Skinning jobs array required");
+    }
+
+    size_t nchunks = 0;
+    for (size_t j = 0; j < njobs; ++j)
+    {
+        ValidateJob(jobs[j]);
+        nchunks += (jobs[j].vertexCount + c_SkinningChunkSize - 1) / c_SkinningChunkSize;
+    }
+
+    if (!nchunks)
+        return;
+
+    std::vector<std::pair<size_t, size_t>> chunks;
+    chunks.reserve(nchunks);
+    for (size_t j = 0; j < njobs; ++j)
+    {
+        for (size_t first = 0; first < jobs[j].vertexCount; first += c_SkinningChunkSize)
+        {
+            chunks.emplace_back(j, first);
+        }
+    }
+
+    if (!threadCount)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    const size_t workerCount = std::min<size_t>(threadCount, nchunks);
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() noexcept
+    {
+        for (;;)
+        {
+            const size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= chunks.size())
+                break;
+
+            const SkinningJob& job = jobs[chunks[index].first];
+            const size_t first = chunks[index].second;
+            SkinRange(job, first, std::min(c_SkinningChunkSize, job.vertexCount - first));
+        }
+    };
+
+    if (workerCount == 1)
+    {
+        worker();
+        return;
+    }
+
+    // The calling thread is one of the workers, and picks up any chunks left if threads can't be created
+    std::vector<std::thread> threads;
+    try
+    {
+        threads.reserve(workerCount - 1);
+        for (size_t j = 1; j < workerCount; ++j)
+        {
+            threads.emplace_back(worker);
+        }
+    }
+    catch (const std::exception&)
+    {
+    }
+
+    worker();
+
+    for (auto& it : threads)
+    {
+        it.join();
+    }
+}
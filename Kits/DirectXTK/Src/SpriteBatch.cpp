@@ -17,6 +17,9 @@
 #include "AlignedNew.h"
 #include "SharedResourcePool.h"
 
+#include <atomic>
+#include <thread>
+
 using namespace DirectX;
 using Microsoft::WRL::ComPtr;
 
@@ -55,6 +58,76 @@ namespace
 
         return v;
     }
+
+
+    // Maps a float onto an unsigned integer with the same ordering.
+    inline uint32_t FloatSortKey(float value) noexcept
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        // -0 compares equal to +0, so it gets the same key rather than sorting before it.
+        if (bits == 0x80000000u)
+            bits = 0;
+
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+
+    // Stable LSD radix sort of entries by their key, 8 bits at a time. Passes where every key has the same digit are
+    // skipped, which is most of the bytes of a texture pointer. Returns whichever of the two arrays holds the result.
+    template<typename T>
+    T* RadixSort(_Inout_updates_(count) T* entries, _Out_writes_(count) T* scratch, size_t count, size_t keyBytes) noexcept
+    {
+        assert(count > 0 && keyBytes <= sizeof(uint64_t));
+
+        size_t histograms[sizeof(uint64_t)][256] = {};
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const uint64_t key = entries[i].key;
+
+            for (size_t b = 0; b < keyBytes; b++)
+            {
+                histograms[b][(key >> (b * 8)) & 0xff]++;
+            }
+        }
+
+        T* src = entries;
+        T* dst = scratch;
+
+        for (size_t b = 0; b < keyBytes; b++)
+        {
+            const size_t shift = b * 8;
+            size_t* histogram = histograms[b];
+
+            if (histogram[(src[0].key >> shift) & 0xff] == count)
+                continue;
+
+            // Turn the digit counts into output offsets.
+            size_t offset = 0;
+            for (size_t j = 0; j < 256; j++)
+            {
+                const size_t digitCount = histogram[j];
+                histogram[j] = offset;
+                offset += digitCount;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                dst[histogram[(src[i].key >> shift) & 0xff]++] = src[i];
+            }
+
+            std::swap(src, dst);
+        }
+
+        return src;
+    }
+
+
+    // Identifies each Begin/End pair across every SpriteBatch, so a thread can't mistake the queue it cached for
+    // an earlier batch for one belonging to the current batch.
+    std::atomic<uint64_t> s_nextBatchId(1);
 }
 
 
@@ -106,12 +179,16 @@ public:
 
 private:
     // Implementation helper methods.
-    void GrowSpriteQueue();
+    void GrowSpriteQueue(size_t minSize);
+    void MergeThreadQueues();
     void PrepareForRendering();
     void FlushBatch();
     void SortSprites();
     void GrowSortedSprites();
 
+    static void GrowSpriteArray(std::unique_ptr<SpriteInfo[]>& array, size_t count, size_t& arraySize, size_t minSize);
+    static void AddTextureReference(std::vector<ComPtr<ID3D11ShaderResourceView>>& references, _In_ ID3D11ShaderResourceView* texture);
+
     void RenderBatch(_In_ ID3D11ShaderResourceView* texture, _In_reads_(count) SpriteInfo const* const* sprites, size_t count);
 
     static void XM_CALLCONV RenderSprite(_In_ SpriteInfo const* sprite,
@@ -119,6 +196,11 @@ private:
         FXMVECTOR textureSize,
         FXMVECTOR inverseTextureSize);
 
+    static void XM_CALLCONV RenderSpriteGroup(_In_reads_(SpritesPerGroup) SpriteInfo const* const* sprites,
+        _Out_writes_(VerticesPerSprite * SpritesPerGroup) VertexPositionColorTexture* vertices,
+        FXMVECTOR textureSize,
+        FXMVECTOR inverseTextureSize);
+
     static XMVECTOR GetTextureSize(_In_ ID3D11ShaderResourceView* texture);
     XMMATRIX GetViewportTransform(_In_ ID3D11DeviceContext* deviceContext, DXGI_MODE_ROTATION rotation );
 
@@ -129,6 +211,7 @@ private:
     static constexpr size_t InitialQueueSize = 64;
     static constexpr size_t VerticesPerSprite = 4;
     static constexpr size_t IndicesPerSprite = 6;
+    static constexpr size_t SpritesPerGroup = 4;
 
 
     // Queue of sprites waiting to be drawn.
@@ -145,6 +228,39 @@ private:
     std::vector<SpriteInfo const*> mSortedSprites;
 
 
+    // Sprites drawn between Begin and End by threads other than the one that called Begin. Each of those
+    // threads records into its own queue without locking, and End appends them all to mSpriteQueue.
+    struct ThreadQueue
+    {
+        ThreadQueue() noexcept : count(0), arraySize(0) {}
+
+        std::thread::id thread;
+        std::unique_ptr<SpriteInfo[]> sprites;
+        size_t count;
+        size_t arraySize;
+        std::vector<ComPtr<ID3D11ShaderResourceView>> textureReferences;
+    };
+
+    ThreadQueue* GetThreadQueue();
+
+    std::mutex mThreadQueueMutex;
+    std::vector<std::unique_ptr<ThreadQueue>> mThreadQueues;
+    std::thread::id mBeginThread;
+    uint64_t mBatchId;
+
+
+    // Sort keys for the queued sprites, plus scratch space for the radix sort. These keep
+    // their capacity from one batch to the next so that sorting doesn't allocate every frame.
+    struct SortEntry
+    {
+        uint64_t key;
+        SpriteInfo const* sprite;
+    };
+
+    std::vector<SortEntry> mSortEntries;
+    std::vector<SortEntry> mSortScratch;
+
+
     // If each SpriteInfo instance held a refcount on its texture, could end up with
     // many redundant AddRef/Release calls on the same object, so instead we use
     // this separate list to hold just a single refcount each time we change texture.
@@ -373,6 +489,7 @@ SpriteBatch::Impl::Impl(_In_ ID3D11DeviceContext* deviceContext)
     mViewPort{},
     mSpriteQueueCount(0),
     mSpriteQueueArraySize(0),
+    mBatchId(0),
     mInBeginEndPair(false),
     mSortMode(SpriteSortMode_Deferred),
     mTransformMatrix(MatrixIdentity),
@@ -403,6 +520,9 @@ void XM_CALLCONV SpriteBatch::Impl::Begin(SpriteSortMode sortMode,
     mSetCustomShaders = setCustomShaders;
     mTransformMatrix = transformMatrix;
 
+    mBeginThread = std::this_thread::get_id();
+    mBatchId = s_nextBatchId.fetch_add(1);
+
     if (sortMode == SpriteSortMode_Immediate)
     {
         // If we are in immediate mode, set device state ready for drawing.
@@ -435,6 +555,7 @@ void SpriteBatch::Impl::End()
         if (mContextResources->inImmediateMode)
             throw std::logic_error("Cannot end one SpriteBatch while another is using SpriteSortMode_Immediate");
 
+        MergeThreadQueues();
         PrepareForRendering();
         FlushBatch();
     }
@@ -462,13 +583,33 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
     if (!mInBeginEndPair)
         throw std::logic_error("Begin must be called before Draw");
 
-    // Get a pointer to the output sprite.
-    if (mSpriteQueueCount >= mSpriteQueueArraySize)
+    // Get a pointer to the output sprite, in this thread's own queue if it isn't the one that called Begin.
+    ThreadQueue* threadQueue = nullptr;
+    SpriteInfo* sprite;
+
+    if (std::this_thread::get_id() == mBeginThread)
     {
-        GrowSpriteQueue();
+        if (mSpriteQueueCount >= mSpriteQueueArraySize)
+        {
+            GrowSpriteQueue(mSpriteQueueCount + 1);
+        }
+
+        sprite = &mSpriteQueue[mSpriteQueueCount];
     }
+    else
+    {
+        if (mSortMode == SpriteSortMode_Immediate)
+            throw std::logic_error("SpriteSortMode_Immediate sprites must be drawn on the thread that called Begin");
 
-    SpriteInfo* sprite = &mSpriteQueue[mSpriteQueueCount];
+        threadQueue = GetThreadQueue();
+
+        if (threadQueue->count >= threadQueue->arraySize)
+        {
+            GrowSpriteArray(threadQueue->sprites, threadQueue->count, threadQueue->arraySize, threadQueue->count + 1);
+        }
+
+        sprite = &threadQueue->sprites[threadQueue->count];
+    }
 
     XMVECTOR dest = destination;
 
@@ -508,47 +649,154 @@ void XM_CALLCONV SpriteBatch::Impl::Draw(ID3D11ShaderResourceView* texture,
         // If we are in immediate mode, draw this sprite straight away.
         RenderBatch(texture, &sprite, 1);
     }
+    else if (threadQueue)
+    {
+        // Queue this sprite for End to merge into the main queue.
+        threadQueue->count++;
+
+        AddTextureReference(threadQueue->textureReferences, texture);
+    }
     else
     {
         // Queue this sprite for later sorting and batched rendering.
         mSpriteQueueCount++;
 
-        // Make sure we hold a refcount on this texture until the sprite has been drawn. Only checking the
-        // back of the vector means we will add duplicate references if the caller switches back and forth
-        // between multiple repeated textures, but calling AddRef more times than strictly necessary hurts
-        // nothing, and is faster than scanning the whole list or using a map to detect all duplicates.
-        if (mSpriteTextureReferences.empty() || texture != mSpriteTextureReferences.back().Get())
-        {
-            mSpriteTextureReferences.emplace_back(texture);
-        }
+        AddTextureReference(mSpriteTextureReferences, texture);
     }
 }
 
 
-// Dynamically expands the array used to store pending sprite information.
-void SpriteBatch::Impl::GrowSpriteQueue()
+// Makes sure we hold a refcount on a texture until the sprite using it has been drawn.
+_Use_decl_annotations_
+void SpriteBatch::Impl::AddTextureReference(std::vector<ComPtr<ID3D11ShaderResourceView>>& references, ID3D11ShaderResourceView* texture)
+{
+    // Only checking the back of the vector means we will add duplicate references if the caller switches back and
+    // forth between multiple repeated textures, but calling AddRef more times than strictly necessary hurts nothing,
+    // and is faster than scanning the whole list or using a map to detect all duplicates.
+    if (references.empty() || texture != references.back().Get())
+    {
+        references.emplace_back(texture);
+    }
+}
+
+
+// Dynamically expands an array used to store pending sprite information.
+void SpriteBatch::Impl::GrowSpriteArray(std::unique_ptr<SpriteInfo[]>& array, size_t count, size_t& arraySize, size_t minSize)
 {
     // Grow by a factor of 2.
-    const size_t newSize = std::max(InitialQueueSize, mSpriteQueueArraySize * 2);
+    size_t newSize = std::max(InitialQueueSize, arraySize * 2);
+
+    while (newSize < minSize)
+    {
+        newSize *= 2;
+    }
 
     // Allocate the new array.
     auto newArray = std::make_unique<SpriteInfo[]>(newSize);
 
     // Copy over any existing sprites.
-    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    for (size_t i = 0; i < count; i++)
     {
-        newArray[i] = mSpriteQueue[i];
+        newArray[i] = array[i];
     }
 
     // Replace the previous array with the new one.
-    mSpriteQueue = std::move(newArray);
-    mSpriteQueueArraySize = newSize;
+    array = std::move(newArray);
+    arraySize = newSize;
+}
+
+
+// Dynamically expands the array used to store pending sprite information.
+void SpriteBatch::Impl::GrowSpriteQueue(size_t minSize)
+{
+    GrowSpriteArray(mSpriteQueue, mSpriteQueueCount, mSpriteQueueArraySize, minSize);
 
     // Clear any dangling SpriteInfo pointers left over from previous rendering.
     mSortedSprites.clear();
 }
 
 
+// Looks up the queue for sprites drawn by the calling thread, which isn't the one that called Begin.
+SpriteBatch::Impl::ThreadQueue* SpriteBatch::Impl::GetThreadQueue()
+{
+    // Each thread remembers the queue it used last, so only its first sprite of a batch takes the lock.
+    static thread_local uint64_t cachedBatchId = 0;
+    static thread_local ThreadQueue* cachedQueue = nullptr;
+
+    if (cachedBatchId == mBatchId)
+        return cachedQueue;
+
+    const std::thread::id thread = std::this_thread::get_id();
+
+    std::lock_guard<std::mutex> lock(mThreadQueueMutex);
+
+    ThreadQueue* queue = nullptr;
+
+    for (auto& it : mThreadQueues)
+    {
+        if (it->thread == thread)
+        {
+            queue = it.get();
+            break;
+        }
+    }
+
+    if (!queue)
+    {
+        mThreadQueues.emplace_back(std::make_unique<ThreadQueue>());
+
+        queue = mThreadQueues.back().get();
+        queue->thread = thread;
+    }
+
+    cachedBatchId = mBatchId;
+    cachedQueue = queue;
+
+    return queue;
+}
+
+
+// Appends the sprites other threads drew during this batch to the main queue, one thread after another in the order
+// they first drew with this SpriteBatch. All of those Draw calls must have returned before End is called.
+void SpriteBatch::Impl::MergeThreadQueues()
+{
+    std::lock_guard<std::mutex> lock(mThreadQueueMutex);
+
+    // Release the queues of threads which didn't draw anything this time, such as ones which have exited.
+    mThreadQueues.erase(
+        std::remove_if(mThreadQueues.begin(), mThreadQueues.end(),
+            [](std::unique_ptr<ThreadQueue> const& queue) noexcept { return queue->count == 0; }),
+        mThreadQueues.end());
+
+    if (mThreadQueues.empty())
+        return;
+
+    size_t totalCount = mSpriteQueueCount;
+
+    for (auto& it : mThreadQueues)
+    {
+        totalCount += it->count;
+    }
+
+    if (totalCount > mSpriteQueueArraySize)
+    {
+        GrowSpriteQueue(totalCount);
+    }
+
+    for (auto& it : mThreadQueues)
+    {
+        std::copy(it->sprites.get(), it->sprites.get() + it->count, mSpriteQueue.get() + mSpriteQueueCount);
+        mSpriteQueueCount += it->count;
+        it->count = 0;
+
+        mSpriteTextureReferences.insert(mSpriteTextureReferences.end(),
+            std::make_move_iterator(it->textureReferences.begin()),
+            std::make_move_iterator(it->textureReferences.end()));
+        it->textureReferences.clear();
+    }
+}
+
+
 // Sets up D3D device state ready for drawing sprites.
 void SpriteBatch::Impl::PrepareForRendering()
 {
@@ -671,37 +919,64 @@ void SpriteBatch::Impl::SortSprites()
         GrowSortedSprites();
     }
 
+    // Each sort mode becomes an unsigned key in the order the sprites are to be drawn.
+    size_t keyBytes;
+
     switch (mSortMode)
     {
         case SpriteSortMode_Texture:
-            // Sort by texture.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-                [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-                {
-                    return x->texture < y->texture;
-                });
+            keyBytes = sizeof(uintptr_t);
             break;
 
         case SpriteSortMode_BackToFront:
-            // Sort back to front.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-                [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-                {
-                    return x->originRotationDepth.w > y->originRotationDepth.w;
-                });
-            break;
-
         case SpriteSortMode_FrontToBack:
-            // Sort front to back.
-            std::sort(mSortedSprites.begin(), mSortedSprites.begin() + static_cast<int>(mSpriteQueueCount),
-                [](SpriteInfo const* x, SpriteInfo const* y) noexcept -> bool
-                {
-                    return x->originRotationDepth.w < y->originRotationDepth.w;
-                });
+            keyBytes = sizeof(uint32_t);
             break;
 
         default:
-            break;
+            return;
+    }
+
+    if (mSortEntries.size() < mSpriteQueueCount)
+    {
+        mSortEntries.resize(mSpriteQueueCount);
+        mSortScratch.resize(mSpriteQueueCount);
+    }
+
+    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    {
+        SpriteInfo const* sprite = mSortedSprites[i];
+
+        uint64_t key;
+
+        switch (mSortMode)
+        {
+            case SpriteSortMode_Texture:
+                // Sort by texture.
+                key = reinterpret_cast<uintptr_t>(sprite->texture);
+                break;
+
+            case SpriteSortMode_BackToFront:
+                // Sort back to front.
+                key = ~FloatSortKey(sprite->originRotationDepth.w);
+                break;
+
+            default:
+                // Sort front to back.
+                key = FloatSortKey(sprite->originRotationDepth.w);
+                break;
+        }
+
+        mSortEntries[i].key = key;
+        mSortEntries[i].sprite = sprite;
+    }
+
+    // The radix sort is stable, so sprites with equal keys stay in the order they were drawn.
+    SortEntry const* sorted = RadixSort(mSortEntries.data(), mSortScratch.data(), mSpriteQueueCount, keyBytes);
+
+    for (size_t i = 0; i < mSpriteQueueCount; i++)
+    {
+        mSortedSprites[i] = sorted[i].sprite;
     }
 }
 
@@ -773,8 +1048,19 @@ void SpriteBatch::Impl::RenderBatch(ID3D11ShaderResourceView* texture, SpriteInf
         auto vertices = static_cast<VertexPositionColorTexture*>(mappedBuffer.pData) + mContextResources->vertexBufferPosition * VerticesPerSprite;
 #endif
 
-        // Generate sprite vertex data.
-        for (size_t i = 0; i < batchSize; i++)
+        // Generate sprite vertex data, a group of sprites at a time while there are enough left.
+        size_t i = 0;
+
+        for (; i + SpritesPerGroup <= batchSize; i += SpritesPerGroup)
+        {
+            assert(i + SpritesPerGroup <= count);
+            _Analysis_assume_(i + SpritesPerGroup <= count);
+            RenderSpriteGroup(&sprites[i], vertices, textureSize, inverseTextureSize);
+
+            vertices += VerticesPerSprite * SpritesPerGroup;
+        }
+
+        for (; i < batchSize; i++)
         {
             assert(i < count);
             _Analysis_assume_(i < count);
@@ -921,6 +1207,161 @@ void XM_CALLCONV SpriteBatch::Impl::RenderSprite(SpriteInfo const* sprite,
 }
 
 
+// Generates vertex data for a group of sprites, with each SIMD lane working on a different sprite. This does
+// exactly the same arithmetic as RenderSprite, so the vertices are identical to drawing the sprites one at a time.
+_Use_decl_annotations_
+void XM_CALLCONV SpriteBatch::Impl::RenderSpriteGroup(SpriteInfo const* const* sprites,
+    VertexPositionColorTexture* vertices,
+    FXMVECTOR textureSize,
+    FXMVECTOR inverseTextureSize)
+{
+    static_assert(SpritesPerGroup == 4, "RenderSpriteGroup works on one sprite per XMVECTOR lane");
+
+    // Load the sprite parameters and transpose them, so each vector holds one parameter of every sprite.
+    const XMMATRIX source = XMMatrixTranspose(XMMATRIX(
+        XMLoadFloat4A(&sprites[0]->source),
+        XMLoadFloat4A(&sprites[1]->source),
+        XMLoadFloat4A(&sprites[2]->source),
+        XMLoadFloat4A(&sprites[3]->source)));
+
+    const XMMATRIX destination = XMMatrixTranspose(XMMATRIX(
+        XMLoadFloat4A(&sprites[0]->destination),
+        XMLoadFloat4A(&sprites[1]->destination),
+        XMLoadFloat4A(&sprites[2]->destination),
+        XMLoadFloat4A(&sprites[3]->destination)));
+
+    const XMMATRIX originRotationDepth = XMMatrixTranspose(XMMATRIX(
+        XMLoadFloat4A(&sprites[0]->originRotationDepth),
+        XMLoadFloat4A(&sprites[1]->originRotationDepth),
+        XMLoadFloat4A(&sprites[2]->originRotationDepth),
+        XMLoadFloat4A(&sprites[3]->originRotationDepth)));
+
+    XMVECTOR sourceX = source.r[0];
+    XMVECTOR sourceY = source.r[1];
+    XMVECTOR sourceWidth = source.r[2];
+    XMVECTOR sourceHeight = source.r[3];
+
+    XMVECTOR destinationWidth = destination.r[2];
+    XMVECTOR destinationHeight = destination.r[3];
+
+    const XMVECTOR depth = originRotationDepth.r[3];
+
+    // Per-sprite flags as lane masks.
+    const XMVECTOR flags = XMVectorSetInt(sprites[0]->flags, sprites[1]->flags, sprites[2]->flags, sprites[3]->flags);
+
+    auto const flagMask = [flags](unsigned int flag) noexcept
+    {
+        return XMVectorNotEqualInt(XMVectorAndInt(flags, XMVectorReplicateInt(flag)), XMVectorZero());
+    };
+
+    const XMVECTOR sourceInTexels = flagMask(SpriteInfo::SourceInTexels);
+    const XMVECTOR destSizeInPixels = flagMask(SpriteInfo::DestSizeInPixels);
+    const XMVECTOR flipHorizontally = flagMask(SpriteEffects_FlipHorizontally);
+    const XMVECTOR flipVertically = flagMask(SpriteEffects_FlipVertically);
+
+    // Scale the origin offset by source size, taking care to avoid overflow if the source region is zero.
+    XMVECTOR originX = XMVectorDivide(originRotationDepth.r[0],
+        XMVectorSelect(sourceWidth, g_XMEpsilon, XMVectorEqual(sourceWidth, XMVectorZero())));
+    XMVECTOR originY = XMVectorDivide(originRotationDepth.r[1],
+        XMVectorSelect(sourceHeight, g_XMEpsilon, XMVectorEqual(sourceHeight, XMVectorZero())));
+
+    // Convert the source region from texels to mod-1 texture coordinate format.
+    const XMVECTOR inverseWidth = XMVectorSplatX(inverseTextureSize);
+    const XMVECTOR inverseHeight = XMVectorSplatY(inverseTextureSize);
+
+    sourceX = XMVectorSelect(sourceX, XMVectorMultiply(sourceX, inverseWidth), sourceInTexels);
+    sourceY = XMVectorSelect(sourceY, XMVectorMultiply(sourceY, inverseHeight), sourceInTexels);
+    sourceWidth = XMVectorSelect(sourceWidth, XMVectorMultiply(sourceWidth, inverseWidth), sourceInTexels);
+    sourceHeight = XMVectorSelect(sourceHeight, XMVectorMultiply(sourceHeight, inverseHeight), sourceInTexels);
+    originX = XMVectorSelect(XMVectorMultiply(originX, inverseWidth), originX, sourceInTexels);
+    originY = XMVectorSelect(XMVectorMultiply(originY, inverseHeight), originY, sourceInTexels);
+
+    // If the destination size is relative to the source region, convert it to pixels.
+    destinationWidth = XMVectorSelect(XMVectorMultiply(destinationWidth, XMVectorSplatX(textureSize)), destinationWidth, destSizeInPixels);
+    destinationHeight = XMVectorSelect(XMVectorMultiply(destinationHeight, XMVectorSplatY(textureSize)), destinationHeight, destSizeInPixels);
+
+    // Compute the 2x2 rotation matrices, using the same scalar sine and cosine as RenderSprite.
+    float sin[SpritesPerGroup] = { 0, 0, 0, 0 };
+    float cos[SpritesPerGroup] = { 1, 1, 1, 1 };
+    float negSin[SpritesPerGroup] = { 0, 0, 0, 0 };
+
+    for (size_t j = 0; j < SpritesPerGroup; j++)
+    {
+        const float rotation = sprites[j]->originRotationDepth.z;
+
+        if (rotation != 0)
+        {
+            XMScalarSinCos(&sin[j], &cos[j], rotation);
+
+            negSin[j] = -sin[j];
+        }
+    }
+
+    const XMVECTOR sinV = XMVectorSet(sin[0], sin[1], sin[2], sin[3]);
+    const XMVECTOR cosV = XMVectorSet(cos[0], cos[1], cos[2], cos[3]);
+    const XMVECTOR negSinV = XMVectorSet(negSin[0], negSin[1], negSin[2], negSin[3]);
+
+    // Generate the four corners of every sprite. Texture coordinates come from the mirrored corner, as in RenderSprite.
+    XMMATRIX positions[VerticesPerSprite];
+    XMVECTOR textureCoordinates[VerticesPerSprite][2];
+
+    for (size_t i = 0; i < VerticesPerSprite; i++)
+    {
+        const XMVECTOR cornerX = (i & 1) ? g_XMOne : g_XMZero;
+        const XMVECTOR cornerY = (i & 2) ? g_XMOne : g_XMZero;
+
+        // Calculate position.
+        const XMVECTOR cornerOffsetX = XMVectorMultiply(XMVectorSubtract(cornerX, originX), destinationWidth);
+        const XMVECTOR cornerOffsetY = XMVectorMultiply(XMVectorSubtract(cornerY, originY), destinationHeight);
+
+        // Apply 2x2 rotation matrix.
+        const XMVECTOR position1X = XMVectorMultiplyAdd(cornerOffsetX, cosV, destination.r[0]);
+        const XMVECTOR position1Y = XMVectorMultiplyAdd(cornerOffsetX, sinV, destination.r[1]);
+        const XMVECTOR positionX = XMVectorMultiplyAdd(cornerOffsetY, negSinV, position1X);
+        const XMVECTOR positionY = XMVectorMultiplyAdd(cornerOffsetY, cosV, position1Y);
+
+        // Compute the texture coordinate.
+        const XMVECTOR mirrorX = XMVectorSelect(cornerX, XMVectorSubtract(g_XMOne, cornerX), flipHorizontally);
+        const XMVECTOR mirrorY = XMVectorSelect(cornerY, XMVectorSubtract(g_XMOne, cornerY), flipVertically);
+
+        textureCoordinates[i][0] = XMVectorMultiplyAdd(mirrorX, sourceWidth, sourceX);
+        textureCoordinates[i][1] = XMVectorMultiplyAdd(mirrorY, sourceHeight, sourceY);
+
+        // Transpose back to one x, y, z = depth vector per sprite.
+        positions[i] = XMMatrixTranspose(XMMATRIX(positionX, positionY, depth, depth));
+    }
+
+    const XMMATRIX textureCoordinates01 = XMMatrixTranspose(XMMATRIX(
+        textureCoordinates[0][0], textureCoordinates[0][1], textureCoordinates[1][0], textureCoordinates[1][1]));
+    const XMMATRIX textureCoordinates23 = XMMatrixTranspose(XMMATRIX(
+        textureCoordinates[2][0], textureCoordinates[2][1], textureCoordinates[3][0], textureCoordinates[3][1]));
+
+    // Write the vertices in order, one sprite after another.
+    for (size_t j = 0; j < SpritesPerGroup; j++)
+    {
+        const XMVECTOR color = XMLoadFloat4A(&sprites[j]->color);
+
+        const XMVECTOR textureCoordinate[VerticesPerSprite] =
+        {
+            textureCoordinates01.r[j],
+            XMVectorSwizzle<2, 3, 2, 3>(textureCoordinates01.r[j]),
+            textureCoordinates23.r[j],
+            XMVectorSwizzle<2, 3, 2, 3>(textureCoordinates23.r[j]),
+        };
+
+        for (size_t i = 0; i < VerticesPerSprite; i++)
+        {
+            // As in RenderSprite, the position is written as a Float4 and the color overwrites the extra element.
+            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&vertices->position), positions[i].r[j]);
+            XMStoreFloat4(&vertices->color, color);
+            XMStoreFloat2(&vertices->textureCoordinate, textureCoordinate[i]);
+
+            vertices++;
+        }
+    }
+}
+
+
 // Helper looks up the size of the specified texture.
 XMVECTOR SpriteBatch::Impl::GetTextureSize(_In_ ID3D11ShaderResourceView* texture)
 {
@@ -314,6 +314,284 @@ namespace
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // Batched form of OptimizeRGB which solves four independent blocks at once, one block
+    // per SIMD lane. Each lane performs the same sequence of IEEE operations as the scalar
+    // version (no fused multiply-add) so the resulting endpoints are bit-identical.
+    //-------------------------------------------------------------------------------------
+#ifndef COLOR_WEIGHTS
+    void OptimizeRGBx4(
+        _Out_writes_(4) HDRColorA *pX,
+        _Out_writes_(4) HDRColorA *pY,
+        _In_reads_(4) const HDRColorA* const *ppPoints,
+        _In_reads_(4) const uint32_t *pcSteps,
+        uint32_t laneMask,
+        uint32_t flags) noexcept
+    {
+        static const XMVECTORF32 s_Epsilon = { { { (0.25f / 64.0f) * (0.25f / 64.0f), (0.25f / 64.0f) * (0.25f / 64.0f), (0.25f / 64.0f) * (0.25f / 64.0f), (0.25f / 64.0f) * (0.25f / 64.0f) } } };
+        static const XMVECTORF32 s_TwoColor = { { { 1.0f / 4096.0f, 1.0f / 4096.0f, 1.0f / 4096.0f, 1.0f / 4096.0f } } };
+        static const XMVECTORF32 s_FltMin = { { { FLT_MIN, FLT_MIN, FLT_MIN, FLT_MIN } } };
+        static const XMVECTORF32 s_NegOne = { { { -1.0f, -1.0f, -1.0f, -1.0f } } };
+        static const XMVECTORF32 s_Eighth = { { { 1.0f / 8.0f, 1.0f / 8.0f, 1.0f / 8.0f, 1.0f / 8.0f } } };
+
+        // Transpose points into structure-of-arrays form
+        XMVECTOR PR[NUM_PIXELS_PER_BLOCK], PG[NUM_PIXELS_PER_BLOCK], PB[NUM_PIXELS_PER_BLOCK];
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            PR[iPoint] = XMVectorSet(ppPoints[0][iPoint].r, ppPoints[1][iPoint].r, ppPoints[2][iPoint].r, ppPoints[3][iPoint].r);
+            PG[iPoint] = XMVectorSet(ppPoints[0][iPoint].g, ppPoints[1][iPoint].g, ppPoints[2][iPoint].g, ppPoints[3][iPoint].g);
+            PB[iPoint] = XMVectorSet(ppPoints[0][iPoint].b, ppPoints[1][iPoint].b, ppPoints[2][iPoint].b, ppPoints[3][iPoint].b);
+        }
+
+        // Per-lane step weights (3 or 4 steps)
+        const XMVECTOR steps3 = XMVectorSelectControl(
+            (3 == pcSteps[0]) ? 1u : 0u, (3 == pcSteps[1]) ? 1u : 0u, (3 == pcSteps[2]) ? 1u : 0u, (3 == pcSteps[3]) ? 1u : 0u);
+
+        const XMVECTOR C0 = g_XMOne;
+        const XMVECTOR C1 = XMVectorSelect(XMVectorReplicate(2.0f / 3.0f), XMVectorReplicate(1.0f / 2.0f), steps3);
+        const XMVECTOR C2 = XMVectorSelect(XMVectorReplicate(1.0f / 3.0f), XMVectorZero(), steps3);
+        const XMVECTOR C3 = XMVectorZero();
+        const XMVECTOR D0 = XMVectorZero();
+        const XMVECTOR D1 = XMVectorSelect(XMVectorReplicate(1.0f / 3.0f), XMVectorReplicate(1.0f / 2.0f), steps3);
+        const XMVECTOR D2 = XMVectorSelect(XMVectorReplicate(2.0f / 3.0f), g_XMOne, steps3);
+        const XMVECTOR D3 = g_XMOne;
+
+        const XMVECTOR fSteps = XMVectorSelect(XMVectorReplicate(3.0f), XMVectorReplicate(2.0f), steps3);
+
+        XMVECTOR active = XMVectorSelectControl(laneMask & 1u, (laneMask >> 1) & 1u, (laneMask >> 2) & 1u, (laneMask >> 3) & 1u);
+
+        // Find Min and Max points, as starting point
+        XMVECTOR XR, XG, XB;
+        if (flags & BC_FLAGS_UNIFORM)
+        {
+            XR = XG = XB = g_XMOne;
+        }
+        else
+        {
+            XR = XMVectorReplicate(g_Luminance.r);
+            XG = XMVectorReplicate(g_Luminance.g);
+            XB = XMVectorReplicate(g_Luminance.b);
+        }
+        XMVECTOR YR = XMVectorZero();
+        XMVECTOR YG = XMVectorZero();
+        XMVECTOR YB = XMVectorZero();
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            XR = XMVectorSelect(XR, PR[iPoint], XMVectorLess(PR[iPoint], XR));
+            XG = XMVectorSelect(XG, PG[iPoint], XMVectorLess(PG[iPoint], XG));
+            XB = XMVectorSelect(XB, PB[iPoint], XMVectorLess(PB[iPoint], XB));
+
+            YR = XMVectorSelect(YR, PR[iPoint], XMVectorGreater(PR[iPoint], YR));
+            YG = XMVectorSelect(YG, PG[iPoint], XMVectorGreater(PG[iPoint], YG));
+            YB = XMVectorSelect(YB, PB[iPoint], XMVectorGreater(PB[iPoint], YB));
+        }
+
+        // Diagonal axis
+        const XMVECTOR ABR = XMVectorSubtract(YR, XR);
+        const XMVECTOR ABG = XMVectorSubtract(YG, XG);
+        const XMVECTOR ABB = XMVectorSubtract(YB, XB);
+
+        const XMVECTOR fAB = XMVectorAdd(XMVectorAdd(XMVectorMultiply(ABR, ABR), XMVectorMultiply(ABG, ABG)), XMVectorMultiply(ABB, ABB));
+
+        // Single color block.. no need to root-find
+        active = XMVectorAndCInt(active, XMVectorLess(fAB, s_FltMin));
+
+        // Try all four axis directions, to determine which diagonal best fits data
+        const XMVECTOR fABInv = XMVectorDivide(g_XMOne, fAB);
+
+        XMVECTOR DirR = XMVectorMultiply(ABR, fABInv);
+        XMVECTOR DirG = XMVectorMultiply(ABG, fABInv);
+        XMVECTOR DirB = XMVectorMultiply(ABB, fABInv);
+
+        const XMVECTOR MidR = XMVectorMultiply(XMVectorAdd(XR, YR), g_XMOneHalf);
+        const XMVECTOR MidG = XMVectorMultiply(XMVectorAdd(XG, YG), g_XMOneHalf);
+        const XMVECTOR MidB = XMVectorMultiply(XMVectorAdd(XB, YB), g_XMOneHalf);
+
+        XMVECTOR fDir0 = XMVectorZero();
+        XMVECTOR fDir1 = XMVectorZero();
+        XMVECTOR fDir2 = XMVectorZero();
+        XMVECTOR fDir3 = XMVectorZero();
+
+        for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+        {
+            const XMVECTOR PtR = XMVectorMultiply(XMVectorSubtract(PR[iPoint], MidR), DirR);
+            const XMVECTOR PtG = XMVectorMultiply(XMVectorSubtract(PG[iPoint], MidG), DirG);
+            const XMVECTOR PtB = XMVectorMultiply(XMVectorSubtract(PB[iPoint], MidB), DirB);
+
+            XMVECTOR f = XMVectorAdd(XMVectorAdd(PtR, PtG), PtB);
+            fDir0 = XMVectorAdd(fDir0, XMVectorMultiply(f, f));
+
+            f = XMVectorSubtract(XMVectorAdd(PtR, PtG), PtB);
+            fDir1 = XMVectorAdd(fDir1, XMVectorMultiply(f, f));
+
+            f = XMVectorAdd(XMVectorSubtract(PtR, PtG), PtB);
+            fDir2 = XMVectorAdd(fDir2, XMVectorMultiply(f, f));
+
+            f = XMVectorSubtract(XMVectorSubtract(PtR, PtG), PtB);
+            fDir3 = XMVectorAdd(fDir3, XMVectorMultiply(f, f));
+        }
+
+        // Track (iDirMax & 2) and (iDirMax & 1) as lane masks
+        XMVECTOR fDirMax = fDir0;
+        XMVECTOR swapG = XMVectorFalseInt();
+        XMVECTOR swapB = XMVectorFalseInt();
+
+        XMVECTOR mask = XMVectorGreater(fDir1, fDirMax);
+        fDirMax = XMVectorSelect(fDirMax, fDir1, mask);
+        swapG = XMVectorAndCInt(swapG, mask);
+        swapB = XMVectorOrInt(swapB, mask);
+
+        mask = XMVectorGreater(fDir2, fDirMax);
+        fDirMax = XMVectorSelect(fDirMax, fDir2, mask);
+        swapG = XMVectorOrInt(swapG, mask);
+        swapB = XMVectorAndCInt(swapB, mask);
+
+        mask = XMVectorGreater(fDir3, fDirMax);
+        swapG = XMVectorOrInt(swapG, mask);
+        swapB = XMVectorOrInt(swapB, mask);
+
+        swapG = XMVectorAndInt(swapG, active);
+        swapB = XMVectorAndInt(swapB, active);
+
+        XMVECTOR tmp = XG;
+        XG = XMVectorSelect(XG, YG, swapG);
+        YG = XMVectorSelect(YG, tmp, swapG);
+
+        tmp = XB;
+        XB = XMVectorSelect(XB, YB, swapB);
+        YB = XMVectorSelect(YB, tmp, swapB);
+
+        // Two color block.. no need to root-find
+        active = XMVectorAndCInt(active, XMVectorLess(fAB, s_TwoColor));
+
+        // Use Newton's Method to find local minima of sum-of-squares error.
+        for (size_t iIteration = 0; iIteration < 8; iIteration++)
+        {
+            if (XMVector4EqualInt(active, XMVectorFalseInt()))
+                break;
+
+            // Calculate new steps
+            const XMVECTOR S0R = XMVectorAdd(XMVectorMultiply(XR, C0), XMVectorMultiply(YR, D0));
+            const XMVECTOR S0G = XMVectorAdd(XMVectorMultiply(XG, C0), XMVectorMultiply(YG, D0));
+            const XMVECTOR S0B = XMVectorAdd(XMVectorMultiply(XB, C0), XMVectorMultiply(YB, D0));
+            const XMVECTOR S1R = XMVectorAdd(XMVectorMultiply(XR, C1), XMVectorMultiply(YR, D1));
+            const XMVECTOR S1G = XMVectorAdd(XMVectorMultiply(XG, C1), XMVectorMultiply(YG, D1));
+            const XMVECTOR S1B = XMVectorAdd(XMVectorMultiply(XB, C1), XMVectorMultiply(YB, D1));
+            const XMVECTOR S2R = XMVectorAdd(XMVectorMultiply(XR, C2), XMVectorMultiply(YR, D2));
+            const XMVECTOR S2G = XMVectorAdd(XMVectorMultiply(XG, C2), XMVectorMultiply(YG, D2));
+            const XMVECTOR S2B = XMVectorAdd(XMVectorMultiply(XB, C2), XMVectorMultiply(YB, D2));
+            const XMVECTOR S3R = XMVectorAdd(XMVectorMultiply(XR, C3), XMVectorMultiply(YR, D3));
+            const XMVECTOR S3G = XMVectorAdd(XMVectorMultiply(XG, C3), XMVectorMultiply(YG, D3));
+            const XMVECTOR S3B = XMVectorAdd(XMVectorMultiply(XB, C3), XMVectorMultiply(YB, D3));
+
+            // Calculate color direction
+            DirR = XMVectorSubtract(YR, XR);
+            DirG = XMVectorSubtract(YG, XG);
+            DirB = XMVectorSubtract(YB, XB);
+
+            const XMVECTOR fLen = XMVectorAdd(XMVectorAdd(XMVectorMultiply(DirR, DirR), XMVectorMultiply(DirG, DirG)), XMVectorMultiply(DirB, DirB));
+
+            active = XMVectorAndCInt(active, XMVectorLess(fLen, s_TwoColor));
+            if (XMVector4EqualInt(active, XMVectorFalseInt()))
+                break;
+
+            const XMVECTOR fScale = XMVectorDivide(fSteps, fLen);
+
+            DirR = XMVectorMultiply(DirR, fScale);
+            DirG = XMVectorMultiply(DirG, fScale);
+            DirB = XMVectorMultiply(DirB, fScale);
+
+            // Evaluate function, and derivatives
+            XMVECTOR d2X = XMVectorZero();
+            XMVECTOR d2Y = XMVectorZero();
+            XMVECTOR dXR = XMVectorZero();
+            XMVECTOR dXG = XMVectorZero();
+            XMVECTOR dXB = XMVectorZero();
+            XMVECTOR dYR = XMVectorZero();
+            XMVECTOR dYG = XMVectorZero();
+            XMVECTOR dYB = XMVectorZero();
+
+            for (size_t iPoint = 0; iPoint < NUM_PIXELS_PER_BLOCK; iPoint++)
+            {
+                const XMVECTOR fDot = XMVectorAdd(
+                    XMVectorAdd(
+                        XMVectorMultiply(XMVectorSubtract(PR[iPoint], XR), DirR),
+                        XMVectorMultiply(XMVectorSubtract(PG[iPoint], XG), DirG)),
+                    XMVectorMultiply(XMVectorSubtract(PB[iPoint], XB), DirB));
+
+                XMVECTOR iStep = XMVectorTruncate(XMVectorAdd(fDot, g_XMOneHalf));
+                iStep = XMVectorSelect(iStep, XMVectorZero(), XMVectorLessOrEqual(fDot, XMVectorZero()));
+                iStep = XMVectorSelect(iStep, fSteps, XMVectorGreaterOrEqual(fDot, fSteps));
+
+                const XMVECTOR is0 = XMVectorEqual(iStep, XMVectorZero());
+                const XMVECTOR is1 = XMVectorEqual(iStep, g_XMOne);
+                const XMVECTOR is2 = XMVectorEqual(iStep, g_XMTwo);
+
+                const XMVECTOR C = XMVectorSelect(XMVectorSelect(XMVectorSelect(C3, C2, is2), C1, is1), C0, is0);
+                const XMVECTOR D = XMVectorSelect(XMVectorSelect(XMVectorSelect(D3, D2, is2), D1, is1), D0, is0);
+
+                const XMVECTOR DiffR = XMVectorSubtract(XMVectorSelect(XMVectorSelect(XMVectorSelect(S3R, S2R, is2), S1R, is1), S0R, is0), PR[iPoint]);
+                const XMVECTOR DiffG = XMVectorSubtract(XMVectorSelect(XMVectorSelect(XMVectorSelect(S3G, S2G, is2), S1G, is1), S0G, is0), PG[iPoint]);
+                const XMVECTOR DiffB = XMVectorSubtract(XMVectorSelect(XMVectorSelect(XMVectorSelect(S3B, S2B, is2), S1B, is1), S0B, is0), PB[iPoint]);
+
+                const XMVECTOR fC = XMVectorMultiply(C, s_Eighth);
+                const XMVECTOR fD = XMVectorMultiply(D, s_Eighth);
+
+                d2X = XMVectorAdd(d2X, XMVectorMultiply(fC, C));
+                dXR = XMVectorAdd(dXR, XMVectorMultiply(fC, DiffR));
+                dXG = XMVectorAdd(dXG, XMVectorMultiply(fC, DiffG));
+                dXB = XMVectorAdd(dXB, XMVectorMultiply(fC, DiffB));
+
+                d2Y = XMVectorAdd(d2Y, XMVectorMultiply(fD, D));
+                dYR = XMVectorAdd(dYR, XMVectorMultiply(fD, DiffR));
+                dYG = XMVectorAdd(dYG, XMVectorMultiply(fD, DiffG));
+                dYB = XMVectorAdd(dYB, XMVectorMultiply(fD, DiffB));
+            }
+
+            // Move endpoints
+            mask = XMVectorAndInt(active, XMVectorGreater(d2X, XMVectorZero()));
+            XMVECTOR f = XMVectorDivide(s_NegOne, d2X);
+            XR = XMVectorSelect(XR, XMVectorAdd(XR, XMVectorMultiply(dXR, f)), mask);
+            XG = XMVectorSelect(XG, XMVectorAdd(XG, XMVectorMultiply(dXG, f)), mask);
+            XB = XMVectorSelect(XB, XMVectorAdd(XB, XMVectorMultiply(dXB, f)), mask);
+
+            mask = XMVectorAndInt(active, XMVectorGreater(d2Y, XMVectorZero()));
+            f = XMVectorDivide(s_NegOne, d2Y);
+            YR = XMVectorSelect(YR, XMVectorAdd(YR, XMVectorMultiply(dYR, f)), mask);
+            YG = XMVectorSelect(YG, XMVectorAdd(YG, XMVectorMultiply(dYG, f)), mask);
+            YB = XMVectorSelect(YB, XMVectorAdd(YB, XMVectorMultiply(dYB, f)), mask);
+
+            XMVECTOR done = XMVectorLess(XMVectorMultiply(dXR, dXR), s_Epsilon);
+            done = XMVectorAndInt(done, XMVectorLess(XMVectorMultiply(dXG, dXG), s_Epsilon));
+            done = XMVectorAndInt(done, XMVectorLess(XMVectorMultiply(dXB, dXB), s_Epsilon));
+            done = XMVectorAndInt(done, XMVectorLess(XMVectorMultiply(dYR, dYR), s_Epsilon));
+            done = XMVectorAndInt(done, XMVectorLess(XMVectorMultiply(dYG, dYG), s_Epsilon));
+            done = XMVectorAndInt(done, XMVectorLess(XMVectorMultiply(dYB, dYB), s_Epsilon));
+            active = XMVectorAndCInt(active, done);
+        }
+
+        XMFLOAT4A xr, xg, xb, yr, yg, yb;
+        XMStoreFloat4A(&xr, XR);
+        XMStoreFloat4A(&xg, XG);
+        XMStoreFloat4A(&xb, XB);
+        XMStoreFloat4A(&yr, YR);
+        XMStoreFloat4A(&yg, YG);
+        XMStoreFloat4A(&yb, YB);
+
+        pX[0] = HDRColorA(xr.x, xg.x, xb.x, 1.0f);
+        pX[1] = HDRColorA(xr.y, xg.y, xb.y, 1.0f);
+        pX[2] = HDRColorA(xr.z, xg.z, xb.z, 1.0f);
+        pX[3] = HDRColorA(xr.w, xg.w, xb.w, 1.0f);
+
+        pY[0] = HDRColorA(yr.x, yg.x, yb.x, 1.0f);
+        pY[1] = HDRColorA(yr.y, yg.y, yb.y, 1.0f);
+        pY[2] = HDRColorA(yr.z, yg.z, yb.z, 1.0f);
+        pY[3] = HDRColorA(yr.w, yg.w, yb.w, 1.0f);
+    }
+#endif // !COLOR_WEIGHTS
+
+
     //-------------------------------------------------------------------------------------
     inline void DecodeBC1(
         _Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor,
@@ -365,14 +643,75 @@ namespace
         }
     }
 
+    inline void DecodeBC1RGBA8(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor,
+        _In_ const D3DX_BC1 *pBC,
+        bool isbc1) noexcept
+    {
+        assert(pColor && pBC);
+
+        const uint32_t r0 = (pBC->rgb[0] >> 11) & 31;
+        const uint32_t g0 = (pBC->rgb[0] >> 5) & 63;
+        const uint32_t b0 = pBC->rgb[0] & 31;
+
+        const uint32_t r1 = (pBC->rgb[1] >> 11) & 31;
+        const uint32_t g1 = (pBC->rgb[1] >> 5) & 63;
+        const uint32_t b1 = pBC->rgb[1] & 31;
+
+        // Endpoints and interpolants are scaled from 5:6:5 in one step with rounding
+        uint32_t clr[4];
+        clr[0] = ((r0 * 255 + 15) / 31) | (((g0 * 255 + 31) / 63) << 8) | (((b0 * 255 + 15) / 31) << 16) | 0xff000000;
+        clr[1] = ((r1 * 255 + 15) / 31) | (((g1 * 255 + 31) / 63) << 8) | (((b1 * 255 + 15) / 31) << 16) | 0xff000000;
+
+        if (isbc1 && (pBC->rgb[0] <= pBC->rgb[1]))
+        {
+            clr[2] = (((r0 + r1) * 255 + 31) / 62)
+                | ((((g0 + g1) * 255 + 63) / 126) << 8)
+                | ((((b0 + b1) * 255 + 31) / 62) << 16)
+                | 0xff000000;
+            clr[3] = 0;  // Alpha of 0
+        }
+        else
+        {
+            clr[2] = (((r0 * 2 + r1) * 255 + 46) / 93)
+                | ((((g0 * 2 + g1) * 255 + 94) / 189) << 8)
+                | ((((b0 * 2 + b1) * 255 + 46) / 93) << 16)
+                | 0xff000000;
+            clr[3] = (((r0 + r1 * 2) * 255 + 46) / 93)
+                | ((((g0 + g1 * 2) * 255 + 94) / 189) << 8)
+                | ((((b0 + b1 * 2) * 255 + 46) / 93) << 16)
+                | 0xff000000;
+        }
+
+        uint32_t dw = pBC->bitmap;
+
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 2)
+        {
+            pColor[i] = clr[dw & 3];
+        }
+    }
+
 
     //-------------------------------------------------------------------------------------
-    void EncodeBC1(
+    // BC1 encoding is split into phases so the endpoint search can be batched across blocks
+    struct BC1Encoding
+    {
+        HDRColorA   Color[NUM_PIXELS_PER_BLOCK];    // Quantized (and weighted) source colors
+        HDRColorA   Step[4];
+        HDRColorA   Dir;
+        float       fSteps;
+        uint32_t    uSteps;
+        const size_t* pSteps;
+    };
+
+    // Returns false if the block was fully encoded as color-keyed
+    bool PrepareBC1(
         _Out_ D3DX_BC1 *pBC,
         _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor,
         bool bColorKey,
         float threshold,
-        uint32_t flags) noexcept
+        uint32_t flags,
+        _Out_ BC1Encoding& enc) noexcept
     {
         assert(pBC && pColor);
         static_assert(sizeof(D3DX_BC1) == 8, "D3DX_BC1 should be 8 bytes");
@@ -395,7 +734,7 @@ namespace
                 pBC->rgb[0] = 0x0000;
                 pBC->rgb[1] = 0xffff;
                 pBC->bitmap = 0xffffffff;
-                return;
+                return false;
             }
 
             uSteps = (uColorKey > 0) ? 3u : 4u;
@@ -405,17 +744,18 @@ namespace
             uSteps = 4u;
         }
 
+        enc.uSteps = uSteps;
+
         // Quantize block to R56B5, using Floyd Stienberg error diffusion.  This
         // increases the chance that colors will map directly to the quantized
         // axis endpoints.
-        HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+        HDRColorA* Color = enc.Color;
         HDRColorA Error[NUM_PIXELS_PER_BLOCK];
 
         if (flags & BC_FLAGS_DITHER_RGB)
             memset(Error, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(HDRColorA));
 
-        size_t i;
-        for (i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
             HDRColorA Clr;
             Clr.r = pColor[i].r;
@@ -489,12 +829,24 @@ namespace
             }
         }
 
-        // Perform 6D root finding function to find two endpoints of color axis.
-        // Then quantize and sort the endpoints depending on mode.
-        HDRColorA ColorA, ColorB, ColorC, ColorD;
+        return true;
+    }
+
+    // Quantizes the endpoints found by OptimizeRGB. Returns false if the block was fully
+    // encoded as a solid color, otherwise sets up the color steps for index selection.
+    bool SetupBC1Endpoints(
+        _Inout_ D3DX_BC1 *pBC,
+        HDRColorA ColorA,
+        HDRColorA ColorB,
+        uint32_t flags,
+        _Inout_ BC1Encoding& enc) noexcept
+    {
+        static const size_t pSteps3[] = { 0, 2, 1 };
+        static const size_t pSteps4[] = { 0, 2, 3, 1 };
 
-        OptimizeRGB(&ColorA, &ColorB, Color, uSteps, flags);
+        const uint32_t uSteps = enc.uSteps;
 
+        HDRColorA ColorC, ColorD;
         if (flags & BC_FLAGS_UNIFORM)
         {
             ColorC = ColorA;
@@ -521,7 +873,7 @@ namespace
             pBC->rgb[0] = wColorA;
             pBC->rgb[1] = wColorB;
             pBC->bitmap = 0x00000000;
-            return;
+            return false;
         }
 
         Decode565(&ColorC, wColorA);
@@ -544,7 +896,7 @@ namespace
         }
 
         // Calculate color steps
-        HDRColorA Step[4];
+        HDRColorA* Step = enc.Step;
 
         if ((3 == uSteps) == (wColorA <= wColorB))
         {
@@ -563,26 +915,22 @@ namespace
             Step[1] = ColorA;
         }
 
-        static const size_t pSteps3[] = { 0, 2, 1 };
-        static const size_t pSteps4[] = { 0, 2, 3, 1 };
-        const size_t *pSteps;
-
         if (3 == uSteps)
         {
-            pSteps = pSteps3;
+            enc.pSteps = pSteps3;
 
             HDRColorALerp(&Step[2], &Step[0], &Step[1], 0.5f);
         }
         else
         {
-            pSteps = pSteps4;
+            enc.pSteps = pSteps4;
 
             HDRColorALerp(&Step[2], &Step[0], &Step[1], 1.0f / 3.0f);
             HDRColorALerp(&Step[3], &Step[0], &Step[1], 2.0f / 3.0f);
         }
 
         // Calculate color direction
-        HDRColorA Dir;
+        HDRColorA& Dir = enc.Dir;
         Dir.r = Step[1].r - Step[0].r;
         Dir.g = Step[1].g - Step[0].g;
         Dir.b = Step[1].b - Step[0].b;
@@ -595,12 +943,32 @@ namespace
         Dir.g *= fScale;
         Dir.b *= fScale;
 
+        enc.fSteps = fSteps;
+
+        return true;
+    }
+
+    void EncodeBC1Indices(
+        _Inout_ D3DX_BC1 *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor,
+        float threshold,
+        uint32_t flags,
+        _In_ const BC1Encoding& enc) noexcept
+    {
+        const HDRColorA* Color = enc.Color;
+        const HDRColorA* Step = enc.Step;
+        const HDRColorA& Dir = enc.Dir;
+        const size_t* pSteps = enc.pSteps;
+        const uint32_t uSteps = enc.uSteps;
+        const float fSteps = enc.fSteps;
+
         // Encode colors
         uint32_t dw = 0;
+        HDRColorA Error[NUM_PIXELS_PER_BLOCK];
         if (flags & BC_FLAGS_DITHER_RGB)
             memset(Error, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(HDRColorA));
 
-        for (i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
             if ((3 == uSteps) && (pColor[i].a < threshold))
             {
@@ -684,6 +1052,187 @@ namespace
         pBC->bitmap = dw;
     }
 
+
+    //-------------------------------------------------------------------------------------
+    void EncodeBC1(
+        _Out_ D3DX_BC1 *pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor,
+        bool bColorKey,
+        float threshold,
+        uint32_t flags) noexcept
+    {
+        BC1Encoding enc;
+        if (!PrepareBC1(pBC, pColor, bColorKey, threshold, flags, enc))
+            return;
+
+        // Perform 6D root finding function to find two endpoints of color axis.
+        // Then quantize and sort the endpoints depending on mode.
+        HDRColorA ColorA, ColorB;
+
+        OptimizeRGB(&ColorA, &ColorB, enc.Color, enc.uSteps, flags);
+
+        if (!SetupBC1Endpoints(pBC, ColorA, ColorB, flags, enc))
+            return;
+
+        EncodeBC1Indices(pBC, pColor, threshold, flags, enc);
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Encodes up to four BC1 blocks at once, running the endpoint search and (when not
+    // dithering) the index selection with one block per SIMD lane.
+    //-------------------------------------------------------------------------------------
+    void EncodeBC1x4(
+        _Out_writes_(count) D3DX_BC1* const *ppBC,
+        _In_reads_(count) const HDRColorA* const *ppColor,
+        size_t count,
+        bool bColorKey,
+        float threshold,
+        uint32_t flags) noexcept
+    {
+        assert(ppBC && ppColor && count > 0 && count <= 4);
+
+    #ifdef COLOR_WEIGHTS
+        for (size_t j = 0; j < count; ++j)
+        {
+            EncodeBC1(ppBC[j], ppColor[j], bColorKey, threshold, flags);
+        }
+    #else
+        BC1Encoding enc[4];
+
+        uint32_t laneMask = 0;
+        size_t first = 4;
+        for (size_t j = 0; j < count; ++j)
+        {
+            if (PrepareBC1(ppBC[j], ppColor[j], bColorKey, threshold, flags, enc[j]))
+            {
+                laneMask |= (1u << j);
+                if (first == 4)
+                    first = j;
+            }
+        }
+
+        if (!laneMask)
+            return;
+
+        // Unused lanes replicate the first active block; their results are discarded
+        const HDRColorA* pPoints[4];
+        uint32_t cSteps[4];
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const size_t k = (laneMask & (1u << j)) ? j : first;
+            pPoints[j] = enc[k].Color;
+            cSteps[j] = enc[k].uSteps;
+        }
+
+        // Perform 6D root finding function to find two endpoints of color axis.
+        HDRColorA ColorA[4], ColorB[4];
+        OptimizeRGBx4(ColorA, ColorB, pPoints, cSteps, laneMask, flags);
+
+        uint32_t indexMask = 0;
+        first = 4;
+        for (size_t j = 0; j < count; ++j)
+        {
+            if ((laneMask & (1u << j))
+                && SetupBC1Endpoints(ppBC[j], ColorA[j], ColorB[j], flags, enc[j]))
+            {
+                indexMask |= (1u << j);
+                if (first == 4)
+                    first = j;
+            }
+        }
+
+        if (!indexMask)
+            return;
+
+        if (flags & BC_FLAGS_DITHER_RGB)
+        {
+            // Error diffusion is serial within a block
+            for (size_t j = 0; j < count; ++j)
+            {
+                if (indexMask & (1u << j))
+                    EncodeBC1Indices(ppBC[j], ppColor[j], threshold, flags, enc[j]);
+            }
+            return;
+        }
+
+        // Encode colors
+        const HDRColorA* pSrc[4];
+        const BC1Encoding* pEnc[4];
+        for (size_t j = 0; j < 4; ++j)
+        {
+            const size_t k = (indexMask & (1u << j)) ? j : first;
+            pSrc[j] = ppColor[k];
+            pEnc[j] = &enc[k];
+        }
+
+        const XMVECTOR Step0R = XMVectorSet(pEnc[0]->Step[0].r, pEnc[1]->Step[0].r, pEnc[2]->Step[0].r, pEnc[3]->Step[0].r);
+        const XMVECTOR Step0G = XMVectorSet(pEnc[0]->Step[0].g, pEnc[1]->Step[0].g, pEnc[2]->Step[0].g, pEnc[3]->Step[0].g);
+        const XMVECTOR Step0B = XMVectorSet(pEnc[0]->Step[0].b, pEnc[1]->Step[0].b, pEnc[2]->Step[0].b, pEnc[3]->Step[0].b);
+        const XMVECTOR DirR = XMVectorSet(pEnc[0]->Dir.r, pEnc[1]->Dir.r, pEnc[2]->Dir.r, pEnc[3]->Dir.r);
+        const XMVECTOR DirG = XMVectorSet(pEnc[0]->Dir.g, pEnc[1]->Dir.g, pEnc[2]->Dir.g, pEnc[3]->Dir.g);
+        const XMVECTOR DirB = XMVectorSet(pEnc[0]->Dir.b, pEnc[1]->Dir.b, pEnc[2]->Dir.b, pEnc[3]->Dir.b);
+
+        XMVECTOR LumR, LumG, LumB;
+        if (flags & BC_FLAGS_UNIFORM)
+        {
+            LumR = LumG = LumB = g_XMOne;
+        }
+        else
+        {
+            LumR = XMVectorReplicate(g_Luminance.r);
+            LumG = XMVectorReplicate(g_Luminance.g);
+            LumB = XMVectorReplicate(g_Luminance.b);
+        }
+
+        uint32_t dw[4] = {};
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            XMVECTOR ClrR = XMVectorSet(pSrc[0][i].r, pSrc[1][i].r, pSrc[2][i].r, pSrc[3][i].r);
+            XMVECTOR ClrG = XMVectorSet(pSrc[0][i].g, pSrc[1][i].g, pSrc[2][i].g, pSrc[3][i].g);
+            XMVECTOR ClrB = XMVectorSet(pSrc[0][i].b, pSrc[1][i].b, pSrc[2][i].b, pSrc[3][i].b);
+
+            if (!(flags & BC_FLAGS_UNIFORM))
+            {
+                ClrR = XMVectorMultiply(ClrR, LumR);
+                ClrG = XMVectorMultiply(ClrG, LumG);
+                ClrB = XMVectorMultiply(ClrB, LumB);
+            }
+
+            const XMVECTOR vDot = XMVectorAdd(
+                XMVectorAdd(
+                    XMVectorMultiply(XMVectorSubtract(ClrR, Step0R), DirR),
+                    XMVectorMultiply(XMVectorSubtract(ClrG, Step0G), DirG)),
+                XMVectorMultiply(XMVectorSubtract(ClrB, Step0B), DirB));
+
+            XMFLOAT4A fDot;
+            XMStoreFloat4A(&fDot, vDot);
+            const float* pDot = reinterpret_cast<const float*>(&fDot);
+
+            for (size_t j = 0; j < 4; ++j)
+            {
+                uint32_t iStep;
+                if ((3 == pEnc[j]->uSteps) && (pSrc[j][i].a < threshold))
+                    iStep = 3u;
+                else if (pDot[j] <= 0.0f)
+                    iStep = 0;
+                else if (pDot[j] >= pEnc[j]->fSteps)
+                    iStep = 1;
+                else
+                    iStep = uint32_t(pEnc[j]->pSteps[uint32_t(pDot[j] + 0.5f)]);
+
+                dw[j] = (iStep << 30) | (dw[j] >> 2);
+            }
+        }
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            if (indexMask & (1u << j))
+                ppBC[j]->bitmap = dw[j];
+        }
+    #endif // COLOR_WEIGHTS
+    }
+
     //-------------------------------------------------------------------------------------
 #ifdef COLOR_WEIGHTS
     void EncodeSolidBC1(_Out_ D3DX_BC1 *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *pColor)
@@ -717,83 +1266,310 @@ namespace
         pBC->bitmap = 0x00000000;
     }
 #endif // COLOR_WEIGHTS
-}
-
-
-//=====================================================================================
-// Entry points
-//=====================================================================================
-
-//-------------------------------------------------------------------------------------
-// BC1 Compression
-//-------------------------------------------------------------------------------------
-_Use_decl_annotations_
-void DirectX::D3DXDecodeBC1(XMVECTOR *pColor, const uint8_t *pBC) noexcept
-{
-    auto pBC1 = reinterpret_cast<const D3DX_BC1 *>(pBC);
-    DecodeBC1(pColor, pBC1, true);
-}
-
-_Use_decl_annotations_
-void DirectX::D3DXEncodeBC1(uint8_t *pBC, const XMVECTOR *pColor, float threshold, uint32_t flags) noexcept
-{
-    assert(pBC && pColor);
-
-    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
 
-    if (flags & BC_FLAGS_DITHER_A)
+    //-------------------------------------------------------------------------------------
+    void LoadBC1Colors(
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA *Color,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor,
+        uint32_t flags) noexcept
     {
-        float fError[NUM_PIXELS_PER_BLOCK] = {};
-
-        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        if (flags & BC_FLAGS_DITHER_A)
         {
-            HDRColorA clr;
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&clr), pColor[i]);
+            float fError[NUM_PIXELS_PER_BLOCK] = {};
 
-            const float fAlph = clr.a + fError[i];
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                HDRColorA clr;
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&clr), pColor[i]);
 
-            Color[i].r = clr.r;
-            Color[i].g = clr.g;
-            Color[i].b = clr.b;
-            Color[i].a = static_cast<float>(static_cast<int32_t>(clr.a + fError[i] + 0.5f));
+                const float fAlph = clr.a + fError[i];
 
-            const float fDiff = fAlph - Color[i].a;
+                Color[i].r = clr.r;
+                Color[i].g = clr.g;
+                Color[i].b = clr.b;
+                Color[i].a = static_cast<float>(static_cast<int32_t>(clr.a + fError[i] + 0.5f));
 
-            if (3 != (i & 3))
-            {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
-            }
-
-            if (i < 12)
-            {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
-
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
+                const float fDiff = fAlph - Color[i].a;
 
                 if (3 != (i & 3))
                 {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
                 }
             }
         }
+        else
+        {
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
+            }
+        }
     }
-    else
+
+    //-------------------------------------------------------------------------------------
+    void EncodeBC3Alpha(
+        _Out_ D3DX_BC3 *pBC3,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA *Color,
+        uint32_t flags) noexcept
     {
+        // Quantize block to A8, using Floyd Stienberg error diffusion.  This
+        // increases the chance that colors will map directly to the quantized
+        // axis endpoints.
+        float fAlpha[NUM_PIXELS_PER_BLOCK] = {};
+        float fError[NUM_PIXELS_PER_BLOCK] = {};
+
+        float fMinAlpha = Color[0].a;
+        float fMaxAlpha = Color[0].a;
+
         for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
         {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
+            float fAlph = Color[i].a;
+            if (flags & BC_FLAGS_DITHER_A)
+                fAlph += fError[i];
+
+            fAlpha[i] = static_cast<float>(static_cast<int32_t>(fAlph * 255.0f + 0.5f)) * (1.0f / 255.0f);
+
+            if (fAlpha[i] < fMinAlpha)
+                fMinAlpha = fAlpha[i];
+            else if (fAlpha[i] > fMaxAlpha)
+                fMaxAlpha = fAlpha[i];
+
+            if (flags & BC_FLAGS_DITHER_A)
+            {
+                const float fDiff = fAlph - fAlpha[i];
+
+                if (3 != (i & 3))
+                {
+                    assert(i < 15);
+                    _Analysis_assume_(i < 15);
+                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+                }
+
+                if (i < 12)
+                {
+                    if (i & 3)
+                        fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                    if (3 != (i & 3))
+                    {
+                        assert(i < 11);
+                        _Analysis_assume_(i < 11);
+                        fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+        }
+
+    #ifdef COLOR_WEIGHTS
+        if (0.0f == fMaxAlpha)
+        {
+            EncodeSolidBC1(&pBC3->dxt1, Color);
+            pBC3->alpha[0] = 0x00;
+            pBC3->alpha[1] = 0x00;
+            memset(pBC3->bitmap, 0x00, 6);
+        }
+    #endif
+
+        // Alpha part
+        if (1.0f == fMinAlpha)
+        {
+            pBC3->alpha[0] = 0xff;
+            pBC3->alpha[1] = 0xff;
+            memset(pBC3->bitmap, 0x00, 6);
+            return;
+        }
+
+        // Optimize and Quantize Min and Max values
+        const uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
+
+        float fAlphaA, fAlphaB;
+        OptimizeAlpha<false>(&fAlphaA, &fAlphaB, fAlpha, uSteps);
+
+        auto const bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
+        auto const bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
+
+        fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
+        fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
+
+        // Setup block
+        if ((8 == uSteps) && (bAlphaA == bAlphaB))
+        {
+            pBC3->alpha[0] = bAlphaA;
+            pBC3->alpha[1] = bAlphaB;
+            memset(pBC3->bitmap, 0x00, 6);
+            return;
+        }
+
+        static const size_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
+        static const size_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+
+        const size_t *pSteps;
+        float fStep[8] = {};
+
+        if (6 == uSteps)
+        {
+            pBC3->alpha[0] = bAlphaA;
+            pBC3->alpha[1] = bAlphaB;
+
+            fStep[0] = fAlphaA;
+            fStep[1] = fAlphaB;
+
+            for (size_t i = 1; i < 5; ++i)
+                fStep[i + 1] = (fStep[0] * float(5u - i) + fStep[1] * float(i)) * (1.0f / 5.0f);
+
+            fStep[6] = 0.0f;
+            fStep[7] = 1.0f;
+
+            pSteps = pSteps6;
+        }
+        else
+        {
+            pBC3->alpha[0] = bAlphaB;
+            pBC3->alpha[1] = bAlphaA;
+
+            fStep[0] = fAlphaB;
+            fStep[1] = fAlphaA;
+
+            for (size_t i = 1; i < 7; ++i)
+                fStep[i + 1] = (fStep[0] * float(7u - i) + fStep[1] * float(i)) * (1.0f / 7.0f);
+
+            pSteps = pSteps8;
+        }
+
+        // Encode alpha bitmap
+        auto const fSteps = static_cast<float>(uSteps - 1);
+        const float fScale = (fStep[0] != fStep[1]) ? (fSteps / (fStep[1] - fStep[0])) : 0.0f;
+
+        if (flags & BC_FLAGS_DITHER_A)
+            memset(fError, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(float));
+
+        for (size_t iSet = 0; iSet < 2; iSet++)
+        {
+            uint32_t dw = 0;
+
+            const size_t iMin = iSet * 8;
+            const size_t iLim = iMin + 8;
+
+            for (size_t i = iMin; i < iLim; ++i)
+            {
+                float fAlph = Color[i].a;
+                if (flags & BC_FLAGS_DITHER_A)
+                    fAlph += fError[i];
+                const float fDot = (fAlph - fStep[0]) * fScale;
+
+                uint32_t iStep;
+                if (fDot <= 0.0f)
+                    iStep = ((6 == uSteps) && (fAlph <= fStep[0] * 0.5f)) ? 6u : 0u;
+                else if (fDot >= fSteps)
+                    iStep = ((6 == uSteps) && (fAlph >= (fStep[1] + 1.0f) * 0.5f)) ? 7u : 1u;
+                else
+                    iStep = uint32_t(pSteps[uint32_t(fDot + 0.5f)]);
+
+                dw = (iStep << 21) | (dw >> 3);
+
+                if (flags & BC_FLAGS_DITHER_A)
+                {
+                    const float fDiff = (fAlph - fStep[iStep]);
+
+                    if (3 != (i & 3))
+                        fError[i + 1] += fDiff * (7.0f / 16.0f);
+
+                    if (i < 12)
+                    {
+                        if (i & 3)
+                            fError[i + 3] += fDiff * (3.0f / 16.0f);
+
+                        fError[i + 4] += fDiff * (5.0f / 16.0f);
+
+                        if (3 != (i & 3))
+                            fError[i + 5] += fDiff * (1.0f / 16.0f);
+                    }
+                }
+            }
+
+            pBC3->bitmap[0 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[0];
+            pBC3->bitmap[1 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[1];
+            pBC3->bitmap[2 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[2];
         }
     }
+}
+
+
+//=====================================================================================
+// Entry points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// BC1 Compression
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC1(XMVECTOR *pColor, const uint8_t *pBC) noexcept
+{
+    auto pBC1 = reinterpret_cast<const D3DX_BC1 *>(pBC);
+    DecodeBC1(pColor, pBC1, true);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC1RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    auto pBC1 = reinterpret_cast<const D3DX_BC1 *>(pBC);
+    DecodeBC1RGBA8(pColor, pBC1, true);
+}
+
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC1(uint8_t *pBC, const XMVECTOR *pColor, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+    LoadBC1Colors(Color, pColor, flags);
 
     auto pBC1 = reinterpret_cast<D3DX_BC1 *>(pBC);
     EncodeBC1(pBC1, Color, true, threshold, flags);
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC1Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t nBlocks, float threshold, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+
+    HDRColorA Color[4][NUM_PIXELS_PER_BLOCK];
+    D3DX_BC1* pBC1[4];
+    const HDRColorA* pColors[4] = { Color[0], Color[1], Color[2], Color[3] };
+
+    for (size_t iBlock = 0; iBlock < nBlocks; iBlock += 4)
+    {
+        const size_t count = std::min<size_t>(4, nBlocks - iBlock);
+
+        for (size_t j = 0; j < count; ++j)
+        {
+            LoadBC1Colors(Color[j], pColor + (iBlock + j) * NUM_PIXELS_PER_BLOCK, flags);
+            pBC1[j] = reinterpret_cast<D3DX_BC1 *>(pBC + (iBlock + j) * sizeof(D3DX_BC1));
+        }
+
+        EncodeBC1x4(pBC1, pColors, count, true, threshold, flags);
+    }
+}
+
 
 //-------------------------------------------------------------------------------------
 // BC2 Compression
@@ -824,6 +1600,29 @@ void DirectX::D3DXDecodeBC2(XMVECTOR *pColor, const uint8_t *pBC) noexcept
         pColor[i] = XMVectorSetW(pColor[i], static_cast<float>(dw & 0xf) * (1.0f / 15.0f));
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC2RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(D3DX_BC2) == 16, "D3DX_BC2 should be 16 bytes");
+
+    auto pBC2 = reinterpret_cast<const D3DX_BC2 *>(pBC);
+
+    // RGB part
+    DecodeBC1RGBA8(pColor, &pBC2->bc1, false);
+
+    // 4-bit alpha part (x17 expands a nibble to 8 bits exactly)
+    uint32_t dw = pBC2->bitmap[0];
+
+    for (size_t i = 0; i < 8; ++i, dw >>= 4)
+        pColor[i] = (pColor[i] & 0x00ffffff) | (((dw & 0xf) * 17) << 24);
+
+    dw = pBC2->bitmap[1];
+
+    for (size_t i = 8; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 4)
+        pColor[i] = (pColor[i] & 0x00ffffff) | (((dw & 0xf) * 17) << 24);
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC2(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
@@ -941,201 +1740,99 @@ void DirectX::D3DXDecodeBC3(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 }
 
 _Use_decl_annotations_
-void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+void DirectX::D3DXDecodeBC3RGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
 {
-    assert(pBC && pColor);
+    assert(pColor && pBC);
     static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
-    {
-        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
-    }
+    auto pBC3 = reinterpret_cast<const D3DX_BC3 *>(pBC);
 
-    auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC);
+    // RGB part
+    DecodeBC1RGBA8(pColor, &pBC3->bc1, false);
 
-    // Quantize block to A8, using Floyd Stienberg error diffusion.  This
-    // increases the chance that colors will map directly to the quantized
-    // axis endpoints.
-    float fAlpha[NUM_PIXELS_PER_BLOCK] = {};
-    float fError[NUM_PIXELS_PER_BLOCK] = {};
+    // Adaptive 3-bit alpha part
+    uint32_t alpha[8];
 
-    float fMinAlpha = Color[0].a;
-    float fMaxAlpha = Color[0].a;
+    alpha[0] = pBC3->alpha[0];
+    alpha[1] = pBC3->alpha[1];
 
-    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    if (alpha[0] > alpha[1])
     {
-        float fAlph = Color[i].a;
-        if (flags & BC_FLAGS_DITHER_A)
-            fAlph += fError[i];
-
-        fAlpha[i] = static_cast<float>(static_cast<int32_t>(fAlph * 255.0f + 0.5f)) * (1.0f / 255.0f);
-
-        if (fAlpha[i] < fMinAlpha)
-            fMinAlpha = fAlpha[i];
-        else if (fAlpha[i] > fMaxAlpha)
-            fMaxAlpha = fAlpha[i];
-
-        if (flags & BC_FLAGS_DITHER_A)
-        {
-            const float fDiff = fAlph - fAlpha[i];
-
-            if (3 != (i & 3))
-            {
-                assert(i < 15);
-                _Analysis_assume_(i < 15);
-                fError[i + 1] += fDiff * (7.0f / 16.0f);
-            }
-
-            if (i < 12)
-            {
-                if (i & 3)
-                    fError[i + 3] += fDiff * (3.0f / 16.0f);
-
-                fError[i + 4] += fDiff * (5.0f / 16.0f);
-
-                if (3 != (i & 3))
-                {
-                    assert(i < 11);
-                    _Analysis_assume_(i < 11);
-                    fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
-        }
+        for (uint32_t i = 1; i < 7; ++i)
+            alpha[i + 1] = (alpha[0] * (7u - i) + alpha[1] * i + 3) / 7;
     }
-
-#ifdef COLOR_WEIGHTS
-    if (0.0f == fMaxAlpha)
+    else
     {
-        EncodeSolidBC1(&pBC3->dxt1, Color);
-        pBC3->alpha[0] = 0x00;
-        pBC3->alpha[1] = 0x00;
-        memset(pBC3->bitmap, 0x00, 6);
-    }
-#endif
+        for (uint32_t i = 1; i < 5; ++i)
+            alpha[i + 1] = (alpha[0] * (5u - i) + alpha[1] * i + 2) / 5;
 
-    // RGB part
-    EncodeBC1(&pBC3->bc1, Color, false, 0.f, flags);
-
-    // Alpha part
-    if (1.0f == fMinAlpha)
-    {
-        pBC3->alpha[0] = 0xff;
-        pBC3->alpha[1] = 0xff;
-        memset(pBC3->bitmap, 0x00, 6);
-        return;
+        alpha[6] = 0;
+        alpha[7] = 255;
     }
 
-    // Optimize and Quantize Min and Max values
-    const uint32_t uSteps = ((0.0f == fMinAlpha) || (1.0f == fMaxAlpha)) ? 6u : 8u;
-
-    float fAlphaA, fAlphaB;
-    OptimizeAlpha<false>(&fAlphaA, &fAlphaB, fAlpha, uSteps);
-
-    auto const bAlphaA = static_cast<uint8_t>(static_cast<int32_t>(fAlphaA * 255.0f + 0.5f));
-    auto const bAlphaB = static_cast<uint8_t>(static_cast<int32_t>(fAlphaB * 255.0f + 0.5f));
+    uint32_t dw = uint32_t(pBC3->bitmap[0]) | uint32_t(pBC3->bitmap[1] << 8) | uint32_t(pBC3->bitmap[2] << 16);
 
-    fAlphaA = static_cast<float>(bAlphaA) * (1.0f / 255.0f);
-    fAlphaB = static_cast<float>(bAlphaB) * (1.0f / 255.0f);
+    for (size_t i = 0; i < 8; ++i, dw >>= 3)
+        pColor[i] = (pColor[i] & 0x00ffffff) | (alpha[dw & 0x7] << 24);
 
-    // Setup block
-    if ((8 == uSteps) && (bAlphaA == bAlphaB))
-    {
-        pBC3->alpha[0] = bAlphaA;
-        pBC3->alpha[1] = bAlphaB;
-        memset(pBC3->bitmap, 0x00, 6);
-        return;
-    }
+    dw = uint32_t(pBC3->bitmap[3]) | uint32_t(pBC3->bitmap[4] << 8) | uint32_t(pBC3->bitmap[5] << 16);
 
-    static const size_t pSteps6[] = { 0, 2, 3, 4, 5, 1 };
-    static const size_t pSteps8[] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+    for (size_t i = 8; i < NUM_PIXELS_PER_BLOCK; ++i, dw >>= 3)
+        pColor[i] = (pColor[i] & 0x00ffffff) | (alpha[dw & 0x7] << 24);
+}
 
-    const size_t *pSteps;
-    float fStep[8] = {};
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-    if (6 == uSteps)
+    HDRColorA Color[NUM_PIXELS_PER_BLOCK];
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
     {
-        pBC3->alpha[0] = bAlphaA;
-        pBC3->alpha[1] = bAlphaB;
-
-        fStep[0] = fAlphaA;
-        fStep[1] = fAlphaB;
-
-        for (size_t i = 1; i < 5; ++i)
-            fStep[i + 1] = (fStep[0] * float(5u - i) + fStep[1] * float(i)) * (1.0f / 5.0f);
-
-        fStep[6] = 0.0f;
-        fStep[7] = 1.0f;
-
-        pSteps = pSteps6;
+        XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[i]), pColor[i]);
     }
-    else
-    {
-        pBC3->alpha[0] = bAlphaB;
-        pBC3->alpha[1] = bAlphaA;
 
-        fStep[0] = fAlphaB;
-        fStep[1] = fAlphaA;
+    auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC);
 
-        for (size_t i = 1; i < 7; ++i)
-            fStep[i + 1] = (fStep[0] * float(7u - i) + fStep[1] * float(i)) * (1.0f / 7.0f);
+    // RGB part
+    EncodeBC1(&pBC3->bc1, Color, false, 0.f, flags);
 
-        pSteps = pSteps8;
-    }
+    // Alpha part
+    EncodeBC3Alpha(pBC3, Color, flags);
+}
 
-    // Encode alpha bitmap
-    auto const fSteps = static_cast<float>(uSteps - 1);
-    const float fScale = (fStep[0] != fStep[1]) ? (fSteps / (fStep[1] - fStep[0])) : 0.0f;
+_Use_decl_annotations_
+void DirectX::D3DXEncodeBC3Batch(uint8_t *pBC, const XMVECTOR *pColor, size_t nBlocks, uint32_t flags) noexcept
+{
+    assert(pBC && pColor);
+    static_assert(sizeof(D3DX_BC3) == 16, "D3DX_BC3 should be 16 bytes");
 
-    if (flags & BC_FLAGS_DITHER_A)
-        memset(fError, 0x00, NUM_PIXELS_PER_BLOCK * sizeof(float));
+    HDRColorA Color[4][NUM_PIXELS_PER_BLOCK];
+    D3DX_BC1* pBC1[4];
+    const HDRColorA* pColors[4] = { Color[0], Color[1], Color[2], Color[3] };
 
-    for (size_t iSet = 0; iSet < 2; iSet++)
+    for (size_t iBlock = 0; iBlock < nBlocks; iBlock += 4)
     {
-        uint32_t dw = 0;
+        const size_t count = std::min<size_t>(4, nBlocks - iBlock);
 
-        const size_t iMin = iSet * 8;
-        const size_t iLim = iMin + 8;
-
-        for (size_t i = iMin; i < iLim; ++i)
+        for (size_t j = 0; j < count; ++j)
         {
-            float fAlph = Color[i].a;
-            if (flags & BC_FLAGS_DITHER_A)
-                fAlph += fError[i];
-            const float fDot = (fAlph - fStep[0]) * fScale;
-
-            uint32_t iStep;
-            if (fDot <= 0.0f)
-                iStep = ((6 == uSteps) && (fAlph <= fStep[0] * 0.5f)) ? 6u : 0u;
-            else if (fDot >= fSteps)
-                iStep = ((6 == uSteps) && (fAlph >= (fStep[1] + 1.0f) * 0.5f)) ? 7u : 1u;
-            else
-                iStep = uint32_t(pSteps[uint32_t(fDot + 0.5f)]);
-
-            dw = (iStep << 21) | (dw >> 3);
-
-            if (flags & BC_FLAGS_DITHER_A)
+            const XMVECTOR* pBlock = pColor + (iBlock + j) * NUM_PIXELS_PER_BLOCK;
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
             {
-                const float fDiff = (fAlph - fStep[iStep]);
+                XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(&Color[j][i]), pBlock[i]);
+            }
 
-                if (3 != (i & 3))
-                    fError[i + 1] += fDiff * (7.0f / 16.0f);
+            auto pBC3 = reinterpret_cast<D3DX_BC3 *>(pBC + (iBlock + j) * sizeof(D3DX_BC3));
 
-                if (i < 12)
-                {
-                    if (i & 3)
-                        fError[i + 3] += fDiff * (3.0f / 16.0f);
-
-                    fError[i + 4] += fDiff * (5.0f / 16.0f);
+            // Alpha part
+            EncodeBC3Alpha(pBC3, Color[j], flags);
 
-                    if (3 != (i & 3))
-                        fError[i + 5] += fDiff * (1.0f / 16.0f);
-                }
-            }
+            pBC1[j] = &pBC3->bc1;
         }
 
-        pBC3->bitmap[0 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[0];
-        pBC3->bitmap[1 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[1];
-        pBC3->bitmap[2 + iSet * 3] = reinterpret_cast<uint8_t *>(&dw)[2];
+        // RGB part
+        EncodeBC1x4(pBC1, pColors, count, false, 0.f, flags);
     }
 }
@@ -27,6 +27,9 @@ namespace DirectX
 // Constants
 //-------------------------------------------------------------------------------------
 
+    constexpr size_t BC_BLOCKS_PER_BATCH = 4;
+        // Number of blocks the batched encoders solve together (one per SIMD lane)
+
     enum BC_FLAGS : uint32_t
     {
         BC_FLAGS_NONE = 0x0,
@@ -45,6 +48,9 @@ namespace DirectX
 
         BC_FLAGS_FORCE_BC7_MODE6 = 0x100000,
         // BC7 should only use mode 6; skip other modes
+
+        BC_FLAGS_FORCE_BC6H_1REGION = 0x200000,
+        // BC6H should only use the single region modes (11-14); skip the two region modes
     };
 
     //-------------------------------------------------------------------------------------
@@ -323,6 +329,16 @@ namespace DirectX
     void D3DXDecodeBC6HS(_Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
     void D3DXDecodeBC7(_Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
 
+    typedef void (*BC_DECODE_RGBA8)(uint32_t *pColor, const uint8_t *pBC);
+
+    void D3DXDecodeBC1RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(8) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC2RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC3RGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC4URGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(8) const uint8_t *pBC) noexcept;
+    void D3DXDecodeBC5URGBA8(_Out_writes_(NUM_PIXELS_PER_BLOCK) uint32_t *pColor, _In_reads_(16) const uint8_t *pBC) noexcept;
+        // Integer decoders which return R8G8B8A8 texels (red in the low byte) without going through float.
+        // Values are rounded as when storing the float decoder results to UNORM, and BC4 replicates red to RGB.
+
     void D3DXEncodeBC1(_Out_writes_(8) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ float threshold, _In_ uint32_t flags) noexcept;
         // BC1 requires one additional parameter, so it doesn't match signature of BC_ENCODE above
 
@@ -336,4 +352,13 @@ namespace DirectX
     void D3DXEncodeBC6HS(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
     void D3DXEncodeBC7(_Out_writes_(16) uint8_t *pBC, _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ uint32_t flags) noexcept;
 
+    void D3DXEncodeBC1Batch(
+        _Out_writes_(nBlocks * 8) uint8_t *pBC, _In_reads_(nBlocks * NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ size_t nBlocks,
+        _In_ float threshold, _In_ uint32_t flags) noexcept;
+    void D3DXEncodeBC3Batch(
+        _Out_writes_(nBlocks * 16) uint8_t *pBC, _In_reads_(nBlocks * NUM_PIXELS_PER_BLOCK) const XMVECTOR *pColor, _In_ size_t nBlocks,
+        _In_ uint32_t flags) noexcept;
+        // Encodes nBlocks consecutive blocks, solving the RGB endpoints for up to 4 blocks at a time in SIMD lanes.
+        // Results are bit-identical to calling D3DXEncodeBC1 / D3DXEncodeBC3 once per block.
+
 } // namespace
@@ -68,6 +68,26 @@ namespace
             }
         }
 
+        // Integer palette, rounded to match the float decode stored as 8-bit UNORM
+        void DecodePalette(_Out_writes_(8) uint32_t* palette) const noexcept
+        {
+            palette[0] = red_0;
+            palette[1] = red_1;
+            if (red_0 > red_1)
+            {
+                for (uint32_t i = 1; i < 7; ++i)
+                    palette[i + 1] = (uint32_t(red_0) * (7u - i) + uint32_t(red_1) * i + 3) / 7;
+            }
+            else
+            {
+                for (uint32_t i = 1; i < 5; ++i)
+                    palette[i + 1] = (uint32_t(red_0) * (5u - i) + uint32_t(red_1) * i + 2) / 5;
+
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+        }
+
         size_t GetIndex(size_t uOffset) const noexcept
         {
             return static_cast<size_t>((data >> (3 * uOffset + 16)) & 0x07);
@@ -400,6 +420,25 @@ void DirectX::D3DXDecodeBC4U(XMVECTOR *pColor, const uint8_t *pBC) noexcept
     }
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC4URGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
+
+    auto pBC4 = reinterpret_cast<const BC4_UNORM*>(pBC);
+
+    uint32_t palette[8];
+    pBC4->DecodePalette(palette);
+
+    // Red is replicated to green and blue, matching the R -> RGB conversion of the float path
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        const uint32_t r = palette[pBC4->GetIndex(i)];
+        pColor[i] = r | (r << 8) | (r << 16) | 0xff000000;
+    }
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXDecodeBC4S(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 {
@@ -477,6 +516,26 @@ void DirectX::D3DXDecodeBC5U(XMVECTOR *pColor, const uint8_t *pBC) noexcept
     }
 }
 
+_Use_decl_annotations_
+void DirectX::D3DXDecodeBC5URGBA8(uint32_t *pColor, const uint8_t *pBC) noexcept
+{
+    assert(pColor && pBC);
+    static_assert(sizeof(BC4_UNORM) == 8, "BC4_UNORM should be 8 bytes");
+
+    auto pBCR = reinterpret_cast<const BC4_UNORM*>(pBC);
+    auto pBCG = reinterpret_cast<const BC4_UNORM*>(pBC + sizeof(BC4_UNORM));
+
+    uint32_t paletteR[8];
+    uint32_t paletteG[8];
+    pBCR->DecodePalette(paletteR);
+    pBCG->DecodePalette(paletteG);
+
+    for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+    {
+        pColor[i] = paletteR[pBCR->GetIndex(i)] | (paletteG[pBCG->GetIndex(i)] << 8) | 0xff000000;
+    }
+}
+
 _Use_decl_annotations_
 void DirectX::D3DXDecodeBC5S(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 {
@@ -656,7 +656,7 @@ namespace
     {
     public:
         void Decode(_In_ bool bSigned, _Out_writes_(NUM_PIXELS_PER_BLOCK) HDRColorA* pOut) const noexcept;
-        void Encode(_In_ bool bSigned, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
+        void Encode(_In_ bool bSigned, uint32_t flags, _In_reads_(NUM_PIXELS_PER_BLOCK) const HDRColorA* const pIn) noexcept;
 
     private:
     #pragma warning(push)
@@ -1806,7 +1806,7 @@ void D3DX_BC6H::Decode(bool bSigned, HDRColorA* pOut) const noexcept
 
 
 _Use_decl_annotations_
-void D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn) noexcept
+void D3DX_BC6H::Encode(bool bSigned, uint32_t flags, const HDRColorA* const pIn) noexcept
 {
     assert(pIn);
 
@@ -1814,6 +1814,12 @@ void D3DX_BC6H::Encode(bool bSigned, const HDRColorA* const pIn) noexcept
 
     for (EP.uMode = 0; EP.uMode < c_NumModes && EP.fBestErr > 0; ++EP.uMode)
     {
+        if ((flags & BC_FLAGS_FORCE_BC6H_1REGION) && ms_aInfo[EP.uMode].uPartitions)
+        {
+            // Use only the single region modes
+            continue;
+        }
+
         const uint8_t uShapes = ms_aInfo[EP.uMode].uPartitions ? 32u : 1u;
         // Number of rough cases to look at. reasonable values of this are 1, uShapes/4, and uShapes
         // uShapes/4 gets nearly all the cases; you can increase that a bit (say by 3 or 4) if you really want to squeeze the last bit out
@@ -3598,19 +3604,17 @@ void DirectX::D3DXDecodeBC6HS(XMVECTOR *pColor, const uint8_t *pBC) noexcept
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC6HU(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
-    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(false, reinterpret_cast<const HDRColorA*>(pColor));
+    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(false, flags, reinterpret_cast<const HDRColorA*>(pColor));
 }
 
 _Use_decl_annotations_
 void DirectX::D3DXEncodeBC6HS(uint8_t *pBC, const XMVECTOR *pColor, uint32_t flags) noexcept
 {
-    UNREFERENCED_PARAMETER(flags);
     assert(pBC && pColor);
     static_assert(sizeof(D3DX_BC6H) == 16, "D3DX_BC6H should be 16 bytes");
-    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(true, reinterpret_cast<const HDRColorA*>(pColor));
+    reinterpret_cast<D3DX_BC6H*>(pBC)->Encode(true, flags, reinterpret_cast<const HDRColorA*>(pColor));
 }
 
 
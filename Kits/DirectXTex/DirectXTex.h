@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -246,6 +247,20 @@ namespace DirectX
 
         TGA_FLAGS_DEFAULT_SRGB = 0x80,
         // If no colorspace is specified in TGA 2.0 metadata, assume sRGB
+
+        TGA_FLAGS_RLE = 0x100,
+        // Writes run-length encoded (RLE) pixel data
+
+        TGA_FLAGS_PARALLEL = 0x10000000,
+        // Decodes scanlines using multiple threads
+    };
+
+    enum HDR_FLAGS : unsigned long
+    {
+        HDR_FLAGS_NONE = 0x0,
+
+        HDR_FLAGS_PARALLEL = 0x10000000,
+        // Decodes scanlines using multiple threads
     };
 
     enum WIC_FLAGS : unsigned long
@@ -351,13 +366,65 @@ namespace DirectX
         uint8_t*    pixels;
     };
 
+    //---------------------------------------------------------------------------------
+    // Allocator for ScratchImage and Blob storage (returned memory must be 16-byte aligned)
+    class IAllocator
+    {
+    public:
+        virtual ~IAllocator() = default;
+
+        virtual void* __cdecl Allocate(_In_ size_t size) noexcept = 0;
+
+        virtual void __cdecl Free(_In_opt_ void* ptr, _In_ size_t size) noexcept = 0;
+            // size is the value that was passed to Allocate for this memory
+
+    protected:
+        IAllocator() = default;
+        IAllocator(const IAllocator&) = default;
+        IAllocator& operator=(const IAllocator&) = default;
+    };
+
+    IAllocator* __cdecl GetDefaultAllocator() noexcept;
+
+    void __cdecl SetDefaultAllocator(_In_opt_ IAllocator* allocator) noexcept;
+        // Used by ScratchImage and Blob objects constructed without an explicit allocator; nullptr restores the heap
+        // The allocator must outlive every object that was constructed while it was the default
+
+    // Size-bucketed pool that recycles freed buffers instead of returning them to the heap (thread-safe)
+    class BufferPool : public IAllocator
+    {
+    public:
+        explicit BufferPool(_In_ size_t maxCachedBytes = 256 * 1024 * 1024) noexcept;
+            // maxCachedBytes limits the memory held by the pool while not in use (0 for no limit)
+
+        ~BufferPool() override;
+
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        void* __cdecl Allocate(_In_ size_t size) noexcept override;
+        void __cdecl Free(_In_opt_ void* ptr, _In_ size_t size) noexcept override;
+
+        void __cdecl Trim() noexcept;
+            // Returns all cached buffers to the heap
+
+        size_t __cdecl GetCachedBytes() const noexcept;
+
+    private:
+        struct Impl;
+        Impl* m_impl;
+    };
+
     class ScratchImage
     {
     public:
         ScratchImage() noexcept
-            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr) {}
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(GetDefaultAllocator()) {}
+        explicit ScratchImage(_In_opt_ IAllocator* allocator) noexcept
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr),
+            m_allocator(allocator ? allocator : GetDefaultAllocator()) {}
         ScratchImage(ScratchImage&& moveFrom) noexcept
-            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr) { *this = std::move(moveFrom); }
+            : m_nimages(0), m_size(0), m_metadata{}, m_image(nullptr), m_memory(nullptr), m_allocator(nullptr) { *this = std::move(moveFrom); }
         ~ScratchImage() { Release(); }
 
         ScratchImage& __cdecl operator= (ScratchImage&& moveFrom) noexcept;
@@ -392,12 +459,15 @@ namespace DirectX
 
         bool __cdecl IsAlphaAllOpaque() const noexcept;
 
+        IAllocator* __cdecl GetAllocator() const noexcept { return m_allocator; }
+
     private:
         size_t      m_nimages;
         size_t      m_size;
         TexMetadata m_metadata;
         Image*      m_image;
         uint8_t*    m_memory;
+        IAllocator* m_allocator;
     };
 
     //---------------------------------------------------------------------------------
@@ -405,8 +475,10 @@ namespace DirectX
     class Blob
     {
     public:
-        Blob() noexcept : m_buffer(nullptr), m_size(0) {}
-        Blob(Blob&& moveFrom) noexcept : m_buffer(nullptr), m_size(0) { *this = std::move(moveFrom); }
+        Blob() noexcept : m_buffer(nullptr), m_size(0), m_capacity(0), m_allocator(GetDefaultAllocator()) {}
+        explicit Blob(_In_opt_ IAllocator* allocator) noexcept
+            : m_buffer(nullptr), m_size(0), m_capacity(0), m_allocator(allocator ? allocator : GetDefaultAllocator()) {}
+        Blob(Blob&& moveFrom) noexcept : m_buffer(nullptr), m_size(0), m_capacity(0), m_allocator(nullptr) { *this = std::move(moveFrom); }
         ~Blob() { Release(); }
 
         Blob& __cdecl operator= (Blob&& moveFrom) noexcept;
@@ -427,9 +499,56 @@ namespace DirectX
         HRESULT __cdecl Trim(size_t size) noexcept;
             // Shorten size without reallocation
 
+        IAllocator* __cdecl GetAllocator() const noexcept { return m_allocator; }
+
     private:
-        void*   m_buffer;
-        size_t  m_size;
+        void*       m_buffer;
+        size_t      m_size;
+        size_t      m_capacity;
+        IAllocator* m_allocator;
+    };
+
+    //---------------------------------------------------------------------------------
+    // Read-only view of a DDS file mapped into memory
+    class DDSFileView
+    {
+    public:
+        DDSFileView() noexcept
+            : m_nimages(0), m_metadata{}, m_image(nullptr), m_mapping(nullptr), m_mappingSize(0) {}
+        DDSFileView(DDSFileView&& moveFrom) noexcept
+            : m_nimages(0), m_metadata{}, m_image(nullptr), m_mapping(nullptr), m_mappingSize(0) { *this = std::move(moveFrom); }
+        ~DDSFileView() { Release(); }
+
+        DDSFileView& __cdecl operator= (DDSFileView&& moveFrom) noexcept;
+
+        DDSFileView(const DDSFileView&) = delete;
+        DDSFileView& operator=(const DDSFileView&) = delete;
+
+        void __cdecl Release() noexcept;
+
+        const TexMetadata& __cdecl GetMetadata() const noexcept { return m_metadata; }
+        const Image* __cdecl GetImage(_In_ size_t mip, _In_ size_t item, _In_ size_t slice) const noexcept;
+
+        const Image* __cdecl GetImages() const noexcept;
+        size_t __cdecl GetImageCount() const noexcept;
+
+        bool __cdecl IsMapped() const noexcept { return m_image != nullptr; }
+            // Images point directly into the file mapping and must not be written to
+            // Otherwise the file required conversion and the images are a private copy
+
+    private:
+        friend HRESULT __cdecl LoadFromDDSFile(
+            _In_z_ const wchar_t* szFile, _In_ DDS_FLAGS flags,
+            _Out_opt_ TexMetadata* metadata, _Out_ DDSFileView& view) noexcept;
+
+        void __cdecl Unmap() noexcept;
+
+        size_t          m_nimages;
+        TexMetadata     m_metadata;
+        Image*          m_image;
+        void*           m_mapping;
+        size_t          m_mappingSize;
+        ScratchImage    m_copy;
     };
 
     //---------------------------------------------------------------------------------
@@ -444,6 +563,12 @@ namespace DirectX
         _In_z_ const wchar_t* szFile,
         _In_ DDS_FLAGS flags,
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl LoadFromDDSFile(
+        _In_z_ const wchar_t* szFile,
+        _In_ DDS_FLAGS flags,
+        _Out_opt_ TexMetadata* metadata, _Out_ DDSFileView& view) noexcept;
+        // Memory-maps the file and returns images that reference the mapping without copying
+        // Files that need legacy format conversion are decoded into a copy owned by the view
 
     HRESULT __cdecl SaveToDDSMemory(
         _In_ const Image& image,
@@ -466,6 +591,14 @@ namespace DirectX
     HRESULT __cdecl LoadFromHDRFile(
         _In_z_ const wchar_t* szFile,
         _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl LoadFromHDRMemory(
+        _In_reads_bytes_(size) const void* pSource, _In_ size_t size,
+        _In_ HDR_FLAGS flags,
+        _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl LoadFromHDRFile(
+        _In_z_ const wchar_t* szFile,
+        _In_ HDR_FLAGS flags,
+        _Out_opt_ TexMetadata* metadata, _Out_ ScratchImage& image) noexcept;
 
     HRESULT __cdecl SaveToHDRMemory(_In_ const Image& image, _Out_ Blob& blob) noexcept;
     HRESULT __cdecl SaveToHDRFile(_In_ const Image& image, _In_z_ const wchar_t* szFile) noexcept;
@@ -544,13 +677,12 @@ namespace DirectX
         TEX_FR_FLIP_VERTICAL = 0x10,
     };
 
-#ifdef _WIN32
     HRESULT __cdecl FlipRotate(_In_ const Image& srcImage, _In_ TEX_FR_FLAGS flags, _Out_ ScratchImage& image) noexcept;
     HRESULT __cdecl FlipRotate(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ TEX_FR_FLAGS flags, _Out_ ScratchImage& result) noexcept;
-        // Flip and/or rotate image
-#endif
+        // Flip and/or rotate image; the rotation (clockwise) is applied before any flips
+        // BC1 through BC5 are supported by permuting blocks, if the image is whole blocks or a single block
 
     enum TEX_FILTER_FLAGS : unsigned long
     {
@@ -589,7 +721,10 @@ namespace DirectX
         TEX_FILTER_BOX = 0x400000,
         TEX_FILTER_FANT = 0x400000, // Equiv to Box filtering for mipmap generation
         TEX_FILTER_TRIANGLE = 0x500000,
+        TEX_FILTER_LANCZOS3 = 0x600000,
+        TEX_FILTER_MITCHELL = 0x700000,
         // Filtering mode to use for any required image resizing
+        // Lanczos3 and Mitchell are only implemented by the non-WIC code paths
 
         TEX_FILTER_SRGB_IN = 0x1000000,
         TEX_FILTER_SRGB_OUT = 0x2000000,
@@ -603,6 +738,10 @@ namespace DirectX
 
         TEX_FILTER_FORCE_WIC = 0x20000000,
         // Forces use of the WIC path even when logic would have picked a non-WIC path when both are an option
+
+        TEX_FILTER_PARALLEL = 0x40000000,
+        // Use multiple threads for the non-WIC filtering code paths; results are the same as without it
+        // For mipmap generation, rows of every item or slice in a level are processed concurrently (box and point: one item per thread)
     };
 
     constexpr unsigned long TEX_FILTER_DITHER_MASK = 0xF0000;
@@ -654,6 +793,22 @@ namespace DirectX
         // levels of '0' indicates a full mipchain, otherwise is generates that number of total levels (including the source base image)
         // Defaults to Fant filtering which is equivalent to a box filter
 
+    HRESULT __cdecl ResizeStreaming(
+        _In_ size_t srcWidth, _In_ size_t srcHeight, _In_ DXGI_FORMAT format,
+        _In_ size_t width, _In_ size_t height, _In_ TEX_FILTER_FLAGS filter,
+        _In_ std::function<HRESULT __cdecl(_Out_writes_bytes_(rowPitch) uint8_t* pixels, size_t rowPitch, size_t y)> readRow,
+        _In_ std::function<HRESULT __cdecl(_In_reads_bytes_(rowPitch) const uint8_t* pixels, size_t rowPitch, size_t y)> writeRow);
+    HRESULT __cdecl GenerateMipMapsStreaming(
+        _In_ size_t width, _In_ size_t height, _In_ DXGI_FORMAT format,
+        _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels,
+        _In_ std::function<HRESULT __cdecl(_Out_writes_bytes_(rowPitch) uint8_t* pixels, size_t rowPitch, size_t y)> readRow,
+        _In_ std::function<HRESULT __cdecl(_In_reads_bytes_(rowPitch) const uint8_t* pixels, size_t rowPitch, size_t level, size_t y)> writeRow);
+        // Resize or generate mips for images too large to hold in memory, using any of the non-WIC filters
+        // Source rows are requested exactly once in top-down order, and each destination row is passed to writeRow as soon as it is complete
+        // Working memory is bounded by the vertical filter support times the image width
+        // TEX_FILTER_WRAP_V is not supported, as it would need the whole destination in memory; TEX_FILTER_WRAP_U is
+        // GenerateMipMapsStreaming delivers levels 1 through levels - 1 with their rows interleaved
+
     HRESULT __cdecl ScaleMipMapsAlphaForCoverage(
         _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata, _In_ size_t item,
         _In_ float alphaReference, _Inout_ ScratchImage& mipChain) noexcept;
@@ -674,6 +829,9 @@ namespace DirectX
         TEX_PMALPHA_SRGB = (TEX_PMALPHA_SRGB_IN | TEX_PMALPHA_SRGB_OUT),
         // if the input format type is IsSRGB(), then SRGB_IN is on by default
         // if the output format type is IsSRGB(), then SRGB_OUT is on by default
+
+        TEX_PMALPHA_PARALLEL = 0x10000000,
+        // Use multithreading to process bands of rows (the result is identical to the single-threaded one)
     };
 
     HRESULT __cdecl PremultiplyAlpha(_In_ const Image& srcImage, _In_ TEX_PMALPHA_FLAGS flags, _Out_ ScratchImage& image) noexcept;
@@ -704,6 +862,13 @@ namespace DirectX
         TEX_COMPRESS_BC7_QUICK = 0x100000,
         // Minimal modes (usually mode 6) for BC7 compression
 
+        TEX_COMPRESS_BC6H_QUICK = 0x200000,
+        // Minimal modes (single region modes only) for BC6H compression
+
+        TEX_COMPRESS_PROGRESSIVE = 0x400000,
+        // Progressive BC6H/BC7 compression: encodes every block with the quick modes first, then refines
+        // the worst blocks with the full search until the CompressOptions time budget or target error is met
+
         TEX_COMPRESS_SRGB_IN = 0x1000000,
         TEX_COMPRESS_SRGB_OUT = 0x2000000,
         TEX_COMPRESS_SRGB = (TEX_COMPRESS_SRGB_IN | TEX_COMPRESS_SRGB_OUT),
@@ -722,6 +887,78 @@ namespace DirectX
         _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress, _In_ float threshold, _Out_ ScratchImage& cImages) noexcept;
         // Note that threshold is only used by BC1. TEX_THRESHOLD_DEFAULT is a typical value to use
 
+    // Persistent store of compressed tiles keyed by a hash of their source pixels and compression settings (thread-safe)
+    class CompressionCache
+    {
+    public:
+        CompressionCache() noexcept;
+        ~CompressionCache();
+
+        CompressionCache(const CompressionCache&) = delete;
+        CompressionCache& operator=(const CompressionCache&) = delete;
+
+        HRESULT __cdecl Initialize(_In_z_ const wchar_t* szDirectory, _In_ uint64_t maxBytes) noexcept;
+            // Creates the directory if needed and indexes the entries already in it. Several processes may share it.
+            // maxBytes limits the size of the store by evicting the least recently used entries (0 for no limit)
+
+        bool __cdecl Lookup(_In_reads_(2) const uint64_t key[2], _Out_writes_bytes_(size) void* data, _In_ size_t size) noexcept;
+        HRESULT __cdecl Store(_In_reads_(2) const uint64_t key[2], _In_reads_bytes_(size) const void* data, _In_ size_t size) noexcept;
+            // Used by CompressEx; an entry is only returned when both its key and size match
+
+        void __cdecl Trim(_In_ uint64_t maxBytes) noexcept;
+            // Evicts least recently used entries until the store fits in maxBytes
+
+        void __cdecl Release() noexcept;
+            // Closes the store, leaving the entries on disk
+
+        uint64_t __cdecl GetSize() const noexcept;
+        uint64_t __cdecl GetHitCount() const noexcept;
+        uint64_t __cdecl GetMissCount() const noexcept;
+
+    private:
+        struct Impl;
+        Impl* m_impl;
+    };
+
+    struct CompressOptions
+    {
+        TEX_COMPRESS_FLAGS  flags;
+        float               threshold;
+        size_t              threadCount;
+        // Number of worker threads used for TEX_COMPRESS_PARALLEL (0 uses one per hardware thread)
+
+        float               timeBudget;
+        // Time in milliseconds for TEX_COMPRESS_PROGRESSIVE to spend on the whole texture (0 for no limit)
+
+        float               targetError;
+        // Per-block RMS error below which TEX_COMPRESS_PROGRESSIVE stops refining (0 refines every inexact block)
+
+        CompressionCache*   cache;
+        // Reuses tiles of 64x64 pixels compressed by earlier calls with the same settings (nullptr to disable)
+        // Not used with TEX_COMPRESS_PROGRESSIVE, as its results depend on the time budget
+    };
+
+    HRESULT __cdecl CompressEx(
+        _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ const CompressOptions& options,
+        _Out_ ScratchImage& cImage, _Out_opt_ float* timing = nullptr) noexcept;
+    HRESULT __cdecl CompressEx(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DXGI_FORMAT format, _In_ const CompressOptions& options, _Out_ ScratchImage& cImages,
+        _Out_writes_opt_(nimages) float* timings = nullptr) noexcept;
+        // TEX_COMPRESS_PARALLEL schedules tiles from all subresources on a shared work-stealing pool
+        // Optionally returns the time in milliseconds spent compressing each subresource (summed across workers)
+
+    HRESULT __cdecl GenerateMipMapsAndCompress(
+        _In_ const Image& baseImage, _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels,
+        _In_ DXGI_FORMAT format, _In_ const CompressOptions& options, _Out_ ScratchImage& cImages) noexcept;
+    HRESULT __cdecl GenerateMipMapsAndCompress(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ TEX_FILTER_FLAGS filter, _In_ size_t levels,
+        _In_ DXGI_FORMAT format, _In_ const CompressOptions& options, _Out_ ScratchImage& cImages) noexcept;
+        // levels of '0' indicates a full mipchain, otherwise is generates that number of total levels (including the source base image)
+        // Each level is compressed while the next one is filtered, so only two uncompressed levels are ever resident
+        // 1D and 2D textures only; always uses the non-WIC filters
+
 #if defined(__d3d11_h__) || defined(__d3d11_x_h__)
     HRESULT __cdecl Compress(
         _In_ ID3D11Device* pDevice, _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_COMPRESS_FLAGS compress,
@@ -736,6 +973,47 @@ namespace DirectX
     HRESULT __cdecl Decompress(
         _In_reads_(nimages) const Image* cImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
         _In_ DXGI_FORMAT format, _Out_ ScratchImage& images) noexcept;
+        // Decoding BC1-BC5 UNORM to matching 8-bit UNORM formats uses integer decoders that skip the float conversion
+
+    enum TEX_DECOMPRESS_FLAGS : unsigned long
+    {
+        TEX_DECOMPRESS_DEFAULT = 0,
+
+        TEX_DECOMPRESS_PARALLEL = 0x10000000,
+        // Decompress is free to use multithreading to improve performance (by default it does not use multithreading)
+    };
+
+    HRESULT __cdecl DecompressEx(
+        _In_ const Image& cImage, _In_ DXGI_FORMAT format, _In_ TEX_DECOMPRESS_FLAGS flags,
+        _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl DecompressEx(
+        _In_reads_(nimages) const Image* cImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DXGI_FORMAT format, _In_ TEX_DECOMPRESS_FLAGS flags, _Out_ ScratchImage& images) noexcept;
+        // TEX_DECOMPRESS_PARALLEL schedules tiles from all subresources (e.g. a whole mip chain) on a shared work-stealing pool
+
+    enum TEX_TRANSCODE_FLAGS : unsigned long
+    {
+        TEX_TRANSCODE_DEFAULT = 0,
+
+        TEX_TRANSCODE_BC5_GREEN = 0x1,
+        // BC5 -> BC4 keeps the second (green) channel rather than the first (red)
+
+        TEX_TRANSCODE_PARALLEL = 0x10000000,
+        // Use multithreading to transcode bands of blocks
+    };
+
+    bool __cdecl IsTranscodeSupported(_In_ DXGI_FORMAT srcFormat, _In_ DXGI_FORMAT destFormat) noexcept;
+
+    HRESULT __cdecl Transcode(
+        _In_ const Image& srcImage, _In_ DXGI_FORMAT format, _In_ TEX_TRANSCODE_FLAGS flags,
+        _Out_ ScratchImage& image) noexcept;
+    HRESULT __cdecl Transcode(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ DXGI_FORMAT format, _In_ TEX_TRANSCODE_FLAGS flags, _Out_ ScratchImage& result) noexcept;
+        // Converts between block compressed formats by reusing the endpoints and indices of the source blocks:
+        //   BC2/BC3 -> BC1 drops alpha, BC3 -> BC4 keeps only alpha, BC5 -> BC4 keeps one channel
+        //   BC1 -> BC7 writes mode 6 blocks seeded from the BC1 endpoints and refined against the BC1 colors (within 2),
+        //   re-encoding only punch-through alpha blocks
 
     //---------------------------------------------------------------------------------
     // Normal map operations
@@ -762,6 +1040,9 @@ namespace DirectX
 
         CNMAP_COMPUTE_OCCLUSION = 0x8000,
         // Computes a crude occlusion term stored in the alpha channel
+
+        CNMAP_PARALLEL = 0x10000000,
+        // Use multithreading to process bands of rows (the result is identical to the single-threaded one)
     };
 
     HRESULT __cdecl ComputeNormalMap(
@@ -806,9 +1087,27 @@ namespace DirectX
         CMSE_IMAGE1_X2_BIAS = 0x100,
         CMSE_IMAGE2_X2_BIAS = 0x200,
         // Indicates that image should be scaled and biased before comparison (i.e. UNORM -> SNORM)
+
+        CMSE_PARALLEL = 0x10000000,
+        // Use multithreading to compute the error (the result is identical to the single-threaded one)
+    };
+
+    struct ImageQualityMetrics
+    {
+        float   mse;
+        float   mseV[4];
+        // Same values as returned by ComputeMSE
+
+        float   psnr;
+        // Peak signal-to-noise ratio in dB for a peak of 1.0, using the mean MSE of the compared channels (infinite if identical)
+
+        float   ssim;
+        // Structural similarity over 8x8 windows, averaged over the compared channels
     };
 
     HRESULT __cdecl ComputeMSE(_In_ const Image& image1, _In_ const Image& image2, _Out_ float& mse, _Out_writes_opt_(4) float* mseV, _In_ CMSE_FLAGS flags = CMSE_DEFAULT) noexcept;
+    HRESULT __cdecl ComputeMSE(_In_ const Image& image1, _In_ const Image& image2, _Out_ ImageQualityMetrics& metrics, _In_ CMSE_FLAGS flags = CMSE_DEFAULT) noexcept;
+        // Computes PSNR and SSIM in the same pass as the MSE
 
     HRESULT __cdecl EvaluateImage(
         _In_ const Image& image,
@@ -827,6 +1126,46 @@ namespace DirectX
         _In_ std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels,
             _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)> pixelFunc,
         ScratchImage& result);
+        // The std::function callbacks are always invoked one row at a time, in order, on the calling thread
+
+    enum TEX_PIXELFUNC_FLAGS : unsigned long
+    {
+        TEX_PIXELFUNC_DEFAULT = 0,
+
+        TEX_PIXELFUNC_PARALLEL = 0x10000000,
+        // Rows are processed on multiple threads, so the callback may be invoked concurrently and must not throw
+    };
+
+    using EvaluateRowFunc = void(__cdecl*)(_In_ void* context, _In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y);
+    using TransformRowFunc = void(__cdecl*)(_In_ void* context,
+        _Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y);
+
+    HRESULT __cdecl EvaluateImageRows(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ TEX_PIXELFUNC_FLAGS flags, _In_ EvaluateRowFunc rowFunc, _In_opt_ void* context);
+    HRESULT __cdecl TransformImageRows(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ TEX_PIXELFUNC_FLAGS flags, _In_ TransformRowFunc rowFunc, _In_opt_ void* context,
+        _Out_ ScratchImage& result);
+        // Row drivers without std::function overhead, processed in bands of rows
+
+    template<typename TPixelFunc>
+    HRESULT __cdecl EvaluateImage(_In_ const Image& image, _In_ TPixelFunc&& pixelFunc, _In_ TEX_PIXELFUNC_FLAGS flags);
+    template<typename TPixelFunc>
+    HRESULT __cdecl EvaluateImage(
+        _In_reads_(nimages) const Image* images, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ TPixelFunc&& pixelFunc, _In_ TEX_PIXELFUNC_FLAGS flags);
+        // pixelFunc is called as void(XMVECTOR pixel, size_t x, size_t y) and is inlined into the row loop
+
+    template<typename TPixelFunc>
+    HRESULT __cdecl TransformImage(
+        _In_ const Image& image, _In_ TPixelFunc&& pixelFunc, _In_ TEX_PIXELFUNC_FLAGS flags,
+        _Out_ ScratchImage& result);
+    template<typename TPixelFunc>
+    HRESULT __cdecl TransformImage(
+        _In_reads_(nimages) const Image* srcImages, _In_ size_t nimages, _In_ const TexMetadata& metadata,
+        _In_ TPixelFunc&& pixelFunc, _In_ TEX_PIXELFUNC_FLAGS flags, _Out_ ScratchImage& result);
+        // pixelFunc is called as XMVECTOR(XMVECTOR pixel, size_t x, size_t y) and is inlined into the row loop
 
     //---------------------------------------------------------------------------------
     // WIC utility code
@@ -17,13 +17,17 @@
 DEFINE_ENUM_FLAG_OPERATORS(CP_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(DDS_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TGA_FLAGS);
+DEFINE_ENUM_FLAG_OPERATORS(HDR_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(WIC_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TEX_FR_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TEX_FILTER_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TEX_PMALPHA_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(TEX_COMPRESS_FLAGS);
+DEFINE_ENUM_FLAG_OPERATORS(TEX_DECOMPRESS_FLAGS);
+DEFINE_ENUM_FLAG_OPERATORS(TEX_TRANSCODE_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(CNMAP_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(CMSE_FLAGS);
+DEFINE_ENUM_FLAG_OPERATORS(TEX_PIXELFUNC_FLAGS);
 DEFINE_ENUM_FLAG_OPERATORS(CREATETEX_FLAGS);
 
 // WIC_FILTER modes match TEX_FILTER modes
@@ -173,6 +177,79 @@ inline HRESULT __cdecl SaveToDDSFile(const Image& image, DDS_FLAGS flags, const
 }
 
 
+//=====================================================================================
+// Per-pixel image processing
+//=====================================================================================
+template<typename TPixelFunc>
+inline HRESULT __cdecl EvaluateImage(
+    const Image* images, size_t nimages, const TexMetadata& metadata,
+    TPixelFunc&& pixelFunc, TEX_PIXELFUNC_FLAGS flags)
+{
+    using func_t = std::remove_reference_t<TPixelFunc>;
+
+    auto rowFunc = [](void* context, const XMVECTOR* pixels, size_t width, size_t y)
+    {
+        auto& func = *static_cast<func_t*>(context);
+        for (size_t x = 0; x < width; ++x)
+        {
+            func(pixels[x], x, y);
+        }
+    };
+
+    return EvaluateImageRows(images, nimages, metadata, flags, rowFunc,
+        const_cast<void*>(static_cast<const void*>(&pixelFunc)));
+}
+
+template<typename TPixelFunc>
+inline HRESULT __cdecl EvaluateImage(const Image& image, TPixelFunc&& pixelFunc, TEX_PIXELFUNC_FLAGS flags)
+{
+    TexMetadata mdata = {};
+    mdata.width = image.width;
+    mdata.height = image.height;
+    mdata.depth = 1;
+    mdata.arraySize = 1;
+    mdata.mipLevels = 1;
+    mdata.format = image.format;
+    mdata.dimension = TEX_DIMENSION_TEXTURE2D;
+
+    return EvaluateImage(&image, 1, mdata, std::forward<TPixelFunc>(pixelFunc), flags);
+}
+
+template<typename TPixelFunc>
+inline HRESULT __cdecl TransformImage(
+    const Image* srcImages, size_t nimages, const TexMetadata& metadata,
+    TPixelFunc&& pixelFunc, TEX_PIXELFUNC_FLAGS flags, ScratchImage& result)
+{
+    using func_t = std::remove_reference_t<TPixelFunc>;
+
+    auto rowFunc = [](void* context, XMVECTOR* outPixels, const XMVECTOR* inPixels, size_t width, size_t y)
+    {
+        auto& func = *static_cast<func_t*>(context);
+        for (size_t x = 0; x < width; ++x)
+        {
+            outPixels[x] = func(inPixels[x], x, y);
+        }
+    };
+
+    return TransformImageRows(srcImages, nimages, metadata, flags, rowFunc,
+        const_cast<void*>(static_cast<const void*>(&pixelFunc)), result);
+}
+
+template<typename TPixelFunc>
+inline HRESULT __cdecl TransformImage(const Image& image, TPixelFunc&& pixelFunc, TEX_PIXELFUNC_FLAGS flags, ScratchImage& result)
+{
+    TexMetadata mdata = {};
+    mdata.width = image.width;
+    mdata.height = image.height;
+    mdata.depth = 1;
+    mdata.arraySize = 1;
+    mdata.mipLevels = 1;
+    mdata.format = image.format;
+    mdata.dimension = TEX_DIMENSION_TEXTURE2D;
+
+    return TransformImage(&image, 1, mdata, std::forward<TPixelFunc>(pixelFunc), flags, result);
+}
+
 //=====================================================================================
 // Compatability helpers
 //=====================================================================================
@@ -211,3 +288,15 @@ inline HRESULT __cdecl SaveToTGAFile(const Image& image, const wchar_t* szFile,
 {
     return SaveToTGAFile(image, TGA_FLAGS_NONE, szFile, metadata);
 }
+
+_Use_decl_annotations_
+inline HRESULT __cdecl LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata* metadata, ScratchImage& image) noexcept
+{
+    return LoadFromHDRMemory(pSource, size, HDR_FLAGS_NONE, metadata, image);
+}
+
+_Use_decl_annotations_
+inline HRESULT __cdecl LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, ScratchImage& image) noexcept
+{
+    return LoadFromHDRFile(szFile, HDR_FLAGS_NONE, metadata, image);
+}
@@ -11,13 +11,12 @@
 
 #include "DirectXTexP.h"
 
-#ifdef _OPENMP
-#include <omp.h>
-#pragma warning(disable : 4616 6993)
-#endif
-
 #include "BC.h"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 using namespace DirectX;
 using namespace DirectX::Internal;
 
@@ -31,7 +30,8 @@ namespace
         static_assert(static_cast<int>(TEX_COMPRESS_UNIFORM) == static_cast<int>(BC_FLAGS_UNIFORM), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_USE_3SUBSETS) == static_cast<int>(BC_FLAGS_USE_3SUBSETS), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
         static_assert(static_cast<int>(TEX_COMPRESS_BC7_QUICK) == static_cast<int>(BC_FLAGS_FORCE_BC7_MODE6), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
-        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6));
+        static_assert(static_cast<int>(TEX_COMPRESS_BC6H_QUICK) == static_cast<int>(BC_FLAGS_FORCE_BC6H_1REGION), "TEX_COMPRESS_* flags should match BC_FLAGS_*");
+        return (compress & (BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A | BC_FLAGS_UNIFORM | BC_FLAGS_USE_3SUBSETS | BC_FLAGS_FORCE_BC7_MODE6 | BC_FLAGS_FORCE_BC6H_1REGION));
     }
 
     constexpr TEX_FILTER_FLAGS GetSRGBFlags(_In_ TEX_COMPRESS_FLAGS compress) noexcept
@@ -69,21 +69,129 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    HRESULT CompressBC(
+    // Loads the 4x4 block at (x,y), replicating pixels for partial blocks
+    bool LoadBlock(
         const Image& image,
-        const Image& result,
+        size_t x,
+        size_t y,
+        size_t sbpp,
+        _Out_writes_(NUM_PIXELS_PER_BLOCK) XMVECTOR* temp) noexcept
+    {
+        const size_t rowPitch = image.rowPitch;
+        const uint8_t *pSrc = image.pixels + (y * rowPitch) + (x * sbpp);
+        const uint8_t *pEnd = image.pixels + image.slicePitch;
+
+        const size_t ph = std::min<size_t>(4, image.height - y);
+        const size_t pw = std::min<size_t>(4, image.width - x);
+        assert(pw > 0 && ph > 0);
+
+        const ptrdiff_t bytesLeft = pEnd - pSrc;
+        assert(bytesLeft > 0);
+        size_t bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft));
+        if (!LoadScanline(&temp[0], pw, pSrc, bytesToRead, image.format))
+            return false;
+
+        if (ph > 1)
+        {
+            bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch);
+            if (!LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, image.format))
+                return false;
+
+            if (ph > 2)
+            {
+                bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 2);
+                if (!LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, image.format))
+                    return false;
+
+                if (ph > 3)
+                {
+                    bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 3);
+                    if (!LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, image.format))
+                        return false;
+                }
+            }
+        }
+
+        if (pw != 4 || ph != 4)
+        {
+            // Replicate pixels for partial block
+            static const size_t uSrc[] = { 0, 0, 0, 1 };
+
+            if (pw < 4)
+            {
+                for (size_t t = 0; t < ph && t < 4; ++t)
+                {
+                    for (size_t s = pw; s < 4; ++s)
+                    {
+                    #pragma prefast(suppress: 26000, "PREFAST false positive")
+                        temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
+                    }
+                }
+            }
+
+            if (ph < 4)
+            {
+                for (size_t t = ph; t < 4; ++t)
+                {
+                    for (size_t s = 0; s < 4; ++s)
+                    {
+                    #pragma prefast(suppress: 26000, "PREFAST false positive")
+                        temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Encodes nBlocks consecutive blocks, using the batched encoders where available
+    void EncodeBlocks(
+        DXGI_FORMAT format,
+        BC_ENCODE pfEncode,
+        size_t blocksize,
+        _Out_writes_bytes_(nBlocks * blocksize) uint8_t* pDest,
+        _In_reads_(nBlocks * NUM_PIXELS_PER_BLOCK) const XMVECTOR* pColor,
+        size_t nBlocks,
         uint32_t bcflags,
-        TEX_FILTER_FLAGS srgb,
         float threshold) noexcept
     {
-        if (!image.pixels || !result.pixels)
-            return E_POINTER;
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            D3DXEncodeBC1Batch(pDest, pColor, nBlocks, threshold, bcflags);
+            break;
+
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            D3DXEncodeBC3Batch(pDest, pColor, nBlocks, bcflags);
+            break;
+
+        default:
+            assert(pfEncode != nullptr);
+            for (size_t j = 0; j < nBlocks; ++j)
+            {
+                pfEncode(pDest + j * blocksize, pColor + j * NUM_PIXELS_PER_BLOCK, bcflags);
+            }
+            break;
+        }
+    }
 
-        assert(image.width == result.width);
-        assert(image.height == result.height);
 
-        const DXGI_FORMAT format = image.format;
-        size_t sbpp = BitsPerPixel(format);
+    //-------------------------------------------------------------------------------------
+    // Determines the source bytes-per-pixel and encoder settings for a compression
+    HRESULT GetCompressSettings(
+        DXGI_FORMAT srcFormat,
+        DXGI_FORMAT format,
+        _Out_ size_t& sbpp,
+        _Out_ BC_ENCODE& pfEncode,
+        _Out_ size_t& blocksize,
+        _Out_ TEX_FILTER_FLAGS& cflags) noexcept
+    {
+        sbpp = BitsPerPixel(srcFormat);
         if (!sbpp)
             return E_FAIL;
 
@@ -96,109 +204,66 @@ namespace
         // Round to bytes
         sbpp = (sbpp + 7) / 8;
 
-        uint8_t *pDest = result.pixels;
-
         // Determine BC format encoder
-        BC_ENCODE pfEncode;
-        size_t blocksize;
-        TEX_FILTER_FLAGS cflags;
-        if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
+        if (!DetermineEncoderSettings(format, pfEncode, blocksize, cflags))
             return HRESULT_E_NOT_SUPPORTED;
 
-        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = image.pixels;
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
-        const size_t rowPitch = image.rowPitch;
-        for (size_t h = 0; h < image.height; h += 4)
-        {
-            const uint8_t *sptr = pSrc;
-            uint8_t* dptr = pDest;
-            const size_t ph = std::min<size_t>(4, image.height - h);
-            size_t w = 0;
-            for (size_t count = 0; (count < result.rowPitch) && (w < image.width); count += blocksize, w += 4)
-            {
-                const size_t pw = std::min<size_t>(4, image.width - w);
-                assert(pw > 0 && ph > 0);
+        return S_OK;
+    }
 
-                const ptrdiff_t bytesLeft = pEnd - sptr;
-                assert(bytesLeft > 0);
-                size_t bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft));
-                if (!LoadScanline(&temp[0], pw, sptr, bytesToRead, format))
-                    return E_FAIL;
 
-                if (ph > 1)
-                {
-                    bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch);
-                    if (!LoadScanline(&temp[4], pw, sptr + rowPitch, bytesToRead, format))
-                        return E_FAIL;
+    //-------------------------------------------------------------------------------------
+    // Compresses nBlocks consecutive blocks of the block row starting at block (bx,by)
+    bool CompressBlocks(
+        const Image& image,
+        const Image& result,
+        size_t sbpp,
+        BC_ENCODE pfEncode,
+        size_t blocksize,
+        TEX_FILTER_FLAGS cflags,
+        size_t bx,
+        size_t by,
+        size_t nBlocks,
+        uint32_t bcflags,
+        float threshold) noexcept
+    {
+        uint8_t* dptr = result.pixels + (by * result.rowPitch) + (bx * blocksize);
 
-                    if (ph > 2)
-                    {
-                        bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 2);
-                        if (!LoadScanline(&temp[8], pw, sptr + rowPitch * 2, bytesToRead, format))
-                            return E_FAIL;
-
-                        if (ph > 3)
-                        {
-                            bytesToRead = std::min<size_t>(rowPitch, static_cast<size_t>(bytesLeft) - rowPitch * 3);
-                            if (!LoadScanline(&temp[12], pw, sptr + rowPitch * 3, bytesToRead, format))
-                                return E_FAIL;
-                        }
-                    }
-                }
+        XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK * BC_BLOCKS_PER_BATCH];
+        size_t nBatch = 0;
+        for (size_t j = 0; j < nBlocks; ++j)
+        {
+            const size_t x = (bx + j) * 4;
+            const size_t y = by * 4;
 
-                if (pw != 4 || ph != 4)
-                {
-                    // Replicate pixels for partial block
-                    static const size_t uSrc[] = { 0, 0, 0, 1 };
+            assert(x < image.width);
+            assert(y < image.height);
 
-                    if (pw < 4)
-                    {
-                        for (size_t t = 0; t < ph && t < 4; ++t)
-                        {
-                            for (size_t s = pw; s < 4; ++s)
-                            {
-                            #pragma prefast(suppress: 26000, "PREFAST false positive")
-                                temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                            }
-                        }
-                    }
+            XMVECTOR* block = &temp[nBatch * NUM_PIXELS_PER_BLOCK];
+            if (!LoadBlock(image, x, y, sbpp, block))
+                return false;
 
-                    if (ph < 4)
-                    {
-                        for (size_t t = ph; t < 4; ++t)
-                        {
-                            for (size_t s = 0; s < 4; ++s)
-                            {
-                            #pragma prefast(suppress: 26000, "PREFAST false positive")
-                                temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                            }
-                        }
-                    }
-                }
-
-                ConvertScanline(temp, 16, result.format, format, cflags | srgb);
-
-                if (pfEncode)
-                    pfEncode(dptr, temp, bcflags);
-                else
-                    D3DXEncodeBC1(dptr, temp, threshold, bcflags);
+            ConvertScanline(block, NUM_PIXELS_PER_BLOCK, result.format, image.format, cflags);
 
-                sptr += sbpp * 4;
-                dptr += blocksize;
+            if (++nBatch == BC_BLOCKS_PER_BATCH)
+            {
+                EncodeBlocks(result.format, pfEncode, blocksize, dptr, temp, nBatch, bcflags, threshold);
+                dptr += blocksize * nBatch;
+                nBatch = 0;
             }
+        }
 
-            pSrc += rowPitch * 4;
-            pDest += result.rowPitch;
+        if (nBatch > 0)
+        {
+            EncodeBlocks(result.format, pfEncode, blocksize, dptr, temp, nBatch, bcflags, threshold);
         }
 
-        return S_OK;
+        return true;
     }
 
 
     //-------------------------------------------------------------------------------------
-#ifdef _OPENMP
-    HRESULT CompressBC_Parallel(
+    HRESULT CompressBC(
         const Image& image,
         const Image& result,
         uint32_t bcflags,
@@ -211,125 +276,650 @@ namespace
         assert(image.width == result.width);
         assert(image.height == result.height);
 
-        const DXGI_FORMAT format = image.format;
-        size_t sbpp = BitsPerPixel(format);
-        if (!sbpp)
-            return E_FAIL;
+        size_t sbpp;
+        BC_ENCODE pfEncode;
+        size_t blocksize;
+        TEX_FILTER_FLAGS cflags;
+        HRESULT hr = GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags);
+        if (FAILED(hr))
+            return hr;
 
-        if (sbpp < 8)
+        const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
+        const size_t nbHeight = std::max<size_t>(1, (image.height + 3) / 4);
+
+        for (size_t by = 0; by < nbHeight; ++by)
         {
-            // We don't support compressing from monochrome (DXGI_FORMAT_R1_UNORM)
-            return HRESULT_E_NOT_SUPPORTED;
+            if (!CompressBlocks(image, result, sbpp, pfEncode, blocksize, cflags | srgb, 0, by, nbWidth, bcflags, threshold))
+                return E_FAIL;
         }
 
-        // Round to bytes
-        sbpp = (sbpp + 7) / 8;
+        return S_OK;
+    }
 
-        const uint8_t *pEnd = image.pixels + image.slicePitch;
 
-        // Determine BC format encoder
-        BC_ENCODE pfEncode;
-        size_t blocksize;
-        TEX_FILTER_FLAGS cflags;
-        if (!DetermineEncoderSettings(result.format, pfEncode, blocksize, cflags))
-            return HRESULT_E_NOT_SUPPORTED;
+    //-------------------------------------------------------------------------------------
+    // Elapsed time is accumulated per-worker and per-subresource so that workers never
+    // contend on the totals, then reduced to milliseconds per subresource at the end
+    class WorkerTimings
+    {
+    public:
+        WorkerTimings() noexcept : m_workerCount(0), m_nimages(0) {}
 
-        // Refactored version of loop to support parallel independance
-        const size_t nBlocks = std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+        HRESULT Initialize(size_t workerCount, size_t nimages) noexcept
+        {
+            m_elapsed.reset(new (std::nothrow) double[workerCount * nimages]);
+            if (!m_elapsed)
+                return E_OUTOFMEMORY;
+
+            memset(m_elapsed.get(), 0, sizeof(double) * workerCount * nimages);
+            m_workerCount = workerCount;
+            m_nimages = nimages;
+            return S_OK;
+        }
 
-        bool fail = false;
+        void Add(size_t worker, size_t index, std::chrono::steady_clock::time_point start) noexcept
+        {
+            if (m_elapsed)
+            {
+                assert(worker < m_workerCount && index < m_nimages);
+                const std::chrono::duration<double, std::milli> delta = std::chrono::steady_clock::now() - start;
+                m_elapsed[worker * m_nimages + index] += delta.count();
+            }
+        }
 
-    #pragma omp parallel for
-        for (int nb = 0; nb < static_cast<int>(nBlocks); ++nb)
+        void Reduce(_Out_writes_(m_nimages) float* timings) const noexcept
         {
-            const int nbWidth = std::max<int>(1, int((image.width + 3) / 4));
+            for (size_t index = 0; index < m_nimages; ++index)
+            {
+                double total = 0.0;
+                for (size_t worker = 0; worker < m_workerCount; ++worker)
+                {
+                    total += m_elapsed[worker * m_nimages + index];
+                }
+                timings[index] = static_cast<float>(total);
+            }
+        }
 
-            int y = nb / nbWidth;
-            const int x = (nb - (y*nbWidth)) * 4;
-            y *= 4;
+    private:
+        std::unique_ptr<double[]>   m_elapsed;
+        size_t                      m_workerCount;
+        size_t                      m_nimages;
+    };
 
-            assert((x >= 0) && (x < int(image.width)));
-            assert((y >= 0) && (y < int(image.height)));
 
-            const size_t rowPitch = image.rowPitch;
-            const uint8_t *pSrc = image.pixels + (size_t(y)*rowPitch) + (size_t(x)*sbpp);
+    //-------------------------------------------------------------------------------------
+    // A tile is a run of up to BLOCKS_PER_TILE blocks within one block row of a subresource
+    constexpr size_t BLOCKS_PER_TILE = 64;
 
-            uint8_t *pDest = result.pixels + (size_t(nb)*blocksize);
+    struct CompressTile
+    {
+        size_t  index;
+        size_t  bx;
+        size_t  by;
+        size_t  count;
+    };
 
-            const size_t ph = std::min<size_t>(4, image.height - size_t(y));
-            const size_t pw = std::min<size_t>(4, image.width - size_t(x));
-            assert(pw > 0 && ph > 0);
+    HRESULT CompressBC_Parallel(
+        _In_reads_(nimages) const Image* srcImages,
+        _In_reads_(nimages) const Image* destImages,
+        size_t nimages,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold,
+        size_t threadCount,
+        _Out_writes_opt_(nimages) float* timings) noexcept
+    {
+        if (!srcImages || !destImages || !nimages)
+            return E_INVALIDARG;
 
-            const ptrdiff_t bytesLeft = pEnd - pSrc;
-            assert(bytesLeft > 0);
-            size_t bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft));
+        // Validate all subresources up front and count the tiles
+        size_t nTiles = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const Image& image = srcImages[index];
+            const Image& result = destImages[index];
 
-            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-            if (!LoadScanline(&temp[0], pw, pSrc, bytesToRead, format))
-                fail = true;
+            if (!image.pixels || !result.pixels)
+                return E_POINTER;
 
-            if (ph > 1)
-            {
-                bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch);
-                if (!LoadScanline(&temp[4], pw, pSrc + rowPitch, bytesToRead, format))
-                    fail = true;
+            assert(image.width == result.width);
+            assert(image.height == result.height);
+
+            size_t sbpp;
+            BC_ENCODE pfEncode;
+            size_t blocksize;
+            TEX_FILTER_FLAGS cflags;
+            HRESULT hr = GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags);
+            if (FAILED(hr))
+                return hr;
 
-                if (ph > 2)
+            const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
+            const size_t nbHeight = std::max<size_t>(1, (image.height + 3) / 4);
+            nTiles += ((nbWidth + BLOCKS_PER_TILE - 1) / BLOCKS_PER_TILE) * nbHeight;
+        }
+
+        // Build one shared list of tiles across all subresources
+        std::unique_ptr<CompressTile[]> tiles(new (std::nothrow) CompressTile[nTiles]);
+        if (!tiles)
+            return E_OUTOFMEMORY;
+
+        size_t tile = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const size_t nbWidth = std::max<size_t>(1, (srcImages[index].width + 3) / 4);
+            const size_t nbHeight = std::max<size_t>(1, (srcImages[index].height + 3) / 4);
+
+            for (size_t by = 0; by < nbHeight; ++by)
+            {
+                for (size_t bx = 0; bx < nbWidth; bx += BLOCKS_PER_TILE)
                 {
-                    bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 2);
-                    if (!LoadScanline(&temp[8], pw, pSrc + rowPitch * 2, bytesToRead, format))
-                        fail = true;
+                    assert(tile < nTiles);
+                    tiles[tile++] = { index, bx, by, std::min<size_t>(BLOCKS_PER_TILE, nbWidth - bx) };
+                }
+            }
+        }
+        assert(tile == nTiles);
 
-                    if (ph > 3)
-                    {
-                        bytesToRead = std::min<size_t>(rowPitch, size_t(bytesLeft) - rowPitch * 3);
-                        if (!LoadScanline(&temp[12], pw, pSrc + rowPitch * 3, bytesToRead, format))
-                            fail = true;
-                    }
+        const size_t workerCount = GetWorkerCount(threadCount, nTiles);
+
+        WorkerTimings elapsed;
+        if (timings)
+        {
+            HRESULT hr = elapsed.Initialize(workerCount, nimages);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        HRESULT hr = ParallelFor(nTiles, workerCount,
+            [&](size_t task, size_t worker) noexcept -> bool
+            {
+                const CompressTile& t = tiles[task];
+                const Image& image = srcImages[t.index];
+                const Image& result = destImages[t.index];
+
+                const auto start = std::chrono::steady_clock::now();
+
+                size_t sbpp;
+                BC_ENCODE pfEncode;
+                size_t blocksize;
+                TEX_FILTER_FLAGS cflags;
+                if (FAILED(GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags)))
+                    return false;
+
+                if (!CompressBlocks(image, result, sbpp, pfEncode, blocksize, cflags | srgb, t.bx, t.by, t.count, bcflags, threshold))
+                    return false;
+
+                elapsed.Add(worker, t.index, start);
+                return true;
+            });
+        if (FAILED(hr))
+            return hr;
+
+        if (timings)
+        {
+            elapsed.Reduce(timings);
+        }
+
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Compression through a CompressionCache. Tiles are CACHE_TILE_BLOCKS square and keyed
+    // by a hash of their source pixels and every setting which affects the encoded blocks.
+    //-------------------------------------------------------------------------------------
+    constexpr size_t CACHE_TILE_BLOCKS = 16;
+    constexpr uint32_t CACHE_KEY_VERSION = 1;
+        // Must be changed whenever the encoders change their output
+
+    constexpr uint64_t CACHE_KEY_SEED0 = 0;
+    constexpr uint64_t CACHE_KEY_SEED1 = 0x5BD1E9955BD1E995ull;
+
+    struct CacheKeySettings
+    {
+        uint32_t    version;
+        uint32_t    srcFormat;
+        uint32_t    format;
+        uint32_t    bcflags;
+        uint32_t    srgb;
+        float       threshold;
+        uint32_t    width;
+        uint32_t    height;
+    };
+
+    static_assert(sizeof(CacheKeySettings) == 32, "Cache key settings must not contain padding");
+
+    void ComputeTileKey(
+        const Image& image,
+        DXGI_FORMAT format,
+        size_t sbpp,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold,
+        size_t x,
+        size_t y,
+        size_t w,
+        size_t h,
+        _Out_writes_(2) uint64_t key[2]) noexcept
+    {
+        CacheKeySettings settings;
+        settings.version = CACHE_KEY_VERSION;
+        settings.srcFormat = static_cast<uint32_t>(image.format);
+        settings.format = static_cast<uint32_t>(format);
+        settings.bcflags = bcflags;
+        settings.srgb = static_cast<uint32_t>(srgb);
+        settings.width = static_cast<uint32_t>(w);
+        settings.height = static_cast<uint32_t>(h);
+
+        // Only BC1 uses the threshold, so other formats share entries across thresholds
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            settings.threshold = threshold;
+            break;
+
+        default:
+            settings.threshold = 0.f;
+            break;
+        }
+
+        // Two independently seeded hashes make a 128-bit key
+        const size_t rowBytes = std::min(w * sbpp, image.rowPitch - x * sbpp);
+        const uint8_t* pSrc = image.pixels + y * image.rowPitch + x * sbpp;
+
+        key[0] = HashBytes(&settings, sizeof(settings), CACHE_KEY_SEED0);
+        key[1] = HashBytes(&settings, sizeof(settings), CACHE_KEY_SEED1);
+        for (size_t row = 0; row < h; ++row, pSrc += image.rowPitch)
+        {
+            key[0] = HashBytes(pSrc, rowBytes, key[0]);
+            key[1] = HashBytes(pSrc, rowBytes, key[1]);
+        }
+    }
+
+    struct CacheTile
+    {
+        size_t  index;
+        size_t  bx;
+        size_t  by;
+    };
+
+    HRESULT CompressBC_Cached(
+        _In_reads_(nimages) const Image* srcImages,
+        _In_reads_(nimages) const Image* destImages,
+        size_t nimages,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        float threshold,
+        size_t threadCount,
+        CompressionCache& cache,
+        _Out_writes_opt_(nimages) float* timings) noexcept
+    {
+        if (!srcImages || !destImages || !nimages)
+            return E_INVALIDARG;
+
+        // Validate all subresources up front and count the tiles
+        size_t nTiles = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const Image& image = srcImages[index];
+            const Image& result = destImages[index];
+
+            if (!image.pixels || !result.pixels)
+                return E_POINTER;
+
+            assert(image.width == result.width);
+            assert(image.height == result.height);
+
+            size_t sbpp;
+            BC_ENCODE pfEncode;
+            size_t blocksize;
+            TEX_FILTER_FLAGS cflags;
+            HRESULT hr = GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags);
+            if (FAILED(hr))
+                return hr;
+
+            const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
+            const size_t nbHeight = std::max<size_t>(1, (image.height + 3) / 4);
+            nTiles += ((nbWidth + CACHE_TILE_BLOCKS - 1) / CACHE_TILE_BLOCKS) * ((nbHeight + CACHE_TILE_BLOCKS - 1) / CACHE_TILE_BLOCKS);
+        }
+
+        std::unique_ptr<CacheTile[]> tiles(new (std::nothrow) CacheTile[nTiles]);
+        if (!tiles)
+            return E_OUTOFMEMORY;
+
+        size_t tile = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const size_t nbWidth = std::max<size_t>(1, (srcImages[index].width + 3) / 4);
+            const size_t nbHeight = std::max<size_t>(1, (srcImages[index].height + 3) / 4);
+
+            for (size_t by = 0; by < nbHeight; by += CACHE_TILE_BLOCKS)
+            {
+                for (size_t bx = 0; bx < nbWidth; bx += CACHE_TILE_BLOCKS)
+                {
+                    assert(tile < nTiles);
+                    tiles[tile++] = { index, bx, by };
                 }
             }
+        }
+        assert(tile == nTiles);
 
-            if (pw != 4 || ph != 4)
+        const size_t workerCount = GetWorkerCount(threadCount, nTiles);
+
+        WorkerTimings elapsed;
+        if (timings)
+        {
+            HRESULT hr = elapsed.Initialize(workerCount, nimages);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        HRESULT hr = ParallelFor(nTiles, workerCount,
+            [&](size_t task, size_t worker) noexcept -> bool
             {
-                // Replicate pixels for partial block
-                static const size_t uSrc[] = { 0, 0, 0, 1 };
+                const CacheTile& t = tiles[task];
+                const Image& image = srcImages[t.index];
+                const Image& result = destImages[t.index];
+
+                const auto start = std::chrono::steady_clock::now();
 
-                if (pw < 4)
+                size_t sbpp;
+                BC_ENCODE pfEncode;
+                size_t blocksize;
+                TEX_FILTER_FLAGS cflags;
+                if (FAILED(GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags)))
+                    return false;
+
+                const size_t nbWidth = std::max<size_t>(1, (image.width + 3) / 4);
+                const size_t nbHeight = std::max<size_t>(1, (image.height + 3) / 4);
+                const size_t tbw = std::min(CACHE_TILE_BLOCKS, nbWidth - t.bx);
+                const size_t tbh = std::min(CACHE_TILE_BLOCKS, nbHeight - t.by);
+
+                const size_t x = t.bx * 4;
+                const size_t y = t.by * 4;
+                const size_t w = std::min(tbw * 4, image.width - x);
+                const size_t h = std::min(tbh * 4, image.height - y);
+
+                uint64_t key[2];
+                ComputeTileKey(image, result.format, sbpp, bcflags, srgb, threshold, x, y, w, h, key);
+
+                const size_t tileRowBytes = tbw * blocksize;
+                uint8_t blocks[CACHE_TILE_BLOCKS * CACHE_TILE_BLOCKS * 16];
+                assert(tileRowBytes * tbh <= sizeof(blocks));
+
+                if (cache.Lookup(key, blocks, tileRowBytes * tbh))
                 {
-                    for (size_t t = 0; t < ph && t < 4; ++t)
+                    for (size_t row = 0; row < tbh; ++row)
                     {
-                        for (size_t s = pw; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(t << 2) | uSrc[s]];
-                        }
+                        memcpy(result.pixels + (t.by + row) * result.rowPitch + t.bx * blocksize,
+                            blocks + row * tileRowBytes, tileRowBytes);
                     }
                 }
-
-                if (ph < 4)
+                else
                 {
-                    for (size_t t = ph; t < 4; ++t)
+                    for (size_t row = 0; row < tbh; ++row)
                     {
-                        for (size_t s = 0; s < 4; ++s)
-                        {
-                            temp[(t << 2) | s] = temp[(uSrc[t] << 2) | s];
-                        }
+                        if (!CompressBlocks(image, result, sbpp, pfEncode, blocksize, cflags | srgb, t.bx, t.by + row, tbw, bcflags, threshold))
+                            return false;
+
+                        memcpy(blocks + row * tileRowBytes,
+                            result.pixels + (t.by + row) * result.rowPitch + t.bx * blocksize, tileRowBytes);
                     }
+
+                    // Failing to store the tile doesn't affect the result
+                    std::ignore = cache.Store(key, blocks, tileRowBytes * tbh);
                 }
-            }
 
-            ConvertScanline(temp, 16, result.format, format, cflags | srgb);
+                elapsed.Add(worker, t.index, start);
+                return true;
+            });
+        if (FAILED(hr))
+            return hr;
 
-            if (pfEncode)
-                pfEncode(pDest, temp, bcflags);
-            else
-                D3DXEncodeBC1(pDest, temp, threshold, bcflags);
+        if (timings)
+        {
+            elapsed.Reduce(timings);
         }
 
-        return (fail) ? E_FAIL : S_OK;
+        return S_OK;
     }
-#endif // _OPENMP
 
 
+    //-------------------------------------------------------------------------------------
+    // Progressive BC6H / BC7 compression
+    //-------------------------------------------------------------------------------------
+    inline bool IsProgressiveFormat(_In_ DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    struct ProgressiveBlock
+    {
+        size_t  index;
+        size_t  bx;
+        size_t  by;
+        float   error;
+    };
+
+    // Returns the root-mean-square error of an encoded block against its source pixels
+    float BlockError(
+        DXGI_FORMAT format,
+        _In_reads_(16) const uint8_t* pBC,
+        _In_reads_(NUM_PIXELS_PER_BLOCK) const XMVECTOR* pColor) noexcept
+    {
+        XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK];
+
+        bool alpha = true;
+        switch (format)
+        {
+        case DXGI_FORMAT_BC6H_UF16: D3DXDecodeBC6HU(temp, pBC); alpha = false; break;
+        case DXGI_FORMAT_BC6H_SF16: D3DXDecodeBC6HS(temp, pBC); alpha = false; break;
+        default:                    D3DXDecodeBC7(temp, pBC); break;
+        }
+
+        XMVECTOR acc = g_XMZero;
+        for (size_t j = 0; j < NUM_PIXELS_PER_BLOCK; ++j)
+        {
+            const XMVECTOR diff = XMVectorSubtract(pColor[j], temp[j]);
+            acc = XMVectorMultiplyAdd(diff, diff, acc);
+        }
+
+        // BC6H has no alpha channel, so only RGB contributes to the error
+        const float sum = alpha ? XMVectorGetX(XMVector4Dot(acc, g_XMOne)) : XMVectorGetX(XMVector3Dot(acc, g_XMOne));
+        return sqrtf(sum / float(NUM_PIXELS_PER_BLOCK * (alpha ? 4 : 3)));
+    }
+
+    HRESULT CompressBC_Progressive(
+        _In_reads_(nimages) const Image* srcImages,
+        _In_reads_(nimages) const Image* destImages,
+        size_t nimages,
+        uint32_t bcflags,
+        TEX_FILTER_FLAGS srgb,
+        size_t threadCount,
+        float timeBudget,
+        float targetError,
+        _Out_writes_opt_(nimages) float* timings) noexcept
+    {
+        if (!srcImages || !destImages || !nimages)
+            return E_INVALIDARG;
+
+        const auto start = std::chrono::steady_clock::now();
+
+        // Validate all subresources up front and count the blocks
+        size_t nBlocks = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const Image& image = srcImages[index];
+            const Image& result = destImages[index];
+
+            if (!image.pixels || !result.pixels)
+                return E_POINTER;
+
+            assert(image.width == result.width);
+            assert(image.height == result.height);
+
+            if (!IsProgressiveFormat(result.format))
+                return HRESULT_E_NOT_SUPPORTED;
+
+            size_t sbpp;
+            BC_ENCODE pfEncode;
+            size_t blocksize;
+            TEX_FILTER_FLAGS cflags;
+            HRESULT hr = GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags);
+            if (FAILED(hr))
+                return hr;
+
+            nBlocks += std::max<size_t>(1, (image.width + 3) / 4) * std::max<size_t>(1, (image.height + 3) / 4);
+        }
+
+        std::unique_ptr<ProgressiveBlock[]> blocks(new (std::nothrow) ProgressiveBlock[nBlocks]);
+        if (!blocks)
+            return E_OUTOFMEMORY;
+
+        size_t block = 0;
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const size_t nbWidth = std::max<size_t>(1, (srcImages[index].width + 3) / 4);
+            const size_t nbHeight = std::max<size_t>(1, (srcImages[index].height + 3) / 4);
+
+            for (size_t by = 0; by < nbHeight; ++by)
+            {
+                for (size_t bx = 0; bx < nbWidth; ++bx)
+                {
+                    assert(block < nBlocks);
+                    blocks[block++] = { index, bx, by, 0.f };
+                }
+            }
+        }
+        assert(block == nBlocks);
+
+        const size_t nTiles = (nBlocks + BLOCKS_PER_TILE - 1) / BLOCKS_PER_TILE;
+        const size_t workerCount = GetWorkerCount(threadCount, nTiles);
+
+        WorkerTimings elapsed;
+        if (timings)
+        {
+            HRESULT hr = elapsed.Initialize(workerCount, nimages);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        // Loads the source pixels for a block and returns where its encoding lives
+        auto loadBlock = [&](const ProgressiveBlock& b, XMVECTOR* temp, BC_ENCODE& pfEncode) noexcept -> uint8_t*
+        {
+            const Image& image = srcImages[b.index];
+            const Image& result = destImages[b.index];
+
+            size_t sbpp;
+            size_t blocksize;
+            TEX_FILTER_FLAGS cflags;
+            if (FAILED(GetCompressSettings(image.format, result.format, sbpp, pfEncode, blocksize, cflags)))
+                return nullptr;
+
+            if (!LoadBlock(image, b.bx * 4, b.by * 4, sbpp, temp))
+                return nullptr;
+
+            ConvertScanline(temp, NUM_PIXELS_PER_BLOCK, result.format, image.format, cflags | srgb);
+
+            return result.pixels + (b.by * result.rowPitch) + (b.bx * blocksize);
+        };
+
+        // First pass encodes every block with only the cheapest modes so we always have a complete result
+        const uint32_t quickFlags = (bcflags & ~static_cast<uint32_t>(BC_FLAGS_USE_3SUBSETS))
+            | BC_FLAGS_FORCE_BC7_MODE6 | BC_FLAGS_FORCE_BC6H_1REGION;
+
+        HRESULT hr = ParallelFor(nTiles, workerCount,
+            [&](size_t task, size_t worker) noexcept -> bool
+            {
+                const size_t last = std::min(nBlocks, (task + 1) * BLOCKS_PER_TILE);
+                for (size_t j = task * BLOCKS_PER_TILE; j < last; ++j)
+                {
+                    ProgressiveBlock& b = blocks[j];
+
+                    const auto bstart = std::chrono::steady_clock::now();
+
+                    XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK];
+                    BC_ENCODE pfEncode;
+                    uint8_t* pBC = loadBlock(b, temp, pfEncode);
+                    if (!pBC)
+                        return false;
+
+                    pfEncode(pBC, temp, quickFlags);
+                    b.error = BlockError(destImages[b.index].format, pBC, temp);
+
+                    elapsed.Add(worker, b.index, bstart);
+                }
+
+                return true;
+            });
+        if (FAILED(hr))
+            return hr;
+
+        // Second pass refines the worst blocks first with the full mode and partition search
+        std::sort(blocks.get(), blocks.get() + nBlocks,
+            [](const ProgressiveBlock& a, const ProgressiveBlock& b) noexcept { return a.error > b.error; });
+
+        const bool hasBudget = (timeBudget > 0.f);
+        const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<float, std::milli>(timeBudget));
+
+        std::atomic<size_t> next(0);
+        hr = ParallelFor(workerCount, workerCount,
+            [&](size_t, size_t worker) noexcept -> bool
+            {
+                for (;;)
+                {
+                    // Blocks are claimed in sorted order, so every worker is always on the worst remaining block
+                    const size_t j = next.fetch_add(1);
+                    if (j >= nBlocks)
+                        return true;
+
+                    const ProgressiveBlock& b = blocks[j];
+                    if (b.error <= targetError)
+                        return true;
+
+                    const auto bstart = std::chrono::steady_clock::now();
+                    if (hasBudget && bstart >= deadline)
+                        return true;
+
+                    XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK];
+                    BC_ENCODE pfEncode;
+                    uint8_t* pBC = loadBlock(b, temp, pfEncode);
+                    if (!pBC)
+                        return false;
+
+                    uint8_t candidate[16];
+                    pfEncode(candidate, temp, bcflags);
+                    if (BlockError(destImages[b.index].format, candidate, temp) < b.error)
+                    {
+                        memcpy(pBC, candidate, sizeof(candidate));
+                    }
+
+                    elapsed.Add(worker, b.index, bstart);
+                }
+            });
+        if (FAILED(hr))
+            return hr;
+
+        if (timings)
+        {
+            elapsed.Reduce(timings);
+        }
+
+        return S_OK;
+    }
+
     //-------------------------------------------------------------------------------------
     DXGI_FORMAT DefaultDecompress(_In_ DXGI_FORMAT format) noexcept
     {
@@ -351,34 +941,268 @@ namespace
         case DXGI_FORMAT_BC7_UNORM_SRGB:
             return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
 
-        case DXGI_FORMAT_BC4_TYPELESS:
-        case DXGI_FORMAT_BC4_UNORM:
-            return DXGI_FORMAT_R8_UNORM;
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+            return DXGI_FORMAT_R8_UNORM;
+
+        case DXGI_FORMAT_BC4_SNORM:
+            return DXGI_FORMAT_R8_SNORM;
+
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+            return DXGI_FORMAT_R8G8_UNORM;
+
+        case DXGI_FORMAT_BC5_SNORM:
+            return DXGI_FORMAT_R8G8_SNORM;
+
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:
+        case DXGI_FORMAT_BC6H_SF16:
+            // We could use DXGI_FORMAT_R32G32B32_FLOAT here since BC6H is always Alpha 1.0,
+            // but this format is more supported by viewers
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+        default:
+            return DXGI_FORMAT_UNKNOWN;
+        }
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Decompression
+    //-------------------------------------------------------------------------------------
+    enum RGBA8_LAYOUT : uint32_t
+    {
+        RGBA8_LAYOUT_RGBA = 0,
+        RGBA8_LAYOUT_BGRA,
+        RGBA8_LAYOUT_R,
+        RGBA8_LAYOUT_RG,
+    };
+
+    struct DecompressSettings
+    {
+        DXGI_FORMAT     cformat;
+        BC_DECODE       pfDecode;
+        BC_DECODE_RGBA8 pfDecodeRGBA8;  // Set when the output can be written directly from integer texels
+        RGBA8_LAYOUT    layout;
+        size_t          sbpp;
+        size_t          dbpp;
+    };
+
+    HRESULT GetDecompressSettings(DXGI_FORMAT srcFormat, DXGI_FORMAT format, DecompressSettings& settings) noexcept
+    {
+        size_t dbpp = BitsPerPixel(format);
+        if (!dbpp)
+            return E_FAIL;
+
+        if (dbpp < 8)
+        {
+            // We don't support decompressing to monochrome (DXGI_FORMAT_R1_UNORM)
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        // Round to bytes
+        settings.dbpp = (dbpp + 7) / 8;
+
+        // Promote "typeless" BC formats
+        DXGI_FORMAT cformat;
+        switch (srcFormat)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:  cformat = DXGI_FORMAT_BC1_UNORM; break;
+        case DXGI_FORMAT_BC2_TYPELESS:  cformat = DXGI_FORMAT_BC2_UNORM; break;
+        case DXGI_FORMAT_BC3_TYPELESS:  cformat = DXGI_FORMAT_BC3_UNORM; break;
+        case DXGI_FORMAT_BC4_TYPELESS:  cformat = DXGI_FORMAT_BC4_UNORM; break;
+        case DXGI_FORMAT_BC5_TYPELESS:  cformat = DXGI_FORMAT_BC5_UNORM; break;
+        case DXGI_FORMAT_BC6H_TYPELESS: cformat = DXGI_FORMAT_BC6H_UF16; break;
+        case DXGI_FORMAT_BC7_TYPELESS:  cformat = DXGI_FORMAT_BC7_UNORM; break;
+        default:                        cformat = srcFormat;             break;
+        }
+        settings.cformat = cformat;
+
+        // Determine BC format decoder
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    settings.pfDecode = D3DXDecodeBC1;   settings.sbpp = 8;   break;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    settings.pfDecode = D3DXDecodeBC2;   settings.sbpp = 16;  break;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    settings.pfDecode = D3DXDecodeBC3;   settings.sbpp = 16;  break;
+        case DXGI_FORMAT_BC4_UNORM:         settings.pfDecode = D3DXDecodeBC4U;  settings.sbpp = 8;   break;
+        case DXGI_FORMAT_BC4_SNORM:         settings.pfDecode = D3DXDecodeBC4S;  settings.sbpp = 8;   break;
+        case DXGI_FORMAT_BC5_UNORM:         settings.pfDecode = D3DXDecodeBC5U;  settings.sbpp = 16;  break;
+        case DXGI_FORMAT_BC5_SNORM:         settings.pfDecode = D3DXDecodeBC5S;  settings.sbpp = 16;  break;
+        case DXGI_FORMAT_BC6H_UF16:         settings.pfDecode = D3DXDecodeBC6HU; settings.sbpp = 16;  break;
+        case DXGI_FORMAT_BC6H_SF16:         settings.pfDecode = D3DXDecodeBC6HS; settings.sbpp = 16;  break;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    settings.pfDecode = D3DXDecodeBC7;   settings.sbpp = 16;  break;
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        // Integer decoders apply when no conversion beyond a channel shuffle is needed
+        settings.pfDecodeRGBA8 = nullptr;
+        settings.layout = RGBA8_LAYOUT_RGBA;
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC3_UNORM:
+            if (format == DXGI_FORMAT_R8G8B8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM)
+            {
+                settings.layout = (format == DXGI_FORMAT_B8G8R8A8_UNORM) ? RGBA8_LAYOUT_BGRA : RGBA8_LAYOUT_RGBA;
+            }
+            else
+                return S_OK;
+            break;
+
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            if (format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+            {
+                settings.layout = (format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) ? RGBA8_LAYOUT_BGRA : RGBA8_LAYOUT_RGBA;
+            }
+            else
+                return S_OK;
+            break;
+
+        case DXGI_FORMAT_BC4_UNORM:
+            if (format == DXGI_FORMAT_R8_UNORM)
+            {
+                settings.layout = RGBA8_LAYOUT_R;
+            }
+            else if (format != DXGI_FORMAT_R8G8B8A8_UNORM)
+                return S_OK;
+            break;
+
+        case DXGI_FORMAT_BC5_UNORM:
+            if (format == DXGI_FORMAT_R8G8_UNORM)
+            {
+                settings.layout = RGBA8_LAYOUT_RG;
+            }
+            else if (format != DXGI_FORMAT_R8G8B8A8_UNORM)
+                return S_OK;
+            break;
+
+        default:
+            return S_OK;
+        }
+
+        switch (cformat)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    settings.pfDecodeRGBA8 = D3DXDecodeBC1RGBA8;    break;
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    settings.pfDecodeRGBA8 = D3DXDecodeBC2RGBA8;    break;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    settings.pfDecodeRGBA8 = D3DXDecodeBC3RGBA8;    break;
+        case DXGI_FORMAT_BC4_UNORM:         settings.pfDecodeRGBA8 = D3DXDecodeBC4URGBA8;   break;
+        case DXGI_FORMAT_BC5_UNORM:         settings.pfDecodeRGBA8 = D3DXDecodeBC5URGBA8;   break;
+        default:                            break;
+        }
+
+        return S_OK;
+    }
+
+    void StoreRGBA8(
+        _Out_ uint8_t* pDest,
+        _In_reads_(count) const uint32_t* pSource,
+        size_t count,
+        RGBA8_LAYOUT layout) noexcept
+    {
+        switch (layout)
+        {
+        case RGBA8_LAYOUT_BGRA:
+            for (size_t i = 0; i < count; ++i)
+            {
+                const uint32_t t = pSource[i];
+                const uint32_t v = ((t & 0x00ff0000) >> 16) | ((t & 0x000000ff) << 16) | (t & 0xff00ff00);
+                memcpy(pDest + i * 4, &v, sizeof(uint32_t));
+            }
+            break;
+
+        case RGBA8_LAYOUT_R:
+            for (size_t i = 0; i < count; ++i)
+            {
+                pDest[i] = static_cast<uint8_t>(pSource[i]);
+            }
+            break;
+
+        case RGBA8_LAYOUT_RG:
+            for (size_t i = 0; i < count; ++i)
+            {
+                pDest[i * 2] = static_cast<uint8_t>(pSource[i]);
+                pDest[i * 2 + 1] = static_cast<uint8_t>(pSource[i] >> 8);
+            }
+            break;
+
+        default:
+            memcpy(pDest, pSource, count * sizeof(uint32_t));
+            break;
+        }
+    }
+
+    // Decodes a run of blocks within one block row
+    bool DecompressBlocks(
+        const Image& cImage,
+        const Image& result,
+        const DecompressSettings& settings,
+        size_t bx,
+        size_t by,
+        size_t count) noexcept
+    {
+        const size_t rowPitch = result.rowPitch;
+        const size_t h = by * 4;
+        const size_t ph = std::min<size_t>(4, cImage.height - h);
+
+        const uint8_t *sptr = cImage.pixels + cImage.rowPitch * by + settings.sbpp * bx;
+        uint8_t *dptr = result.pixels + rowPitch * h + settings.dbpp * 4 * bx;
+
+        if (settings.pfDecodeRGBA8)
+        {
+            uint32_t temp[NUM_PIXELS_PER_BLOCK];
+            for (size_t i = 0; i < count; ++i)
+            {
+                settings.pfDecodeRGBA8(temp, sptr);
+
+                const size_t pw = std::min<size_t>(4, cImage.width - (bx + i) * 4);
+                assert(pw > 0 && ph > 0);
+
+                for (size_t row = 0; row < ph; ++row)
+                {
+                    StoreRGBA8(dptr + rowPitch * row, &temp[row * 4], pw, settings.layout);
+                }
+
+                sptr += settings.sbpp;
+                dptr += settings.dbpp * 4;
+            }
 
-        case DXGI_FORMAT_BC4_SNORM:
-            return DXGI_FORMAT_R8_SNORM;
+            return true;
+        }
 
-        case DXGI_FORMAT_BC5_TYPELESS:
-        case DXGI_FORMAT_BC5_UNORM:
-            return DXGI_FORMAT_R8G8_UNORM;
+        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
+        for (size_t i = 0; i < count; ++i)
+        {
+            settings.pfDecode(temp, sptr);
+            ConvertScanline(temp, 16, result.format, settings.cformat, TEX_FILTER_DEFAULT);
 
-        case DXGI_FORMAT_BC5_SNORM:
-            return DXGI_FORMAT_R8G8_SNORM;
+            const size_t pw = std::min<size_t>(4, cImage.width - (bx + i) * 4);
+            assert(pw > 0 && ph > 0);
 
-        case DXGI_FORMAT_BC6H_TYPELESS:
-        case DXGI_FORMAT_BC6H_UF16:
-        case DXGI_FORMAT_BC6H_SF16:
-            // We could use DXGI_FORMAT_R32G32B32_FLOAT here since BC6H is always Alpha 1.0,
-            // but this format is more supported by viewers
-            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+            for (size_t row = 0; row < ph; ++row)
+            {
+                if (!StoreScanline(dptr + rowPitch * row, rowPitch, result.format, &temp[row * 4], pw))
+                    return false;
+            }
 
-        default:
-            return DXGI_FORMAT_UNKNOWN;
+            sptr += settings.sbpp;
+            dptr += settings.dbpp * 4;
         }
-    }
 
+        return true;
+    }
 
-    //-------------------------------------------------------------------------------------
     HRESULT DecompressBC(_In_ const Image& cImage, _In_ const Image& result) noexcept
     {
         if (!cImage.pixels || !result.pixels)
@@ -387,105 +1211,144 @@ namespace
         assert(cImage.width == result.width);
         assert(cImage.height == result.height);
 
-        const DXGI_FORMAT format = result.format;
-        size_t dbpp = BitsPerPixel(format);
-        if (!dbpp)
+        DecompressSettings settings;
+        HRESULT hr = GetDecompressSettings(cImage.format, result.format, settings);
+        if (FAILED(hr))
+            return hr;
+
+        const size_t nbWidth = (cImage.width + 3) / 4;
+        const size_t nbHeight = (cImage.height + 3) / 4;
+        if (nbWidth * settings.sbpp > cImage.rowPitch)
             return E_FAIL;
 
-        if (dbpp < 8)
+        for (size_t by = 0; by < nbHeight; ++by)
         {
-            // We don't support decompressing to monochrome (DXGI_FORMAT_R1_UNORM)
-            return HRESULT_E_NOT_SUPPORTED;
+            if (!DecompressBlocks(cImage, result, settings, 0, by, nbWidth))
+                return E_FAIL;
         }
 
-        // Round to bytes
-        dbpp = (dbpp + 7) / 8;
+        return S_OK;
+    }
 
-        uint8_t *pDest = result.pixels;
-        if (!pDest)
-            return E_POINTER;
+    HRESULT DecompressBC_Parallel(
+        _In_reads_(nimages) const Image* cImages,
+        _In_reads_(nimages) const Image* destImages,
+        size_t nimages) noexcept
+    {
+        if (!cImages || !destImages || !nimages)
+            return E_INVALIDARG;
 
-        // Promote "typeless" BC formats
-        DXGI_FORMAT cformat;
-        switch (cImage.format)
+        // Validate all subresources up front and count the tiles
+        size_t nTiles = 0;
+        for (size_t index = 0; index < nimages; ++index)
         {
-        case DXGI_FORMAT_BC1_TYPELESS:  cformat = DXGI_FORMAT_BC1_UNORM; break;
-        case DXGI_FORMAT_BC2_TYPELESS:  cformat = DXGI_FORMAT_BC2_UNORM; break;
-        case DXGI_FORMAT_BC3_TYPELESS:  cformat = DXGI_FORMAT_BC3_UNORM; break;
-        case DXGI_FORMAT_BC4_TYPELESS:  cformat = DXGI_FORMAT_BC4_UNORM; break;
-        case DXGI_FORMAT_BC5_TYPELESS:  cformat = DXGI_FORMAT_BC5_UNORM; break;
-        case DXGI_FORMAT_BC6H_TYPELESS: cformat = DXGI_FORMAT_BC6H_UF16; break;
-        case DXGI_FORMAT_BC7_TYPELESS:  cformat = DXGI_FORMAT_BC7_UNORM; break;
-        default:                        cformat = cImage.format;         break;
+            const Image& cImage = cImages[index];
+            const Image& result = destImages[index];
+
+            if (!cImage.pixels || !result.pixels)
+                return E_POINTER;
+
+            assert(cImage.width == result.width);
+            assert(cImage.height == result.height);
+
+            DecompressSettings settings;
+            HRESULT hr = GetDecompressSettings(cImage.format, result.format, settings);
+            if (FAILED(hr))
+                return hr;
+
+            const size_t nbWidth = (cImage.width + 3) / 4;
+            if (nbWidth * settings.sbpp > cImage.rowPitch)
+                return E_FAIL;
+
+            nTiles += ((nbWidth + BLOCKS_PER_TILE - 1) / BLOCKS_PER_TILE) * ((cImage.height + 3) / 4);
         }
 
-        // Determine BC format decoder
-        BC_DECODE pfDecode;
-        size_t sbpp;
-        switch (cformat)
+        // Build one shared list of tiles across all subresources, so a whole mip chain scales across cores
+        std::unique_ptr<CompressTile[]> tiles(new (std::nothrow) CompressTile[nTiles]);
+        if (!tiles)
+            return E_OUTOFMEMORY;
+
+        size_t tile = 0;
+        for (size_t index = 0; index < nimages; ++index)
         {
-        case DXGI_FORMAT_BC1_UNORM:
-        case DXGI_FORMAT_BC1_UNORM_SRGB:    pfDecode = D3DXDecodeBC1;   sbpp = 8;   break;
-        case DXGI_FORMAT_BC2_UNORM:
-        case DXGI_FORMAT_BC2_UNORM_SRGB:    pfDecode = D3DXDecodeBC2;   sbpp = 16;  break;
-        case DXGI_FORMAT_BC3_UNORM:
-        case DXGI_FORMAT_BC3_UNORM_SRGB:    pfDecode = D3DXDecodeBC3;   sbpp = 16;  break;
-        case DXGI_FORMAT_BC4_UNORM:         pfDecode = D3DXDecodeBC4U;  sbpp = 8;   break;
-        case DXGI_FORMAT_BC4_SNORM:         pfDecode = D3DXDecodeBC4S;  sbpp = 8;   break;
-        case DXGI_FORMAT_BC5_UNORM:         pfDecode = D3DXDecodeBC5U;  sbpp = 16;  break;
-        case DXGI_FORMAT_BC5_SNORM:         pfDecode = D3DXDecodeBC5S;  sbpp = 16;  break;
-        case DXGI_FORMAT_BC6H_UF16:         pfDecode = D3DXDecodeBC6HU; sbpp = 16;  break;
-        case DXGI_FORMAT_BC6H_SF16:         pfDecode = D3DXDecodeBC6HS; sbpp = 16;  break;
-        case DXGI_FORMAT_BC7_UNORM:
-        case DXGI_FORMAT_BC7_UNORM_SRGB:    pfDecode = D3DXDecodeBC7;   sbpp = 16;  break;
-        default:
-            return HRESULT_E_NOT_SUPPORTED;
+            const size_t nbWidth = (cImages[index].width + 3) / 4;
+            const size_t nbHeight = (cImages[index].height + 3) / 4;
+
+            for (size_t by = 0; by < nbHeight; ++by)
+            {
+                for (size_t bx = 0; bx < nbWidth; bx += BLOCKS_PER_TILE)
+                {
+                    assert(tile < nTiles);
+                    tiles[tile++] = { index, bx, by, std::min<size_t>(BLOCKS_PER_TILE, nbWidth - bx) };
+                }
+            }
         }
+        assert(tile == nTiles);
 
-        XM_ALIGNED_DATA(16) XMVECTOR temp[16];
-        const uint8_t *pSrc = cImage.pixels;
-        const size_t rowPitch = result.rowPitch;
-        for (size_t h = 0; h < cImage.height; h += 4)
-        {
-            const uint8_t *sptr = pSrc;
-            uint8_t* dptr = pDest;
-            const size_t ph = std::min<size_t>(4, cImage.height - h);
-            size_t w = 0;
-            for (size_t count = 0; (count < cImage.rowPitch) && (w < cImage.width); count += sbpp, w += 4)
+        return ParallelFor(nTiles, 0,
+            [&](size_t task, size_t) noexcept -> bool
             {
-                pfDecode(temp, sptr);
-                ConvertScanline(temp, 16, format, cformat, TEX_FILTER_DEFAULT);
+                const CompressTile& t = tiles[task];
+                const Image& cImage = cImages[t.index];
+                const Image& result = destImages[t.index];
 
-                const size_t pw = std::min<size_t>(4, cImage.width - w);
-                assert(pw > 0 && ph > 0);
+                DecompressSettings settings;
+                if (FAILED(GetDecompressSettings(cImage.format, result.format, settings)))
+                    return false;
 
-                if (!StoreScanline(dptr, rowPitch, format, &temp[0], pw))
-                    return E_FAIL;
+                return DecompressBlocks(cImage, result, settings, t.bx, t.by, t.count);
+            });
+    }
 
-                if (ph > 1)
-                {
-                    if (!StoreScanline(dptr + rowPitch, rowPitch, format, &temp[4], pw))
-                        return E_FAIL;
+    //-------------------------------------------------------------------------------------
+    // Compress a set of images into already allocated images of the compressed format
+    //-------------------------------------------------------------------------------------
+    HRESULT CompressImages(
+        _In_reads_(nimages) const Image* srcImages,
+        _In_reads_(nimages) const Image* destImages,
+        size_t nimages,
+        const CompressOptions& options,
+        _Out_writes_opt_(nimages) float* timings) noexcept
+    {
+        if (!srcImages || !destImages || !nimages)
+            return E_INVALIDARG;
 
-                    if (ph > 2)
-                    {
-                        if (!StoreScanline(dptr + rowPitch * 2, rowPitch, format, &temp[8], pw))
-                            return E_FAIL;
-
-                        if (ph > 3)
-                        {
-                            if (!StoreScanline(dptr + rowPitch * 3, rowPitch, format, &temp[12], pw))
-                                return E_FAIL;
-                        }
-                    }
-                }
+        const TEX_COMPRESS_FLAGS compress = options.flags;
+        if ((compress & TEX_COMPRESS_PROGRESSIVE) && IsProgressiveFormat(destImages[0].format))
+        {
+            // The time budget and target error apply to the set of images as a whole
+            const size_t threadCount = (compress & TEX_COMPRESS_PARALLEL) ? options.threadCount : 1;
+            return CompressBC_Progressive(srcImages, destImages, nimages, GetBCFlags(compress), GetSRGBFlags(compress),
+                threadCount, options.timeBudget, options.targetError, timings);
+        }
 
-                sptr += sbpp;
-                dptr += dbpp * 4;
-            }
+        if (options.cache)
+        {
+            const size_t threadCount = (compress & TEX_COMPRESS_PARALLEL) ? options.threadCount : 1;
+            return CompressBC_Cached(srcImages, destImages, nimages, GetBCFlags(compress), GetSRGBFlags(compress),
+                options.threshold, threadCount, *options.cache, timings);
+        }
+
+        if (compress & TEX_COMPRESS_PARALLEL)
+        {
+            // All subresources share a single pool of tiles so small mips don't leave workers idle
+            return CompressBC_Parallel(srcImages, destImages, nimages, GetBCFlags(compress), GetSRGBFlags(compress),
+                options.threshold, options.threadCount, timings);
+        }
+
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            const auto start = std::chrono::steady_clock::now();
+
+            const HRESULT hr = CompressBC(srcImages[index], destImages[index], GetBCFlags(compress), GetSRGBFlags(compress), options.threshold);
+            if (FAILED(hr))
+                return hr;
 
-            pSrc += cImage.rowPitch;
-            pDest += rowPitch * 4;
+            if (timings)
+            {
+                const std::chrono::duration<float, std::milli> delta = std::chrono::steady_clock::now() - start;
+                timings[index] = delta.count();
+            }
         }
 
         return S_OK;
@@ -592,6 +1455,36 @@ HRESULT DirectX::Compress(
     TEX_COMPRESS_FLAGS compress,
     float threshold,
     ScratchImage& image) noexcept
+{
+    CompressOptions options = {};
+    options.flags = compress;
+    options.threshold = threshold;
+    return CompressEx(srcImage, format, options, image);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Compress(
+    const Image* srcImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DXGI_FORMAT format,
+    TEX_COMPRESS_FLAGS compress,
+    float threshold,
+    ScratchImage& cImages) noexcept
+{
+    CompressOptions options = {};
+    options.flags = compress;
+    options.threshold = threshold;
+    return CompressEx(srcImages, nimages, metadata, format, options, cImages);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::CompressEx(
+    const Image& srcImage,
+    DXGI_FORMAT format,
+    const CompressOptions& options,
+    ScratchImage& image,
+    float* timing) noexcept
 {
     if (IsCompressed(srcImage.format) || !IsCompressed(format))
         return E_INVALIDARG;
@@ -613,19 +1506,7 @@ HRESULT DirectX::Compress(
     }
 
     // Compress single image
-    if (compress & TEX_COMPRESS_PARALLEL)
-    {
-    #ifndef _OPENMP
-        return E_NOTIMPL;
-    #else
-        hr = CompressBC_Parallel(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-    #endif // _OPENMP
-    }
-    else
-    {
-        hr = CompressBC(srcImage, *img, GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-    }
-
+    hr = CompressImages(&srcImage, img, 1, options, timing);
     if (FAILED(hr))
         image.Release();
 
@@ -633,14 +1514,14 @@ HRESULT DirectX::Compress(
 }
 
 _Use_decl_annotations_
-HRESULT DirectX::Compress(
+HRESULT DirectX::CompressEx(
     const Image* srcImages,
     size_t nimages,
     const TexMetadata& metadata,
     DXGI_FORMAT format,
-    TEX_COMPRESS_FLAGS compress,
-    float threshold,
-    ScratchImage& cImages) noexcept
+    const CompressOptions& options,
+    ScratchImage& cImages,
+    float* timings) noexcept
 {
     if (!srcImages || !nimages)
         return E_INVALIDARG;
@@ -684,32 +1565,181 @@ HRESULT DirectX::Compress(
             cImages.Release();
             return E_FAIL;
         }
+    }
+
+    hr = CompressImages(srcImages, dest, nimages, options, timings);
+    if (FAILED(hr))
+    {
+        cImages.Release();
+        return hr;
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Fused mipmap generation and compression
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GenerateMipMapsAndCompress(
+    const Image& baseImage,
+    TEX_FILTER_FLAGS filter,
+    size_t levels,
+    DXGI_FORMAT format,
+    const CompressOptions& options,
+    ScratchImage& cImages) noexcept
+{
+    TexMetadata mdata = {};
+    mdata.width = baseImage.width;
+    mdata.height = baseImage.height;
+    mdata.depth = mdata.arraySize = mdata.mipLevels = 1;
+    mdata.format = baseImage.format;
+    mdata.dimension = TEX_DIMENSION_TEXTURE2D;
+
+    return GenerateMipMapsAndCompress(&baseImage, 1, mdata, filter, levels, format, options, cImages);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::GenerateMipMapsAndCompress(
+    const Image* srcImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    TEX_FILTER_FLAGS filter,
+    size_t levels,
+    DXGI_FORMAT format,
+    const CompressOptions& options,
+    ScratchImage& cImages) noexcept
+{
+    if (!srcImages || !nimages)
+        return E_INVALIDARG;
+
+    if (IsCompressed(metadata.format) || !IsCompressed(format))
+        return E_INVALIDARG;
+
+    if (metadata.IsVolumemap())
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (IsTypeless(format)
+        || IsTypeless(metadata.format) || IsPlanar(metadata.format) || IsPalettized(metadata.format))
+        return HRESULT_E_NOT_SUPPORTED;
+
+    // Mips are filtered on a worker thread which has no COM apartment, so WIC can't be used
+    if (filter & TEX_FILTER_FORCE_WIC)
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if (!CalculateMipLevels(metadata.width, metadata.height, levels))
+        return E_INVALIDARG;
+
+    const size_t items = metadata.arraySize;
+
+    std::unique_ptr<Image[]> baseImages(new (std::nothrow) Image[items]);
+    std::unique_ptr<Image[]> destImages(new (std::nothrow) Image[items]);
+    if (!baseImages || !destImages)
+        return E_OUTOFMEMORY;
+
+    for (size_t item = 0; item < items; ++item)
+    {
+        const size_t index = metadata.ComputeIndex(0, item, 0);
+        if (index >= nimages)
+            return E_FAIL;
+
+        if (srcImages[index].format != metadata.format
+            || srcImages[index].width != metadata.width
+            || srcImages[index].height != metadata.height)
+            return E_FAIL;
+
+        baseImages[item] = srcImages[index];
+    }
+
+    cImages.Release();
+
+    TexMetadata mdata2 = metadata;
+    mdata2.format = format;
+    mdata2.mipLevels = levels;
+    HRESULT hr = cImages.Initialize(mdata2);
+    if (FAILED(hr))
+        return hr;
+
+    // The progressive time budget is split across the levels by pixel count
+    uint64_t totalPixels = 0;
+    for (size_t level = 0; level < levels; ++level)
+    {
+        totalPixels += uint64_t(std::max<size_t>(1, metadata.width >> level)) * uint64_t(std::max<size_t>(1, metadata.height >> level));
+    }
 
-        if ((compress & TEX_COMPRESS_PARALLEL))
+    const TEX_FILTER_FLAGS mipFilter = filter | TEX_FILTER_FORCE_NON_WIC;
+
+    // Only the level being compressed and the one being filtered from it are kept uncompressed
+    ScratchImage current;
+    const Image* levelImages = baseImages.get();
+
+    TexMetadata lmeta = metadata;
+    lmeta.mipLevels = 1;
+
+    for (size_t level = 0; level < levels; ++level)
+    {
+        for (size_t item = 0; item < items; ++item)
         {
-        #ifndef _OPENMP
-            return E_NOTIMPL;
-        #else
-            if (compress & TEX_COMPRESS_PARALLEL)
+            const Image* dest = cImages.GetImage(level, item, 0);
+            if (!dest)
             {
-                hr = CompressBC_Parallel(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-                if (FAILED(hr))
-                {
-                    cImages.Release();
-                    return  hr;
-                }
+                cImages.Release();
+                return E_POINTER;
             }
-        #endif // _OPENMP
+
+            destImages[item] = *dest;
         }
-        else
+
+        // Filter the next level while this one is being compressed
+        ScratchImage next;
+        HRESULT hrNext = S_OK;
+        std::thread producer;
+        if (level + 1 < levels)
         {
-            hr = CompressBC(src, dest[index], GetBCFlags(compress), GetSRGBFlags(compress), threshold);
-            if (FAILED(hr))
+            const size_t width = std::max<size_t>(1, lmeta.width >> 1);
+            const size_t height = std::max<size_t>(1, lmeta.height >> 1);
+
+            auto filterLevel = [&, width, height]() noexcept
             {
-                cImages.Release();
-                return hr;
+                hrNext = Resize(levelImages, items, lmeta, width, height, mipFilter, next);
+            };
+
+            try
+            {
+                producer = std::thread(filterLevel);
+            }
+            catch (...)
+            {
+                filterLevel();
             }
         }
+
+        CompressOptions levelOptions = options;
+        if (options.timeBudget > 0.f && totalPixels > 0)
+        {
+            const uint64_t pixels = uint64_t(lmeta.width) * uint64_t(lmeta.height);
+            levelOptions.timeBudget = options.timeBudget * float(double(pixels) / double(totalPixels));
+        }
+
+        hr = CompressImages(levelImages, destImages.get(), items, levelOptions, nullptr);
+
+        if (producer.joinable())
+            producer.join();
+
+        if (FAILED(hr) || FAILED(hrNext))
+        {
+            cImages.Release();
+            return FAILED(hr) ? hr : hrNext;
+        }
+
+        if (level + 1 < levels)
+        {
+            // Releases the uncompressed copy of the level that was just compressed
+            current = std::move(next);
+            levelImages = current.GetImages();
+            lmeta = current.GetMetadata();
+        }
     }
 
     return S_OK;
@@ -724,6 +1754,27 @@ HRESULT DirectX::Decompress(
     const Image& cImage,
     DXGI_FORMAT format,
     ScratchImage& image) noexcept
+{
+    return DecompressEx(cImage, format, TEX_DECOMPRESS_DEFAULT, image);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::Decompress(
+    const Image* cImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DXGI_FORMAT format,
+    ScratchImage& images) noexcept
+{
+    return DecompressEx(cImages, nimages, metadata, format, TEX_DECOMPRESS_DEFAULT, images);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::DecompressEx(
+    const Image& cImage,
+    DXGI_FORMAT format,
+    TEX_DECOMPRESS_FLAGS flags,
+    ScratchImage& image) noexcept
 {
     if (!IsCompressed(cImage.format) || IsCompressed(format))
         return E_INVALIDARG;
@@ -760,7 +1811,15 @@ HRESULT DirectX::Decompress(
     }
 
     // Decompress single image
-    hr = DecompressBC(cImage, *img);
+    if (flags & TEX_DECOMPRESS_PARALLEL)
+    {
+        hr = DecompressBC_Parallel(&cImage, img, 1);
+    }
+    else
+    {
+        hr = DecompressBC(cImage, *img);
+    }
+
     if (FAILED(hr))
         image.Release();
 
@@ -768,11 +1827,12 @@ HRESULT DirectX::Decompress(
 }
 
 _Use_decl_annotations_
-HRESULT DirectX::Decompress(
+HRESULT DirectX::DecompressEx(
     const Image* cImages,
     size_t nimages,
     const TexMetadata& metadata,
     DXGI_FORMAT format,
+    TEX_DECOMPRESS_FLAGS flags,
     ScratchImage& images) noexcept
 {
     if (!cImages || !nimages)
@@ -837,14 +1897,30 @@ HRESULT DirectX::Decompress(
             images.Release();
             return E_FAIL;
         }
+    }
 
-        hr = DecompressBC(src, dest[index]);
+    if (flags & TEX_DECOMPRESS_PARALLEL)
+    {
+        // All subresources share a single pool of tiles so small mips don't leave workers idle
+        hr = DecompressBC_Parallel(cImages, dest, nimages);
         if (FAILED(hr))
         {
             images.Release();
             return hr;
         }
     }
+    else
+    {
+        for (size_t index = 0; index < nimages; ++index)
+        {
+            hr = DecompressBC(cImages[index], dest[index]);
+            if (FAILED(hr))
+            {
+                images.Release();
+                return hr;
+            }
+        }
+    }
 
     return S_OK;
 }
@@ -0,0 +1,764 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexCompressCache.cpp
+//
+// DirectX Texture Library - Persistent cache of compressed tiles
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include <chrono>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // 64-bit hash (xxHash64 mixing)
+    //-------------------------------------------------------------------------------------
+    constexpr uint64_t HASH_PRIME1 = 0x9E3779B185EBCA87ull;
+    constexpr uint64_t HASH_PRIME2 = 0xC2B2AE3D27D4EB4Full;
+    constexpr uint64_t HASH_PRIME3 = 0x165667B19E3779F9ull;
+    constexpr uint64_t HASH_PRIME4 = 0x85EBCA77C2B2AE63ull;
+    constexpr uint64_t HASH_PRIME5 = 0x27D4EB2F165667C5ull;
+
+    inline uint64_t RotateLeft(uint64_t value, unsigned int bits) noexcept
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    inline uint64_t Read64(const uint8_t* ptr) noexcept
+    {
+        uint64_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t Read32(const uint8_t* ptr) noexcept
+    {
+        uint32_t value;
+        memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t HashRound(uint64_t acc, uint64_t input) noexcept
+    {
+        acc += input * HASH_PRIME2;
+        acc = RotateLeft(acc, 31);
+        return acc * HASH_PRIME1;
+    }
+
+    inline uint64_t HashMerge(uint64_t acc, uint64_t value) noexcept
+    {
+        acc ^= HashRound(0, value);
+        return acc * HASH_PRIME1 + HASH_PRIME4;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // On-disk entries
+    //-------------------------------------------------------------------------------------
+    constexpr uint32_t CACHE_MAGIC = 0x31434342; // "BCC1"
+    constexpr uint32_t CACHE_VERSION = 1;
+    constexpr size_t CACHE_NAME_DIGITS = 32;
+
+    constexpr wchar_t CACHE_EXTENSION[] = L".bcc";
+    constexpr wchar_t CACHE_TEMP_EXTENSION[] = L".tmp";
+
+#pragma pack(push,1)
+    struct CacheHeader
+    {
+        uint32_t    magic;
+        uint32_t    version;
+        uint64_t    key[2];
+        uint64_t    size;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(CacheHeader) == 32, "Cache entry header size mismatch");
+
+    struct CacheKey
+    {
+        uint64_t    value[2];
+
+        bool operator==(const CacheKey& other) const noexcept
+        {
+            return value[0] == other.value[0] && value[1] == other.value[1];
+        }
+    };
+
+    struct CacheKeyHash
+    {
+        size_t operator()(const CacheKey& key) const noexcept
+        {
+            // The key is already a good hash
+            return static_cast<size_t>(key.value[0]);
+        }
+    };
+
+    struct CacheEntry
+    {
+        CacheKey    key;
+        uint64_t    bytes;      // Size of the file, including the header
+        int64_t     stamp;      // Last write time, used to order the entries found at startup
+    };
+
+    std::wstring GetEntryName(const CacheKey& key)
+    {
+        static const wchar_t s_digits[] = L"0123456789abcdef";
+
+        std::wstring name(CACHE_NAME_DIGITS, L'0');
+        for (size_t j = 0; j < CACHE_NAME_DIGITS; ++j)
+        {
+            const uint64_t value = key.value[j / 16];
+            name[j] = s_digits[(value >> (60 - 4 * (j % 16))) & 0xF];
+        }
+        return name;
+    }
+
+    template<typename CharT>
+    bool ParseEntryName(_In_reads_(length) const CharT* name, size_t length, CacheKey& key) noexcept
+    {
+        // Expects exactly CACHE_NAME_DIGITS hex digits followed by the cache extension
+        if (length != CACHE_NAME_DIGITS + 4)
+            return false;
+
+        for (size_t j = 0; j < 4; ++j)
+        {
+            if (name[CACHE_NAME_DIGITS + j] != static_cast<CharT>(CACHE_EXTENSION[j]))
+                return false;
+        }
+
+        key = {};
+        for (size_t j = 0; j < CACHE_NAME_DIGITS; ++j)
+        {
+            const CharT c = name[j];
+
+            uint64_t digit;
+            if (c >= '0' && c <= '9')
+                digit = static_cast<uint64_t>(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                digit = static_cast<uint64_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                digit = static_cast<uint64_t>(c - 'A' + 10);
+            else
+                return false;
+
+            key.value[j / 16] = (key.value[j / 16] << 4) | digit;
+        }
+
+        return true;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // File system helpers
+    //-------------------------------------------------------------------------------------
+#ifdef _WIN32
+    HRESULT CreateCacheDirectory(const std::wstring& directory) noexcept
+    {
+        if (!CreateDirectoryW(directory.c_str(), nullptr))
+        {
+            const DWORD error = GetLastError();
+            if (error != ERROR_ALREADY_EXISTS)
+                return HRESULT_FROM_WIN32(error);
+        }
+
+        return S_OK;
+    }
+
+    HRESULT FindEntries(const std::wstring& directory, std::vector<CacheEntry>& entries)
+    {
+        const std::wstring pattern = directory + L"*" + CACHE_EXTENSION;
+
+        WIN32_FIND_DATAW findData = {};
+        ScopedFindHandle hFind(safe_handle(FindFirstFileExW(pattern.c_str(),
+            FindExInfoBasic, &findData,
+            FindExSearchNameMatch, nullptr,
+            FIND_FIRST_EX_LARGE_FETCH)));
+        if (!hFind)
+        {
+            const DWORD error = GetLastError();
+            return (error == ERROR_FILE_NOT_FOUND) ? S_OK : HRESULT_FROM_WIN32(error);
+        }
+
+        do
+        {
+            CacheEntry entry = {};
+            if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                && ParseEntryName(findData.cFileName, wcslen(findData.cFileName), entry.key))
+            {
+                entry.bytes = (uint64_t(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+                entry.stamp = static_cast<int64_t>((uint64_t(findData.ftLastWriteTime.dwHighDateTime) << 32) | findData.ftLastWriteTime.dwLowDateTime);
+                entries.push_back(entry);
+            }
+        } while (FindNextFileW(hFind.get(), &findData));
+
+        return S_OK;
+    }
+
+    bool ReadEntry(const std::wstring& path, const CacheKey& key, _Out_writes_bytes_(size) void* data, size_t size) noexcept
+    {
+    #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+        ScopedHandle hFile(safe_handle(CreateFile2(path.c_str(),
+            GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_DELETE, OPEN_EXISTING, nullptr)));
+    #else
+        ScopedHandle hFile(safe_handle(CreateFileW(path.c_str(),
+            GENERIC_READ | FILE_WRITE_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr)));
+    #endif
+        if (!hFile)
+            return false;
+
+        CacheHeader header;
+        DWORD bytesRead = 0;
+        if (!ReadFile(hFile.get(), &header, sizeof(header), &bytesRead, nullptr) || bytesRead != sizeof(header))
+            return false;
+
+        if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION
+            || header.key[0] != key.value[0] || header.key[1] != key.value[1] || header.size != size)
+            return false;
+
+        if (!ReadFile(hFile.get(), data, static_cast<DWORD>(size), &bytesRead, nullptr) || bytesRead != size)
+            return false;
+
+        // Touch the entry so the least recently used order survives to the next session
+        FILETIME now;
+        GetSystemTimeAsFileTime(&now);
+        std::ignore = SetFileTime(hFile.get(), nullptr, nullptr, &now);
+
+        return true;
+    }
+
+    HRESULT WriteEntry(
+        const std::wstring& path,
+        const std::wstring& tempPath,
+        const CacheHeader& header,
+        _In_reads_bytes_(size) const void* data,
+        size_t size) noexcept
+    {
+        {
+        #if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+            ScopedHandle hFile(safe_handle(CreateFile2(tempPath.c_str(),
+                GENERIC_WRITE | DELETE, 0, CREATE_ALWAYS, nullptr)));
+        #else
+            ScopedHandle hFile(safe_handle(CreateFileW(tempPath.c_str(),
+                GENERIC_WRITE | DELETE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr)));
+        #endif
+            if (!hFile)
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            auto_delete_file delonfail(hFile.get());
+
+            DWORD bytesWritten;
+            if (!WriteFile(hFile.get(), &header, sizeof(header), &bytesWritten, nullptr))
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            if (bytesWritten != sizeof(header))
+                return E_FAIL;
+
+            if (!WriteFile(hFile.get(), data, static_cast<DWORD>(size), &bytesWritten, nullptr))
+                return HRESULT_FROM_WIN32(GetLastError());
+
+            if (bytesWritten != size)
+                return E_FAIL;
+
+            delonfail.clear();
+        }
+
+        // Readers only ever see complete entries
+        if (!MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            const DWORD error = GetLastError();
+            std::ignore = DeleteFileW(tempPath.c_str());
+            return HRESULT_FROM_WIN32(error);
+        }
+
+        return S_OK;
+    }
+
+    void DeleteEntry(const std::wstring& path) noexcept
+    {
+        std::ignore = DeleteFileW(path.c_str());
+    }
+
+#else // !WIN32
+    HRESULT CreateCacheDirectory(const std::wstring& directory) noexcept
+    {
+        std::error_code ec;
+        std::filesystem::create_directories(std::filesystem::path(directory), ec);
+        return (ec) ? E_FAIL : S_OK;
+    }
+
+    HRESULT FindEntries(const std::wstring& directory, std::vector<CacheEntry>& entries)
+    {
+        std::error_code ec;
+        for (auto it = std::filesystem::directory_iterator(std::filesystem::path(directory), ec);
+            !ec && it != std::filesystem::directory_iterator(); it.increment(ec))
+        {
+            if (!it->is_regular_file(ec))
+                continue;
+
+            const std::string name = it->path().filename().string();
+
+            CacheEntry entry = {};
+            if (ParseEntryName(name.c_str(), name.size(), entry.key))
+            {
+                entry.bytes = static_cast<uint64_t>(it->file_size(ec));
+                entry.stamp = static_cast<int64_t>(it->last_write_time(ec).time_since_epoch().count());
+                if (!ec)
+                    entries.push_back(entry);
+            }
+        }
+
+        return (ec) ? E_FAIL : S_OK;
+    }
+
+    bool ReadEntry(const std::wstring& path, const CacheKey& key, _Out_writes_bytes_(size) void* data, size_t size) noexcept
+    {
+        {
+            std::ifstream inFile(std::filesystem::path(path), std::ios::in | std::ios::binary);
+            if (!inFile)
+                return false;
+
+            CacheHeader header;
+            inFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!inFile)
+                return false;
+
+            if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION
+                || header.key[0] != key.value[0] || header.key[1] != key.value[1] || header.size != size)
+                return false;
+
+            inFile.read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+            if (!inFile)
+                return false;
+        }
+
+        // Touch the entry so the least recently used order survives to the next session
+        std::error_code ec;
+        std::filesystem::last_write_time(std::filesystem::path(path), std::filesystem::file_time_type::clock::now(), ec);
+
+        return true;
+    }
+
+    HRESULT WriteEntry(
+        const std::wstring& path,
+        const std::wstring& tempPath,
+        const CacheHeader& header,
+        _In_reads_bytes_(size) const void* data,
+        size_t size) noexcept
+    {
+        const std::filesystem::path temp(tempPath);
+
+        {
+            std::ofstream outFile(temp, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!outFile)
+                return E_FAIL;
+
+            outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            outFile.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            outFile.close();
+            if (!outFile)
+            {
+                std::error_code ec;
+                std::filesystem::remove(temp, ec);
+                return E_FAIL;
+            }
+        }
+
+        // Readers only ever see complete entries
+        std::error_code ec;
+        std::filesystem::rename(temp, std::filesystem::path(path), ec);
+        if (ec)
+        {
+            std::filesystem::remove(temp, ec);
+            return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    void DeleteEntry(const std::wstring& path) noexcept
+    {
+        std::error_code ec;
+        std::filesystem::remove(std::filesystem::path(path), ec);
+    }
+#endif // WIN32
+}
+
+
+//-------------------------------------------------------------------------------------
+// Hashing
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+uint64_t DirectX::Internal::HashBytes(const void* data, size_t size, uint64_t seed) noexcept
+{
+    auto ptr = static_cast<const uint8_t*>(data);
+    const uint8_t* end = ptr + size;
+
+    uint64_t hash;
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + HASH_PRIME1 + HASH_PRIME2;
+        uint64_t v2 = seed + HASH_PRIME2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - HASH_PRIME1;
+
+        const uint8_t* limit = end - 32;
+        do
+        {
+            v1 = HashRound(v1, Read64(ptr));
+            v2 = HashRound(v2, Read64(ptr + 8));
+            v3 = HashRound(v3, Read64(ptr + 16));
+            v4 = HashRound(v4, Read64(ptr + 24));
+            ptr += 32;
+        } while (ptr <= limit);
+
+        hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+        hash = HashMerge(hash, v1);
+        hash = HashMerge(hash, v2);
+        hash = HashMerge(hash, v3);
+        hash = HashMerge(hash, v4);
+    }
+    else
+    {
+        hash = seed + HASH_PRIME5;
+    }
+
+    hash += static_cast<uint64_t>(size);
+
+    for (; ptr + 8 <= end; ptr += 8)
+    {
+        hash ^= HashRound(0, Read64(ptr));
+        hash = RotateLeft(hash, 27) * HASH_PRIME1 + HASH_PRIME4;
+    }
+
+    if (ptr + 4 <= end)
+    {
+        hash ^= uint64_t(Read32(ptr)) * HASH_PRIME1;
+        hash = RotateLeft(hash, 23) * HASH_PRIME2 + HASH_PRIME3;
+        ptr += 4;
+    }
+
+    for (; ptr < end; ++ptr)
+    {
+        hash ^= uint64_t(*ptr) * HASH_PRIME5;
+        hash = RotateLeft(hash, 11) * HASH_PRIME1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= HASH_PRIME2;
+    hash ^= hash >> 29;
+    hash *= HASH_PRIME3;
+    hash ^= hash >> 32;
+
+    return hash;
+}
+
+
+//=====================================================================================
+// CompressionCache - Entries are kept one per file, named by their key, so several
+// processes can share a directory. The index orders them from most to least recently
+// used; on startup that order is recovered from the file write times.
+//=====================================================================================
+
+struct CompressionCache::Impl
+{
+    using EntryList = std::list<CacheEntry>;
+
+    mutable std::mutex  mutex;
+    std::wstring        directory;
+    uint64_t            maxBytes;
+    uint64_t            totalBytes;
+    uint64_t            hits;
+    uint64_t            misses;
+    uint64_t            tempCounter;
+    EntryList           entries;
+    std::unordered_map<CacheKey, EntryList::iterator, CacheKeyHash> index;
+
+    std::wstring GetPath(const CacheKey& key) const
+    {
+        return directory + GetEntryName(key) + CACHE_EXTENSION;
+    }
+
+    // Caller holds the mutex
+    void Evict(uint64_t limit) noexcept
+    {
+        while (totalBytes > limit && !entries.empty())
+        {
+            const CacheEntry& entry = entries.back();
+
+            try
+            {
+                DeleteEntry(GetPath(entry.key));
+            }
+            catch (...)
+            {
+                // The file is left for the next session to evict
+            }
+
+            totalBytes -= entry.bytes;
+            index.erase(entry.key);
+            entries.pop_back();
+        }
+    }
+};
+
+CompressionCache::CompressionCache() noexcept :
+    m_impl(nullptr)
+{
+}
+
+CompressionCache::~CompressionCache()
+{
+    Release();
+}
+
+_Use_decl_annotations_
+HRESULT CompressionCache::Initialize(const wchar_t* szDirectory, uint64_t maxBytes) noexcept
+{
+    if (!szDirectory || !*szDirectory)
+        return E_INVALIDARG;
+
+    Release();
+
+    std::unique_ptr<Impl> impl(new (std::nothrow) Impl);
+    if (!impl)
+        return E_OUTOFMEMORY;
+
+    impl->maxBytes = maxBytes;
+    impl->totalBytes = 0;
+    impl->hits = 0;
+    impl->misses = 0;
+    impl->tempCounter = 0;
+
+    try
+    {
+        impl->directory = szDirectory;
+        const wchar_t last = impl->directory.back();
+    #ifdef _WIN32
+        if (last != L'\\' && last != L'/')
+            impl->directory += L'\\';
+    #else
+        if (last != L'/')
+            impl->directory += L'/';
+    #endif
+
+        HRESULT hr = CreateCacheDirectory(impl->directory);
+        if (FAILED(hr))
+            return hr;
+
+        std::vector<CacheEntry> found;
+        hr = FindEntries(impl->directory, found);
+        if (FAILED(hr))
+            return hr;
+
+        std::sort(found.begin(), found.end(),
+            [](const CacheEntry& a, const CacheEntry& b) noexcept { return a.stamp > b.stamp; });
+
+        impl->index.reserve(found.size());
+        for (const auto& entry : found)
+        {
+            impl->entries.push_back(entry);
+            impl->index[entry.key] = std::prev(impl->entries.end());
+            impl->totalBytes += entry.bytes;
+        }
+    }
+    catch (...)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    if (maxBytes)
+    {
+        impl->Evict(maxBytes);
+    }
+
+    m_impl = impl.release();
+    return S_OK;
+}
+
+_Use_decl_annotations_
+bool CompressionCache::Lookup(const uint64_t key[2], void* data, size_t size) noexcept
+{
+    if (!m_impl || !key || !data || !size)
+        return false;
+
+    const CacheKey k = { { key[0], key[1] } };
+
+    try
+    {
+        // The index only reflects this session's view of the directory, so the file is always
+        // probed to pick up entries written by other processes. Entries are immutable once
+        // written, so it is read without holding the lock.
+        const std::wstring path = m_impl->GetPath(k);
+        const bool found = ReadEntry(path, k, data, size);
+
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+        auto it = m_impl->index.find(k);
+        if (found)
+        {
+            if (it != m_impl->index.end())
+            {
+                m_impl->entries.splice(m_impl->entries.begin(), m_impl->entries, it->second);
+            }
+            else
+            {
+                m_impl->entries.push_front({ k, sizeof(CacheHeader) + size, 0 });
+                m_impl->index[k] = m_impl->entries.begin();
+                m_impl->totalBytes += sizeof(CacheHeader) + size;
+
+                if (m_impl->maxBytes)
+                {
+                    m_impl->Evict(m_impl->maxBytes);
+                }
+            }
+            ++m_impl->hits;
+        }
+        else
+        {
+            // Missing, truncated, or belongs to a different key/size
+            if (it != m_impl->index.end())
+            {
+                DeleteEntry(path);
+                m_impl->totalBytes -= it->second->bytes;
+                m_impl->entries.erase(it->second);
+                m_impl->index.erase(it);
+            }
+            ++m_impl->misses;
+        }
+
+        return found;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+_Use_decl_annotations_
+HRESULT CompressionCache::Store(const uint64_t key[2], const void* data, size_t size) noexcept
+{
+    if (!key || !data || !size)
+        return E_INVALIDARG;
+
+    if (!m_impl)
+        return E_UNEXPECTED;
+
+    const CacheKey k = { { key[0], key[1] } };
+
+    CacheHeader header = {};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.key[0] = key[0];
+    header.key[1] = key[1];
+    header.size = size;
+
+    try
+    {
+        const std::wstring path = m_impl->GetPath(k);
+
+        uint64_t counter;
+        {
+            std::lock_guard<std::mutex> lock(m_impl->mutex);
+            counter = ++m_impl->tempCounter;
+        }
+
+        // Temporary names must be unique across every process sharing the directory
+        const uint64_t salt[3] = {
+            counter,
+            static_cast<uint64_t>(std::chrono::high_resolution_clock::now().time_since_epoch().count()),
+            static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this))
+        };
+        const CacheKey tempKey = { { Internal::HashBytes(salt, sizeof(salt), key[0]), key[1] } };
+        const std::wstring tempPath = m_impl->directory + GetEntryName(tempKey) + CACHE_TEMP_EXTENSION;
+
+        HRESULT hr = WriteEntry(path, tempPath, header, data, size);
+        if (FAILED(hr))
+            return hr;
+
+        const uint64_t bytes = sizeof(CacheHeader) + size;
+
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+        auto it = m_impl->index.find(k);
+        if (it != m_impl->index.end())
+        {
+            // Replaced by an identical entry from another worker or process
+            m_impl->totalBytes -= it->second->bytes;
+            it->second->bytes = bytes;
+            m_impl->entries.splice(m_impl->entries.begin(), m_impl->entries, it->second);
+        }
+        else
+        {
+            m_impl->entries.push_front({ k, bytes, 0 });
+            m_impl->index[k] = m_impl->entries.begin();
+        }
+        m_impl->totalBytes += bytes;
+
+        if (m_impl->maxBytes)
+        {
+            m_impl->Evict(m_impl->maxBytes);
+        }
+    }
+    catch (...)
+    {
+        return E_OUTOFMEMORY;
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+void CompressionCache::Trim(uint64_t maxBytes) noexcept
+{
+    if (!m_impl)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->Evict(maxBytes);
+}
+
+void CompressionCache::Release() noexcept
+{
+    delete m_impl;
+    m_impl = nullptr;
+}
+
+uint64_t CompressionCache::GetSize() const noexcept
+{
+    if (!m_impl)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->totalBytes;
+}
+
+uint64_t CompressionCache::GetHitCount() const noexcept
+{
+    if (!m_impl)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->hits;
+}
+
+uint64_t CompressionCache::GetMissCount() const noexcept
+{
+    if (!m_impl)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->misses;
+}
@@ -195,6 +195,478 @@ namespace
     const XMVECTORF32 g_HalfMin = { { { -65504.f, -65504.f, -65504.f, -65504.f } } };
     const XMVECTORF32 g_HalfMax = { { { 65504.f, 65504.f, 65504.f, 65504.f } } };
     const XMVECTORF32 g_8BitBias = { { { 0.5f / 255.f, 0.5f / 255.f, 0.5f / 255.f, 0.5f / 255.f } } };
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    //---------------------------------------------------------------------------------
+    // SSE scanline kernels for the most common 32-bit formats. Four pixels are converted
+    // at a time with each channel in its own register, then transposed to or from the
+    // RGBA XMVECTOR layout. The scale and rounding match the XMLoad*/XMStore* functions.
+    //---------------------------------------------------------------------------------
+    const XMVECTORF32 g_UByteNScale = { { { 1.f / 255.f, 1.f / 255.f, 1.f / 255.f, 1.f / 255.f } } };
+    const XMVECTORF32 g_UByteNMax = { { { 255.f, 255.f, 255.f, 255.f } } };
+    const XMVECTORF32 g_UDecNScale = { { { 1.f / 1023.f, 1.f / 1023.f, 1.f / 1023.f, 1.f / 1023.f } } };
+    const XMVECTORF32 g_UDecNMax = { { { 1023.f, 1023.f, 1023.f, 1023.f } } };
+    const XMVECTORF32 g_UDecNAScale = { { { 1.f / 3.f, 1.f / 3.f, 1.f / 3.f, 1.f / 3.f } } };
+    const XMVECTORF32 g_UDecNAMax = { { { 3.f, 3.f, 3.f, 3.f } } };
+
+    inline XMVECTOR XM_CALLCONV LoadChannel(__m128i v, int shift, int mask, FXMVECTOR scale) noexcept
+    {
+        const __m128i c = _mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(mask));
+        return _mm_mul_ps(_mm_cvtepi32_ps(c), scale);
+    }
+
+    inline __m128i XM_CALLCONV StoreChannel(FXMVECTOR v, FXMVECTOR scale, int shift) noexcept
+    {
+        XMVECTOR n = _mm_max_ps(v, g_XMZero);
+        n = _mm_min_ps(n, g_XMOne);
+        n = _mm_mul_ps(n, scale);
+        return _mm_sll_epi32(_mm_cvttps_epi32(n), _mm_cvtsi32_si128(shift));
+    }
+
+    void LoadUByteN4x4(
+        _Out_writes_(4) XMVECTOR* pDestination,
+        _In_reads_(4) const uint32_t* pSource,
+        bool bgr) noexcept
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+
+        XMVECTOR r = LoadChannel(v, 0, 0xFF, g_UByteNScale);
+        XMVECTOR g = LoadChannel(v, 8, 0xFF, g_UByteNScale);
+        XMVECTOR b = LoadChannel(v, 16, 0xFF, g_UByteNScale);
+        XMVECTOR a = LoadChannel(v, 24, 0xFF, g_UByteNScale);
+        if (bgr)
+            std::swap(r, b);
+
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        pDestination[0] = r;
+        pDestination[1] = g;
+        pDestination[2] = b;
+        pDestination[3] = a;
+    }
+
+    void StoreUByteN4x4(
+        _Out_writes_(4) uint32_t* pDestination,
+        _In_reads_(4) const XMVECTOR* pSource,
+        bool bgr) noexcept
+    {
+        XMVECTOR r = pSource[0];
+        XMVECTOR g = pSource[1];
+        XMVECTOR b = pSource[2];
+        XMVECTOR a = pSource[3];
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        if (bgr)
+            std::swap(r, b);
+
+        __m128i v = StoreChannel(_mm_add_ps(r, g_8BitBias), g_UByteNMax, 0);
+        v = _mm_or_si128(v, StoreChannel(_mm_add_ps(g, g_8BitBias), g_UByteNMax, 8));
+        v = _mm_or_si128(v, StoreChannel(_mm_add_ps(b, g_8BitBias), g_UByteNMax, 16));
+        v = _mm_or_si128(v, StoreChannel(_mm_add_ps(a, g_8BitBias), g_UByteNMax, 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), v);
+    }
+
+    void LoadUDecN4x4(_Out_writes_(4) XMVECTOR* pDestination, _In_reads_(4) const uint32_t* pSource) noexcept
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+
+        XMVECTOR r = LoadChannel(v, 0, 0x3FF, g_UDecNScale);
+        XMVECTOR g = LoadChannel(v, 10, 0x3FF, g_UDecNScale);
+        XMVECTOR b = LoadChannel(v, 20, 0x3FF, g_UDecNScale);
+        XMVECTOR a = LoadChannel(v, 30, 0x3, g_UDecNAScale);
+
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        pDestination[0] = r;
+        pDestination[1] = g;
+        pDestination[2] = b;
+        pDestination[3] = a;
+    }
+
+    void StoreUDecN4x4(_Out_writes_(4) uint32_t* pDestination, _In_reads_(4) const XMVECTOR* pSource) noexcept
+    {
+        XMVECTOR r = pSource[0];
+        XMVECTOR g = pSource[1];
+        XMVECTOR b = pSource[2];
+        XMVECTOR a = pSource[3];
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+
+        __m128i v = StoreChannel(r, g_UDecNMax, 0);
+        v = _mm_or_si128(v, StoreChannel(g, g_UDecNMax, 10));
+        v = _mm_or_si128(v, StoreChannel(b, g_UDecNMax, 20));
+        v = _mm_or_si128(v, StoreChannel(a, g_UDecNAMax, 30));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), v);
+    }
+
+    // Expands a 5-bit exponent, mbits-bit mantissa unsigned float to a float
+    inline XMVECTOR XM_CALLCONV LoadPackedFloat(__m128i v, int shift, int mbits) noexcept
+    {
+        const __m128i c = _mm_srl_epi32(v, _mm_cvtsi32_si128(shift));
+        const __m128i m = _mm_and_si128(c, _mm_set1_epi32((1 << mbits) - 1));
+        const __m128i e = _mm_and_si128(_mm_srl_epi32(c, _mm_cvtsi32_si128(mbits)), _mm_set1_epi32(0x1F));
+        const __m128i fm = _mm_sll_epi32(m, _mm_cvtsi32_si128(23 - mbits));
+
+        // Normalized values rebias the exponent, while INF and NAN keep the mantissa bits
+        const __m128i normal = _mm_or_si128(_mm_slli_epi32(_mm_add_epi32(e, _mm_set1_epi32(112)), 23), fm);
+        const __m128i special = _mm_or_si128(_mm_set1_epi32(0x7F800000), fm);
+        const __m128i isSpecial = _mm_cmpeq_epi32(e, _mm_set1_epi32(0x1F));
+        const __m128i bits = _mm_or_si128(_mm_and_si128(isSpecial, special), _mm_andnot_si128(isSpecial, normal));
+
+        // Denormalized values (and zero) are exactly mantissa * 2^(-14 - mbits)
+        const XMVECTOR denorm = _mm_mul_ps(_mm_cvtepi32_ps(m), _mm_castsi128_ps(_mm_set1_epi32((127 - 14 - mbits) << 23)));
+        const XMVECTOR isDenorm = _mm_castsi128_ps(_mm_cmpeq_epi32(e, _mm_setzero_si128()));
+        return _mm_or_ps(_mm_and_ps(isDenorm, denorm), _mm_andnot_ps(isDenorm, _mm_castsi128_ps(bits)));
+    }
+
+    void LoadFloat3PKx4(_Out_writes_(4) XMVECTOR* pDestination, _In_reads_(4) const uint32_t* pSource) noexcept
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+
+        XMVECTOR r = LoadPackedFloat(v, 0, 6);
+        XMVECTOR g = LoadPackedFloat(v, 11, 6);
+        XMVECTOR b = LoadPackedFloat(v, 22, 5);
+        XMVECTOR a = g_XMOne;
+
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+        pDestination[0] = r;
+        pDestination[1] = g;
+        pDestination[2] = b;
+        pDestination[3] = a;
+    }
+
+    // Packs floats to a 5-bit exponent, mbits-bit mantissa unsigned float. Only valid for lanes
+    // that are +0 or normalized in the target format, which is reported through the mask
+    inline __m128i XM_CALLCONV StorePackedFloat(FXMVECTOR v, int mbits, int maxBits, __m128i& valid) noexcept
+    {
+        const __m128i i = _mm_castps_si128(v);
+        const __m128i isZero = _mm_cmpeq_epi32(i, _mm_setzero_si128());
+        const __m128i inRange = _mm_andnot_si128(
+            _mm_cmplt_epi32(i, _mm_set1_epi32(0x38800000)),
+            _mm_andnot_si128(_mm_cmpgt_epi32(i, _mm_set1_epi32(maxBits)), _mm_set1_epi32(-1)));
+        valid = _mm_and_si128(valid, _mm_or_si128(isZero, inRange));
+
+        // Rebias the exponent and round to nearest even
+        const int shift = 23 - mbits;
+        const __m128i count = _mm_cvtsi32_si128(shift);
+        __m128i r = _mm_add_epi32(i, _mm_set1_epi32(static_cast<int>(0xC8000000)));
+        const __m128i odd = _mm_and_si128(_mm_srl_epi32(r, count), _mm_set1_epi32(1));
+        r = _mm_add_epi32(r, _mm_add_epi32(_mm_set1_epi32((1 << shift) - 1), odd));
+        r = _mm_and_si128(_mm_srl_epi32(r, count), _mm_set1_epi32((1 << (mbits + 5)) - 1));
+        return _mm_andnot_si128(isZero, r);
+    }
+
+    void StoreFloat3PKx4(_Out_writes_(4) uint32_t* pDestination, _In_reads_(4) const XMVECTOR* pSource) noexcept
+    {
+        XMVECTOR r = pSource[0];
+        XMVECTOR g = pSource[1];
+        XMVECTOR b = pSource[2];
+        XMVECTOR a = pSource[3];
+        _MM_TRANSPOSE4_PS(r, g, b, a);
+
+        __m128i valid = _mm_set1_epi32(-1);
+        __m128i v = StorePackedFloat(r, 6, 0x477E0000, valid);
+        v = _mm_or_si128(v, _mm_slli_epi32(StorePackedFloat(g, 6, 0x477E0000, valid), 11));
+        v = _mm_or_si128(v, _mm_slli_epi32(StorePackedFloat(b, 5, 0x477C0000, valid), 22));
+
+        if (_mm_movemask_ps(_mm_castsi128_ps(valid)) == 0xF)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), v);
+        }
+        else
+        {
+            // Negative, denormalized, out of range, INF, or NAN values take the reference path
+            for (size_t j = 0; j < 4; ++j)
+            {
+                XMStoreFloat3PK(reinterpret_cast<XMFLOAT3PK*>(&pDestination[j]), pSource[j]);
+            }
+        }
+    }
+
+#if defined(_XM_AVX2_INTRINSICS_)
+    //---------------------------------------------------------------------------------
+    // AVX2 versions of the kernels above for eight pixels at a time. The channel math
+    // runs in 256-bit registers with the same per-lane operations, so results match the
+    // four pixel kernels exactly; only the transposes are done as two 4x4 halves.
+    //---------------------------------------------------------------------------------
+    inline __m256 XM_CALLCONV LoadChannel8(__m256i v, int shift, int mask, __m256 scale) noexcept
+    {
+        const __m256i c = _mm256_and_si256(_mm256_srl_epi32(v, _mm_cvtsi32_si128(shift)), _mm256_set1_epi32(mask));
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(c), scale);
+    }
+
+    inline __m256i XM_CALLCONV StoreChannel8(__m256 v, __m256 scale, int shift) noexcept
+    {
+        __m256 n = _mm256_max_ps(v, _mm256_setzero_ps());
+        n = _mm256_min_ps(n, _mm256_broadcast_ps(&g_XMOne.v));
+        n = _mm256_mul_ps(n, scale);
+        return _mm256_sll_epi32(_mm256_cvttps_epi32(n), _mm_cvtsi32_si128(shift));
+    }
+
+    inline void XM_CALLCONV StoreRGBA8(_Out_writes_(8) XMVECTOR* pDestination, __m256 r, __m256 g, __m256 b, __m256 a) noexcept
+    {
+        XMVECTOR r0 = _mm256_castps256_ps128(r);
+        XMVECTOR g0 = _mm256_castps256_ps128(g);
+        XMVECTOR b0 = _mm256_castps256_ps128(b);
+        XMVECTOR a0 = _mm256_castps256_ps128(a);
+        _MM_TRANSPOSE4_PS(r0, g0, b0, a0);
+        pDestination[0] = r0;
+        pDestination[1] = g0;
+        pDestination[2] = b0;
+        pDestination[3] = a0;
+
+        XMVECTOR r1 = _mm256_extractf128_ps(r, 1);
+        XMVECTOR g1 = _mm256_extractf128_ps(g, 1);
+        XMVECTOR b1 = _mm256_extractf128_ps(b, 1);
+        XMVECTOR a1 = _mm256_extractf128_ps(a, 1);
+        _MM_TRANSPOSE4_PS(r1, g1, b1, a1);
+        pDestination[4] = r1;
+        pDestination[5] = g1;
+        pDestination[6] = b1;
+        pDestination[7] = a1;
+    }
+
+    inline void XM_CALLCONV LoadRGBA8(_In_reads_(8) const XMVECTOR* pSource, __m256& r, __m256& g, __m256& b, __m256& a) noexcept
+    {
+        XMVECTOR r0 = pSource[0];
+        XMVECTOR g0 = pSource[1];
+        XMVECTOR b0 = pSource[2];
+        XMVECTOR a0 = pSource[3];
+        _MM_TRANSPOSE4_PS(r0, g0, b0, a0);
+
+        XMVECTOR r1 = pSource[4];
+        XMVECTOR g1 = pSource[5];
+        XMVECTOR b1 = pSource[6];
+        XMVECTOR a1 = pSource[7];
+        _MM_TRANSPOSE4_PS(r1, g1, b1, a1);
+
+        r = _mm256_insertf128_ps(_mm256_castps128_ps256(r0), r1, 1);
+        g = _mm256_insertf128_ps(_mm256_castps128_ps256(g0), g1, 1);
+        b = _mm256_insertf128_ps(_mm256_castps128_ps256(b0), b1, 1);
+        a = _mm256_insertf128_ps(_mm256_castps128_ps256(a0), a1, 1);
+    }
+
+    void LoadUByteN8(
+        _Out_writes_(8) XMVECTOR* pDestination,
+        _In_reads_(8) const uint32_t* pSource,
+        bool bgr) noexcept
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+        const __m256 scale = _mm256_broadcast_ps(&g_UByteNScale.v);
+
+        __m256 r = LoadChannel8(v, 0, 0xFF, scale);
+        const __m256 g = LoadChannel8(v, 8, 0xFF, scale);
+        __m256 b = LoadChannel8(v, 16, 0xFF, scale);
+        const __m256 a = LoadChannel8(v, 24, 0xFF, scale);
+        if (bgr)
+            std::swap(r, b);
+
+        StoreRGBA8(pDestination, r, g, b, a);
+    }
+
+    void StoreUByteN8(
+        _Out_writes_(8) uint32_t* pDestination,
+        _In_reads_(8) const XMVECTOR* pSource,
+        bool bgr) noexcept
+    {
+        __m256 r, g, b, a;
+        LoadRGBA8(pSource, r, g, b, a);
+        if (bgr)
+            std::swap(r, b);
+
+        const __m256 bias = _mm256_broadcast_ps(&g_8BitBias.v);
+        const __m256 scale = _mm256_broadcast_ps(&g_UByteNMax.v);
+
+        __m256i v = StoreChannel8(_mm256_add_ps(r, bias), scale, 0);
+        v = _mm256_or_si256(v, StoreChannel8(_mm256_add_ps(g, bias), scale, 8));
+        v = _mm256_or_si256(v, StoreChannel8(_mm256_add_ps(b, bias), scale, 16));
+        v = _mm256_or_si256(v, StoreChannel8(_mm256_add_ps(a, bias), scale, 24));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), v);
+    }
+
+    void LoadUDecN8(_Out_writes_(8) XMVECTOR* pDestination, _In_reads_(8) const uint32_t* pSource) noexcept
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+        const __m256 scale = _mm256_broadcast_ps(&g_UDecNScale.v);
+
+        StoreRGBA8(pDestination,
+            LoadChannel8(v, 0, 0x3FF, scale),
+            LoadChannel8(v, 10, 0x3FF, scale),
+            LoadChannel8(v, 20, 0x3FF, scale),
+            LoadChannel8(v, 30, 0x3, _mm256_broadcast_ps(&g_UDecNAScale.v)));
+    }
+
+    void StoreUDecN8(_Out_writes_(8) uint32_t* pDestination, _In_reads_(8) const XMVECTOR* pSource) noexcept
+    {
+        __m256 r, g, b, a;
+        LoadRGBA8(pSource, r, g, b, a);
+
+        const __m256 scale = _mm256_broadcast_ps(&g_UDecNMax.v);
+
+        __m256i v = StoreChannel8(r, scale, 0);
+        v = _mm256_or_si256(v, StoreChannel8(g, scale, 10));
+        v = _mm256_or_si256(v, StoreChannel8(b, scale, 20));
+        v = _mm256_or_si256(v, StoreChannel8(a, _mm256_broadcast_ps(&g_UDecNAMax.v), 30));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), v);
+    }
+
+    inline __m256 XM_CALLCONV LoadPackedFloat8(__m256i v, int shift, int mbits) noexcept
+    {
+        const __m256i c = _mm256_srl_epi32(v, _mm_cvtsi32_si128(shift));
+        const __m256i m = _mm256_and_si256(c, _mm256_set1_epi32((1 << mbits) - 1));
+        const __m256i e = _mm256_and_si256(_mm256_srl_epi32(c, _mm_cvtsi32_si128(mbits)), _mm256_set1_epi32(0x1F));
+        const __m256i fm = _mm256_sll_epi32(m, _mm_cvtsi32_si128(23 - mbits));
+
+        const __m256i normal = _mm256_or_si256(_mm256_slli_epi32(_mm256_add_epi32(e, _mm256_set1_epi32(112)), 23), fm);
+        const __m256i special = _mm256_or_si256(_mm256_set1_epi32(0x7F800000), fm);
+        const __m256i isSpecial = _mm256_cmpeq_epi32(e, _mm256_set1_epi32(0x1F));
+        const __m256i bits = _mm256_blendv_epi8(normal, special, isSpecial);
+
+        const __m256 denorm = _mm256_mul_ps(_mm256_cvtepi32_ps(m), _mm256_castsi256_ps(_mm256_set1_epi32((127 - 14 - mbits) << 23)));
+        const __m256 isDenorm = _mm256_castsi256_ps(_mm256_cmpeq_epi32(e, _mm256_setzero_si256()));
+        return _mm256_blendv_ps(_mm256_castsi256_ps(bits), denorm, isDenorm);
+    }
+
+    void LoadFloat3PKx8(_Out_writes_(8) XMVECTOR* pDestination, _In_reads_(8) const uint32_t* pSource) noexcept
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+
+        StoreRGBA8(pDestination,
+            LoadPackedFloat8(v, 0, 6),
+            LoadPackedFloat8(v, 11, 6),
+            LoadPackedFloat8(v, 22, 5),
+            _mm256_broadcast_ps(&g_XMOne.v));
+    }
+
+    inline __m256i XM_CALLCONV StorePackedFloat8(__m256 v, int mbits, int maxBits, __m256i& valid) noexcept
+    {
+        const __m256i i = _mm256_castps_si256(v);
+        const __m256i isZero = _mm256_cmpeq_epi32(i, _mm256_setzero_si256());
+        const __m256i inRange = _mm256_andnot_si256(
+            _mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), i),
+            _mm256_andnot_si256(_mm256_cmpgt_epi32(i, _mm256_set1_epi32(maxBits)), _mm256_set1_epi32(-1)));
+        valid = _mm256_and_si256(valid, _mm256_or_si256(isZero, inRange));
+
+        const int shift = 23 - mbits;
+        const __m128i count = _mm_cvtsi32_si128(shift);
+        __m256i r = _mm256_add_epi32(i, _mm256_set1_epi32(static_cast<int>(0xC8000000)));
+        const __m256i odd = _mm256_and_si256(_mm256_srl_epi32(r, count), _mm256_set1_epi32(1));
+        r = _mm256_add_epi32(r, _mm256_add_epi32(_mm256_set1_epi32((1 << shift) - 1), odd));
+        r = _mm256_and_si256(_mm256_srl_epi32(r, count), _mm256_set1_epi32((1 << (mbits + 5)) - 1));
+        return _mm256_andnot_si256(isZero, r);
+    }
+
+    void StoreFloat3PKx8(_Out_writes_(8) uint32_t* pDestination, _In_reads_(8) const XMVECTOR* pSource) noexcept
+    {
+        __m256 r, g, b, a;
+        LoadRGBA8(pSource, r, g, b, a);
+
+        __m256i valid = _mm256_set1_epi32(-1);
+        __m256i v = StorePackedFloat8(r, 6, 0x477E0000, valid);
+        v = _mm256_or_si256(v, _mm256_slli_epi32(StorePackedFloat8(g, 6, 0x477E0000, valid), 11));
+        v = _mm256_or_si256(v, _mm256_slli_epi32(StorePackedFloat8(b, 5, 0x477C0000, valid), 22));
+
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(valid)) == 0xFF)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), v);
+        }
+        else
+        {
+            StoreFloat3PKx4(pDestination, pSource);
+            StoreFloat3PKx4(pDestination + 4, pSource + 4);
+        }
+    }
+#else
+    // Without AVX2 the eight pixel kernels are two independent four pixel groups
+    void LoadUByteN8(_Out_writes_(8) XMVECTOR* pDestination, _In_reads_(8) const uint32_t* pSource, bool bgr) noexcept
+    {
+        LoadUByteN4x4(pDestination, pSource, bgr);
+        LoadUByteN4x4(pDestination + 4, pSource + 4, bgr);
+    }
+
+    void StoreUByteN8(_Out_writes_(8) uint32_t* pDestination, _In_reads_(8) const XMVECTOR* pSource, bool bgr) noexcept
+    {
+        StoreUByteN4x4(pDestination, pSource, bgr);
+        StoreUByteN4x4(pDestination + 4, pSource + 4, bgr);
+    }
+
+    void LoadUDecN8(_Out_writes_(8) XMVECTOR* pDestination, _In_reads_(8) const uint32_t* pSource) noexcept
+    {
+        LoadUDecN4x4(pDestination, pSource);
+        LoadUDecN4x4(pDestination + 4, pSource + 4);
+    }
+
+    void StoreUDecN8(_Out_writes_(8) uint32_t* pDestination, _In_reads_(8) const XMVECTOR* pSource) noexcept
+    {
+        StoreUDecN4x4(pDestination, pSource);
+        StoreUDecN4x4(pDestination + 4, pSource + 4);
+    }
+
+    void LoadFloat3PKx8(_Out_writes_(8) XMVECTOR* pDestination, _In_reads_(8) const uint32_t* pSource) noexcept
+    {
+        LoadFloat3PKx4(pDestination, pSource);
+        LoadFloat3PKx4(pDestination + 4, pSource + 4);
+    }
+
+    void StoreFloat3PKx8(_Out_writes_(8) uint32_t* pDestination, _In_reads_(8) const XMVECTOR* pSource) noexcept
+    {
+        StoreFloat3PKx4(pDestination, pSource);
+        StoreFloat3PKx4(pDestination + 4, pSource + 4);
+    }
+#endif // _XM_AVX2_INTRINSICS_
+
+    //---------------------------------------------------------------------------------
+    // Red/blue channel swaps for SwizzleScanline, four pixels at a time. Each returns the
+    // number of pixels it handled, leaving the rest to the scalar loop, and may be used
+    // in place.
+    //---------------------------------------------------------------------------------
+    size_t SwizzleRB8888(
+        _Out_writes_(count) uint32_t* dPtr,
+        _In_reads_(count) const uint32_t* sPtr,
+        size_t count,
+        bool setAlpha) noexcept
+    {
+        const __m128i alpha = _mm_set1_epi32(setAlpha ? static_cast<int>(0xff000000) : 0);
+    #if defined(_XM_SSE4_INTRINSICS_)
+        const __m128i shuffle = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    #else
+        const __m128i maskRB = _mm_set1_epi32(0x00ff00ff);
+    #endif
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr + i));
+        #if defined(_XM_SSE4_INTRINSICS_)
+            v = _mm_shuffle_epi8(v, shuffle);
+        #else
+            const __m128i rb = _mm_and_si128(v, maskRB);
+            v = _mm_or_si128(_mm_andnot_si128(maskRB, v), _mm_or_si128(_mm_srli_epi32(rb, 16), _mm_slli_epi32(rb, 16)));
+        #endif
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr + i), _mm_or_si128(v, alpha));
+        }
+        return i;
+    }
+
+    size_t SwizzleRB1010102(
+        _Out_writes_(count) uint32_t* dPtr,
+        _In_reads_(count) const uint32_t* sPtr,
+        size_t count,
+        bool setAlpha) noexcept
+    {
+        // The 10-bit fields do not sit on byte boundaries, so these are shifted rather than shuffled
+        const __m128i keep = _mm_set1_epi32(setAlpha ? 0x000ffc00 : static_cast<int>(0xC00ffc00));
+        const __m128i alpha = _mm_set1_epi32(setAlpha ? static_cast<int>(0xC0000000) : 0);
+        const __m128i mask10 = _mm_set1_epi32(0x3ff);
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr + i));
+            const __m128i r = _mm_and_si128(_mm_srli_epi32(v, 20), mask10);
+            const __m128i b = _mm_slli_epi32(_mm_and_si128(v, mask10), 20);
+            const __m128i ga = _mm_or_si128(_mm_and_si128(v, keep), alpha);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr + i), _mm_or_si128(ga, _mm_or_si128(r, b)));
+        }
+        return i;
+    }
+#endif // _XM_SSE_INTRINSICS_
 }
 
 //-------------------------------------------------------------------------------------
@@ -475,7 +947,12 @@ void DirectX::Internal::SwizzleScanline(
                 if (pDestination == pSource)
                 {
                     auto dPtr = static_cast<uint32_t*>(pDestination);
-                    for (size_t count = 0; count < (outSize - 3); count += 4)
+                    size_t count = 0;
+                #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                    count = SwizzleRB1010102(dPtr, dPtr, outSize / 4, (tflags & TEXP_SCANLINE_SETALPHA) != 0) * 4;
+                    dPtr += count / 4;
+                #endif
+                    for (; count < (outSize - 3); count += 4)
                     {
                         const uint32_t t = *dPtr;
 
@@ -492,7 +969,13 @@ void DirectX::Internal::SwizzleScanline(
                     const uint32_t * __restrict sPtr = static_cast<const uint32_t*>(pSource);
                     uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
                     const size_t size = std::min<size_t>(outSize, inSize);
-                    for (size_t count = 0; count < (size - 3); count += 4)
+                    size_t count = 0;
+                #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                    count = SwizzleRB1010102(dPtr, sPtr, size / 4, (tflags & TEXP_SCANLINE_SETALPHA) != 0) * 4;
+                    sPtr += count / 4;
+                    dPtr += count / 4;
+                #endif
+                    for (; count < (size - 3); count += 4)
                     {
                         const uint32_t t = *(sPtr++);
 
@@ -525,7 +1008,12 @@ void DirectX::Internal::SwizzleScanline(
             if (pDestination == pSource)
             {
                 auto dPtr = static_cast<uint32_t*>(pDestination);
-                for (size_t count = 0; count < (outSize - 3); count += 4)
+                size_t count = 0;
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                count = SwizzleRB8888(dPtr, dPtr, outSize / 4, (tflags & TEXP_SCANLINE_SETALPHA) != 0) * 4;
+                dPtr += count / 4;
+            #endif
+                for (; count < (outSize - 3); count += 4)
                 {
                     const uint32_t t = *dPtr;
 
@@ -542,7 +1030,13 @@ void DirectX::Internal::SwizzleScanline(
                 const uint32_t * __restrict sPtr = static_cast<const uint32_t*>(pSource);
                 uint32_t * __restrict dPtr = static_cast<uint32_t*>(pDestination);
                 const size_t size = std::min<size_t>(outSize, inSize);
-                for (size_t count = 0; count < (size - 3); count += 4)
+                size_t count = 0;
+            #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+                count = SwizzleRB8888(dPtr, sPtr, size / 4, (tflags & TEXP_SCANLINE_SETALPHA) != 0) * 4;
+                sPtr += count / 4;
+                dPtr += count / 4;
+            #endif
+                for (; count < (size - 3); count += 4)
                 {
                     const uint32_t t = *(sPtr++);
 
@@ -775,6 +1269,75 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
 
     const XMVECTOR* ePtr = pDestination + count;
 
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    // Whole groups of four pixels use the SIMD kernels, eight at a time, leaving any remainder to the per-pixel code below
+    if (count >= 4 && size >= sizeof(uint32_t) * 4)
+    {
+        const size_t pixels = std::min<size_t>(count, size / sizeof(uint32_t)) & ~size_t(3);
+        const uint32_t* __restrict sPtr = static_cast<const uint32_t*>(pSource);
+
+        bool handled = true;
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    LoadUByteN8(dPtr + i, sPtr + i, false);
+                if (i < pixels)
+                    LoadUByteN4x4(dPtr + i, sPtr + i, false);
+            }
+            break;
+
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    LoadUByteN8(dPtr + i, sPtr + i, true);
+                if (i < pixels)
+                    LoadUByteN4x4(dPtr + i, sPtr + i, true);
+            }
+            break;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    LoadUDecN8(dPtr + i, sPtr + i);
+                if (i < pixels)
+                    LoadUDecN4x4(dPtr + i, sPtr + i);
+            }
+            break;
+
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    LoadFloat3PKx8(dPtr + i, sPtr + i);
+                if (i < pixels)
+                    LoadFloat3PKx4(dPtr + i, sPtr + i);
+            }
+            break;
+
+        default:
+            handled = false;
+            break;
+        }
+
+        if (handled)
+        {
+            size -= pixels * sizeof(uint32_t);
+            if (pixels == count || size < sizeof(uint32_t))
+                return true;
+
+            dPtr += pixels;
+            pSource = sPtr + pixels;
+        }
+    }
+#endif
+
     switch (static_cast<int>(format))
     {
     case DXGI_FORMAT_R32G32B32A32_FLOAT:
@@ -800,7 +1363,17 @@ _Use_decl_annotations_ bool DirectX::Internal::LoadScanline(
         LOAD_SCANLINE3(XMINT3, XMLoadSInt3, g_XMIdentityR3)
 
     case DXGI_FORMAT_R16G16B16A16_FLOAT:
-        LOAD_SCANLINE(XMHALF4, XMLoadHalf4)
+        if (size >= sizeof(XMHALF4))
+        {
+            // The stream conversion is vectorized when F16C is available
+            const size_t pixels = std::min<size_t>(size_t(ePtr - dPtr), size / sizeof(XMHALF4));
+            XMConvertHalfToFloatStream(
+                reinterpret_cast<float*>(dPtr), sizeof(float),
+                static_cast<const HALF*>(pSource), sizeof(HALF),
+                pixels * 4);
+            return true;
+        }
+        return false;
 
     case DXGI_FORMAT_R16G16B16A16_UNORM:
         LOAD_SCANLINE(XMUSHORTN4, XMLoadUShortN4)
@@ -1632,6 +2205,75 @@ bool DirectX::Internal::StoreScanline(
     *reinterpret_cast<uint8_t*>(pDestination) = 0;
 #endif
 
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    // Whole groups of four pixels use the SIMD kernels, eight at a time, leaving any remainder to the per-pixel code below
+    if (count >= 4 && size >= sizeof(uint32_t) * 4)
+    {
+        const size_t pixels = std::min<size_t>(count, size / sizeof(uint32_t)) & ~size_t(3);
+        uint32_t* __restrict dPtr = static_cast<uint32_t*>(pDestination);
+
+        bool handled = true;
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    StoreUByteN8(dPtr + i, sPtr + i, false);
+                if (i < pixels)
+                    StoreUByteN4x4(dPtr + i, sPtr + i, false);
+            }
+            break;
+
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    StoreUByteN8(dPtr + i, sPtr + i, true);
+                if (i < pixels)
+                    StoreUByteN4x4(dPtr + i, sPtr + i, true);
+            }
+            break;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    StoreUDecN8(dPtr + i, sPtr + i);
+                if (i < pixels)
+                    StoreUDecN4x4(dPtr + i, sPtr + i);
+            }
+            break;
+
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+            {
+                size_t i = 0;
+                for (; i + 8 <= pixels; i += 8)
+                    StoreFloat3PKx8(dPtr + i, sPtr + i);
+                if (i < pixels)
+                    StoreFloat3PKx4(dPtr + i, sPtr + i);
+            }
+            break;
+
+        default:
+            handled = false;
+            break;
+        }
+
+        if (handled)
+        {
+            size -= pixels * sizeof(uint32_t);
+            if (pixels == count || size < sizeof(uint32_t))
+                return true;
+
+            sPtr += pixels;
+            pDestination = dPtr + pixels;
+        }
+    }
+#endif
+
     switch (static_cast<int>(format))
     {
     case DXGI_FORMAT_R32G32B32A32_FLOAT:
@@ -1655,13 +2297,26 @@ bool DirectX::Internal::StoreScanline(
     case DXGI_FORMAT_R16G16B16A16_FLOAT:
         if (size >= sizeof(XMHALF4))
         {
+            // Clamp a block of pixels at a time so the stream conversion (vectorized when F16C is available) can do the rest
             XMHALF4* __restrict dPtr = static_cast<XMHALF4*>(pDestination);
-            for (size_t icount = 0; icount < (size - sizeof(XMHALF4) + 1); icount += sizeof(XMHALF4))
+            size_t pixels = std::min<size_t>(size_t(ePtr - sPtr), size / sizeof(XMHALF4));
+
+            XM_ALIGNED_DATA(16) XMVECTOR temp[16];
+            while (pixels > 0)
             {
-                if (sPtr >= ePtr) break;
-                XMVECTOR v = *sPtr++;
-                v = XMVectorClamp(v, g_HalfMin, g_HalfMax);
-                XMStoreHalf4(dPtr++, v);
+                const size_t n = std::min<size_t>(pixels, std::size(temp));
+                for (size_t j = 0; j < n; ++j)
+                {
+                    temp[j] = XMVectorClamp(*sPtr++, g_HalfMin, g_HalfMax);
+                }
+
+                XMConvertFloatToHalfStream(
+                    reinterpret_cast<HALF*>(dPtr), sizeof(HALF),
+                    reinterpret_cast<const float*>(temp), sizeof(float),
+                    n * 4);
+
+                dPtr += n;
+                pixels -= n;
             }
             return true;
         }
@@ -4620,6 +5275,225 @@ namespace
     #endif // WIN32
     }
 
+    //-------------------------------------------------------------------------------------
+    // Direct conversions for common format pairs that skip the XMVECTOR intermediate
+    //-------------------------------------------------------------------------------------
+    enum DIRECT_CONVERT : uint32_t
+    {
+        DCONV_NONE = 0,
+        DCONV_SWIZZLE_8888,     // RGBA <-> BGRA channel swap
+        DCONV_TABLE_8888,       // 8:8:8:8 through per-channel lookup tables (i.e. linear <-> sRGB), with optional swap
+        DCONV_TABLE_565,        // 8:8:8:8 to 5:6:5 through per-channel lookup tables
+        DCONV_R16F_TO_R32F,
+        DCONV_R32F_TO_R16F,
+    };
+
+    struct DirectConvertData
+    {
+        DXGI_FORMAT     sformat;
+        DXGI_FORMAT     tformat;
+        DIRECT_CONVERT  type;
+    };
+
+    const DirectConvertData g_DirectConvertTable[] =
+    {
+        { DXGI_FORMAT_R8G8B8A8_UNORM,       DXGI_FORMAT_B8G8R8A8_UNORM,         DCONV_SWIZZLE_8888 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,  DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,    DCONV_SWIZZLE_8888 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,       DXGI_FORMAT_R8G8B8A8_UNORM,         DCONV_SWIZZLE_8888 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,  DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,    DCONV_SWIZZLE_8888 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM,       DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,    DCONV_TABLE_8888 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM,       DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,    DCONV_TABLE_8888 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,  DXGI_FORMAT_R8G8B8A8_UNORM,         DCONV_TABLE_8888 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,  DXGI_FORMAT_B8G8R8A8_UNORM,         DCONV_TABLE_8888 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,       DXGI_FORMAT_R8G8B8A8_UNORM_SRGB,    DCONV_TABLE_8888 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,       DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,    DCONV_TABLE_8888 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,  DXGI_FORMAT_R8G8B8A8_UNORM,         DCONV_TABLE_8888 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM_SRGB,  DXGI_FORMAT_B8G8R8A8_UNORM,         DCONV_TABLE_8888 },
+        { DXGI_FORMAT_R8G8B8A8_UNORM,       DXGI_FORMAT_B5G6R5_UNORM,           DCONV_TABLE_565 },
+        { DXGI_FORMAT_B8G8R8A8_UNORM,       DXGI_FORMAT_B5G6R5_UNORM,           DCONV_TABLE_565 },
+        { DXGI_FORMAT_R16_FLOAT,            DXGI_FORMAT_R32_FLOAT,              DCONV_R16F_TO_R32F },
+        { DXGI_FORMAT_R32_FLOAT,            DXGI_FORMAT_R16_FLOAT,              DCONV_R32F_TO_R16F },
+    };
+
+    DIRECT_CONVERT GetDirectConversion(
+        _In_ TEX_FILTER_FLAGS filter,
+        _In_ DXGI_FORMAT sformat,
+        _In_ DXGI_FORMAT tformat) noexcept
+    {
+        // Dithering, explicit colorspace or bias requests, and forced WIC all need the general path
+        if (filter & (TEX_FILTER_DITHER | TEX_FILTER_DITHER_DIFFUSION | TEX_FILTER_FLOAT_X2BIAS
+            | TEX_FILTER_SRGB_MASK | TEX_FILTER_FORCE_WIC))
+            return DCONV_NONE;
+
+        for (size_t i = 0; i < std::size(g_DirectConvertTable); ++i)
+        {
+            if (g_DirectConvertTable[i].sformat == sformat && g_DirectConvertTable[i].tformat == tformat)
+                return g_DirectConvertTable[i].type;
+        }
+
+        return DCONV_NONE;
+    }
+
+    inline bool IsBGR(_In_ DXGI_FORMAT format) noexcept
+    {
+        return (format == DXGI_FORMAT_B8G8R8A8_UNORM) || (format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB);
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Builds per-channel tables by running a gray ramp through the general conversion path,
+    // so the table-based converters produce exactly the same results
+    //-------------------------------------------------------------------------------------
+    HRESULT BuildDirectConvertTable(
+        _In_ DXGI_FORMAT sformat,
+        _In_ DXGI_FORMAT tformat,
+        _In_ TEX_FILTER_FLAGS filter,
+        _Out_writes_all_(256) uint32_t* table) noexcept
+    {
+        auto scanline = make_AlignedArrayXMVECTOR(256);
+        if (!scanline)
+            return E_OUTOFMEMORY;
+
+        uint32_t ramp[256];
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            ramp[i] = i * 0x01010101u;
+        }
+
+        if (!LoadScanline(scanline.get(), 256, ramp, sizeof(ramp), sformat))
+            return E_FAIL;
+
+        ConvertScanline(scanline.get(), 256, tformat, sformat, filter);
+
+        if (tformat == DXGI_FORMAT_B5G6R5_UNORM)
+        {
+            uint16_t result[256];
+            if (!StoreScanline(result, sizeof(result), tformat, scanline.get(), 256, 0.f))
+                return E_FAIL;
+
+            for (size_t i = 0; i < 256; ++i)
+            {
+                table[i] = result[i];
+            }
+        }
+        else
+        {
+            if (!StoreScanline(table, sizeof(uint32_t) * 256, tformat, scanline.get(), 256, 0.f))
+                return E_FAIL;
+        }
+
+        return S_OK;
+    }
+
+    HRESULT ConvertDirect(
+        _In_ const Image& srcImage,
+        _In_ TEX_FILTER_FLAGS filter,
+        _In_ const Image& destImage,
+        DIRECT_CONVERT type) noexcept
+    {
+        assert(srcImage.width == destImage.width);
+        assert(srcImage.height == destImage.height);
+
+        const uint8_t *pSrc = srcImage.pixels;
+        uint8_t *pDest = destImage.pixels;
+        if (!pSrc || !pDest)
+            return E_POINTER;
+
+        const size_t width = srcImage.width;
+
+        uint32_t table[256] = {};
+        if (type == DCONV_TABLE_8888 || type == DCONV_TABLE_565)
+        {
+            HRESULT hr = BuildDirectConvertTable(srcImage.format, destImage.format, filter, table);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        // Source byte order is R,G,B,A or B,G,R,A
+        const bool swap = (IsBGR(srcImage.format) != IsBGR(destImage.format));
+        const size_t ri = IsBGR(srcImage.format) ? 16 : 0;
+        const size_t bi = IsBGR(srcImage.format) ? 0 : 16;
+
+        for (size_t h = 0; h < srcImage.height; ++h)
+        {
+            switch (type)
+            {
+            case DCONV_SWIZZLE_8888:
+                SwizzleScanline(pDest, destImage.rowPitch, pSrc, srcImage.rowPitch, srcImage.format, 0);
+                break;
+
+            case DCONV_TABLE_8888:
+                {
+                    auto sPtr = reinterpret_cast<const uint32_t*>(pSrc);
+                    auto dPtr = reinterpret_cast<uint32_t*>(pDest);
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        const uint32_t t = *(sPtr++);
+                        const uint32_t s0 = swap ? ((t >> 16) & 0xff) : (t & 0xff);
+                        const uint32_t s2 = swap ? (t & 0xff) : ((t >> 16) & 0xff);
+
+                        const uint32_t t0 = table[s0] & 0x000000ff;
+                        const uint32_t t1 = table[(t >> 8) & 0xff] & 0x0000ff00;
+                        const uint32_t t2 = table[s2] & 0x00ff0000;
+                        const uint32_t ta = table[t >> 24] & 0xff000000;
+
+                        *(dPtr++) = t0 | t1 | t2 | ta;
+                    }
+                }
+                break;
+
+            case DCONV_TABLE_565:
+                {
+                    auto sPtr = reinterpret_cast<const uint32_t*>(pSrc);
+                    auto dPtr = reinterpret_cast<uint16_t*>(pDest);
+                    for (size_t x = 0; x < width; ++x)
+                    {
+                        const uint32_t t = *(sPtr++);
+                        const uint32_t r = table[(t >> ri) & 0xff] & 0xf800;
+                        const uint32_t g = table[(t >> 8) & 0xff] & 0x07e0;
+                        const uint32_t b = table[(t >> bi) & 0xff] & 0x001f;
+                        *(dPtr++) = static_cast<uint16_t>(r | g | b);
+                    }
+                }
+                break;
+
+            case DCONV_R16F_TO_R32F:
+                XMConvertHalfToFloatStream(
+                    reinterpret_cast<float*>(pDest), sizeof(float),
+                    reinterpret_cast<const HALF*>(pSrc), sizeof(HALF),
+                    width);
+                break;
+
+            case DCONV_R32F_TO_R16F:
+                {
+                    // Clamp a block at a time (matching StoreScanline) so the stream conversion can do the rest
+                    auto sPtr = reinterpret_cast<const float*>(pSrc);
+                    auto dPtr = reinterpret_cast<HALF*>(pDest);
+
+                    float temp[64];
+                    for (size_t x = 0; x < width; x += std::size(temp))
+                    {
+                        const size_t n = std::min<size_t>(width - x, std::size(temp));
+                        for (size_t j = 0; j < n; ++j)
+                        {
+                            temp[j] = std::max<float>(std::min<float>(sPtr[x + j], 65504.f), -65504.f);
+                        }
+
+                        XMConvertFloatToHalfStream(dPtr + x, sizeof(HALF), temp, sizeof(float), n);
+                    }
+                }
+                break;
+
+            default:
+                return E_UNEXPECTED;
+            }
+
+            pSrc += srcImage.rowPitch;
+            pDest += destImage.rowPitch;
+        }
+
+        return S_OK;
+    }
+
     //-------------------------------------------------------------------------------------
     // Convert the source image (not using WIC)
     //-------------------------------------------------------------------------------------
@@ -4919,7 +5793,12 @@ HRESULT DirectX::Convert(
     }
 
     WICPixelFormatGUID pfGUID, targetGUID;
-    if (UseWICConversion(filter, srcImage.format, format, pfGUID, targetGUID))
+    const DIRECT_CONVERT direct = GetDirectConversion(filter, srcImage.format, format);
+    if (direct != DCONV_NONE)
+    {
+        hr = ConvertDirect(srcImage, filter, *rimage, direct);
+    }
+    else if (UseWICConversion(filter, srcImage.format, format, pfGUID, targetGUID))
     {
         hr = ConvertUsingWIC(srcImage, pfGUID, targetGUID, filter, threshold, *rimage);
     }
@@ -4983,7 +5862,9 @@ HRESULT DirectX::Convert(
     }
 
     WICPixelFormatGUID pfGUID, targetGUID;
-    const bool usewic = !metadata.IsPMAlpha() && UseWICConversion(filter, metadata.format, format, pfGUID, targetGUID);
+    const DIRECT_CONVERT direct = GetDirectConversion(filter, metadata.format, format);
+    const bool usewic = (direct == DCONV_NONE)
+        && !metadata.IsPMAlpha() && UseWICConversion(filter, metadata.format, format, pfGUID, targetGUID);
 
     switch (metadata.dimension)
     {
@@ -5013,7 +5894,11 @@ HRESULT DirectX::Convert(
                 return E_FAIL;
             }
 
-            if (usewic)
+            if (direct != DCONV_NONE)
+            {
+                hr = ConvertDirect(src, filter, dst, direct);
+            }
+            else if (usewic)
             {
                 hr = ConvertUsingWIC(src, pfGUID, targetGUID, filter, threshold, dst);
             }
@@ -5066,7 +5951,11 @@ HRESULT DirectX::Convert(
                         return E_FAIL;
                     }
 
-                    if (usewic)
+                    if (direct != DCONV_NONE)
+                    {
+                        hr = ConvertDirect(src, filter, dst, direct);
+                    }
+                    else if (usewic)
                     {
                         hr = ConvertUsingWIC(src, pfGUID, targetGUID, filter, threshold, dst);
                     }
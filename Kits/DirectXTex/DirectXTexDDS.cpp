@@ -13,6 +13,13 @@
 
 #include "DDS.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 using namespace DirectX;
 using namespace DirectX::Internal;
 
@@ -1985,6 +1992,264 @@ HRESULT DirectX::LoadFromDDSFile(
 }
 
 
+//-------------------------------------------------------------------------------------
+// Memory-mapped DDS file view
+//-------------------------------------------------------------------------------------
+DDSFileView& DDSFileView::operator= (DDSFileView&& moveFrom) noexcept
+{
+    if (this != &moveFrom)
+    {
+        Release();
+
+        m_nimages = moveFrom.m_nimages;
+        m_metadata = moveFrom.m_metadata;
+        m_image = moveFrom.m_image;
+        m_mapping = moveFrom.m_mapping;
+        m_mappingSize = moveFrom.m_mappingSize;
+        m_copy = std::move(moveFrom.m_copy);
+
+        moveFrom.m_nimages = 0;
+        moveFrom.m_image = nullptr;
+        moveFrom.m_mapping = nullptr;
+        moveFrom.m_mappingSize = 0;
+    }
+    return *this;
+}
+
+void DDSFileView::Unmap() noexcept
+{
+    if (m_image)
+    {
+        delete[] m_image;
+        m_image = nullptr;
+    }
+
+    if (m_mapping)
+    {
+    #ifdef _WIN32
+        std::ignore = UnmapViewOfFile(m_mapping);
+    #else
+        std::ignore = munmap(m_mapping, m_mappingSize);
+    #endif
+        m_mapping = nullptr;
+    }
+
+    m_nimages = 0;
+    m_mappingSize = 0;
+}
+
+void DDSFileView::Release() noexcept
+{
+    Unmap();
+    m_copy.Release();
+
+    memset(&m_metadata, 0, sizeof(m_metadata));
+}
+
+const Image* DDSFileView::GetImages() const noexcept
+{
+    return (m_image) ? m_image : m_copy.GetImages();
+}
+
+size_t DDSFileView::GetImageCount() const noexcept
+{
+    return (m_image) ? m_nimages : m_copy.GetImageCount();
+}
+
+_Use_decl_annotations_
+const Image* DDSFileView::GetImage(size_t mip, size_t item, size_t slice) const noexcept
+{
+    if (!m_image)
+        return m_copy.GetImage(mip, item, slice);
+
+    if (mip >= m_metadata.mipLevels)
+        return nullptr;
+
+    if (m_metadata.dimension == TEX_DIMENSION_TEXTURE3D)
+    {
+        // No support for arrays of volumes
+        if (item > 0 || slice >= std::max<size_t>(1, m_metadata.depth >> mip))
+            return nullptr;
+    }
+    else if (slice > 0 || item >= m_metadata.arraySize)
+    {
+        return nullptr;
+    }
+
+    const size_t index = m_metadata.ComputeIndex(mip, item, slice);
+    if (index >= m_nimages)
+        return nullptr;
+
+    return &m_image[index];
+}
+
+
+//-------------------------------------------------------------------------------------
+// Map a DDS file from disk
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::LoadFromDDSFile(
+    const wchar_t* szFile,
+    DDS_FLAGS flags,
+    TexMetadata* metadata,
+    DDSFileView& view) noexcept
+{
+    if (!szFile)
+        return E_INVALIDARG;
+
+    view.Release();
+
+#ifdef _WIN32
+#if (_WIN32_WINNT >= _WIN32_WINNT_WIN8)
+    ScopedHandle hFile(safe_handle(CreateFile2(szFile, GENERIC_READ, FILE_SHARE_READ, OPEN_EXISTING, nullptr)));
+#else
+    ScopedHandle hFile(safe_handle(CreateFileW(szFile, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr)));
+#endif
+    if (!hFile)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // Get the file size
+    FILE_STANDARD_INFO fileInfo;
+    if (!GetFileInformationByHandleEx(hFile.get(), FileStandardInfo, &fileInfo, sizeof(fileInfo)))
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // Keep the same 4 GB limit as the reading loader
+    if (fileInfo.EndOfFile.HighPart > 0)
+        return HRESULT_E_FILE_TOO_LARGE;
+
+    const size_t len = fileInfo.EndOfFile.LowPart;
+
+    // Need at least enough data to fill the standard header and magic number to be a valid DDS
+    if (len < (sizeof(DDS_HEADER) + sizeof(uint32_t)))
+    {
+        return E_FAIL;
+    }
+
+    ScopedHandle hMapping(CreateFileMappingW(hFile.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+    if (!hMapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+
+    // The view keeps the file contents alive after the mapping handle is closed
+    void* pMapping = MapViewOfFile(hMapping.get(), FILE_MAP_READ, 0, 0, 0);
+    if (!pMapping)
+    {
+        return HRESULT_FROM_WIN32(GetLastError());
+    }
+#else // !WIN32
+    const int fd = open(std::filesystem::path(szFile).c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return E_FAIL;
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0)
+    {
+        close(fd);
+        return E_FAIL;
+    }
+
+    if (static_cast<uint64_t>(fileStat.st_size) > UINT32_MAX)
+    {
+        close(fd);
+        return HRESULT_E_FILE_TOO_LARGE;
+    }
+
+    const size_t len = static_cast<size_t>(fileStat.st_size);
+
+    // Need at least enough data to fill the standard header and magic number to be a valid DDS
+    if (len < (sizeof(DDS_HEADER) + sizeof(uint32_t)))
+    {
+        close(fd);
+        return E_FAIL;
+    }
+
+    void* pMapping = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (pMapping == MAP_FAILED)
+        return E_FAIL;
+#endif
+
+    // The view owns the mapping from here on, so any failure below must release it
+    view.m_mapping = pMapping;
+    view.m_mappingSize = len;
+
+    auto pSource = static_cast<const uint8_t*>(pMapping);
+
+    uint32_t convFlags = 0;
+    TexMetadata mdata;
+    HRESULT hr = DecodeDDSHeader(pSource, len, flags, mdata, convFlags);
+    if (FAILED(hr))
+    {
+        view.Release();
+        return hr;
+    }
+
+    if ((convFlags & (CONV_FLAGS_EXPAND | CONV_FLAGS_SWIZZLE | CONV_FLAGS_NOALPHA | CONV_FLAGS_PAL8))
+        || (flags & (DDS_FLAGS_LEGACY_DWORD | DDS_FLAGS_BAD_DXTN_TAILS)))
+    {
+        // Legacy layouts can't be used in place, so decode a copy and drop the mapping
+        hr = LoadFromDDSMemory(pSource, len, flags, nullptr, view.m_copy);
+        view.Unmap();
+        if (FAILED(hr))
+        {
+            view.Release();
+            return hr;
+        }
+    }
+    else
+    {
+        size_t offset = sizeof(uint32_t) + sizeof(DDS_HEADER);
+        if (convFlags & CONV_FLAGS_DX10)
+            offset += sizeof(DDS_HEADER_DXT10);
+
+        size_t nimages = 0;
+        size_t pixelSize = 0;
+        hr = DetermineImageArray(mdata, CP_FLAGS_NONE, nimages, pixelSize);
+        if (FAILED(hr))
+        {
+            view.Release();
+            return hr;
+        }
+
+        if (offset > len || (len - offset) < pixelSize)
+        {
+            view.Release();
+            return HRESULT_E_HANDLE_EOF;
+        }
+
+        view.m_image = new (std::nothrow) Image[nimages];
+        if (!view.m_image)
+        {
+            view.Release();
+            return E_OUTOFMEMORY;
+        }
+
+        view.m_nimages = nimages;
+        memset(view.m_image, 0, sizeof(Image) * nimages);
+
+        // Image::pixels is non-const, but the pages are mapped read-only
+        if (!SetupImageArray(const_cast<uint8_t*>(pSource + offset), pixelSize, mdata, CP_FLAGS_NONE, view.m_image, nimages))
+        {
+            view.Release();
+            return E_FAIL;
+        }
+    }
+
+    view.m_metadata = mdata;
+
+    if (metadata)
+        memcpy(metadata, &mdata, sizeof(TexMetadata));
+
+    return S_OK;
+}
+
+
 //-------------------------------------------------------------------------------------
 // Save a DDS file to memory
 //-------------------------------------------------------------------------------------
@@ -13,10 +13,437 @@
 
 using namespace DirectX;
 using namespace DirectX::Internal;
+
+#ifdef _WIN32
 using Microsoft::WRL::ComPtr;
+#endif
 
 namespace
 {
+    //-------------------------------------------------------------------------------------
+    // Maps destination pixels to source pixels for a flip/rotate operation. The rotation
+    // (clockwise) is applied first, and then the flips in the rotated image.
+    //-------------------------------------------------------------------------------------
+    struct FlipRotateMapping
+    {
+        ptrdiff_t x0, y0;   // Source pixel for destination (0,0)
+        ptrdiff_t xdx, ydx; // Source step for each destination column
+        ptrdiff_t xdy, ydy; // Source step for each destination row
+
+        FlipRotateMapping(size_t width, size_t height, TEX_FR_FLAGS flags) noexcept
+        {
+            const auto w = static_cast<ptrdiff_t>(width);
+            const auto h = static_cast<ptrdiff_t>(height);
+
+            // Source x,y for rotated x,y
+            ptrdiff_t rx0 = 0, rxx = 1, rxy = 0;
+            ptrdiff_t ry0 = 0, ryx = 0, ryy = 1;
+            ptrdiff_t rw = w, rh = h;
+
+            switch (flags & (TEX_FR_ROTATE0 | TEX_FR_ROTATE90 | TEX_FR_ROTATE180 | TEX_FR_ROTATE270))
+            {
+            case TEX_FR_ROTATE90:
+                rx0 = 0;        rxx = 0;    rxy = 1;
+                ry0 = h - 1;    ryx = -1;   ryy = 0;
+                rw = h; rh = w;
+                break;
+
+            case TEX_FR_ROTATE180:
+                rx0 = w - 1;    rxx = -1;   rxy = 0;
+                ry0 = h - 1;    ryx = 0;    ryy = -1;
+                break;
+
+            case TEX_FR_ROTATE270:
+                rx0 = w - 1;    rxx = 0;    rxy = -1;
+                ry0 = 0;        ryx = 1;    ryy = 0;
+                rw = h; rh = w;
+                break;
+
+            default:
+                break;
+            }
+
+            // Rotated x,y for destination x,y
+            ptrdiff_t fx0 = 0, fxx = 1;
+            ptrdiff_t fy0 = 0, fyy = 1;
+
+            if (flags & TEX_FR_FLIP_HORIZONTAL)
+            {
+                fx0 = rw - 1;
+                fxx = -1;
+            }
+
+            if (flags & TEX_FR_FLIP_VERTICAL)
+            {
+                fy0 = rh - 1;
+                fyy = -1;
+            }
+
+            x0 = rx0 + rxx * fx0 + rxy * fy0;
+            xdx = rxx * fxx;
+            xdy = rxy * fyy;
+
+            y0 = ry0 + ryx * fx0 + ryy * fy0;
+            ydx = ryx * fxx;
+            ydy = ryy * fyy;
+        }
+
+        void Map(size_t dx, size_t dy, size_t& sx, size_t& sy) const noexcept
+        {
+            sx = static_cast<size_t>(x0 + xdx * ptrdiff_t(dx) + xdy * ptrdiff_t(dy));
+            sy = static_cast<size_t>(y0 + ydx * ptrdiff_t(dx) + ydy * ptrdiff_t(dy));
+        }
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Flip/rotate of uncompressed pixels
+    //-------------------------------------------------------------------------------------
+    constexpr size_t FR_TILE_SIZE = 32;
+
+    template<size_t N> struct Pixel { uint8_t v[N]; };
+
+    inline bool IsNativeFlipRotate(DXGI_FORMAT format) noexcept
+    {
+        if (IsCompressed(format) || IsPlanar(format) || IsPacked(format))
+            return false;
+
+        const size_t bpp = BitsPerPixel(format);
+        switch (bpp)
+        {
+        case 8:
+        case 16:
+        case 32:
+        case 64:
+        case 96:
+        case 128:
+            return true;
+
+        default:
+            return false;
+        }
+    }
+
+    template<typename T>
+    void CopyRows(const Image& srcImage, const FlipRotateMapping& map, const Image& destImage) noexcept
+    {
+        // Each destination row is a source row, either forwards or reversed
+        assert(map.xdx != 0 && map.ydx == 0);
+
+        for (size_t dy = 0; dy < destImage.height; ++dy)
+        {
+            size_t sx, sy;
+            map.Map(0, dy, sx, sy);
+
+            auto sptr = reinterpret_cast<const T*>(srcImage.pixels + srcImage.rowPitch * sy) + sx;
+            auto dptr = reinterpret_cast<T*>(destImage.pixels + destImage.rowPitch * dy);
+
+            if (map.xdx > 0)
+            {
+                memcpy(dptr, sptr, sizeof(T) * destImage.width);
+            }
+            else
+            {
+                for (size_t dx = 0; dx < destImage.width; ++dx)
+                {
+                    dptr[dx] = *(sptr - dx);
+                }
+            }
+        }
+    }
+
+    template<typename T>
+    void TransposeTileScalar(
+        const Image& srcImage, const FlipRotateMapping& map, const Image& destImage,
+        size_t tx, size_t ty, size_t tw, size_t th) noexcept
+    {
+        // Each destination row is a source column, so the copy is done in tiles which fit in cache
+        assert(map.xdx == 0 && map.ydx != 0);
+
+        const ptrdiff_t sstep = map.ydx * ptrdiff_t(srcImage.rowPitch);
+
+        for (size_t dy = ty; dy < ty + th; ++dy)
+        {
+            size_t sx, sy;
+            map.Map(tx, dy, sx, sy);
+
+            auto sptr = srcImage.pixels + srcImage.rowPitch * sy + sizeof(T) * sx;
+            auto dptr = reinterpret_cast<T*>(destImage.pixels + destImage.rowPitch * dy) + tx;
+
+            for (size_t dx = 0; dx < tw; ++dx, sptr += sstep)
+            {
+                dptr[dx] = *reinterpret_cast<const T*>(sptr);
+            }
+        }
+    }
+
+    template<typename T>
+    inline void TransposeTile(
+        const Image& srcImage, const FlipRotateMapping& map, const Image& destImage,
+        size_t tx, size_t ty, size_t tw, size_t th) noexcept
+    {
+        TransposeTileScalar<T>(srcImage, map, destImage, tx, ty, tw, th);
+    }
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    template<>
+    void TransposeTile<uint32_t>(
+        const Image& srcImage, const FlipRotateMapping& map, const Image& destImage,
+        size_t tx, size_t ty, size_t tw, size_t th) noexcept
+    {
+        assert(map.xdx == 0 && map.ydx != 0);
+
+        // 4x4 blocks of destination pixels are four runs of four source pixels, which are transposed
+        const size_t tw4 = tw & ~size_t(3);
+        const size_t th4 = th & ~size_t(3);
+        const ptrdiff_t sstep = map.ydx * ptrdiff_t(srcImage.rowPitch);
+
+        for (size_t dy = ty; dy < ty + th4; dy += 4)
+        {
+            for (size_t dx = tx; dx < tx + tw4; dx += 4)
+            {
+                // Source runs go along x, in the same or the opposite order as destination rows
+                size_t sx, sy;
+                map.Map(dx, (map.xdy > 0) ? dy : (dy + 3), sx, sy);
+
+                auto sptr = srcImage.pixels + srcImage.rowPitch * sy + sizeof(uint32_t) * sx;
+
+                XMVECTOR r0 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sptr)));
+                XMVECTOR r1 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sptr + sstep)));
+                XMVECTOR r2 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sptr + sstep * 2)));
+                XMVECTOR r3 = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(sptr + sstep * 3)));
+
+                _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+                if (map.xdy < 0)
+                {
+                    std::swap(r0, r3);
+                    std::swap(r1, r2);
+                }
+
+                auto dptr = destImage.pixels + destImage.rowPitch * dy + sizeof(uint32_t) * dx;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dptr), _mm_castps_si128(r0));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dptr + destImage.rowPitch), _mm_castps_si128(r1));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dptr + destImage.rowPitch * 2), _mm_castps_si128(r2));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dptr + destImage.rowPitch * 3), _mm_castps_si128(r3));
+            }
+        }
+
+        // Remaining columns and rows
+        if (tw4 < tw)
+        {
+            TransposeTileScalar<uint32_t>(srcImage, map, destImage, tx + tw4, ty, tw - tw4, th4);
+        }
+
+        if (th4 < th)
+        {
+            TransposeTileScalar<uint32_t>(srcImage, map, destImage, tx, ty + th4, tw, th - th4);
+        }
+    }
+#endif
+
+    template<typename T>
+    void FlipRotatePixels(const Image& srcImage, const FlipRotateMapping& map, const Image& destImage) noexcept
+    {
+        if (map.ydx == 0)
+        {
+            CopyRows<T>(srcImage, map, destImage);
+            return;
+        }
+
+        for (size_t ty = 0; ty < destImage.height; ty += FR_TILE_SIZE)
+        {
+            const size_t th = std::min(FR_TILE_SIZE, destImage.height - ty);
+
+            for (size_t tx = 0; tx < destImage.width; tx += FR_TILE_SIZE)
+            {
+                const size_t tw = std::min(FR_TILE_SIZE, destImage.width - tx);
+
+                TransposeTile<T>(srcImage, map, destImage, tx, ty, tw, th);
+            }
+        }
+    }
+
+    HRESULT PerformFlipRotate(
+        const Image& srcImage,
+        TEX_FR_FLAGS flags,
+        const Image& destImage) noexcept
+    {
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        assert(srcImage.format == destImage.format);
+        assert(IsNativeFlipRotate(srcImage.format));
+
+        const FlipRotateMapping map(srcImage.width, srcImage.height, flags);
+
+        switch (BitsPerPixel(srcImage.format))
+        {
+        case 8:     FlipRotatePixels<uint8_t>(srcImage, map, destImage); break;
+        case 16:    FlipRotatePixels<uint16_t>(srcImage, map, destImage); break;
+        case 32:    FlipRotatePixels<uint32_t>(srcImage, map, destImage); break;
+        case 64:    FlipRotatePixels<Pixel<8>>(srcImage, map, destImage); break;
+        case 96:    FlipRotatePixels<Pixel<12>>(srcImage, map, destImage); break;
+        case 128:   FlipRotatePixels<Pixel<16>>(srcImage, map, destImage); break;
+
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+
+        return S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Flip/rotate of BC compressed images
+    //
+    // Blocks are moved as a unit and the per-pixel indices within each block permuted, so
+    // the endpoints are unchanged and no re-encoding is needed. BC6H and BC7 are not
+    // supported as their partition shapes and anchor indices don't survive a permutation.
+    //-------------------------------------------------------------------------------------
+    struct BCIndexField
+    {
+        uint8_t offset;     // Byte offset of the 16 indices within the block
+        uint8_t bits;       // Bits per index
+    };
+
+    size_t GetBCIndexFields(DXGI_FORMAT format, _Out_writes_(2) BCIndexField* fields) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            fields[0] = { 4, 2 };
+            return 1;
+
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+            fields[0] = { 0, 4 };
+            fields[1] = { 12, 2 };
+            return 2;
+
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            fields[0] = { 2, 3 };
+            fields[1] = { 12, 2 };
+            return 2;
+
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:
+        case DXGI_FORMAT_BC4_SNORM:
+            fields[0] = { 2, 3 };
+            return 1;
+
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:
+        case DXGI_FORMAT_BC5_SNORM:
+            fields[0] = { 2, 3 };
+            fields[1] = { 10, 3 };
+            return 2;
+
+        default:
+            return 0;
+        }
+    }
+
+    inline bool IsBlockAligned(size_t size) noexcept
+    {
+        // Either whole blocks, or a single partial block (e.g. the smallest mips)
+        return ((size % 4) == 0) || (size < 4);
+    }
+
+    void PermuteIndices(_Inout_updates_bytes_(16) uint8_t* block, const BCIndexField& field, const uint8_t* permute) noexcept
+    {
+        const size_t bytes = field.bits * 2;
+        const uint64_t mask = (uint64_t(1) << field.bits) - 1;
+
+        uint64_t src = 0;
+        for (size_t j = 0; j < bytes; ++j)
+        {
+            src |= uint64_t(block[field.offset + j]) << (j * 8);
+        }
+
+        uint64_t dst = 0;
+        for (size_t i = 0; i < 16; ++i)
+        {
+            dst |= ((src >> (permute[i] * field.bits)) & mask) << (i * field.bits);
+        }
+
+        for (size_t j = 0; j < bytes; ++j)
+        {
+            block[field.offset + j] = static_cast<uint8_t>(dst >> (j * 8));
+        }
+    }
+
+    HRESULT PerformFlipRotateBC(
+        const Image& srcImage,
+        TEX_FR_FLAGS flags,
+        const Image& destImage) noexcept
+    {
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        assert(srcImage.format == destImage.format);
+
+        BCIndexField fields[2] = {};
+        const size_t nfields = GetBCIndexFields(srcImage.format, fields);
+        if (!nfields)
+            return HRESULT_E_NOT_SUPPORTED;
+
+        // Every block must map to a single source block
+        if (!IsBlockAligned(srcImage.width) || !IsBlockAligned(srcImage.height))
+            return HRESULT_E_NOT_SUPPORTED;
+
+        const size_t blockSize = (BitsPerPixel(srcImage.format) == 4) ? 8 : 16;
+
+        const FlipRotateMapping map(srcImage.width, srcImage.height, flags);
+
+        const size_t nbw = std::max<size_t>(1, (destImage.width + 3) / 4);
+        const size_t nbh = std::max<size_t>(1, (destImage.height + 3) / 4);
+
+        uint8_t* pDest = destImage.pixels;
+        for (size_t by = 0; by < nbh; ++by, pDest += destImage.rowPitch)
+        {
+            uint8_t* dptr = pDest;
+            for (size_t bx = 0; bx < nbw; ++bx, dptr += blockSize)
+            {
+                // Source pixel for each destination pixel, with padding reusing the nearest pixel
+                uint8_t permute[16];
+                size_t sbx = 0, sby = 0;
+                for (size_t i = 0; i < 16; ++i)
+                {
+                    const size_t dx = std::min(bx * 4 + (i & 3), destImage.width - 1);
+                    const size_t dy = std::min(by * 4 + (i >> 2), destImage.height - 1);
+
+                    size_t sx, sy;
+                    map.Map(dx, dy, sx, sy);
+
+                    if (!i)
+                    {
+                        sbx = sx >> 2;
+                        sby = sy >> 2;
+                    }
+                    assert((sx >> 2) == sbx && (sy >> 2) == sby);
+
+                    permute[i] = static_cast<uint8_t>(((sy & 3) << 2) | (sx & 3));
+                }
+
+                memcpy(dptr, srcImage.pixels + srcImage.rowPitch * sby + blockSize * sbx, blockSize);
+
+                for (size_t f = 0; f < nfields; ++f)
+                {
+                    PermuteIndices(dptr, fields[f], permute);
+                }
+            }
+        }
+
+        return S_OK;
+    }
+
+
+#ifdef _WIN32
     //-------------------------------------------------------------------------------------
     // Do flip/rotate operation using WIC
     //-------------------------------------------------------------------------------------
@@ -172,6 +599,7 @@ namespace
 
         return S_OK;
     }
+#endif // _WIN32
 }
 
 
@@ -199,16 +627,20 @@ HRESULT DirectX::FlipRotate(
 
     if (IsCompressed(srcImage.format))
     {
-        // We don't support flip/rotate operations on compressed images
-        return HRESULT_E_NOT_SUPPORTED;
+        // Only block-permutable compressed formats are supported
+        BCIndexField fields[2];
+        if (!GetBCIndexFields(srcImage.format, fields))
+            return HRESULT_E_NOT_SUPPORTED;
     }
 
+#ifdef _WIN32
     static_assert(static_cast<int>(TEX_FR_ROTATE0) == static_cast<int>(WICBitmapTransformRotate0), "TEX_FR_ROTATE0 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_ROTATE90) == static_cast<int>(WICBitmapTransformRotate90), "TEX_FR_ROTATE90 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_ROTATE180) == static_cast<int>(WICBitmapTransformRotate180), "TEX_FR_ROTATE180 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_ROTATE270) == static_cast<int>(WICBitmapTransformRotate270), "TEX_FR_ROTATE270 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_FLIP_HORIZONTAL) == static_cast<int>(WICBitmapTransformFlipHorizontal), "TEX_FR_FLIP_HORIZONTAL no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_FLIP_VERTICAL) == static_cast<int>(WICBitmapTransformFlipVertical), "TEX_FR_FLIP_VERTICAL no longer matches WIC");
+#endif
 
     // Only supports 90, 180, 270, or no rotation flags... not a combination of rotation flags
     const int rotateMode = static_cast<int>(flags & (TEX_FR_ROTATE0 | TEX_FR_ROTATE90 | TEX_FR_ROTATE180 | TEX_FR_ROTATE270));
@@ -245,25 +677,43 @@ HRESULT DirectX::FlipRotate(
         return E_POINTER;
     }
 
-    WICPixelFormatGUID pfGUID;
-    if (DXGIToWIC(srcImage.format, pfGUID))
+    if (IsCompressed(srcImage.format))
+    {
+        // Case 1: BC compressed blocks are moved and their indices permuted
+        hr = PerformFlipRotateBC(srcImage, flags, *rimage);
+    }
+    else if (IsNativeFlipRotate(srcImage.format))
     {
-        // Case 1: Source format is supported by Windows Imaging Component
-        hr = PerformFlipRotateUsingWIC(srcImage, flags, pfGUID, *rimage);
+        // Case 2: Pixels are whole bytes, so they are copied directly
+        hr = PerformFlipRotate(srcImage, flags, *rimage);
     }
     else
     {
-        // Case 2: Source format is not supported by WIC, so we have to convert, flip/rotate, and convert back
-        const uint64_t expandedSize = uint64_t(srcImage.width) * uint64_t(srcImage.height) * sizeof(float) * 4;
-        if (expandedSize > UINT32_MAX)
+    #ifdef _WIN32
+        WICPixelFormatGUID pfGUID;
+        if (DXGIToWIC(srcImage.format, pfGUID))
         {
-            // Image is too large for float32, so have to use float16 instead
-            hr = PerformFlipRotateViaF16(srcImage, flags, *rimage);
+            // Case 3: Source format is supported by Windows Imaging Component
+            hr = PerformFlipRotateUsingWIC(srcImage, flags, pfGUID, *rimage);
         }
         else
         {
-            hr = PerformFlipRotateViaF32(srcImage, flags, *rimage);
+            // Case 4: Source format is not supported by WIC, so we have to convert, flip/rotate, and convert back
+            const uint64_t expandedSize = uint64_t(srcImage.width) * uint64_t(srcImage.height) * sizeof(float) * 4;
+            if (expandedSize > UINT32_MAX)
+            {
+                // Image is too large for float32, so have to use float16 instead
+                hr = PerformFlipRotateViaF16(srcImage, flags, *rimage);
+            }
+            else
+            {
+                hr = PerformFlipRotateViaF32(srcImage, flags, *rimage);
+            }
         }
+    #else
+        // Sub-byte and packed formats require WIC
+        hr = HRESULT_E_NOT_SUPPORTED;
+    #endif
     }
 
     if (FAILED(hr))
@@ -292,16 +742,20 @@ HRESULT DirectX::FlipRotate(
 
     if (IsCompressed(metadata.format))
     {
-        // We don't support flip/rotate operations on compressed images
-        return HRESULT_E_NOT_SUPPORTED;
+        // Only block-permutable compressed formats are supported
+        BCIndexField fields[2];
+        if (!GetBCIndexFields(metadata.format, fields))
+            return HRESULT_E_NOT_SUPPORTED;
     }
 
+#ifdef _WIN32
     static_assert(static_cast<int>(TEX_FR_ROTATE0) == static_cast<int>(WICBitmapTransformRotate0), "TEX_FR_ROTATE0 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_ROTATE90) == static_cast<int>(WICBitmapTransformRotate90), "TEX_FR_ROTATE90 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_ROTATE180) == static_cast<int>(WICBitmapTransformRotate180), "TEX_FR_ROTATE180 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_ROTATE270) == static_cast<int>(WICBitmapTransformRotate270), "TEX_FR_ROTATE270 no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_FLIP_HORIZONTAL) == static_cast<int>(WICBitmapTransformFlipHorizontal), "TEX_FR_FLIP_HORIZONTAL no longer matches WIC");
     static_assert(static_cast<int>(TEX_FR_FLIP_VERTICAL) == static_cast<int>(WICBitmapTransformFlipVertical), "TEX_FR_FLIP_VERTICAL no longer matches WIC");
+#endif
 
     // Only supports 90, 180, 270, or no rotation flags... not a combination of rotation flags
     const int rotateMode = static_cast<int>(flags & (TEX_FR_ROTATE0 | TEX_FR_ROTATE90 | TEX_FR_ROTATE180 | TEX_FR_ROTATE270));
@@ -345,8 +799,13 @@ HRESULT DirectX::FlipRotate(
         return E_POINTER;
     }
 
+    const bool compressed = IsCompressed(metadata.format);
+    const bool native = IsNativeFlipRotate(metadata.format);
+
+#ifdef _WIN32
     WICPixelFormatGUID pfGUID;
     const bool wicpf = DXGIToWIC(metadata.format, pfGUID);
+#endif
 
     for (size_t index = 0; index < nimages; ++index)
     {
@@ -380,14 +839,25 @@ HRESULT DirectX::FlipRotate(
             }
         }
 
-        if (wicpf)
+        if (compressed)
+        {
+            // Case 1: BC compressed blocks are moved and their indices permuted
+            hr = PerformFlipRotateBC(src, flags, dst);
+        }
+        else if (native)
         {
-            // Case 1: Source format is supported by Windows Imaging Component
+            // Case 2: Pixels are whole bytes, so they are copied directly
+            hr = PerformFlipRotate(src, flags, dst);
+        }
+    #ifdef _WIN32
+        else if (wicpf)
+        {
+            // Case 3: Source format is supported by Windows Imaging Component
             hr = PerformFlipRotateUsingWIC(src, flags, pfGUID, dst);
         }
         else
         {
-            // Case 2: Source format is not supported by WIC, so we have to convert, flip/rotate, and convert back
+            // Case 4: Source format is not supported by WIC, so we have to convert, flip/rotate, and convert back
             const uint64_t expandedSize = uint64_t(src.width) * uint64_t(src.height) * sizeof(float) * 4;
             if (expandedSize > UINT32_MAX)
             {
@@ -399,6 +869,13 @@ HRESULT DirectX::FlipRotate(
                 hr = PerformFlipRotateViaF32(src, flags, dst);
             }
         }
+    #else
+        else
+        {
+            // Sub-byte and packed formats require WIC
+            hr = HRESULT_E_NOT_SUPPORTED;
+        }
+    #endif
 
         if (FAILED(hr))
         {
@@ -305,60 +305,259 @@ namespace
     }
 
     //-------------------------------------------------------------------------------------
-    // FloatToRGBE
+    // Decodes a single scanline to RGBE. If rgbe is null, the scanline is only validated.
+    // Returns the number of source bytes used by the scanline, or 0 on failure.
     //-------------------------------------------------------------------------------------
-    inline void FloatToRGBE(_Out_writes_(width*4) uint8_t* pDestination, _In_reads_(width*fpp) const float* pSource, size_t width, _In_range_(3, 4) int fpp) noexcept
+    size_t DecodeScanline(
+        _Out_writes_opt_(width * 4) uint8_t* rgbe,
+        _In_reads_bytes_(size) const uint8_t* pSource,
+        size_t size,
+        size_t width) noexcept
     {
-        auto ePtr = pSource + width * size_t(fpp);
+        if (size < 4)
+            return 0;
 
-        for (size_t j = 0; j < width; ++j)
-        {
-            if (pSource + 2 >= ePtr) break;
-            const float r = pSource[0] >= 0.f ? pSource[0] : 0.f;
-            const float g = pSource[1] >= 0.f ? pSource[1] : 0.f;
-            const float b = pSource[2] >= 0.f ? pSource[2] : 0.f;
-            pSource += fpp;
+        const uint8_t* sPtr = pSource;
+        const uint8_t* endPtr = pSource + size;
 
-            const float max_xy = (r > g) ? r : g;
-            float max_xyz = (max_xy > b) ? max_xy : b;
+        uint8_t inColor[4];
+        memcpy(inColor, sPtr, 4);
+        sPtr += 4;
 
-            if (max_xyz > 1e-32f)
+        if (inColor[0] == 2 && inColor[1] == 2 && inColor[2] < 128)
+        {
+            // Adaptive Run Length Encoding (RLE)
+            if (size_t((size_t(inColor[2]) << 8) + inColor[3]) != width)
+                return 0;
+
+            for (size_t channel = 0; channel < 4; ++channel)
             {
-                int e;
-                max_xyz = frexpf(max_xyz, &e) * 256.f / max_xyz;
-                e += 128;
+                for (size_t pixelCount = 0; pixelCount < width;)
+                {
+                    if (endPtr - sPtr < 2)
+                        return 0;
 
-                const uint8_t red = uint8_t(r * max_xyz);
-                const uint8_t green = uint8_t(g * max_xyz);
-                const uint8_t blue = uint8_t(b * max_xyz);
+                    size_t runLen = *sPtr;
+                    if (runLen > 128)
+                    {
+                        runLen &= 127;
+                        if (pixelCount + runLen > width)
+                            return 0;
 
-                pDestination[0] = red;
-                pDestination[1] = green;
-                pDestination[2] = blue;
-                pDestination[3] = (red || green || blue) ? uint8_t(e & 0xff) : 0u;
+                        if (rgbe)
+                        {
+                            uint8_t* pixelLoc = rgbe + pixelCount * 4 + channel;
+                            const uint8_t val = sPtr[1];
+                            for (size_t j = 0; j < runLen; ++j)
+                            {
+                                pixelLoc[j * 4] = val;
+                            }
+                        }
+                        sPtr += 2;
+                    }
+                    else
+                    {
+                        if ((size_t(endPtr - sPtr) < runLen + 1) || ((pixelCount + runLen) > width))
+                            return 0;
+
+                        ++sPtr;
+                        if (rgbe)
+                        {
+                            uint8_t* pixelLoc = rgbe + pixelCount * 4 + channel;
+                            for (size_t j = 0; j < runLen; ++j)
+                            {
+                                pixelLoc[j * 4] = sPtr[j];
+                            }
+                        }
+                        sPtr += runLen;
+                    }
+                    pixelCount += runLen;
+                }
             }
-            else
+        }
+        else
+        {
+            uint8_t prevColor[4];
+            memcpy(prevColor, inColor, 4);
+
+            int bitShift = 0;
+            for (size_t pixelCount = 0; pixelCount < width;)
             {
-                pDestination[0] = pDestination[1] = pDestination[2] = pDestination[3] = 0;
+                if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
+                {
+                    if (bitShift > 24)
+                        return 0;
+
+                    // "Standard" Run Length Encoding
+                    const size_t spanLen = size_t(inColor[3]) << bitShift;
+                    if (spanLen + pixelCount > width)
+                        return 0;
+
+                    if (rgbe)
+                    {
+                        for (size_t j = 0; j < spanLen; ++j)
+                        {
+                            memcpy(rgbe + (pixelCount + j) * 4, prevColor, 4);
+                        }
+                    }
+                    pixelCount += spanLen;
+                    bitShift += 8;
+                }
+                else
+                {
+                    // Uncompressed
+                    if (rgbe)
+                    {
+                        memcpy(rgbe + pixelCount * 4, inColor, 4);
+                    }
+                    memcpy(prevColor, inColor, 4);
+                    bitShift = 0;
+                    ++pixelCount;
+                }
+
+                if (pixelCount >= width)
+                    break;
+
+                if (endPtr - sPtr < 4)
+                    return 0;
+
+                memcpy(inColor, sPtr, 4);
+                sPtr += 4;
             }
+        }
 
-            pDestination += 4;
+        return size_t(sPtr - pSource);
+    }
+
+#if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+    //-------------------------------------------------------------------------------------
+    // Expands one RGBE pixel (as four 32-bit integers) to float, with alpha of 1.0
+    //-------------------------------------------------------------------------------------
+    inline XMVECTOR XM_CALLCONV ExpandRGBE(__m128i pixel, XMVECTOR scale) noexcept
+    {
+        // 2^(e - 136) is applied as two factors so neither leaves the normal float range,
+        // which keeps the result bit-exact with ldexpf
+        const __m128i bias = _mm_set1_epi32(127 - 68);
+        const __m128i e = _mm_shuffle_epi32(pixel, _MM_SHUFFLE(3, 3, 3, 3));
+        const __m128i elo = _mm_srli_epi32(e, 1);
+        const __m128i ehi = _mm_sub_epi32(e, elo);
+
+        XMVECTOR v = _mm_add_ps(_mm_cvtepi32_ps(pixel), g_XMOneHalf);
+        v = _mm_mul_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(elo, bias), 23)));
+        v = _mm_mul_ps(v, _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(ehi, bias), 23)));
+        v = _mm_mul_ps(scale, v);
+
+        return XMVectorSelect(g_XMIdentityR3, v, g_XMSelect1110);
+    }
+#endif
+
+    //-------------------------------------------------------------------------------------
+    // RGBEToFloat
+    //-------------------------------------------------------------------------------------
+    void RGBEToFloat(_Out_writes_(width * 4) float* pDestination, _In_reads_(width * 4) const uint8_t* pSource, size_t width, float exposure) noexcept
+    {
+        const float scale = 1.0f / exposure;
+
+        size_t j = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m128i zero = _mm_setzero_si128();
+        const XMVECTOR vscale = _mm_set1_ps(scale);
+
+        for (; j + 4 <= width; j += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + j * 4));
+            const __m128i lo = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+            _mm_storeu_ps(pDestination + j * 4, ExpandRGBE(_mm_unpacklo_epi16(lo, zero), vscale));
+            _mm_storeu_ps(pDestination + j * 4 + 4, ExpandRGBE(_mm_unpackhi_epi16(lo, zero), vscale));
+            _mm_storeu_ps(pDestination + j * 4 + 8, ExpandRGBE(_mm_unpacklo_epi16(hi, zero), vscale));
+            _mm_storeu_ps(pDestination + j * 4 + 12, ExpandRGBE(_mm_unpackhi_epi16(hi, zero), vscale));
+        }
+    #endif
+
+        for (; j < width; ++j)
+        {
+            const uint8_t* sPtr = pSource + j * 4;
+            float* dPtr = pDestination + j * 4;
+
+            const int exponent = static_cast<int>(sPtr[3]) - (128 + 8);
+            dPtr[0] = scale * ldexpf(float(sPtr[0]) + 0.5f, exponent);
+            dPtr[1] = scale * ldexpf(float(sPtr[1]) + 0.5f, exponent);
+            dPtr[2] = scale * ldexpf(float(sPtr[2]) + 0.5f, exponent);
+            dPtr[3] = 1.f;
         }
     }
 
     //-------------------------------------------------------------------------------------
-    // HalfToRGBE
+    // FloatToRGBE
     //-------------------------------------------------------------------------------------
-    inline void HalfToRGBE(_Out_writes_(width * 4) uint8_t* pDestination, _In_reads_(width* fpp) const uint16_t* pSource, size_t width, _In_range_(3, 4) int fpp) noexcept
+    void FloatToRGBE(_Out_writes_(width*4) uint8_t* pDestination, _In_reads_(width*fpp) const float* pSource, size_t width, _In_range_(3, 4) int fpp) noexcept
     {
         auto ePtr = pSource + width * size_t(fpp);
 
-        for (size_t j = 0; j < width; ++j)
+        size_t j = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i byteMask = _mm_set1_epi32(0xff);
+        const __m128i expBias = _mm_set1_epi32(127 + 134);
+        const XMVECTOR threshold = _mm_set1_ps(1e-32f);
+
+        for (; j + 4 <= width; j += 4)
+        {
+            XMVECTOR p0, p1, p2, p3;
+            if (fpp == 4)
+            {
+                p0 = _mm_loadu_ps(pSource);
+                p1 = _mm_loadu_ps(pSource + 4);
+                p2 = _mm_loadu_ps(pSource + 8);
+                p3 = _mm_loadu_ps(pSource + 12);
+            }
+            else
+            {
+                p0 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(pSource));
+                p1 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(pSource + 3));
+                p2 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(pSource + 6));
+                p3 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(pSource + 9));
+            }
+            pSource += size_t(fpp) * 4;
+
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+            // Negative values and NaNs clamp to zero
+            const XMVECTOR r = _mm_max_ps(p0, g_XMZero);
+            const XMVECTOR g = _mm_max_ps(p1, g_XMZero);
+            const XMVECTOR b = _mm_max_ps(p2, g_XMZero);
+            const XMVECTOR maxrgb = _mm_max_ps(_mm_max_ps(r, g), b);
+
+            // Scale by 2^(8 - frexp exponent) which is exact, so this matches the scalar path
+            const __m128i e = _mm_srli_epi32(_mm_castps_si128(maxrgb), 23);
+            const XMVECTOR scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(expBias, e), 23));
+            const __m128i valid = _mm_castps_si128(_mm_cmpgt_ps(maxrgb, threshold));
+
+            const __m128i red = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(r, scale)), valid);
+            const __m128i green = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(g, scale)), valid);
+            const __m128i blue = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(b, scale)), valid);
+
+            const __m128i black = _mm_cmpeq_epi32(_mm_or_si128(_mm_or_si128(red, green), blue), zero);
+            const __m128i exponent = _mm_andnot_si128(black, _mm_and_si128(_mm_add_epi32(e, _mm_set1_epi32(2)), byteMask));
+
+            __m128i rgbe = _mm_or_si128(red, _mm_slli_epi32(green, 8));
+            rgbe = _mm_or_si128(rgbe, _mm_slli_epi32(blue, 16));
+            rgbe = _mm_or_si128(rgbe, _mm_slli_epi32(exponent, 24));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), rgbe);
+            pDestination += 16;
+        }
+    #endif
+
+        for (; j < width; ++j)
         {
             if (pSource + 2 >= ePtr) break;
-            float r = PackedVector::XMConvertHalfToFloat(pSource[0]); r = (r >= 0.f) ? r : 0.f;
-            float g = PackedVector::XMConvertHalfToFloat(pSource[1]); g = (g >= 0.f) ? g : 0.f;
-            float b = PackedVector::XMConvertHalfToFloat(pSource[2]); b = (b >= 0.f) ? b : 0.f;
+            const float r = pSource[0] >= 0.f ? pSource[0] : 0.f;
+            const float g = pSource[1] >= 0.f ? pSource[1] : 0.f;
+            const float b = pSource[2] >= 0.f ? pSource[2] : 0.f;
             pSource += fpp;
 
             const float max_xy = (r > g) ? r : g;
@@ -388,6 +587,29 @@ namespace
         }
     }
 
+    //-------------------------------------------------------------------------------------
+    // HalfToRGBE
+    //-------------------------------------------------------------------------------------
+    void HalfToRGBE(_Out_writes_(width * 4) uint8_t* pDestination, _In_reads_(width* fpp) const uint16_t* pSource, size_t width, _In_range_(3, 4) int fpp) noexcept
+    {
+        // Expand in small batches and share the float encoder
+        constexpr size_t c_BatchPixels = 64;
+        float temp[c_BatchPixels * 4];
+
+        while (width > 0)
+        {
+            const size_t count = std::min(width, c_BatchPixels);
+            const size_t halfs = count * size_t(fpp);
+
+            PackedVector::XMConvertHalfToFloatStream(temp, sizeof(float), pSource, sizeof(uint16_t), halfs);
+            FloatToRGBE(pDestination, temp, count, fpp);
+
+            pSource += halfs;
+            pDestination += count * 4;
+            width -= count;
+        }
+    }
+
     //-------------------------------------------------------------------------------------
     // Encode using Adapative RLE
     //-------------------------------------------------------------------------------------
@@ -678,7 +900,7 @@ HRESULT DirectX::GetMetadataFromHDRFile(const wchar_t* szFile, TexMetadata& meta
 // Load a HDR file in memory
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata* metadata, ScratchImage& image) noexcept
+HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, HDR_FLAGS flags, TexMetadata* metadata, ScratchImage& image) noexcept
 {
     if (!pSource || size == 0)
         return E_INVALIDARG;
@@ -706,8 +928,6 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
     // Copy pixels
     auto sourcePtr = static_cast<const uint8_t*>(pSource) + offset;
 
-    size_t pixelLen = remaining;
-
     const Image* img = image.GetImage(0, 0, 0);
     if (!img)
     {
@@ -715,172 +935,89 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
         return E_POINTER;
     }
 
-    auto destPtr = img->pixels;
-
 #ifdef _DEBUG
     memset(img->pixels, 0xFF, img->rowPitch * img->height);
 #endif
 
-    for (size_t scan = 0; scan < mdata.height; ++scan)
+    const size_t rgbeRowBytes = mdata.width * 4;
+
+    if ((flags & HDR_FLAGS_PARALLEL) && mdata.height > 1)
     {
-        if (pixelLen < 4)
+        // Scanlines are variable length, so first find where each one starts
+        std::unique_ptr<size_t[]> offsets(new (std::nothrow) size_t[mdata.height]);
+        if (!offsets)
         {
             image.Release();
-            return E_FAIL;
+            return E_OUTOFMEMORY;
         }
 
-        uint8_t inColor[4];
-        memcpy(inColor, sourcePtr, 4);
-        sourcePtr += 4;
-        pixelLen -= 4;
-
-        auto scanLine = reinterpret_cast<float*>(destPtr);
-
-        if (inColor[0] == 2 && inColor[1] == 2 && inColor[2] < 128)
+        size_t pos = 0;
+        for (size_t scan = 0; scan < mdata.height; ++scan)
         {
-            // Adaptive Run Length Encoding (RLE)
-            if (size_t((size_t(inColor[2]) << 8) + inColor[3]) != mdata.width)
+            offsets[scan] = pos;
+
+            const size_t used = DecodeScanline(nullptr, sourcePtr + pos, remaining - pos, mdata.width);
+            if (!used)
             {
                 image.Release();
                 return E_FAIL;
             }
+            pos += used;
+        }
 
-            for (int channel = 0; channel < 4; ++channel)
-            {
-                auto pixelLoc = scanLine + channel;
-                for (size_t pixelCount = 0; pixelCount < mdata.width;)
-                {
-                    if (pixelLen < 2)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
+        // Then decode the scanlines independently
+        const size_t workers = Internal::GetWorkerCount(0, mdata.height);
 
-                    assert(sourcePtr < (reinterpret_cast<const uint8_t*>(pSource) + size));
+        std::unique_ptr<uint8_t[]> rgbe(new (std::nothrow) uint8_t[rgbeRowBytes * workers]);
+        if (!rgbe)
+        {
+            image.Release();
+            return E_OUTOFMEMORY;
+        }
 
-                    uint8_t runLen = *sourcePtr;
-                    if (runLen > 128)
-                    {
-                        runLen &= 127;
-                        if (pixelCount + runLen > mdata.width)
-                        {
-                            image.Release();
-                            return E_FAIL;
-                        }
+        hr = Internal::ParallelFor(mdata.height, workers,
+            [&](size_t scan, size_t worker) noexcept -> bool
+            {
+                uint8_t* rgbeRow = rgbe.get() + rgbeRowBytes * worker;
+                if (!DecodeScanline(rgbeRow, sourcePtr + offsets[scan], remaining - offsets[scan], mdata.width))
+                    return false;
 
-                        auto val = static_cast<float>(sourcePtr[1]);
-                        for (uint8_t j = 0; j < runLen; ++j)
-                        {
-                            *pixelLoc = val;
-                            pixelLoc += 4;
-                        }
-                        pixelCount += runLen;
-                        sourcePtr += 2;
-                        pixelLen -= 2;
-                    }
-                    else if ((size < size_t(runLen) + 1) || ((pixelCount + size_t(runLen)) > mdata.width))
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-                    else
-                    {
-                        ++sourcePtr;
-                        for (uint8_t j = 0; j < runLen; ++j)
-                        {
-                            auto val = static_cast<float>(*sourcePtr++);
-                            *pixelLoc = val;
-                            pixelLoc += 4;
-                        }
-                        pixelCount += runLen;
-                        pixelLen -= size_t(runLen) + 1;
-                    }
-                }
-            }
+                RGBEToFloat(reinterpret_cast<float*>(img->pixels + img->rowPitch * scan), rgbeRow, mdata.width, exposure);
+                return true;
+            });
+        if (FAILED(hr))
+        {
+            image.Release();
+            return hr;
         }
-        else
+    }
+    else
+    {
+        std::unique_ptr<uint8_t[]> rgbe(new (std::nothrow) uint8_t[rgbeRowBytes]);
+        if (!rgbe)
         {
-            auto pixelLoc = scanLine;
+            image.Release();
+            return E_OUTOFMEMORY;
+        }
 
-            float prevColor[4];
-            prevColor[0] = inColor[0];
-            prevColor[1] = inColor[1];
-            prevColor[2] = inColor[2];
-            prevColor[3] = inColor[3];
+        size_t pixelLen = remaining;
+        auto destPtr = img->pixels;
 
-            int bitShift = 0;
-            for (size_t pixelCount = 0; pixelCount < mdata.width;)
+        for (size_t scan = 0; scan < mdata.height; ++scan)
+        {
+            const size_t used = DecodeScanline(rgbe.get(), sourcePtr, pixelLen, mdata.width);
+            if (!used)
             {
-                if (inColor[0] == 1 && inColor[1] == 1 && inColor[2] == 1)
-                {
-                    if (bitShift > 24)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    // "Standard" Run Length Encoding
-                    const size_t spanLen = size_t(inColor[3]) << bitShift;
-                    if (spanLen + pixelCount > mdata.width)
-                    {
-                        image.Release();
-                        return E_FAIL;
-                    }
-
-                    for (size_t j = 0; j < spanLen; ++j)
-                    {
-                        pixelLoc[0] = prevColor[0];
-                        pixelLoc[1] = prevColor[1];
-                        pixelLoc[2] = prevColor[2];
-                        pixelLoc[3] = prevColor[3];
-                        pixelLoc += 4;
-                    }
-                    pixelCount += spanLen;
-                    bitShift += 8;
-                }
-                else
-                {
-                    // Uncompressed
-                    pixelLoc[0] = prevColor[0] = inColor[0];
-                    pixelLoc[1] = prevColor[1] = inColor[1];
-                    pixelLoc[2] = prevColor[2] = inColor[2];
-                    pixelLoc[3] = prevColor[3] = inColor[3];
-                    bitShift = 0;
-                    ++pixelCount;
-                    pixelLoc += 4;
-                }
-
-                if (pixelCount >= mdata.width)
-                    break;
-
-                if (pixelLen < 4)
-                {
-                    image.Release();
-                    return E_FAIL;
-                }
-
-                memcpy(inColor, sourcePtr, 4);
-                sourcePtr += 4;
-                pixelLen -= 4;
+                image.Release();
+                return E_FAIL;
             }
-        }
 
-        destPtr += img->rowPitch;
-    }
+            sourcePtr += used;
+            pixelLen -= used;
 
-    // Transform values
-    {
-        auto fdata = reinterpret_cast<float*>(image.GetPixels());
-
-        for (size_t j = 0; j < image.GetPixelsSize(); j += 16)
-        {
-            auto const exponent = static_cast<int>(fdata[3]);
-            fdata[0] = 1.0f / exposure*ldexpf((fdata[0] + 0.5f), exponent - (128 + 8));
-            fdata[1] = 1.0f / exposure*ldexpf((fdata[1] + 0.5f), exponent - (128 + 8));
-            fdata[2] = 1.0f / exposure*ldexpf((fdata[2] + 0.5f), exponent - (128 + 8));
-            fdata[3] = 1.f;
+            RGBEToFloat(reinterpret_cast<float*>(destPtr), rgbe.get(), mdata.width, exposure);
 
-            fdata += 4;
+            destPtr += img->rowPitch;
         }
     }
 
@@ -895,7 +1032,7 @@ HRESULT DirectX::LoadFromHDRMemory(const void* pSource, size_t size, TexMetadata
 // Load a HDR file from disk
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, ScratchImage& image) noexcept
+HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, HDR_FLAGS flags, TexMetadata* metadata, ScratchImage& image) noexcept
 {
     if (!szFile)
         return E_INVALIDARG;
@@ -977,7 +1114,7 @@ HRESULT DirectX::LoadFromHDRFile(const wchar_t* szFile, TexMetadata* metadata, S
         return E_FAIL;
 #endif
 
-    return LoadFromHDRMemory(temp.get(), len, metadata, image);
+    return LoadFromHDRMemory(temp.get(), len, flags, metadata, image);
 }
 
 
@@ -14,19 +14,6 @@
 using namespace DirectX;
 using namespace DirectX::Internal;
 
-#ifndef _WIN32
-namespace
-{
-    inline void * _aligned_malloc(size_t size, size_t alignment)
-    {
-        size = (size + alignment - 1) & ~(alignment - 1);
-        return std::aligned_alloc(alignment, size);
-    }
-
-#define _aligned_free free
-}
-#endif
-
 //-------------------------------------------------------------------------------------
 // Determines number of image array entries and pixel size
 //-------------------------------------------------------------------------------------
@@ -277,6 +264,7 @@ ScratchImage& ScratchImage::operator= (ScratchImage&& moveFrom) noexcept
         m_metadata = moveFrom.m_metadata;
         m_image = moveFrom.m_image;
         m_memory = moveFrom.m_memory;
+        m_allocator = moveFrom.m_allocator;
 
         moveFrom.m_nimages = 0;
         moveFrom.m_size = 0;
@@ -361,7 +349,7 @@ HRESULT ScratchImage::Initialize(const TexMetadata& mdata, CP_FLAGS flags) noexc
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    m_memory = static_cast<uint8_t*>(m_allocator->Allocate(pixelSize));
     if (!m_memory)
     {
         Release();
@@ -431,7 +419,7 @@ HRESULT ScratchImage::Initialize2D(DXGI_FORMAT fmt, size_t width, size_t height,
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    m_memory = static_cast<uint8_t*>(m_allocator->Allocate(pixelSize));
     if (!m_memory)
     {
         Release();
@@ -487,7 +475,7 @@ HRESULT ScratchImage::Initialize3D(DXGI_FORMAT fmt, size_t width, size_t height,
     m_nimages = nimages;
     memset(m_image, 0, sizeof(Image) * nimages);
 
-    m_memory = static_cast<uint8_t*>(_aligned_malloc(pixelSize, 16));
+    m_memory = static_cast<uint8_t*>(m_allocator->Allocate(pixelSize));
     if (!m_memory)
     {
         Release();
@@ -696,9 +684,6 @@ HRESULT ScratchImage::Initialize3DFromImages(const Image* images, size_t depth,
 
 void ScratchImage::Release() noexcept
 {
-    m_nimages = 0;
-    m_size = 0;
-
     if (m_image)
     {
         delete[] m_image;
@@ -707,10 +692,13 @@ void ScratchImage::Release() noexcept
 
     if (m_memory)
     {
-        _aligned_free(m_memory);
+        m_allocator->Free(m_memory, m_size);
         m_memory = nullptr;
     }
 
+    m_nimages = 0;
+    m_size = 0;
+
     memset(&m_metadata, 0, sizeof(m_metadata));
 }
 
@@ -684,7 +684,9 @@ namespace
             break;
 
         case TEX_FILTER_TRIANGLE:
-            // WIC does not implement this filter
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            // WIC does not implement these filters
             return false;
 
         default:
@@ -1603,6 +1605,77 @@ namespace
     }
 
 
+    //--- 2D per-item generators over all items (concurrently with TEX_FILTER_PARALLEL) ---
+    template<typename Generate>
+    HRESULT Generate2DMipsForEachItem(size_t items, TEX_FILTER_FLAGS filter, Generate generate) noexcept
+    {
+        std::unique_ptr<HRESULT[]> results(new (std::nothrow) HRESULT[items]);
+        if (!results)
+            return E_OUTOFMEMORY;
+
+        for (size_t item = 0; item < items; ++item)
+        {
+            results[item] = S_OK;
+        }
+
+        const HRESULT hr = ParallelFor(items, (filter & TEX_FILTER_PARALLEL) ? 0 : 1, [&](size_t item, size_t) noexcept -> bool
+            {
+                results[item] = generate(item);
+                return SUCCEEDED(results[item]);
+            });
+
+        for (size_t item = 0; item < items; ++item)
+        {
+            if (FAILED(results[item]))
+                return results[item];
+        }
+
+        return hr;
+    }
+
+
+    //--- 2D Separable Filters (Linear, Cubic, Triangle, Lanczos3, Mitchell; all items at once) ---
+    HRESULT Generate2DMipsSeparableFilter(size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        if (!mipChain.GetImages())
+            return E_INVALIDARG;
+
+        // This assumes that the base image is already placed into the mipChain at the top level... (see _Setup2DMips)
+
+        assert(levels > 1);
+
+        const size_t items = mipChain.GetMetadata().arraySize;
+
+        std::unique_ptr<Image[]> images(new (std::nothrow) Image[items * 2]);
+        if (!images)
+            return E_OUTOFMEMORY;
+
+        Image* srcImages = images.get();
+        Image* destImages = images.get() + items;
+
+        for (size_t level = 1; level < levels; ++level)
+        {
+            for (size_t item = 0; item < items; ++item)
+            {
+                const Image* src = mipChain.GetImage(level - 1, item, 0);
+                const Image* dest = mipChain.GetImage(level, item, 0);
+                if (!src || !dest)
+                    return E_POINTER;
+
+                srcImages[item] = *src;
+                destImages[item] = *dest;
+            }
+
+            // Every item of a level is independent, so they are all filtered in one pass
+            const HRESULT hr = ResizeSeparableFilter(srcImages, items, destImages, items, false, filter);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+
     //-------------------------------------------------------------------------------------
     // Generate volume mip-map helpers
     //-------------------------------------------------------------------------------------
@@ -1660,6 +1733,56 @@ namespace
     }
 
 
+    //--- 3D Separable Filters (Linear, Cubic, Triangle, Lanczos3, Mitchell) ---
+    HRESULT Generate3DMipsSeparableFilter(size_t depth, size_t levels, TEX_FILTER_FLAGS filter, const ScratchImage& mipChain) noexcept
+    {
+        if (!depth || !mipChain.GetImages())
+            return E_INVALIDARG;
+
+        // This assumes that the base images are already placed into the mipChain at the top level... (see _Setup3DMips)
+
+        assert(levels > 1);
+
+        std::unique_ptr<Image[]> images(new (std::nothrow) Image[depth * 2]);
+        if (!images)
+            return E_OUTOFMEMORY;
+
+        Image* srcImages = images.get();
+        Image* destImages = images.get() + depth;
+
+        for (size_t level = 1; level < levels; ++level)
+        {
+            const size_t ndepth = (depth > 1) ? (depth >> 1) : 1;
+
+            for (size_t slice = 0; slice < depth; ++slice)
+            {
+                const Image* src = mipChain.GetImage(level - 1, 0, slice);
+                if (!src)
+                    return E_POINTER;
+
+                srcImages[slice] = *src;
+            }
+
+            for (size_t slice = 0; slice < ndepth; ++slice)
+            {
+                const Image* dest = mipChain.GetImage(level, 0, slice);
+                if (!dest)
+                    return E_POINTER;
+
+                destImages[slice] = *dest;
+            }
+
+            const HRESULT hr = ResizeSeparableFilter(srcImages, depth, destImages, ndepth, true, filter);
+            if (FAILED(hr))
+                return hr;
+
+            depth = ndepth;
+        }
+
+        return S_OK;
+    }
+
+
     //--- 3D Point Filter ---
     HRESULT Generate3DMipsPointFilter(size_t depth, size_t levels, const ScratchImage& mipChain) noexcept
     {
@@ -2941,6 +3064,19 @@ HRESULT DirectX::GenerateMipMaps(
             filter_select = (ispow2(baseImage.width) && ispow2(baseImage.height)) ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
         }
 
+        if ((filter & TEX_FILTER_PARALLEL) && (filter_select != TEX_FILTER_BOX) && (filter_select != TEX_FILTER_POINT))
+        {
+            // The multithreaded separable filter engine gives the same results as the serial generators
+            hr = Setup2DMips(&baseImage, 1, mdata, mipChain);
+            if (FAILED(hr))
+                return hr;
+
+            hr = Generate2DMipsSeparableFilter(levels, static_cast<TEX_FILTER_FLAGS>((filter & ~TEX_FILTER_MODE_MASK) | filter_select), mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
+            return hr;
+        }
+
         switch (filter_select)
         {
         case TEX_FILTER_BOX:
@@ -2993,6 +3129,17 @@ HRESULT DirectX::GenerateMipMaps(
                 mipChain.Release();
             return hr;
 
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            hr = Setup2DMips(&baseImage, 1, mdata, mipChain);
+            if (FAILED(hr))
+                return hr;
+
+            hr = Generate2DMipsSeparableFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
+            return hr;
+
         default:
             return HRESULT_E_NOT_SUPPORTED;
         }
@@ -3156,6 +3303,19 @@ HRESULT DirectX::GenerateMipMaps(
             filter_select = (ispow2(metadata.width) && ispow2(metadata.height)) ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
         }
 
+        if ((filter & TEX_FILTER_PARALLEL) && (filter_select != TEX_FILTER_BOX) && (filter_select != TEX_FILTER_POINT))
+        {
+            // The multithreaded separable filter engine gives the same results as the serial generators
+            hr = Setup2DMips(&baseImages[0], metadata.arraySize, mdata2, mipChain);
+            if (FAILED(hr))
+                return hr;
+
+            hr = Generate2DMipsSeparableFilter(levels, static_cast<TEX_FILTER_FLAGS>((filter & ~TEX_FILTER_MODE_MASK) | filter_select), mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
+            return hr;
+        }
+
         switch (filter_select)
         {
         case TEX_FILTER_BOX:
@@ -3163,12 +3323,12 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsBoxFilter(levels, filter, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsForEachItem(metadata.arraySize, filter, [&](size_t item) noexcept
+                {
+                    return Generate2DMipsBoxFilter(levels, filter, mipChain, item);
+                });
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         case TEX_FILTER_POINT:
@@ -3176,12 +3336,12 @@ HRESULT DirectX::GenerateMipMaps(
             if (FAILED(hr))
                 return hr;
 
-            for (size_t item = 0; item < metadata.arraySize; ++item)
-            {
-                hr = Generate2DMipsPointFilter(levels, mipChain, item);
-                if (FAILED(hr))
-                    mipChain.Release();
-            }
+            hr = Generate2DMipsForEachItem(metadata.arraySize, filter, [&](size_t item) noexcept
+                {
+                    return Generate2DMipsPointFilter(levels, mipChain, item);
+                });
+            if (FAILED(hr))
+                mipChain.Release();
             return hr;
 
         case TEX_FILTER_LINEAR:
@@ -3223,6 +3383,17 @@ HRESULT DirectX::GenerateMipMaps(
             }
             return hr;
 
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            hr = Setup2DMips(&baseImages[0], metadata.arraySize, mdata2, mipChain);
+            if (FAILED(hr))
+                return hr;
+
+            hr = Generate2DMipsSeparableFilter(levels, filter, mipChain);
+            if (FAILED(hr))
+                mipChain.Release();
+            return hr;
+
         default:
             return HRESULT_E_NOT_SUPPORTED;
         }
@@ -3283,6 +3454,19 @@ HRESULT DirectX::GenerateMipMaps3D(
         filter_select = (ispow2(width) && ispow2(height) && ispow2(depth)) ? TEX_FILTER_BOX : TEX_FILTER_TRIANGLE;
     }
 
+    if ((filter & TEX_FILTER_PARALLEL) && (filter_select != TEX_FILTER_BOX) && (filter_select != TEX_FILTER_POINT))
+    {
+        // The multithreaded separable filter engine gives the same results as the serial generators
+        hr = Setup3DMips(baseImages, depth, levels, mipChain);
+        if (FAILED(hr))
+            return hr;
+
+        hr = Generate3DMipsSeparableFilter(depth, levels, static_cast<TEX_FILTER_FLAGS>((filter & ~TEX_FILTER_MODE_MASK) | filter_select), mipChain);
+        if (FAILED(hr))
+            mipChain.Release();
+        return hr;
+    }
+
     switch (filter_select)
     {
     case TEX_FILTER_BOX:
@@ -3335,6 +3519,17 @@ HRESULT DirectX::GenerateMipMaps3D(
             mipChain.Release();
         return hr;
 
+    case TEX_FILTER_LANCZOS3:
+    case TEX_FILTER_MITCHELL:
+        hr = Setup3DMips(baseImages, depth, levels, mipChain);
+        if (FAILED(hr))
+            return hr;
+
+        hr = Generate3DMipsSeparableFilter(depth, levels, filter, mipChain);
+        if (FAILED(hr))
+            mipChain.Release();
+        return hr;
+
     default:
         return HRESULT_E_NOT_SUPPORTED;
     }
@@ -3399,6 +3594,19 @@ HRESULT DirectX::GenerateMipMaps3D(
         filter_select = (ispow2(metadata.width) && ispow2(metadata.height) && ispow2(metadata.depth)) ? TEX_FILTER_BOX : TEX_FILTER_TRIANGLE;
     }
 
+    if ((filter & TEX_FILTER_PARALLEL) && (filter_select != TEX_FILTER_BOX) && (filter_select != TEX_FILTER_POINT))
+    {
+        // The multithreaded separable filter engine gives the same results as the serial generators
+        hr = Setup3DMips(&baseImages[0], metadata.depth, levels, mipChain);
+        if (FAILED(hr))
+            return hr;
+
+        hr = Generate3DMipsSeparableFilter(metadata.depth, levels, static_cast<TEX_FILTER_FLAGS>((filter & ~TEX_FILTER_MODE_MASK) | filter_select), mipChain);
+        if (FAILED(hr))
+            mipChain.Release();
+        return hr;
+    }
+
     switch (filter_select)
     {
     case TEX_FILTER_BOX:
@@ -3451,6 +3659,17 @@ HRESULT DirectX::GenerateMipMaps3D(
             mipChain.Release();
         return hr;
 
+    case TEX_FILTER_LANCZOS3:
+    case TEX_FILTER_MITCHELL:
+        hr = Setup3DMips(&baseImages[0], metadata.depth, levels, mipChain);
+        if (FAILED(hr))
+            return hr;
+
+        hr = Generate3DMipsSeparableFilter(metadata.depth, levels, filter, mipChain);
+        if (FAILED(hr))
+            mipChain.Release();
+        return hr;
+
     default:
         return HRESULT_E_NOT_SUPPORTED;
     }
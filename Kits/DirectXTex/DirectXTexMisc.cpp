@@ -11,6 +11,9 @@
 
 #include "DirectXTexP.h"
 
+#include <cmath>
+#include <limits>
+
 using namespace DirectX;
 using namespace DirectX::Internal;
 
@@ -23,59 +26,138 @@ namespace
 {
     const XMVECTORF32 g_Gamma22 = { { { 2.2f, 2.2f, 2.2f, 1.f } } };
 
+    // Images are split into bands of rows which are the unit of work for multithreading. Bands
+    // are a fixed size (and a multiple of the SSIM window) so results don't depend on thread count.
+    constexpr size_t ROWS_PER_BAND = 32;
+    constexpr size_t SSIM_WINDOW = 8;
+
+    static_assert((ROWS_PER_BAND % SSIM_WINDOW) == 0, "Bands must contain whole SSIM windows");
+
+    // SSIM stabilization constants for a dynamic range of 1.0
+    const XMVECTORF32 g_SSIM_C1 = { { { 0.0001f, 0.0001f, 0.0001f, 0.0001f } } };
+    const XMVECTORF32 g_SSIM_C2 = { { { 0.0009f, 0.0009f, 0.0009f, 0.0009f } } };
+
     //-------------------------------------------------------------------------------------
-    HRESULT ComputeMSE_(
-        const Image& image1,
-        const Image& image2,
-        float& mse,
-        _Out_writes_opt_(4) float* mseV,
-        CMSE_FLAGS flags) noexcept
+    // Runs the bands in order on the calling thread, or on the task scheduler if parallel
+    //-------------------------------------------------------------------------------------
+    template<typename TBand>
+    HRESULT ProcessBands(size_t bandCount, bool parallel, TBand&& band)
     {
-        if (!image1.pixels || !image2.pixels)
-            return E_POINTER;
+        if (!parallel)
+        {
+            // Keeps the original single-threaded callback order and exception behavior
+            for (size_t index = 0; index < bandCount; ++index)
+            {
+                if (!band(index, 0))
+                    return E_FAIL;
+            }
 
-        assert(image1.width == image2.width && image1.height == image2.height);
-        assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
+            return S_OK;
+        }
 
-        const size_t width = image1.width;
+        return ParallelFor(bandCount, 0, [&](size_t task, size_t worker) noexcept -> bool
+        {
+            return band(task, worker);
+        });
+    }
 
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+    inline size_t BandCount(const Image& image) noexcept
+    {
+        return (image.height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+    }
 
-        // Flags implied from image formats
-        switch (image1.format)
+    //-------------------------------------------------------------------------------------
+    // Validates the images and builds the prefix table used to map a band to its image
+    //-------------------------------------------------------------------------------------
+    HRESULT SetupImageBands(
+        _In_reads_(nimages) const Image* images,
+        size_t nimages,
+        const TexMetadata& metadata,
+        DXGI_FORMAT format,
+        std::unique_ptr<size_t[]>& firstBand,
+        size_t& count,
+        size_t& maxWidth) noexcept
+    {
+        // For volumes, images are ordered by level then slice, so the whole chain is the same walk
+        count = 0;
+        switch (metadata.dimension)
         {
-        case DXGI_FORMAT_B8G8R8X8_UNORM:
-            flags |= CMSE_IGNORE_ALPHA;
+        case TEX_DIMENSION_TEXTURE1D:
+        case TEX_DIMENSION_TEXTURE2D:
+            count = nimages;
             break;
 
-        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            flags |= CMSE_IMAGE1_SRGB | CMSE_IGNORE_ALPHA;
-            break;
+        case TEX_DIMENSION_TEXTURE3D:
+            {
+                size_t d = metadata.depth;
+                for (size_t level = 0; level < metadata.mipLevels; ++level)
+                {
+                    count += d;
 
-        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
-        case DXGI_FORMAT_BC1_UNORM_SRGB:
-        case DXGI_FORMAT_BC2_UNORM_SRGB:
-        case DXGI_FORMAT_BC3_UNORM_SRGB:
-        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
-        case DXGI_FORMAT_BC7_UNORM_SRGB:
-            flags |= CMSE_IMAGE1_SRGB;
+                    if (d > 1)
+                        d >>= 1;
+                }
+
+                if (count > nimages)
+                    return E_FAIL;
+            }
             break;
 
         default:
-            break;
+            return E_FAIL;
         }
 
-        switch (image2.format)
+        firstBand.reset(new (std::nothrow) size_t[count + 1]);
+        if (!firstBand)
+            return E_OUTOFMEMORY;
+
+        maxWidth = 0;
+        size_t bands = 0;
+        for (size_t index = 0; index < count; ++index)
+        {
+            const Image& img = images[index];
+            if (img.format != format)
+                return E_FAIL;
+
+            if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
+                return E_FAIL;
+
+            if (!img.pixels)
+                return E_POINTER;
+
+            firstBand[index] = bands;
+            bands += BandCount(img);
+            maxWidth = std::max(maxWidth, img.width);
+        }
+        firstBand[count] = bands;
+
+        return S_OK;
+    }
+
+    inline size_t FindBandImage(const size_t* firstBand, size_t count, size_t band) noexcept
+    {
+        // The first image whose range starts after the band, less one (skips empty images)
+        auto it = std::upper_bound(firstBand, firstBand + count + 1, band);
+        return static_cast<size_t>(it - firstBand) - 1;
+    }
+
+    //-------------------------------------------------------------------------------------
+    struct CompareBand
+    {
+        XMFLOAT4    sqError;
+        XMFLOAT4    ssim;
+        size_t      windows;
+    };
+
+    CMSE_FLAGS GetImpliedFlags(DXGI_FORMAT format, CMSE_FLAGS srgbFlag) noexcept
+    {
+        switch (format)
         {
         case DXGI_FORMAT_B8G8R8X8_UNORM:
-            flags |= CMSE_IGNORE_ALPHA;
-            break;
+            return CMSE_IGNORE_ALPHA;
 
         case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
-            flags |= CMSE_IMAGE2_SRGB | CMSE_IGNORE_ALPHA;
-            break;
+            return srgbFlag | CMSE_IGNORE_ALPHA;
 
         case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
         case DXGI_FORMAT_BC1_UNORM_SRGB:
@@ -83,185 +165,284 @@ namespace
         case DXGI_FORMAT_BC3_UNORM_SRGB:
         case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
         case DXGI_FORMAT_BC7_UNORM_SRGB:
-            flags |= CMSE_IMAGE2_SRGB;
-            break;
+            return srgbFlag;
 
         default:
-            break;
+            return CMSE_DEFAULT;
         }
+    }
 
-        const uint8_t *pSrc1 = image1.pixels;
-        const size_t rowPitch1 = image1.rowPitch;
+    //-------------------------------------------------------------------------------------
+    // Computes the per-channel MSE, and optionally the per-channel mean SSIM over 8x8 windows
+    //-------------------------------------------------------------------------------------
+    HRESULT ComputeMSE_(
+        const Image& image1,
+        const Image& image2,
+        CMSE_FLAGS flags,
+        XMFLOAT4& mseV,
+        _Out_opt_ XMFLOAT4* ssimV) noexcept
+    {
+        if (!image1.pixels || !image2.pixels)
+            return E_POINTER;
 
-        const uint8_t *pSrc2 = image2.pixels;
-        const size_t rowPitch2 = image2.rowPitch;
+        assert(image1.width == image2.width && image1.height == image2.height);
+        assert(!IsCompressed(image1.format) && !IsCompressed(image2.format));
 
-        XMVECTOR acc = g_XMZero;
-        static XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+        const size_t width = image1.width;
+        const size_t height = image1.height;
 
-        for (size_t h = 0; h < image1.height; ++h)
-        {
-            XMVECTOR* ptr1 = scanline.get();
-            if (!LoadScanline(ptr1, width, pSrc1, rowPitch1, image1.format))
-                return E_FAIL;
+        // Flags implied from image formats
+        flags |= GetImpliedFlags(image1.format, CMSE_IMAGE1_SRGB);
+        flags |= GetImpliedFlags(image2.format, CMSE_IMAGE2_SRGB);
 
-            XMVECTOR* ptr2 = scanline.get() + width;
-            if (!LoadScanline(ptr2, width, pSrc2, rowPitch2, image2.format))
-                return E_FAIL;
+        const size_t bandCount = BandCount(image1);
+        const size_t windowsX = (width + SSIM_WINDOW - 1) / SSIM_WINDOW;
+
+        // Per worker: two scanlines plus the running sums (x, y, x^2, y^2, xy) for a row of SSIM windows
+        const uint64_t perWorker = uint64_t(width) * 2 + ((ssimV) ? uint64_t(windowsX) * 5 : 0);
+        const size_t workerCount = (flags & CMSE_PARALLEL) ? GetWorkerCount(0, bandCount) : 1;
+
+        auto scratch = make_AlignedArrayXMVECTOR(perWorker * workerCount);
+        if (!scratch)
+            return E_OUTOFMEMORY;
 
-            for (size_t i = 0; i < width; ++i)
+        std::unique_ptr<CompareBand[]> results(new (std::nothrow) CompareBand[bandCount]);
+        if (!results)
+            return E_OUTOFMEMORY;
+
+        static const XMVECTORF32 two = { { { 2.0f, 2.0f, 2.0f, 2.0f } } };
+
+        const HRESULT hr = ProcessBands(bandCount, (flags & CMSE_PARALLEL) != 0,
+            [&](size_t band, size_t worker) noexcept -> bool
             {
-                XMVECTOR v1 = *(ptr1++);
-                if (flags & CMSE_IMAGE1_SRGB)
-                {
-                    v1 = XMVectorPow(v1, g_Gamma22);
-                }
-                if (flags & CMSE_IMAGE1_X2_BIAS)
-                {
-                    v1 = XMVectorMultiplyAdd(v1, two, g_XMNegativeOne);
-                }
+                XMVECTOR* ptr1 = scratch.get() + perWorker * worker;
+                XMVECTOR* ptr2 = ptr1 + width;
+                XMVECTOR* stats = ptr2 + width;
 
-                XMVECTOR v2 = *(ptr2++);
-                if (flags & CMSE_IMAGE2_SRGB)
-                {
-                    v2 = XMVectorPow(v2, g_Gamma22);
-                }
-                if (flags & CMSE_IMAGE2_X2_BIAS)
-                {
-                    v2 = XMVectorMultiplyAdd(v2, two, g_XMNegativeOne);
-                }
+                const size_t y0 = band * ROWS_PER_BAND;
+                const size_t y1 = std::min(height, y0 + ROWS_PER_BAND);
 
-                // sum[ (I1 - I2)^2 ]
-                XMVECTOR v = XMVectorSubtract(v1, v2);
-                if (flags & CMSE_IGNORE_RED)
-                {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskX);
-                }
-                if (flags & CMSE_IGNORE_GREEN)
-                {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskY);
-                }
-                if (flags & CMSE_IGNORE_BLUE)
+                XMVECTOR acc = g_XMZero;
+                XMVECTOR ssimAcc = g_XMZero;
+                size_t windows = 0;
+
+                if (ssimV)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskZ);
+                    memset(stats, 0, sizeof(XMVECTOR) * windowsX * 5);
                 }
-                if (flags & CMSE_IGNORE_ALPHA)
+
+                for (size_t y = y0; y < y1; ++y)
                 {
-                    v = XMVectorSelect(v, g_XMZero, g_XMMaskW);
-                }
+                    if (!LoadScanline(ptr1, width, image1.pixels + image1.rowPitch * y, image1.rowPitch, image1.format))
+                        return false;
 
-                acc = XMVectorMultiplyAdd(v, v, acc);
-            }
+                    if (!LoadScanline(ptr2, width, image2.pixels + image2.rowPitch * y, image2.rowPitch, image2.format))
+                        return false;
 
-            pSrc1 += rowPitch1;
-            pSrc2 += rowPitch2;
-        }
+                    for (size_t i = 0; i < width; ++i)
+                    {
+                        XMVECTOR v1 = ptr1[i];
+                        if (flags & CMSE_IMAGE1_SRGB)
+                        {
+                            v1 = XMVectorPow(v1, g_Gamma22);
+                        }
+                        if (flags & CMSE_IMAGE1_X2_BIAS)
+                        {
+                            v1 = XMVectorMultiplyAdd(v1, two, g_XMNegativeOne);
+                        }
+
+                        XMVECTOR v2 = ptr2[i];
+                        if (flags & CMSE_IMAGE2_SRGB)
+                        {
+                            v2 = XMVectorPow(v2, g_Gamma22);
+                        }
+                        if (flags & CMSE_IMAGE2_X2_BIAS)
+                        {
+                            v2 = XMVectorMultiplyAdd(v2, two, g_XMNegativeOne);
+                        }
+
+                        // sum[ (I1 - I2)^2 ]
+                        XMVECTOR v = XMVectorSubtract(v1, v2);
+                        if (flags & CMSE_IGNORE_RED)
+                        {
+                            v = XMVectorSelect(v, g_XMZero, g_XMMaskX);
+                        }
+                        if (flags & CMSE_IGNORE_GREEN)
+                        {
+                            v = XMVectorSelect(v, g_XMZero, g_XMMaskY);
+                        }
+                        if (flags & CMSE_IGNORE_BLUE)
+                        {
+                            v = XMVectorSelect(v, g_XMZero, g_XMMaskZ);
+                        }
+                        if (flags & CMSE_IGNORE_ALPHA)
+                        {
+                            v = XMVectorSelect(v, g_XMZero, g_XMMaskW);
+                        }
+
+                        acc = XMVectorMultiplyAdd(v, v, acc);
+
+                        if (ssimV)
+                        {
+                            XMVECTOR* s = stats + (i / SSIM_WINDOW) * 5;
+                            s[0] = XMVectorAdd(s[0], v1);
+                            s[1] = XMVectorAdd(s[1], v2);
+                            s[2] = XMVectorMultiplyAdd(v1, v1, s[2]);
+                            s[3] = XMVectorMultiplyAdd(v2, v2, s[3]);
+                            s[4] = XMVectorMultiplyAdd(v1, v2, s[4]);
+                        }
+                    }
 
-        // MSE = sum[ (I1 - I2)^2 ] / w*h
-        const XMVECTOR d = XMVectorReplicate(float(image1.width * image1.height));
-        const XMVECTOR v = XMVectorDivide(acc, d);
-        if (mseV)
-        {
-            XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(mseV), v);
-            mse = mseV[0] + mseV[1] + mseV[2] + mseV[3];
-        }
-        else
-        {
-            XMFLOAT4 _mseV;
-            XMStoreFloat4(&_mseV, v);
-            mse = _mseV.x + _mseV.y + _mseV.z + _mseV.w;
-        }
+                    // Close out the row of windows at each window boundary (or the bottom of the image)
+                    const size_t rows = (y % SSIM_WINDOW) + 1;
+                    if (ssimV && (rows == SSIM_WINDOW || y + 1 == height))
+                    {
+                        for (size_t wx = 0; wx < windowsX; ++wx)
+                        {
+                            XMVECTOR* s = stats + wx * 5;
 
-        return S_OK;
-    }
+                            const size_t cols = std::min(SSIM_WINDOW, width - wx * SSIM_WINDOW);
+                            const XMVECTOR n = XMVectorReplicate(1.f / float(cols * rows));
 
-    //-------------------------------------------------------------------------------------
-    HRESULT EvaluateImage_(
-        const Image& image,
-        const std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>& pixelFunc)
-    {
-        if (!pixelFunc)
-            return E_INVALIDARG;
+                            const XMVECTOR mx = XMVectorMultiply(s[0], n);
+                            const XMVECTOR my = XMVectorMultiply(s[1], n);
+                            const XMVECTOR vx = XMVectorNegativeMultiplySubtract(mx, mx, XMVectorMultiply(s[2], n));
+                            const XMVECTOR vy = XMVectorNegativeMultiplySubtract(my, my, XMVectorMultiply(s[3], n));
+                            const XMVECTOR cxy = XMVectorNegativeMultiplySubtract(mx, my, XMVectorMultiply(s[4], n));
 
-        if (!image.pixels)
-            return E_POINTER;
+                            // SSIM = ((2 mx my + C1)(2 cxy + C2)) / ((mx^2 + my^2 + C1)(vx + vy + C2))
+                            const XMVECTOR num = XMVectorMultiply(
+                                XMVectorMultiplyAdd(XMVectorMultiply(mx, my), two, g_SSIM_C1),
+                                XMVectorMultiplyAdd(cxy, two, g_SSIM_C2));
+                            const XMVECTOR den = XMVectorMultiply(
+                                XMVectorAdd(XMVectorMultiplyAdd(mx, mx, XMVectorMultiply(my, my)), g_SSIM_C1),
+                                XMVectorAdd(XMVectorAdd(vx, vy), g_SSIM_C2));
 
-        assert(!IsCompressed(image.format));
+                            ssimAcc = XMVectorAdd(ssimAcc, XMVectorDivide(num, den));
 
-        const size_t width = image.width;
+                            s[0] = s[1] = s[2] = s[3] = s[4] = g_XMZero;
+                        }
 
-        auto scanline = make_AlignedArrayXMVECTOR(width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+                        windows += windowsX;
+                    }
+                }
 
-        const uint8_t *pSrc = image.pixels;
-        const size_t rowPitch = image.rowPitch;
+                CompareBand& result = results[band];
+                XMStoreFloat4(&result.sqError, acc);
+                XMStoreFloat4(&result.ssim, ssimAcc);
+                result.windows = windows;
+                return true;
+            });
+        if (FAILED(hr))
+            return hr;
 
-        for (size_t h = 0; h < image.height; ++h)
+        // Reduce in band order so the result is identical regardless of scheduling
+        XMVECTOR acc = g_XMZero;
+        XMVECTOR ssimAcc = g_XMZero;
+        size_t windows = 0;
+        for (size_t band = 0; band < bandCount; ++band)
         {
-            if (!LoadScanline(scanline.get(), width, pSrc, rowPitch, image.format))
-                return E_FAIL;
+            acc = XMVectorAdd(acc, XMLoadFloat4(&results[band].sqError));
+            ssimAcc = XMVectorAdd(ssimAcc, XMLoadFloat4(&results[band].ssim));
+            windows += results[band].windows;
+        }
 
-            pixelFunc(scanline.get(), width, h);
+        // MSE = sum[ (I1 - I2)^2 ] / w*h
+        const XMVECTOR d = XMVectorReplicate(float(width * height));
+        XMStoreFloat4(&mseV, XMVectorDivide(acc, d));
 
-            pSrc += rowPitch;
+        if (ssimV)
+        {
+            XMStoreFloat4(ssimV, (windows > 0) ? XMVectorDivide(ssimAcc, XMVectorReplicate(float(windows))) : g_XMOne.v);
         }
 
         return S_OK;
     }
 
-
     //-------------------------------------------------------------------------------------
-    HRESULT TransformImage_(
-        const Image& srcImage,
-        const std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)>& pixelFunc,
-        const Image& destImage)
+    // Expands any compressed inputs and compares the images
+    //-------------------------------------------------------------------------------------
+    HRESULT CompareImages(
+        const Image& image1,
+        const Image& image2,
+        CMSE_FLAGS flags,
+        XMFLOAT4& mseV,
+        _Out_opt_ XMFLOAT4* ssimV) noexcept
     {
-        if (!pixelFunc)
-            return E_INVALIDARG;
-
-        if (!srcImage.pixels || !destImage.pixels)
+        if (!image1.pixels || !image2.pixels)
             return E_POINTER;
 
-        if (srcImage.width != destImage.width || srcImage.height != destImage.height || srcImage.format != destImage.format)
-            return E_FAIL;
+        if (image1.width != image2.width || image1.height != image2.height)
+            return E_INVALIDARG;
 
-        const size_t width = srcImage.width;
+        if (!IsValid(image1.format) || !IsValid(image2.format))
+            return E_INVALIDARG;
 
-        auto scanlines = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
-        if (!scanlines)
-            return E_OUTOFMEMORY;
+        if (IsPlanar(image1.format) || IsPlanar(image2.format)
+            || IsPalettized(image1.format) || IsPalettized(image2.format)
+            || IsTypeless(image1.format) || IsTypeless(image2.format))
+            return HRESULT_E_NOT_SUPPORTED;
 
-        XMVECTOR* sScanline = scanlines.get();
-        XMVECTOR* dScanline = scanlines.get() + width;
+        // Compressed inputs are expanded to RGBA32F before comparing
+        const TEX_DECOMPRESS_FLAGS decompress = (flags & CMSE_PARALLEL) ? TEX_DECOMPRESS_PARALLEL : TEX_DECOMPRESS_DEFAULT;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        const size_t spitch = srcImage.rowPitch;
+        ScratchImage temp1;
+        const Image* img1 = &image1;
+        if (IsCompressed(image1.format))
+        {
+            HRESULT hr = DecompressEx(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp1);
+            if (FAILED(hr))
+                return hr;
 
-        uint8_t *pDest = destImage.pixels;
-        const size_t dpitch = destImage.rowPitch;
+            img1 = temp1.GetImage(0, 0, 0);
+            if (!img1)
+                return E_POINTER;
+        }
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+        ScratchImage temp2;
+        const Image* img2 = &image2;
+        if (IsCompressed(image2.format))
         {
-            if (!LoadScanline(sScanline, width, pSrc, spitch, srcImage.format))
-                return E_FAIL;
+            HRESULT hr = DecompressEx(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp2);
+            if (FAILED(hr))
+                return hr;
 
-        #ifdef _DEBUG
-            memset(dScanline, 0xCD, sizeof(XMVECTOR)*width);
-        #endif
+            img2 = temp2.GetImage(0, 0, 0);
+            if (!img2)
+                return E_POINTER;
+        }
 
-            pixelFunc(dScanline, sScanline, width, h);
+        return ComputeMSE_(*img1, *img2, flags, mseV, ssimV);
+    }
 
-            if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, dScanline, width))
-                return E_FAIL;
+    //-------------------------------------------------------------------------------------
+    // Adapters from the std::function callbacks to the row drivers
+    //-------------------------------------------------------------------------------------
+    using EvaluateFunc = std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)>;
+    using TransformFunc = std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)>;
 
-            pSrc += spitch;
-            pDest += dpitch;
-        }
+    void __cdecl EvaluateThunk(_In_ void* context, _In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)
+    {
+        (*static_cast<const EvaluateFunc*>(context))(pixels, width, y);
+    }
 
-        return S_OK;
+    void __cdecl TransformThunk(_In_ void* context, _Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)
+    {
+        (*static_cast<const TransformFunc*>(context))(outPixels, inPixels, width, y);
     }
-};
+
+    TexMetadata GetImageMetadata(const Image& image) noexcept
+    {
+        TexMetadata mdata = {};
+        mdata.width = image.width;
+        mdata.height = image.height;
+        mdata.depth = mdata.arraySize = mdata.mipLevels = 1;
+        mdata.format = image.format;
+        mdata.dimension = TEX_DIMENSION_TEXTURE2D;
+        return mdata;
+    }
+}
+
 
 
 //=====================================================================================
@@ -392,79 +573,83 @@ HRESULT DirectX::ComputeMSE(
     float* mseV,
     CMSE_FLAGS flags) noexcept
 {
-    if (!image1.pixels || !image2.pixels)
-        return E_POINTER;
-
-    if (image1.width != image2.width || image1.height != image2.height)
-        return E_INVALIDARG;
+    XMFLOAT4 channels;
+    HRESULT hr = CompareImages(image1, image2, flags, channels, nullptr);
+    if (FAILED(hr))
+        return hr;
 
-    if (!IsValid(image1.format) || !IsValid(image2.format))
-        return E_INVALIDARG;
+    if (mseV)
+    {
+        mseV[0] = channels.x;
+        mseV[1] = channels.y;
+        mseV[2] = channels.z;
+        mseV[3] = channels.w;
+    }
 
-    if (IsPlanar(image1.format) || IsPlanar(image2.format)
-        || IsPalettized(image1.format) || IsPalettized(image2.format)
-        || IsTypeless(image1.format) || IsTypeless(image2.format))
-        return HRESULT_E_NOT_SUPPORTED;
+    mse = channels.x + channels.y + channels.z + channels.w;
 
-    if (IsCompressed(image1.format))
-    {
-        if (IsCompressed(image2.format))
-        {
-            // Case 1: both images are compressed, expand to RGBA32F
-            ScratchImage temp1;
-            HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, temp1);
-            if (FAILED(hr))
-                return hr;
+    return S_OK;
+}
 
-            ScratchImage temp2;
-            hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, temp2);
-            if (FAILED(hr))
-                return hr;
+_Use_decl_annotations_
+HRESULT DirectX::ComputeMSE(
+    const Image& image1,
+    const Image& image2,
+    ImageQualityMetrics& metrics,
+    CMSE_FLAGS flags) noexcept
+{
+    memset(&metrics, 0, sizeof(ImageQualityMetrics));
 
-            const Image* img1 = temp1.GetImage(0, 0, 0);
-            const Image* img2 = temp2.GetImage(0, 0, 0);
-            if (!img1 || !img2)
-                return E_POINTER;
+    XMFLOAT4 channels;
+    XMFLOAT4 ssim;
+    HRESULT hr = CompareImages(image1, image2, flags, channels, &ssim);
+    if (FAILED(hr))
+        return hr;
 
-            return ComputeMSE_(*img1, *img2, mse, mseV, flags);
-        }
-        else
-        {
-            // Case 2: image1 is compressed, expand to RGBA32F
-            ScratchImage temp;
-            HRESULT hr = Decompress(image1, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
-            if (FAILED(hr))
-                return hr;
+    metrics.mseV[0] = channels.x;
+    metrics.mseV[1] = channels.y;
+    metrics.mseV[2] = channels.z;
+    metrics.mseV[3] = channels.w;
+    metrics.mse = channels.x + channels.y + channels.z + channels.w;
 
-            const Image* img = temp.GetImage(0, 0, 0);
-            if (!img)
-                return E_POINTER;
+    // PSNR and SSIM are averaged over the channels that take part in the comparison
+    const CMSE_FLAGS ignore = flags
+        | GetImpliedFlags(image1.format, CMSE_IMAGE1_SRGB)
+        | GetImpliedFlags(image2.format, CMSE_IMAGE2_SRGB);
 
-            return ComputeMSE_(*img, image2, mse, mseV, flags);
+    const bool active[4] =
+    {
+        !(ignore & CMSE_IGNORE_RED),
+        !(ignore & CMSE_IGNORE_GREEN),
+        !(ignore & CMSE_IGNORE_BLUE),
+        !(ignore & CMSE_IGNORE_ALPHA)
+    };
+    const float ssimV[4] = { ssim.x, ssim.y, ssim.z, ssim.w };
+
+    size_t channelCount = 0;
+    float ssimSum = 0.f;
+    for (size_t j = 0; j < 4; ++j)
+    {
+        if (active[j])
+        {
+            ++channelCount;
+            ssimSum += ssimV[j];
         }
     }
-    else
+
+    if (!channelCount)
     {
-        if (IsCompressed(image2.format))
-        {
-            // Case 3: image2 is compressed, expand to RGBA32F
-            ScratchImage temp;
-            HRESULT hr = Decompress(image2, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
-            if (FAILED(hr))
-                return hr;
+        metrics.psnr = std::numeric_limits<float>::infinity();
+        metrics.ssim = 1.f;
+        return S_OK;
+    }
 
-            const Image* img = temp.GetImage(0, 0, 0);
-            if (!img)
-                return E_POINTER;
+    // PSNR = 10 log10( peak^2 / MSE ) with a peak value of 1.0
+    const float meanError = metrics.mse / float(channelCount);
+    metrics.psnr = (meanError > 0.f) ? -10.f * log10f(meanError) : std::numeric_limits<float>::infinity();
+    metrics.ssim = ssimSum / float(channelCount);
 
-            return ComputeMSE_(image1, *img, mse, mseV, flags);
-        }
-        else
-        {
-            // Case 4: neither image is compressed
-            return ComputeMSE_(image1, image2, mse, mseV, flags);
-        }
-    }
+    return S_OK;
 }
 
 
@@ -472,47 +657,15 @@ HRESULT DirectX::ComputeMSE(
 // Evaluates a user-supplied function for all the pixels in the image
 //-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::EvaluateImage(
-    const Image& image,
-    std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc)
-{
-    if (image.width > UINT32_MAX
-        || image.height > UINT32_MAX)
-        return E_INVALIDARG;
-
-    if (!IsValid(image.format))
-        return E_INVALIDARG;
-
-    if (IsPlanar(image.format) || IsPalettized(image.format) || IsTypeless(image.format))
-        return HRESULT_E_NOT_SUPPORTED;
-
-    if (IsCompressed(image.format))
-    {
-        ScratchImage temp;
-        HRESULT hr = Decompress(image, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
-        if (FAILED(hr))
-            return hr;
-
-        const Image* img = temp.GetImage(0, 0, 0);
-        if (!img)
-            return E_POINTER;
-
-        return EvaluateImage_(*img, pixelFunc);
-    }
-    else
-    {
-        return EvaluateImage_(image, pixelFunc);
-    }
-}
-
-_Use_decl_annotations_
-HRESULT DirectX::EvaluateImage(
+HRESULT DirectX::EvaluateImageRows(
     const Image* images,
     size_t nimages,
     const TexMetadata& metadata,
-    std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc)
+    TEX_PIXELFUNC_FLAGS flags,
+    EvaluateRowFunc rowFunc,
+    void* context)
 {
-    if (!images || !nimages)
+    if (!images || !nimages || !rowFunc)
         return E_INVALIDARG;
 
     if (!IsValid(metadata.format))
@@ -532,7 +685,8 @@ HRESULT DirectX::EvaluateImage(
     DXGI_FORMAT format = metadata.format;
     if (IsCompressed(format))
     {
-        HRESULT hr = Decompress(images, nimages, metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, temp);
+        const TEX_DECOMPRESS_FLAGS decompress = (flags & TEX_PIXELFUNC_PARALLEL) ? TEX_DECOMPRESS_PARALLEL : TEX_DECOMPRESS_DEFAULT;
+        HRESULT hr = DecompressEx(images, nimages, metadata, DXGI_FORMAT_R32G32B32A32_FLOAT, decompress, temp);
         if (FAILED(hr))
             return hr;
 
@@ -543,107 +697,82 @@ HRESULT DirectX::EvaluateImage(
         format = DXGI_FORMAT_R32G32B32A32_FLOAT;
     }
 
-    switch (metadata.dimension)
-    {
-    case TEX_DIMENSION_TEXTURE1D:
-    case TEX_DIMENSION_TEXTURE2D:
-        for (size_t index = 0; index < nimages; ++index)
-        {
-            const Image& img = images[index];
-            if (img.format != format)
-                return E_FAIL;
+    std::unique_ptr<size_t[]> firstBand;
+    size_t count = 0;
+    size_t maxWidth = 0;
+    HRESULT hr = SetupImageBands(images, nimages, metadata, format, firstBand, count, maxWidth);
+    if (FAILED(hr))
+        return hr;
 
-            if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
-                return E_FAIL;
+    const size_t bandCount = firstBand[count];
+    const bool parallel = (flags & TEX_PIXELFUNC_PARALLEL) != 0;
+    const size_t workerCount = (parallel) ? GetWorkerCount(0, bandCount) : 1;
 
-            HRESULT hr = EvaluateImage_(img, pixelFunc);
-            if (FAILED(hr))
-                return hr;
-        }
-        break;
+    auto scanlines = make_AlignedArrayXMVECTOR(uint64_t(maxWidth) * workerCount);
+    if (!scanlines)
+        return E_OUTOFMEMORY;
 
-    case TEX_DIMENSION_TEXTURE3D:
+    return ProcessBands(bandCount, parallel,
+        [&](size_t band, size_t worker) -> bool
         {
-            size_t index = 0;
-            size_t d = metadata.depth;
-            for (size_t level = 0; level < metadata.mipLevels; ++level)
-            {
-                for (size_t slice = 0; slice < d; ++slice, ++index)
-                {
-                    if (index >= nimages)
-                        return E_FAIL;
+            const size_t index = FindBandImage(firstBand.get(), count, band);
+            const Image& img = images[index];
 
-                    const Image& img = images[index];
-                    if (img.format != format)
-                        return E_FAIL;
+            XMVECTOR* scanline = scanlines.get() + maxWidth * worker;
 
-                    if ((img.width > UINT32_MAX) || (img.height > UINT32_MAX))
-                        return E_FAIL;
+            const size_t y0 = (band - firstBand[index]) * ROWS_PER_BAND;
+            const size_t y1 = std::min(img.height, y0 + ROWS_PER_BAND);
 
-                    HRESULT hr = EvaluateImage_(img, pixelFunc);
-                    if (FAILED(hr))
-                        return hr;
-                }
+            const uint8_t* pSrc = img.pixels + img.rowPitch * y0;
+            for (size_t y = y0; y < y1; ++y, pSrc += img.rowPitch)
+            {
+                if (!LoadScanline(scanline, img.width, pSrc, img.rowPitch, img.format))
+                    return false;
 
-                if (d > 1)
-                    d >>= 1;
+                rowFunc(context, scanline, img.width, y);
             }
-        }
-        break;
 
-    default:
-        return E_FAIL;
-    }
-
-    return S_OK;
+            return true;
+        });
 }
 
-
-//-------------------------------------------------------------------------------------
-// Use a user-supplied function to compute a new image from an input image
-//-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::TransformImage(
+HRESULT DirectX::EvaluateImage(
     const Image& image,
-    std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)> pixelFunc,
-    ScratchImage& result)
+    std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc)
 {
-    if (image.width > UINT32_MAX
-        || image.height > UINT32_MAX)
-        return E_INVALIDARG;
-
-    if (IsPlanar(image.format) || IsPalettized(image.format) || IsCompressed(image.format) || IsTypeless(image.format))
-        return HRESULT_E_NOT_SUPPORTED;
-
-    HRESULT hr = result.Initialize2D(image.format, image.width, image.height, 1, 1);
-    if (FAILED(hr))
-        return hr;
-
-    const Image* dimg = result.GetImage(0, 0, 0);
-    if (!dimg)
-    {
-        result.Release();
-        return E_POINTER;
-    }
+    const TexMetadata mdata = GetImageMetadata(image);
+    return EvaluateImage(&image, 1, mdata, pixelFunc);
+}
 
-    hr = TransformImage_(image, pixelFunc, *dimg);
-    if (FAILED(hr))
-    {
-        result.Release();
-        return hr;
-    }
+_Use_decl_annotations_
+HRESULT DirectX::EvaluateImage(
+    const Image* images,
+    size_t nimages,
+    const TexMetadata& metadata,
+    std::function<void __cdecl(_In_reads_(width) const XMVECTOR* pixels, size_t width, size_t y)> pixelFunc)
+{
+    if (!pixelFunc)
+        return E_INVALIDARG;
 
-    return S_OK;
+    return EvaluateImageRows(images, nimages, metadata, TEX_PIXELFUNC_DEFAULT, EvaluateThunk, &pixelFunc);
 }
 
+
+//-------------------------------------------------------------------------------------
+// Use a user-supplied function to compute a new image from an input image
+//-------------------------------------------------------------------------------------
 _Use_decl_annotations_
-HRESULT DirectX::TransformImage(
+HRESULT DirectX::TransformImageRows(
     const Image* srcImages,
-    size_t nimages, const TexMetadata& metadata,
-    std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)> pixelFunc,
+    size_t nimages,
+    const TexMetadata& metadata,
+    TEX_PIXELFUNC_FLAGS flags,
+    TransformRowFunc rowFunc,
+    void* context,
     ScratchImage& result)
 {
-    if (!srcImages || !nimages)
+    if (!srcImages || !nimages || !rowFunc)
         return E_INVALIDARG;
 
     if (IsPlanar(metadata.format) || IsPalettized(metadata.format) || IsCompressed(metadata.format) || IsTypeless(metadata.format))
@@ -673,95 +802,97 @@ HRESULT DirectX::TransformImage(
         return E_POINTER;
     }
 
-    switch (metadata.dimension)
+    std::unique_ptr<size_t[]> firstBand;
+    size_t count = 0;
+    size_t maxWidth = 0;
+    hr = SetupImageBands(srcImages, nimages, metadata, metadata.format, firstBand, count, maxWidth);
+    if (FAILED(hr))
     {
-    case TEX_DIMENSION_TEXTURE1D:
-    case TEX_DIMENSION_TEXTURE2D:
-        for (size_t index = 0; index < nimages; ++index)
-        {
-            const Image& src = srcImages[index];
-            if (src.format != metadata.format)
-            {
-                result.Release();
-                return E_FAIL;
-            }
-
-            if ((src.width > UINT32_MAX) || (src.height > UINT32_MAX))
-            {
-                result.Release();
-                return E_FAIL;
-            }
+        result.Release();
+        return hr;
+    }
 
-            const Image& dst = dest[index];
+    for (size_t index = 0; index < count; ++index)
+    {
+        if (srcImages[index].width != dest[index].width || srcImages[index].height != dest[index].height)
+        {
+            result.Release();
+            return E_FAIL;
+        }
+    }
 
-            if (src.width != dst.width || src.height != dst.height)
-            {
-                result.Release();
-                return E_FAIL;
-            }
+    const size_t bandCount = firstBand[count];
+    const bool parallel = (flags & TEX_PIXELFUNC_PARALLEL) != 0;
+    const size_t workerCount = (parallel) ? GetWorkerCount(0, bandCount) : 1;
 
-            hr = TransformImage_(src, pixelFunc, dst);
-            if (FAILED(hr))
-            {
-                result.Release();
-                return hr;
-            }
-        }
-        break;
+    auto scanlines = make_AlignedArrayXMVECTOR(uint64_t(maxWidth) * 2 * workerCount);
+    if (!scanlines)
+    {
+        result.Release();
+        return E_OUTOFMEMORY;
+    }
 
-    case TEX_DIMENSION_TEXTURE3D:
+    hr = ProcessBands(bandCount, parallel,
+        [&](size_t band, size_t worker) -> bool
         {
-            size_t index = 0;
-            size_t d = metadata.depth;
-            for (size_t level = 0; level < metadata.mipLevels; ++level)
-            {
-                for (size_t slice = 0; slice < d; ++slice, ++index)
-                {
-                    if (index >= nimages)
-                    {
-                        result.Release();
-                        return E_FAIL;
-                    }
+            const size_t index = FindBandImage(firstBand.get(), count, band);
+            const Image& src = srcImages[index];
+            const Image& dst = dest[index];
 
-                    const Image& src = srcImages[index];
-                    if (src.format != metadata.format)
-                    {
-                        result.Release();
-                        return E_FAIL;
-                    }
+            XMVECTOR* sScanline = scanlines.get() + maxWidth * 2 * worker;
+            XMVECTOR* dScanline = sScanline + maxWidth;
 
-                    if ((src.width > UINT32_MAX) || (src.height > UINT32_MAX))
-                    {
-                        result.Release();
-                        return E_FAIL;
-                    }
+            const size_t width = src.width;
+            const size_t y0 = (band - firstBand[index]) * ROWS_PER_BAND;
+            const size_t y1 = std::min(src.height, y0 + ROWS_PER_BAND);
 
-                    const Image& dst = dest[index];
+            const uint8_t* pSrc = src.pixels + src.rowPitch * y0;
+            uint8_t* pDest = dst.pixels + dst.rowPitch * y0;
+            for (size_t y = y0; y < y1; ++y, pSrc += src.rowPitch, pDest += dst.rowPitch)
+            {
+                if (!LoadScanline(sScanline, width, pSrc, src.rowPitch, src.format))
+                    return false;
 
-                    if (src.width != dst.width || src.height != dst.height)
-                    {
-                        result.Release();
-                        return E_FAIL;
-                    }
+            #ifdef _DEBUG
+                memset(dScanline, 0xCD, sizeof(XMVECTOR)*width);
+            #endif
 
-                    hr = TransformImage_(src, pixelFunc, dst);
-                    if (FAILED(hr))
-                    {
-                        result.Release();
-                        return hr;
-                    }
-                }
+                rowFunc(context, dScanline, sScanline, width, y);
 
-                if (d > 1)
-                    d >>= 1;
+                if (!StoreScanline(pDest, dst.rowPitch, dst.format, dScanline, width))
+                    return false;
             }
-        }
-        break;
 
-    default:
+            return true;
+        });
+    if (FAILED(hr))
+    {
         result.Release();
-        return E_FAIL;
+        return hr;
     }
 
     return S_OK;
 }
+
+_Use_decl_annotations_
+HRESULT DirectX::TransformImage(
+    const Image& image,
+    std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)> pixelFunc,
+    ScratchImage& result)
+{
+    const TexMetadata mdata = GetImageMetadata(image);
+    return TransformImage(&image, 1, mdata, pixelFunc, result);
+}
+
+_Use_decl_annotations_
+HRESULT DirectX::TransformImage(
+    const Image* srcImages,
+    size_t nimages, const TexMetadata& metadata,
+    std::function<void __cdecl(_Out_writes_(width) XMVECTOR* outPixels, _In_reads_(width) const XMVECTOR* inPixels, size_t width, size_t y)> pixelFunc,
+    ScratchImage& result)
+{
+    if (!pixelFunc)
+        return E_INVALIDARG;
+
+    return TransformImageRows(srcImages, nimages, metadata, TEX_PIXELFUNC_DEFAULT, TransformThunk, &pixelFunc, result);
+}
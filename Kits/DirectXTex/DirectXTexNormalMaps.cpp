@@ -74,6 +74,182 @@ namespace
         }
     }
 
+    // Images are split into bands of rows which are the unit of work for multithreading. Each
+    // band evaluates the rows just outside of it so bands are independent of each other.
+    constexpr size_t ROWS_PER_BAND = 32;
+
+    //---------------------------------------------------------------------------------
+    // Loads and evaluates a source row, where y may be one outside of the image (uses wrap or mirror)
+    bool EvaluateSourceRow(
+        const Image& srcImage,
+        ptrdiff_t y,
+        CNMAP_FLAGS flags,
+        _Out_writes_(srcImage.width) XMVECTOR* scanline,
+        _Out_writes_(srcImage.width + 2) float* pDest) noexcept
+    {
+        const auto height = static_cast<ptrdiff_t>(srcImage.height);
+        if (y < 0)
+        {
+            y = (flags & CNMAP_MIRROR_V) ? 0 : (height - 1);
+        }
+        else if (y >= height)
+        {
+            y = (flags & CNMAP_MIRROR_V) ? (height - 1) : 0;
+        }
+
+        const uint8_t* pSrc = srcImage.pixels + srcImage.rowPitch * size_t(y);
+        if (!LoadScanline(scanline, srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
+            return false;
+
+        EvaluateRow(scanline, pDest, srcImage.width, flags);
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Builds the normal from the central differences and encodes it for the target format
+    inline XMVECTOR XM_CALLCONV EncodeNormal(float deltaZX, float deltaZY, float alpha, CNMAP_FLAGS flags, uint32_t convFlags) noexcept
+    {
+        const XMVECTOR vx = XMVectorSetZ(g_XMNegIdentityR0, deltaZX);   // (-1.0f, 0.0f, deltaZX)
+        const XMVECTOR vy = XMVectorSetZ(g_XMNegIdentityR1, deltaZY);   // (0.0f, -1.0f, deltaZY)
+
+        const XMVECTOR normal = XMVector3Normalize(XMVector3Cross(vx, vy));
+
+        // Encode based on target format
+        if (convFlags & CONVF_UNORM)
+        {
+            // 0.5f*normal + 0.5f -or- invert sign case: -0.5f*normal + 0.5f
+            const XMVECTOR n1 = XMVectorMultiplyAdd((flags & CNMAP_INVERT_SIGN) ? g_XMNegativeOneHalf : g_XMOneHalf, normal, g_XMOneHalf);
+            return XMVectorSetW(n1, alpha);
+        }
+        else if (flags & CNMAP_INVERT_SIGN)
+        {
+            return XMVectorSetW(XMVectorNegate(normal), alpha);
+        }
+        else
+        {
+            return XMVectorSetW(normal, alpha);
+        }
+    }
+
+    //---------------------------------------------------------------------------------
+    // Generates a target scanline from three evaluated rows
+    void ComputeNormalRow(
+        _In_reads_(width + 2) const float* val0,
+        _In_reads_(width + 2) const float* val1,
+        _In_reads_(width + 2) const float* val2,
+        size_t width,
+        CNMAP_FLAGS flags,
+        float amplitude,
+        uint32_t convFlags,
+        _Out_writes_(width) XMVECTOR* target) noexcept
+    {
+        XMVECTOR *dptr = target;
+        size_t x = 0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // The central differences and occlusion term are computed four pixels at a time, with the same
+        // operations in the same order as the per-pixel code below. The normal itself is still built one
+        // pixel at a time by EncodeNormal, as XMVector3Normalize sums differently depending on the build.
+        const XMVECTOR vAmplitude = XMVectorReplicate(amplitude);
+        const XMVECTOR vSix = XMVectorReplicate(6.f);
+        const XMVECTOR vOcclusion = XMVectorReplicate(0.125f * amplitude);
+        const XMVECTOR vZero = XMVectorZero();
+
+        for (; (x + 4) <= width; x += 4)
+        {
+            const XMVECTOR l0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val0 + x));
+            const XMVECTOR c0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val0 + x + 1));
+            const XMVECTOR r0 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val0 + x + 2));
+            const XMVECTOR l1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val1 + x));
+            const XMVECTOR c1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val1 + x + 1));
+            const XMVECTOR r1 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val1 + x + 2));
+            const XMVECTOR l2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val2 + x));
+            const XMVECTOR c2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val2 + x + 1));
+            const XMVECTOR r2 = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(val2 + x + 2));
+
+            // Compute normal via central differencing
+            XMVECTOR totDelta = XMVectorAdd(XMVectorAdd(XMVectorSubtract(l0, r0), XMVectorSubtract(l1, r1)), XMVectorSubtract(l2, r2));
+            XMFLOAT4A deltaZX;
+            XMStoreFloat4A(&deltaZX, XMVectorDivide(XMVectorMultiply(totDelta, vAmplitude), vSix));
+
+            totDelta = XMVectorAdd(XMVectorAdd(XMVectorSubtract(l0, l2), XMVectorSubtract(c0, c2)), XMVectorSubtract(r0, r2));
+            XMFLOAT4A deltaZY;
+            XMStoreFloat4A(&deltaZY, XMVectorDivide(XMVectorMultiply(totDelta, vAmplitude), vSix));
+
+            // Compute alpha (1.0 or an occlusion term)
+            XMVECTOR alpha = g_XMOne;
+
+            if (flags & CNMAP_COMPUTE_OCCLUSION)
+            {
+                XMVECTOR delta = XMVectorMax(XMVectorSubtract(l0, c1), vZero);
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(c0, c1), vZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(r0, c1), vZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(l1, c1), vZero));
+                // Skip current pixel
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(r1, c1), vZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(l2, c1), vZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(c2, c1), vZero));
+                delta = XMVectorAdd(delta, XMVectorMax(XMVectorSubtract(r2, c1), vZero));
+
+                // Average delta (divide by 8, scale by amplitude factor)
+                delta = XMVectorMultiply(delta, vOcclusion);
+
+                const XMVECTOR r = XMVectorSqrt(XMVectorAdd(g_XMOne, XMVectorMultiply(delta, delta)));
+                const XMVECTOR occlusion = XMVectorDivide(XMVectorSubtract(r, delta), r);
+                alpha = XMVectorSelect(g_XMOne, occlusion, XMVectorGreater(delta, vZero));
+            }
+
+            XMFLOAT4A alphas;
+            XMStoreFloat4A(&alphas, alpha);
+
+            *dptr++ = EncodeNormal(deltaZX.x, deltaZY.x, alphas.x, flags, convFlags);
+            *dptr++ = EncodeNormal(deltaZX.y, deltaZY.y, alphas.y, flags, convFlags);
+            *dptr++ = EncodeNormal(deltaZX.z, deltaZY.z, alphas.z, flags, convFlags);
+            *dptr++ = EncodeNormal(deltaZX.w, deltaZY.w, alphas.w, flags, convFlags);
+        }
+    #endif
+
+        for (; x < width; ++x)
+        {
+            // Compute normal via central differencing
+            float totDelta = (val0[x] - val0[x + 2]) + (val1[x] - val1[x + 2]) + (val2[x] - val2[x + 2]);
+            const float deltaZX = totDelta * amplitude / 6.f;
+
+            totDelta = (val0[x] - val2[x]) + (val0[x + 1] - val2[x + 1]) + (val0[x + 2] - val2[x + 2]);
+            const float deltaZY = totDelta * amplitude / 6.f;
+
+            // Compute alpha (1.0 or an occlusion term)
+            float alpha = 1.f;
+
+            if (flags & CNMAP_COMPUTE_OCCLUSION)
+            {
+                float delta = 0.f;
+                const float c = val1[x + 1];
+
+                float t = val0[x] - c;  if (t > 0.f) delta += t;
+                t = val0[x + 1] - c;    if (t > 0.f) delta += t;
+                t = val0[x + 2] - c;    if (t > 0.f) delta += t;
+                t = val1[x] - c;    if (t > 0.f) delta += t;
+                // Skip current pixel
+                t = val1[x + 2] - c;    if (t > 0.f) delta += t;
+                t = val2[x] - c;    if (t > 0.f) delta += t;
+                t = val2[x + 1] - c;    if (t > 0.f) delta += t;
+                t = val2[x + 2] - c;    if (t > 0.f) delta += t;
+
+                // Average delta (divide by 8, scale by amplitude factor)
+                delta *= 0.125f * amplitude;
+                if (delta > 0.f)
+                {
+                    // If < 0, then no occlusion
+                    const float r = sqrtf(1.f + delta*delta);
+                    alpha = (r - delta) / r;
+                }
+            }
+
+            *dptr++ = EncodeNormal(deltaZX, deltaZY, alpha, flags, convFlags);
+        }
+    }
+
     HRESULT ComputeNMap(_In_ const Image& srcImage, _In_ CNMAP_FLAGS flags, _In_ float amplitude,
         _In_ DXGI_FORMAT format, _In_ const Image& normalMap) noexcept
     {
@@ -92,153 +268,70 @@ namespace
         if (width != normalMap.width || height != normalMap.height)
             return E_FAIL;
 
-        // Allocate temporary space (4 scanlines and 3 evaluated rows)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 4);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        const size_t bandCount = (height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+        const bool parallel = (flags & CNMAP_PARALLEL) && (bandCount > 1);
+        const size_t workerCount = (parallel) ? GetWorkerCount(0, bandCount) : 1;
 
-        auto buffer = make_AlignedArrayFloat((uint64_t(width) + 2) * 3);
-        if (!buffer)
+        // Allocate temporary space (2 scanlines and 3 evaluated rows per worker)
+        auto scanlines = make_AlignedArrayXMVECTOR(uint64_t(width) * 2 * workerCount);
+        if (!scanlines)
             return E_OUTOFMEMORY;
 
-        uint8_t* pDest = normalMap.pixels;
-        if (!pDest)
-            return E_POINTER;
-
-        XMVECTOR* row0 = scanline.get();
-        XMVECTOR* row1 = row0 + width;
-        XMVECTOR* row2 = row1 + width;
-        XMVECTOR* target = row2 + width;
-
-        float* val0 = buffer.get();
-        float* val1 = val0 + width + 2;
-        float* val2 = val1 + width + 2;
-
-        const size_t rowPitch = srcImage.rowPitch;
-        const uint8_t* pSrc = srcImage.pixels;
-
-        // Read first scanline row into 'row1'
-        if (!LoadScanline(row1, width, pSrc, rowPitch, srcImage.format))
-            return E_FAIL;
+        auto buffers = make_AlignedArrayFloat((uint64_t(width) + 2) * 3 * workerCount);
+        if (!buffers)
+            return E_OUTOFMEMORY;
 
-        // Setup 'row0'
-        if (flags & CNMAP_MIRROR_V)
+        auto band = [&](size_t index, size_t worker) noexcept -> bool
         {
-            // Mirror first row
-            memcpy(row0, row1, rowPitch);
-        }
-        else
-        {
-            // Read last row (Wrap V)
-            if (!LoadScanline(row0, width, pSrc + (rowPitch * (height - 1)), rowPitch, srcImage.format))
-                return E_FAIL;
-        }
+            XMVECTOR* row = scanlines.get() + width * 2 * worker;
+            XMVECTOR* target = row + width;
 
-        // Evaluate the initial rows
-        EvaluateRow(row0, val0, width, flags);
-        EvaluateRow(row1, val1, width, flags);
+            float* val0 = buffers.get() + (width + 2) * 3 * worker;
+            float* val1 = val0 + width + 2;
+            float* val2 = val1 + width + 2;
 
-        pSrc += rowPitch;
+            const size_t y0 = index * ROWS_PER_BAND;
+            const size_t y1 = std::min(height, y0 + ROWS_PER_BAND);
 
-        for (size_t y = 0; y < height; ++y)
-        {
-            // Load next scanline of source image
-            if (y < (height - 1))
-            {
-                if (!LoadScanline(row2, width, pSrc, rowPitch, srcImage.format))
-                    return E_FAIL;
-            }
-            else
-            {
-                if (flags & CNMAP_MIRROR_V)
-                {
-                    // Use last row of source image
-                    if (!LoadScanline(row2, width, srcImage.pixels + (rowPitch * (height - 1)), rowPitch, srcImage.format))
-                        return E_FAIL;
-                }
-                else
-                {
-                    // Use first row of source image (Wrap V)
-                    if (!LoadScanline(row2, width, srcImage.pixels, rowPitch, srcImage.format))
-                        return E_FAIL;
-                }
-            }
+            // Evaluate the initial rows
+            if (!EvaluateSourceRow(srcImage, ptrdiff_t(y0) - 1, flags, row, val0)
+                || !EvaluateSourceRow(srcImage, ptrdiff_t(y0), flags, row, val1))
+                return false;
 
-            // Evaluate row
-            EvaluateRow(row2, val2, width, flags);
+            uint8_t* pDest = normalMap.pixels + normalMap.rowPitch * y0;
 
-            // Generate target scanline
-            XMVECTOR *dptr = target;
-            for (size_t x = 0; x < width; ++x)
+            for (size_t y = y0; y < y1; ++y)
             {
-                // Compute normal via central differencing
-                float totDelta = (val0[x] - val0[x + 2]) + (val1[x] - val1[x + 2]) + (val2[x] - val2[x + 2]);
-                const float deltaZX = totDelta * amplitude / 6.f;
-
-                totDelta = (val0[x] - val2[x]) + (val0[x + 1] - val2[x + 1]) + (val0[x + 2] - val2[x + 2]);
-                const float deltaZY = totDelta * amplitude / 6.f;
+                // Evaluate next row (wraps or mirrors past the last row of the image)
+                if (!EvaluateSourceRow(srcImage, ptrdiff_t(y) + 1, flags, row, val2))
+                    return false;
 
-                const XMVECTOR vx = XMVectorSetZ(g_XMNegIdentityR0, deltaZX);   // (-1.0f, 0.0f, deltaZX)
-                const XMVECTOR vy = XMVectorSetZ(g_XMNegIdentityR1, deltaZY);   // (0.0f, -1.0f, deltaZY)
+                ComputeNormalRow(val0, val1, val2, width, flags, amplitude, convFlags, target);
 
-                const XMVECTOR normal = XMVector3Normalize(XMVector3Cross(vx, vy));
+                if (!StoreScanline(pDest, normalMap.rowPitch, format, target, width))
+                    return false;
 
-                // Compute alpha (1.0 or an occlusion term)
-                float alpha = 1.f;
+                // Cycle buffers
+                float* temp = val0;
+                val0 = val1;
+                val1 = val2;
+                val2 = temp;
 
-                if (flags & CNMAP_COMPUTE_OCCLUSION)
-                {
-                    float delta = 0.f;
-                    const float c = val1[x + 1];
-
-                    float t = val0[x] - c;  if (t > 0.f) delta += t;
-                    t = val0[x + 1] - c;    if (t > 0.f) delta += t;
-                    t = val0[x + 2] - c;    if (t > 0.f) delta += t;
-                    t = val1[x] - c;    if (t > 0.f) delta += t;
-                    // Skip current pixel
-                    t = val1[x + 2] - c;    if (t > 0.f) delta += t;
-                    t = val2[x] - c;    if (t > 0.f) delta += t;
-                    t = val2[x + 1] - c;    if (t > 0.f) delta += t;
-                    t = val2[x + 2] - c;    if (t > 0.f) delta += t;
-
-                    // Average delta (divide by 8, scale by amplitude factor)
-                    delta *= 0.125f * amplitude;
-                    if (delta > 0.f)
-                    {
-                        // If < 0, then no occlusion
-                        const float r = sqrtf(1.f + delta*delta);
-                        alpha = (r - delta) / r;
-                    }
-                }
-
-                // Encode based on target format
-                if (convFlags & CONVF_UNORM)
-                {
-                    // 0.5f*normal + 0.5f -or- invert sign case: -0.5f*normal + 0.5f
-                    const XMVECTOR n1 = XMVectorMultiplyAdd((flags & CNMAP_INVERT_SIGN) ? g_XMNegativeOneHalf : g_XMOneHalf, normal, g_XMOneHalf);
-                    *dptr++ = XMVectorSetW(n1, alpha);
-                }
-                else if (flags & CNMAP_INVERT_SIGN)
-                {
-                    *dptr++ = XMVectorSetW(XMVectorNegate(normal), alpha);
-                }
-                else
-                {
-                    *dptr++ = XMVectorSetW(normal, alpha);
-                }
+                pDest += normalMap.rowPitch;
             }
 
-            if (!StoreScanline(pDest, normalMap.rowPitch, format, target, width))
-                return E_FAIL;
+            return true;
+        };
 
-            // Cycle buffers
-            float* temp = val0;
-            val0 = val1;
-            val1 = val2;
-            val2 = temp;
+        if (parallel)
+        {
+            return ParallelFor(bandCount, 0, band);
+        }
 
-            pSrc += rowPitch;
-            pDest += normalMap.rowPitch;
+        for (size_t index = 0; index < bandCount; ++index)
+        {
+            if (!band(index, 0))
+                return E_FAIL;
         }
 
         return S_OK;
@@ -25,28 +25,22 @@ namespace
         return static_cast<TEX_FILTER_FLAGS>(compress & TEX_FILTER_SRGB_MASK);
     }
 
+    // Images are split into bands of rows which are the unit of work for multithreading
+    constexpr size_t ROWS_PER_BAND = 32;
+
     //---------------------------------------------------------------------------------
     // NonPremultiplied alpha -> Premultiplied alpha
-    HRESULT PremultiplyAlpha_(const Image& srcImage, const Image& destImage) noexcept
+    bool PremultiplyAlpha_(const Image& srcImage, const Image& destImage, size_t y0, size_t y1, XMVECTOR* scanline) noexcept
     {
-        assert(srcImage.width == destImage.width);
-        assert(srcImage.height == destImage.height);
-
-        auto scanline = make_AlignedArrayXMVECTOR(srcImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        const uint8_t *pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+        uint8_t *pDest = destImage.pixels + destImage.rowPitch * y0;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
-
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
-            if (!LoadScanline(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
-                return E_FAIL;
+            if (!LoadScanline(scanline, srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
+                return false;
 
-            XMVECTOR* ptr = scanline.get();
+            XMVECTOR* ptr = scanline;
             for (size_t w = 0; w < srcImage.width; ++w)
             {
                 const XMVECTOR v = *ptr;
@@ -55,43 +49,27 @@ namespace
                 *(ptr++) = XMVectorSelect(v, alpha, g_XMSelect1110);
             }
 
-            if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline.get(), srcImage.width))
-                return E_FAIL;
+            if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline, srcImage.width))
+                return false;
 
             pSrc += srcImage.rowPitch;
             pDest += destImage.rowPitch;
         }
 
-        return S_OK;
+        return true;
     }
 
-    HRESULT PremultiplyAlphaLinear(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage) noexcept
+    bool PremultiplyAlphaLinear(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage, size_t y0, size_t y1, XMVECTOR* scanline) noexcept
     {
-        assert(srcImage.width == destImage.width);
-        assert(srcImage.height == destImage.height);
-
-        static_assert(static_cast<int>(TEX_PMALPHA_SRGB_IN) == static_cast<int>(TEX_FILTER_SRGB_IN), "TEX_PMALHPA_SRGB* should match TEX_FILTER_SRGB*");
-        static_assert(static_cast<int>(TEX_PMALPHA_SRGB_OUT) == static_cast<int>(TEX_FILTER_SRGB_OUT), "TEX_PMALHPA_SRGB* should match TEX_FILTER_SRGB*");
-        static_assert(static_cast<int>(TEX_PMALPHA_SRGB) == static_cast<int>(TEX_FILTER_SRGB), "TEX_PMALHPA_SRGB* should match TEX_FILTER_SRGB*");
-        flags &= TEX_PMALPHA_SRGB;
-
-        auto scanline = make_AlignedArrayXMVECTOR(srcImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
-
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
-
-        const TEX_FILTER_FLAGS filter = GetSRGBFlags(flags);
+        const uint8_t *pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+        uint8_t *pDest = destImage.pixels + destImage.rowPitch * y0;
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
-            if (!LoadScanlineLinear(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format, filter))
-                return E_FAIL;
+            if (!LoadScanlineLinear(scanline, srcImage.width, pSrc, srcImage.rowPitch, srcImage.format, filter))
+                return false;
 
-            XMVECTOR* ptr = scanline.get();
+            XMVECTOR* ptr = scanline;
             for (size_t w = 0; w < srcImage.width; ++w)
             {
                 const XMVECTOR v = *ptr;
@@ -100,38 +78,114 @@ namespace
                 *(ptr++) = XMVectorSelect(v, alpha, g_XMSelect1110);
             }
 
-            if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, scanline.get(), srcImage.width, filter))
-                return E_FAIL;
+            if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, scanline, srcImage.width, filter))
+                return false;
 
             pSrc += srcImage.rowPitch;
             pDest += destImage.rowPitch;
         }
 
-        return S_OK;
+        return true;
     }
 
     //---------------------------------------------------------------------------------
-    // Premultiplied alpha -> NonPremultiplied alpha (a.k.a. Straight alpha)
-    HRESULT DemultiplyAlpha(const Image& srcImage, const Image& destImage) noexcept
+    // NonPremultiplied alpha -> Premultiplied alpha for 8:8:8:8 UNORM formats
+    //
+    // Computes round(c * a / 255) in integers, which gives the same result as the
+    // floating-point path since the exact product is never halfway between two values.
+    inline bool IsPremultiply8Bit(DXGI_FORMAT format, TEX_PMALPHA_FLAGS flags) noexcept
     {
-        assert(srcImage.width == destImage.width);
-        assert(srcImage.height == destImage.height);
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            return (flags & TEX_PMALPHA_IGNORE_SRGB) || !(flags & TEX_PMALPHA_SRGB);
 
-        auto scanline = make_AlignedArrayXMVECTOR(srcImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            return (flags & TEX_PMALPHA_IGNORE_SRGB) != 0;
 
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
+        default:
+            return false;
+        }
+    }
+
+    void PremultiplyAlpha8Bit(const Image& srcImage, const Image& destImage, size_t y0, size_t y1) noexcept
+    {
+        const uint8_t *pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+        uint8_t *pDest = destImage.pixels + destImage.rowPitch * y0;
+
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // Alpha is the fourth byte of each pixel in both RGBA and BGRA, and is multiplied by 255
+        const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        const __m128i colorMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i bias = _mm_set1_epi16(128);
+        const __m128i zero = _mm_setzero_si128();
+    #endif
+
+        for (size_t h = y0; h < y1; ++h)
+        {
+            auto sPtr = reinterpret_cast<const uint32_t*>(pSrc);
+            auto dPtr = reinterpret_cast<uint32_t*>(pDest);
+
+            size_t w = 0;
+
+        #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+            for (; (w + 4) <= srcImage.width; w += 4)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr + w));
+
+                __m128i lo = _mm_unpacklo_epi8(v, zero);
+                __m128i hi = _mm_unpackhi_epi8(v, zero);
+
+                __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+                alo = _mm_or_si128(_mm_and_si128(alo, colorMask), alphaOne);
+                ahi = _mm_or_si128(_mm_and_si128(ahi, colorMask), alphaOne);
+
+                // t = c * a + 128; result = (t + (t >> 8)) >> 8
+                lo = _mm_add_epi16(_mm_mullo_epi16(lo, alo), bias);
+                hi = _mm_add_epi16(_mm_mullo_epi16(hi, ahi), bias);
+                lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+                hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr + w), _mm_packus_epi16(lo, hi));
+            }
+        #endif
+
+            for (; w < srcImage.width; ++w)
+            {
+                const uint32_t t = sPtr[w];
+                const uint32_t a = t >> 24;
+
+                uint32_t result = t & 0xff000000;
+                for (uint32_t shift = 0; shift < 24; shift += 8)
+                {
+                    const uint32_t c = ((t >> shift) & 0xff) * a + 128;
+                    result |= ((c + (c >> 8)) >> 8) << shift;
+                }
+
+                dPtr[w] = result;
+            }
+
+            pSrc += srcImage.rowPitch;
+            pDest += destImage.rowPitch;
+        }
+    }
 
-        for (size_t h = 0; h < srcImage.height; ++h)
+    //---------------------------------------------------------------------------------
+    // Premultiplied alpha -> NonPremultiplied alpha (a.k.a. Straight alpha)
+    bool DemultiplyAlpha(const Image& srcImage, const Image& destImage, size_t y0, size_t y1, XMVECTOR* scanline) noexcept
+    {
+        const uint8_t *pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+        uint8_t *pDest = destImage.pixels + destImage.rowPitch * y0;
+
+        for (size_t h = y0; h < y1; ++h)
         {
-            if (!LoadScanline(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
-                return E_FAIL;
+            if (!LoadScanline(scanline, srcImage.width, pSrc, srcImage.rowPitch, srcImage.format))
+                return false;
 
-            XMVECTOR* ptr = scanline.get();
+            XMVECTOR* ptr = scanline;
             for (size_t w = 0; w < srcImage.width; ++w)
             {
                 const XMVECTOR v = *ptr;
@@ -143,43 +197,27 @@ namespace
                 *(ptr++) = XMVectorSelect(v, alpha, g_XMSelect1110);
             }
 
-            if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline.get(), srcImage.width))
-                return E_FAIL;
+            if (!StoreScanline(pDest, destImage.rowPitch, destImage.format, scanline, srcImage.width))
+                return false;
 
             pSrc += srcImage.rowPitch;
             pDest += destImage.rowPitch;
         }
 
-        return S_OK;
+        return true;
     }
 
-    HRESULT DemultiplyAlphaLinear(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage) noexcept
+    bool DemultiplyAlphaLinear(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage, size_t y0, size_t y1, XMVECTOR* scanline) noexcept
     {
-        assert(srcImage.width == destImage.width);
-        assert(srcImage.height == destImage.height);
-
-        static_assert(static_cast<int>(TEX_PMALPHA_SRGB_IN) == static_cast<int>(TEX_FILTER_SRGB_IN), "TEX_PMALPHA_SRGB* should match TEX_FILTER_SRGB*");
-        static_assert(static_cast<int>(TEX_PMALPHA_SRGB_OUT) == static_cast<int>(TEX_FILTER_SRGB_OUT), "TEX_PMALPHA_SRGB* should match TEX_FILTER_SRGB*");
-        static_assert(static_cast<int>(TEX_PMALPHA_SRGB) == static_cast<int>(TEX_FILTER_SRGB), "TEX_PMALPHA_SRGB* should match TEX_FILTER_SRGB*");
-        flags &= TEX_PMALPHA_SRGB;
+        const uint8_t *pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+        uint8_t *pDest = destImage.pixels + destImage.rowPitch * y0;
 
-        auto scanline = make_AlignedArrayXMVECTOR(srcImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
-
-        const uint8_t *pSrc = srcImage.pixels;
-        uint8_t *pDest = destImage.pixels;
-        if (!pSrc || !pDest)
-            return E_POINTER;
-
-        const TEX_FILTER_FLAGS filter = GetSRGBFlags(flags);
-
-        for (size_t h = 0; h < srcImage.height; ++h)
+        for (size_t h = y0; h < y1; ++h)
         {
-            if (!LoadScanlineLinear(scanline.get(), srcImage.width, pSrc, srcImage.rowPitch, srcImage.format, filter))
-                return E_FAIL;
+            if (!LoadScanlineLinear(scanline, srcImage.width, pSrc, srcImage.rowPitch, srcImage.format, filter))
+                return false;
 
-            XMVECTOR* ptr = scanline.get();
+            XMVECTOR* ptr = scanline;
             for (size_t w = 0; w < srcImage.width; ++w)
             {
                 const XMVECTOR v = *ptr;
@@ -191,13 +229,81 @@ namespace
                 *(ptr++) = XMVectorSelect(v, alpha, g_XMSelect1110);
             }
 
-            if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, scanline.get(), srcImage.width, filter))
-                return E_FAIL;
+            if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, scanline, srcImage.width, filter))
+                return false;
 
             pSrc += srcImage.rowPitch;
             pDest += destImage.rowPitch;
         }
 
+        return true;
+    }
+
+    //---------------------------------------------------------------------------------
+    // Converts one image, a band of rows at a time
+    HRESULT ConvertAlpha(const Image& srcImage, TEX_PMALPHA_FLAGS flags, const Image& destImage) noexcept
+    {
+        assert(srcImage.width == destImage.width);
+        assert(srcImage.height == destImage.height);
+
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        const TEX_FILTER_FLAGS filter = GetSRGBFlags(flags);
+
+        const bool reverse = (flags & TEX_PMALPHA_REVERSE) != 0;
+        const bool ignoreSRGB = (flags & TEX_PMALPHA_IGNORE_SRGB) != 0;
+        const bool fast8Bit = !reverse && IsPremultiply8Bit(srcImage.format, flags);
+
+        const size_t bandCount = (srcImage.height + ROWS_PER_BAND - 1) / ROWS_PER_BAND;
+        const bool parallel = (flags & TEX_PMALPHA_PARALLEL) && (bandCount > 1);
+        const size_t workerCount = (parallel) ? GetWorkerCount(0, bandCount) : 1;
+
+        ScopedAlignedArrayXMVECTOR scanlines;
+        if (!fast8Bit)
+        {
+            scanlines = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * workerCount);
+            if (!scanlines)
+                return E_OUTOFMEMORY;
+        }
+
+        auto band = [&](size_t index, size_t worker) noexcept -> bool
+        {
+            const size_t y0 = index * ROWS_PER_BAND;
+            const size_t y1 = std::min(srcImage.height, y0 + ROWS_PER_BAND);
+
+            if (fast8Bit)
+            {
+                PremultiplyAlpha8Bit(srcImage, destImage, y0, y1);
+                return true;
+            }
+
+            XMVECTOR* scanline = scanlines.get() + srcImage.width * worker;
+            if (reverse)
+            {
+                return (ignoreSRGB)
+                    ? DemultiplyAlpha(srcImage, destImage, y0, y1, scanline)
+                    : DemultiplyAlphaLinear(srcImage, filter, destImage, y0, y1, scanline);
+            }
+            else
+            {
+                return (ignoreSRGB)
+                    ? PremultiplyAlpha_(srcImage, destImage, y0, y1, scanline)
+                    : PremultiplyAlphaLinear(srcImage, filter, destImage, y0, y1, scanline);
+            }
+        };
+
+        if (parallel)
+        {
+            return ParallelFor(bandCount, 0, band);
+        }
+
+        for (size_t index = 0; index < bandCount; ++index)
+        {
+            if (!band(index, 0))
+                return E_FAIL;
+        }
+
         return S_OK;
     }
 }
@@ -240,14 +346,7 @@ HRESULT DirectX::PremultiplyAlpha(
         return E_POINTER;
     }
 
-    if (flags & TEX_PMALPHA_REVERSE)
-    {
-        hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? DemultiplyAlpha(srcImage, *rimage) : DemultiplyAlphaLinear(srcImage, flags, *rimage);
-    }
-    else
-    {
-        hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? PremultiplyAlpha_(srcImage, *rimage) : PremultiplyAlphaLinear(srcImage, flags, *rimage);
-    }
+    hr = ConvertAlpha(srcImage, flags, *rimage);
     if (FAILED(hr))
     {
         image.Release();
@@ -325,14 +424,7 @@ HRESULT DirectX::PremultiplyAlpha(
             return E_FAIL;
         }
 
-        if (flags & TEX_PMALPHA_REVERSE)
-        {
-            hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? DemultiplyAlpha(src, dst) : DemultiplyAlphaLinear(src, flags, dst);
-        }
-        else
-        {
-            hr = (flags & TEX_PMALPHA_IGNORE_SRGB) ? PremultiplyAlpha_(src, dst) : PremultiplyAlphaLinear(src, flags, dst);
-        }
+        hr = ConvertAlpha(src, flags, dst);
         if (FAILED(hr))
         {
             result.Release();
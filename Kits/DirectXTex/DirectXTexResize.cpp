@@ -231,7 +231,9 @@ namespace
             break;
 
         case TEX_FILTER_TRIANGLE:
-            // WIC does not implement this filter
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            // WIC does not implement these filters
             return false;
 
         default:
@@ -371,475 +373,504 @@ namespace
     }
 
 
-    //--- Linear Filter ---
-    HRESULT ResizeLinearFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
-    {
-        using namespace DirectX::Filters;
-
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
+    //--- Separable Filters (Linear, Cubic, Triangle, Lanczos3, Mitchell) ---
 
-        // Allocate temporary space (3 scanlines, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 2 + destImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
-
-        std::unique_ptr<LinearFilter[]> lf(new (std::nothrow) LinearFilter[destImage.width + destImage.height]);
-        if (!lf)
-            return E_OUTOFMEMORY;
-
-        LinearFilter* lfX = lf.get();
-        LinearFilter* lfY = lf.get() + destImage.width;
-
-        CreateLinearFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, lfX);
-        CreateLinearFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, lfY);
-
-        XMVECTOR* target = scanline.get();
+    // Neighboring destination rows share most of their vertical taps, so each worker keeps a
+    // small FIFO of source rows. Rows are stored after the horizontal pass, except for the
+    // triangle filter which weights each source pixel by its combined x, y (and z) weight.
+    class FilteredRowCache
+    {
+    public:
+        FilteredRowCache() noexcept : m_slots(0), m_next(0), m_width(0), m_target(0), m_filtered(false) {}
 
-        XMVECTOR* row0 = target + destImage.width;
-        XMVECTOR* row1 = row0 + srcImage.width;
+        FilteredRowCache(const FilteredRowCache&) = delete;
+        FilteredRowCache& operator=(const FilteredRowCache&) = delete;
 
-    #ifdef _DEBUG
-        memset(row0, 0xCD, sizeof(XMVECTOR)*srcImage.width);
-        memset(row1, 0xDD, sizeof(XMVECTOR)*srcImage.width);
-    #endif
+        HRESULT Initialize(size_t slots, size_t srcWidth, size_t width, bool filtered) noexcept
+        {
+            m_index.reset(new (std::nothrow) size_t[slots]);
+            m_used.reset(new (std::nothrow) size_t[slots]);
+            if (!m_index || !m_used)
+                return E_OUTOFMEMORY;
+
+            // Filtered rows need 1 extra scanline to load the source row into
+            const size_t rowWidth = (filtered) ? width : srcWidth;
+            m_rows = make_AlignedArrayXMVECTOR(uint64_t(slots) * rowWidth + ((filtered) ? srcWidth : 0));
+            if (!m_rows)
+                return E_OUTOFMEMORY;
+
+            for (size_t j = 0; j < slots; ++j)
+            {
+                m_index[j] = size_t(-1);
+                m_used[j] = 0;
+            }
 
-        const uint8_t* pSrc = srcImage.pixels;
-        uint8_t* pDest = destImage.pixels;
+            m_slots = slots;
+            m_next = 0;
+            m_width = rowWidth;
+            m_target = 1;
+            m_filtered = filtered;
 
-        const size_t rowPitch = srcImage.rowPitch;
+            return S_OK;
+        }
 
-        size_t u0 = size_t(-1);
-        size_t u1 = size_t(-1);
+        // Rows returned since the last call stay valid until the next one, so a target row
+        // can hold on to all of its taps at once (needs more slots than taps)
+        void NextTarget() noexcept
+        {
+            ++m_target;
+        }
 
-        for (size_t y = 0; y < destImage.height; ++y)
+        // key identifies the row across all of the source images
+        const XMVECTOR* GetRow(
+            size_t key,
+            size_t y,
+            const Image& srcImage,
+            TEX_FILTER_FLAGS filter,
+            unsigned long filterSelect,
+            const Filters::PolyphaseFilter& pfX) noexcept
         {
-            auto const& toY = lfY[y];
+            using namespace DirectX::Filters;
 
-            if (toY.u0 != u0)
+            for (size_t j = 0; j < m_slots; ++j)
             {
-                if (toY.u0 != u1)
-                {
-                    u0 = toY.u0;
-
-                    if (!LoadScanlineLinear(row0, srcImage.width, pSrc + (rowPitch * u0), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else
+                if (m_index[j] == key)
                 {
-                    u0 = u1;
-                    u1 = size_t(-1);
-
-                    std::swap(row0, row1);
+                    m_used[j] = m_target;
+                    return m_rows.get() + j * m_width;
                 }
             }
 
-            if (toY.u1 != u1)
+            size_t slot = m_next;
+            while (m_used[slot] == m_target)
             {
-                u1 = toY.u1;
-
-                if (!LoadScanlineLinear(row1, srcImage.width, pSrc + (rowPitch * u1), rowPitch, srcImage.format, filter))
-                    return E_FAIL;
+                slot = (slot + 1) % m_slots;
+                assert(slot != m_next);
             }
 
-            for (size_t x = 0; x < destImage.width; ++x)
-            {
-                auto const& toX = lfX[x];
+            m_next = (slot + 1) % m_slots;
+            m_index[slot] = size_t(-1);
 
-                BILINEAR_INTERPOLATE(target[x], toX, toY, row0, row1)
-            }
+            XMVECTOR* row = m_rows.get() + slot * m_width;
+            XMVECTOR* scanline = (m_filtered) ? m_rows.get() + m_slots * m_width : row;
 
-            if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
-                return E_FAIL;
-            pDest += destImage.rowPitch;
-        }
-
-        return S_OK;
-    }
-
-
-    //--- Cubic Filter ---
-#ifdef __clang__
-#pragma clang diagnostic ignored "-Wextra-semi-stmt"
-#endif
-
-    HRESULT ResizeCubicFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
-    {
-        using namespace DirectX::Filters;
-
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
-
-        // Allocate temporary space (5 scanlines, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(srcImage.width) * 4 + destImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+            if (!LoadScanlineLinear(scanline, srcImage.width, srcImage.pixels + (srcImage.rowPitch * y), srcImage.rowPitch, srcImage.format, filter))
+                return nullptr;
 
-        std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[destImage.width + destImage.height]);
-        if (!cf)
-            return E_OUTOFMEMORY;
+            if (m_filtered)
+            {
+                // One XMVECTOR per pixel, with the same operations as the serial filter of each mode
+                const FilterTap* taps = pfX.taps.get();
 
-        CubicFilter* cfX = cf.get();
-        CubicFilter* cfY = cf.get() + destImage.width;
+                switch (filterSelect)
+                {
+                case TEX_FILTER_LINEAR:
+                    for (size_t x = 0; x < m_width; ++x)
+                    {
+                        const FilterTap* tap = taps + pfX.offsets[x];
+                        row[x] = XMVectorAdd(XMVectorScale(scanline[tap[0].src], tap[0].weight), XMVectorScale(scanline[tap[1].src], tap[1].weight));
+                    }
+                    break;
 
-        CreateCubicFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, cfX);
-        CreateCubicFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, cfY);
+                case TEX_FILTER_CUBIC:
+                    for (size_t x = 0; x < m_width; ++x)
+                    {
+                        const FilterTap* tap = taps + pfX.offsets[x];
+                        CUBIC_INTERPOLATE(row[x], pfX.phases[x], scanline[tap[0].src], scanline[tap[1].src], scanline[tap[2].src], scanline[tap[3].src]);
+                    }
+                    break;
 
-        XMVECTOR* target = scanline.get();
+                default:
+                    for (size_t x = 0; x < m_width; ++x)
+                    {
+                        XMVECTOR acc = XMVectorZero();
+                        for (size_t j = pfX.offsets[x]; j < pfX.offsets[x + 1]; ++j)
+                        {
+                            acc = XMVectorMultiplyAdd(scanline[taps[j].src], XMVectorReplicate(taps[j].weight), acc);
+                        }
+                        row[x] = acc;
+                    }
+                    break;
+                }
+            }
 
-        XMVECTOR* row0 = target + destImage.width;
-        XMVECTOR* row1 = row0 + srcImage.width;
-        XMVECTOR* row2 = row0 + srcImage.width * 2;
-        XMVECTOR* row3 = row0 + srcImage.width * 3;
+            m_index[slot] = key;
+            m_used[slot] = m_target;
+            return row;
+        }
 
-    #ifdef _DEBUG
-        memset(row0, 0xCD, sizeof(XMVECTOR)*srcImage.width);
-        memset(row1, 0xDD, sizeof(XMVECTOR)*srcImage.width);
-        memset(row2, 0xED, sizeof(XMVECTOR)*srcImage.width);
-        memset(row3, 0xFD, sizeof(XMVECTOR)*srcImage.width);
-    #endif
+    private:
+        size_t                      m_slots;
+        size_t                      m_next;
+        size_t                      m_width;
+        size_t                      m_target;
+        bool                        m_filtered;
+        std::unique_ptr<size_t[]>   m_index;
+        std::unique_ptr<size_t[]>   m_used;
+        ScopedAlignedArrayXMVECTOR  m_rows;
+    };
+
+    constexpr size_t RESIZE_ROWS_PER_BAND = 16;
+
+    // Taps of a destination pixel are sorted by source, so repeats of a source are adjacent
+    inline const Filters::FilterTap* SameSourceEnd(const Filters::FilterTap* tap, const Filters::FilterTap* end) noexcept
+    {
+        const size_t src = tap->src;
+        while (tap < end && tap->src == src)
+        {
+            ++tap;
+        }
+        return tap;
+    }
 
-        const uint8_t* pSrc = srcImage.pixels;
-        uint8_t* pDest = destImage.pixels;
 
-        const size_t rowPitch = srcImage.rowPitch;
+    //--- Custom filter resize ---
+    HRESULT PerformResizeUsingCustomFilters(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    {
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
 
-        size_t u0 = size_t(-1);
-        size_t u1 = size_t(-1);
-        size_t u2 = size_t(-1);
-        size_t u3 = size_t(-1);
+        static_assert(TEX_FILTER_POINT == 0x100000, "TEX_FILTER_ flag values don't match TEX_FILTER_MASK");
 
-        for (size_t y = 0; y < destImage.height; ++y)
+        unsigned long filter_select = filter & TEX_FILTER_MODE_MASK;
+        if (!filter_select)
         {
-            auto const& toY = cfY[y];
+            // Default filter choice
+            filter_select = (((destImage.width << 1) == srcImage.width) && ((destImage.height << 1) == srcImage.height))
+                ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
+        }
 
-            // Scanline 1
-            if (toY.u0 != u0)
-            {
-                if (toY.u0 != u1 && toY.u0 != u2 && toY.u0 != u3)
-                {
-                    u0 = toY.u0;
+        switch (filter_select)
+        {
+        case TEX_FILTER_POINT:
+            return ResizePointFilter(srcImage, destImage);
 
-                    if (!LoadScanlineLinear(row0, srcImage.width, pSrc + (rowPitch * u0), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else if (toY.u0 == u1)
-                {
-                    u0 = u1;
-                    u1 = size_t(-1);
+        case TEX_FILTER_BOX:
+            return ResizeBoxFilter(srcImage, filter, destImage);
 
-                    std::swap(row0, row1);
-                }
-                else if (toY.u0 == u2)
-                {
-                    u0 = u2;
-                    u2 = size_t(-1);
+        case TEX_FILTER_LINEAR:
+        case TEX_FILTER_CUBIC:
+        case TEX_FILTER_TRIANGLE:
+        case TEX_FILTER_LANCZOS3:
+        case TEX_FILTER_MITCHELL:
+            return ResizeSeparableFilter(srcImage, static_cast<TEX_FILTER_FLAGS>((filter & ~TEX_FILTER_MODE_MASK) | filter_select), destImage);
 
-                    std::swap(row0, row2);
-                }
-                else if (toY.u0 == u3)
-                {
-                    u0 = u3;
-                    u3 = size_t(-1);
+        default:
+            return HRESULT_E_NOT_SUPPORTED;
+        }
+    }
+}
 
-                    std::swap(row0, row3);
-                }
-            }
 
-            // Scanline 2
-            if (toY.u1 != u1)
-            {
-                if (toY.u1 != u2 && toY.u1 != u3)
-                {
-                    u1 = toY.u1;
+//-------------------------------------------------------------------------------------
+// Resize using the separable filters, with precomputed weight tables for each axis.
+// Either resizes each srcImages[i] into destImages[i], or treats the images as the
+// slices of a volume and also filters along depth.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::Internal::ResizeSeparableFilter(
+    const Image* srcImages,
+    size_t srcCount,
+    const Image* destImages,
+    size_t destCount,
+    bool volume,
+    TEX_FILTER_FLAGS filter) noexcept
+{
+    using namespace DirectX::Filters;
 
-                    if (!LoadScanlineLinear(row1, srcImage.width, pSrc + (rowPitch * u1), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else if (toY.u1 == u2)
-                {
-                    u1 = u2;
-                    u2 = size_t(-1);
+    if (!srcImages || !destImages || !srcCount || !destCount)
+        return E_INVALIDARG;
 
-                    std::swap(row1, row2);
-                }
-                else if (toY.u1 == u3)
-                {
-                    u1 = u3;
-                    u3 = size_t(-1);
+    if (!volume && (srcCount != destCount))
+        return E_INVALIDARG;
 
-                    std::swap(row1, row3);
-                }
-            }
+    const Image& srcImage = srcImages[0];
+    const Image& destImage = destImages[0];
 
-            // Scanline 3
-            if (toY.u2 != u2)
-            {
-                if (toY.u2 != u3)
-                {
-                    u2 = toY.u2;
+    for (size_t j = 0; j < srcCount; ++j)
+    {
+        if (!srcImages[j].pixels)
+            return E_POINTER;
 
-                    if (!LoadScanlineLinear(row2, srcImage.width, pSrc + (rowPitch * u2), rowPitch, srcImage.format, filter))
-                        return E_FAIL;
-                }
-                else
-                {
-                    u2 = u3;
-                    u3 = size_t(-1);
+        if (srcImages[j].width != srcImage.width || srcImages[j].height != srcImage.height || srcImages[j].format != srcImage.format)
+            return E_FAIL;
+    }
 
-                    std::swap(row2, row3);
-                }
-            }
+    for (size_t j = 0; j < destCount; ++j)
+    {
+        if (!destImages[j].pixels)
+            return E_POINTER;
 
-            // Scanline 4
-            if (toY.u3 != u3)
-            {
-                u3 = toY.u3;
+        if (destImages[j].width != destImage.width || destImages[j].height != destImage.height || destImages[j].format != srcImage.format)
+            return E_FAIL;
+    }
 
-                if (!LoadScanlineLinear(row3, srcImage.width, pSrc + (rowPitch * u3), rowPitch, srcImage.format, filter))
-                    return E_FAIL;
-            }
+    unsigned long filter_select = filter & TEX_FILTER_MODE_MASK;
+    if (!filter_select)
+    {
+        filter_select = TEX_FILTER_LINEAR;
+    }
 
-            for (size_t x = 0; x < destImage.width; ++x)
-            {
-                auto const& toX = cfX[x];
+    switch (filter_select)
+    {
+    case TEX_FILTER_LINEAR:
+    case TEX_FILTER_CUBIC:
+    case TEX_FILTER_TRIANGLE:
+    case TEX_FILTER_LANCZOS3:
+    case TEX_FILTER_MITCHELL:
+        break;
 
-                XMVECTOR C0, C1, C2, C3;
+    default:
+        return HRESULT_E_NOT_SUPPORTED;
+    }
 
-                CUBIC_INTERPOLATE(C0, toX.x, row0[toX.u0], row0[toX.u1], row0[toX.u2], row0[toX.u3]);
-                CUBIC_INTERPOLATE(C1, toX.x, row1[toX.u0], row1[toX.u1], row1[toX.u2], row1[toX.u3]);
-                CUBIC_INTERPOLATE(C2, toX.x, row2[toX.u0], row2[toX.u1], row2[toX.u2], row2[toX.u3]);
-                CUBIC_INTERPOLATE(C3, toX.x, row3[toX.u0], row3[toX.u1], row3[toX.u2], row3[toX.u3]);
+    PolyphaseFilter pfX;
+    HRESULT hr = CreatePolyphaseFilter(filter_select, srcImage.width, destImage.width,
+        (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0, pfX);
+    if (FAILED(hr))
+        return hr;
 
-                CUBIC_INTERPOLATE(target[x], toY.x, C0, C1, C2, C3);
-            }
+    PolyphaseFilter pfY;
+    hr = CreatePolyphaseFilter(filter_select, srcImage.height, destImage.height,
+        (filter & TEX_FILTER_WRAP_V) != 0, (filter & TEX_FILTER_MIRROR_V) != 0, pfY);
+    if (FAILED(hr))
+        return hr;
 
-            if (!StoreScanlineLinear(pDest, destImage.rowPitch, destImage.format, target, destImage.width, filter))
-                return E_FAIL;
-            pDest += destImage.rowPitch;
-        }
+    // Like the 3D mip generators, a single slice is filtered as a 2D image
+    const bool depthAxis = volume && (srcCount > 1);
 
-        return S_OK;
+    PolyphaseFilter pfZ;
+    if (depthAxis)
+    {
+        hr = CreatePolyphaseFilter(filter_select, srcCount, destCount,
+            (filter & TEX_FILTER_WRAP_W) != 0, (filter & TEX_FILTER_MIRROR_W) != 0, pfZ);
+        if (FAILED(hr))
+            return hr;
     }
 
-
-    //--- Triangle Filter ---
-    HRESULT ResizeTriangleFilter(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
+    bool bias = false;
+    if (filter_select == TEX_FILTER_TRIANGLE)
     {
-        using namespace DirectX::Filters;
-
-        assert(srcImage.pixels && destImage.pixels);
-        assert(srcImage.format == destImage.format);
+        switch (destImage.format)
+        {
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+        case DXGI_FORMAT_R10G10B10A2_UINT:
+            bias = true;
+            break;
 
-        // Allocate initial temporary space (1 scanline, accumulation rows, plus X and Y filters)
-        auto scanline = make_AlignedArrayXMVECTOR(srcImage.width);
-        if (!scanline)
-            return E_OUTOFMEMORY;
+        default:
+            break;
+        }
+    }
 
-        std::unique_ptr<TriangleRow[]> rowActive(new (std::nothrow) TriangleRow[destImage.height]);
-        if (!rowActive)
-            return E_OUTOFMEMORY;
+    // Work is split into bands of destination rows across all of the destination images
+    const size_t bandCount = (destImage.height + RESIZE_ROWS_PER_BAND - 1) / RESIZE_ROWS_PER_BAND;
+    const size_t taskCount = bandCount * destCount;
+    const size_t threadCount = (filter & TEX_FILTER_PARALLEL) ? 0 : 1;
+    const size_t workerCount = GetWorkerCount(threadCount, taskCount);
 
-        TriangleRow * rowFree = nullptr;
+    // Per-worker temporary space (row cache holding every tap of a target row, plus 1 target scanline)
+    const size_t rowTaps = pfY.maxTaps * ((depthAxis) ? pfZ.maxTaps : 1);
 
-        std::unique_ptr<Filter> tfX;
-        HRESULT hr = CreateTriangleFilter(srcImage.width, destImage.width, (filter & TEX_FILTER_WRAP_U) != 0, tfX);
-        if (FAILED(hr))
-            return hr;
+    std::unique_ptr<FilteredRowCache[]> caches(new (std::nothrow) FilteredRowCache[workerCount]);
+    std::unique_ptr<const XMVECTOR*[]> rowLists(new (std::nothrow) const XMVECTOR*[rowTaps * workerCount]);
+    if (!caches || !rowLists)
+        return E_OUTOFMEMORY;
 
-        std::unique_ptr<Filter> tfY;
-        hr = CreateTriangleFilter(srcImage.height, destImage.height, (filter & TEX_FILTER_WRAP_V) != 0, tfY);
+    for (size_t w = 0; w < workerCount; ++w)
+    {
+        hr = caches[w].Initialize(rowTaps + 2, srcImage.width, destImage.width, filter_select != TEX_FILTER_TRIANGLE);
         if (FAILED(hr))
             return hr;
+    }
 
-        XMVECTOR* row = scanline.get();
-
-    #ifdef _DEBUG
-        memset(row, 0xCD, sizeof(XMVECTOR)*srcImage.width);
-    #endif
-
-        auto xFromEnd = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(tfX.get()) + tfX->sizeInBytes);
-        auto yFromEnd = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(tfY.get()) + tfY->sizeInBytes);
+    auto targets = make_AlignedArrayXMVECTOR(uint64_t(destImage.width) * workerCount);
+    if (!targets)
+        return E_OUTOFMEMORY;
 
-        // Count times rows get written
-        for (FilterFrom* yFrom = tfY->from; yFrom < yFromEnd; )
+    return ParallelFor(taskCount, workerCount, [&](size_t task, size_t worker) -> bool
         {
-            for (size_t j = 0; j < yFrom->count; ++j)
+            FilteredRowCache& cache = caches[worker];
+            const XMVECTOR** rows = rowLists.get() + worker * rowTaps;
+            XMVECTOR* target = targets.get() + worker * destImage.width;
+
+            const size_t item = task / bandCount;
+            const size_t band = task % bandCount;
+            const Image& dest = destImages[item];
+
+            // Without a depth axis each destination image has a single source image
+            const FilterTap identity = { (volume) ? 0 : item, item, 1.f };
+            const FilterTap* zBegin = &identity;
+            const FilterTap* zEnd = zBegin + 1;
+            if (depthAxis)
             {
-                const size_t v = yFrom->to[j].u;
-                assert(v < destImage.height);
-                ++rowActive[v].remaining;
+                zBegin = pfZ.taps.get() + pfZ.offsets[item];
+                zEnd = pfZ.taps.get() + pfZ.offsets[item + 1];
             }
 
-            yFrom = reinterpret_cast<FilterFrom*>(reinterpret_cast<uint8_t*>(yFrom) + yFrom->sizeInBytes);
-        }
-
-        // Filter image
-        const uint8_t* pSrc = srcImage.pixels;
-        const size_t rowPitch = srcImage.rowPitch;
-        const uint8_t* pEndSrc = pSrc + rowPitch * srcImage.height;
-
-        uint8_t* pDest = destImage.pixels;
-
-        for (FilterFrom* yFrom = tfY->from; yFrom < yFromEnd; )
-        {
-            // Create accumulation rows as needed
-            for (size_t j = 0; j < yFrom->count; ++j)
+            const size_t yEnd = std::min(dest.height, (band + 1) * RESIZE_ROWS_PER_BAND);
+            for (size_t y = band * RESIZE_ROWS_PER_BAND; y < yEnd; ++y)
             {
-                const size_t v = yFrom->to[j].u;
-                assert(v < destImage.height);
-                TriangleRow* rowAcc = &rowActive[v];
-
-                if (!rowAcc->scanline)
-                {
-                    if (rowFree)
-                    {
-                        // Steal and reuse scanline from 'free row' list
-                        assert(rowFree->scanline != nullptr);
-                        rowAcc->scanline.reset(rowFree->scanline.release());
-                        rowFree = rowFree->next;
-                    }
-                    else
-                    {
-                        auto nscanline = make_AlignedArrayXMVECTOR(destImage.width);
-                        if (!nscanline)
-                            return E_OUTOFMEMORY;
-                        rowAcc->scanline.swap(nscanline);
-                    }
-
-                    memset(rowAcc->scanline.get(), 0, sizeof(XMVECTOR) * destImage.width);
-                }
-            }
+                const FilterTap* yBegin = pfY.taps.get() + pfY.offsets[y];
+                const size_t yCount = pfY.offsets[y + 1] - pfY.offsets[y];
 
-            // Load source scanline
-            if ((pSrc + rowPitch) > pEndSrc)
-                return E_FAIL;
-
-            if (!LoadScanlineLinear(row, srcImage.width, pSrc, rowPitch, srcImage.format, filter))
-                return E_FAIL;
+                // Gather every source row of this target row, ordered by depth tap then row tap
+                cache.NextTarget();
 
-            pSrc += rowPitch;
-
-            // Process row
-            size_t x = 0;
-            for (FilterFrom* xFrom = tfX->from; xFrom < xFromEnd; ++x)
-            {
-                for (size_t j = 0; j < yFrom->count; ++j)
+                size_t rowCount = 0;
+                for (const FilterTap* zTap = zBegin; zTap < zEnd; ++zTap)
                 {
-                    const size_t v = yFrom->to[j].u;
-                    assert(v < destImage.height);
-                    const float yweight = yFrom->to[j].weight;
-
-                    XMVECTOR* accPtr = rowActive[v].scanline.get();
-                    if (!accPtr)
-                        return E_POINTER;
+                    const Image& src = srcImages[zTap->src];
 
-                    for (size_t k = 0; k < xFrom->count; ++k)
+                    for (size_t j = 0; j < yCount; ++j)
                     {
-                        size_t u = xFrom->to[k].u;
-                        assert(u < destImage.width);
+                        const size_t sy = yBegin[j].src;
 
-                        const XMVECTOR weight = XMVectorReplicate(yweight * xFrom->to[k].weight);
-
-                        assert(x < srcImage.width);
-                        accPtr[u] = XMVectorMultiplyAdd(row[x], weight, accPtr[u]);
+                        rows[rowCount] = cache.GetRow(zTap->src * src.height + sy, sy, src, filter, filter_select, pfX);
+                        if (!rows[rowCount++])
+                            return false;
                     }
                 }
 
-                xFrom = reinterpret_cast<FilterFrom*>(reinterpret_cast<uint8_t*>(xFrom) + xFrom->sizeInBytes);
-            }
-
-            // Write completed accumulation rows
-            for (size_t j = 0; j < yFrom->count; ++j)
-            {
-                size_t v = yFrom->to[j].u;
-                assert(v < destImage.height);
-                TriangleRow* rowAcc = &rowActive[v];
-
-                assert(rowAcc->remaining > 0);
-                --rowAcc->remaining;
-
-                if (!rowAcc->remaining)
+                // Each pixel is one XMVECTOR and the taps are walked one at a time. Linear, cubic and triangle
+                // use the same operations in the same order as the serial filters (BILINEAR_INTERPOLATE,
+                // TRILINEAR_INTERPOLATE, CUBIC_INTERPOLATE and the triangle accumulation), so they match them exactly.
+                switch (filter_select)
                 {
-                    XMVECTOR* pAccSrc = rowAcc->scanline.get();
-                    if (!pAccSrc)
-                        return E_POINTER;
-
-                    switch (destImage.format)
+                case TEX_FILTER_LINEAR:
+                    for (size_t x = 0; x < dest.width; ++x)
                     {
-                    case DXGI_FORMAT_R10G10B10A2_UNORM:
-                    case DXGI_FORMAT_R10G10B10A2_UINT:
+                        XMVECTOR v0 = XMVectorAdd(XMVectorScale(rows[0][x], yBegin[0].weight), XMVectorScale(rows[1][x], yBegin[1].weight));
+                        if (depthAxis)
                         {
-                            // Need to slightly bias results for floating-point error accumulation which can
-                            // be visible with harshly quantized values
-                            static const XMVECTORF32 Bias = { { { 0.f, 0.f, 0.f, 0.1f } } };
+                            const XMVECTOR v1 = XMVectorAdd(XMVectorScale(rows[2][x], yBegin[0].weight), XMVectorScale(rows[3][x], yBegin[1].weight));
+                            v0 = XMVectorAdd(XMVectorScale(v0, zBegin[0].weight), XMVectorScale(v1, zBegin[1].weight));
+                        }
+                        target[x] = v0;
+                    }
+                    break;
 
-                            XMVECTOR* ptr = pAccSrc;
-                            for (size_t i = 0; i < destImage.width; ++i, ++ptr)
-                            {
-                                *ptr = XMVectorAdd(*ptr, Bias);
-                            }
+                case TEX_FILTER_CUBIC:
+                    for (size_t x = 0; x < dest.width; ++x)
+                    {
+                        XMVECTOR D[4];
+                        for (size_t j = 0; j < rowCount; j += 4)
+                        {
+                            CUBIC_INTERPOLATE(D[j >> 2], pfY.phases[y], rows[j][x], rows[j + 1][x], rows[j + 2][x], rows[j + 3][x]);
                         }
-                        break;
 
-                    default:
-                        break;
+                        if (depthAxis)
+                        {
+                            CUBIC_INTERPOLATE(target[x], pfZ.phases[item], D[0], D[1], D[2], D[3]);
+                        }
+                        else
+                        {
+                            target[x] = D[0];
+                        }
                     }
+                    break;
 
-                    // This performs any required clamping
-                    if (!StoreScanlineLinear(pDest + (destImage.rowPitch * v), destImage.rowPitch, destImage.format, pAccSrc, destImage.width, filter))
-                        return E_FAIL;
-
-                    // Put row on freelist to reuse it's allocated scanline
-                    rowAcc->next = rowFree;
-                    rowFree = rowAcc;
-                }
-            }
+                case TEX_FILTER_TRIANGLE:
+                    {
+                        // The serial filter visits each source pixel once and adds it to every destination it
+                        // reaches. When wrapping a tiny image, a source can reach a destination more than once,
+                        // so taps that share a source are applied together to keep the same order.
+                        memset(target, 0, sizeof(XMVECTOR) * dest.width);
 
-            yFrom = reinterpret_cast<FilterFrom*>(reinterpret_cast<uint8_t*>(yFrom) + yFrom->sizeInBytes);
-        }
+                        const FilterTap* yEndTap = yBegin + yCount;
 
-        return S_OK;
-    }
+                        for (const FilterTap* z0 = zBegin; z0 < zEnd; )
+                        {
+                            const FilterTap* z1 = SameSourceEnd(z0, zEnd);
 
+                            for (const FilterTap* y0 = yBegin; y0 < yEndTap; )
+                            {
+                                const FilterTap* y1 = SameSourceEnd(y0, yEndTap);
+
+                                for (size_t x = 0; x < dest.width; ++x)
+                                {
+                                    const FilterTap* xEndTap = pfX.taps.get() + pfX.offsets[x + 1];
+
+                                    for (const FilterTap* x0 = pfX.taps.get() + pfX.offsets[x]; x0 < xEndTap; )
+                                    {
+                                        const FilterTap* x1 = SameSourceEnd(x0, xEndTap);
+
+                                        for (const FilterTap* zTap = z0; zTap < z1; ++zTap)
+                                        {
+                                            for (const FilterTap* yTap = y0; yTap < y1; ++yTap)
+                                            {
+                                                const XMVECTOR* row = rows[size_t(zTap - zBegin) * yCount + size_t(yTap - yBegin)];
+                                                const float weight = zTap->weight * yTap->weight;
+
+                                                for (const FilterTap* xTap = x0; xTap < x1; ++xTap)
+                                                {
+                                                    target[x] = XMVectorMultiplyAdd(row[xTap->src], XMVectorReplicate(weight * xTap->weight), target[x]);
+                                                }
+                                            }
+                                        }
+
+                                        x0 = x1;
+                                    }
+                                }
+
+                                y0 = y1;
+                            }
 
-    //--- Custom filter resize ---
-    HRESULT PerformResizeUsingCustomFilters(const Image& srcImage, TEX_FILTER_FLAGS filter, const Image& destImage) noexcept
-    {
-        if (!srcImage.pixels || !destImage.pixels)
-            return E_POINTER;
+                            z0 = z1;
+                        }
+                    }
+                    break;
 
-        static_assert(TEX_FILTER_POINT == 0x100000, "TEX_FILTER_ flag values don't match TEX_FILTER_MASK");
+                default:
+                    {
+                        memset(target, 0, sizeof(XMVECTOR) * dest.width);
 
-        unsigned long filter_select = filter & TEX_FILTER_MODE_MASK;
-        if (!filter_select)
-        {
-            // Default filter choice
-            filter_select = (((destImage.width << 1) == srcImage.width) && ((destImage.height << 1) == srcImage.height))
-                ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
-        }
+                        size_t r = 0;
+                        for (const FilterTap* zTap = zBegin; zTap < zEnd; ++zTap)
+                        {
+                            for (size_t j = 0; j < yCount; ++j)
+                            {
+                                const XMVECTOR* row = rows[r++];
+                                const XMVECTOR weight = XMVectorReplicate(zTap->weight * yBegin[j].weight);
 
-        switch (filter_select)
-        {
-        case TEX_FILTER_POINT:
-            return ResizePointFilter(srcImage, destImage);
+                                for (size_t x = 0; x < dest.width; ++x)
+                                {
+                                    target[x] = XMVectorMultiplyAdd(row[x], weight, target[x]);
+                                }
+                            }
+                        }
+                    }
+                    break;
+                }
 
-        case TEX_FILTER_BOX:
-            return ResizeBoxFilter(srcImage, filter, destImage);
+                if (bias)
+                {
+                    // Need to slightly bias results for floating-point error accumulation which can
+                    // be visible with harshly quantized values
+                    static const XMVECTORF32 Bias = { { { 0.f, 0.f, 0.f, 0.1f } } };
 
-        case TEX_FILTER_LINEAR:
-            return ResizeLinearFilter(srcImage, filter, destImage);
+                    for (size_t x = 0; x < dest.width; ++x)
+                    {
+                        target[x] = XMVectorAdd(target[x], Bias);
+                    }
+                }
 
-        case TEX_FILTER_CUBIC:
-            return ResizeCubicFilter(srcImage, filter, destImage);
+                // This performs any required clamping
+                if (!StoreScanlineLinear(dest.pixels + (dest.rowPitch * y), dest.rowPitch, dest.format, target, dest.width, filter))
+                    return false;
+            }
 
-        case TEX_FILTER_TRIANGLE:
-            return ResizeTriangleFilter(srcImage, filter, destImage);
+            return true;
+        });
+}
 
-        default:
-            return HRESULT_E_NOT_SUPPORTED;
-        }
-    }
+_Use_decl_annotations_
+HRESULT DirectX::Internal::ResizeSeparableFilter(
+    const Image& srcImage,
+    TEX_FILTER_FLAGS filter,
+    const Image& destImage) noexcept
+{
+    return ResizeSeparableFilter(&srcImage, 1, &destImage, 1, false, filter);
 }
 
 
@@ -0,0 +1,535 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexStreaming.cpp
+//
+// DirectX Texture Library - Streaming resize and mipmap generation
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include "filters.h"
+
+using namespace DirectX;
+using namespace DirectX::Internal;
+using namespace DirectX::Filters;
+
+namespace
+{
+    constexpr bool ispow2(_In_ size_t x) noexcept
+    {
+        return ((x != 0) && !(x & (x - 1)));
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Resizes an image one source row at a time. Each row is filtered horizontally, then
+    // scattered into the accumulation rows of the destination rows it contributes to.
+    // A destination row is emitted (and its storage recycled) as soon as its last
+    // contribution arrives, so only rows within the vertical filter support are live.
+    //-------------------------------------------------------------------------------------
+    class StreamingResizer
+    {
+    public:
+        StreamingResizer() noexcept :
+            m_srcWidth(0),
+            m_srcHeight(0),
+            m_width(0),
+            m_height(0),
+            m_hTapCount(0),
+            m_nextRow(0),
+            m_bias(false),
+            m_rowFree(nullptr)
+        {
+        }
+
+        StreamingResizer(const StreamingResizer&) = delete;
+        StreamingResizer& operator=(const StreamingResizer&) = delete;
+
+        HRESULT Initialize(
+            size_t srcWidth, size_t srcHeight,
+            size_t width, size_t height,
+            DXGI_FORMAT format, unsigned long filterSelect, TEX_FILTER_FLAGS filter) noexcept
+        {
+            HRESULT hr = CreateFilterTaps(filterSelect, srcWidth, width,
+                (filter & TEX_FILTER_WRAP_U) != 0, (filter & TEX_FILTER_MIRROR_U) != 0,
+                m_hTaps, m_hTapCount);
+            if (FAILED(hr))
+                return hr;
+
+            std::unique_ptr<FilterTap[]> vTaps;
+            size_t vTapCount = 0;
+            // Wrapping is rejected by the callers, as it would keep every destination row live
+            hr = CreateFilterTaps(filterSelect, srcHeight, height,
+                false, (filter & TEX_FILTER_MIRROR_V) != 0,
+                vTaps, vTapCount);
+            if (FAILED(hr))
+                return hr;
+
+            m_hrow = make_AlignedArrayXMVECTOR(width);
+            if (!m_hrow)
+                return E_OUTOFMEMORY;
+
+            m_rows.reset(new (std::nothrow) TriangleRow[height]);
+            m_vOffsets.reset(new (std::nothrow) size_t[srcHeight + 1]);
+            m_vTaps.reset(new (std::nothrow) FilterTap[std::max<size_t>(vTapCount, 1)]);
+            if (!m_rows || !m_vOffsets || !m_vTaps)
+                return E_OUTOFMEMORY;
+
+            // Group the vertical taps by source row and count the contributions to each destination row
+            memset(m_vOffsets.get(), 0, sizeof(size_t) * (srcHeight + 1));
+
+            for (size_t j = 0; j < vTapCount; ++j)
+            {
+                assert(vTaps[j].src < srcHeight);
+                assert(vTaps[j].dest < height);
+                ++m_vOffsets[vTaps[j].src + 1];
+                ++m_rows[vTaps[j].dest].remaining;
+            }
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                // Every destination row must be completed by some source row
+                if (!m_rows[y].remaining)
+                    return E_FAIL;
+            }
+
+            for (size_t y = 0; y < srcHeight; ++y)
+            {
+                m_vOffsets[y + 1] += m_vOffsets[y];
+            }
+
+            std::unique_ptr<size_t[]> cursor(new (std::nothrow) size_t[srcHeight]);
+            if (!cursor)
+                return E_OUTOFMEMORY;
+
+            memcpy(cursor.get(), m_vOffsets.get(), sizeof(size_t) * srcHeight);
+
+            for (size_t j = 0; j < vTapCount; ++j)
+            {
+                m_vTaps[cursor[vTaps[j].src]++] = vTaps[j];
+            }
+
+            m_srcWidth = srcWidth;
+            m_srcHeight = srcHeight;
+            m_width = width;
+            m_height = height;
+            m_nextRow = 0;
+            m_rowFree = nullptr;
+
+            switch (format)
+            {
+            case DXGI_FORMAT_R10G10B10A2_UNORM:
+            case DXGI_FORMAT_R10G10B10A2_UINT:
+                // Matches the bias applied by the in-memory triangle filter
+                m_bias = (filterSelect == TEX_FILTER_TRIANGLE);
+                break;
+
+            default:
+                m_bias = false;
+                break;
+            }
+
+            return S_OK;
+        }
+
+        size_t GetWidth() const noexcept { return m_width; }
+        size_t GetHeight() const noexcept { return m_height; }
+
+        // Consumes the next source row (linear space, m_srcWidth pixels). emit(y, pixels) is invoked
+        // for every destination row completed by it; the pixels may be modified by the callee.
+        template<typename TEmit>
+        HRESULT PushRow(_In_ const XMVECTOR* row, TEmit&& emit)
+        {
+            if (m_nextRow >= m_srcHeight)
+                return E_UNEXPECTED;
+
+            const size_t sy = m_nextRow++;
+
+            // Horizontal pass
+            XMVECTOR* hrow = m_hrow.get();
+            memset(hrow, 0, sizeof(XMVECTOR) * m_width);
+
+            for (size_t j = 0; j < m_hTapCount; ++j)
+            {
+                auto const& tap = m_hTaps[j];
+                assert(tap.src < m_srcWidth);
+                hrow[tap.dest] = XMVectorMultiplyAdd(row[tap.src], XMVectorReplicate(tap.weight), hrow[tap.dest]);
+            }
+
+            // Vertical pass
+            for (size_t j = m_vOffsets[sy]; j < m_vOffsets[sy + 1]; ++j)
+            {
+                auto const& tap = m_vTaps[j];
+
+                TriangleRow* rowAcc = &m_rows[tap.dest];
+                if (!rowAcc->scanline)
+                {
+                    if (m_rowFree)
+                    {
+                        // Steal and reuse scanline from 'free row' list
+                        assert(m_rowFree->scanline != nullptr);
+                        rowAcc->scanline.reset(m_rowFree->scanline.release());
+                        m_rowFree = m_rowFree->next;
+                    }
+                    else
+                    {
+                        auto nscanline = make_AlignedArrayXMVECTOR(m_width);
+                        if (!nscanline)
+                            return E_OUTOFMEMORY;
+                        rowAcc->scanline.swap(nscanline);
+                    }
+
+                    memset(rowAcc->scanline.get(), 0, sizeof(XMVECTOR) * m_width);
+                }
+
+                XMVECTOR* accPtr = rowAcc->scanline.get();
+
+                const XMVECTOR weight = XMVectorReplicate(tap.weight);
+                for (size_t x = 0; x < m_width; ++x)
+                {
+                    accPtr[x] = XMVectorMultiplyAdd(hrow[x], weight, accPtr[x]);
+                }
+
+                assert(rowAcc->remaining > 0);
+                if (--rowAcc->remaining)
+                    continue;
+
+                if (m_bias)
+                {
+                    // Need to slightly bias results for floating-point error accumulation which can
+                    // be visible with harshly quantized values
+                    static const XMVECTORF32 Bias = { { { 0.f, 0.f, 0.f, 0.1f } } };
+
+                    for (size_t x = 0; x < m_width; ++x)
+                    {
+                        accPtr[x] = XMVectorAdd(accPtr[x], Bias);
+                    }
+                }
+
+                HRESULT hr = emit(tap.dest, accPtr);
+                if (FAILED(hr))
+                    return hr;
+
+                // Put row on freelist to reuse it's allocated scanline
+                rowAcc->next = m_rowFree;
+                m_rowFree = rowAcc;
+            }
+
+            return S_OK;
+        }
+
+    private:
+        size_t                                  m_srcWidth;
+        size_t                                  m_srcHeight;
+        size_t                                  m_width;
+        size_t                                  m_height;
+
+        std::unique_ptr<FilterTap[]>            m_hTaps;
+        size_t                                  m_hTapCount;
+
+        std::unique_ptr<FilterTap[]>            m_vTaps;
+        std::unique_ptr<size_t[]>               m_vOffsets;
+
+        size_t                                  m_nextRow;
+        bool                                    m_bias;
+
+        ScopedAlignedArrayXMVECTOR              m_hrow;
+        std::unique_ptr<TriangleRow[]>          m_rows;
+        TriangleRow*                            m_rowFree;
+    };
+
+
+    //-------------------------------------------------------------------------------------
+    // Mipchain as a cascade of streaming resizers: every completed row of a level is
+    // quantized to the texture format, handed to the caller, then fed to the next level
+    //-------------------------------------------------------------------------------------
+    using MipWriteFunc = std::function<HRESULT __cdecl(_In_reads_bytes_(rowPitch) const uint8_t* pixels, size_t rowPitch, size_t level, size_t y)>;
+
+    struct StreamingMipLevel
+    {
+        StreamingResizer            resizer;
+        size_t                      rowPitch;
+        std::unique_ptr<uint8_t[]>  row;
+        ScopedAlignedArrayXMVECTOR  scanline;
+
+        StreamingMipLevel() noexcept : rowPitch(0) {}
+    };
+
+    class StreamingMipChain
+    {
+    public:
+        StreamingMipChain(DXGI_FORMAT format, TEX_FILTER_FLAGS filter, const MipWriteFunc& writeRow) noexcept :
+            m_format(format),
+            m_filter(filter),
+            m_levelCount(0),
+            m_writeRow(writeRow)
+        {
+        }
+
+        StreamingMipChain(const StreamingMipChain&) = delete;
+        StreamingMipChain& operator=(const StreamingMipChain&) = delete;
+
+        HRESULT Initialize(size_t width, size_t height, size_t levels, unsigned long filterSelect) noexcept
+        {
+            assert(levels > 1);
+
+            m_levels.reset(new (std::nothrow) StreamingMipLevel[levels - 1]);
+            if (!m_levels)
+                return E_OUTOFMEMORY;
+
+            m_levelCount = levels;
+
+            for (size_t level = 1; level < levels; ++level)
+            {
+                const size_t nwidth = (width > 1) ? (width >> 1) : 1;
+                const size_t nheight = (height > 1) ? (height >> 1) : 1;
+
+                auto& mip = m_levels[level - 1];
+
+                HRESULT hr = mip.resizer.Initialize(width, height, nwidth, nheight, m_format, filterSelect, m_filter);
+                if (FAILED(hr))
+                    return hr;
+
+                size_t slicePitch;
+                hr = ComputePitch(m_format, nwidth, 1, mip.rowPitch, slicePitch, CP_FLAGS_NONE);
+                if (FAILED(hr))
+                    return hr;
+
+                mip.row.reset(new (std::nothrow) uint8_t[mip.rowPitch]);
+                mip.scanline = make_AlignedArrayXMVECTOR(nwidth);
+                if (!mip.row || !mip.scanline)
+                    return E_OUTOFMEMORY;
+
+                width = nwidth;
+                height = nheight;
+            }
+
+            return S_OK;
+        }
+
+        // Pushes the next row of level - 1 into the resizer that produces level
+        HRESULT PushRow(size_t level, _In_ const XMVECTOR* row)
+        {
+            assert(level > 0 && level < m_levelCount);
+
+            auto& mip = m_levels[level - 1];
+
+            return mip.resizer.PushRow(row, [&](size_t y, XMVECTOR* pixels) -> HRESULT
+                {
+                    const size_t width = mip.resizer.GetWidth();
+
+                    // This performs any required clamping
+                    if (!StoreScanlineLinear(mip.row.get(), mip.rowPitch, m_format, pixels, width, m_filter))
+                        return E_FAIL;
+
+                    HRESULT hr = m_writeRow(mip.row.get(), mip.rowPitch, level, y);
+                    if (FAILED(hr))
+                        return hr;
+
+                    if ((level + 1) >= m_levelCount)
+                        return S_OK;
+
+                    // Each level is built from the quantized previous level, as GenerateMipMaps does
+                    if (!LoadScanlineLinear(mip.scanline.get(), width, mip.row.get(), mip.rowPitch, m_format, m_filter))
+                        return E_FAIL;
+
+                    return PushRow(level + 1, mip.scanline.get());
+                });
+        }
+
+    private:
+        DXGI_FORMAT                             m_format;
+        TEX_FILTER_FLAGS                        m_filter;
+        size_t                                  m_levelCount;
+        const MipWriteFunc&                     m_writeRow;
+        std::unique_ptr<StreamingMipLevel[]>    m_levels;
+    };
+
+
+    HRESULT ValidateStreamingFormat(DXGI_FORMAT format) noexcept
+    {
+        if (!IsValid(format))
+            return E_INVALIDARG;
+
+        if (IsCompressed(format) || IsTypeless(format) || IsPlanar(format) || IsPalettized(format))
+            return HRESULT_E_NOT_SUPPORTED;
+
+        return S_OK;
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+//-------------------------------------------------------------------------------------
+// Resize an image streamed by scanline
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::ResizeStreaming(
+    size_t srcWidth,
+    size_t srcHeight,
+    DXGI_FORMAT format,
+    size_t width,
+    size_t height,
+    TEX_FILTER_FLAGS filter,
+    std::function<HRESULT __cdecl(uint8_t* pixels, size_t rowPitch, size_t y)> readRow,
+    std::function<HRESULT __cdecl(const uint8_t* pixels, size_t rowPitch, size_t y)> writeRow)
+{
+    if (!srcWidth || !srcHeight || !width || !height)
+        return E_INVALIDARG;
+
+    if ((srcWidth > UINT32_MAX) || (srcHeight > UINT32_MAX))
+        return E_INVALIDARG;
+
+    if ((width > UINT32_MAX) || (height > UINT32_MAX))
+        return E_INVALIDARG;
+
+    if (!readRow || !writeRow)
+        return E_INVALIDARG;
+
+    HRESULT hr = ValidateStreamingFormat(format);
+    if (FAILED(hr))
+        return hr;
+
+    if (filter & TEX_FILTER_WRAP_V)
+    {
+        // Wrapping would complete the first rows last, which requires the whole destination in memory
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    static_assert(TEX_FILTER_POINT == 0x100000, "TEX_FILTER_ flag values don't match TEX_FILTER_MODE_MASK");
+
+    unsigned long filter_select = filter & TEX_FILTER_MODE_MASK;
+    if (!filter_select)
+    {
+        // Default filter choice
+        filter_select = (((width << 1) == srcWidth) && ((height << 1) == srcHeight))
+            ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
+    }
+
+    StreamingResizer resizer;
+    hr = resizer.Initialize(srcWidth, srcHeight, width, height, format, filter_select, filter);
+    if (FAILED(hr))
+        return hr;
+
+    size_t srcRowPitch, rowPitch, slicePitch;
+    hr = ComputePitch(format, srcWidth, 1, srcRowPitch, slicePitch, CP_FLAGS_NONE);
+    if (FAILED(hr))
+        return hr;
+
+    hr = ComputePitch(format, width, 1, rowPitch, slicePitch, CP_FLAGS_NONE);
+    if (FAILED(hr))
+        return hr;
+
+    std::unique_ptr<uint8_t[]> srcRow(new (std::nothrow) uint8_t[srcRowPitch]);
+    std::unique_ptr<uint8_t[]> destRow(new (std::nothrow) uint8_t[rowPitch]);
+    auto scanline = make_AlignedArrayXMVECTOR(srcWidth);
+    if (!srcRow || !destRow || !scanline)
+        return E_OUTOFMEMORY;
+
+    for (size_t y = 0; y < srcHeight; ++y)
+    {
+        hr = readRow(srcRow.get(), srcRowPitch, y);
+        if (FAILED(hr))
+            return hr;
+
+        if (!LoadScanlineLinear(scanline.get(), srcWidth, srcRow.get(), srcRowPitch, format, filter))
+            return E_FAIL;
+
+        hr = resizer.PushRow(scanline.get(), [&](size_t v, XMVECTOR* pixels) -> HRESULT
+            {
+                // This performs any required clamping
+                if (!StoreScanlineLinear(destRow.get(), rowPitch, format, pixels, width, filter))
+                    return E_FAIL;
+
+                return writeRow(destRow.get(), rowPitch, v);
+            });
+        if (FAILED(hr))
+            return hr;
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Generate mipmap chain for an image streamed by scanline
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::GenerateMipMapsStreaming(
+    size_t width,
+    size_t height,
+    DXGI_FORMAT format,
+    TEX_FILTER_FLAGS filter,
+    size_t levels,
+    std::function<HRESULT __cdecl(uint8_t* pixels, size_t rowPitch, size_t y)> readRow,
+    std::function<HRESULT __cdecl(const uint8_t* pixels, size_t rowPitch, size_t level, size_t y)> writeRow)
+{
+    if (!width || !height)
+        return E_INVALIDARG;
+
+    if ((width > UINT32_MAX) || (height > UINT32_MAX))
+        return E_INVALIDARG;
+
+    if (!readRow || !writeRow)
+        return E_INVALIDARG;
+
+    if (!CalculateMipLevels(width, height, levels))
+        return E_INVALIDARG;
+
+    if (levels <= 1)
+        return E_INVALIDARG;
+
+    HRESULT hr = ValidateStreamingFormat(format);
+    if (FAILED(hr))
+        return hr;
+
+    if (filter & TEX_FILTER_WRAP_V)
+    {
+        // Wrapping would complete the first row of each level last, which requires the whole level in memory
+        return HRESULT_E_NOT_SUPPORTED;
+    }
+
+    unsigned long filter_select = (filter & TEX_FILTER_MODE_MASK);
+    if (!filter_select)
+    {
+        // Default filter choice
+        filter_select = (ispow2(width) && ispow2(height)) ? TEX_FILTER_BOX : TEX_FILTER_LINEAR;
+    }
+
+    StreamingMipChain chain(format, filter, writeRow);
+    hr = chain.Initialize(width, height, levels, filter_select);
+    if (FAILED(hr))
+        return hr;
+
+    size_t rowPitch, slicePitch;
+    hr = ComputePitch(format, width, 1, rowPitch, slicePitch, CP_FLAGS_NONE);
+    if (FAILED(hr))
+        return hr;
+
+    std::unique_ptr<uint8_t[]> srcRow(new (std::nothrow) uint8_t[rowPitch]);
+    auto scanline = make_AlignedArrayXMVECTOR(width);
+    if (!srcRow || !scanline)
+        return E_OUTOFMEMORY;
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        hr = readRow(srcRow.get(), rowPitch, y);
+        if (FAILED(hr))
+            return hr;
+
+        if (!LoadScanlineLinear(scanline.get(), width, srcRow.get(), rowPitch, format, filter))
+            return E_FAIL;
+
+        hr = chain.PushRow(1, scanline.get());
+        if (FAILED(hr))
+            return hr;
+    }
+
+    return S_OK;
+}
@@ -17,7 +17,7 @@
 //      * Interleaved files are not supported (deprecated aspect of TGA format)
 //      * Only supports 8-bit grayscale; 16-, 24-, and 32-bit truecolor images RLE or uncompressed
 //        plus 24-bit color-mapped uncompressed images
-//      * Always writes uncompressed files (i.e. can read RLE compression, but does not write it)
+//      * Writes uncompressed files unless TGA_FLAGS_RLE is given
 //
 
 using namespace DirectX;
@@ -385,542 +385,445 @@ namespace
 
 
     //-------------------------------------------------------------------------------------
-    // Uncompress pixel data from a TGA into the target image
+    // Describes how TGA pixels map to the target image format
     //-------------------------------------------------------------------------------------
-    HRESULT UncompressPixels(
-        _In_reads_bytes_(size) const void* pSource,
-        size_t size,
-        TGA_FLAGS flags,
-        _In_ const Image* image,
-        _In_ uint32_t convFlags) noexcept
+    struct TGAPixelLayout
     {
-        assert(pSource && size > 0);
+        size_t      srcBytes;   // Bytes per pixel in the TGA data
+        size_t      dstBytes;   // Bytes per pixel in the image
+        bool        swizzle;    // BGR(A) -> RGB(A)
+        bool        trackAlpha; // Alpha range is used to detect all-zero or all-opaque alpha
+        uint32_t    fillAlpha;  // Alpha for pixels expanded from 24bpp
+    };
 
-        if (!image || !image->pixels)
-            return E_POINTER;
+    bool GetPixelLayout(DXGI_FORMAT format, uint32_t convFlags, TGAPixelLayout& layout) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8_UNORM:
+            layout = { 1, 1, false, false, 0 };
+            return true;
 
-        // Compute TGA image data pitch
-        size_t rowPitch, slicePitch;
-        HRESULT hr = ComputePitch(image->format, image->width, image->height, rowPitch, slicePitch,
-            (convFlags & CONV_FLAGS_EXPAND) ? CP_FLAGS_24BPP : CP_FLAGS_NONE);
-        if (FAILED(hr))
-            return hr;
+        case DXGI_FORMAT_B5G5R5A1_UNORM:
+            layout = { 2, 2, false, true, 0 };
+            return true;
 
-        auto sPtr = static_cast<const uint8_t*>(pSource);
-        const uint8_t* endPtr = sPtr + size;
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            if (convFlags & CONV_FLAGS_EXPAND)
+            {
+                layout = { 3, 4, true, false, 0xFF000000 };
+            }
+            else
+            {
+                layout = { 4, 4, true, true, 0 };
+            }
+            return true;
 
-        bool opaquealpha = false;
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            assert((convFlags & CONV_FLAGS_EXPAND) == 0);
+            layout = { 4, 4, false, true, 0 };
+            return true;
 
-        switch (image->format)
-        {
-        //--------------------------------------------------------------------------- 8-bit
-        case DXGI_FORMAT_R8_UNORM:
-            for (size_t y = 0; y < image->height; ++y)
-            {
-                size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-                assert(offset < rowPitch);
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            assert((convFlags & CONV_FLAGS_EXPAND) != 0);
+            layout = { 3, 4, false, false, 0 };
+            return true;
 
-                uint8_t* dPtr = image->pixels
-                    + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1)))
-                    + offset;
+        default:
+            return false;
+        }
+    }
 
-                for (size_t x = 0; x < image->width; )
-                {
-                    if (sPtr >= endPtr)
-                        return E_FAIL;
+    struct AlphaRange
+    {
+        uint32_t minalpha;
+        uint32_t maxalpha;
+    };
 
-                    if (*sPtr & 0x80)
-                    {
-                        // Repeat
-                        size_t j = size_t(*sPtr & 0x7F) + 1;
-                        if (++sPtr >= endPtr)
-                            return E_FAIL;
+    constexpr AlphaRange c_EmptyAlphaRange = { 255, 0 };
 
-                        for (; j > 0; --j, ++x)
-                        {
-                            if (x >= image->width)
-                                return E_FAIL;
 
-                            *dPtr = *sPtr;
+    //-------------------------------------------------------------------------------------
+    // Converts a span of TGA pixels into the target format
+    //-------------------------------------------------------------------------------------
+    void Copy16bppPixels(
+        _Out_writes_(count) uint16_t* __restrict dPtr,
+        _In_reads_bytes_(count * 2) const uint8_t* __restrict sPtr,
+        size_t count,
+        AlphaRange& alpha) noexcept
+    {
+        memcpy(dPtr, sPtr, count * sizeof(uint16_t));
 
-                            if (convFlags & CONV_FLAGS_INVERTX)
-                                --dPtr;
-                            else
-                                ++dPtr;
-                        }
+        uint32_t allBits = 0xFFFF;
+        uint32_t anyBits = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            allBits &= dPtr[i];
+            anyBits |= dPtr[i];
+        }
 
-                        ++sPtr;
-                    }
-                    else
-                    {
-                        // Literal
-                        size_t j = size_t(*sPtr & 0x7F) + 1;
-                        ++sPtr;
+        if (anyBits & 0x8000)
+            alpha.maxalpha = 255;
+        if (!(allBits & 0x8000))
+            alpha.minalpha = 0;
+    }
 
-                        if (sPtr + j > endPtr)
-                            return E_FAIL;
+    void Expand24bppPixels(
+        _Out_writes_(count) uint32_t* __restrict dPtr,
+        _In_reads_bytes_(count * 3) const uint8_t* __restrict sPtr,
+        size_t count,
+        bool swizzle,
+        uint32_t fillAlpha) noexcept
+    {
+        size_t i = 0;
 
-                        for (; j > 0; --j, ++x)
-                        {
-                            if (x >= image->width)
-                                return E_FAIL;
+    #if defined(_XM_SSE4_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        // Four pixels per iteration, but each 16-byte load reads a pixel and a third past them
+        const __m128i shuffle = swizzle
+            ? _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1)
+            : _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m128i fill = _mm_set1_epi32(static_cast<int>(fillAlpha));
 
-                            *dPtr = *(sPtr++);
+        for (; i + 6 <= count; i += 4)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr + i * 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr + i), _mm_or_si128(_mm_shuffle_epi8(v, shuffle), fill));
+        }
+    #endif
 
-                            if (convFlags & CONV_FLAGS_INVERTX)
-                                --dPtr;
-                            else
-                                ++dPtr;
-                        }
-                    }
-                }
+        for (; i < count; ++i)
+        {
+            const uint8_t* s = sPtr + i * 3;
+            if (swizzle)
+            {
+                // BGR -> RGBA
+                dPtr[i] = uint32_t(s[0] << 16) | uint32_t(s[1] << 8) | uint32_t(s[2]) | fillAlpha;
             }
-            break;
-
-        //-------------------------------------------------------------------------- 16-bit
-        case DXGI_FORMAT_B5G5R5A1_UNORM:
+            else
             {
-                uint32_t minalpha = 255;
-                uint32_t maxalpha = 0;
+                dPtr[i] = uint32_t(s[0]) | uint32_t(s[1] << 8) | uint32_t(s[2] << 16) | fillAlpha;
+            }
+        }
+    }
 
-                for (size_t y = 0; y < image->height; ++y)
-                {
-                    size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-                    assert(offset * 2 < rowPitch);
+    void Copy32bppPixels(
+        _Out_writes_(count) uint32_t* __restrict dPtr,
+        _In_reads_bytes_(count * 4) const uint8_t* __restrict sPtr,
+        size_t count,
+        bool swizzle,
+        AlphaRange& alpha) noexcept
+    {
+        size_t i = 0;
 
-                    auto dPtr = reinterpret_cast<uint16_t*>(image->pixels
-                        + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                        + offset;
+    #if defined(_XM_SSE_INTRINSICS_) && !defined(_XM_NO_INTRINSICS_)
+        if (count >= 4)
+        {
+            const __m128i rbMask = _mm_set1_epi32(0x00FF00FF);
+            const __m128i alphaMask = _mm_set1_epi32(static_cast<int>(0xFF000000));
+            const __m128i colorMask = _mm_set1_epi32(0x00FFFFFF);
 
-                    for (size_t x = 0; x < image->width; )
-                    {
-                        if (sPtr >= endPtr)
-                            return E_FAIL;
-
-                        if (*sPtr & 0x80)
-                        {
-                            // Repeat
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
-
-                            if (sPtr + 1 >= endPtr)
-                                return E_FAIL;
-
-                            auto t = static_cast<uint16_t>(uint32_t(*sPtr) | uint32_t(*(sPtr + 1u) << 8));
-
-                            const uint32_t alpha = (t & 0x8000) ? 255 : 0;
-                            minalpha = std::min(minalpha, alpha);
-                            maxalpha = std::max(maxalpha, alpha);
-
-                            sPtr += 2;
-
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
-
-                                *dPtr = t;
-
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                        else
-                        {
-                            // Literal
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
-
-                            if (sPtr + (j * 2) > endPtr)
-                                return E_FAIL;
-
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
-
-                                auto t = static_cast<uint16_t>(uint32_t(*sPtr) | uint32_t(*(sPtr + 1u) << 8));
-
-                                const uint32_t alpha = (t & 0x8000) ? 255 : 0;
-                                minalpha = std::min(minalpha, alpha);
-                                maxalpha = std::max(maxalpha, alpha);
-
-                                sPtr += 2;
-                                *dPtr = t;
-
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                    }
-                }
+            // Alpha range is tracked per byte, with the color bytes forced to not affect it
+            __m128i amin = _mm_set1_epi32(-1);
+            __m128i amax = _mm_setzero_si128();
 
-                // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-                if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-                {
-                    opaquealpha = true;
-                    hr = SetAlphaChannelToOpaque(image);
-                    if (FAILED(hr))
-                        return hr;
-                }
-                else if (minalpha == 255)
+            for (; i + 4 <= count; i += 4)
+            {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(sPtr + i * 4));
+                if (swizzle)
                 {
-                    opaquealpha = true;
+                    // BGRA -> RGBA
+                    const __m128i rb = _mm_and_si128(v, rbMask);
+                    v = _mm_or_si128(_mm_andnot_si128(rbMask, v),
+                        _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16)));
                 }
+
+                amin = _mm_min_epu8(amin, _mm_or_si128(v, colorMask));
+                amax = _mm_max_epu8(amax, _mm_and_si128(v, alphaMask));
+
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dPtr + i), v);
             }
-            break;
 
-            //------------------------------------------------------ 24/32-bit (with swizzling)
-        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            XM_ALIGNED_DATA(16) uint32_t lanes[8];
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_srli_epi32(amin, 24));
+            _mm_store_si128(reinterpret_cast<__m128i*>(lanes + 4), _mm_srli_epi32(amax, 24));
+
+            for (size_t j = 0; j < 4; ++j)
             {
-                uint32_t minalpha = 255;
-                uint32_t maxalpha = 0;
+                alpha.minalpha = std::min(alpha.minalpha, lanes[j]);
+                alpha.maxalpha = std::max(alpha.maxalpha, lanes[j + 4]);
+            }
+        }
+    #endif
 
-                for (size_t y = 0; y < image->height; ++y)
-                {
-                    size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
+        for (; i < count; ++i)
+        {
+            uint32_t t;
+            memcpy(&t, sPtr + i * 4, sizeof(t));
 
-                    auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                        + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                        + offset;
+            if (swizzle)
+            {
+                // BGRA -> RGBA
+                t = (t & 0xFF00FF00) | ((t & 0xFF) << 16) | ((t >> 16) & 0xFF);
+            }
 
-                    for (size_t x = 0; x < image->width; )
-                    {
-                        if (sPtr >= endPtr)
-                            return E_FAIL;
-
-                        if (*sPtr & 0x80)
-                        {
-                            // Repeat
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
-
-                            uint32_t t;
-                            if (convFlags & CONV_FLAGS_EXPAND)
-                            {
-                                assert(offset * 3 < rowPitch);
-
-                                if (sPtr + 2 >= endPtr)
-                                    return E_FAIL;
-
-                                // BGR -> RGBA
-                                t = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | 0xFF000000;
-                                sPtr += 3;
-
-                                minalpha = maxalpha = 255;
-                            }
-                            else
-                            {
-                                assert(offset * 4 < rowPitch);
-
-                                if (sPtr + 3 >= endPtr)
-                                    return E_FAIL;
-
-                                // BGRA -> RGBA
-                                const uint32_t alpha = *(sPtr + 3);
-                                t = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | uint32_t(alpha << 24);
-
-                                minalpha = std::min(minalpha, alpha);
-                                maxalpha = std::max(maxalpha, alpha);
-
-                                sPtr += 4;
-                            }
-
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
-
-                                *dPtr = t;
-
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                        else
-                        {
-                            // Literal
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
-
-                            if (convFlags & CONV_FLAGS_EXPAND)
-                            {
-                                if (sPtr + (j * 3) > endPtr)
-                                    return E_FAIL;
-                            }
-                            else
-                            {
-                                if (sPtr + (j * 4) > endPtr)
-                                    return E_FAIL;
-                            }
-
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
-
-                                if (convFlags & CONV_FLAGS_EXPAND)
-                                {
-                                    assert(offset * 3 < rowPitch);
-
-                                    if (sPtr + 2 >= endPtr)
-                                        return E_FAIL;
-
-                                    // BGR -> RGBA
-                                    *dPtr = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | 0xFF000000;
-                                    sPtr += 3;
-
-                                    minalpha = maxalpha = 255;
-                                }
-                                else
-                                {
-                                    assert(offset * 4 < rowPitch);
-
-                                    if (sPtr + 3 >= endPtr)
-                                        return E_FAIL;
-
-                                    // BGRA -> RGBA
-                                    uint32_t alpha = *(sPtr + 3);
-                                    *dPtr = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | uint32_t(alpha << 24);
-
-                                    minalpha = std::min(minalpha, alpha);
-                                    maxalpha = std::max(maxalpha, alpha);
-
-                                    sPtr += 4;
-                                }
-
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                    }
-                }
+            const uint32_t a = t >> 24;
+            alpha.minalpha = std::min(alpha.minalpha, a);
+            alpha.maxalpha = std::max(alpha.maxalpha, a);
 
-                // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-                if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-                {
-                    opaquealpha = true;
-                    hr = SetAlphaChannelToOpaque(image);
-                    if (FAILED(hr))
-                        return hr;
-                }
-                else if (minalpha == 255)
-                {
-                    opaquealpha = true;
-                }
-            }
+            dPtr[i] = t;
+        }
+    }
+
+    void ConvertPixels(
+        _Out_ uint8_t* dPtr,
+        _In_ const uint8_t* sPtr,
+        size_t count,
+        const TGAPixelLayout& layout,
+        AlphaRange& alpha) noexcept
+    {
+        switch (layout.srcBytes)
+        {
+        case 1:
+            memcpy(dPtr, sPtr, count);
             break;
 
-            //-------------------------------------------------------------------- 32-bit (BGR)
-        case DXGI_FORMAT_B8G8R8A8_UNORM:
-            {
-                assert((convFlags & CONV_FLAGS_EXPAND) == 0);
+        case 2:
+            Copy16bppPixels(reinterpret_cast<uint16_t*>(dPtr), sPtr, count, alpha);
+            break;
 
-                uint32_t minalpha = 255;
-                uint32_t maxalpha = 0;
+        case 3:
+            Expand24bppPixels(reinterpret_cast<uint32_t*>(dPtr), sPtr, count, layout.swizzle, layout.fillAlpha);
+            break;
 
-                for (size_t y = 0; y < image->height; ++y)
-                {
-                    size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
+        default:
+            Copy32bppPixels(reinterpret_cast<uint32_t*>(dPtr), sPtr, count, layout.swizzle, alpha);
+            break;
+        }
+    }
 
-                    auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                        + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                        + offset;
+    void FillPixels(
+        _Out_ uint8_t* dPtr,
+        _In_ const uint8_t* sPtr,
+        size_t count,
+        const TGAPixelLayout& layout,
+        AlphaRange& alpha) noexcept
+    {
+        uint8_t pixel[4] = {};
+        ConvertPixels(pixel, sPtr, 1, layout, alpha);
 
-                    for (size_t x = 0; x < image->width; )
-                    {
-                        if (sPtr >= endPtr)
-                            return E_FAIL;
+        switch (layout.dstBytes)
+        {
+        case 1:
+            memset(dPtr, pixel[0], count);
+            break;
 
-                        if (*sPtr & 0x80)
-                        {
-                            // Repeat
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
+        case 2:
+            {
+                uint16_t t;
+                memcpy(&t, pixel, sizeof(t));
+                std::fill_n(reinterpret_cast<uint16_t*>(dPtr), count, t);
+            }
+            break;
+
+        default:
+            {
+                uint32_t t;
+                memcpy(&t, pixel, sizeof(t));
+                std::fill_n(reinterpret_cast<uint32_t*>(dPtr), count, t);
+            }
+            break;
+        }
+    }
 
-                            assert(offset * 4 < rowPitch);
 
-                            if (sPtr + 3 >= endPtr)
-                                return E_FAIL;
+    //-------------------------------------------------------------------------------------
+    // RLE packets do not cross scanlines, so each scanline decodes independently once
+    // its starting offset is known. Returns the start of the next scanline or nullptr.
+    //-------------------------------------------------------------------------------------
+    const uint8_t* SkipRLEScanline(
+        _In_ const uint8_t* sPtr,
+        _In_ const uint8_t* endPtr,
+        size_t width,
+        size_t srcBytes) noexcept
+    {
+        for (size_t x = 0; x < width; )
+        {
+            if (sPtr >= endPtr)
+                return nullptr;
 
-                            const uint32_t alpha = *(sPtr + 3);
+            const size_t j = size_t(*sPtr & 0x7F) + 1;
+            if (j > width - x)
+                return nullptr;
 
-                            auto t = *reinterpret_cast<const uint32_t*>(sPtr);
+            const size_t bytes = (*sPtr & 0x80) ? srcBytes : (j * srcBytes);
+            ++sPtr;
 
-                            minalpha = std::min(minalpha, alpha);
-                            maxalpha = std::max(maxalpha, alpha);
+            if (bytes > size_t(endPtr - sPtr))
+                return nullptr;
 
-                            sPtr += 4;
+            sPtr += bytes;
+            x += j;
+        }
 
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
+        return sPtr;
+    }
 
-                                *dPtr = t;
+    const uint8_t* DecodeRLEScanline(
+        _Out_ uint8_t* dPtr,
+        _In_ const uint8_t* sPtr,
+        _In_ const uint8_t* endPtr,
+        size_t width,
+        const TGAPixelLayout& layout,
+        AlphaRange& alpha) noexcept
+    {
+        for (size_t x = 0; x < width; )
+        {
+            if (sPtr >= endPtr)
+                return nullptr;
 
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                        else
-                        {
-                            // Literal
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
+            const size_t j = size_t(*sPtr & 0x7F) + 1;
+            if (j > width - x)
+                return nullptr;
 
-                            if (sPtr + (j * 4) > endPtr)
-                                return E_FAIL;
+            if (*(sPtr++) & 0x80)
+            {
+                // Repeat
+                if (layout.srcBytes > size_t(endPtr - sPtr))
+                    return nullptr;
 
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
+                FillPixels(dPtr + x * layout.dstBytes, sPtr, j, layout, alpha);
+                sPtr += layout.srcBytes;
+            }
+            else
+            {
+                // Literal
+                if (j * layout.srcBytes > size_t(endPtr - sPtr))
+                    return nullptr;
 
-                                assert(offset * 4 < rowPitch);
+                ConvertPixels(dPtr + x * layout.dstBytes, sPtr, j, layout, alpha);
+                sPtr += j * layout.srcBytes;
+            }
 
-                                if (sPtr + 3 >= endPtr)
-                                    return E_FAIL;
+            x += j;
+        }
 
-                                const uint32_t alpha = *(sPtr + 3);
-                                *dPtr = *reinterpret_cast<const uint32_t*>(sPtr);
+        return sPtr;
+    }
 
-                                minalpha = std::min(minalpha, alpha);
-                                maxalpha = std::max(maxalpha, alpha);
 
-                                sPtr += 4;
+    //-------------------------------------------------------------------------------------
+    // Runs a scanline decoder over the image, in bands of rows across threads if requested
+    //-------------------------------------------------------------------------------------
+    constexpr size_t TGA_ROWS_PER_BAND = 64;
+
+    template<typename TDecodeRow>
+    HRESULT DecodeScanlines(
+        const Image& image,
+        uint32_t convFlags,
+        size_t dstBytes,
+        bool parallel,
+        AlphaRange& alpha,
+        TDecodeRow&& decodeRow) noexcept
+    {
+        auto processRow = [&](size_t y, AlphaRange& range) noexcept -> bool
+        {
+            uint8_t* dPtr = image.pixels
+                + (image.rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image.height - y - 1)));
 
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                    }
-                }
+            if (!decodeRow(y, dPtr, range))
+                return false;
 
-                // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-                if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-                {
-                    opaquealpha = true;
-                    hr = SetAlphaChannelToOpaque(image);
-                    if (FAILED(hr))
-                        return hr;
-                }
-                else if (minalpha == 255)
+            if (convFlags & CONV_FLAGS_INVERTX)
+            {
+                switch (dstBytes)
                 {
-                    opaquealpha = true;
+                case 1: std::reverse(dPtr, dPtr + image.width); break;
+                case 2: std::reverse(reinterpret_cast<uint16_t*>(dPtr), reinterpret_cast<uint16_t*>(dPtr) + image.width); break;
+                default: std::reverse(reinterpret_cast<uint32_t*>(dPtr), reinterpret_cast<uint32_t*>(dPtr) + image.width); break;
                 }
             }
-            break;
 
-            //-------------------------------------------------------------------- 24-bit (BGR)
-        case DXGI_FORMAT_B8G8R8X8_UNORM:
+            return true;
+        };
+
+        if (!parallel || image.height <= TGA_ROWS_PER_BAND)
+        {
+            for (size_t y = 0; y < image.height; ++y)
             {
-                assert((convFlags & CONV_FLAGS_EXPAND) != 0);
+                if (!processRow(y, alpha))
+                    return E_FAIL;
+            }
 
-                for (size_t y = 0; y < image->height; ++y)
-                {
-                    size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
+            return S_OK;
+        }
 
-                    auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                        + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                        + offset;
+        const size_t bandCount = (image.height + TGA_ROWS_PER_BAND - 1) / TGA_ROWS_PER_BAND;
 
-                    for (size_t x = 0; x < image->width; )
-                    {
-                        if (sPtr >= endPtr)
-                            return E_FAIL;
-
-                        if (*sPtr & 0x80)
-                        {
-                            // Repeat
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
-
-                            assert(offset * 3 < rowPitch);
-
-                            if (sPtr + 2 >= endPtr)
-                                return E_FAIL;
-
-                            uint32_t t = uint32_t(*sPtr) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2) << 16);
-                            sPtr += 3;
-
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
-
-                                *dPtr = t;
-
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                        else
-                        {
-                            // Literal
-                            size_t j = size_t(*sPtr & 0x7F) + 1;
-                            ++sPtr;
-
-                            if (sPtr + (j * 3) > endPtr)
-                                return E_FAIL;
-
-                            for (; j > 0; --j, ++x)
-                            {
-                                if (x >= image->width)
-                                    return E_FAIL;
-
-                                assert(offset * 3 < rowPitch);
-
-                                if (sPtr + 2 >= endPtr)
-                                    return E_FAIL;
-
-                                *dPtr = uint32_t(*sPtr) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2) << 16);
-                                sPtr += 3;
-
-                                if (convFlags & CONV_FLAGS_INVERTX)
-                                    --dPtr;
-                                else
-                                    ++dPtr;
-                            }
-                        }
-                    }
+        std::unique_ptr<AlphaRange[]> ranges(new (std::nothrow) AlphaRange[bandCount]);
+        if (!ranges)
+            return E_OUTOFMEMORY;
+
+        HRESULT hr = ParallelFor(bandCount, 0, [&](size_t band, size_t) noexcept -> bool
+            {
+                ranges[band] = c_EmptyAlphaRange;
+
+                const size_t y1 = std::min(image.height, (band + 1) * TGA_ROWS_PER_BAND);
+                for (size_t y = band * TGA_ROWS_PER_BAND; y < y1; ++y)
+                {
+                    if (!processRow(y, ranges[band]))
+                        return false;
                 }
-            }
-            break;
 
-            //---------------------------------------------------------------------------------
-        default:
-            return E_FAIL;
+                return true;
+            });
+        if (FAILED(hr))
+            return hr;
+
+        for (size_t band = 0; band < bandCount; ++band)
+        {
+            alpha.minalpha = std::min(alpha.minalpha, ranges[band].minalpha);
+            alpha.maxalpha = std::max(alpha.maxalpha, ranges[band].maxalpha);
         }
 
-        return opaquealpha ? S_FALSE : S_OK;
+        return S_OK;
     }
 
 
     //-------------------------------------------------------------------------------------
-    // Copies pixel data from a TGA into the target image
+    // Returns S_FALSE if the decoded image has opaque alpha
     //-------------------------------------------------------------------------------------
-    HRESULT CopyPixels(
+    HRESULT ResolveAlpha(
+        _In_ const Image* image,
+        TGA_FLAGS flags,
+        const TGAPixelLayout& layout,
+        const AlphaRange& alpha) noexcept
+    {
+        if (!layout.trackAlpha)
+            return (layout.fillAlpha) ? S_FALSE : S_OK;
+
+        // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
+        if (alpha.maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
+        {
+            const HRESULT hr = SetAlphaChannelToOpaque(image);
+            if (FAILED(hr))
+                return hr;
+
+            return S_FALSE;
+        }
+
+        return (alpha.minalpha == 255) ? S_FALSE : S_OK;
+    }
+
+
+    //-------------------------------------------------------------------------------------
+    // Uncompress pixel data from a TGA into the target image
+    //-------------------------------------------------------------------------------------
+    HRESULT UncompressPixels(
         _In_reads_bytes_(size) const void* pSource,
         size_t size,
         TGA_FLAGS flags,
         _In_ const Image* image,
-        _In_ uint32_t convFlags,
-        _In_opt_ const uint8_t* palette) noexcept
+        _In_ uint32_t convFlags) noexcept
     {
         assert(pSource && size > 0);
 
@@ -929,294 +832,136 @@ namespace
 
         // Compute TGA image data pitch
         size_t rowPitch, slicePitch;
-        HRESULT hr = ComputePitch(image->format, image->width, image->height,
-            rowPitch, slicePitch,
+        HRESULT hr = ComputePitch(image->format, image->width, image->height, rowPitch, slicePitch,
             (convFlags & CONV_FLAGS_EXPAND) ? CP_FLAGS_24BPP : CP_FLAGS_NONE);
         if (FAILED(hr))
             return hr;
 
+        TGAPixelLayout layout;
+        if (!GetPixelLayout(image->format, convFlags, layout))
+            return E_FAIL;
+
         auto sPtr = static_cast<const uint8_t*>(pSource);
         const uint8_t* endPtr = sPtr + size;
 
-        bool opaquealpha = false;
+        AlphaRange alpha = c_EmptyAlphaRange;
 
-        if ((convFlags & CONV_FLAGS_PALETTED) != 0)
+        if ((flags & TGA_FLAGS_PARALLEL) && image->height > TGA_ROWS_PER_BAND)
         {
-            if (!palette)
-                return E_UNEXPECTED;
-
-            const auto table = reinterpret_cast<const uint32_t*>(palette);
+            // Only the packet headers are read to find where each scanline starts
+            std::unique_ptr<const uint8_t*[]> rows(new (std::nothrow) const uint8_t*[image->height]);
+            if (!rows)
+                return E_OUTOFMEMORY;
 
             for (size_t y = 0; y < image->height; ++y)
             {
-                size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-                assert(offset < rowPitch);
-
-                auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                    + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                    + offset;
+                rows[y] = sPtr;
+                sPtr = SkipRLEScanline(sPtr, endPtr, image->width, layout.srcBytes);
+                if (!sPtr)
+                    return E_FAIL;
+            }
 
-                for (size_t x = 0; x < image->width; ++x)
+            hr = DecodeScanlines(*image, convFlags, layout.dstBytes, true, alpha,
+                [&](size_t y, uint8_t* dPtr, AlphaRange& range) noexcept -> bool
                 {
-                    if (sPtr >= endPtr)
-                        return E_FAIL;
-
-                    *dPtr = table[*(sPtr++)];
-
-                    if (convFlags & CONV_FLAGS_INVERTX)
-                        --dPtr;
-                    else
-                        ++dPtr;
-                }
-            }
+                    return DecodeRLEScanline(dPtr, rows[y], endPtr, image->width, layout, range) != nullptr;
+                });
         }
         else
         {
-            switch (image->format)
-            {
-            //----------------------------------------------------------------------- 8-bit
-            case DXGI_FORMAT_R8_UNORM:
-                for (size_t y = 0; y < image->height; ++y)
+            hr = DecodeScanlines(*image, convFlags, layout.dstBytes, false, alpha,
+                [&](size_t, uint8_t* dPtr, AlphaRange& range) noexcept -> bool
                 {
-                    size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-                    assert(offset < rowPitch);
-
-                    uint8_t* dPtr = image->pixels
-                        + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1)))
-                        + offset;
-
-                    for (size_t x = 0; x < image->width; ++x)
-                    {
-                        if (sPtr >= endPtr)
-                            return E_FAIL;
-
-                        *dPtr = *(sPtr++);
-
-                        if (convFlags & CONV_FLAGS_INVERTX)
-                            --dPtr;
-                        else
-                            ++dPtr;
-                    }
-                }
-                break;
-
-            //---------------------------------------------------------------------- 16-bit
-            case DXGI_FORMAT_B5G5R5A1_UNORM:
-                {
-                    uint32_t minalpha = 255;
-                    uint32_t maxalpha = 0;
-
-                    for (size_t y = 0; y < image->height; ++y)
-                    {
-                        size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-                        assert(offset * 2 < rowPitch);
-
-                        auto dPtr = reinterpret_cast<uint16_t*>(image->pixels
-                            + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                            + offset;
-
-                        for (size_t x = 0; x < image->width; ++x)
-                        {
-                            if (sPtr + 1 >= endPtr)
-                                return E_FAIL;
-
-                            auto t = static_cast<uint16_t>(uint32_t(*sPtr) | uint32_t(*(sPtr + 1u) << 8));
-                            sPtr += 2;
-                            *dPtr = t;
-
-                            const uint32_t alpha = (t & 0x8000) ? 255 : 0;
-                            minalpha = std::min(minalpha, alpha);
-                            maxalpha = std::max(maxalpha, alpha);
-
-                            if (convFlags & CONV_FLAGS_INVERTX)
-                                --dPtr;
-                            else
-                                ++dPtr;
-                        }
-                    }
-
-                    // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-                    if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-                    {
-                        opaquealpha = true;
-                        hr = SetAlphaChannelToOpaque(image);
-                        if (FAILED(hr))
-                            return hr;
-                    }
-                    else if (minalpha == 255)
-                    {
-                        opaquealpha = true;
-                    }
-                }
-                break;
-
-            //-------------------------------------------------- 24/32-bit (with swizzling)
-            case DXGI_FORMAT_R8G8B8A8_UNORM:
-                {
-                    uint32_t minalpha = 255;
-                    uint32_t maxalpha = 0;
-
-                    for (size_t y = 0; y < image->height; ++y)
-                    {
-                        size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
+                    sPtr = DecodeRLEScanline(dPtr, sPtr, endPtr, image->width, layout, range);
+                    return sPtr != nullptr;
+                });
+        }
 
-                        auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                            + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                            + offset;
+        if (FAILED(hr))
+            return hr;
 
-                        for (size_t x = 0; x < image->width; ++x)
-                        {
-                            if (convFlags & CONV_FLAGS_EXPAND)
-                            {
-                                assert(offset * 3 < rowPitch);
+        return ResolveAlpha(image, flags, layout, alpha);
+    }
 
-                                if (sPtr + 2 >= endPtr)
-                                    return E_FAIL;
 
-                                // BGR -> RGBA
-                                *dPtr = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | 0xFF000000;
-                                sPtr += 3;
+    //-------------------------------------------------------------------------------------
+    // Copies pixel data from a TGA into the target image
+    //-------------------------------------------------------------------------------------
+    HRESULT CopyPixels(
+        _In_reads_bytes_(size) const void* pSource,
+        size_t size,
+        TGA_FLAGS flags,
+        _In_ const Image* image,
+        _In_ uint32_t convFlags,
+        _In_opt_ const uint8_t* palette) noexcept
+    {
+        assert(pSource && size > 0);
 
-                                minalpha = maxalpha = 255;
-                            }
-                            else
-                            {
-                                assert(offset * 4 < rowPitch);
+        if (!image || !image->pixels)
+            return E_POINTER;
 
-                                if (sPtr + 3 >= endPtr)
-                                    return E_FAIL;
+        // Compute TGA image data pitch
+        size_t rowPitch, slicePitch;
+        HRESULT hr = ComputePitch(image->format, image->width, image->height,
+            rowPitch, slicePitch,
+            (convFlags & CONV_FLAGS_EXPAND) ? CP_FLAGS_24BPP : CP_FLAGS_NONE);
+        if (FAILED(hr))
+            return hr;
 
-                                // BGRA -> RGBA
-                                uint32_t alpha = *(sPtr + 3);
-                                *dPtr = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | uint32_t(alpha << 24);
+        auto sPtr = static_cast<const uint8_t*>(pSource);
+        const bool parallel = (flags & TGA_FLAGS_PARALLEL) != 0;
 
-                                minalpha = std::min(minalpha, alpha);
-                                maxalpha = std::max(maxalpha, alpha);
+        AlphaRange alpha = c_EmptyAlphaRange;
 
-                                sPtr += 4;
-                            }
+        if ((convFlags & CONV_FLAGS_PALETTED) != 0)
+        {
+            if (!palette)
+                return E_UNEXPECTED;
 
-                            if (convFlags & CONV_FLAGS_INVERTX)
-                                --dPtr;
-                            else
-                                ++dPtr;
-                        }
-                    }
+            if (image->width > size / image->height)
+                return E_FAIL;
 
-                    // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-                    if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-                    {
-                        opaquealpha = true;
-                        hr = SetAlphaChannelToOpaque(image);
-                        if (FAILED(hr))
-                            return hr;
-                    }
-                    else if (minalpha == 255)
-                    {
-                        opaquealpha = true;
-                    }
-                }
-                break;
+            const auto table = reinterpret_cast<const uint32_t*>(palette);
 
-            //---------------------------------------------------------------- 32-bit (BGR)
-            case DXGI_FORMAT_B8G8R8A8_UNORM:
+            return DecodeScanlines(*image, convFlags, sizeof(uint32_t), parallel, alpha,
+                [&](size_t y, uint8_t* dPtr, AlphaRange&) noexcept -> bool
                 {
-                    assert((convFlags & CONV_FLAGS_EXPAND) == 0);
-
-                    uint32_t minalpha = 255;
-                    uint32_t maxalpha = 0;
-
-                    for (size_t y = 0; y < image->height; ++y)
-                    {
-                        size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-
-                        auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                            + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                            + offset;
-
-                        for (size_t x = 0; x < image->width; ++x)
-                        {
-                            assert(offset * 4 < rowPitch);
-
-                            if (sPtr + 3 >= endPtr)
-                                return E_FAIL;
-
-                            const uint32_t alpha = *(sPtr + 3);
-                            *dPtr = *reinterpret_cast<const uint32_t*>(sPtr);
-
-                            minalpha = std::min(minalpha, alpha);
-                            maxalpha = std::max(maxalpha, alpha);
-
-                            sPtr += 4;
-
-                            if (convFlags & CONV_FLAGS_INVERTX)
-                                --dPtr;
-                            else
-                                ++dPtr;
-                        }
-                    }
-
-                    // If there are no non-zero alpha channel entries, we'll assume alpha is not used and force it to opaque
-                    if (maxalpha == 0 && !(flags & TGA_FLAGS_ALLOW_ALL_ZERO_ALPHA))
-                    {
-                        opaquealpha = true;
-                        hr = SetAlphaChannelToOpaque(image);
-                        if (FAILED(hr))
-                            return hr;
-                    }
-                    else if (minalpha == 255)
+                    const uint8_t* src = sPtr + y * image->width;
+                    auto dst = reinterpret_cast<uint32_t*>(dPtr);
+                    for (size_t x = 0; x < image->width; ++x)
                     {
-                        opaquealpha = true;
+                        dst[x] = table[src[x]];
                     }
-                }
-                break;
-
-            //---------------------------------------------------------------- 24-bit (BGR)
-            case DXGI_FORMAT_B8G8R8X8_UNORM:
-                {
-                    assert((convFlags & CONV_FLAGS_EXPAND) != 0);
-
-                    for (size_t y = 0; y < image->height; ++y)
-                    {
-                        size_t offset = ((convFlags & CONV_FLAGS_INVERTX) ? (image->width - 1) : 0);
-
-                        auto dPtr = reinterpret_cast<uint32_t*>(image->pixels
-                            + (image->rowPitch * ((convFlags & CONV_FLAGS_INVERTY) ? y : (image->height - y - 1))))
-                            + offset;
-
-                        for (size_t x = 0; x < image->width; ++x)
-                        {
-                            assert(offset * 3 < rowPitch);
-
-                            if (sPtr + 2 >= endPtr)
-                                return E_FAIL;
+                    return true;
+                });
+        }
 
-                            *dPtr = uint32_t(*sPtr) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2) << 16);
-                            sPtr += 3;
+        TGAPixelLayout layout;
+        if (!GetPixelLayout(image->format, convFlags, layout))
+            return E_FAIL;
 
-                            if (convFlags & CONV_FLAGS_INVERTX)
-                                --dPtr;
-                            else
-                                ++dPtr;
-                        }
-                    }
-                }
-                break;
+        // Scanlines are tightly packed, so each one can be located directly
+        const size_t srcPitch = image->width * layout.srcBytes;
+        if (srcPitch > size / image->height)
+            return E_FAIL;
 
-            //-----------------------------------------------------------------------------
-            default:
-                return E_FAIL;
-            }
-        }
+        hr = DecodeScanlines(*image, convFlags, layout.dstBytes, parallel, alpha,
+            [&](size_t y, uint8_t* dPtr, AlphaRange& range) noexcept -> bool
+            {
+                ConvertPixels(dPtr, sPtr + y * srcPitch, image->width, layout, range);
+                return true;
+            });
+        if (FAILED(hr))
+            return hr;
 
-        return opaquealpha ? S_FALSE : S_OK;
+        return ResolveAlpha(image, flags, layout, alpha);
     }
 
 
     //-------------------------------------------------------------------------------------
     // Encodes TGA file header
     //-------------------------------------------------------------------------------------
-    HRESULT EncodeTGAHeader(_In_ const Image& image, _Out_ TGA_HEADER& header, _Inout_ uint32_t& convFlags) noexcept
+    HRESULT EncodeTGAHeader(_In_ const Image& image, TGA_FLAGS flags, _Out_ TGA_HEADER& header, _Inout_ uint32_t& convFlags) noexcept
     {
         memset(&header, 0, TGA_HEADER_LEN);
 
@@ -1271,10 +1016,88 @@ namespace
             return HRESULT_E_NOT_SUPPORTED;
         }
 
+        if (flags & TGA_FLAGS_RLE)
+        {
+            header.bImageType = (header.bImageType == TGA_BLACK_AND_WHITE) ? TGA_BLACK_AND_WHITE_RLE : TGA_TRUECOLOR_RLE;
+            convFlags |= CONV_FLAGS_RLE;
+        }
+
         return S_OK;
     }
 
 
+    //-------------------------------------------------------------------------------------
+    // Run-length encodes a scanline of TGA pixel data
+    //-------------------------------------------------------------------------------------
+    inline size_t GetRLEScanlineSize(size_t width, size_t rowPitch) noexcept
+    {
+        // Worst case is all literal packets, since a repeat packet is only used when it is smaller
+        return rowPitch + (width + 127) / 128 + 1;
+    }
+
+    size_t EncodeRLEScanline(
+        _Out_writes_bytes_to_(outSize, return) uint8_t* pDestination,
+        size_t outSize,
+        _In_reads_bytes_(width * bpp) const uint8_t* pSource,
+        size_t width,
+        size_t bpp) noexcept
+    {
+        assert(pDestination && pSource && bpp > 0 && bpp <= 4);
+
+        auto samePixel = [=](size_t a, size_t b) noexcept
+        {
+            return memcmp(pSource + a * bpp, pSource + b * bpp, bpp) == 0;
+        };
+
+        // A two pixel run only saves space over a literal for pixels larger than a byte
+        const size_t minRun = (bpp > 1) ? 2 : 3;
+
+        auto runLength = [&](size_t x, size_t maxRun) noexcept
+        {
+            size_t j = 1;
+            while (j < maxRun && (x + j) < width && samePixel(x, x + j))
+                ++j;
+            return j;
+        };
+
+        uint8_t* dPtr = pDestination;
+        const uint8_t* endPtr = pDestination + outSize;
+
+        for (size_t x = 0; x < width; )
+        {
+            size_t j = runLength(x, 128);
+            if (j >= minRun)
+            {
+                // Repeat
+                if (size_t(endPtr - dPtr) < 1 + bpp)
+                    return 0;
+
+                *(dPtr++) = static_cast<uint8_t>(0x80 | (j - 1));
+                memcpy(dPtr, pSource + x * bpp, bpp);
+                dPtr += bpp;
+            }
+            else
+            {
+                // Literal, which ends where the next worthwhile run starts
+                j = 1;
+                while (j < 128 && (x + j) < width && runLength(x + j, minRun) < minRun)
+                    ++j;
+
+                if (size_t(endPtr - dPtr) < 1 + j * bpp)
+                    return 0;
+
+                *(dPtr++) = static_cast<uint8_t>(j - 1);
+                memcpy(dPtr, pSource + x * bpp, j * bpp);
+                dPtr += j * bpp;
+            }
+
+            x += j;
+        }
+
+        return static_cast<size_t>(dPtr - pDestination);
+    }
+
+
     //-------------------------------------------------------------------------------------
     // Copies BGRX data to form BGR 24bpp data
     //-------------------------------------------------------------------------------------
@@ -2247,7 +2070,7 @@ HRESULT DirectX::SaveToTGAMemory(
 
     TGA_HEADER tga_header = {};
     uint32_t convFlags = 0;
-    HRESULT hr = EncodeTGAHeader(image, tga_header, convFlags);
+    HRESULT hr = EncodeTGAHeader(image, flags, tga_header, convFlags);
     if (FAILED(hr))
         return hr;
 
@@ -2260,8 +2083,22 @@ HRESULT DirectX::SaveToTGAMemory(
     if (FAILED(hr))
         return hr;
 
+    // RLE data is written into a worst-case sized blob which is trimmed afterwards
+    const size_t rleRowSize = (convFlags & CONV_FLAGS_RLE) ? GetRLEScanlineSize(image.width, rowPitch) : 0;
+
+    std::unique_ptr<uint8_t[]> temp;
+    if (convFlags & CONV_FLAGS_RLE)
+    {
+        if (rleRowSize > SIZE_MAX / image.height)
+            return HRESULT_E_ARITHMETIC_OVERFLOW;
+
+        temp.reset(new (std::nothrow) uint8_t[rowPitch]);
+        if (!temp)
+            return E_OUTOFMEMORY;
+    }
+
     hr = blob.Initialize(TGA_HEADER_LEN
-        + slicePitch
+        + ((convFlags & CONV_FLAGS_RLE) ? (rleRowSize * image.height) : slicePitch)
         + (metadata ? sizeof(TGA_EXTENSION) : 0)
         + sizeof(TGA_FOOTER));
     if (FAILED(hr))
@@ -2280,21 +2117,38 @@ HRESULT DirectX::SaveToTGAMemory(
 
     for (size_t y = 0; y < image.height; ++y)
     {
+        uint8_t* rowPtr = (convFlags & CONV_FLAGS_RLE) ? temp.get() : dPtr;
+
         // Copy pixels
         if (convFlags & CONV_FLAGS_888)
         {
-            Copy24bppScanline(dPtr, rowPitch, pPixels, image.rowPitch);
+            Copy24bppScanline(rowPtr, rowPitch, pPixels, image.rowPitch);
         }
         else if (convFlags & CONV_FLAGS_SWIZZLE)
         {
-            SwizzleScanline(dPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            SwizzleScanline(rowPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+        }
+        else
+        {
+            CopyScanline(rowPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+        }
+
+        if (convFlags & CONV_FLAGS_RLE)
+        {
+            const size_t bytes = EncodeRLEScanline(dPtr, rleRowSize, rowPtr, image.width, rowPitch / image.width);
+            if (!bytes)
+            {
+                blob.Release();
+                return E_FAIL;
+            }
+
+            dPtr += bytes;
         }
         else
         {
-            CopyScanline(dPtr, rowPitch, pPixels, image.rowPitch, image.format, TEXP_SCANLINE_NONE);
+            dPtr += rowPitch;
         }
 
-        dPtr += rowPitch;
         pPixels += image.rowPitch;
     }
 
@@ -2314,6 +2168,17 @@ HRESULT DirectX::SaveToTGAMemory(
     footer->dwDeveloperOffset = 0;
     footer->dwExtensionOffset = extOffset;
     memcpy(footer->Signature, g_Signature, sizeof(g_Signature));
+    dPtr += sizeof(TGA_FOOTER);
+
+    if (convFlags & CONV_FLAGS_RLE)
+    {
+        hr = blob.Trim(static_cast<size_t>(dPtr - destPtr));
+        if (FAILED(hr))
+        {
+            blob.Release();
+            return hr;
+        }
+    }
 
     return S_OK;
 }
@@ -2340,7 +2205,7 @@ HRESULT DirectX::SaveToTGAFile(
 
     TGA_HEADER tga_header = {};
     uint32_t convFlags = 0;
-    HRESULT hr = EncodeTGAHeader(image, tga_header, convFlags);
+    HRESULT hr = EncodeTGAHeader(image, flags, tga_header, convFlags);
     if (FAILED(hr))
         return hr;
 
@@ -2405,7 +2270,9 @@ HRESULT DirectX::SaveToTGAFile(
     else
     {
         // Otherwise, write the image one scanline at a time...
-        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch]);
+        const size_t rleRowSize = (convFlags & CONV_FLAGS_RLE) ? GetRLEScanlineSize(image.width, rowPitch) : 0;
+
+        std::unique_ptr<uint8_t[]> temp(new (std::nothrow) uint8_t[rowPitch + rleRowSize]);
         if (!temp)
             return E_OUTOFMEMORY;
 
@@ -2425,7 +2292,7 @@ HRESULT DirectX::SaveToTGAFile(
             return E_FAIL;
     #endif
 
-        if (rowPitch > UINT32_MAX)
+        if ((rowPitch + rleRowSize) > UINT32_MAX)
             return HRESULT_E_ARITHMETIC_OVERFLOW;
 
         // Write pixels
@@ -2449,16 +2316,26 @@ HRESULT DirectX::SaveToTGAFile(
 
             pPixels += image.rowPitch;
 
+            const uint8_t* rowPtr = temp.get();
+            size_t rowBytes = rowPitch;
+            if (convFlags & CONV_FLAGS_RLE)
+            {
+                rowPtr = temp.get() + rowPitch;
+                rowBytes = EncodeRLEScanline(temp.get() + rowPitch, rleRowSize, temp.get(), image.width, rowPitch / image.width);
+                if (!rowBytes)
+                    return E_FAIL;
+            }
+
         #ifdef _WIN32
-            if (!WriteFile(hFile.get(), temp.get(), static_cast<DWORD>(rowPitch), &bytesWritten, nullptr))
+            if (!WriteFile(hFile.get(), rowPtr, static_cast<DWORD>(rowBytes), &bytesWritten, nullptr))
             {
                 return HRESULT_FROM_WIN32(GetLastError());
             }
 
-            if (bytesWritten != rowPitch)
+            if (bytesWritten != rowBytes)
                 return E_FAIL;
         #else
-            outFile.write(reinterpret_cast<char*>(temp.get()), rowPitch);
+            outFile.write(reinterpret_cast<const char*>(rowPtr), static_cast<std::streamsize>(rowBytes));
             if (!outFile)
                 return E_FAIL;
         #endif
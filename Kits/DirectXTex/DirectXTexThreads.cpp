@@ -0,0 +1,330 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexThreads.cpp
+//
+// DirectX Texture Library - Work-stealing task scheduler
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexp.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+    //-------------------------------------------------------------------------------------
+    // Each worker owns a contiguous range of task indices. The owner consumes from the
+    // front of its range, while workers that run out of work steal from the back.
+    //-------------------------------------------------------------------------------------
+    class TaskRange
+    {
+    public:
+        TaskRange() noexcept : m_head(0), m_tail(0) {}
+
+        TaskRange(const TaskRange&) = delete;
+        TaskRange& operator=(const TaskRange&) = delete;
+
+        void Reset(size_t head, size_t tail) noexcept
+        {
+            m_head = head;
+            m_tail = tail;
+        }
+
+        bool PopFront(size_t& task)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_head >= m_tail)
+                return false;
+
+            task = m_head++;
+            return true;
+        }
+
+        bool PopBack(size_t& task)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_head >= m_tail)
+                return false;
+
+            task = --m_tail;
+            return true;
+        }
+
+    private:
+        std::mutex  m_mutex;
+        size_t      m_head;
+        size_t      m_tail;
+    };
+
+    //-------------------------------------------------------------------------------------
+    // Process-wide set of helper threads that stay parked between ParallelFor calls, so
+    // short jobs (small mips, single bands) don't pay for creating and joining threads.
+    // One job runs on the pool at a time; a caller that finds it busy (another thread, or
+    // a nested call from inside a task) reports that and runs with its own threads instead.
+    //-------------------------------------------------------------------------------------
+    class WorkerPool
+    {
+    public:
+        using WorkerFunc = void(*)(void* context, size_t worker);
+
+        WorkerPool() noexcept :
+            m_busy(false),
+            m_threadCount(0),
+            m_func(nullptr),
+            m_context(nullptr),
+            m_workerCount(0),
+            m_claimed(0),
+            m_running(0),
+            m_generation(0)
+        {
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // The pool is never destroyed: its threads are parked on a condition variable and
+        // are torn down with the process, which avoids joining them during static destruction
+        static WorkerPool* Get() noexcept
+        {
+            static WorkerPool* s_pool = new (std::nothrow) WorkerPool;
+            return s_pool;
+        }
+
+        // Runs func for worker indices [0, workerCount), with index 0 on the calling thread
+        // and the rest on whichever pooled threads pick them up. Indices nobody claims
+        // before worker 0 finishes are simply never run, so func must not depend on them.
+        bool Run(size_t workerCount, WorkerFunc func, void* context) noexcept
+        {
+            if (m_busy.exchange(true, std::memory_order_acquire))
+                return false;
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+
+                Grow(workerCount - 1);
+
+                m_func = func;
+                m_context = context;
+                m_workerCount = workerCount;
+                m_claimed = 1;
+                ++m_generation;
+            }
+
+            if (workerCount > 1)
+                m_wake.notify_all();
+
+            func(context, 0);
+
+            // Close the job so late wakers can't claim an index, then wait for the helpers
+            // that did to finish their last task
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workerCount = 0;
+            m_done.wait(lock, [this]() noexcept { return !m_running; });
+
+            m_func = nullptr;
+            m_context = nullptr;
+            lock.unlock();
+
+            m_busy.store(false, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        void Grow(size_t helperCount) noexcept
+        {
+            try
+            {
+                while (m_threadCount < helperCount)
+                {
+                    std::thread(&WorkerPool::HelperLoop, this).detach();
+                    ++m_threadCount;
+                }
+            }
+            catch (...)
+            {
+                // Running with fewer helpers is fine, as worker 0 steals any unclaimed work
+            }
+        }
+
+        void HelperLoop() noexcept
+        {
+            uint64_t seen = 0;
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            for (;;)
+            {
+                m_wake.wait(lock, [&]() noexcept { return m_generation != seen; });
+                seen = m_generation;
+
+                if (m_claimed >= m_workerCount)
+                    continue;
+
+                const size_t index = m_claimed++;
+                ++m_running;
+
+                WorkerFunc func = m_func;
+                void* context = m_context;
+
+                lock.unlock();
+                func(context, index);
+                lock.lock();
+
+                if (!--m_running)
+                    m_done.notify_one();
+            }
+        }
+
+        std::atomic<bool>           m_busy;
+        std::mutex                  m_mutex;
+        std::condition_variable     m_wake;
+        std::condition_variable     m_done;
+        size_t                      m_threadCount;
+        WorkerFunc                  m_func;
+        void*                       m_context;
+        size_t                      m_workerCount;
+        size_t                      m_claimed;
+        size_t                      m_running;
+        uint64_t                    m_generation;
+    };
+
+    template<typename T>
+    void InvokeWorker(void* context, size_t worker) noexcept
+    {
+        (*static_cast<T*>(context))(worker);
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Determine the number of workers to use for a given amount of work
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+size_t DirectX::Internal::GetWorkerCount(size_t threadCount, size_t taskCount) noexcept
+{
+    if (!threadCount)
+    {
+        threadCount = std::thread::hardware_concurrency();
+        if (!threadCount)
+            threadCount = 1;
+    }
+
+    return std::max<size_t>(1, std::min<size_t>(threadCount, taskCount));
+}
+
+
+//-------------------------------------------------------------------------------------
+// Run a set of independent tasks across the persistent pool of work-stealing workers
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::Internal::ParallelFor(
+    size_t taskCount,
+    size_t threadCount,
+    const std::function<bool __cdecl(size_t task, size_t worker)>& taskFunc) noexcept
+{
+    if (!taskFunc)
+        return E_INVALIDARG;
+
+    if (!taskCount)
+        return S_OK;
+
+    const size_t workerCount = GetWorkerCount(threadCount, taskCount);
+
+    std::unique_ptr<TaskRange[]> ranges(new (std::nothrow) TaskRange[workerCount]);
+    if (!ranges)
+        return E_OUTOFMEMORY;
+
+    for (size_t w = 0; w < workerCount; ++w)
+    {
+        ranges[w].Reset(taskCount * w / workerCount, taskCount * (w + 1) / workerCount);
+    }
+
+    // The first failure is kept, and stops the workers from starting any more tasks
+    std::atomic<HRESULT> result(S_OK);
+    auto fail = [&](HRESULT hr) noexcept
+    {
+        HRESULT expected = S_OK;
+        result.compare_exchange_strong(expected, hr);
+    };
+
+    auto worker = [&](size_t index) noexcept
+    {
+        size_t task = 0;
+        for (;;)
+        {
+            if (result.load(std::memory_order_relaxed) != S_OK)
+                return;
+
+            if (!ranges[index].PopFront(task))
+            {
+                // Out of local work, so try to steal from the other workers
+                bool stolen = false;
+                for (size_t j = 1; j < workerCount && !stolen; ++j)
+                {
+                    stolen = ranges[(index + j) % workerCount].PopBack(task);
+                }
+
+                // No work is added once started, so nothing left to steal means we are done
+                if (!stolen)
+                    return;
+            }
+
+            // Workers run inside noexcept code, so an exception from a task must not escape
+            try
+            {
+                if (!taskFunc(task, index))
+                    fail(E_FAIL);
+            }
+            catch (const std::bad_alloc&)
+            {
+                fail(E_OUTOFMEMORY);
+            }
+            catch (...)
+            {
+                fail(E_FAIL);
+            }
+        }
+    };
+
+    if (workerCount == 1)
+    {
+        worker(0);
+        return result;
+    }
+
+    WorkerPool* pool = WorkerPool::Get();
+    if (pool && pool->Run(workerCount, InvokeWorker<decltype(worker)>, &worker))
+        return result;
+
+    // The pool is busy with another job, so this one gets threads of its own
+    std::vector<std::thread> threads;
+    try
+    {
+        threads.reserve(workerCount - 1);
+        for (size_t w = 1; w < workerCount; ++w)
+        {
+            threads.emplace_back(worker, w);
+        }
+    }
+    catch (...)
+    {
+        // Any ranges belonging to workers that failed to start are stolen by the others
+    }
+
+    // The calling thread acts as worker 0
+    worker(0);
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    return result;
+}
@@ -0,0 +1,609 @@
+//-------------------------------------------------------------------------------------
+// DirectXTexTranscode.cpp
+//
+// DirectX Texture Library - Block compressed format transcoding
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//
+// http://go.microsoft.com/fwlink/?LinkId=248926
+//-------------------------------------------------------------------------------------
+
+#include "DirectXTexP.h"
+
+#include "BC.h"
+
+using namespace DirectX;
+using namespace DirectX::Internal;
+
+namespace
+{
+    enum TRANSCODE_OP
+    {
+        TRANSCODE_NONE = 0,
+        TRANSCODE_COLOR_TO_BC1,     // BC2/BC3 color block -> BC1
+        TRANSCODE_ALPHA_TO_BC4,     // BC3 alpha block -> BC4
+        TRANSCODE_BC5_TO_BC4,       // BC5 red or green block -> BC4
+        TRANSCODE_BC1_TO_BC7,       // BC1 -> BC7 mode 6
+    };
+
+    TRANSCODE_OP GetTranscodeOp(DXGI_FORMAT srcFormat, DXGI_FORMAT destFormat) noexcept
+    {
+        switch (srcFormat)
+        {
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC3_TYPELESS:
+            if (destFormat == DXGI_FORMAT_BC1_TYPELESS)
+                return TRANSCODE_COLOR_TO_BC1;
+            if (destFormat == DXGI_FORMAT_BC4_TYPELESS && srcFormat == DXGI_FORMAT_BC3_TYPELESS)
+                return TRANSCODE_ALPHA_TO_BC4;
+            break;
+
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC3_UNORM:
+            if (destFormat == DXGI_FORMAT_BC1_UNORM)
+                return TRANSCODE_COLOR_TO_BC1;
+            if (destFormat == DXGI_FORMAT_BC4_UNORM && srcFormat == DXGI_FORMAT_BC3_UNORM)
+                return TRANSCODE_ALPHA_TO_BC4;
+            break;
+
+        case DXGI_FORMAT_BC2_UNORM_SRGB:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:
+            if (destFormat == DXGI_FORMAT_BC1_UNORM_SRGB)
+                return TRANSCODE_COLOR_TO_BC1;
+            if (destFormat == DXGI_FORMAT_BC4_UNORM && srcFormat == DXGI_FORMAT_BC3_UNORM_SRGB)
+                return TRANSCODE_ALPHA_TO_BC4;
+            break;
+
+        case DXGI_FORMAT_BC5_TYPELESS:
+            if (destFormat == DXGI_FORMAT_BC4_TYPELESS)
+                return TRANSCODE_BC5_TO_BC4;
+            break;
+
+        case DXGI_FORMAT_BC5_UNORM:
+            if (destFormat == DXGI_FORMAT_BC4_UNORM)
+                return TRANSCODE_BC5_TO_BC4;
+            break;
+
+        case DXGI_FORMAT_BC5_SNORM:
+            if (destFormat == DXGI_FORMAT_BC4_SNORM)
+                return TRANSCODE_BC5_TO_BC4;
+            break;
+
+        case DXGI_FORMAT_BC1_TYPELESS:
+            if (destFormat == DXGI_FORMAT_BC7_TYPELESS)
+                return TRANSCODE_BC1_TO_BC7;
+            break;
+
+        case DXGI_FORMAT_BC1_UNORM:
+            if (destFormat == DXGI_FORMAT_BC7_UNORM)
+                return TRANSCODE_BC1_TO_BC7;
+            break;
+
+        case DXGI_FORMAT_BC1_UNORM_SRGB:
+            if (destFormat == DXGI_FORMAT_BC7_UNORM_SRGB)
+                return TRANSCODE_BC1_TO_BC7;
+            break;
+
+        default:
+            break;
+        }
+
+        return TRANSCODE_NONE;
+    }
+
+    inline uint16_t ReadU16(const uint8_t* ptr) noexcept
+    {
+        return static_cast<uint16_t>(ptr[0] | (ptr[1] << 8));
+    }
+
+    inline uint32_t ReadU32(const uint8_t* ptr) noexcept
+    {
+        return uint32_t(ptr[0]) | (uint32_t(ptr[1]) << 8) | (uint32_t(ptr[2]) << 16) | (uint32_t(ptr[3]) << 24);
+    }
+
+    inline void WriteU16(uint8_t* ptr, uint16_t value) noexcept
+    {
+        ptr[0] = static_cast<uint8_t>(value);
+        ptr[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    inline void WriteU32(uint8_t* ptr, uint32_t value) noexcept
+    {
+        ptr[0] = static_cast<uint8_t>(value);
+        ptr[1] = static_cast<uint8_t>(value >> 8);
+        ptr[2] = static_cast<uint8_t>(value >> 16);
+        ptr[3] = static_cast<uint8_t>(value >> 24);
+    }
+
+    //-------------------------------------------------------------------------------------
+    // BC2/BC3 color block -> BC1
+    //
+    // The color block of BC2/BC3 always uses four colors, while BC1 selects the
+    // three-color mode when color0 <= color1, so those blocks are reordered.
+    //-------------------------------------------------------------------------------------
+    void ColorToBC1(_Out_writes_(8) uint8_t* pBC1, _In_reads_(8) const uint8_t* pColor) noexcept
+    {
+        const uint16_t c0 = ReadU16(pColor);
+        const uint16_t c1 = ReadU16(pColor + 2);
+        const uint32_t indices = ReadU32(pColor + 4);
+
+        if (c0 > c1)
+        {
+            memcpy(pBC1, pColor, 8);
+        }
+        else if (c0 == c1)
+        {
+            // All four colors are the same
+            WriteU16(pBC1, c0);
+            WriteU16(pBC1 + 2, c1);
+            WriteU32(pBC1 + 4, 0);
+        }
+        else
+        {
+            // Swapping the endpoints exchanges indices 0<->1 and 2<->3
+            WriteU16(pBC1, c1);
+            WriteU16(pBC1 + 2, c0);
+            WriteU32(pBC1 + 4, indices ^ 0x55555555);
+        }
+    }
+
+    //-------------------------------------------------------------------------------------
+    // BC1 -> BC7 mode 6
+    //
+    // The endpoints are expanded to 8 bits and stored with a p-bit of 1 (so alpha is
+    // opaque), which rounds even color values up by one. The 1/3 and 2/3 interpolants map
+    // to the nearest 4-bit weights (21/64 and 43/64). Blocks which use the midpoint or
+    // transparent colors of three-color mode can't be represented this way, and are
+    // decoded and re-encoded instead.
+    //
+    // That block seeds a refinement against the BC1 colors: the endpoints are solved by
+    // least squares for the seed weights, then the weights are re-selected for the new
+    // endpoints. The result is only kept if it is closer to the BC1 colors than the seed.
+    //-------------------------------------------------------------------------------------
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(_Out_writes_(16) uint8_t* pBC) noexcept : m_bits(pBC), m_pos(0) { memset(pBC, 0, 16); }
+
+        void Write(uint32_t value, size_t count) noexcept
+        {
+            for (size_t i = 0; i < count; ++i, ++m_pos)
+            {
+                if (value & (1u << i))
+                {
+                    m_bits[m_pos >> 3] |= static_cast<uint8_t>(1u << (m_pos & 7));
+                }
+            }
+        }
+
+        size_t GetPosition() const noexcept { return m_pos; }
+
+    private:
+        uint8_t* m_bits;
+        size_t m_pos;
+    };
+
+    const int g_aWeights4[] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    inline int Interpolate(int a, int b, int weight) noexcept
+    {
+        return ((64 - weight) * a + weight * b + 32) >> 6;
+    }
+
+    // Squared error of one texel against the mode 6 color for a weight
+    inline int TexelError(const int* texel, const int endpoints[2][3], size_t weight) noexcept
+    {
+        int error = 0;
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            const int d = Interpolate(endpoints[0][ch], endpoints[1][ch], g_aWeights4[weight]) - texel[ch];
+            error += d * d;
+        }
+        return error;
+    }
+
+    // Solves for the endpoints that best fit the colors with the weights fixed, keeping
+    // the low bit set for the p-bit. Returns false if the weights don't span the block.
+    bool FitEndpoints(
+        const int colors[NUM_PIXELS_PER_BLOCK][3],
+        const uint8_t* weights,
+        int endpoints[2][3]) noexcept
+    {
+        float aa = 0.f;
+        float ab = 0.f;
+        float bb = 0.f;
+        float ax[3] = {};
+        float bx[3] = {};
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            const float t = float(g_aWeights4[weights[i]]) / 64.f;
+            const float s = 1.f - t;
+            aa += s * s;
+            ab += s * t;
+            bb += t * t;
+            for (size_t ch = 0; ch < 3; ++ch)
+            {
+                ax[ch] += s * float(colors[i][ch]);
+                bx[ch] += t * float(colors[i][ch]);
+            }
+        }
+
+        const float det = aa * bb - ab * ab;
+        if (det < 1e-3f)
+            return false;
+
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            const float a = (bb * ax[ch] - ab * bx[ch]) / det;
+            const float b = (aa * bx[ch] - ab * ax[ch]) / det;
+
+            // Nearest odd value in [1, 255]
+            endpoints[0][ch] = std::min(std::max(int(floorf((a - 1.f) * 0.5f + 0.5f)), 0), 127) * 2 + 1;
+            endpoints[1][ch] = std::min(std::max(int(floorf((b - 1.f) * 0.5f + 0.5f)), 0), 127) * 2 + 1;
+        }
+
+        return true;
+    }
+
+    void RefineMode6(
+        const int colors[NUM_PIXELS_PER_BLOCK][3],
+        int endpoints[2][3],
+        uint8_t* weights) noexcept
+    {
+        int bestError = 0;
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            bestError += TexelError(colors[i], endpoints, weights[i]);
+        }
+
+        for (size_t pass = 0; pass < 2 && bestError > 0; ++pass)
+        {
+            int trial[2][3];
+            if (!FitEndpoints(colors, weights, trial))
+                return;
+
+            uint8_t trialWeights[NUM_PIXELS_PER_BLOCK];
+            int error = 0;
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                int texelError = TexelError(colors[i], trial, 0);
+                trialWeights[i] = 0;
+                for (size_t w = 1; w < 16; ++w)
+                {
+                    const int e = TexelError(colors[i], trial, w);
+                    if (e < texelError)
+                    {
+                        texelError = e;
+                        trialWeights[i] = static_cast<uint8_t>(w);
+                    }
+                }
+                error += texelError;
+            }
+
+            if (error >= bestError)
+                return;
+
+            bestError = error;
+            memcpy(endpoints, trial, sizeof(trial));
+            memcpy(weights, trialWeights, sizeof(trialWeights));
+        }
+    }
+
+    bool BC1ToBC7Mode6(_Out_writes_(16) uint8_t* pBC7, _In_reads_(8) const uint8_t* pBC1) noexcept
+    {
+        const uint16_t c0 = ReadU16(pBC1);
+        const uint16_t c1 = ReadU16(pBC1 + 2);
+        const uint32_t indices = ReadU32(pBC1 + 4);
+
+        static const uint8_t s_fourColor[4] = { 0, 15, 5, 10 };
+        static const uint8_t s_threeColor[4] = { 0, 15, 0xff, 0xff };
+
+        const uint8_t* remap = (c0 > c1) ? s_fourColor : s_threeColor;
+
+        uint8_t weights[NUM_PIXELS_PER_BLOCK];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            weights[i] = remap[(indices >> (2 * i)) & 0x3];
+            if (weights[i] == 0xff)
+                return false;
+        }
+
+        // 5:6:5 -> 8:8:8, then the top 7 bits of each channel with a p-bit of 1
+        int palette[4][3];
+        int endpoints[2][3];
+        const uint16_t colors[2] = { c0, c1 };
+        for (size_t j = 0; j < 2; ++j)
+        {
+            const int r = (colors[j] >> 11) & 0x1f;
+            const int g = (colors[j] >> 5) & 0x3f;
+            const int b = colors[j] & 0x1f;
+
+            palette[j][0] = (r << 3) | (r >> 2);
+            palette[j][1] = (g << 2) | (g >> 4);
+            palette[j][2] = (b << 3) | (b >> 2);
+
+            for (size_t ch = 0; ch < 3; ++ch)
+            {
+                endpoints[j][ch] = palette[j][ch] | 1;
+            }
+        }
+
+        // Only four-color blocks get here, which use the 1/3 and 2/3 interpolants
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            palette[2][ch] = (2 * palette[0][ch] + palette[1][ch] + 1) / 3;
+            palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch] + 1) / 3;
+        }
+
+        int texels[NUM_PIXELS_PER_BLOCK][3];
+        for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            memcpy(texels[i], palette[(indices >> (2 * i)) & 0x3], sizeof(texels[i]));
+        }
+
+        RefineMode6(texels, endpoints, weights);
+
+        // The anchor (first) index has an implicit zero high bit
+        size_t e0 = 0;
+        if (weights[0] & 0x8)
+        {
+            e0 = 1;
+            for (size_t i = 0; i < NUM_PIXELS_PER_BLOCK; ++i)
+            {
+                weights[i] = static_cast<uint8_t>(15 - weights[i]);
+            }
+        }
+
+        BitWriter bits(pBC7);
+        bits.Write(1u << 6, 7);     // Mode 6
+
+        for (size_t ch = 0; ch < 3; ++ch)
+        {
+            bits.Write(uint32_t(endpoints[e0][ch]) >> 1, 7);
+            bits.Write(uint32_t(endpoints[e0 ^ 1][ch]) >> 1, 7);
+        }
+
+        bits.Write(0x7f, 7);        // Alpha
+        bits.Write(0x7f, 7);
+        bits.Write(1, 1);           // P-bits
+        bits.Write(1, 1);
+
+        bits.Write(weights[0], 3);
+        for (size_t i = 1; i < NUM_PIXELS_PER_BLOCK; ++i)
+        {
+            bits.Write(weights[i], 4);
+        }
+
+        assert(bits.GetPosition() == 128);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------------------
+    // Transcodes the block rows [y0, y1) of an image
+    //-------------------------------------------------------------------------------------
+    bool TranscodeRows(
+        const Image& srcImage,
+        TRANSCODE_OP op,
+        TEX_TRANSCODE_FLAGS flags,
+        const Image& destImage,
+        size_t y0,
+        size_t y1) noexcept
+    {
+        const size_t nbw = std::max<size_t>(1, (srcImage.width + 3) / 4);
+
+        const uint8_t* pSrc = srcImage.pixels + srcImage.rowPitch * y0;
+        uint8_t* pDest = destImage.pixels + destImage.rowPitch * y0;
+
+        for (size_t y = y0; y < y1; ++y, pSrc += srcImage.rowPitch, pDest += destImage.rowPitch)
+        {
+            const uint8_t* sptr = pSrc;
+            uint8_t* dptr = pDest;
+
+            switch (op)
+            {
+            case TRANSCODE_COLOR_TO_BC1:
+                for (size_t x = 0; x < nbw; ++x, sptr += 16, dptr += 8)
+                {
+                    ColorToBC1(dptr, sptr + 8);
+                }
+                break;
+
+            case TRANSCODE_ALPHA_TO_BC4:
+                for (size_t x = 0; x < nbw; ++x, sptr += 16, dptr += 8)
+                {
+                    memcpy(dptr, sptr, 8);
+                }
+                break;
+
+            case TRANSCODE_BC5_TO_BC4:
+                {
+                    const size_t offset = (flags & TEX_TRANSCODE_BC5_GREEN) ? 8 : 0;
+                    for (size_t x = 0; x < nbw; ++x, sptr += 16, dptr += 8)
+                    {
+                        memcpy(dptr, sptr + offset, 8);
+                    }
+                }
+                break;
+
+            case TRANSCODE_BC1_TO_BC7:
+                for (size_t x = 0; x < nbw; ++x, sptr += 8, dptr += 16)
+                {
+                    if (!BC1ToBC7Mode6(dptr, sptr))
+                    {
+                        XM_ALIGNED_DATA(16) XMVECTOR temp[NUM_PIXELS_PER_BLOCK];
+                        D3DXDecodeBC1(temp, sptr);
+                        D3DXEncodeBC7(dptr, temp, BC_FLAGS_NONE);
+                    }
+                }
+                break;
+
+            default:
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    HRESULT TranscodeImage(
+        const Image& srcImage,
+        TRANSCODE_OP op,
+        TEX_TRANSCODE_FLAGS flags,
+        const Image& destImage) noexcept
+    {
+        if (!srcImage.pixels || !destImage.pixels)
+            return E_POINTER;
+
+        if (srcImage.width != destImage.width || srcImage.height != destImage.height)
+            return E_FAIL;
+
+        const size_t nbh = std::max<size_t>(1, (srcImage.height + 3) / 4);
+
+        // Each task is a band of block rows
+        constexpr size_t ROWS_PER_TASK = 16;
+        const size_t taskCount = (nbh + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+
+        if ((flags & TEX_TRANSCODE_PARALLEL) && (taskCount > 1))
+        {
+            return ParallelFor(taskCount, 0, [&](size_t task, size_t) noexcept -> bool
+                {
+                    const size_t y0 = task * ROWS_PER_TASK;
+                    return TranscodeRows(srcImage, op, flags, destImage, y0, std::min(nbh, y0 + ROWS_PER_TASK));
+                });
+        }
+
+        return TranscodeRows(srcImage, op, flags, destImage, 0, nbh) ? S_OK : E_FAIL;
+    }
+}
+
+
+//=====================================================================================
+// Entry-points
+//=====================================================================================
+
+_Use_decl_annotations_
+bool DirectX::IsTranscodeSupported(DXGI_FORMAT srcFormat, DXGI_FORMAT destFormat) noexcept
+{
+    return GetTranscodeOp(srcFormat, destFormat) != TRANSCODE_NONE;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Transcoding between block compressed formats
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::Transcode(
+    const Image& srcImage,
+    DXGI_FORMAT format,
+    TEX_TRANSCODE_FLAGS flags,
+    ScratchImage& image) noexcept
+{
+    if (!srcImage.pixels)
+        return E_POINTER;
+
+    const TRANSCODE_OP op = GetTranscodeOp(srcImage.format, format);
+    if (op == TRANSCODE_NONE)
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if ((srcImage.width > UINT32_MAX) || (srcImage.height > UINT32_MAX))
+        return E_INVALIDARG;
+
+    HRESULT hr = image.Initialize2D(format, srcImage.width, srcImage.height, 1, 1);
+    if (FAILED(hr))
+        return hr;
+
+    const Image *rimage = image.GetImage(0, 0, 0);
+    if (!rimage)
+    {
+        image.Release();
+        return E_POINTER;
+    }
+
+    hr = TranscodeImage(srcImage, op, flags, *rimage);
+    if (FAILED(hr))
+    {
+        image.Release();
+        return hr;
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Transcoding between block compressed formats (complex)
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT DirectX::Transcode(
+    const Image* srcImages,
+    size_t nimages,
+    const TexMetadata& metadata,
+    DXGI_FORMAT format,
+    TEX_TRANSCODE_FLAGS flags,
+    ScratchImage& result) noexcept
+{
+    if (!srcImages || !nimages)
+        return E_INVALIDARG;
+
+    const TRANSCODE_OP op = GetTranscodeOp(metadata.format, format);
+    if (op == TRANSCODE_NONE)
+        return HRESULT_E_NOT_SUPPORTED;
+
+    if ((metadata.width > UINT32_MAX) || (metadata.height > UINT32_MAX))
+        return E_INVALIDARG;
+
+    TexMetadata mdata2 = metadata;
+    mdata2.format = format;
+
+    switch (op)
+    {
+    case TRANSCODE_COLOR_TO_BC1:
+        mdata2.SetAlphaMode(TEX_ALPHA_MODE_OPAQUE);
+        break;
+
+    case TRANSCODE_ALPHA_TO_BC4:
+    case TRANSCODE_BC5_TO_BC4:
+        mdata2.SetAlphaMode(TEX_ALPHA_MODE_UNKNOWN);
+        break;
+
+    default:
+        break;
+    }
+
+    HRESULT hr = result.Initialize(mdata2);
+    if (FAILED(hr))
+        return hr;
+
+    if (nimages != result.GetImageCount())
+    {
+        result.Release();
+        return E_FAIL;
+    }
+
+    const Image* dest = result.GetImages();
+    if (!dest)
+    {
+        result.Release();
+        return E_POINTER;
+    }
+
+    for (size_t index = 0; index < nimages; ++index)
+    {
+        const Image& src = srcImages[index];
+        if (src.format != metadata.format)
+        {
+            result.Release();
+            return E_FAIL;
+        }
+
+        hr = TranscodeImage(src, op, flags, dest[index]);
+        if (FAILED(hr))
+        {
+            result.Release();
+            return hr;
+        }
+    }
+
+    return S_OK;
+}
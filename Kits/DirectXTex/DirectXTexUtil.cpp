@@ -11,6 +11,9 @@
 
 #include "DirectXTexP.h"
 
+#include <atomic>
+#include <mutex>
+
 #if (defined(_XBOX_ONE) && defined(_TITLE)) || defined(_GAMING_XBOX)
 static_assert(XBOX_DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT == DXGI_FORMAT_R10G10B10_7E3_A2_FLOAT, "Xbox mismatch detected");
 static_assert(XBOX_DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT == DXGI_FORMAT_R10G10B10_6E4_A2_FLOAT, "Xbox mismatch detected");
@@ -124,6 +127,63 @@ namespace
 
 #define _aligned_free free
 #endif
+
+    //-------------------------------------------------------------------------------------
+    // Default allocator for ScratchImage and Blob
+    //-------------------------------------------------------------------------------------
+    class HeapAllocator : public IAllocator
+    {
+    public:
+        void* __cdecl Allocate(size_t size) noexcept override
+        {
+            return _aligned_malloc(size, 16);
+        }
+
+        void __cdecl Free(void* ptr, size_t) noexcept override
+        {
+            _aligned_free(ptr);
+        }
+    };
+
+    HeapAllocator g_HeapAllocator;
+    std::atomic<IAllocator*> g_DefaultAllocator(nullptr);
+
+    //-------------------------------------------------------------------------------------
+    // BufferPool buckets have four sizes per power of two, so at most 25% of a buffer is
+    // slack. Requests too large to round up without overflow are not pooled.
+    //-------------------------------------------------------------------------------------
+    constexpr size_t POOL_MIN_BUCKET = 256;
+    constexpr size_t POOL_MAX_SIZE = SIZE_MAX / 2;
+    constexpr size_t POOL_BUCKETS = 1 + (sizeof(size_t) * 8 - 9) * 4;
+
+    static_assert(POOL_MIN_BUCKET >= sizeof(void*), "Free buffers must be able to hold the list link");
+
+    size_t GetPoolBucket(size_t size, size_t& bucketSize) noexcept
+    {
+        assert(size > 0 && size <= POOL_MAX_SIZE);
+
+        if (size <= POOL_MIN_BUCKET)
+        {
+            bucketSize = POOL_MIN_BUCKET;
+            return 0;
+        }
+
+        // size is in (2^hb, 2^(hb+1)], which is split into four steps of 2^(hb-2)
+        size_t hb = 0;
+        for (size_t v = size - 1; v > 1; v >>= 1)
+        {
+            ++hb;
+        }
+
+        const size_t shift = hb - 2;
+        bucketSize = ((size - 1) >> shift) + 1;
+        const size_t quarter = bucketSize - 5;
+        bucketSize <<= shift;
+
+        const size_t bucket = 1 + (hb - 8) * 4 + quarter;
+        assert(bucket < POOL_BUCKETS);
+        return bucket;
+    }
 }
 
 
@@ -1510,6 +1570,150 @@ size_t TexMetadata::ComputeIndex(size_t mip, size_t item, size_t slice) const no
 }
 
 
+//=====================================================================================
+// Allocators for ScratchImage and Blob storage
+//=====================================================================================
+
+IAllocator* DirectX::GetDefaultAllocator() noexcept
+{
+    IAllocator* allocator = g_DefaultAllocator.load(std::memory_order_acquire);
+    return (allocator) ? allocator : &g_HeapAllocator;
+}
+
+_Use_decl_annotations_
+void DirectX::SetDefaultAllocator(IAllocator* allocator) noexcept
+{
+    g_DefaultAllocator.store(allocator, std::memory_order_release);
+}
+
+
+//-------------------------------------------------------------------------------------
+// BufferPool - Freed buffers are kept on an intrusive LIFO list per size bucket, so the
+// most recently used (and so most likely still resident) memory is handed out first.
+//-------------------------------------------------------------------------------------
+struct BufferPool::Impl
+{
+    std::mutex  mutex;
+    void*       freeList[POOL_BUCKETS];
+    size_t      cachedBytes;
+    size_t      maxCachedBytes;
+};
+
+_Use_decl_annotations_
+BufferPool::BufferPool(size_t maxCachedBytes) noexcept :
+    m_impl(new (std::nothrow) Impl)
+{
+    // Without the pool state, buffers come from and go straight back to the heap
+    if (m_impl)
+    {
+        memset(m_impl->freeList, 0, sizeof(m_impl->freeList));
+        m_impl->cachedBytes = 0;
+        m_impl->maxCachedBytes = maxCachedBytes;
+    }
+}
+
+BufferPool::~BufferPool()
+{
+    if (m_impl)
+    {
+        Trim();
+        delete m_impl;
+        m_impl = nullptr;
+    }
+}
+
+_Use_decl_annotations_
+void* BufferPool::Allocate(size_t size) noexcept
+{
+    if (!size)
+        return nullptr;
+
+    if (!m_impl || size > POOL_MAX_SIZE)
+        return _aligned_malloc(size, 16);
+
+    size_t bucketSize;
+    const size_t bucket = GetPoolBucket(size, bucketSize);
+
+    {
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+        void* ptr = m_impl->freeList[bucket];
+        if (ptr)
+        {
+            m_impl->freeList[bucket] = *static_cast<void**>(ptr);
+            m_impl->cachedBytes -= bucketSize;
+            return ptr;
+        }
+    }
+
+    void* ptr = _aligned_malloc(bucketSize, 16);
+    if (!ptr)
+    {
+        // Buffers cached in other buckets may be enough to satisfy the request
+        Trim();
+        ptr = _aligned_malloc(bucketSize, 16);
+    }
+
+    return ptr;
+}
+
+_Use_decl_annotations_
+void BufferPool::Free(void* ptr, size_t size) noexcept
+{
+    if (!ptr)
+        return;
+
+    if (m_impl && size > 0 && size <= POOL_MAX_SIZE)
+    {
+        size_t bucketSize;
+        const size_t bucket = GetPoolBucket(size, bucketSize);
+
+        std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+        if (!m_impl->maxCachedBytes || (m_impl->cachedBytes + bucketSize) <= m_impl->maxCachedBytes)
+        {
+            *static_cast<void**>(ptr) = m_impl->freeList[bucket];
+            m_impl->freeList[bucket] = ptr;
+            m_impl->cachedBytes += bucketSize;
+            return;
+        }
+    }
+
+    _aligned_free(ptr);
+}
+
+void BufferPool::Trim() noexcept
+{
+    if (!m_impl)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+
+    for (size_t bucket = 0; bucket < POOL_BUCKETS; ++bucket)
+    {
+        void* ptr = m_impl->freeList[bucket];
+        while (ptr)
+        {
+            void* next = *static_cast<void**>(ptr);
+            _aligned_free(ptr);
+            ptr = next;
+        }
+        m_impl->freeList[bucket] = nullptr;
+    }
+
+    m_impl->cachedBytes = 0;
+}
+
+size_t BufferPool::GetCachedBytes() const noexcept
+{
+    if (!m_impl)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->cachedBytes;
+}
+
+
 //=====================================================================================
 // Blob - Bitmap image container
 //=====================================================================================
@@ -1522,9 +1726,12 @@ Blob& Blob::operator= (Blob&& moveFrom) noexcept
 
         m_buffer = moveFrom.m_buffer;
         m_size = moveFrom.m_size;
+        m_capacity = moveFrom.m_capacity;
+        m_allocator = moveFrom.m_allocator;
 
         moveFrom.m_buffer = nullptr;
         moveFrom.m_size = 0;
+        moveFrom.m_capacity = 0;
     }
     return *this;
 }
@@ -1533,11 +1740,12 @@ void Blob::Release() noexcept
 {
     if (m_buffer)
     {
-        _aligned_free(m_buffer);
+        m_allocator->Free(m_buffer, m_capacity);
         m_buffer = nullptr;
     }
 
     m_size = 0;
+    m_capacity = 0;
 }
 
 _Use_decl_annotations_
@@ -1548,14 +1756,14 @@ HRESULT Blob::Initialize(size_t size) noexcept
 
     Release();
 
-    m_buffer = _aligned_malloc(size, 16);
+    m_buffer = m_allocator->Allocate(size);
     if (!m_buffer)
     {
         Release();
         return E_OUTOFMEMORY;
     }
 
-    m_size = size;
+    m_size = m_capacity = size;
 
     return S_OK;
 }
@@ -1584,7 +1792,7 @@ HRESULT Blob::Resize(size_t size) noexcept
     if (!m_buffer || !m_size)
         return E_UNEXPECTED;
 
-    void *tbuffer = _aligned_malloc(size, 16);
+    void *tbuffer = m_allocator->Allocate(size);
     if (!tbuffer)
         return E_OUTOFMEMORY;
 
@@ -1593,7 +1801,7 @@ HRESULT Blob::Resize(size_t size) noexcept
     Release();
 
     m_buffer = tbuffer;
-    m_size = size;
+    m_size = m_capacity = size;
 
     return S_OK;
 }
@@ -45,6 +45,19 @@ namespace Xbox
     constexpr XboxTileMode c_XboxTileModeLinear = XG_TILE_MODE_LINEAR;
 #endif
 
+    enum XBOX_TILE_FLAGS : unsigned long
+    {
+        XBOX_TILE_FLAGS_NONE = 0x0,
+
+        XBOX_TILE_FLAGS_ADDRESS_TABLE = 0x1,
+            // Computes the element swizzle once per tile and copies whole runs, instead of querying XG for each element
+
+        XBOX_TILE_FLAGS_PARALLEL = 0x10000000,
+            // Copies tiles using multiple threads (implies XBOX_TILE_FLAGS_ADDRESS_TABLE)
+    };
+
+    DEFINE_ENUM_FLAG_OPERATORS(XBOX_TILE_FLAGS);
+
     class XboxImage
     {
     public:
@@ -103,12 +116,15 @@ namespace Xbox
     //---------------------------------------------------------------------------------
     // Xbox Texture Tiling / Detiling (requires XG DLL to be present at runtime)
 
-    HRESULT Tile(_In_ const DirectX::Image& srcImage, _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid);
+    HRESULT Tile(
+        _In_ const DirectX::Image& srcImage, _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid,
+        _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_FLAGS_NONE);
     HRESULT Tile(
         _In_ const DirectX::Image* srcImages, _In_ size_t nimages, _In_ const DirectX::TexMetadata& metadata,
-        _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid);
+        _Out_ XboxImage& xbox, _In_ XboxTileMode mode = c_XboxTileModeInvalid,
+        _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_FLAGS_NONE);
 
-    HRESULT Detile(_In_ const XboxImage& xbox, _Out_ DirectX::ScratchImage& image);
+    HRESULT Detile(_In_ const XboxImage& xbox, _Out_ DirectX::ScratchImage& image, _In_ XBOX_TILE_FLAGS flags = XBOX_TILE_FLAGS_NONE);
 
     //---------------------------------------------------------------------------------
     // Direct3D 11.X functions
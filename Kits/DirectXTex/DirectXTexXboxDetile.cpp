@@ -9,6 +9,7 @@
 
 #include "DirectXTexP.h"
 #include "DirectXTexXbox.h"
+#include "DirectXTexXboxTileTable.h"
 
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
@@ -193,6 +194,105 @@ namespace
         return S_OK;
     }
 
+    //----------------------------------------------------------------------------------
+    // Copies a surface through an address table built from the XG computer, rather than
+    // querying XG for every element. The table is built for the first item or slice of a
+    // level and rebased for the rest, unless their element pattern differs.
+    //----------------------------------------------------------------------------------
+    HRESULT DetileByTable(
+        TileAddressTable& table,
+        const XboxImage& xbox,
+        uint32_t level,
+        uint32_t item,
+        _In_ XGTextureAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        _Out_ uint8_t* pixels,
+        size_t rowPitch,
+        size_t bpe,
+        size_t w,
+        size_t h,
+        XBOX_TILE_FLAGS flags)
+    {
+        const TileAddressTable::AddressFunc address =
+            [&](size_t x, size_t y) -> size_t
+            {
+            #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
+                return computer->GetTexelElementOffsetBytes(0, level, x, static_cast<UINT32>(y), item, 0, nullptr);
+            #else
+                return computer->GetTexelElementOffsetBytes(0, level, x, static_cast<UINT32>(y), item, 0);
+            #endif
+            };
+
+        HRESULT hr = table.IsInitialized() ? table.Rebase(address) : S_FALSE;
+        if (hr == S_FALSE)
+            hr = table.Initialize(w, h, bpe, address);
+        if (FAILED(hr))
+            return hr;
+
+        return table.Detile(xbox.GetPointer(), layout.SizeBytes, pixels, rowPitch, (flags & XBOX_TILE_FLAGS_PARALLEL) != 0);
+    }
+
+    //----------------------------------------------------------------------------------
+    inline HRESULT DetileByTable2D(
+        const XboxImage& xbox,
+        uint32_t level,
+        _In_ XGTextureAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        _In_reads_(nimages) const Image* const * result,
+        size_t nimages,
+        size_t bpe,
+        size_t w,
+        size_t h,
+        XBOX_TILE_FLAGS flags)
+    {
+        TileAddressTable table;
+        for (uint32_t item = 0; item < nimages; ++item)
+        {
+            const Image* img = result[item];
+            if (!img || !img->pixels)
+                return E_POINTER;
+
+            assert(img->width == result[0]->width);
+            assert(img->height == result[0]->height);
+            assert(img->rowPitch == result[0]->rowPitch);
+            assert(img->format == result[0]->format);
+
+            const HRESULT hr = DetileByTable(table, xbox, level, item, computer, layout, img->pixels, img->rowPitch, bpe, w, h, flags);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+    //----------------------------------------------------------------------------------
+    inline HRESULT DetileByTable3D(
+        const XboxImage& xbox,
+        uint32_t level,
+        uint32_t slices,
+        _In_ XGTextureAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        const Image& result,
+        size_t bpe,
+        size_t w,
+        size_t h,
+        XBOX_TILE_FLAGS flags)
+    {
+        uint8_t* dptr = result.pixels;
+
+        TileAddressTable table;
+        for (uint32_t z = 0; z < slices; ++z)
+        {
+            const HRESULT hr = DetileByTable(table, xbox, level, z, computer, layout, dptr, result.rowPitch, bpe, w, h, flags);
+            if (FAILED(hr))
+                return hr;
+
+            dptr += result.slicePitch;
+        }
+
+        return S_OK;
+    }
+
     //-------------------------------------------------------------------------------------
     // 1D Tiling
     //-------------------------------------------------------------------------------------
@@ -319,7 +419,8 @@ namespace
         _In_ XGTextureAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
         _In_reads_(nimages) const Image** result,
-        size_t nimages)
+        size_t nimages,
+        XBOX_TILE_FLAGS flags)
     {
         if (!nimages)
             return E_INVALIDARG;
@@ -341,6 +442,8 @@ namespace
             byelement = true;
     #endif
 
+        const bool bytable = (flags & (XBOX_TILE_FLAGS_ADDRESS_TABLE | XBOX_TILE_FLAGS_PARALLEL)) != 0;
+
         if (IsCompressed(format))
         {
             //--- BC formats use per-block copy -------------------------------------------
@@ -358,6 +461,9 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
+            if (bytable)
+                return DetileByTable2D(xbox, level, computer, layout, result, nimages, bpb, nbw, nbh, flags);
+
             return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpb, nbw, nbh, false);
         }
         else if (IsPacked(format))
@@ -385,11 +491,21 @@ namespace
             assert(w == layout.Plane[0].MipLayout[level].WidthElements);
             assert(h == layout.Plane[0].MipLayout[level].HeightElements);
 
+            if (bytable)
+                return DetileByTable2D(xbox, level, computer, layout, result, nimages, bpp, w, h, flags);
+
             return DetileByElement2D(xbox, level, computer, layout, result, nimages, bpp, w, h, false);
         }
         else
         {
             //--- Standard format handling ------------------------------------------------
+            const size_t bpp = (BitsPerPixel(format) + 7) / 8;
+            if (bytable && bpp == layout.Plane[0].BytesPerElement)
+            {
+                // Elements are copied as-is, so no format conversion is needed
+                return DetileByTable2D(xbox, level, computer, layout, result, nimages, bpp, result[0]->width, result[0]->height, flags);
+            }
+
             auto& mip = layout.Plane[0].MipLayout[level];
 
             const UINT32 tiledPixels = mip.PaddedWidthElements * mip.PaddedHeightElements * mip.PaddedDepthOrArraySize;
@@ -466,7 +582,8 @@ namespace
         uint32_t slices,
         _In_ XGTextureAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const Image& result)
+        const Image& result,
+        XBOX_TILE_FLAGS flags)
     {
         if (!computer || !xbox.GetPointer() || !result.pixels)
             return E_POINTER;
@@ -481,6 +598,8 @@ namespace
         const bool byelement = IsTypeless(result.format);
     #endif
 
+        const bool bytable = (flags & (XBOX_TILE_FLAGS_ADDRESS_TABLE | XBOX_TILE_FLAGS_PARALLEL)) != 0;
+
         if (IsCompressed(result.format))
         {
             //--- BC formats use per-block copy -------------------------------------------
@@ -498,6 +617,9 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
+            if (bytable)
+                return DetileByTable3D(xbox, level, slices, computer, layout, result, bpb, nbw, nbh, flags);
+
             return DetileByElement3D(xbox, level, slices, computer, layout, result, bpb, nbw, nbh, false);
         }
         else if (IsPacked(result.format))
@@ -520,11 +642,21 @@ namespace
             assert(result.width == layout.Plane[0].MipLayout[level].WidthElements);
             assert(result.height == layout.Plane[0].MipLayout[level].HeightElements);
 
+            if (bytable)
+                return DetileByTable3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, flags);
+
             return DetileByElement3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, false);
         }
         else
         {
             //--- Standard format handling ------------------------------------------------
+            const size_t bpp = (BitsPerPixel(result.format) + 7) / 8;
+            if (bytable && bpp == layout.Plane[0].BytesPerElement)
+            {
+                // Elements are copied as-is, so no format conversion is needed
+                return DetileByTable3D(xbox, level, slices, computer, layout, result, bpp, result.width, result.height, flags);
+            }
+
             auto& mip = layout.Plane[0].MipLayout[level];
 
             const UINT32 tiledPixels = mip.PaddedWidthElements * mip.PaddedHeightElements * mip.PaddedDepthOrArraySize;
@@ -619,7 +751,8 @@ namespace
 _Use_decl_annotations_
 HRESULT Xbox::Detile(
     const XboxImage& xbox,
-    DirectX::ScratchImage& image)
+    DirectX::ScratchImage& image,
+    XBOX_TILE_FLAGS flags)
 {
     if (!xbox.GetSize() || !xbox.GetPointer() || xbox.GetTileMode() == c_XboxTileModeInvalid)
         return E_INVALIDARG;
@@ -783,7 +916,7 @@ HRESULT Xbox::Detile(
                         images.push_back(img);
                     }
 
-                    hr = Detile2D(xbox, level, computer.Get(), layout, &images[0], images.size());
+                    hr = Detile2D(xbox, level, computer.Get(), layout, &images[0], images.size(), flags);
                 }
                 else
                 {
@@ -794,7 +927,7 @@ HRESULT Xbox::Detile(
                         return E_FAIL;
                     }
 
-                    hr = Detile2D(xbox, level, computer.Get(), layout, &img, 1);
+                    hr = Detile2D(xbox, level, computer.Get(), layout, &img, 1, flags);
                 }
 
                 if (FAILED(hr))
@@ -854,7 +987,7 @@ HRESULT Xbox::Detile(
                 }
 
                 // Relies on the fact that slices are contiguous
-                hr = Detile3D(xbox, level, d, computer.Get(), layout, image.GetImages()[index]);
+                hr = Detile3D(xbox, level, d, computer.Get(), layout, image.GetImages()[index], flags);
                 if (FAILED(hr))
                 {
                     image.Release();
@@ -9,6 +9,7 @@
 
 #include "DirectXTexP.h"
 #include "DirectXTexXbox.h"
+#include "DirectXTexXboxTileTable.h"
 
 //#define VERBOSE
 
@@ -195,6 +196,106 @@ namespace
         return S_OK;
     }
 
+    //----------------------------------------------------------------------------------
+    // Copies a surface through an address table built from the XG computer, rather than
+    // querying XG for every element. The table is built for the first item or slice of a
+    // level and rebased for the rest, unless their element pattern differs.
+    //----------------------------------------------------------------------------------
+    HRESULT TileByTable(
+        TileAddressTable& table,
+        _In_ const uint8_t* pixels,
+        size_t rowPitch,
+        uint32_t level,
+        uint32_t item,
+        _In_ XGTextureAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        const XboxImage& xbox,
+        size_t bpe,
+        size_t w,
+        size_t h,
+        XBOX_TILE_FLAGS flags)
+    {
+        const TileAddressTable::AddressFunc address =
+            [&](size_t x, size_t y) -> size_t
+            {
+            #if defined(_GAMING_XBOX_SCARLETT) || defined(_USE_SCARLETT)
+                return computer->GetTexelElementOffsetBytes(0, level, x, static_cast<UINT32>(y), item, 0, nullptr);
+            #else
+                return computer->GetTexelElementOffsetBytes(0, level, x, static_cast<UINT32>(y), item, 0);
+            #endif
+            };
+
+        HRESULT hr = table.IsInitialized() ? table.Rebase(address) : S_FALSE;
+        if (hr == S_FALSE)
+            hr = table.Initialize(w, h, bpe, address);
+        if (FAILED(hr))
+            return hr;
+
+        return table.Tile(pixels, rowPitch, xbox.GetPointer(), layout.SizeBytes, (flags & XBOX_TILE_FLAGS_PARALLEL) != 0);
+    }
+
+    //----------------------------------------------------------------------------------
+    inline HRESULT TileByTable2D(
+        _In_reads_(nimages) const Image* const * images,
+        size_t nimages,
+        uint32_t level,
+        _In_ XGTextureAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        const XboxImage& xbox,
+        size_t bpe,
+        size_t w,
+        size_t h,
+        XBOX_TILE_FLAGS flags)
+    {
+        TileAddressTable table;
+        for (uint32_t item = 0; item < nimages; ++item)
+        {
+            const Image* img = images[item];
+
+            if (!img || !img->pixels)
+                return E_POINTER;
+
+            assert(img->width == images[0]->width);
+            assert(img->height == images[0]->height);
+            assert(img->rowPitch == images[0]->rowPitch);
+            assert(img->format == images[0]->format);
+
+            const HRESULT hr = TileByTable(table, img->pixels, img->rowPitch, level, item, computer, layout, xbox, bpe, w, h, flags);
+            if (FAILED(hr))
+                return hr;
+        }
+
+        return S_OK;
+    }
+
+    //----------------------------------------------------------------------------------
+    inline HRESULT TileByTable3D(
+        const Image& image,
+        uint32_t level,
+        uint32_t slices,
+        _In_ XGTextureAddressComputer* computer,
+        const XG_RESOURCE_LAYOUT& layout,
+        const XboxImage& xbox,
+        size_t bpe,
+        size_t w,
+        size_t h,
+        XBOX_TILE_FLAGS flags)
+    {
+        const uint8_t* sptr = image.pixels;
+
+        TileAddressTable table;
+        for (uint32_t z = 0; z < slices; ++z)
+        {
+            const HRESULT hr = TileByTable(table, sptr, image.rowPitch, level, z, computer, layout, xbox, bpe, w, h, flags);
+            if (FAILED(hr))
+                return hr;
+
+            sptr += image.slicePitch;
+        }
+
+        return S_OK;
+    }
+
     //----------------------------------------------------------------------------------
 #ifdef VERBOSE
     void DebugPrintDesc(const XG_TEXTURE1D_DESC& desc)
@@ -404,7 +505,8 @@ namespace
         uint32_t level,
         _In_ XGTextureAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const XboxImage& xbox)
+        const XboxImage& xbox,
+        XBOX_TILE_FLAGS flags)
     {
         if (!nimages)
             return E_INVALIDARG;
@@ -424,6 +526,8 @@ namespace
             byelement = true;
     #endif
 
+        const bool bytable = (flags & (XBOX_TILE_FLAGS_ADDRESS_TABLE | XBOX_TILE_FLAGS_PARALLEL)) != 0;
+
         if (IsCompressed(format))
         {
             //--- BC formats use per-block copy -------------------------------------------
@@ -441,6 +545,9 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
+            if (bytable)
+                return TileByTable2D(images, nimages, level, computer, layout, xbox, bpb, nbw, nbh, flags);
+
             return TileByElement2D(images, nimages, level, computer, layout, xbox, bpb, nbw, nbh, false);
         }
         else if (IsPacked(format))
@@ -468,11 +575,21 @@ namespace
             assert(w == layout.Plane[0].MipLayout[level].WidthElements);
             assert(h == layout.Plane[0].MipLayout[level].HeightElements);
 
+            if (bytable)
+                return TileByTable2D(images, nimages, level, computer, layout, xbox, bpp, w, h, flags);
+
             return TileByElement2D(images, nimages, level, computer, layout, xbox, bpp, w, h, false);
         }
         else
         {
             //--- Standard format handling ------------------------------------------------
+            const size_t bpp = (BitsPerPixel(format) + 7) / 8;
+            if (bytable && bpp == layout.Plane[0].BytesPerElement)
+            {
+                // Elements are copied as-is, so no format conversion is needed
+                return TileByTable2D(images, nimages, level, computer, layout, xbox, bpp, images[0]->width, images[0]->height, flags);
+            }
+
             auto& mip = layout.Plane[0].MipLayout[level];
 
             const UINT32 tiledPixels = mip.PaddedWidthElements * mip.PaddedHeightElements * mip.PaddedDepthOrArraySize;
@@ -549,7 +666,8 @@ namespace
         uint32_t slices,
         _In_ XGTextureAddressComputer* computer,
         const XG_RESOURCE_LAYOUT& layout,
-        const XboxImage& xbox)
+        const XboxImage& xbox,
+        XBOX_TILE_FLAGS flags)
     {
         if (!image.pixels || !computer || !xbox.GetPointer())
             return E_POINTER;
@@ -566,6 +684,8 @@ namespace
         const bool byelement = IsTypeless(image.format);
     #endif
 
+        const bool bytable = (flags & (XBOX_TILE_FLAGS_ADDRESS_TABLE | XBOX_TILE_FLAGS_PARALLEL)) != 0;
+
         if (IsCompressed(image.format))
         {
             //--- BC formats use per-block copy -------------------------------------------
@@ -583,6 +703,9 @@ namespace
             assert(nbh == layout.Plane[0].MipLayout[level].HeightElements);
             assert(bpb == layout.Plane[0].BytesPerElement);
 
+            if (bytable)
+                return TileByTable3D(image, level, slices, computer, layout, xbox, bpb, nbw, nbh, flags);
+
             return TileByElement3D(image, level, slices, computer, layout, xbox, bpb, nbw, nbh, false);
         }
         else if (IsPacked(image.format))
@@ -605,11 +728,21 @@ namespace
             assert(image.width == layout.Plane[0].MipLayout[level].WidthElements);
             assert(image.height == layout.Plane[0].MipLayout[level].HeightElements);
 
+            if (bytable)
+                return TileByTable3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, flags);
+
             return TileByElement3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, false);
         }
         else
         {
             //--- Standard format handling ------------------------------------------------
+            const size_t bpp = (BitsPerPixel(image.format) + 7) / 8;
+            if (bytable && bpp == layout.Plane[0].BytesPerElement)
+            {
+                // Elements are copied as-is, so no format conversion is needed
+                return TileByTable3D(image, level, slices, computer, layout, xbox, bpp, image.width, image.height, flags);
+            }
+
             auto& mip = layout.Plane[0].MipLayout[level];
 
             const UINT32 tiledPixels = mip.PaddedWidthElements * mip.PaddedHeightElements * mip.PaddedDepthOrArraySize;
@@ -704,7 +837,8 @@ _Use_decl_annotations_
 HRESULT Xbox::Tile(
     const DirectX::Image& srcImage,
     XboxImage& xbox,
-    XboxTileMode mode)
+    XboxTileMode mode,
+    XBOX_TILE_FLAGS flags)
 {
     if (!srcImage.pixels
         || srcImage.width > D3D11_REQ_TEXTURE2D_U_OR_V_DIMENSION
@@ -766,7 +900,7 @@ HRESULT Xbox::Tile(
         return hr;
 
     const Image* images = &srcImage;
-    hr = Tile2D(&images, 1, 0, computer.Get(), layout, xbox);
+    hr = Tile2D(&images, 1, 0, computer.Get(), layout, xbox, flags);
     if (FAILED(hr))
     {
         xbox.Release();
@@ -786,7 +920,8 @@ HRESULT Xbox::Tile(
     size_t nimages,
     const DirectX::TexMetadata& metadata,
     XboxImage& xbox,
-    XboxTileMode mode)
+    XboxTileMode mode,
+    XBOX_TILE_FLAGS flags)
 {
     if (!srcImages
         || !nimages
@@ -979,7 +1114,7 @@ HRESULT Xbox::Tile(
                         images.push_back(&srcImages[index]);
                     }
 
-                    hr = Tile2D(&images[0], images.size(), level, computer.Get(), layout, xbox);
+                    hr = Tile2D(&images[0], images.size(), level, computer.Get(), layout, xbox, flags);
                 }
                 else
                 {
@@ -991,7 +1126,7 @@ HRESULT Xbox::Tile(
                     }
 
                     const Image* images = &srcImages[index];
-                    hr = Tile2D(&images, 1, level, computer.Get(), layout, xbox);
+                    hr = Tile2D(&images, 1, level, computer.Get(), layout, xbox, flags);
                 }
 
                 if (FAILED(hr))
@@ -1055,7 +1190,7 @@ HRESULT Xbox::Tile(
                 }
 
                 // Relies on the fact that slices are contiguous
-                hr = Tile3D(srcImages[index], level, d, computer.Get(), layout, xbox);
+                hr = Tile3D(srcImages[index], level, d, computer.Get(), layout, xbox, flags);
                 if (FAILED(hr))
                 {
                     xbox.Release();
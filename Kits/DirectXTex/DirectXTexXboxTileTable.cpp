@@ -0,0 +1,676 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXTexXboxTileTable.cpp
+//
+// DirectXTex Auxillary functions for Xbox tiling using precomputed address tables
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#include "DirectXTexp.h"
+#include "DirectXTexXboxTileTable.h"
+
+using namespace DirectX;
+using namespace DirectX::Internal;
+using namespace Xbox;
+
+namespace
+{
+    constexpr size_t c_InvalidAddress = size_t(-1);
+
+    // Largest power of two below n, so split tiles stay aligned to the swizzle
+    inline size_t SplitSize(size_t n) noexcept
+    {
+        size_t p = 1;
+        while (p * 2 < n)
+            p *= 2;
+        return p;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Checks that the tiles next to the origin tile use the same element pattern as it.
+    // Returns S_FALSE if they do not.
+    //----------------------------------------------------------------------------------
+    HRESULT CheckRepeats(
+        const TileAddressTable::AddressFunc& address,
+        size_t width,
+        size_t height,
+        size_t tw,
+        size_t th,
+        _Out_writes_(tw * th) size_t* pattern)
+    {
+        const size_t cw = std::min(tw, width);
+        const size_t ch = std::min(th, height);
+
+        for (size_t j = 0; j < ch; ++j)
+        {
+            for (size_t i = 0; i < cw; ++i)
+            {
+                const size_t addr = address(i, j);
+                if (addr == c_InvalidAddress)
+                    return E_FAIL;
+
+                pattern[j * tw + i] = addr;
+            }
+        }
+
+        const size_t origin = pattern[0];
+
+        const size_t neighbors[3][2] = { { tw, 0 }, { 0, th }, { tw, th } };
+        for (auto& n : neighbors)
+        {
+            const size_t nx = n[0];
+            const size_t ny = n[1];
+            if (nx >= width || ny >= height)
+                continue;
+
+            const size_t base = address(nx, ny);
+            if (base == c_InvalidAddress)
+                return E_FAIL;
+
+            const size_t nw = std::min(tw, width - nx);
+            const size_t nh = std::min(th, height - ny);
+            for (size_t j = 0; j < nh; ++j)
+            {
+                for (size_t i = 0; i < nw; ++i)
+                {
+                    const size_t addr = address(nx + i, ny + j);
+                    if (addr == c_InvalidAddress)
+                        return E_FAIL;
+
+                    // Unsigned wrap-around keeps this exact for elements before the tile origin
+                    if ((addr - base) != (pattern[j * tw + i] - origin))
+                        return S_FALSE;
+                }
+            }
+        }
+
+        return S_OK;
+    }
+}
+
+
+//=====================================================================================
+// TileAddressTable
+//=====================================================================================
+
+TileAddressTable::TileAddressTable() noexcept :
+    m_width(0),
+    m_height(0),
+    m_bytesPerElement(0),
+    m_tileWidth(0),
+    m_tileHeight(0),
+    m_tilesX(0),
+    m_tilesY(0),
+    m_minAddress(0),
+    m_maxAddress(0)
+{
+}
+
+TileAddressTable::TileAddressTable(TileAddressTable&& moveFrom) noexcept :
+    m_width(0),
+    m_height(0),
+    m_bytesPerElement(0),
+    m_tileWidth(0),
+    m_tileHeight(0),
+    m_tilesX(0),
+    m_tilesY(0),
+    m_minAddress(0),
+    m_maxAddress(0)
+{
+    *this = std::move(moveFrom);
+}
+
+TileAddressTable& TileAddressTable::operator= (TileAddressTable&& moveFrom) noexcept
+{
+    if (this != &moveFrom)
+    {
+        m_width = moveFrom.m_width;
+        m_height = moveFrom.m_height;
+        m_bytesPerElement = moveFrom.m_bytesPerElement;
+        m_tileWidth = moveFrom.m_tileWidth;
+        m_tileHeight = moveFrom.m_tileHeight;
+        m_tilesX = moveFrom.m_tilesX;
+        m_tilesY = moveFrom.m_tilesY;
+        m_minAddress = moveFrom.m_minAddress;
+        m_maxAddress = moveFrom.m_maxAddress;
+        m_spans = std::move(moveFrom.m_spans);
+        m_rowSpans = std::move(moveFrom.m_rowSpans);
+        m_bases = std::move(moveFrom.m_bases);
+
+        moveFrom.Release();
+    }
+    return *this;
+}
+
+TileAddressTable::~TileAddressTable()
+{
+    Release();
+}
+
+
+//-------------------------------------------------------------------------------------
+// Builds the table by querying the addressing function
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT TileAddressTable::Initialize(
+    size_t width,
+    size_t height,
+    size_t bytesPerElement,
+    const AddressFunc& address,
+    size_t maxTileBytes) noexcept
+{
+    Release();
+
+    if (!width || !height || !bytesPerElement || !address)
+        return E_INVALIDARG;
+
+    if (width > UINT32_MAX || height > UINT32_MAX)
+        return E_INVALIDARG;
+
+    const size_t maxTileElements = std::max<size_t>(1, maxTileBytes / bytesPerElement);
+
+    std::unique_ptr<size_t[]> pattern(new (std::nothrow) size_t[maxTileElements]);
+    if (!pattern)
+        return E_OUTOFMEMORY;
+
+    try
+    {
+        // Find the largest power-of-two tile that repeats next to the origin, growing the
+        // shorter side first
+        size_t tw = 1;
+        size_t th = 1;
+        for (;;)
+        {
+            bool grown = false;
+            for (size_t pass = 0; pass < 2 && !grown; ++pass)
+            {
+                const bool growX = ((tw <= th) == (pass == 0));
+                if (growX ? (tw >= width) : (th >= height))
+                    continue;
+
+                const size_t ntw = growX ? tw * 2 : tw;
+                const size_t nth = growX ? th : th * 2;
+                if (ntw * nth > maxTileElements)
+                    continue;
+
+                const HRESULT hr = CheckRepeats(address, width, height, ntw, nth, pattern.get());
+                if (FAILED(hr))
+                    return hr;
+
+                if (hr == S_OK)
+                {
+                    tw = ntw;
+                    th = nth;
+                    grown = true;
+                }
+            }
+
+            if (!grown)
+                break;
+        }
+
+        // A tile larger than the surface is just the surface
+        tw = std::min(tw, width);
+        th = std::min(th, height);
+
+        // Some modes vary the swizzle with the position of the tile further out, in which
+        // case the tile is split until every tile matches. A single element always does.
+        for (;;)
+        {
+            bool splitX = false;
+            const HRESULT hr = Build(width, height, bytesPerElement, address, tw, th, pattern.get(), splitX);
+            if (hr != S_FALSE)
+            {
+                if (FAILED(hr))
+                    Release();
+                return hr;
+            }
+
+            if (splitX)
+            {
+                assert(tw > 1);
+                tw = SplitSize(tw);
+            }
+            else
+            {
+                assert(th > 1);
+                th = SplitSize(th);
+            }
+        }
+    }
+    catch (...)
+    {
+        Release();
+        return E_FAIL;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Builds the swizzle runs and tile bases for a given tile size. Returns S_FALSE if a
+// tile does not match the pattern, with splitX giving the axis on which it failed.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT TileAddressTable::Build(
+    size_t width,
+    size_t height,
+    size_t bytesPerElement,
+    const AddressFunc& address,
+    size_t tw,
+    size_t th,
+    size_t* pattern,
+    bool& splitX)
+{
+    Release();
+
+    for (size_t j = 0; j < th; ++j)
+    {
+        for (size_t i = 0; i < tw; ++i)
+        {
+            const size_t addr = address(i, j);
+            if (addr == c_InvalidAddress)
+                return E_FAIL;
+
+            pattern[j * tw + i] = addr;
+        }
+    }
+
+    const size_t origin = pattern[0];
+
+    // Merge elements that are also adjacent in the tiled layout into runs
+    m_spans.reset(new (std::nothrow) Span[tw * th]);
+    m_rowSpans.reset(new (std::nothrow) size_t[th + 1]);
+    if (!m_spans || !m_rowSpans)
+        return E_OUTOFMEMORY;
+
+    size_t spanCount = 0;
+    for (size_t j = 0; j < th; ++j)
+    {
+        m_rowSpans[j] = spanCount;
+
+        const size_t* row = pattern + j * tw;
+        for (size_t i = 0; i < tw;)
+        {
+            size_t count = 1;
+            while ((i + count) < tw && row[i + count] == row[i + count - 1] + bytesPerElement)
+                ++count;
+
+            Span& span = m_spans[spanCount++];
+            span.x = static_cast<uint32_t>(i);
+            span.count = static_cast<uint32_t>(count);
+            span.offset = static_cast<ptrdiff_t>(row[i] - origin);
+
+            i += count;
+        }
+    }
+    m_rowSpans[th] = spanCount;
+
+    m_width = width;
+    m_height = height;
+    m_bytesPerElement = bytesPerElement;
+    m_tileWidth = tw;
+    m_tileHeight = th;
+    m_tilesX = (width + tw - 1) / tw;
+    m_tilesY = (height + th - 1) / th;
+
+    m_bases.reset(new (std::nothrow) size_t[m_tilesX * m_tilesY]);
+    if (!m_bases)
+        return E_OUTOFMEMORY;
+
+    // Locate each tile, checking it against the pattern for each coordinate bit. The
+    // swizzle modes combine coordinate bits, so this finds a mismatched tile early.
+    m_minAddress = c_InvalidAddress;
+    m_maxAddress = 0;
+    for (size_t ty = 0; ty < m_tilesY; ++ty)
+    {
+        const size_t y0 = ty * th;
+        const size_t ch = std::min(th, height - y0);
+
+        for (size_t tx = 0; tx < m_tilesX; ++tx)
+        {
+            const size_t x0 = tx * tw;
+            const size_t cw = std::min(tw, width - x0);
+
+            const size_t base = address(x0, y0);
+            if (base == c_InvalidAddress)
+                return E_FAIL;
+
+            for (size_t i = 1; i < cw; i <<= 1)
+            {
+                if (address(x0 + i, y0) - base != pattern[i] - origin)
+                {
+                    splitX = true;
+                    return S_FALSE;
+                }
+            }
+
+            for (size_t j = 1; j < ch; j <<= 1)
+            {
+                if (address(x0, y0 + j) - base != pattern[j * tw] - origin)
+                {
+                    splitX = false;
+                    return S_FALSE;
+                }
+            }
+
+            // Bounds of the elements this tile actually covers
+            ptrdiff_t lo = 0;
+            ptrdiff_t hi = 0;
+            for (size_t j = 0; j < ch; ++j)
+            {
+                for (size_t s = m_rowSpans[j]; s < m_rowSpans[j + 1] && m_spans[s].x < cw; ++s)
+                {
+                    const Span& span = m_spans[s];
+                    const size_t count = std::min<size_t>(span.count, cw - span.x);
+                    lo = std::min(lo, span.offset);
+                    hi = std::max(hi, span.offset + static_cast<ptrdiff_t>((count - 1) * bytesPerElement));
+                }
+            }
+
+            if (lo < 0 && static_cast<size_t>(-lo) > base)
+                return E_FAIL;
+
+            m_minAddress = std::min(m_minAddress, base - static_cast<size_t>(-lo));
+            m_maxAddress = std::max(m_maxAddress, base + static_cast<size_t>(hi) + bytesPerElement);
+            m_bases[ty * m_tilesX + tx] = base;
+        }
+    }
+
+    // The coordinate bit checks hold for the Xbox modes, but every element is compared as
+    // well so that any other layout splits the tile rather than being copied incorrectly
+    for (size_t ty = 0; ty < m_tilesY; ++ty)
+    {
+        const size_t y0 = ty * th;
+        const size_t ch = std::min(th, height - y0);
+
+        for (size_t tx = 0; tx < m_tilesX; ++tx)
+        {
+            const size_t x0 = tx * tw;
+            const size_t cw = std::min(tw, width - x0);
+            const size_t base = m_bases[ty * m_tilesX + tx];
+
+            for (size_t j = 0; j < ch; ++j)
+            {
+                for (size_t i = 0; i < cw; ++i)
+                {
+                    if (address(x0 + i, y0 + j) != base + (pattern[j * tw + i] - origin))
+                    {
+                        splitX = (tw > 1) && (tw >= th || th == 1);
+                        return S_FALSE;
+                    }
+                }
+            }
+        }
+    }
+
+    return S_OK;
+}
+
+
+//-------------------------------------------------------------------------------------
+// Moves the table to another surface whose elements sit at a constant offset from the
+// current one. Each tile is checked one coordinate bit at a time, as Build does.
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT TileAddressTable::Rebase(const AddressFunc& address) noexcept
+{
+    if (!m_bases)
+        return E_UNEXPECTED;
+
+    if (!address)
+        return E_INVALIDARG;
+
+    try
+    {
+        const size_t origin = address(0, 0);
+        if (origin == c_InvalidAddress)
+            return E_FAIL;
+
+        // Unsigned wrap-around keeps the delta exact when the new surface comes first, but
+        // the bounds of the surface must not wrap or the size checks would be defeated
+        const size_t delta = origin - m_bases[0];
+        if (origin < m_bases[0] && (m_bases[0] - origin) > m_minAddress)
+            return S_FALSE;
+
+        if ((m_maxAddress + delta) < (m_minAddress + delta))
+            return S_FALSE;
+
+        // The first tile is compared element by element, so a swizzle that differs between
+        // surfaces (such as one mixing in the array index) is caught even if its bits line up
+        {
+            const size_t cw = std::min(m_tileWidth, m_width);
+            const size_t ch = std::min(m_tileHeight, m_height);
+            for (size_t j = 0; j < ch; ++j)
+            {
+                for (size_t i = 0; i < cw; ++i)
+                {
+                    if (address(i, j) != origin + static_cast<size_t>(ElementOffset(i, j)))
+                        return S_FALSE;
+                }
+            }
+        }
+
+        // Offsets of the single-bit coordinates within a tile
+        ptrdiff_t bitsX[64] = {};
+        ptrdiff_t bitsY[64] = {};
+        size_t nbitsX = 0;
+        size_t nbitsY = 0;
+        for (size_t i = 1; i < m_tileWidth; i <<= 1)
+            bitsX[nbitsX++] = ElementOffset(i, 0);
+        for (size_t j = 1; j < m_tileHeight; j <<= 1)
+            bitsY[nbitsY++] = ElementOffset(0, j);
+
+        for (size_t ty = 0; ty < m_tilesY; ++ty)
+        {
+            const size_t y0 = ty * m_tileHeight;
+            const size_t ch = std::min(m_tileHeight, m_height - y0);
+
+            for (size_t tx = 0; tx < m_tilesX; ++tx)
+            {
+                const size_t x0 = tx * m_tileWidth;
+                const size_t cw = std::min(m_tileWidth, m_width - x0);
+
+                const size_t base = m_bases[ty * m_tilesX + tx] + delta;
+                if (address(x0, y0) != base)
+                    return S_FALSE;
+
+                size_t bit = 0;
+                for (size_t i = 1; i < cw; i <<= 1, ++bit)
+                {
+                    if (address(x0 + i, y0) != base + static_cast<size_t>(bitsX[bit]))
+                        return S_FALSE;
+                }
+
+                bit = 0;
+                for (size_t j = 1; j < ch; j <<= 1, ++bit)
+                {
+                    if (address(x0, y0 + j) != base + static_cast<size_t>(bitsY[bit]))
+                        return S_FALSE;
+                }
+            }
+        }
+
+        for (size_t t = 0; t < m_tilesX * m_tilesY; ++t)
+        {
+            m_bases[t] += delta;
+        }
+        m_minAddress += delta;
+        m_maxAddress += delta;
+
+    #ifdef _DEBUG
+        for (size_t y = 0; y < m_height; ++y)
+        {
+            for (size_t x = 0; x < m_width; ++x)
+            {
+                const size_t expected = m_bases[(y / m_tileHeight) * m_tilesX + (x / m_tileWidth)]
+                    + static_cast<size_t>(ElementOffset(x % m_tileWidth, y % m_tileHeight));
+                assert(address(x, y) == expected);
+            }
+        }
+    #endif
+
+        return S_OK;
+    }
+    catch (...)
+    {
+        return E_FAIL;
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Byte offset of an element from its tile origin
+//-------------------------------------------------------------------------------------
+ptrdiff_t TileAddressTable::ElementOffset(size_t x, size_t y) const noexcept
+{
+    assert(x < m_tileWidth && y < m_tileHeight);
+
+    size_t s = m_rowSpans[y];
+    while (s + 1 < m_rowSpans[y + 1] && m_spans[s + 1].x <= x)
+        ++s;
+
+    return m_spans[s].offset + static_cast<ptrdiff_t>((x - m_spans[s].x) * m_bytesPerElement);
+}
+
+
+//-------------------------------------------------------------------------------------
+// Releases the table
+//-------------------------------------------------------------------------------------
+void TileAddressTable::Release() noexcept
+{
+    m_width = m_height = 0;
+    m_bytesPerElement = 0;
+    m_tileWidth = m_tileHeight = 0;
+    m_tilesX = m_tilesY = 0;
+    m_minAddress = m_maxAddress = 0;
+    m_spans.reset();
+    m_rowSpans.reset();
+    m_bases.reset();
+}
+
+
+//-------------------------------------------------------------------------------------
+// Copies one row of tiles between the tiled and linear layouts
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+void TileAddressTable::CopyTileRow(
+    size_t tileRow,
+    uint8_t* tiled,
+    uint8_t* linear,
+    size_t rowPitch,
+    bool detile) const noexcept
+{
+    const size_t y0 = tileRow * m_tileHeight;
+    const size_t ch = std::min(m_tileHeight, m_height - y0);
+
+    for (size_t tx = 0; tx < m_tilesX; ++tx)
+    {
+        const size_t x0 = tx * m_tileWidth;
+        const size_t cw = std::min(m_tileWidth, m_width - x0);
+
+        uint8_t* tptr = tiled + m_bases[tileRow * m_tilesX + tx];
+        uint8_t* lptr = linear + y0 * rowPitch + x0 * m_bytesPerElement;
+
+        for (size_t j = 0; j < ch; ++j)
+        {
+            for (size_t s = m_rowSpans[j]; s < m_rowSpans[j + 1]; ++s)
+            {
+                const Span& span = m_spans[s];
+                if (span.x >= cw)
+                    break;
+
+                const size_t bytes = std::min<size_t>(span.count, cw - span.x) * m_bytesPerElement;
+                uint8_t* tspan = tptr + span.offset;
+                uint8_t* lspan = lptr + span.x * m_bytesPerElement;
+
+                if (detile)
+                    memcpy(lspan, tspan, bytes);
+                else
+                    memcpy(tspan, lspan, bytes);
+            }
+
+            lptr += rowPitch;
+        }
+    }
+}
+
+
+//-------------------------------------------------------------------------------------
+// Convert between tiled and linear layouts
+//-------------------------------------------------------------------------------------
+_Use_decl_annotations_
+HRESULT TileAddressTable::Detile(
+    const uint8_t* tiled,
+    size_t tiledSize,
+    uint8_t* linear,
+    size_t rowPitch,
+    bool parallel) const noexcept
+{
+    if (!m_bases)
+        return E_UNEXPECTED;
+
+    if (!tiled || !linear)
+        return E_POINTER;
+
+    if (m_maxAddress > tiledSize || rowPitch < m_width * m_bytesPerElement)
+        return E_FAIL;
+
+    // The tiled surface is only read when detiling
+    auto tptr = const_cast<uint8_t*>(tiled);
+
+    if (parallel && m_tilesY > 1)
+    {
+        return ParallelFor(m_tilesY, 0,
+            [&](size_t tileRow, size_t) noexcept -> bool
+            {
+                CopyTileRow(tileRow, tptr, linear, rowPitch, true);
+                return true;
+            });
+    }
+
+    for (size_t tileRow = 0; tileRow < m_tilesY; ++tileRow)
+    {
+        CopyTileRow(tileRow, tptr, linear, rowPitch, true);
+    }
+
+    return S_OK;
+}
+
+_Use_decl_annotations_
+HRESULT TileAddressTable::Tile(
+    const uint8_t* linear,
+    size_t rowPitch,
+    uint8_t* tiled,
+    size_t tiledSize,
+    bool parallel) const noexcept
+{
+    if (!m_bases)
+        return E_UNEXPECTED;
+
+    if (!tiled || !linear)
+        return E_POINTER;
+
+    if (m_maxAddress > tiledSize || rowPitch < m_width * m_bytesPerElement)
+        return E_FAIL;
+
+    // The linear surface is only read when tiling
+    auto lptr = const_cast<uint8_t*>(linear);
+
+    if (parallel && m_tilesY > 1)
+    {
+        return ParallelFor(m_tilesY, 0,
+            [&](size_t tileRow, size_t) noexcept -> bool
+            {
+                CopyTileRow(tileRow, tiled, lptr, rowPitch, false);
+                return true;
+            });
+    }
+
+    for (size_t tileRow = 0; tileRow < m_tilesY; ++tileRow)
+    {
+        CopyTileRow(tileRow, tiled, lptr, rowPitch, false);
+    }
+
+    return S_OK;
+}
@@ -0,0 +1,101 @@
+//--------------------------------------------------------------------------------------
+// File: DirectXTexXboxTileTable.h
+//
+// DirectXTex Auxillary functions for Xbox tiling using precomputed address tables
+//
+// This header has no dependency on XG so the address tables can be driven by
+// synthetic addressing functions on any host.
+//
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT License.
+//--------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace Xbox
+{
+    //---------------------------------------------------------------------------------
+    // Element address pattern for one 2D surface of a tiled resource (a mip level of an
+    // array item, or one slice of a volume).
+    //
+    // The surface is split into a grid of equally sized tiles which all share the same
+    // element swizzle, so the swizzle is stored once and each tile only keeps its base
+    // offset. This holds for the Xbox tile and swizzle modes, which form addresses by
+    // combining bits of the element coordinates, and is verified element by element as the
+    // table is built.
+    class TileAddressTable
+    {
+    public:
+        using AddressFunc = std::function<size_t __cdecl(size_t x, size_t y)>;
+            // Returns the byte offset of the element at (x,y), or size_t(-1) on failure
+
+        TileAddressTable() noexcept;
+        TileAddressTable(TileAddressTable&&) noexcept;
+        TileAddressTable& operator= (TileAddressTable&&) noexcept;
+        ~TileAddressTable();
+
+        TileAddressTable(const TileAddressTable&) = delete;
+        TileAddressTable& operator=(const TileAddressTable&) = delete;
+
+        HRESULT __cdecl Initialize(
+            _In_ size_t width, _In_ size_t height, _In_ size_t bytesPerElement,
+            _In_ const AddressFunc& address, _In_ size_t maxTileBytes = 65536) noexcept;
+            // width and height are in elements (blocks for BC formats)
+
+        HRESULT __cdecl Rebase(_In_ const AddressFunc& address) noexcept;
+            // Moves an initialized table to another surface with the same element pattern at a different
+            // offset, such as the next array item or volume slice, without rebuilding the swizzle runs.
+            // Returns S_FALSE and leaves the table unchanged if the pattern differs; use Initialize then.
+
+        HRESULT __cdecl Detile(
+            _In_reads_bytes_(tiledSize) const uint8_t* tiled, _In_ size_t tiledSize,
+            _Out_ uint8_t* linear, _In_ size_t rowPitch, _In_ bool parallel) const noexcept;
+        HRESULT __cdecl Tile(
+            _In_ const uint8_t* linear, _In_ size_t rowPitch,
+            _Inout_updates_bytes_(tiledSize) uint8_t* tiled, _In_ size_t tiledSize, _In_ bool parallel) const noexcept;
+            // Copies whole runs of elements per tile; tiles are distributed across threads
+            // when parallel is set. Padding in the tiled surface is not written.
+
+        void __cdecl Release() noexcept;
+
+        bool IsInitialized() const noexcept { return m_bases != nullptr; }
+
+        size_t GetTileWidth() const noexcept { return m_tileWidth; }
+        size_t GetTileHeight() const noexcept { return m_tileHeight; }
+
+    private:
+        struct Span
+        {
+            uint32_t    x;          // First element of the run within the tile row
+            uint32_t    count;      // Number of elements which are also contiguous when tiled
+            ptrdiff_t   offset;     // Byte offset of the first element from the tile origin
+        };
+
+        HRESULT __cdecl Build(
+            size_t width, size_t height, size_t bytesPerElement, const AddressFunc& address,
+            size_t tw, size_t th, _Out_writes_(tw * th) size_t* pattern, _Out_ bool& splitX);
+
+        ptrdiff_t __cdecl ElementOffset(size_t x, size_t y) const noexcept;
+
+        void __cdecl CopyTileRow(
+            size_t tileRow, _Inout_ uint8_t* tiled, _Inout_ uint8_t* linear, size_t rowPitch, bool detile) const noexcept;
+
+        size_t                      m_width;
+        size_t                      m_height;
+        size_t                      m_bytesPerElement;
+        size_t                      m_tileWidth;
+        size_t                      m_tileHeight;
+        size_t                      m_tilesX;
+        size_t                      m_tilesY;
+        size_t                      m_minAddress;
+        size_t                      m_maxAddress;
+        std::unique_ptr<Span[]>     m_spans;
+        std::unique_ptr<size_t[]>   m_rowSpans;
+        std::unique_ptr<size_t[]>   m_bases;
+    };
+}
@@ -421,6 +421,36 @@ namespace DirectX
             _Inout_updates_all_(count) XMVECTOR* pBuffer, _In_ size_t count,
             _In_ DXGI_FORMAT outFormat, _In_ DXGI_FORMAT inFormat, _In_ TEX_FILTER_FLAGS flags) noexcept;
 
+        //---------------------------------------------------------------------------------
+        // Resize helper functions
+        HRESULT __cdecl ResizeSeparableFilter(
+            _In_ const Image& srcImage, _In_ TEX_FILTER_FLAGS filter, _In_ const Image& destImage) noexcept;
+        HRESULT __cdecl ResizeSeparableFilter(
+            _In_reads_(srcCount) const Image* srcImages, _In_ size_t srcCount,
+            _In_reads_(destCount) const Image* destImages, _In_ size_t destCount,
+            _In_ bool volume, _In_ TEX_FILTER_FLAGS filter) noexcept;
+            // Non-WIC resize between existing images with the linear, cubic, triangle, Lanczos3 or Mitchell filter
+            // With volume, the images are slices filtered along depth; otherwise destImages[i] is resized from srcImages[i]
+            // Honors TEX_FILTER_PARALLEL by spreading bands of rows across all of the destination images
+
+        //---------------------------------------------------------------------------------
+        // Task scheduling helper functions
+        size_t __cdecl GetWorkerCount(_In_ size_t threadCount, _In_ size_t taskCount) noexcept;
+            // Resolves a requested thread count (0 for hardware concurrency) against the amount of work
+
+        HRESULT __cdecl ParallelFor(
+            _In_ size_t taskCount, _In_ size_t threadCount,
+            _In_ const std::function<bool __cdecl(size_t task, size_t worker)>& taskFunc) noexcept;
+            // Runs taskFunc for each task index on a persistent pool of work-stealing workers, where worker is in the
+            // range [0, GetWorkerCount(threadCount, taskCount)). Returns E_FAIL if any task returns false or throws,
+            // or E_OUTOFMEMORY if one throws std::bad_alloc; no further tasks are started after a failure.
+            // Calls made while the pool is busy (from another thread, or nested inside a task) use their own threads.
+
+        //---------------------------------------------------------------------------------
+        // Hashing helper functions
+        uint64_t __cdecl HashBytes(_In_reads_bytes_(size) const void* data, _In_ size_t size, _In_ uint64_t seed) noexcept;
+            // Fast non-cryptographic 64-bit hash; chain calls by passing the previous result as the seed
+
         //---------------------------------------------------------------------------------
         // Misc helper functions
         bool __cdecl IsAlphaAllOpaqueBC(_In_ const Image& cImage) noexcept;
@@ -418,5 +418,338 @@ namespace DirectX
             return S_OK;
         }
 
+
+        //-------------------------------------------------------------------------------------
+        // Separable (polyphase) filtering helpers
+        //-------------------------------------------------------------------------------------
+
+        struct FilterTap
+        {
+            size_t      src;
+            size_t      dest;
+            float       weight;
+        };
+
+        // Lanczos windowed sinc with a = 3
+        inline float LanczosKernel(_In_ float x) noexcept
+        {
+            x = fabsf(x);
+            if (x < 1e-6f)
+                return 1.f;
+
+            if (x >= 3.f)
+                return 0.f;
+
+            const float px = XM_PI * x;
+            return 3.f * sinf(px) * sinf(px / 3.f) / (px * px);
+        }
+
+        // Mitchell-Netravali cubic with B = C = 1/3
+        inline float MitchellKernel(_In_ float x) noexcept
+        {
+            constexpr float B = 1.f / 3.f;
+            constexpr float C = 1.f / 3.f;
+
+            x = fabsf(x);
+            const float x2 = x * x;
+            const float x3 = x2 * x;
+
+            if (x < 1.f)
+            {
+                return ((12.f - 9.f * B - 6.f * C) * x3 + (-18.f + 12.f * B + 6.f * C) * x2 + (6.f - 2.f * B)) / 6.f;
+            }
+            else if (x < 2.f)
+            {
+                return ((-B - 6.f * C) * x3 + (6.f * B + 30.f * C) * x2 + (-12.f * B - 48.f * C) * x + (8.f * B + 24.f * C)) / 6.f;
+            }
+
+            return 0.f;
+        }
+
+        // Samples a kernel of the given radius, widened by the scale factor when minifying
+        inline HRESULT CreateKernelTaps(
+            _In_ float(*kernel)(float), _In_ float radius,
+            _In_ size_t source, _In_ size_t dest, _In_ bool wrap, _In_ bool mirror,
+            _Inout_ std::unique_ptr<FilterTap[]>& taps, _Out_ size_t& count) noexcept
+        {
+            assert(source > 0);
+            assert(dest > 0);
+
+            count = 0;
+
+            const float scale = float(source) / float(dest);
+            const float filterScale = std::max(1.f, scale);
+            const float support = radius * filterScale;
+            const size_t maxTaps = size_t(ceilf(support * 2.f)) + 1;
+
+            taps.reset(new (std::nothrow) FilterTap[dest * maxTaps]);
+            if (!taps)
+                return E_OUTOFMEMORY;
+
+            const ptrdiff_t maxu = ptrdiff_t(source) - 1;
+
+            for (size_t u = 0; u < dest; ++u)
+            {
+                const float center = (float(u) + 0.5f) * scale - 0.5f;
+                const auto left = static_cast<ptrdiff_t>(floorf(center - support)) + 1;
+                const auto right = static_cast<ptrdiff_t>(floorf(center + support));
+
+                const size_t first = count;
+                float total = 0.f;
+
+                for (ptrdiff_t k = left; k <= right && (count - first) < maxTaps; ++k)
+                {
+                    const float weight = kernel((float(k) - center) / filterScale);
+                    if (weight == 0.f)
+                        continue;
+
+                    taps[count++] = { size_t(bounduvw(k, maxu, wrap, mirror)), u, weight };
+                    total += weight;
+                }
+
+                if (count == first || fabsf(total) < TF_EPSILON)
+                {
+                    // Degenerate case, so fall back to the nearest source pixel
+                    count = first;
+                    const auto nearest = static_cast<ptrdiff_t>(floorf(center + 0.5f));
+                    taps[count++] = { size_t(bounduvw(nearest, maxu, wrap, mirror)), u, 1.f };
+                }
+                else
+                {
+                    // Normalize so that flat regions are preserved
+                    for (size_t j = first; j < count; ++j)
+                    {
+                        taps[j].weight /= total;
+                    }
+                }
+            }
+
+            return S_OK;
+        }
+
+        // Reduces a filter mode to a list of (source, destination, weight) taps for one axis
+        inline HRESULT CreateFilterTaps(
+            _In_ unsigned long filterSelect,
+            _In_ size_t source, _In_ size_t dest, _In_ bool wrap, _In_ bool mirror,
+            _Inout_ std::unique_ptr<FilterTap[]>& taps, _Out_ size_t& count) noexcept
+        {
+            assert(source > 0);
+            assert(dest > 0);
+
+            count = 0;
+
+            switch (filterSelect)
+            {
+            case TEX_FILTER_POINT:
+                {
+                    taps.reset(new (std::nothrow) FilterTap[dest]);
+                    if (!taps)
+                        return E_OUTOFMEMORY;
+
+                    const size_t inc = (source << 16) / dest;
+
+                    size_t s = 0;
+                    for (size_t u = 0; u < dest; ++u)
+                    {
+                        taps[count++] = { s >> 16, u, 1.f };
+                        s += inc;
+                    }
+                }
+                break;
+
+            case TEX_FILTER_BOX:
+                {
+                    // Degenerate axes (1 to 1) are an identity, matching what the box mip generator does
+                    const bool identity = (source == 1) && (dest == 1);
+                    if (!identity && (dest << 1) != source)
+                        return E_FAIL;
+
+                    taps.reset(new (std::nothrow) FilterTap[dest * 2]);
+                    if (!taps)
+                        return E_OUTOFMEMORY;
+
+                    for (size_t u = 0; u < dest; ++u)
+                    {
+                        if (identity)
+                        {
+                            taps[count++] = { u, u, 1.f };
+                        }
+                        else
+                        {
+                            taps[count++] = { u * 2, u, 0.5f };
+                            taps[count++] = { u * 2 + 1, u, 0.5f };
+                        }
+                    }
+                }
+                break;
+
+            case TEX_FILTER_LINEAR:
+                {
+                    std::unique_ptr<LinearFilter[]> lf(new (std::nothrow) LinearFilter[dest]);
+                    taps.reset(new (std::nothrow) FilterTap[dest * 2]);
+                    if (!lf || !taps)
+                        return E_OUTOFMEMORY;
+
+                    CreateLinearFilter(source, dest, wrap, lf.get());
+
+                    for (size_t u = 0; u < dest; ++u)
+                    {
+                        auto const& entry = lf[u];
+                        taps[count++] = { entry.u0, u, entry.weight0 };
+                        taps[count++] = { entry.u1, u, entry.weight1 };
+                    }
+                }
+                break;
+
+            case TEX_FILTER_CUBIC:
+                {
+                    std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[dest]);
+                    taps.reset(new (std::nothrow) FilterTap[dest * 4]);
+                    if (!cf || !taps)
+                        return E_OUTOFMEMORY;
+
+                    CreateCubicFilter(source, dest, wrap, mirror, cf.get());
+
+                    for (size_t u = 0; u < dest; ++u)
+                    {
+                        auto const& entry = cf[u];
+
+                        // Per-tap weights of the CUBIC_INTERPOLATE polynomial
+                        const float x = entry.x;
+                        const float x2 = x * x;
+                        const float x3 = x2 * x;
+
+                        const float w0 = -x / 3.f + x2 / 2.f - x3 / 6.f;
+                        const float w2 = x + x2 / 2.f - x3 / 2.f;
+                        const float w3 = (x3 - x) / 6.f;
+                        const float w1 = 1.f - w0 - w2 - w3;
+
+                        taps[count++] = { entry.u0, u, w0 };
+                        taps[count++] = { entry.u1, u, w1 };
+                        taps[count++] = { entry.u2, u, w2 };
+                        taps[count++] = { entry.u3, u, w3 };
+                    }
+                }
+                break;
+
+            case TEX_FILTER_TRIANGLE:
+                {
+                    std::unique_ptr<Filter> tf;
+                    HRESULT hr = CreateTriangleFilter(source, dest, wrap, tf);
+                    if (FAILED(hr))
+                        return hr;
+
+                    auto fromEnd = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(tf.get()) + tf->sizeInBytes);
+
+                    size_t total = 0;
+                    for (const FilterFrom* from = tf->from; from < fromEnd; )
+                    {
+                        total += from->count;
+                        from = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(from) + from->sizeInBytes);
+                    }
+
+                    taps.reset(new (std::nothrow) FilterTap[std::max<size_t>(total, 1)]);
+                    if (!taps)
+                        return E_OUTOFMEMORY;
+
+                    size_t u = 0;
+                    for (const FilterFrom* from = tf->from; from < fromEnd; ++u)
+                    {
+                        for (size_t j = 0; j < from->count; ++j)
+                        {
+                            assert(from->to[j].u < dest);
+                            taps[count++] = { u, from->to[j].u, from->to[j].weight };
+                        }
+
+                        from = reinterpret_cast<const FilterFrom*>(reinterpret_cast<const uint8_t*>(from) + from->sizeInBytes);
+                    }
+                }
+                break;
+
+            case TEX_FILTER_LANCZOS3:
+                return CreateKernelTaps(LanczosKernel, 3.f, source, dest, wrap, mirror, taps, count);
+
+            case TEX_FILTER_MITCHELL:
+                return CreateKernelTaps(MitchellKernel, 2.f, source, dest, wrap, mirror, taps, count);
+
+            default:
+                return HRESULT_E_NOT_SUPPORTED;
+            }
+
+            return S_OK;
+        }
+
+        // Taps grouped by destination pixel, so each output is a gather over its own taps
+        struct PolyphaseFilter
+        {
+            size_t                          count;
+            size_t                          maxTaps;
+            std::unique_ptr<size_t[]>       offsets;    // count + 1 entries
+            std::unique_ptr<FilterTap[]>    taps;
+            std::unique_ptr<float[]>        phases;     // Cubic only, CubicFilter::x of each destination pixel
+
+            PolyphaseFilter() noexcept : count(0), maxTaps(0) {}
+        };
+
+        inline HRESULT CreatePolyphaseFilter(
+            _In_ unsigned long filterSelect,
+            _In_ size_t source, _In_ size_t dest, _In_ bool wrap, _In_ bool mirror,
+            _Out_ PolyphaseFilter& pf) noexcept
+        {
+            std::unique_ptr<FilterTap[]> taps;
+            size_t tapCount = 0;
+            HRESULT hr = CreateFilterTaps(filterSelect, source, dest, wrap, mirror, taps, tapCount);
+            if (FAILED(hr))
+                return hr;
+
+            pf.offsets.reset(new (std::nothrow) size_t[dest + 1]);
+            pf.taps.reset(new (std::nothrow) FilterTap[std::max<size_t>(tapCount, 1)]);
+            std::unique_ptr<size_t[]> cursor(new (std::nothrow) size_t[dest]);
+            if (!pf.offsets || !pf.taps || !cursor)
+                return E_OUTOFMEMORY;
+
+            memset(pf.offsets.get(), 0, sizeof(size_t) * (dest + 1));
+
+            for (size_t j = 0; j < tapCount; ++j)
+            {
+                assert(taps[j].dest < dest);
+                ++pf.offsets[taps[j].dest + 1];
+            }
+
+            pf.maxTaps = 0;
+            for (size_t u = 0; u < dest; ++u)
+            {
+                pf.maxTaps = std::max(pf.maxTaps, pf.offsets[u + 1]);
+                pf.offsets[u + 1] += pf.offsets[u];
+            }
+
+            memcpy(cursor.get(), pf.offsets.get(), sizeof(size_t) * dest);
+
+            for (size_t j = 0; j < tapCount; ++j)
+            {
+                pf.taps[cursor[taps[j].dest]++] = taps[j];
+            }
+
+            if (filterSelect == TEX_FILTER_CUBIC)
+            {
+                // The taps are applied through CUBIC_INTERPOLATE, which needs the fractional position
+                std::unique_ptr<CubicFilter[]> cf(new (std::nothrow) CubicFilter[dest]);
+                pf.phases.reset(new (std::nothrow) float[dest]);
+                if (!cf || !pf.phases)
+                    return E_OUTOFMEMORY;
+
+                CreateCubicFilter(source, dest, wrap, mirror, cf.get());
+
+                for (size_t u = 0; u < dest; ++u)
+                {
+                    pf.phases[u] = cf[u].x;
+                }
+            }
+
+            pf.count = dest;
+
+            return S_OK;
+        }
+
     } // namespace Filters
 } // namespace DirectX
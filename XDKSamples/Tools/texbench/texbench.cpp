@@ -0,0 +1,877 @@
+//--------------------------------------------------------------------------------------
+// File: TexBench.cpp
+//
+// Throughput benchmarks for the DirectX Texture Library CPU codecs
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#ifndef _M_X64
+#error This tool is only supported for x64 native
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NODRAWTEXT
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <vector>
+
+#include <d3d11.h>
+#include <dxgiformat.h>
+
+#pragma warning(disable : 4619 4616 4091 4838 26812)
+
+#include "DirectXTexP.h"
+#include "BC.h"
+
+#include "DirectXPackedVector.h"
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+    enum BENCHMARKS : uint32_t
+    {
+        BENCH_BC = 0x1,
+        BENCH_SCANLINE = 0x2,
+        BENCH_TGA = 0x4,
+        BENCH_ALL = 0xFFFFFFFF,
+    };
+
+    struct SValue
+    {
+        const wchar_t*  name;
+        uint32_t        value;
+    };
+
+    const SValue g_pBenchmarks[] =
+    {
+        { L"bc",        BENCH_BC },
+        { L"scanline",  BENCH_SCANLINE },
+        { L"tga",       BENCH_TGA },
+        { L"all",       BENCH_ALL },
+        { nullptr,      0 }
+    };
+
+    uint32_t LookupByName(const wchar_t *pName, const SValue *pArray)
+    {
+        while (pArray->name)
+        {
+            if (!_wcsicmp(pName, pArray->name))
+                return pArray->value;
+
+            pArray++;
+        }
+
+        return 0;
+    }
+
+    void PrintLogo()
+    {
+        wprintf(L"Microsoft (R) DirectX Texture Library Benchmark\n");
+        wprintf(L"Copyright (C) Microsoft Corp. All rights reserved.\n");
+#ifdef _DEBUG
+        wprintf(L"*** Debug build ***\n");
+#endif
+        wprintf(L"\n");
+    }
+
+    void PrintUsage()
+    {
+        PrintLogo();
+
+        wprintf(L"Usage: texbench <options> [benchmark...]\n\n");
+        wprintf(L"   -w <n>              width of the synthetic test image (default 2048)\n");
+        wprintf(L"   -h <n>              height of the synthetic test image (default 2048)\n");
+        wprintf(L"   -r <n>              timed repetitions, best time is reported (default 5)\n");
+        wprintf(L"\n   <benchmark>: ");
+
+        for (const SValue* pValue = g_pBenchmarks; pValue->name; ++pValue)
+        {
+            wprintf(L"%ls ", pValue->name);
+        }
+
+        wprintf(L"\n");
+    }
+
+    //----------------------------------------------------------------------------------
+    // Timing helpers
+    //----------------------------------------------------------------------------------
+    class Timer
+    {
+    public:
+        Timer() noexcept : m_start{}
+        {
+            std::ignore = QueryPerformanceFrequency(&m_freq);
+        }
+
+        void Start() noexcept { std::ignore = QueryPerformanceCounter(&m_start); }
+
+        double Elapsed() const noexcept
+        {
+            LARGE_INTEGER end = {};
+            std::ignore = QueryPerformanceCounter(&end);
+            return double(end.QuadPart - m_start.QuadPart) / double(m_freq.QuadPart);
+        }
+
+    private:
+        LARGE_INTEGER m_freq;
+        LARGE_INTEGER m_start;
+    };
+
+    // Runs the work once to warm caches, then reports the best of 'reps' timed runs in seconds
+    template<typename F>
+    double BestOf(size_t reps, F&& work)
+    {
+        work();
+
+        Timer timer;
+        double best = 0.;
+        for (size_t j = 0; j < reps; ++j)
+        {
+            timer.Start();
+            work();
+            const double t = timer.Elapsed();
+            if (!j || t < best)
+                best = t;
+        }
+
+        return best;
+    }
+
+    void Report(const wchar_t* name, double seconds, double items, const wchar_t* units, double baseline = 0.)
+    {
+        wprintf(L"  %-36ls %10.3f ms %14.0f %ls/sec", name, seconds * 1000., items / seconds, units);
+        if (baseline > 0.)
+        {
+            wprintf(L"  (%.2fx)", baseline / seconds);
+        }
+        wprintf(L"\n");
+    }
+
+    //----------------------------------------------------------------------------------
+    // Synthetic content: smooth gradients with a little per-pixel noise, which gives the
+    // endpoint searches realistic work instead of flat or pure noise blocks
+    //----------------------------------------------------------------------------------
+    uint32_t NextRandom(uint32_t& state) noexcept
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    void FillTestPixels(_Out_writes_(width * height) XMVECTOR* pixels, size_t width, size_t height) noexcept
+    {
+        uint32_t seed = 0x2545F491u;
+        for (size_t y = 0; y < height; ++y)
+        {
+            const float fy = float(y) / float(height);
+            for (size_t x = 0; x < width; ++x)
+            {
+                const float fx = float(x) / float(width);
+                const float noise = float(NextRandom(seed) & 0xFF) / 2550.f;
+                const float wave = 0.5f + 0.5f * sinf(fx * 40.f + fy * 13.f);
+                *pixels++ = XMVectorSaturate(XMVectorSet(
+                    fx + noise,
+                    fy + noise,
+                    wave * 0.8f + noise,
+                    (x & 64) ? 1.f : wave));
+            }
+        }
+    }
+
+    //----------------------------------------------------------------------------------
+    // BC1/BC3: per-block encoders against the batched encoders, on the same blocks
+    //----------------------------------------------------------------------------------
+    bool BenchmarkBC(size_t width, size_t height, size_t reps)
+    {
+        const size_t bw = std::max<size_t>(1, width / 4);
+        const size_t bh = std::max<size_t>(1, height / 4);
+        const size_t nblocks = bw * bh;
+
+        auto image = make_AlignedArrayXMVECTOR(uint64_t(nblocks) * NUM_PIXELS_PER_BLOCK);
+        auto blocks = make_AlignedArrayXMVECTOR(uint64_t(nblocks) * NUM_PIXELS_PER_BLOCK);
+        if (!image || !blocks)
+            return false;
+
+        // Gather the image into consecutive 4x4 blocks, the layout CompressBC hands the encoders
+        FillTestPixels(image.get(), bw * 4, bh * 4);
+        for (size_t by = 0; by < bh; ++by)
+        {
+            for (size_t bx = 0; bx < bw; ++bx)
+            {
+                XMVECTOR* pBlock = blocks.get() + (by * bw + bx) * NUM_PIXELS_PER_BLOCK;
+                for (size_t y = 0; y < 4; ++y)
+                {
+                    memcpy(pBlock + y * 4, image.get() + (by * 4 + y) * bw * 4 + bx * 4, sizeof(XMVECTOR) * 4);
+                }
+            }
+        }
+        image.reset();
+
+        std::vector<uint8_t> single(nblocks * 16);
+        std::vector<uint8_t> batch(nblocks * 16);
+
+        wprintf(L"BC1/BC3 encode, %zu blocks\n", nblocks);
+
+        static const struct
+        {
+            const wchar_t*  name;
+            uint32_t        flags;
+        } s_modes[] =
+        {
+            { L"",              BC_FLAGS_NONE },
+            { L" uniform",      BC_FLAGS_UNIFORM },
+            { L" dither",       BC_FLAGS_DITHER_RGB | BC_FLAGS_DITHER_A },
+        };
+
+        bool identical = true;
+        for (const auto& mode : s_modes)
+        {
+            wchar_t name[64] = {};
+
+            // BC1
+            const double t1 = BestOf(reps, [&]()
+                {
+                    for (size_t j = 0; j < nblocks; ++j)
+                    {
+                        D3DXEncodeBC1(&single[j * 8], blocks.get() + j * NUM_PIXELS_PER_BLOCK, TEX_THRESHOLD_DEFAULT, mode.flags);
+                    }
+                });
+            swprintf_s(name, L"D3DXEncodeBC1%ls", mode.name);
+            Report(name, t1, double(nblocks), L"blocks");
+
+            const double t2 = BestOf(reps, [&]()
+                {
+                    D3DXEncodeBC1Batch(batch.data(), blocks.get(), nblocks, TEX_THRESHOLD_DEFAULT, mode.flags);
+                });
+            swprintf_s(name, L"D3DXEncodeBC1Batch%ls", mode.name);
+            Report(name, t2, double(nblocks), L"blocks", t1);
+
+            if (memcmp(single.data(), batch.data(), nblocks * 8) != 0)
+            {
+                wprintf(L"  ERROR: batched BC1%ls output differs from the per-block encoder\n", mode.name);
+                identical = false;
+            }
+
+            // BC3
+            const double t3 = BestOf(reps, [&]()
+                {
+                    for (size_t j = 0; j < nblocks; ++j)
+                    {
+                        D3DXEncodeBC3(&single[j * 16], blocks.get() + j * NUM_PIXELS_PER_BLOCK, mode.flags);
+                    }
+                });
+            swprintf_s(name, L"D3DXEncodeBC3%ls", mode.name);
+            Report(name, t3, double(nblocks), L"blocks");
+
+            const double t4 = BestOf(reps, [&]()
+                {
+                    D3DXEncodeBC3Batch(batch.data(), blocks.get(), nblocks, mode.flags);
+                });
+            swprintf_s(name, L"D3DXEncodeBC3Batch%ls", mode.name);
+            Report(name, t4, double(nblocks), L"blocks", t3);
+
+            if (memcmp(single.data(), batch.data(), nblocks * 16) != 0)
+            {
+                wprintf(L"  ERROR: batched BC3%ls output differs from the per-block encoder\n", mode.name);
+                identical = false;
+            }
+        }
+
+        // Whole-image Compress, which includes the scanline loads and block gathers
+        ScratchImage source;
+        HRESULT hr = source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, bw * 4, bh * 4, 1, 1);
+        if (FAILED(hr))
+            return false;
+
+        {
+            const Image* img = source.GetImage(0, 0, 0);
+            uint32_t seed = 0x9E3779B9u;
+            for (size_t y = 0; y < img->height; ++y)
+            {
+                auto pRow = reinterpret_cast<uint32_t*>(img->pixels + y * img->rowPitch);
+                for (size_t x = 0; x < img->width; ++x)
+                {
+                    const XMVECTOR v = XMVectorSet(
+                        float(x) / float(img->width),
+                        float(y) / float(img->height),
+                        float(NextRandom(seed) & 0xFF) / 255.f,
+                        1.f);
+                    XMStoreUByteN4(reinterpret_cast<XMUBYTEN4*>(&pRow[x]), v);
+                }
+            }
+        }
+
+        static const DXGI_FORMAT s_formats[] = { DXGI_FORMAT_BC1_UNORM, DXGI_FORMAT_BC3_UNORM };
+        for (const DXGI_FORMAT format : s_formats)
+        {
+            wchar_t name[64] = {};
+            ScratchImage result;
+
+            const double serial = BestOf(reps, [&]()
+                {
+                    hr = Compress(*source.GetImage(0, 0, 0), format, TEX_COMPRESS_DEFAULT, TEX_THRESHOLD_DEFAULT, result);
+                });
+            if (FAILED(hr))
+                return false;
+
+            swprintf_s(name, L"Compress %ls", (format == DXGI_FORMAT_BC1_UNORM) ? L"BC1" : L"BC3");
+            Report(name, serial, double(nblocks), L"blocks");
+
+            const double parallel = BestOf(reps, [&]()
+                {
+                    hr = Compress(*source.GetImage(0, 0, 0), format, TEX_COMPRESS_PARALLEL, TEX_THRESHOLD_DEFAULT, result);
+                });
+            if (FAILED(hr))
+                return false;
+
+            swprintf_s(name, L"Compress %ls parallel", (format == DXGI_FORMAT_BC1_UNORM) ? L"BC1" : L"BC3");
+            Report(name, parallel, double(nblocks), L"blocks", serial);
+        }
+
+        wprintf(L"\n");
+        return identical;
+    }
+
+    //----------------------------------------------------------------------------------
+    // LoadScanline/StoreScanline: the library's scanline conversion against the generic
+    // one-pixel-at-a-time DirectXMath loads and stores it uses for all other formats
+    //----------------------------------------------------------------------------------
+    const XMVECTORF32 g_HalfMin = { { { -65504.f, -65504.f, -65504.f, -65504.f } } };
+    const XMVECTORF32 g_HalfMax = { { { 65504.f, 65504.f, 65504.f, 65504.f } } };
+    const XMVECTORF32 g_8BitBias = { { { 0.5f / 255.f, 0.5f / 255.f, 0.5f / 255.f, 0.5f / 255.f } } };
+
+    void GenericLoad(XMVECTOR* pDestination, size_t count, const void* pSource, DXGI_FORMAT format) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            for (size_t j = 0; j < count; ++j)
+                pDestination[j] = XMLoadUByteN4(static_cast<const XMUBYTEN4*>(pSource) + j);
+            break;
+
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            for (size_t j = 0; j < count; ++j)
+                pDestination[j] = XMVectorSwizzle<2, 1, 0, 3>(XMLoadUByteN4(static_cast<const XMUBYTEN4*>(pSource) + j));
+            break;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            for (size_t j = 0; j < count; ++j)
+                pDestination[j] = XMLoadUDecN4(static_cast<const XMUDECN4*>(pSource) + j);
+            break;
+
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+            for (size_t j = 0; j < count; ++j)
+                pDestination[j] = XMLoadFloat3PK(static_cast<const XMFLOAT3PK*>(pSource) + j);
+            break;
+
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            for (size_t j = 0; j < count; ++j)
+                pDestination[j] = XMLoadHalf4(static_cast<const XMHALF4*>(pSource) + j);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    void GenericStore(void* pDestination, DXGI_FORMAT format, const XMVECTOR* pSource, size_t count) noexcept
+    {
+        switch (format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+            for (size_t j = 0; j < count; ++j)
+                XMStoreUByteN4(static_cast<XMUBYTEN4*>(pDestination) + j, XMVectorAdd(pSource[j], g_8BitBias));
+            break;
+
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+            for (size_t j = 0; j < count; ++j)
+                XMStoreUByteN4(static_cast<XMUBYTEN4*>(pDestination) + j,
+                    XMVectorAdd(XMVectorSwizzle<2, 1, 0, 3>(pSource[j]), g_8BitBias));
+            break;
+
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            for (size_t j = 0; j < count; ++j)
+                XMStoreUDecN4(static_cast<XMUDECN4*>(pDestination) + j, pSource[j]);
+            break;
+
+        case DXGI_FORMAT_R11G11B10_FLOAT:
+            for (size_t j = 0; j < count; ++j)
+                XMStoreFloat3PK(static_cast<XMFLOAT3PK*>(pDestination) + j, pSource[j]);
+            break;
+
+        case DXGI_FORMAT_R16G16B16A16_FLOAT:
+            for (size_t j = 0; j < count; ++j)
+                XMStoreHalf4(static_cast<XMHALF4*>(pDestination) + j, XMVectorClamp(pSource[j], g_HalfMin, g_HalfMax));
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    bool BenchmarkScanline(size_t width, size_t height, size_t reps)
+    {
+        static const struct
+        {
+            const wchar_t*  name;
+            DXGI_FORMAT     format;
+        } s_formats[] =
+        {
+            { L"R8G8B8A8_UNORM",        DXGI_FORMAT_R8G8B8A8_UNORM },
+            { L"B8G8R8A8_UNORM",        DXGI_FORMAT_B8G8R8A8_UNORM },
+            { L"R10G10B10A2_UNORM",     DXGI_FORMAT_R10G10B10A2_UNORM },
+            { L"R11G11B10_FLOAT",       DXGI_FORMAT_R11G11B10_FLOAT },
+            { L"R16G16B16A16_FLOAT",    DXGI_FORMAT_R16G16B16A16_FLOAT },
+        };
+
+        const size_t pixels = width * height;
+
+        auto image = make_AlignedArrayXMVECTOR(pixels);
+        auto scanline = make_AlignedArrayXMVECTOR(uint64_t(width) * 2);
+        if (!image || !scanline)
+            return false;
+
+        FillTestPixels(image.get(), width, height);
+
+        wprintf(L"Scanline conversion, %zu x %zu\n", width, height);
+
+        bool identical = true;
+        for (const auto& fmt : s_formats)
+        {
+            const size_t bpp = BitsPerPixel(fmt.format) / 8;
+            const size_t rowPitch = width * bpp;
+
+            std::vector<uint8_t> packed(rowPitch * height);
+            std::vector<uint8_t> check(rowPitch);
+
+            // Packed source data comes from the generic store, so both paths read the same bits
+            for (size_t y = 0; y < height; ++y)
+            {
+                GenericStore(&packed[y * rowPitch], fmt.format, image.get() + y * width, width);
+            }
+
+            XMVECTOR* fast = scanline.get();
+            XMVECTOR* generic = scanline.get() + width;
+            for (size_t y = 0; y < height && identical; ++y)
+            {
+                const uint8_t* pRow = &packed[y * rowPitch];
+                if (!Internal::LoadScanline(fast, width, pRow, rowPitch, fmt.format))
+                    return false;
+
+                GenericLoad(generic, width, pRow, fmt.format);
+                if (memcmp(fast, generic, sizeof(XMVECTOR) * width) != 0)
+                {
+                    wprintf(L"  ERROR: LoadScanline %ls differs from the generic load\n", fmt.name);
+                    identical = false;
+                }
+
+                if (!Internal::StoreScanline(check.data(), rowPitch, fmt.format, image.get() + y * width, width))
+                    return false;
+
+                if (memcmp(check.data(), pRow, rowPitch) != 0)
+                {
+                    wprintf(L"  ERROR: StoreScanline %ls differs from the generic store\n", fmt.name);
+                    identical = false;
+                }
+            }
+
+            wchar_t name[64] = {};
+
+            const double genericLoad = BestOf(reps, [&]()
+                {
+                    for (size_t y = 0; y < height; ++y)
+                    {
+                        GenericLoad(generic, width, &packed[y * rowPitch], fmt.format);
+                    }
+                });
+            swprintf_s(name, L"generic load %ls", fmt.name);
+            Report(name, genericLoad, double(pixels), L"pixels");
+
+            const double fastLoad = BestOf(reps, [&]()
+                {
+                    for (size_t y = 0; y < height; ++y)
+                    {
+                        std::ignore = Internal::LoadScanline(fast, width, &packed[y * rowPitch], rowPitch, fmt.format);
+                    }
+                });
+            swprintf_s(name, L"LoadScanline %ls", fmt.name);
+            Report(name, fastLoad, double(pixels), L"pixels", genericLoad);
+
+            const double genericStore = BestOf(reps, [&]()
+                {
+                    for (size_t y = 0; y < height; ++y)
+                    {
+                        GenericStore(&packed[y * rowPitch], fmt.format, image.get() + y * width, width);
+                    }
+                });
+            swprintf_s(name, L"generic store %ls", fmt.name);
+            Report(name, genericStore, double(pixels), L"pixels");
+
+            const double fastStore = BestOf(reps, [&]()
+                {
+                    for (size_t y = 0; y < height; ++y)
+                    {
+                        std::ignore = Internal::StoreScanline(&packed[y * rowPitch], rowPitch, fmt.format, image.get() + y * width, width);
+                    }
+                });
+            swprintf_s(name, L"StoreScanline %ls", fmt.name);
+            Report(name, fastStore, double(pixels), L"pixels", genericStore);
+        }
+
+        wprintf(L"\n");
+        return identical;
+    }
+
+    //----------------------------------------------------------------------------------
+    // TGA: the library codec against the per-pixel 32bpp decoder it replaced, which is
+    // kept here as the baseline, on raw and RLE files with realistic run lengths
+    //----------------------------------------------------------------------------------
+
+    // Returns false for malformed data. The test content always has alpha set, so the
+    // all-zero alpha fixup of the original is not needed here.
+    bool ReferenceDecodeTGA32(_In_reads_bytes_(size) const uint8_t* pSource, size_t size, const Image& image) noexcept
+    {
+        if (size < 18 || pSource[16] != 32)
+            return false;
+
+        const bool rle = (pSource[2] == 10);
+        const bool invertX = (pSource[17] & 0x10) != 0;
+        const bool invertY = (pSource[17] & 0x20) != 0;
+
+        const uint8_t* sPtr = pSource + 18 + pSource[0];
+        const uint8_t* endPtr = pSource + size;
+
+        uint32_t minalpha = 255;
+        uint32_t maxalpha = 0;
+
+        for (size_t y = 0; y < image.height; ++y)
+        {
+            const size_t offset = invertX ? (image.width - 1) : 0;
+
+            auto dPtr = reinterpret_cast<uint32_t*>(image.pixels
+                + (image.rowPitch * (invertY ? y : (image.height - y - 1))))
+                + offset;
+
+            if (!rle)
+            {
+                for (size_t x = 0; x < image.width; ++x)
+                {
+                    if (sPtr + 3 >= endPtr)
+                        return false;
+
+                    // BGRA -> RGBA
+                    const uint32_t alpha = *(sPtr + 3);
+                    *dPtr = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | uint32_t(alpha << 24);
+
+                    minalpha = std::min(minalpha, alpha);
+                    maxalpha = std::max(maxalpha, alpha);
+
+                    sPtr += 4;
+
+                    if (invertX)
+                        --dPtr;
+                    else
+                        ++dPtr;
+                }
+                continue;
+            }
+
+            for (size_t x = 0; x < image.width; )
+            {
+                if (sPtr >= endPtr)
+                    return false;
+
+                size_t j = size_t(*sPtr & 0x7F) + 1;
+                if (*sPtr++ & 0x80)
+                {
+                    // Repeat
+                    if (sPtr + 3 >= endPtr)
+                        return false;
+
+                    const uint32_t alpha = *(sPtr + 3);
+                    const uint32_t t = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | uint32_t(alpha << 24);
+
+                    minalpha = std::min(minalpha, alpha);
+                    maxalpha = std::max(maxalpha, alpha);
+
+                    sPtr += 4;
+
+                    for (; j > 0; --j, ++x)
+                    {
+                        if (x >= image.width)
+                            return false;
+
+                        *dPtr = t;
+
+                        if (invertX)
+                            --dPtr;
+                        else
+                            ++dPtr;
+                    }
+                }
+                else
+                {
+                    // Literal
+                    if (sPtr + (j * 4) > endPtr)
+                        return false;
+
+                    for (; j > 0; --j, ++x)
+                    {
+                        if (x >= image.width)
+                            return false;
+
+                        if (sPtr + 3 >= endPtr)
+                            return false;
+
+                        const uint32_t alpha = *(sPtr + 3);
+                        *dPtr = uint32_t(*sPtr << 16) | uint32_t(*(sPtr + 1) << 8) | uint32_t(*(sPtr + 2)) | uint32_t(alpha << 24);
+
+                        minalpha = std::min(minalpha, alpha);
+                        maxalpha = std::max(maxalpha, alpha);
+
+                        sPtr += 4;
+
+                        if (invertX)
+                            --dPtr;
+                        else
+                            ++dPtr;
+                    }
+                }
+            }
+        }
+
+        return maxalpha > 0;
+    }
+
+    bool BenchmarkTGA(size_t width, size_t height, size_t reps)
+    {
+        ScratchImage source;
+        HRESULT hr = source.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+        if (FAILED(hr))
+            return false;
+
+        // Runs of 1 to 32 equal pixels between short noisy stretches, roughly what painted source art compresses to
+        const Image& img = *source.GetImage(0, 0, 0);
+        uint32_t seed = 0x6C8E9CF5u;
+        for (size_t y = 0; y < height; ++y)
+        {
+            auto pRow = reinterpret_cast<uint32_t*>(img.pixels + y * img.rowPitch);
+            for (size_t x = 0; x < width; )
+            {
+                const uint32_t r = NextRandom(seed);
+                const size_t run = std::min<size_t>(width - x, (r & 31) + 1);
+                const uint32_t color = NextRandom(seed) | 0x80000000u;
+                for (size_t j = 0; j < run; ++j)
+                {
+                    pRow[x + j] = (r & 0x100) ? color : (NextRandom(seed) | 0x80000000u);
+                }
+                x += run;
+            }
+        }
+
+        const double pixels = double(width * height);
+
+        wprintf(L"TGA 32bpp, %zu x %zu\n", width, height);
+
+        bool identical = true;
+
+        static const struct
+        {
+            const wchar_t*  name;
+            TGA_FLAGS       flags;
+        } s_modes[] =
+        {
+            { L"raw",   TGA_FLAGS_NONE },
+            { L"RLE",   TGA_FLAGS_RLE },
+        };
+
+        for (const auto& mode : s_modes)
+        {
+            wchar_t name[64] = {};
+
+            Blob blob;
+            const double save = BestOf(reps, [&]()
+                {
+                    hr = SaveToTGAMemory(img, mode.flags, blob);
+                });
+            if (FAILED(hr))
+                return false;
+
+            swprintf_s(name, L"SaveToTGAMemory %ls", mode.name);
+            Report(name, save, pixels, L"pixels");
+            wprintf(L"  %ls file is %zu bytes\n", mode.name, blob.GetBufferSize());
+
+            ScratchImage reference;
+            hr = reference.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1);
+            if (FAILED(hr))
+                return false;
+
+            const Image& refImg = *reference.GetImage(0, 0, 0);
+            bool decoded = true;
+            const double baseline = BestOf(reps, [&]()
+                {
+                    decoded = ReferenceDecodeTGA32(blob.GetConstBufferPointer(), blob.GetBufferSize(), refImg);
+                });
+            if (!decoded)
+            {
+                wprintf(L"  ERROR: baseline decoder rejected the %ls file\n", mode.name);
+                return false;
+            }
+
+            swprintf_s(name, L"previous decoder %ls", mode.name);
+            Report(name, baseline, pixels, L"pixels");
+
+            ScratchImage result;
+            const double load = BestOf(reps, [&]()
+                {
+                    hr = LoadFromTGAMemory(blob.GetConstBufferPointer(), blob.GetBufferSize(), TGA_FLAGS_NONE, nullptr, result);
+                });
+            if (FAILED(hr))
+                return false;
+
+            swprintf_s(name, L"LoadFromTGAMemory %ls", mode.name);
+            Report(name, load, pixels, L"pixels", baseline);
+
+            const double parallel = BestOf(reps, [&]()
+                {
+                    hr = LoadFromTGAMemory(blob.GetConstBufferPointer(), blob.GetBufferSize(), TGA_FLAGS_PARALLEL, nullptr, result);
+                });
+            if (FAILED(hr))
+                return false;
+
+            swprintf_s(name, L"LoadFromTGAMemory %ls parallel", mode.name);
+            Report(name, parallel, pixels, L"pixels", baseline);
+
+            const Image* loaded = result.GetImage(0, 0, 0);
+            if (!loaded || loaded->format != DXGI_FORMAT_R8G8B8A8_UNORM || loaded->width != width || loaded->height != height)
+                return false;
+
+            for (size_t y = 0; y < height; ++y)
+            {
+                if (memcmp(loaded->pixels + y * loaded->rowPitch, refImg.pixels + y * refImg.rowPitch, width * 4) != 0
+                    || memcmp(loaded->pixels + y * loaded->rowPitch, img.pixels + y * img.rowPitch, width * 4) != 0)
+                {
+                    wprintf(L"  ERROR: %ls decode of row %zu does not match the source image\n", mode.name, y);
+                    identical = false;
+                    break;
+                }
+            }
+        }
+
+        wprintf(L"\n");
+        return identical;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+#ifdef __PREFAST__
+#pragma prefast(disable : 28198, "Command-line tool, frees all memory on exit")
+#endif
+
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+{
+    size_t width = 2048;
+    size_t height = 2048;
+    size_t reps = 5;
+    uint32_t benchmarks = 0;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        PWSTR pArg = argv[iArg];
+
+        if (('-' == pArg[0]) || ('/' == pArg[0]))
+        {
+            pArg++;
+
+            size_t* pValue = nullptr;
+            if (!_wcsicmp(pArg, L"w"))
+                pValue = &width;
+            else if (!_wcsicmp(pArg, L"h"))
+                pValue = &height;
+            else if (!_wcsicmp(pArg, L"r"))
+                pValue = &reps;
+
+            if (!pValue || (iArg + 1 >= argc))
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            const long value = wcstol(argv[++iArg], nullptr, 10);
+            if (value <= 0)
+            {
+                wprintf(L"Invalid value specified with -%ls (%ls)\n", pArg, argv[iArg]);
+                return 1;
+            }
+
+            *pValue = size_t(value);
+        }
+        else
+        {
+            const uint32_t bench = LookupByName(pArg, g_pBenchmarks);
+            if (!bench)
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            benchmarks |= bench;
+        }
+    }
+
+    if (!benchmarks)
+        benchmarks = BENCH_ALL;
+
+    PrintLogo();
+
+    HRESULT hr = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    if (FAILED(hr))
+    {
+        wprintf(L"Failed to initialize COM (%08X)\n", static_cast<unsigned int>(hr));
+        return 1;
+    }
+
+    bool success = true;
+
+    if (benchmarks & BENCH_BC)
+    {
+        success &= BenchmarkBC(width, height, reps);
+    }
+
+    if (benchmarks & BENCH_SCANLINE)
+    {
+        success &= BenchmarkScanline(width, height, reps);
+    }
+
+    if (benchmarks & BENCH_TGA)
+    {
+        success &= BenchmarkTGA(width, height, reps);
+    }
+
+    return success ? 0 : 1;
+}
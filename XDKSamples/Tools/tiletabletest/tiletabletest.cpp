@@ -0,0 +1,398 @@
+//--------------------------------------------------------------------------------------
+// File: TileTableTest.cpp
+//
+// Validates the Xbox tile address tables against synthetic tile modes. The tables have
+// no dependency on XG, so this builds and runs on any host, including Linux.
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4619 4616 4091 4838 26812)
+#endif
+
+#include "DirectXTexp.h"
+#include "DirectXTexXboxTileTable.h"
+
+using namespace Xbox;
+
+namespace
+{
+    constexpr size_t c_InvalidAddress = size_t(-1);
+
+    //----------------------------------------------------------------------------------
+    // Synthetic tile modes
+    //
+    // Each mode gives the byte offset of element (x,y) of an array item or volume slice,
+    // built from coordinate bits the way the hardware modes are (apart from remap, which
+    // checks that the tables catch a layout that is not).
+    //----------------------------------------------------------------------------------
+    using ModeFunc = std::function<size_t(size_t x, size_t y, size_t item)>;
+
+    struct TileMode
+    {
+        const char* name;
+        ModeFunc    address;
+        size_t      size;           // Total bytes for all items
+        bool        rebases;        // Items differ only by a constant offset
+    };
+
+    // Interleaves the low bits of x and y, x in the even bits
+    size_t Morton(size_t x, size_t y, size_t bits) noexcept
+    {
+        size_t result = 0;
+        for (size_t b = 0; b < bits; ++b)
+        {
+            result |= ((x >> b) & 1) << (2 * b);
+            result |= ((y >> b) & 1) << (2 * b + 1);
+        }
+        return result;
+    }
+
+    inline size_t AlignUp(size_t value, size_t alignment) noexcept
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    std::vector<TileMode> GetTileModes(size_t w, size_t h, size_t bpe, size_t items)
+    {
+        std::vector<TileMode> modes;
+
+        // Linear with the pitch padded to 256 bytes
+        {
+            const size_t pitch = AlignUp(w * bpe, 256);
+            const size_t stride = pitch * h;
+            modes.push_back({ "linear",
+                [=](size_t x, size_t y, size_t item) { return item * stride + y * pitch + x * bpe; },
+                stride * items, true });
+        }
+
+        // 8x8 Morton micro tiles stored in row-major order
+        {
+            const size_t mw = AlignUp(w, 8) / 8;
+            const size_t stride = AlignUp(AlignUp(w, 8) * AlignUp(h, 8) * bpe, 4096);
+            modes.push_back({ "micro",
+                [=](size_t x, size_t y, size_t item)
+                {
+                    return item * stride + (((y / 8) * mw + (x / 8)) * 64 + Morton(x % 8, y % 8, 3)) * bpe;
+                },
+                stride * items, true });
+        }
+
+        // 64x64 macro tiles with a pipe swizzle mixing in bits from within the tile
+        {
+            const size_t bw = AlignUp(w, 64) / 64;
+            const size_t stride = AlignUp(w, 64) * AlignUp(h, 64) * bpe;
+            modes.push_back({ "pipexor",
+                [=](size_t x, size_t y, size_t item)
+                {
+                    const size_t ix = x % 64;
+                    const size_t iy = y % 64;
+                    size_t offset = Morton(ix, iy, 6);
+                    offset ^= (((ix >> 3) & 1) << 8) ^ (((iy >> 4) & 1) << 9);
+                    return item * stride + (((y / 64) * bw + (x / 64)) * 4096 + offset) * bpe;
+                },
+                stride * items, true });
+        }
+
+        // 64x64 macro tiles with a bank swizzle taken from the tile position and the
+        // array index, so tiles must be split and every item needs its own table
+        {
+            const size_t bw = AlignUp(w, 64) / 64;
+            const size_t stride = AlignUp(w, 64) * AlignUp(h, 64) * bpe;
+            modes.push_back({ "bankxor",
+                [=](size_t x, size_t y, size_t item)
+                {
+                    size_t offset = Morton(x % 64, y % 64, 6);
+                    offset ^= (((x / 64) ^ (y / 64) ^ item) & 3) << 10;
+                    return item * stride + (((y / 64) * bw + (x / 64)) * 4096 + offset) * bpe;
+                },
+                stride * items, items < 2 });
+        }
+
+        // Linear rows with two elements swapped away from the coordinate bits of any tile,
+        // so only comparing every element finds that the pattern does not repeat
+        {
+            const size_t pitch = AlignUp(w * bpe, 256);
+            const size_t stride = pitch * h;
+            modes.push_back({ "remap",
+                [=](size_t x, size_t y, size_t item)
+                {
+                    const size_t rx = (y == 13 && (x == 13 || x == 14)) ? (27 - x) : x;
+                    return item * stride + y * pitch + rx * bpe;
+                },
+                stride * items, true });
+        }
+
+        // Thick 8x8x4 micro tiles for volumes, with the slice in the bits above the
+        // micro tile, so consecutive slices interleave
+        {
+            const size_t mw = AlignUp(w, 8) / 8;
+            const size_t sliceBlocks = mw * (AlignUp(h, 8) / 8);
+            modes.push_back({ "thick",
+                [=](size_t x, size_t y, size_t z)
+                {
+                    const size_t block = (z / 4) * sliceBlocks + (y / 8) * mw + (x / 8);
+                    return (block * 256 + (z % 4) * 64 + Morton(x % 8, y % 8, 3)) * bpe;
+                },
+                sliceBlocks * 256 * bpe * AlignUp(items, 4), true });
+        }
+
+        return modes;
+    }
+
+    uint32_t NextRandom(uint32_t& state) noexcept
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Checks one surface against the per-element reference: a detile must read every
+    // element from its address, and a tile must write every element there and nothing
+    // else.
+    //----------------------------------------------------------------------------------
+    bool CheckSurface(
+        const TileAddressTable& table,
+        const TileAddressTable::AddressFunc& address,
+        const std::vector<uint8_t>& tiled,
+        size_t w,
+        size_t h,
+        size_t bpe)
+    {
+        const size_t rowPitch = w * bpe + 7;
+
+        std::vector<uint8_t> covered(tiled.size(), 0);
+        for (size_t y = 0; y < h; ++y)
+        {
+            for (size_t x = 0; x < w; ++x)
+            {
+                memset(&covered[address(x, y)], 1, bpe);
+            }
+        }
+
+        for (size_t pass = 0; pass < 2; ++pass)
+        {
+            const bool parallel = (pass != 0);
+
+            std::vector<uint8_t> linear(rowPitch * h, 0xCD);
+            HRESULT hr = table.Detile(tiled.data(), tiled.size(), linear.data(), rowPitch, parallel);
+            if (FAILED(hr))
+            {
+                printf("ERROR: Detile failed (%08X)\n", static_cast<unsigned int>(hr));
+                return false;
+            }
+
+            for (size_t y = 0; y < h; ++y)
+            {
+                for (size_t x = 0; x < w; ++x)
+                {
+                    if (memcmp(&linear[y * rowPitch + x * bpe], &tiled[address(x, y)], bpe) != 0)
+                    {
+                        printf("ERROR: Detile%s mismatch at (%zu,%zu)\n", parallel ? " (parallel)" : "", x, y);
+                        return false;
+                    }
+                }
+            }
+
+            std::vector<uint8_t> retiled(tiled.size(), 0xCD);
+            hr = table.Tile(linear.data(), rowPitch, retiled.data(), retiled.size(), parallel);
+            if (FAILED(hr))
+            {
+                printf("ERROR: Tile failed (%08X)\n", static_cast<unsigned int>(hr));
+                return false;
+            }
+
+            for (size_t i = 0; i < retiled.size(); ++i)
+            {
+                const uint8_t expected = covered[i] ? tiled[i] : 0xCD;
+                if (retiled[i] != expected)
+                {
+                    printf("ERROR: Tile%s %s byte %zu\n", parallel ? " (parallel)" : "",
+                        covered[i] ? "mismatch at" : "wrote padding", i);
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Runs every item of a mode through one table the way the Xbox tiling paths do:
+    // initialized for the first item and rebased for the rest where possible.
+    //----------------------------------------------------------------------------------
+    bool RunMode(const TileMode& mode, size_t w, size_t h, size_t bpe, size_t items)
+    {
+        std::vector<uint8_t> tiled(mode.size);
+        uint32_t seed = 0x2545F491u;
+        for (auto& b : tiled)
+        {
+            b = static_cast<uint8_t>(NextRandom(seed));
+        }
+
+        TileAddressTable table;
+        size_t rebased = 0;
+        size_t rebuilt = 0;
+        for (size_t item = 0; item < items; ++item)
+        {
+            const TileAddressTable::AddressFunc address = [&](size_t x, size_t y) -> size_t
+            {
+                return mode.address(x, y, item);
+            };
+
+            HRESULT hr = table.IsInitialized() ? table.Rebase(address) : S_FALSE;
+            if (hr == S_FALSE)
+            {
+                if (item > 0)
+                    ++rebuilt;
+
+                hr = table.Initialize(w, h, bpe, address);
+            }
+            else if (hr == S_OK)
+            {
+                ++rebased;
+            }
+
+            if (FAILED(hr))
+            {
+                printf("ERROR: %s %zux%zu bpe %zu item %zu failed (%08X)\n",
+                    mode.name, w, h, bpe, item, static_cast<unsigned int>(hr));
+                return false;
+            }
+
+            if (!CheckSurface(table, address, tiled, w, h, bpe))
+            {
+                printf("       in %s %zux%zu bpe %zu item %zu, tile %zux%zu\n",
+                    mode.name, w, h, bpe, item, table.GetTileWidth(), table.GetTileHeight());
+                return false;
+            }
+        }
+
+        // The bank swizzle changes with the item, so it only rebases by chance on a surface
+        // that fits in one bank
+        if (mode.rebases && rebuilt > 0)
+        {
+            printf("ERROR: %s %zux%zu bpe %zu rebuilt %zu tables where a rebase was expected\n",
+                mode.name, w, h, bpe, rebuilt);
+            return false;
+        }
+
+        printf("%-8s %4zux%-4zu bpe %2zu  tile %3zux%-3zu  rebased %zu  rebuilt %zu\n",
+            mode.name, w, h, bpe, table.GetTileWidth(), table.GetTileHeight(), rebased, rebuilt);
+        return true;
+    }
+
+    //----------------------------------------------------------------------------------
+    // Misuse and failure cases
+    //----------------------------------------------------------------------------------
+    bool RunErrorCases()
+    {
+        bool success = true;
+
+        auto linear = [](size_t x, size_t y) -> size_t { return (y * 16 + x) * 4; };
+
+        TileAddressTable table;
+        if (table.Rebase(linear) != E_UNEXPECTED)
+        {
+            printf("ERROR: Rebase of an empty table should fail\n");
+            success = false;
+        }
+
+        if (table.Initialize(0, 16, 4, linear) != E_INVALIDARG)
+        {
+            printf("ERROR: Initialize of an empty surface should fail\n");
+            success = false;
+        }
+
+        auto invalid = [](size_t x, size_t y) -> size_t { return (x == 5 && y == 3) ? c_InvalidAddress : (y * 16 + x) * 4; };
+        if (table.Initialize(16, 16, 4, invalid) != E_FAIL || table.IsInitialized())
+        {
+            printf("ERROR: Initialize should fail on an invalid address\n");
+            success = false;
+        }
+
+        if (FAILED(table.Initialize(16, 16, 4, linear)))
+        {
+            printf("ERROR: Initialize of a linear surface failed\n");
+            return false;
+        }
+
+        // The invalid element is not on a coordinate bit, so only the full check of the
+        // first tile sees it
+        if (table.Rebase(invalid) != S_FALSE)
+        {
+            printf("ERROR: Rebase accepted a surface with an invalid address\n");
+            success = false;
+        }
+
+        auto shifted = [](size_t x, size_t y) -> size_t { return 1024 + (y * 16 + x) * 4; };
+        if (table.Rebase(shifted) != S_OK)
+        {
+            printf("ERROR: Rebase of a shifted linear surface failed\n");
+            success = false;
+        }
+
+        // A surface whose addresses wrap around the end of the address space is refused,
+        // as its bounds could not be checked against the buffer size
+        auto wrapped = [](size_t x, size_t y) -> size_t { return size_t(-512) + (y * 16 + x) * 4; };
+        if (table.Rebase(wrapped) != S_FALSE)
+        {
+            printf("ERROR: Rebase of a wrapped surface should be refused\n");
+            success = false;
+        }
+
+        // The shifted surface ends past a buffer sized for the original one
+        std::vector<uint8_t> tiled(16 * 16 * 4);
+        std::vector<uint8_t> linearData(16 * 16 * 4);
+        if (table.Detile(tiled.data(), tiled.size(), linearData.data(), 16 * 4, false) != E_FAIL)
+        {
+            printf("ERROR: Detile should fail when the tiled buffer is too small\n");
+            success = false;
+        }
+
+        return success;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+int main()
+{
+    static const size_t s_dims[][2] =
+    {
+        { 1, 1 }, { 3, 5 }, { 16, 16 }, { 100, 37 }, { 256, 256 }, { 513, 129 }, { 1024, 4 },
+    };
+
+    static const size_t s_bpe[] = { 1, 2, 4, 8, 16 };
+
+    constexpr size_t c_items = 6;
+
+    size_t failures = 0;
+    for (auto& dim : s_dims)
+    {
+        for (const size_t bpe : s_bpe)
+        {
+            for (auto& mode : GetTileModes(dim[0], dim[1], bpe, c_items))
+            {
+                if (!RunMode(mode, dim[0], dim[1], bpe, c_items))
+                    ++failures;
+            }
+        }
+    }
+
+    if (!RunErrorCases())
+        ++failures;
+
+    printf("\n%zu failure(s)\n", failures);
+    return failures ? 1 : 0;
+}
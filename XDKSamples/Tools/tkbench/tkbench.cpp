@@ -0,0 +1,993 @@
+//--------------------------------------------------------------------------------------
+// File: TKBench.cpp
+//
+// Throughput benchmarks for the DirectX Tool Kit CPU paths
+//
+// Copyright (c) Microsoft Corporation. All rights reserved.
+//--------------------------------------------------------------------------------------
+
+#ifndef _M_X64
+#error This tool is only supported for x64 native
+#endif
+
+#pragma warning(push)
+#pragma warning(disable : 4005)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#define NODRAWTEXT
+#define NOMCX
+#define NOSERVICE
+#define NOHELP
+#pragma warning(pop)
+
+#include <Windows.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <d3d11_1.h>
+
+#include <wrl/client.h>
+
+#pragma warning(disable : 4619 4616 4061 4365 4571 4623 4625 4626 4668 4710 4711 4774 4820 5026 5027 5039 26812)
+
+#include "Effects.h"
+#include "GeometricPrimitive.h"
+#include "Model.h"
+#include "SpriteBatch.h"
+
+using namespace DirectX;
+using Microsoft::WRL::ComPtr;
+
+namespace
+{
+    enum BENCHMARKS : uint32_t
+    {
+        BENCH_BONES = 0x1,
+        BENCH_GEOSPHERE = 0x2,
+        BENCH_SPRITES = 0x4,
+        BENCH_ALL = 0xFFFFFFFF,
+    };
+
+    struct SValue
+    {
+        const wchar_t*  name;
+        uint32_t        value;
+    };
+
+    const SValue g_pBenchmarks[] =
+    {
+        { L"bones",     BENCH_BONES },
+        { L"geosphere", BENCH_GEOSPHERE },
+        { L"sprites",   BENCH_SPRITES },
+        { L"all",       BENCH_ALL },
+        { nullptr,      0 }
+    };
+
+    uint32_t LookupByName(const wchar_t *pName, const SValue *pArray)
+    {
+        while (pArray->name)
+        {
+            if (!_wcsicmp(pName, pArray->name))
+                return pArray->value;
+
+            pArray++;
+        }
+
+        return 0;
+    }
+
+    void PrintLogo()
+    {
+        wprintf(L"Microsoft (R) DirectX Tool Kit Benchmark\n");
+        wprintf(L"Copyright (C) Microsoft Corp. All rights reserved.\n");
+#ifdef _DEBUG
+        wprintf(L"*** Debug build ***\n");
+#endif
+        wprintf(L"\n");
+    }
+
+    void PrintUsage()
+    {
+        PrintLogo();
+
+        wprintf(L"Usage: tkbench <options> [benchmark...]\n\n");
+        wprintf(L"   -n <n>              model instances per frame (default 256)\n");
+        wprintf(L"   -r <n>              timed repetitions, best time is reported (default 5)\n");
+        wprintf(L"   -m <filename>       also benchmark the bones of a .sdkmesh or .cmo model\n");
+        wprintf(L"\n   <benchmark>: ");
+
+        for (const SValue* pValue = g_pBenchmarks; pValue->name; ++pValue)
+        {
+            wprintf(L"%ls ", pValue->name);
+        }
+
+        wprintf(L"\n");
+    }
+
+    //----------------------------------------------------------------------------------
+    // Timing helpers
+    //----------------------------------------------------------------------------------
+    class Timer
+    {
+    public:
+        Timer() noexcept : m_start{}
+        {
+            std::ignore = QueryPerformanceFrequency(&m_freq);
+        }
+
+        void Start() noexcept { std::ignore = QueryPerformanceCounter(&m_start); }
+
+        double Elapsed() const noexcept
+        {
+            LARGE_INTEGER end = {};
+            std::ignore = QueryPerformanceCounter(&end);
+            return double(end.QuadPart - m_start.QuadPart) / double(m_freq.QuadPart);
+        }
+
+    private:
+        LARGE_INTEGER m_freq;
+        LARGE_INTEGER m_start;
+    };
+
+    // Runs the work once to warm caches, then reports the best of 'reps' timed runs in seconds
+    template<typename F>
+    double BestOf(size_t reps, F&& work)
+    {
+        work();
+
+        Timer timer;
+        double best = 0.;
+        for (size_t j = 0; j < reps; ++j)
+        {
+            timer.Start();
+            work();
+            const double t = timer.Elapsed();
+            if (!j || t < best)
+                best = t;
+        }
+
+        return best;
+    }
+
+    void Report(const wchar_t* name, double seconds, double items, const wchar_t* units, double baseline = 0.)
+    {
+        wprintf(L"  %-36ls %10.3f ms %14.0f %ls/sec", name, seconds * 1000., items / seconds, units);
+        if (baseline > 0.)
+        {
+            wprintf(L"  (%.2fx)", baseline / seconds);
+        }
+        wprintf(L"\n");
+    }
+
+    uint32_t NextRandom(uint32_t& state) noexcept
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    float NextFloat(uint32_t& state) noexcept
+    {
+        return float(NextRandom(state) & 0xFFFF) / 65535.f;
+    }
+
+    //----------------------------------------------------------------------------------
+    // NULL driver device, so models and sprite batches can be created without a GPU
+    //----------------------------------------------------------------------------------
+    HRESULT CreateNullDevice(_Outptr_ ID3D11Device** pDevice)
+    {
+        static const D3D_FEATURE_LEVEL s_featureLevels[] =
+        {
+            D3D_FEATURE_LEVEL_11_0,
+            D3D_FEATURE_LEVEL_10_1,
+            D3D_FEATURE_LEVEL_10_0,
+        };
+
+        return D3D11CreateDevice(nullptr, D3D_DRIVER_TYPE_NULL, nullptr, 0,
+            s_featureLevels, static_cast<UINT>(std::size(s_featureLevels)),
+            D3D11_SDK_VERSION, pDevice, nullptr, nullptr);
+    }
+
+    // Creates the effects a model asks for, but no textures, so media isn't needed
+    class NullEffectFactory : public IEffectFactory
+    {
+    public:
+        explicit NullEffectFactory(_In_ ID3D11Device* device) : m_device(device) {}
+
+        std::shared_ptr<IEffect> __cdecl CreateEffect(const EffectInfo& info, ID3D11DeviceContext*) override
+        {
+            if (info.enableSkinning)
+                return std::make_shared<SkinnedEffect>(m_device.Get());
+
+            return std::make_shared<BasicEffect>(m_device.Get());
+        }
+
+        void __cdecl CreateTexture(const wchar_t*, ID3D11DeviceContext*, ID3D11ShaderResourceView** textureView) override
+        {
+            *textureView = nullptr;
+        }
+
+    private:
+        ComPtr<ID3D11Device> m_device;
+    };
+
+
+    //----------------------------------------------------------------------------------
+    // Bones: absolute transforms for a crowd of instances, through the recursive walk of
+    // the sibling/child links and through the flattened parent-before-child order
+    //----------------------------------------------------------------------------------
+
+    // Random tree whose parents are close to their children in the array, as exported
+    // skeletons are, stored as the first-child/next-sibling links the loaders produce
+    void MakeHierarchy(size_t nbones, size_t span, uint32_t seed, ModelBone::Collection& bones)
+    {
+        bones.clear();
+        bones.resize(nbones);
+
+        for (size_t j = nbones - 1; j > 0; --j)
+        {
+            const size_t window = std::min(j, span);
+            const auto parent = static_cast<uint32_t>(j - 1 - (NextRandom(seed) % window));
+
+            bones[j].parentIndex = parent;
+            bones[j].siblingIndex = bones[parent].childIndex;
+            bones[parent].childIndex = static_cast<uint32_t>(j);
+        }
+    }
+
+    void MakeLocalTransforms(size_t nbones, uint32_t seed, _Out_writes_(nbones) XMMATRIX* transforms)
+    {
+        for (size_t j = 0; j < nbones; ++j)
+        {
+            const XMMATRIX rotation = XMMatrixRotationRollPitchYaw(
+                NextFloat(seed) - 0.5f, NextFloat(seed) - 0.5f, NextFloat(seed) - 0.5f);
+            transforms[j] = XMMatrixMultiply(rotation,
+                XMMatrixTranslation(NextFloat(seed) * 0.2f, 0.1f + NextFloat(seed) * 0.2f, NextFloat(seed) * 0.2f));
+        }
+    }
+
+    // Exact comparison, except that the roots may differ in the sign of zero terms, as the
+    // recursive walk multiplies them by identity
+    bool SameTransforms(size_t count, _In_reads_(count) const XMMATRIX* a, _In_reads_(count) const XMMATRIX* b)
+    {
+        for (size_t j = 0; j < count; ++j)
+        {
+            for (size_t r = 0; r < 4; ++r)
+            {
+                if (XMVector4NotEqual(a[j].r[r], b[j].r[r]))
+                    return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool BenchmarkBoneSet(const wchar_t* name, const Model& source, size_t instances, size_t reps)
+    {
+        const size_t nbones = source.bones.size();
+
+        // One model keeps the flattened order the loaders build, the other only has the
+        // links, so it uses the recursive walk
+        Model flat;
+        flat.bones = source.bones;
+        flat.UpdateBoneEvaluationOrder();
+
+        Model recursive;
+        recursive.bones = source.bones;
+
+        // Every instance is posed differently
+        auto local = ModelBone::MakeArray(instances * nbones);
+        for (size_t j = 0; j < instances; ++j)
+        {
+            MakeLocalTransforms(nbones, 0x2545F491u + uint32_t(j), local.get() + j * nbones);
+
+            if (source.boneMatrices)
+            {
+                for (size_t k = 0; k < nbones; ++k)
+                {
+                    local[j * nbones + k] = XMMatrixMultiply(local[j * nbones + k], source.boneMatrices[k]);
+                }
+            }
+        }
+
+        auto expected = ModelBone::MakeArray(instances * nbones);
+        auto result = ModelBone::MakeArray(instances * nbones);
+
+        wprintf(L"%ls: %zu bones, %zu instances\n", name, nbones, instances);
+
+        const double items = double(instances * nbones);
+
+        const double baseline = BestOf(reps, [&]()
+            {
+                for (size_t j = 0; j < instances; ++j)
+                {
+                    recursive.CopyAbsoluteBoneTransforms(nbones, local.get() + j * nbones, expected.get() + j * nbones);
+                }
+            });
+        Report(L"recursive", baseline, items, L"bones");
+
+        bool success = true;
+
+        const double flatTime = BestOf(reps, [&]()
+            {
+                for (size_t j = 0; j < instances; ++j)
+                {
+                    flat.CopyAbsoluteBoneTransforms(nbones, local.get() + j * nbones, result.get() + j * nbones);
+                }
+            });
+        Report(L"flat", flatTime, items, L"bones", baseline);
+
+        if (!SameTransforms(instances * nbones, expected.get(), result.get()))
+        {
+            wprintf(L"ERROR: flat transforms do not match the recursive walk\n");
+            success = false;
+        }
+
+        memset(result.get(), 0, sizeof(XMMATRIX) * instances * nbones);
+
+        const double batchTime = BestOf(reps, [&]()
+            {
+                flat.CopyAbsoluteBoneTransformsBatch(instances, nbones, local.get(), result.get());
+            });
+        Report(L"flat batch", batchTime, items, L"bones", baseline);
+
+        if (!SameTransforms(instances * nbones, expected.get(), result.get()))
+        {
+            wprintf(L"ERROR: batched transforms do not match the recursive walk\n");
+            success = false;
+        }
+
+        wprintf(L"\n");
+        return success;
+    }
+
+    bool BenchmarkBones(size_t instances, size_t reps, _In_opt_z_ const wchar_t* modelFile)
+    {
+        bool success = true;
+
+        // Sizes of typical character rigs: a game character, one with full hands and face, and a deep chain
+        static const struct { const wchar_t* name; size_t nbones; size_t span; } s_rigs[] =
+        {
+            { L"Synthetic 64-bone rig",     64,   4 },
+            { L"Synthetic 256-bone rig",    256,  8 },
+            { L"Synthetic 128-bone chain",  128,  1 },
+        };
+
+        for (auto& rig : s_rigs)
+        {
+            Model model;
+            MakeHierarchy(rig.nbones, rig.span, 0x9E3779B9u, model.bones);
+            success &= BenchmarkBoneSet(rig.name, model, instances, reps);
+        }
+
+        if (modelFile)
+        {
+            ComPtr<ID3D11Device> device;
+            HRESULT hr = CreateNullDevice(device.GetAddressOf());
+            if (FAILED(hr))
+            {
+                wprintf(L"ERROR: Failed to create a NULL driver device (%08X)\n", static_cast<unsigned int>(hr));
+                return false;
+            }
+
+            std::unique_ptr<Model> model;
+            try
+            {
+                NullEffectFactory fxFactory(device.Get());
+
+                const wchar_t* ext = wcsrchr(modelFile, L'.');
+                if (ext && !_wcsicmp(ext, L".cmo"))
+                {
+                    model = Model::CreateFromCMO(device.Get(), modelFile, fxFactory);
+                }
+                else
+                {
+                    model = Model::CreateFromSDKMESH(device.Get(), modelFile, fxFactory);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                wprintf(L"ERROR: Failed to load %ls (%hs)\n", modelFile, e.what());
+                return false;
+            }
+
+            if (!model || model->bones.empty())
+            {
+                wprintf(L"ERROR: %ls has no bones\n", modelFile);
+                return false;
+            }
+
+            success &= BenchmarkBoneSet(modelFile, *model, instances, reps);
+        }
+
+        return success;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // GeoSphere: the subdivided octahedron behind GeometricPrimitive::CreateGeoSphere
+    //----------------------------------------------------------------------------------
+    using GeoVertexCollection = GeometricPrimitive::VertexCollection;
+    using GeoIndexCollection = GeometricPrimitive::IndexCollection32;
+
+    // The original generator, which looks up each subdivided edge in a std::map and grows
+    // fresh collections every level. Kept here as the baseline and the expected output.
+    void GeoSphereMapReference(GeoVertexCollection& vertices, GeoIndexCollection& indices, float diameter, size_t tessellation, bool rhcoords)
+    {
+        vertices.clear();
+        indices.clear();
+
+        // An undirected edge, with the larger index first so (a,b) is the same as (b,a)
+        using UndirectedEdge = std::pair<uint32_t, uint32_t>;
+        auto makeUndirectedEdge = [](uint32_t a, uint32_t b) noexcept
+        {
+            return std::make_pair(std::max(a, b), std::min(a, b));
+        };
+
+        // Edge to the index of the vertex which lies midway along it
+        using EdgeSubdivisionMap = std::map<UndirectedEdge, uint32_t>;
+
+        static const XMFLOAT3 OctahedronVertices[] =
+        {
+            XMFLOAT3(0,  1,  0), // 0 top
+            XMFLOAT3(0,  0, -1), // 1 front
+            XMFLOAT3(1,  0,  0), // 2 right
+            XMFLOAT3(0,  0,  1), // 3 back
+            XMFLOAT3(-1,  0,  0), // 4 left
+            XMFLOAT3(0, -1,  0), // 5 bottom
+        };
+        static const uint32_t OctahedronIndices[] =
+        {
+            0, 1, 2,
+            0, 2, 3,
+            0, 3, 4,
+            0, 4, 1,
+            5, 1, 4,
+            5, 4, 3,
+            5, 3, 2,
+            5, 2, 1,
+        };
+
+        const float radius = diameter / 2.0f;
+
+        std::vector<XMFLOAT3> vertexPositions(std::begin(OctahedronVertices), std::end(OctahedronVertices));
+
+        indices.insert(indices.begin(), std::begin(OctahedronIndices), std::end(OctahedronIndices));
+
+        constexpr uint32_t northPoleIndex = 0;
+        constexpr uint32_t southPoleIndex = 5;
+
+        for (size_t iSubdivision = 0; iSubdivision < tessellation; ++iSubdivision)
+        {
+            EdgeSubdivisionMap subdividedEdges;
+            GeoIndexCollection newIndices;
+
+            const size_t triangleCount = indices.size() / 3;
+            for (size_t iTriangle = 0; iTriangle < triangleCount; ++iTriangle)
+            {
+                const uint32_t iv0 = indices[iTriangle * 3 + 0];
+                const uint32_t iv1 = indices[iTriangle * 3 + 1];
+                const uint32_t iv2 = indices[iTriangle * 3 + 2];
+
+                XMFLOAT3 v01;
+                XMFLOAT3 v12;
+                XMFLOAT3 v20;
+                uint32_t iv01;
+                uint32_t iv12;
+                uint32_t iv20;
+
+                auto const divideEdge = [&](uint32_t i0, uint32_t i1, XMFLOAT3& outVertex, uint32_t& outIndex)
+                {
+                    const UndirectedEdge edge = makeUndirectedEdge(i0, i1);
+
+                    auto it = subdividedEdges.find(edge);
+                    if (it != subdividedEdges.end())
+                    {
+                        outIndex = it->second;
+                        outVertex = vertexPositions[outIndex];
+                    }
+                    else
+                    {
+                        XMStoreFloat3(
+                            &outVertex,
+                            XMVectorScale(
+                            XMVectorAdd(XMLoadFloat3(&vertexPositions[i0]), XMLoadFloat3(&vertexPositions[i1])),
+                            0.5f
+                        )
+                        );
+
+                        outIndex = static_cast<uint32_t>(vertexPositions.size());
+                        vertexPositions.push_back(outVertex);
+
+                        subdividedEdges.insert(std::make_pair(edge, outIndex));
+                    }
+                };
+
+                divideEdge(iv0, iv1, v01, iv01);
+                divideEdge(iv1, iv2, v12, iv12);
+                divideEdge(iv0, iv2, v20, iv20);
+
+                const uint32_t indicesToAdd[] =
+                {
+                     iv0, iv01, iv20,
+                    iv20, iv12,  iv2,
+                    iv20, iv01, iv12,
+                    iv01,  iv1, iv12,
+                };
+                newIndices.insert(newIndices.end(), std::begin(indicesToAdd), std::end(indicesToAdd));
+            }
+
+            indices = std::move(newIndices);
+        }
+
+        vertices.reserve(vertexPositions.size());
+        for (const auto& it : vertexPositions)
+        {
+            auto const normal = XMVector3Normalize(XMLoadFloat3(&it));
+            auto const pos = XMVectorScale(normal, radius);
+
+            XMFLOAT3 normalFloat3;
+            XMStoreFloat3(&normalFloat3, normal);
+
+            const float longitude = atan2f(normalFloat3.x, -normalFloat3.z);
+            const float latitude = acosf(normalFloat3.y);
+
+            const float u = longitude / XM_2PI + 0.5f;
+            const float v = latitude / XM_PI;
+
+            auto const texcoord = XMVectorSet(1.0f - u, v, 0.0f, 0.0f);
+            vertices.push_back(VertexPositionNormalTexture(pos, normal, texcoord));
+        }
+
+        // Texture coordinate wraparound fixup along the prime meridian
+        const size_t preFixupVertexCount = vertices.size();
+        for (size_t i = 0; i < preFixupVertexCount; ++i)
+        {
+            const bool isOnPrimeMeridian = XMVector2NearEqual(
+                XMVectorSet(vertices[i].position.x, vertices[i].textureCoordinate.x, 0.0f, 0.0f),
+                XMVectorZero(),
+                XMVectorSplatEpsilon());
+
+            if (isOnPrimeMeridian)
+            {
+                const size_t newIndex = vertices.size();
+
+                VertexPositionNormalTexture v = vertices[i];
+                v.textureCoordinate.x = 1.0f;
+                vertices.push_back(v);
+
+                for (size_t j = 0; j < indices.size(); j += 3)
+                {
+                    uint32_t* triIndex0 = &indices[j + 0];
+                    uint32_t* triIndex1 = &indices[j + 1];
+                    uint32_t* triIndex2 = &indices[j + 2];
+
+                    if (*triIndex0 == i)
+                    {
+                    }
+                    else if (*triIndex1 == i)
+                    {
+                        std::swap(triIndex0, triIndex1);
+                    }
+                    else if (*triIndex2 == i)
+                    {
+                        std::swap(triIndex0, triIndex2);
+                    }
+                    else
+                    {
+                        continue;
+                    }
+
+                    const VertexPositionNormalTexture& v0 = vertices[*triIndex0];
+                    const VertexPositionNormalTexture& v1 = vertices[*triIndex1];
+                    const VertexPositionNormalTexture& v2 = vertices[*triIndex2];
+
+                    if (fabsf(v0.textureCoordinate.x - v1.textureCoordinate.x) > 0.5f ||
+                        fabsf(v0.textureCoordinate.x - v2.textureCoordinate.x) > 0.5f)
+                    {
+                        *triIndex0 = static_cast<uint32_t>(newIndex);
+                    }
+                }
+            }
+        }
+
+        // Duplicate the pole vertices for every triangle that uses them
+        auto const fixPole = [&](size_t poleIndex)
+        {
+            const auto& poleVertex = vertices[poleIndex];
+            bool overwrittenPoleVertex = false;
+
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                uint32_t* pPoleIndex;
+                uint32_t* pOtherIndex0;
+                uint32_t* pOtherIndex1;
+                if (indices[i + 0] == poleIndex)
+                {
+                    pPoleIndex = &indices[i + 0];
+                    pOtherIndex0 = &indices[i + 1];
+                    pOtherIndex1 = &indices[i + 2];
+                }
+                else if (indices[i + 1] == poleIndex)
+                {
+                    pPoleIndex = &indices[i + 1];
+                    pOtherIndex0 = &indices[i + 2];
+                    pOtherIndex1 = &indices[i + 0];
+                }
+                else if (indices[i + 2] == poleIndex)
+                {
+                    pPoleIndex = &indices[i + 2];
+                    pOtherIndex0 = &indices[i + 0];
+                    pOtherIndex1 = &indices[i + 1];
+                }
+                else
+                {
+                    continue;
+                }
+
+                const auto& otherVertex0 = vertices[*pOtherIndex0];
+                const auto& otherVertex1 = vertices[*pOtherIndex1];
+
+                VertexPositionNormalTexture newPoleVertex = poleVertex;
+                newPoleVertex.textureCoordinate.x = (otherVertex0.textureCoordinate.x + otherVertex1.textureCoordinate.x) / 2;
+                newPoleVertex.textureCoordinate.y = poleVertex.textureCoordinate.y;
+
+                if (!overwrittenPoleVertex)
+                {
+                    vertices[poleIndex] = newPoleVertex;
+                    overwrittenPoleVertex = true;
+                }
+                else
+                {
+                    *pPoleIndex = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(newPoleVertex);
+                }
+            }
+        };
+
+        fixPole(northPoleIndex);
+        fixPole(southPoleIndex);
+
+        if (!rhcoords)
+        {
+            for (auto it = indices.begin(); it != indices.end(); it += 3)
+            {
+                std::swap(*it, *(it + 2));
+            }
+
+            for (auto& it : vertices)
+            {
+                it.textureCoordinate.x = (1.f - it.textureCoordinate.x);
+            }
+        }
+    }
+
+    bool BenchmarkGeoSphere(size_t reps)
+    {
+        bool success = true;
+
+        wprintf(L"GeoSphere: 32-bit indices, right-handed\n");
+
+        for (size_t tessellation = 1; tessellation <= 8; ++tessellation)
+        {
+            GeoVertexCollection expectedVertices;
+            GeoIndexCollection expectedIndices;
+            GeoVertexCollection vertices;
+            GeoIndexCollection indices;
+
+            wchar_t name[64] = {};
+            swprintf_s(name, L"tessellation %zu, std::map", tessellation);
+
+            const double baseline = BestOf(reps, [&]()
+                {
+                    GeoSphereMapReference(expectedVertices, expectedIndices, 1.f, tessellation, true);
+                });
+
+            const double triangles = double(expectedIndices.size() / 3);
+            Report(name, baseline, triangles, L"tris");
+
+            swprintf_s(name, L"tessellation %zu, CreateGeoSphere", tessellation);
+
+            const double time = BestOf(reps, [&]()
+                {
+                    GeometricPrimitive::CreateGeoSphere(vertices, indices, 1.f, tessellation, true);
+                });
+            Report(name, time, triangles, L"tris", baseline);
+
+            if (vertices.size() != expectedVertices.size()
+                || indices != expectedIndices
+                || memcmp(vertices.data(), expectedVertices.data(), sizeof(VertexPositionNormalTexture) * vertices.size()) != 0)
+            {
+                wprintf(L"ERROR: tessellation %zu does not match the std::map generator\n", tessellation);
+                success = false;
+            }
+        }
+
+        wprintf(L"\n");
+        return success;
+    }
+
+
+    //----------------------------------------------------------------------------------
+    // Sprites: a frame of SpriteBatch::Begin/Draw/End on the NULL driver, which times
+    // the queueing, sorting and vertex generation without any GPU work
+    //----------------------------------------------------------------------------------
+    struct SpriteDesc
+    {
+        XMFLOAT2    position;
+        RECT        source;
+        bool        useSource;
+        float       rotation;
+        XMFLOAT2    origin;
+        float       scale;
+        float       depth;
+        uint32_t    texture;
+    };
+
+    void ReportSprites(const wchar_t* name, double seconds, size_t count, double baseline = 0.)
+    {
+        wprintf(L"  %-36ls %10.3f ms %14.0f sprites/ms", name, seconds * 1000., double(count) / (seconds * 1000.));
+        if (baseline > 0.)
+        {
+            wprintf(L"  (%.2fx)", baseline / seconds);
+        }
+        wprintf(L"\n");
+    }
+
+    bool BenchmarkSprites(size_t reps)
+    {
+        constexpr size_t c_spriteCount = 100000;
+        constexpr size_t c_textureCount = 16;
+
+        ComPtr<ID3D11Device> device;
+        HRESULT hr = CreateNullDevice(device.GetAddressOf());
+        if (FAILED(hr))
+        {
+            wprintf(L"ERROR: Failed to create a NULL driver device (%08X)\n", static_cast<unsigned int>(hr));
+            return false;
+        }
+
+        ComPtr<ID3D11DeviceContext> context;
+        device->GetImmediateContext(context.GetAddressOf());
+
+        // Textures of a few sizes, as a HUD or particle atlas set would have
+        ComPtr<ID3D11ShaderResourceView> textures[c_textureCount];
+        for (size_t j = 0; j < c_textureCount; ++j)
+        {
+            D3D11_TEXTURE2D_DESC desc = {};
+            desc.Width = 64u << (j % 4);
+            desc.Height = 64u << ((j / 4) % 4);
+            desc.MipLevels = desc.ArraySize = 1;
+            desc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+            desc.SampleDesc.Count = 1;
+            desc.Usage = D3D11_USAGE_DEFAULT;
+            desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+            ComPtr<ID3D11Texture2D> texture;
+            hr = device->CreateTexture2D(&desc, nullptr, texture.GetAddressOf());
+            if (SUCCEEDED(hr))
+            {
+                hr = device->CreateShaderResourceView(texture.Get(), nullptr, textures[j].GetAddressOf());
+            }
+
+            if (FAILED(hr))
+            {
+                wprintf(L"ERROR: Failed to create a NULL driver texture (%08X)\n", static_cast<unsigned int>(hr));
+                return false;
+            }
+        }
+
+        // Half the sprites use a source rectangle and a quarter are rotated, on random textures and depths
+        std::vector<SpriteDesc> sprites(c_spriteCount);
+        uint32_t seed = 0x6C078965u;
+        for (auto& it : sprites)
+        {
+            const uint32_t r = NextRandom(seed);
+
+            it.position = XMFLOAT2(NextFloat(seed) * 1920.f, NextFloat(seed) * 1080.f);
+            it.source = { 0, 0, LONG(8 + (r & 31)), LONG(8 + ((r >> 5) & 31)) };
+            it.useSource = (r & 0x800) != 0;
+            it.rotation = (r & 0x600) ? 0.f : NextFloat(seed) * XM_2PI;
+            it.origin = XMFLOAT2(4.f, 4.f);
+            it.scale = 0.5f + NextFloat(seed);
+            it.depth = NextFloat(seed);
+            it.texture = (r >> 12) % c_textureCount;
+        }
+
+        std::unique_ptr<SpriteBatch> batch;
+        try
+        {
+            batch = std::make_unique<SpriteBatch>(context.Get());
+        }
+        catch (const std::exception& e)
+        {
+            wprintf(L"ERROR: Failed to create the SpriteBatch (%hs)\n", e.what());
+            return false;
+        }
+
+        // The NULL driver has no viewport set
+        const D3D11_VIEWPORT viewport = { 0.f, 0.f, 1920.f, 1080.f, 0.f, 1.f };
+        batch->SetViewport(viewport);
+
+        auto const drawRange = [&](size_t begin, size_t end)
+        {
+            for (size_t j = begin; j < end; ++j)
+            {
+                const SpriteDesc& sprite = sprites[j];
+
+                batch->Draw(textures[sprite.texture].Get(), sprite.position,
+                    sprite.useSource ? &sprite.source : nullptr,
+                    Colors::White, sprite.rotation, sprite.origin, sprite.scale, SpriteEffects_None, sprite.depth);
+            }
+        };
+
+        // Records the frame on 'threadCount' threads, including this one, which calls Begin and End
+        auto const frame = [&](SpriteSortMode sortMode, size_t threadCount)
+        {
+            batch->Begin(sortMode);
+
+            std::vector<std::thread> threads;
+            threads.reserve(threadCount - 1);
+            for (size_t j = 1; j < threadCount; ++j)
+            {
+                threads.emplace_back(drawRange, c_spriteCount * j / threadCount, c_spriteCount * (j + 1) / threadCount);
+            }
+
+            drawRange(0, c_spriteCount / threadCount);
+
+            for (auto& it : threads)
+            {
+                it.join();
+            }
+
+            batch->End();
+        };
+
+        static const struct { const wchar_t* name; SpriteSortMode sortMode; } s_modes[] =
+        {
+            { L"Deferred",      SpriteSortMode_Deferred },
+            { L"Texture",       SpriteSortMode_Texture },
+            { L"BackToFront",   SpriteSortMode_BackToFront },
+            { L"FrontToBack",   SpriteSortMode_FrontToBack },
+        };
+
+        const size_t threadCount = std::min<size_t>(std::max(1u, std::thread::hardware_concurrency()), 8);
+
+        wprintf(L"Sprites: %zu sprites, %zu textures, NULL driver\n", c_spriteCount, c_textureCount);
+
+        try
+        {
+            for (auto& mode : s_modes)
+            {
+                const double baseline = BestOf(reps, [&]() { frame(mode.sortMode, 1); });
+                ReportSprites(mode.name, baseline, c_spriteCount);
+
+                if (threadCount > 1)
+                {
+                    wchar_t name[64] = {};
+                    swprintf_s(name, L"%ls, %zu threads", mode.name, threadCount);
+
+                    const double time = BestOf(reps, [&]() { frame(mode.sortMode, threadCount); });
+                    ReportSprites(name, time, c_spriteCount, baseline);
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            wprintf(L"ERROR: SpriteBatch failed on the NULL driver (%hs)\n", e.what());
+            return false;
+        }
+
+        wprintf(L"\n");
+        return true;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Entry-point
+//--------------------------------------------------------------------------------------
+#ifdef __PREFAST__
+#pragma prefast(disable : 28198, "Command-line tool, frees all memory on exit")
+#endif
+
+int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
+{
+    size_t instances = 256;
+    size_t reps = 5;
+    const wchar_t* modelFile = nullptr;
+    uint32_t benchmarks = 0;
+
+    for (int iArg = 1; iArg < argc; iArg++)
+    {
+        PWSTR pArg = argv[iArg];
+
+        if (('-' == pArg[0]) || ('/' == pArg[0]))
+        {
+            pArg++;
+
+            if (!_wcsicmp(pArg, L"m"))
+            {
+                if (iArg + 1 >= argc)
+                {
+                    PrintUsage();
+                    return 1;
+                }
+
+                modelFile = argv[++iArg];
+                continue;
+            }
+
+            size_t* pValue = nullptr;
+            if (!_wcsicmp(pArg, L"n"))
+                pValue = &instances;
+            else if (!_wcsicmp(pArg, L"r"))
+                pValue = &reps;
+
+            if (!pValue || (iArg + 1 >= argc))
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            const long value = wcstol(argv[++iArg], nullptr, 10);
+            if (value <= 0)
+            {
+                wprintf(L"Invalid value specified with -%ls (%ls)\n", pArg, argv[iArg]);
+                return 1;
+            }
+
+            *pValue = size_t(value);
+        }
+        else
+        {
+            const uint32_t bench = LookupByName(pArg, g_pBenchmarks);
+            if (!bench)
+            {
+                PrintUsage();
+                return 1;
+            }
+
+            benchmarks |= bench;
+        }
+    }
+
+    if (!benchmarks)
+        benchmarks = BENCH_ALL;
+
+    PrintLogo();
+
+    bool success = true;
+
+    if (benchmarks & BENCH_BONES)
+    {
+        success &= BenchmarkBones(instances, reps, modelFile);
+    }
+
+    if (benchmarks & BENCH_GEOSPHERE)
+    {
+        success &= BenchmarkGeoSphere(reps);
+    }
+
+    if (benchmarks & BENCH_SPRITES)
+    {
+        success &= BenchmarkSprites(reps);
+    }
+
+    return success ? 0 : 1;
+}
@@ -97,6 +97,7 @@ namespace
         OPT_USE_DX10,
         OPT_USE_DX9,
         OPT_TGA20,
+        OPT_TGA_RLE,
         OPT_WIC_QUALITY,
         OPT_WIC_LOSSLESS,
         OPT_WIC_MULTIFRAME,
@@ -133,6 +134,8 @@ namespace
         OPT_SWIZZLE,
         OPT_USE_XBOX,
         OPT_XGMODE,
+        OPT_BC_CACHE,
+        OPT_BC_CACHE_SIZE,
         OPT_MAX
     };
 
@@ -188,6 +191,7 @@ namespace
         { L"dx10",          OPT_USE_DX10 },
         { L"dx9",           OPT_USE_DX9 },
         { L"tga20",         OPT_TGA20 },
+        { L"tgarle",        OPT_TGA_RLE },
         { L"wicq",          OPT_WIC_QUALITY },
         { L"wiclossless",   OPT_WIC_LOSSLESS },
         { L"wicmulti",      OPT_WIC_MULTIFRAME },
@@ -224,6 +228,8 @@ namespace
         { L"swizzle",       OPT_SWIZZLE },
         { L"xbox",          OPT_USE_XBOX },
         { L"xgmode",        OPT_XGMODE },
+        { L"bccache",       OPT_BC_CACHE },
+        { L"bccachesize",   OPT_BC_CACHE_SIZE },
         { nullptr,          0 }
     };
 
@@ -405,18 +411,24 @@ namespace
         { L"FANT",                      TEX_FILTER_FANT },
         { L"BOX",                       TEX_FILTER_BOX },
         { L"TRIANGLE",                  TEX_FILTER_TRIANGLE },
+        { L"LANCZOS3",                  TEX_FILTER_LANCZOS3 },
+        { L"MITCHELL",                  TEX_FILTER_MITCHELL },
         { L"POINT_DITHER",              TEX_FILTER_POINT | TEX_FILTER_DITHER },
         { L"LINEAR_DITHER",             TEX_FILTER_LINEAR | TEX_FILTER_DITHER },
         { L"CUBIC_DITHER",              TEX_FILTER_CUBIC | TEX_FILTER_DITHER },
         { L"FANT_DITHER",               TEX_FILTER_FANT | TEX_FILTER_DITHER },
         { L"BOX_DITHER",                TEX_FILTER_BOX | TEX_FILTER_DITHER },
         { L"TRIANGLE_DITHER",           TEX_FILTER_TRIANGLE | TEX_FILTER_DITHER },
+        { L"LANCZOS3_DITHER",           TEX_FILTER_LANCZOS3 | TEX_FILTER_DITHER },
+        { L"MITCHELL_DITHER",           TEX_FILTER_MITCHELL | TEX_FILTER_DITHER },
         { L"POINT_DITHER_DIFFUSION",    TEX_FILTER_POINT | TEX_FILTER_DITHER_DIFFUSION },
         { L"LINEAR_DITHER_DIFFUSION",   TEX_FILTER_LINEAR | TEX_FILTER_DITHER_DIFFUSION },
         { L"CUBIC_DITHER_DIFFUSION",    TEX_FILTER_CUBIC | TEX_FILTER_DITHER_DIFFUSION },
         { L"FANT_DITHER_DIFFUSION",     TEX_FILTER_FANT | TEX_FILTER_DITHER_DIFFUSION },
         { L"BOX_DITHER_DIFFUSION",      TEX_FILTER_BOX | TEX_FILTER_DITHER_DIFFUSION },
         { L"TRIANGLE_DITHER_DIFFUSION", TEX_FILTER_TRIANGLE | TEX_FILTER_DITHER_DIFFUSION },
+        { L"LANCZOS3_DITHER_DIFFUSION", TEX_FILTER_LANCZOS3 | TEX_FILTER_DITHER_DIFFUSION },
+        { L"MITCHELL_DITHER_DIFFUSION", TEX_FILTER_MITCHELL | TEX_FILTER_DITHER_DIFFUSION },
         { nullptr,                      TEX_FILTER_DEFAULT                              }
     };
 
@@ -525,6 +537,10 @@ namespace
 
     using ScopedFindHandle = std::unique_ptr<void, find_closer>;
 
+    struct allocator_restorer { void operator()(IAllocator*) noexcept { SetDefaultAllocator(nullptr); } };
+
+    using ScopedDefaultAllocator = std::unique_ptr<IAllocator, allocator_restorer>;
+
     constexpr static bool ispow2(size_t x)
     {
         return ((x != 0) && !(x & (x - 1)));
@@ -933,6 +949,7 @@ namespace
             L"\n"
             L"                       (TGA output only)\n"
             L"   -tga20              Write file including TGA 2.0 extension area\n"
+            L"   -tgarle             Write file using RLE compression\n"
             L"\n"
             L"                       (BMP, PNG, JPG, TIF, WDP output only)\n"
             L"   -wicq <quality>     When writing images with WIC use quality (0.0 to 1.0)\n"
@@ -942,9 +959,7 @@ namespace
             L"   -nologo             suppress copyright message\n"
             L"   -timing             Display elapsed processing time\n"
             L"\n"
-#ifdef _OPENMP
-            L"   -singleproc         Do not use multi-threaded compression\n"
-#endif
+            L"   -singleproc         Do not use multi-threaded compression or filtering\n"
             L"   -gpu <adapter>      Select GPU for DirectCompute-based codecs (0 is default)\n"
             L"   -nogpu              Do not use DirectCompute-based codecs\n"
             L"\n"
@@ -953,6 +968,8 @@ namespace
             L"                          d, u, q, x\n"
             L"   -aw <weight>        BC7 GPU compressor weighting for alpha error metric\n"
             L"                       (defaults to 1.0)\n"
+            L"   -bccache <dir>      Reuse CPU compressed BC tiles from earlier runs\n"
+            L"   -bccachesize <MB>   Size limit of the -bccache directory (defaults to 1024)\n"
             L"\n"
             L"   -c <hex-RGB>        colorkey (a.k.a. chromakey) transparency\n"
             L"   -rotatecolor <rot>  rotates color primaries and/or applies a curve\n"
@@ -1398,6 +1415,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     wchar_t szPrefix[MAX_PATH] = {};
     wchar_t szSuffix[MAX_PATH] = {};
     wchar_t szOutputDir[MAX_PATH] = {};
+    wchar_t szCacheDir[MAX_PATH] = {};
+    uint32_t cacheSizeMB = 1024;
 
     // Set locale for output since GetErrorDesc can get localized strings.
     std::locale::global(std::locale(""));
@@ -1465,6 +1484,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             case OPT_PRESERVE_ALPHA_COVERAGE:
             case OPT_SWIZZLE:
             case OPT_XGMODE:
+            case OPT_BC_CACHE:
+            case OPT_BC_CACHE_SIZE:
                 // These support either "-arg:value" or "-arg value"
                 if (!*pValue)
                 {
@@ -1953,7 +1974,21 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
             }
 #else
                 printf("WARNING: -xgmode switch ignored\n");
+                break;
 #endif
+
+            case OPT_BC_CACHE:
+                wcscpy_s(szCacheDir, MAX_PATH, pValue);
+                break;
+
+            case OPT_BC_CACHE_SIZE:
+                if (swscanf_s(pValue, L"%u", &cacheSizeMB) != 1)
+                {
+                    wprintf(L"Invalid value specified with -bccachesize (%ls)\n\n", pValue);
+                    PrintUsage();
+                    return 1;
+                }
+                break;
             }
         }
         else if (wcspbrk(pArg, L"?*") != nullptr)
@@ -1984,6 +2019,22 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     if (~dwOptions & (uint64_t(1) << OPT_NOLOGO))
         PrintLogo();
 
+    if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+    {
+        dwFilterOpts |= TEX_FILTER_PARALLEL;
+    }
+
+    CompressionCache bcCache;
+    if (dwOptions & (uint64_t(1) << OPT_BC_CACHE))
+    {
+        hr = bcCache.Initialize(szCacheDir, uint64_t(cacheSizeMB) * 1024 * 1024);
+        if (FAILED(hr))
+        {
+            wprintf(L"Failed to open BC cache directory %ls (%08X%ls)\n", szCacheDir, static_cast<unsigned int>(hr), GetErrorDesc(hr));
+            return 1;
+        }
+    }
+
     // Work out out filename prefix and suffix
     if (szOutputDir[0] && (L'\\' != szOutputDir[wcslen(szOutputDir) - 1]))
         wcscat_s(szOutputDir, MAX_PATH, L"\\");
@@ -2018,6 +2069,12 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
     bool preserveAlphaCoverage = false;
     ComPtr<ID3D11Device> pDevice;
 
+    // Intermediate images are recycled from file to file rather than going back to the heap.
+    // The default allocator is reset on every return path, before the pool goes out of scope.
+    BufferPool bufferPool;
+    SetDefaultAllocator(&bufferPool);
+    ScopedDefaultAllocator restoreAllocator(&bufferPool);
+
     int retVal = 0;
 
     for (auto pConv = conversion.begin(); pConv != conversion.end(); ++pConv)
@@ -2060,7 +2117,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 hr = Xbox::LoadFromDDSFile(pConv->szSrc, &info, xbox);
                 if (SUCCEEDED(hr))
                 {
-                    hr = Xbox::Detile(xbox, *image);
+                    hr = Xbox::Detile(xbox, *image,
+                        (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? Xbox::XBOX_TILE_FLAGS_ADDRESS_TABLE : Xbox::XBOX_TILE_FLAGS_PARALLEL);
                 }
             }
             else
@@ -2116,6 +2174,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         else if (_wcsicmp(ext, L".tga") == 0)
         {
             TGA_FLAGS tgaFlags = (IsBGR(format)) ? TGA_FLAGS_BGR : TGA_FLAGS_NONE;
+            if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
+            {
+                tgaFlags |= TGA_FLAGS_PARALLEL;
+            }
 
             hr = LoadFromTGAFile(pConv->szSrc, tgaFlags, &info, *image);
             if (FAILED(hr))
@@ -2127,7 +2189,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
         }
         else if (_wcsicmp(ext, L".hdr") == 0)
         {
-            hr = LoadFromHDRFile(pConv->szSrc, &info, *image);
+            const HDR_FLAGS hdrFlags = (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? HDR_FLAGS_NONE : HDR_FLAGS_PARALLEL;
+            hr = LoadFromHDRFile(pConv->szSrc, hdrFlags, &info, *image);
             if (FAILED(hr))
             {
                 wprintf(L" FAILED (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
@@ -2316,7 +2379,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 return 1;
             }
 
-            hr = Decompress(img, nimg, info, DXGI_FORMAT_UNKNOWN /* picks good default */, *timage);
+            hr = DecompressEx(img, nimg, info, DXGI_FORMAT_UNKNOWN /* picks good default */,
+                (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? TEX_DECOMPRESS_DEFAULT : TEX_DECOMPRESS_PARALLEL,
+                *timage);
             if (FAILED(hr))
             {
                 wprintf(L" FAILED [decompress] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
@@ -2374,7 +2439,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     return 1;
                 }
 
-                hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_REVERSE | dwSRGB, *timage);
+                const TEX_PMALPHA_FLAGS pmFlags = (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? TEX_PMALPHA_DEFAULT : TEX_PMALPHA_PARALLEL;
+                hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_REVERSE | dwSRGB | pmFlags, *timage);
                 if (FAILED(hr))
                 {
                     wprintf(L" FAILED [demultiply alpha] (%08X%ls)\n",
@@ -2943,7 +3009,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
             }
 
-            hr = ComputeNormalMap(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwNormalMap, nmapAmplitude, nmfmt, *timage);
+            const CNMAP_FLAGS nmapFlags = (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? CNMAP_DEFAULT : CNMAP_PARALLEL;
+            hr = ComputeNormalMap(image->GetImages(), image->GetImageCount(), image->GetMetadata(), dwNormalMap | nmapFlags, nmapAmplitude, nmfmt, *timage);
             if (FAILED(hr))
             {
                 wprintf(L" FAILED [normalmap] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
@@ -3392,7 +3459,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                     return 1;
                 }
 
-                hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_DEFAULT | dwSRGB, *timage);
+                const TEX_PMALPHA_FLAGS pmFlags = (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? TEX_PMALPHA_DEFAULT : TEX_PMALPHA_PARALLEL;
+                hr = PremultiplyAlpha(img, nimg, info, TEX_PMALPHA_DEFAULT | dwSRGB | pmFlags, *timage);
                 if (FAILED(hr))
                 {
                     wprintf(L" FAILED [premultiply alpha] (%08X%ls)\n", static_cast<unsigned int>(hr), GetErrorDesc(hr));
@@ -3491,12 +3559,10 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
 
                 TEX_COMPRESS_FLAGS cflags = dwCompress;
-#ifdef _OPENMP
                 if (!(dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)))
                 {
                     cflags |= TEX_COMPRESS_PARALLEL;
                 }
-#endif
 
                 if ((img->width % 4) != 0 || (img->height % 4) != 0)
                 {
@@ -3509,7 +3575,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 }
                 else
                 {
-                    hr = Compress(img, nimg, info, tformat, cflags | dwSRGB, alphaThreshold, *timage);
+                    CompressOptions options = {};
+                    options.flags = cflags | dwSRGB;
+                    options.threshold = alphaThreshold;
+                    options.cache = (dwOptions & (uint64_t(1) << OPT_BC_CACHE)) ? &bcCache : nullptr;
+                    hr = CompressEx(img, nimg, info, tformat, options, *timage);
                 }
                 if (FAILED(hr))
                 {
@@ -3652,7 +3722,8 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 {
                     Xbox::XboxImage xbox;
 
-                    hr = Xbox::Tile(img, nimg, info, xbox);
+                    hr = Xbox::Tile(img, nimg, info, xbox, Xbox::c_XboxTileModeInvalid,
+                        (dwOptions & (uint64_t(1) << OPT_FORCE_SINGLEPROC)) ? Xbox::XBOX_TILE_FLAGS_ADDRESS_TABLE : Xbox::XBOX_TILE_FLAGS_PARALLEL);
                     if (SUCCEEDED(hr))
                     {
                         hr = Xbox::SaveToDDSFile(xbox, szDest);
@@ -3675,7 +3746,9 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
                 break;
 
             case CODEC_TGA:
-                hr = SaveToTGAFile(img[0], TGA_FLAGS_NONE, szDest, (dwOptions & (uint64_t(1) << OPT_TGA20)) ? &info : nullptr);
+                hr = SaveToTGAFile(img[0],
+                    (dwOptions & (uint64_t(1) << OPT_TGA_RLE)) ? TGA_FLAGS_RLE : TGA_FLAGS_NONE,
+                    szDest, (dwOptions & (uint64_t(1) << OPT_TGA20)) ? &info : nullptr);
                 break;
 
             case CODEC_HDR:
@@ -3797,6 +3870,11 @@ int __cdecl wmain(_In_ int argc, _In_z_count_(argc) wchar_t* argv[])
 
         const LONGLONG delta = qpcEnd.QuadPart - qpcStart.QuadPart;
         wprintf(L"\n Processing time: %f seconds\n", double(delta) / double(qpcFreq.QuadPart));
+
+        if (dwOptions & (uint64_t(1) << OPT_BC_CACHE))
+        {
+            wprintf(L" BC cache: %llu hits, %llu misses\n", bcCache.GetHitCount(), bcCache.GetMissCount());
+        }
     }
 
     return retVal;